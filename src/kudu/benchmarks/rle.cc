@@ -22,13 +22,18 @@
 //
 
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
 #include <ostream>
+#include <string>
+#include <vector>
 
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
 #include "kudu/gutil/basictypes.h"
 #include "kudu/gutil/mathlimits.h"
+#include "kudu/gutil/strings/substitute.h"
 #include "kudu/util/bit-stream-utils.h"
 #include "kudu/util/bit-stream-utils.inline.h"
 #include "kudu/util/faststring.h"
@@ -38,6 +43,8 @@
 
 DEFINE_int32(bitstream_num_bytes, 1 * 1024 * 1024,
              "Number of bytes worth of bits to write and read from the bitstream");
+DEFINE_int32(rle_num_values, 4 * 1024 * 1024,
+             "Number of values to encode and decode in each RLE benchmark case");
 
 namespace kudu {
 
@@ -101,6 +108,49 @@ void BooleanRLE() {
   }
 }
 
+// Generate FLAGS_rle_num_values values of 'bit_width' bits, where each value
+// repeats 'run_length' times. run_length == 1 yields a stream of literal
+// runs (the bit-packing fast path); longer run lengths shift the mix towards
+// repeated runs.
+std::vector<uint64_t> GenerateValues(int bit_width, int run_length) {
+  const uint64_t mod = bit_width == 64 ? 0 : 1ULL << bit_width;
+  const size_t num_values = FLAGS_rle_num_values;
+  std::vector<uint64_t> values;
+  values.reserve(num_values);
+  while (values.size() < num_values) {
+    uint64_t v = (static_cast<uint64_t>(random()) << 32) | random();
+    if (mod != 0) v %= mod;
+    for (int i = 0; i < run_length && values.size() < num_values; i++) {
+      values.push_back(v);
+    }
+  }
+  return values;
+}
+
+// Measure encoding (via Put) and batched decoding (via GetBatch) of
+// 'bit_width'-bit values with the given run-length distribution.
+void ValueRle(int bit_width, int run_length) {
+  const std::vector<uint64_t> values = GenerateValues(bit_width, run_length);
+  faststring buffer;
+  RleEncoder<uint64_t> encoder(&buffer, bit_width);
+
+  LOG_TIMING(INFO, strings::Substitute("encode width=$0 run=$1", bit_width, run_length)) {
+    for (uint64_t v : values) {
+      encoder.Put(v);
+    }
+    encoder.Flush();
+  }
+  LOG(INFO) << "Wrote " << encoder.len() << " bytes";
+
+  std::vector<uint64_t> decoded(values.size());
+  LOG_TIMING(INFO, strings::Substitute("decode width=$0 run=$1", bit_width, run_length)) {
+    RleDecoder<uint64_t> decoder(buffer.data(), encoder.len(), bit_width);
+    size_t n = decoder.GetBatch(decoded.data(), decoded.size());
+    CHECK_EQ(decoded.size(), n);
+  }
+  CHECK(decoded == values);
+}
+
 } // namespace kudu
 
 int main(int argc, char **argv) {
@@ -116,5 +166,15 @@ int main(int argc, char **argv) {
     kudu::BooleanRLE();
   }
 
+  // Cover the power-of-2 bit widths (which have a BMI2 bulk-packing fast
+  // path for widths <= 8) as well as a couple of non-power-of-2 widths,
+  // across run-length distributions from pure literal runs to long
+  // repeated runs.
+  for (int bit_width : {1, 2, 4, 8, 13, 16, 32}) {
+    for (int run_length : {1, 4, 100}) {
+      kudu::ValueRle(bit_width, run_length);
+    }
+  }
+
   return 0;
 }
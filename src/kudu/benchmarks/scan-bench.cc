@@ -0,0 +1,268 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+//
+// End-to-end benchmark for the tablet scan path.
+//
+// Unlike the other benchmarks in this directory, which exercise isolated
+// encodings or the WAL, this harness constructs a full tablet with a
+// parameterized shape -- a configurable number of (optionally overlapping)
+// rowsets, a configurable depth of delta history per row, and a
+// configurable number of value columns with a chosen encoding -- and then
+// times full scans over it. For each scan it reports rows/sec, cycles/row,
+// and the per-column IteratorStats breakdown (blocks, cells and bytes read
+// from disk), which is where time goes when the merge or delta-apply paths
+// dominate.
+//
+// Typical invocations:
+//
+//   Many overlapping rowsets (stresses the merge path):
+//     scan-bench --num_rowsets=32 --overlap_rowsets
+//
+//   Deep delta chains (stresses delta application):
+//     scan-bench --num_rowsets=4 --updates_per_row=16
+//
+//   Wide rows, narrow projection (stresses column selection):
+//     scan-bench --num_value_cols=32 --num_projected_cols=1
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "kudu/common/common.pb.h"
+#include "kudu/common/iterator.h"
+#include "kudu/common/iterator_stats.h"
+#include "kudu/common/partial_row.h"
+#include "kudu/common/rowblock.h"
+#include "kudu/common/schema.h"
+#include "kudu/gutil/basictypes.h"
+#include "kudu/gutil/gscoped_ptr.h"
+#include "kudu/gutil/walltime.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/tablet/local_tablet_writer.h"
+#include "kudu/tablet/tablet-harness.h"
+#include "kudu/tablet/tablet.h"
+#include "kudu/util/env.h"
+#include "kudu/util/logging.h"
+#include "kudu/util/memory/arena.h"
+#include "kudu/util/status.h"
+#include "kudu/util/stopwatch.h"
+
+DEFINE_string(scan_bench_dir, "/tmp/kudu-scan-bench",
+              "Directory in which to store the benchmark tablet's data. "
+              "Deleted and recreated on startup.");
+DEFINE_int32(num_rowsets, 10, "Number of disk rowsets to create");
+DEFINE_int32(rows_per_rowset, 100000, "Number of rows to insert per rowset");
+DEFINE_bool(overlap_rowsets, true,
+            "Whether the rowsets' key ranges should fully overlap (forcing a "
+            "merge on ordered scans and per-rowset bloom checks on writes) or "
+            "be disjoint");
+DEFINE_int32(updates_per_row, 0,
+             "Number of times to update each row after the initial load, "
+             "building up a delta chain of that depth on every row");
+DEFINE_bool(flush_deltas, true,
+            "Whether to flush the delta memstores to delta files after each "
+            "round of updates");
+DEFINE_int32(num_value_cols, 4, "Number of INT32 value columns in the schema");
+DEFINE_string(value_encoding, "BIT_SHUFFLE",
+              "Encoding for the value columns: one of PLAIN_ENCODING, RLE or "
+              "BIT_SHUFFLE");
+DEFINE_int32(num_projected_cols, -1,
+             "Number of value columns to project in the scans. The key column "
+             "is always projected. -1 means project all columns");
+DEFINE_int32(num_iters, 3, "Number of times to scan the tablet");
+
+using std::vector;
+using strings::Substitute;
+
+namespace kudu {
+namespace tablet {
+
+namespace {
+
+Status BuildSchema(Schema* schema) {
+  EncodingType encoding;
+  if (!EncodingType_Parse(FLAGS_value_encoding, &encoding)) {
+    return Status::InvalidArgument("invalid encoding", FLAGS_value_encoding);
+  }
+  SchemaBuilder builder;
+  RETURN_NOT_OK(builder.AddKeyColumn("key", INT64));
+  for (int i = 0; i < FLAGS_num_value_cols; i++) {
+    RETURN_NOT_OK(builder.AddColumn(
+        ColumnSchema(Substitute("int_col$0", i), INT32, false, nullptr, nullptr,
+                     ColumnStorageAttributes(encoding, DEFAULT_COMPRESSION)),
+        /* is_key= */ false));
+  }
+  *schema = builder.Build();
+  return Status::OK();
+}
+
+// Insert the rows for rowset 'rowset_idx' and flush it. With
+// --overlap_rowsets, each rowset receives every num_rowsets'th key, so all
+// rowsets span the entire key range; otherwise each rowset covers its own
+// contiguous chunk of the key space.
+Status LoadRowSet(Tablet* tablet, const Schema& client_schema, int rowset_idx) {
+  LocalTabletWriter writer(tablet, &client_schema);
+  KuduPartialRow row(&client_schema);
+  for (int i = 0; i < FLAGS_rows_per_rowset; i++) {
+    int64_t key;
+    if (FLAGS_overlap_rowsets) {
+      key = static_cast<int64_t>(i) * FLAGS_num_rowsets + rowset_idx;
+    } else {
+      key = static_cast<int64_t>(rowset_idx) * FLAGS_rows_per_rowset + i;
+    }
+    RETURN_NOT_OK(row.SetInt64("key", key));
+    for (int c = 0; c < FLAGS_num_value_cols; c++) {
+      RETURN_NOT_OK(row.SetInt32(Substitute("int_col$0", c),
+                                 static_cast<int32_t>(key + c)));
+    }
+    RETURN_NOT_OK(writer.Insert(row));
+  }
+  return tablet->Flush();
+}
+
+// Apply one round of updates to every row, incrementing the delta chain
+// depth of each row by one.
+Status UpdateAllRows(Tablet* tablet, const Schema& client_schema, int round) {
+  LocalTabletWriter writer(tablet, &client_schema);
+  KuduPartialRow row(&client_schema);
+  int64_t num_rows = static_cast<int64_t>(FLAGS_num_rowsets) * FLAGS_rows_per_rowset;
+  for (int64_t key = 0; key < num_rows; key++) {
+    RETURN_NOT_OK(row.SetInt64("key", key));
+    RETURN_NOT_OK(row.SetInt32("int_col0", static_cast<int32_t>(key + round + 1)));
+    RETURN_NOT_OK(writer.Update(row));
+  }
+  if (FLAGS_flush_deltas) {
+    for (int i = 0; i < FLAGS_num_rowsets; i++) {
+      RETURN_NOT_OK(tablet->FlushBiggestDMS());
+    }
+  }
+  return Status::OK();
+}
+
+// Scan the whole tablet once with the given projection, logging throughput
+// and the per-column iterator stats.
+Status ScanTablet(Tablet* tablet, const Schema& projection, int iter_num) {
+  gscoped_ptr<RowwiseIterator> iter;
+  RETURN_NOT_OK(tablet->NewRowIterator(projection, &iter));
+  RETURN_NOT_OK(iter->Init(nullptr));
+
+  Arena arena(32 * 1024);
+  RowBlock block(projection, 1024, &arena);
+  int64_t rows_scanned = 0;
+
+  Stopwatch sw(Stopwatch::THIS_THREAD);
+  int64_t start_cycles = CycleClock::Now();
+  sw.start();
+  while (iter->HasNext()) {
+    arena.Reset();
+    RETURN_NOT_OK(iter->NextBlock(&block));
+    rows_scanned += block.selection_vector()->CountSelected();
+  }
+  sw.stop();
+  int64_t cycles = CycleClock::Now() - start_cycles;
+
+  double wall_secs = sw.elapsed().wall_seconds();
+  LOG(INFO) << Substitute(
+      "iter $0: scanned $1 rows in $2s: $3 rows/sec, $4 cycles/row",
+      iter_num, rows_scanned, wall_secs,
+      static_cast<int64_t>(rows_scanned / wall_secs),
+      rows_scanned > 0 ? cycles / rows_scanned : 0);
+
+  vector<IteratorStats> stats;
+  iter->GetIteratorStats(&stats);
+  CHECK_EQ(stats.size(), projection.num_columns());
+  for (int i = 0; i < stats.size(); i++) {
+    LOG(INFO) << Substitute("  column '$0': $1",
+                            projection.column(i).name(),
+                            stats[i].ToString());
+  }
+  return Status::OK();
+}
+
+Status RunScanBench() {
+  Env* env = Env::Default();
+  ignore_result(env->DeleteRecursively(FLAGS_scan_bench_dir));
+
+  Schema schema;
+  RETURN_NOT_OK(BuildSchema(&schema));
+  Schema client_schema = schema.CopyWithoutColumnIds();
+
+  TabletHarness harness(schema, TabletHarness::Options(FLAGS_scan_bench_dir));
+  RETURN_NOT_OK(harness.Create(true));
+  RETURN_NOT_OK(harness.Open());
+  Tablet* tablet = harness.tablet().get();
+
+  LOG_TIMING(INFO, Substitute("loading $0 rowsets of $1 rows",
+                              FLAGS_num_rowsets, FLAGS_rows_per_rowset)) {
+    for (int i = 0; i < FLAGS_num_rowsets; i++) {
+      RETURN_NOT_OK(LoadRowSet(tablet, client_schema, i));
+    }
+  }
+
+  if (FLAGS_updates_per_row > 0) {
+    LOG_TIMING(INFO, Substitute("applying $0 rounds of updates",
+                                FLAGS_updates_per_row)) {
+      for (int round = 0; round < FLAGS_updates_per_row; round++) {
+        RETURN_NOT_OK(UpdateAllRows(tablet, client_schema, round));
+      }
+    }
+  }
+
+  // Build the scan projection: the key column plus the first
+  // --num_projected_cols value columns.
+  Schema projection;
+  if (FLAGS_num_projected_cols < 0) {
+    projection = client_schema;
+  } else {
+    vector<ColumnSchema> cols;
+    cols.push_back(client_schema.column(0));
+    for (int i = 0; i < FLAGS_num_projected_cols; i++) {
+      cols.push_back(client_schema.column(1 + i));
+    }
+    projection = Schema(cols, 1);
+  }
+
+  for (int i = 0; i < FLAGS_num_iters; i++) {
+    RETURN_NOT_OK(ScanTablet(tablet, projection, i));
+  }
+  return Status::OK();
+}
+
+} // anonymous namespace
+} // namespace tablet
+} // namespace kudu
+
+int main(int argc, char** argv) {
+  FLAGS_logtostderr = 1;
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  kudu::InitGoogleLoggingSafe(argv[0]);
+
+  CHECK_GE(FLAGS_num_projected_cols, -1);
+  CHECK_LE(FLAGS_num_projected_cols, FLAGS_num_value_cols);
+
+  kudu::Status s = kudu::tablet::RunScanBench();
+  if (!s.ok()) {
+    LOG(ERROR) << "Scan benchmark failed: " << s.ToString();
+    return 1;
+  }
+  return 0;
+}
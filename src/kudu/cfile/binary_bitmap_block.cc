@@ -0,0 +1,358 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/cfile/binary_bitmap_block.h"
+
+#include <algorithm>
+#include <limits>
+#include <string>
+
+#include <glog/logging.h>
+
+#include "kudu/cfile/cfile_util.h"
+#include "kudu/common/column_materialization_context.h"
+#include "kudu/common/column_predicate.h"
+#include "kudu/common/columnblock.h"
+#include "kudu/common/common.pb.h"
+#include "kudu/common/rowblock.h"
+#include "kudu/common/schema.h"
+#include "kudu/common/types.h"
+#include "kudu/gutil/map-util.h"
+#include "kudu/gutil/strings/stringpiece.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/bitmap.h"
+#include "kudu/util/coding.h"
+#include "kudu/util/coding-inl.h"
+#include "kudu/util/memory/arena.h"
+
+namespace kudu {
+namespace cfile {
+
+BinaryBitmapBlockBuilder::BinaryBitmapBlockBuilder(const WriterOptions* options)
+    : options_(options),
+      dict_builder_(options_),
+      dictionary_strings_arena_(1024) {
+  // We use this invalid StringPiece for the "empty key". It's safe to build such
+  // a string and use it in equality comparisons.
+  dictionary_.set_empty_key(StringPiece(static_cast<const char*>(nullptr),
+                                        std::numeric_limits<int>::max()));
+  Reset();
+}
+
+void BinaryBitmapBlockBuilder::Reset() {
+  buffer_.clear();
+  buffer_.resize(kMaxHeaderSize);
+  buffer_.reserve(options_->storage_attributes.cfile_block_size);
+
+  dict_builder_.Reset();
+  dictionary_.clear();
+  dictionary_strings_arena_.Reset();
+  bitmaps_.clear();
+
+  count_ = 0;
+  dict_size_estimate_ = BinaryPlainBlockBuilder::kMaxHeaderSize;
+  first_codeword_ = 0;
+  last_codeword_ = 0;
+  finished_ = false;
+}
+
+bool BinaryBitmapBlockBuilder::IsBlockFull() const {
+  size_t size_estimate = kMaxHeaderSize +
+      bitmaps_.size() * BitmapSize(count_) +
+      dict_size_estimate_;
+  return size_estimate > options_->storage_attributes.cfile_block_size;
+}
+
+int BinaryBitmapBlockBuilder::Add(const uint8_t* vals, size_t count) {
+  DCHECK(!finished_);
+  DCHECK_GT(count, 0);
+  size_t i;
+
+  const Slice* src = reinterpret_cast<const Slice*>(vals);
+  for (i = 0; i < count && !IsBlockFull(); i++, src++) {
+    const char* c_str = reinterpret_cast<const char*>(src->data());
+    StringPiece current_item(c_str, src->size());
+    uint32_t codeword;
+
+    if (PREDICT_FALSE(!FindCopy(dictionary_, current_item, &codeword))) {
+      // Not already in the dictionary, try to add it if there is space.
+      if (PREDICT_FALSE(!AddToDict(*src, &codeword))) {
+        break;
+      }
+    }
+
+    std::vector<uint8_t>* bitmap = &bitmaps_[codeword];
+    size_t byte_idx = count_ >> 3;
+    if (bitmap->size() <= byte_idx) {
+      bitmap->resize(byte_idx + 1, 0);
+    }
+    BitmapSet(bitmap->data(), count_);
+
+    if (count_ == 0) {
+      first_codeword_ = codeword;
+    }
+    last_codeword_ = codeword;
+    count_++;
+  }
+  return i;
+}
+
+bool BinaryBitmapBlockBuilder::AddToDict(Slice val, uint32_t* codeword) {
+  if (PREDICT_FALSE(dict_builder_.Add(reinterpret_cast<const uint8_t*>(&val), 1) == 0)) {
+    // The dictionary block is full.
+    return false;
+  }
+  const uint8_t* s_ptr = CHECK_NOTNULL(dictionary_strings_arena_.AddSlice(val));
+  const char* s_content = reinterpret_cast<const char*>(s_ptr);
+  *codeword = dict_builder_.Count() - 1;
+  InsertOrDie(&dictionary_, StringPiece(s_content, val.size()), *codeword);
+  bitmaps_.emplace_back();
+  dict_size_estimate_ += val.size() + sizeof(uint32_t);
+  return true;
+}
+
+Slice BinaryBitmapBlockBuilder::Finish(rowid_t ordinal_pos) {
+  finished_ = true;
+
+  InlineEncodeFixed32(&buffer_[0], ordinal_pos);
+  InlineEncodeFixed32(&buffer_[4], count_);
+  InlineEncodeFixed32(&buffer_[8], bitmaps_.size());
+
+  // Append the bitmaps, padded out to a common size.
+  const size_t stride = BitmapSize(count_);
+  for (std::vector<uint8_t>& bitmap : bitmaps_) {
+    bitmap.resize(stride, 0);
+    buffer_.append(bitmap.data(), stride);
+  }
+
+  InlineEncodeFixed32(&buffer_[12], buffer_.size());
+  Slice dict_slice = dict_builder_.Finish(0);
+  buffer_.append(dict_slice.data(), dict_slice.size());
+
+  return Slice(buffer_);
+}
+
+size_t BinaryBitmapBlockBuilder::Count() const {
+  return count_;
+}
+
+Status BinaryBitmapBlockBuilder::GetFirstKey(void* key_void) const {
+  CHECK(finished_);
+  if (count_ == 0) {
+    return Status::NotFound("no keys in data block");
+  }
+  return dict_builder_.GetKeyAtIdx(key_void, first_codeword_);
+}
+
+Status BinaryBitmapBlockBuilder::GetLastKey(void* key_void) const {
+  CHECK(finished_);
+  if (count_ == 0) {
+    return Status::NotFound("no keys in data block");
+  }
+  return dict_builder_.GetKeyAtIdx(key_void, last_codeword_);
+}
+
+////////////////////////////////////////////////////////////
+// Decoding
+////////////////////////////////////////////////////////////
+
+BinaryBitmapBlockDecoder::BinaryBitmapBlockDecoder(Slice slice)
+    : data_(slice),
+      parsed_(false),
+      num_elems_(0),
+      num_values_(0),
+      bitmap_stride_(0),
+      ordinal_pos_base_(0),
+      cur_idx_(0),
+      evaluated_pred_(nullptr),
+      num_matching_values_(0),
+      only_matching_value_(0) {
+}
+
+Status BinaryBitmapBlockDecoder::ParseHeader() {
+  CHECK(!parsed_);
+
+  if (data_.size() < kMinHeaderSize) {
+    return Status::Corruption(
+      strings::Substitute("not enough bytes for header: bitmap block header "
+        "size ($0) less than minimum possible header length ($1)",
+        data_.size(), kMinHeaderSize));
+  }
+
+  // Decode header.
+  ordinal_pos_base_ = DecodeFixed32(&data_[0]);
+  num_elems_        = DecodeFixed32(&data_[4]);
+  num_values_       = DecodeFixed32(&data_[8]);
+  size_t dict_pos   = DecodeFixed32(&data_[12]);
+  bitmap_stride_    = BitmapSize(num_elems_);
+
+  // Sanity check.
+  if (dict_pos > data_.size() ||
+      kMinHeaderSize + num_values_ * bitmap_stride_ > dict_pos) {
+    return Status::Corruption(
+      strings::Substitute("bad dictionary position $0 in bitmap block of size $1 "
+        "with $2 values and $3 elements",
+        dict_pos, data_.size(), num_values_, num_elems_));
+  }
+
+  dict_decoder_.reset(new BinaryPlainBlockDecoder(
+      Slice(data_.data() + dict_pos, data_.size() - dict_pos)));
+  RETURN_NOT_OK_PREPEND(dict_decoder_->ParseHeader(),
+                        "unable to parse the embedded dictionary");
+  if (dict_decoder_->Count() != num_values_) {
+    return Status::Corruption(
+      strings::Substitute("embedded dictionary has $0 entries, expected $1",
+        dict_decoder_->Count(), num_values_));
+  }
+
+  parsed_ = true;
+  return Status::OK();
+}
+
+void BinaryBitmapBlockDecoder::SeekToPositionInBlock(uint pos) {
+  if (PREDICT_FALSE(num_elems_ == 0)) {
+    DCHECK_EQ(0, pos);
+    return;
+  }
+
+  DCHECK_LE(pos, num_elems_);
+  cur_idx_ = pos;
+}
+
+Status BinaryBitmapBlockDecoder::SeekAtOrAfterValue(const void* value_void, bool* exact) {
+  return Status::NotSupported("bitmap encoded blocks do not support value-based seeks");
+}
+
+void BinaryBitmapBlockDecoder::MaterializeCodewords() {
+  if (!codewords_.empty() || num_elems_ == 0) {
+    return;
+  }
+  codewords_.resize(num_elems_);
+  for (uint32_t v = 0; v < num_values_; v++) {
+    const uint8_t* bitmap = bitmap_for_value(v);
+    size_t idx = 0;
+    while (idx < num_elems_ && BitmapFindFirstSet(bitmap, idx, num_elems_, &idx)) {
+      codewords_[idx] = v;
+      idx++;
+    }
+  }
+}
+
+void BinaryBitmapBlockDecoder::EvaluatePredicate(const ColumnPredicate* pred) {
+  if (evaluated_pred_ == pred) {
+    return;
+  }
+  evaluated_pred_ = pred;
+  num_matching_values_ = 0;
+  only_matching_value_ = 0;
+  pred_match_bitmap_.assign(bitmap_stride_, 0);
+  for (uint32_t v = 0; v < num_values_; v++) {
+    Slice word = dict_decoder_->string_at_index(v);
+    if (pred->EvaluateCell<BINARY>(static_cast<const void*>(&word))) {
+      num_matching_values_++;
+      only_matching_value_ = v;
+      BitmapMergeOr(pred_match_bitmap_.data(), bitmap_for_value(v), num_elems_);
+    }
+  }
+}
+
+Status BinaryBitmapBlockDecoder::CopyNextValues(size_t* n, ColumnDataView* dst) {
+  DCHECK(parsed_);
+  CHECK_EQ(dst->type_info()->physical_type(), BINARY);
+  DCHECK_LE(*n, dst->nrows());
+  DCHECK_EQ(dst->stride(), sizeof(Slice));
+  if (PREDICT_FALSE(*n == 0 || cur_idx_ >= num_elems_)) {
+    *n = 0;
+    return Status::OK();
+  }
+  MaterializeCodewords();
+  size_t max_fetch = std::min(*n, static_cast<size_t>(num_elems_ - cur_idx_));
+
+  Arena* out_arena = dst->arena();
+  Slice* out = reinterpret_cast<Slice*>(dst->data());
+  for (size_t i = 0; i < max_fetch; i++, out++, cur_idx_++) {
+    Slice elem = dict_decoder_->string_at_index(codewords_[cur_idx_]);
+    CHECK(out_arena->RelocateSlice(elem, out));
+  }
+  *n = max_fetch;
+  return Status::OK();
+}
+
+Status BinaryBitmapBlockDecoder::CopyNextAndEval(size_t* n,
+                                                 ColumnMaterializationContext* ctx,
+                                                 SelectionVectorView* sel,
+                                                 ColumnDataView* dst) {
+  ctx->SetDecoderEvalSupported();
+  DCHECK(parsed_);
+  EvaluatePredicate(ctx->pred());
+
+  // Predicates that have no matching dictionary entries should return no
+  // data: move forward and clear the corresponding selection bits.
+  if (num_matching_values_ == 0) {
+    int skip = static_cast<int>(*n);
+    SeekForward(&skip);
+    *n = static_cast<size_t>(skip);
+    sel->ClearBits(*n);
+    return Status::OK();
+  }
+
+  // Predicates matched by every dictionary entry select all rows, so
+  // there's no point testing each row's bit.
+  if (num_matching_values_ == num_values_) {
+    return CopyNextValues(n, dst);
+  }
+
+  CHECK_EQ(dst->type_info()->physical_type(), BINARY);
+  DCHECK_LE(*n, dst->nrows());
+  DCHECK_EQ(dst->stride(), sizeof(Slice));
+  if (PREDICT_FALSE(*n == 0 || cur_idx_ >= num_elems_)) {
+    *n = 0;
+    return Status::OK();
+  }
+  size_t max_fetch = std::min(*n, static_cast<size_t>(num_elems_ - cur_idx_));
+
+  // When a single dictionary entry matches (the common equality case),
+  // every selected row holds that entry and the per-row codewords are not
+  // needed at all.
+  const bool single_value = num_matching_values_ == 1;
+  if (!single_value) {
+    MaterializeCodewords();
+  }
+
+  Arena* out_arena = dst->arena();
+  Slice* out = reinterpret_cast<Slice*>(dst->data());
+  for (size_t i = 0; i < max_fetch; i++, out++, cur_idx_++) {
+    // Check with the SelectionVectorView to see whether the row has already
+    // been cleared, in which case we can skip evaluation.
+    if (!sel->TestBit(i)) {
+      continue;
+    }
+    if (BitmapTest(pred_match_bitmap_.data(), cur_idx_)) {
+      Slice elem = dict_decoder_->string_at_index(
+          single_value ? only_matching_value_ : codewords_[cur_idx_]);
+      CHECK(out_arena->RelocateSlice(elem, out));
+    } else {
+      // Mark that the row will not be returned.
+      sel->ClearBit(i);
+    }
+  }
+  *n = max_fetch;
+  return Status::OK();
+}
+
+} // namespace cfile
+} // namespace kudu
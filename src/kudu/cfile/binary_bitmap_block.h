@@ -0,0 +1,220 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+//
+// Bitmap encoding for low-cardinality binary columns (e.g. enum-like
+// "status" or "country" columns). Each block embeds a small dictionary
+// of the distinct values it contains and stores one bitmap per distinct
+// value, marking the rows which hold that value.
+//
+// layout for a bitmap encoded block:
+// Header:
+//   ordinal_pos (32-bit fixed)
+//   num_elems (32-bit fixed)
+//   num_values (32-bit fixed): the number of distinct values in the block
+//   dict_pos (32-bit fixed): position of the embedded dictionary,
+//     relative to the block start
+// Bitmaps:
+//   num_values bitmaps of BitmapSize(num_elems) bytes each, in codeword
+//   order. Bit i of bitmap v is set iff row i holds dictionary entry v.
+// Dictionary: [pointed to by dict_pos]
+//   the distinct values in codeword order, encoded as a BinaryPlainBlock.
+//
+// With decoder-level evaluation enabled, equality and IN-list predicates
+// are resolved by unioning the bitmaps of the matching dictionary
+// entries, so non-matching rows are deselected without decoding any row
+// data. Values are not stored in sorted order, so this encoding does not
+// support value-based seeks and must not be used for key columns.
+
+#ifndef KUDU_CFILE_BINARY_BITMAP_BLOCK_H
+#define KUDU_CFILE_BINARY_BITMAP_BLOCK_H
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <sparsehash/dense_hash_map>
+
+#include "kudu/cfile/binary_plain_block.h"
+#include "kudu/cfile/block_encodings.h"
+#include "kudu/common/rowid.h"
+#include "kudu/gutil/gscoped_ptr.h"
+#include "kudu/gutil/macros.h"
+#include "kudu/gutil/port.h"
+#include "kudu/gutil/strings/stringpiece.h"
+#include "kudu/util/faststring.h"
+#include "kudu/util/memory/arena.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+
+template <class X>
+struct GoodFastHash;
+
+namespace kudu {
+
+class ColumnDataView;
+class ColumnMaterializationContext;
+class ColumnPredicate;
+class SelectionVectorView;
+
+namespace cfile {
+
+struct WriterOptions;
+
+class BinaryBitmapBlockBuilder final : public BlockBuilder {
+ public:
+  explicit BinaryBitmapBlockBuilder(const WriterOptions* options);
+
+  bool IsBlockFull() const override;
+
+  int Add(const uint8_t* vals, size_t count) OVERRIDE;
+
+  Slice Finish(rowid_t ordinal_pos) OVERRIDE;
+
+  void Reset() OVERRIDE;
+
+  size_t Count() const OVERRIDE;
+
+  Status GetFirstKey(void* key) const OVERRIDE;
+
+  Status GetLastKey(void* key) const OVERRIDE;
+
+  static const size_t kMaxHeaderSize = sizeof(uint32_t) * 4;
+
+ private:
+  // Add 'val' as a new dictionary entry, assigning it the next codeword.
+  // Returns false if the embedded dictionary is full.
+  ATTRIBUTE_COLD
+  bool AddToDict(Slice val, uint32_t* codeword);
+
+  faststring buffer_;
+  bool finished_;
+  const WriterOptions* options_;
+
+  // The distinct values added so far, in codeword order. Unlike the
+  // cfile-wide dictionary used by dictionary encoding, the dictionary
+  // here is per-block, and is cleared by Reset().
+  BinaryPlainBlockBuilder dict_builder_;
+
+  google::dense_hash_map<StringPiece, uint32_t, GoodFastHash<StringPiece> > dictionary_;
+  // Memory to hold the actual content for strings in the dictionary_.
+  Arena dictionary_strings_arena_;
+
+  // One bitmap per dictionary entry. The bitmaps are grown lazily as rows
+  // are added and padded out to a common size in Finish().
+  std::vector<std::vector<uint8_t> > bitmaps_;
+
+  // Number of rows added to the block so far.
+  size_t count_;
+
+  // Estimated encoded size of the embedded dictionary.
+  size_t dict_size_estimate_;
+
+  // Codewords of the first and last rows added, for GetFirstKey()/GetLastKey().
+  uint32_t first_codeword_;
+  uint32_t last_codeword_;
+};
+
+class BinaryBitmapBlockDecoder final : public BlockDecoder {
+ public:
+  explicit BinaryBitmapBlockDecoder(Slice slice);
+
+  virtual Status ParseHeader() OVERRIDE;
+  virtual void SeekToPositionInBlock(uint pos) OVERRIDE;
+
+  // Always returns Status::NotSupported: the values in a bitmap encoded
+  // block are not stored in sorted order.
+  virtual Status SeekAtOrAfterValue(const void* value, bool* exact_match) OVERRIDE;
+
+  Status CopyNextValues(size_t* n, ColumnDataView* dst) OVERRIDE;
+  Status CopyNextAndEval(size_t* n,
+                         ColumnMaterializationContext* ctx,
+                         SelectionVectorView* sel,
+                         ColumnDataView* dst) override;
+
+  virtual bool HasNext() const OVERRIDE {
+    DCHECK(parsed_);
+    return cur_idx_ < num_elems_;
+  }
+
+  virtual size_t Count() const OVERRIDE {
+    DCHECK(parsed_);
+    return num_elems_;
+  }
+
+  virtual size_t GetCurrentIndex() const OVERRIDE {
+    DCHECK(parsed_);
+    return cur_idx_;
+  }
+
+  virtual rowid_t GetFirstRowId() const OVERRIDE {
+    return ordinal_pos_base_;
+  }
+
+  static const size_t kMinHeaderSize = sizeof(uint32_t) * 4;
+
+ private:
+  // Return a pointer to the bitmap for dictionary entry 'v'.
+  const uint8_t* bitmap_for_value(uint32_t v) const {
+    return data_.data() + kMinHeaderSize + v * bitmap_stride_;
+  }
+
+  // Fill 'codewords_' with the per-row codewords, reconstructed from the
+  // per-value bitmaps. Only needed when row values are actually decoded.
+  void MaterializeCodewords();
+
+  // Evaluate 'pred' against the dictionary entries, computing the union of
+  // the bitmaps of the matching entries. The result is cached: each block
+  // is only ever scanned with a single predicate.
+  void EvaluatePredicate(const ColumnPredicate* pred);
+
+  Slice data_;
+  bool parsed_;
+
+  gscoped_ptr<BinaryPlainBlockDecoder> dict_decoder_;
+
+  uint32_t num_elems_;
+  uint32_t num_values_;
+  size_t bitmap_stride_;
+  rowid_t ordinal_pos_base_;
+
+  // Index of the currently seeked element in the block.
+  uint32_t cur_idx_;
+
+  // Per-row codewords, lazily materialized by MaterializeCodewords().
+  std::vector<uint32_t> codewords_;
+
+  // The predicate which 'pred_match_bitmap_' was computed for, or NULL if
+  // no predicate has been evaluated yet.
+  const ColumnPredicate* evaluated_pred_;
+
+  // Union of the bitmaps of the dictionary entries matching 'evaluated_pred_':
+  // bit i is set iff row i satisfies the predicate.
+  std::vector<uint8_t> pred_match_bitmap_;
+
+  // The number of dictionary entries matching 'evaluated_pred_', and, if
+  // exactly one entry matches, its codeword. In the common equality case
+  // this allows copying the matching value without materializing codewords.
+  uint32_t num_matching_values_;
+  uint32_t only_matching_value_;
+};
+
+} // namespace cfile
+} // namespace kudu
+
+#endif // KUDU_CFILE_BINARY_BITMAP_BLOCK_H
@@ -22,6 +22,7 @@
 #include <string>
 #include <vector>
 
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 
 #include "kudu/cfile/block_pointer.h"
@@ -44,14 +45,41 @@
 #include "kudu/util/bitmap.h"
 #include "kudu/util/coding.h"
 #include "kudu/util/coding-inl.h"
+#include "kudu/util/flag_tags.h"
 #include "kudu/util/memory/arena.h"
 
+DEFINE_int32(cfile_dictionary_block_size, 0,
+             "The maximum size (in bytes) of the dictionary block in a "
+             "dictionary-encoded cfile. Once the dictionary reaches this "
+             "size, subsequent data blocks in the file fall back to plain "
+             "encoding. A value of 0 means to use the column's cfile block "
+             "size. Because the dictionary is written and read as a single "
+             "block, larger values trade memory for better encoding of "
+             "higher-cardinality columns.");
+TAG_FLAG(cfile_dictionary_block_size, advanced);
+TAG_FLAG(cfile_dictionary_block_size, experimental);
+
 namespace kudu {
 namespace cfile {
 
+namespace {
+
+// Return the options to use for the dictionary block, which inherit
+// everything from the data block options except possibly the size limit.
+WriterOptions DictBlockOptions(const WriterOptions& options) {
+  WriterOptions ret = options;
+  if (FLAGS_cfile_dictionary_block_size > 0) {
+    ret.storage_attributes.cfile_block_size = FLAGS_cfile_dictionary_block_size;
+  }
+  return ret;
+}
+
+} // anonymous namespace
+
 BinaryDictBlockBuilder::BinaryDictBlockBuilder(const WriterOptions* options)
     : options_(options),
-      dict_block_(options_),
+      dict_options_(DictBlockOptions(*options)),
+      dict_block_(&dict_options_),
       dictionary_strings_arena_(1024),
       mode_(kCodeWordMode) {
   data_builder_.reset(new BShufBlockBuilder<UINT32>(options_));
@@ -92,8 +120,8 @@ Slice BinaryDictBlockBuilder::Finish(rowid_t ordinal_pos) {
 }
 
 // The current block is considered full when the the size of data block
-// exceeds limit or when the size of dictionary block exceeds the
-// CFile block size.
+// exceeds limit or when the size of dictionary block exceeds its own
+// size limit.
 //
 // If it is the latter case, all the subsequent data blocks will switch to
 // StringPlainBlock automatically.
@@ -225,21 +253,26 @@ Status BinaryDictBlockDecoder::ParseHeader() {
   Slice content(data_.data() + 4, data_.size() - 4);
 
   if (mode_ == kCodeWordMode) {
-    data_decoder_.reset(new BShufBlockDecoder<UINT32>(content));
+    codeword_decoder_.reset(new BShufBlockDecoder<UINT32>(content));
+    RETURN_NOT_OK(codeword_decoder_->ParseHeader());
   } else {
     if (mode_ != kPlainBinaryMode) {
       return Status::Corruption("Unrecognized Dictionary encoded data block header");
     }
-    data_decoder_.reset(new BinaryPlainBlockDecoder(content));
+    plain_decoder_.reset(new BinaryPlainBlockDecoder(content));
+    RETURN_NOT_OK(plain_decoder_->ParseHeader());
   }
 
-  RETURN_NOT_OK(data_decoder_->ParseHeader());
   parsed_ = true;
   return Status::OK();
 }
 
 void BinaryDictBlockDecoder::SeekToPositionInBlock(uint pos) {
-  data_decoder_->SeekToPositionInBlock(pos);
+  if (mode_ == kCodeWordMode) {
+    codeword_decoder_->SeekToPositionInBlock(pos);
+  } else {
+    plain_decoder_->SeekToPositionInBlock(pos);
+  }
 }
 
 Status BinaryDictBlockDecoder::SeekAtOrAfterValue(const void* value_void, bool* exact) {
@@ -251,16 +284,16 @@ Status BinaryDictBlockDecoder::SeekAtOrAfterValue(const void* value_void, bool*
       // in the dictionary block. Therefore, it is impossible to be in
       // the current data block, and we adjust the index to be the end
       // of the block
-      data_decoder_->SeekToPositionInBlock(data_decoder_->Count() - 1);
+      codeword_decoder_->SeekToPositionInBlock(codeword_decoder_->Count() - 1);
       return s;
     }
 
     size_t index = dict_decoder_->GetCurrentIndex();
     bool tmp;
-    return data_decoder_->SeekAtOrAfterValue(&index, &tmp);
+    return codeword_decoder_->SeekAtOrAfterValue(&index, &tmp);
   } else {
     DCHECK_EQ(mode_, kPlainBinaryMode);
-    return data_decoder_->SeekAtOrAfterValue(value_void, exact);
+    return plain_decoder_->SeekAtOrAfterValue(value_void, exact);
   }
 }
 
@@ -275,31 +308,34 @@ Status BinaryDictBlockDecoder::CopyNextAndEval(size_t* n,
   ctx->SetDecoderEvalSupported();
   if (mode_ == kPlainBinaryMode) {
     // Copy all strings and evaluate them Slice-by-Slice.
-    return data_decoder_->CopyNextAndEval(n, ctx, sel, dst);
+    return plain_decoder_->CopyNextAndEval(n, ctx, sel, dst);
   }
 
   // Predicates that have no matching words should return no data.
   SelectionVector* codewords_matching_pred = parent_cfile_iter_->GetCodeWordsMatchingPredicate();
   CHECK(codewords_matching_pred != nullptr);
   if (!codewords_matching_pred->AnySelected()) {
-    // If nothing is selected, move the data_decoder_ pointer forward and clear
+    // If nothing is selected, move the codeword decoder forward and clear
     // the corresponding bits in the selection vector.
     int skip = static_cast<int>(*n);
-    data_decoder_->SeekForward(&skip);
+    codeword_decoder_->SeekForward(&skip);
     *n = static_cast<size_t>(skip);
     sel->ClearBits(*n);
     return Status::OK();
   }
 
-  // IsNotNull predicates should return all data.
-  if (ctx->pred()->predicate_type() == PredicateType::IsNotNull) {
+  // IsNotNull predicates should return all data, as should predicates
+  // matched by every word in the vocabulary (common for wide range
+  // predicates over low-cardinality columns): in both cases there's no
+  // point testing each row's codeword.
+  if (ctx->pred()->predicate_type() == PredicateType::IsNotNull ||
+      parent_cfile_iter_->CodeWordsAllMatchPredicate()) {
     return CopyNextDecodeStrings(n, dst);
   }
 
   // Load the rows' codeword values into a buffer for scanning.
-  BShufBlockDecoder<UINT32>* d_bptr = down_cast<BShufBlockDecoder<UINT32>*>(data_decoder_.get());
   codeword_buf_.resize(*n * sizeof(uint32_t));
-  d_bptr->CopyNextValuesToArray(n, codeword_buf_.data());
+  codeword_decoder_->CopyNextValuesToArray(n, codeword_buf_.data());
   Slice* out = reinterpret_cast<Slice*>(dst->data());
   Arena* out_arena = dst->arena();
   for (size_t i = 0; i < *n; i++, out++) {
@@ -333,8 +369,7 @@ Status BinaryDictBlockDecoder::CopyNextDecodeStrings(size_t* n, ColumnDataView*
 
   // Copy the codewords into a temporary buffer first.
   // And then Copy the strings corresponding to the codewords to the destination buffer.
-  BShufBlockDecoder<UINT32>* d_bptr = down_cast<BShufBlockDecoder<UINT32>*>(data_decoder_.get());
-  RETURN_NOT_OK(d_bptr->CopyNextValuesToArray(n, codeword_buf_.data()));
+  RETURN_NOT_OK(codeword_decoder_->CopyNextValuesToArray(n, codeword_buf_.data()));
 
   for (int i = 0; i < *n; i++) {
     uint32_t codeword = *reinterpret_cast<uint32_t*>(&codeword_buf_[i*sizeof(uint32_t)]);
@@ -350,7 +385,7 @@ Status BinaryDictBlockDecoder::CopyNextValues(size_t* n, ColumnDataView* dst) {
     return CopyNextDecodeStrings(n, dst);
   } else {
     DCHECK_EQ(mode_, kPlainBinaryMode);
-    return data_decoder_->CopyNextValues(n, dst);
+    return plain_decoder_->CopyNextValues(n, dst);
   }
 }
 
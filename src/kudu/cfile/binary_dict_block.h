@@ -22,7 +22,8 @@
 //        int blockbuilder, when mode_ = kCodeWordMode.
 // Or     header + embedded StringPlainBlock, when mode_ = kPlainStringMode.
 // Data blocks start with mode_ = kCodeWordMode, when the the size of dictionary
-// block go beyond the option_->block_size, the subsequent data blocks will switch
+// block go beyond its size limit (--cfile_dictionary_block_size, defaulting to
+// the column's cfile block size), the subsequent data blocks will switch
 // to string plain block automatically.
 
 // You can embed any int block builder encoding formats, such as group-varint,
@@ -46,6 +47,8 @@
 #include "kudu/common/rowid.h"
 #include "kudu/cfile/block_encodings.h"
 #include "kudu/cfile/binary_plain_block.h"
+#include "kudu/cfile/bshuf_block.h"
+#include "kudu/cfile/cfile_util.h"
 #include "kudu/gutil/casts.h"
 #include "kudu/gutil/gscoped_ptr.h"
 #include "kudu/gutil/macros.h"
@@ -70,8 +73,6 @@ namespace cfile {
 class CFileFooterPB;
 class CFileWriter;
 
-struct WriterOptions;
-
 // Header Mode type
 enum DictEncodingMode {
   DictEncodingMode_min = 1,
@@ -119,6 +120,13 @@ class BinaryDictBlockBuilder final : public BlockBuilder {
   // dict_block_, dictionary_, dictionary_strings_arena_
   // is related to the dictionary block (one per cfile).
   // They should NOT be cleared in the Reset() method.
+
+  // Options for the dictionary block: a copy of *options_, except that the
+  // block size limit may be overridden by --cfile_dictionary_block_size so
+  // that the dictionary can grow larger than a data block and keep
+  // higher-cardinality columns in codeword mode for the whole file.
+  const WriterOptions dict_options_;
+
   BinaryPlainBlockBuilder dict_block_;
 
   google::dense_hash_map<StringPiece, uint32_t, GoodFastHash<StringPiece> > dictionary_;
@@ -152,19 +160,23 @@ class BinaryDictBlockDecoder final : public BlockDecoder {
                          ColumnDataView* dst) override;
 
   virtual bool HasNext() const OVERRIDE {
-    return data_decoder_->HasNext();
+    return mode_ == kCodeWordMode ? codeword_decoder_->HasNext()
+                                  : plain_decoder_->HasNext();
   }
 
   virtual size_t Count() const OVERRIDE {
-    return data_decoder_->Count();
+    return mode_ == kCodeWordMode ? codeword_decoder_->Count()
+                                  : plain_decoder_->Count();
   }
 
   virtual size_t GetCurrentIndex() const OVERRIDE {
-    return data_decoder_->GetCurrentIndex();
+    return mode_ == kCodeWordMode ? codeword_decoder_->GetCurrentIndex()
+                                  : plain_decoder_->GetCurrentIndex();
   }
 
   virtual rowid_t GetFirstRowId() const OVERRIDE {
-    return data_decoder_->GetFirstRowId();
+    return mode_ == kCodeWordMode ? codeword_decoder_->GetFirstRowId()
+                                  : plain_decoder_->GetFirstRowId();
   }
 
   static const size_t kMinHeaderSize = sizeof(uint32_t) * 1;
@@ -178,7 +190,14 @@ class BinaryDictBlockDecoder final : public BlockDecoder {
   // Dictionary block decoder
   BinaryPlainBlockDecoder* dict_decoder_;
 
-  gscoped_ptr<BlockDecoder> data_decoder_;
+  // Decoder for the embedded data block. Exactly one of these is non-null
+  // after a successful ParseHeader(), according to 'mode_'. The data block
+  // is a member of a small closed set of concrete decoder types, so calls
+  // are dispatched on 'mode_' to the concrete types rather than through a
+  // BlockDecoder pointer; this lets the per-batch copy and seek loops
+  // inline instead of making virtual calls.
+  gscoped_ptr<BShufBlockDecoder<UINT32>> codeword_decoder_;
+  gscoped_ptr<BinaryPlainBlockDecoder> plain_decoder_;
 
   // Parent CFileIterator, each dictionary decoder in the same CFile will share
   // the same vocabulary, and thus, the same set of matching codewords.
@@ -483,12 +483,59 @@ Status BinaryPrefixBlockDecoder::SkipForward(int n) {
     cur_idx_ += n;
     return Status::OK();
   }
+  if (PREDICT_FALSE(n == 0)) {
+    return Status::OK();
+  }
 
-  // Probably a faster way to implement this using restarts,
+  // First pass: walk the entry headers without materializing any of the
+  // intermediate values. The lengths alone are enough to validate the walk,
+  // since entry i's value is 'shared' bytes of entry i-1's value followed by
+  // 'non_shared' new bytes.
+  skip_scratch_.clear();
+  size_t prev_len = cur_val_.size();
   for (int i = 0; i < n; i++) {
-    RETURN_NOT_OK(ParseNextValue());
-    cur_idx_++;
+    RETURN_NOT_OK(CheckNextPtr());
+    uint32_t shared, non_shared;
+    const uint8_t *val_delta = DecodeEntryLengths(next_ptr_, &shared, &non_shared);
+    if (PREDICT_FALSE(val_delta == nullptr)) {
+      return Status::Corruption(
+        StringPrintf("Could not decode value length data at idx %d",
+                     cur_idx_ + i + 1));
+    }
+    if (PREDICT_FALSE(shared > prev_len)) {
+      return Status::Corruption(
+        StringPrintf("Specified longer shared amount than previous key "
+                     "length at idx %d", cur_idx_ + i + 1));
+    }
+    skip_scratch_.push_back({ val_delta, shared, non_shared });
+    prev_len = shared + non_shared;
+    next_ptr_ = val_delta + non_shared;
   }
+
+  // Second pass: reconstruct only the destination value, back to front.
+  // Each byte position is owned by the last skipped entry that wrote it, so
+  // walking the entries in reverse and filling only the positions that are
+  // still missing copies each byte at most once, rather than copying every
+  // intermediate value in full. Positions that no skipped entry supplies are
+  // already in place from the restart point value in cur_val_ (which
+  // faststring::resize() preserves).
+  const SkippedEntry& last = skip_scratch_.back();
+  cur_val_.resize(last.shared + last.non_shared);
+  strings::memcpy_inlined(&cur_val_[last.shared], last.delta, last.non_shared);
+  // Bytes [0, missing) of the destination still need to be filled in.
+  size_t missing = last.shared;
+  for (int i = n - 2; i >= 0 && missing > 0; i--) {
+    const SkippedEntry& e = skip_scratch_[i];
+    if (e.shared < missing) {
+      // This entry supplies bytes [e.shared, e.shared + e.non_shared); the
+      // still-missing region is bounded above by this entry's total length.
+      size_t fill = std::min<size_t>(missing, e.shared + e.non_shared) - e.shared;
+      strings::memcpy_inlined(&cur_val_[e.shared], e.delta, fill);
+      missing = e.shared;
+    }
+  }
+
+  cur_idx_ += n;
   return Status::OK();
 }
 
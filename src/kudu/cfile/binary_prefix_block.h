@@ -166,6 +166,16 @@ class BinaryPrefixBlockDecoder final : public BlockDecoder {
   // following cur_val_
   // This is advanced by ParseNextValue()
   const uint8_t *next_ptr_;
+
+  // An entry header noted by SkipForward()'s length-only scan.
+  struct SkippedEntry {
+    const uint8_t *delta;
+    uint32_t shared;
+    uint32_t non_shared;
+  };
+
+  // Scratch space reused by SkipForward() to avoid an allocation per seek.
+  std::vector<SkippedEntry> skip_scratch_;
 };
 
 } // namespace cfile
@@ -17,12 +17,15 @@
 
 #include <cstring>
 
+#include <gflags/gflags_declare.h>
 #include <gtest/gtest.h>
 
 #include "kudu/cfile/block_cache.h"
 #include "kudu/util/cache.h"
 #include "kudu/util/slice.h"
 
+DECLARE_string(block_cache_table_shares);
+
 namespace kudu {
 namespace cfile {
 
@@ -63,5 +66,20 @@ TEST(TestBlockCache, TestBasics) {
 }
 
 
+TEST(TestBlockCache, TestTableShares) {
+  FLAGS_block_cache_table_shares = "table-a=4,table-b=1";
+  BlockCache cache(512 * 1024 * 1024);
+
+  // Tables with a configured share get their own partitions.
+  int partition_a = cache.GetPartitionForTable("table-a");
+  int partition_b = cache.GetPartitionForTable("table-b");
+  ASSERT_NE(0, partition_a);
+  ASSERT_NE(0, partition_b);
+  ASSERT_NE(partition_a, partition_b);
+
+  // Tables without a configured share use the default partition.
+  ASSERT_EQ(0, cache.GetPartitionForTable("some-other-table"));
+}
+
 } // namespace cfile
 } // namespace kudu
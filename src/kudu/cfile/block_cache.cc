@@ -17,25 +17,63 @@
 
 #include <ostream>
 #include <string>
+#include <vector>
 
 #include <gflags/gflags.h>
 
 #include "kudu/cfile/block_cache.h"
+#include "kudu/gutil/map-util.h"
+#include "kudu/gutil/strings/numbers.h"
+#include "kudu/gutil/strings/split.h"
 #include "kudu/util/cache.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/slice.h"
 #include "kudu/util/string_case.h"
+#include "kudu/util/twotier_cache.h"
 
 DEFINE_int64(block_cache_capacity_mb, 512, "block cache capacity in MB");
 TAG_FLAG(block_cache_capacity_mb, stable);
 
 DEFINE_string(block_cache_type, "DRAM",
               "Which type of block cache to use for caching data. "
-              "Valid choices are 'DRAM' or 'NVM'. DRAM, the default, "
-              "caches data in regular memory. 'NVM' caches data "
-              "in a memory-mapped file using the NVML library.");
+              "Valid choices are 'DRAM', 'NVM' or 'DRAM_NVM'. DRAM, the "
+              "default, caches data in regular memory. 'NVM' caches data "
+              "in a memory-mapped file using the NVML library. 'DRAM_NVM' "
+              "keeps hot blocks in a DRAM tier sized by "
+              "--block_cache_capacity_mb, backed by an NVM tier sized by "
+              "--block_cache_nvm_capacity_mb which absorbs blocks evicted "
+              "from DRAM.");
 TAG_FLAG(block_cache_type, experimental);
 
+DEFINE_int64(block_cache_nvm_capacity_mb, 0,
+             "Capacity in MB of the NVM tier of the block cache. Only used "
+             "when --block_cache_type is 'DRAM_NVM', in which case it must "
+             "be set to a positive value.");
+TAG_FLAG(block_cache_nvm_capacity_mb, experimental);
+
+DEFINE_bool(block_cache_frequency_based_admission, false,
+            "Whether to use frequency-based admission control for the block "
+            "cache. When enabled, a newly read block is only retained in the "
+            "cache if it has recently been accessed at least as frequently "
+            "as the block it would evict. This prevents large sequential "
+            "scans from flushing frequently-used index and bloom filter "
+            "blocks out of the cache. Only supported by the DRAM block "
+            "cache.");
+TAG_FLAG(block_cache_frequency_based_admission, advanced);
+TAG_FLAG(block_cache_frequency_based_admission, experimental);
+
+DEFINE_string(block_cache_table_shares, "",
+              "Comma-separated list of <table-id>=<weight> pairs assigning "
+              "weighted block cache shares to specific tables. Each listed "
+              "table gets its own cache partition with a soft eviction "
+              "target proportional to its weight, so that scans of one "
+              "table cannot evict another table's cached blocks past its "
+              "share. Tables without an entry share the default partition, "
+              "which has a weight of 1. Only supported by the DRAM block "
+              "cache.");
+TAG_FLAG(block_cache_table_shares, advanced);
+TAG_FLAG(block_cache_table_shares, experimental);
+
 template <class T> class scoped_refptr;
 
 namespace kudu {
@@ -47,17 +85,31 @@ namespace cfile {
 namespace {
 
 Cache* CreateCache(int64_t capacity) {
-  CacheType t;
+  Cache* cache;
   ToUpperCase(FLAGS_block_cache_type, &FLAGS_block_cache_type);
   if (FLAGS_block_cache_type == "NVM") {
-    t = NVM_CACHE;
+    cache = NewLRUCache(NVM_CACHE, capacity, "block_cache");
   } else if (FLAGS_block_cache_type == "DRAM") {
-    t = DRAM_CACHE;
+    cache = NewLRUCache(DRAM_CACHE, capacity, "block_cache");
+  } else if (FLAGS_block_cache_type == "DRAM_NVM") {
+    CHECK_GT(FLAGS_block_cache_nvm_capacity_mb, 0)
+        << "--block_cache_nvm_capacity_mb must be set when "
+        << "--block_cache_type is 'DRAM_NVM'";
+    cache = NewTwoTierCache(
+        NewLRUCache(DRAM_CACHE, capacity, "block_cache"),
+        NewLRUCache(NVM_CACHE, FLAGS_block_cache_nvm_capacity_mb * 1024 * 1024,
+                    "block_cache"),
+        "block_cache");
   } else {
     LOG(FATAL) << "Unknown block cache type: '" << FLAGS_block_cache_type
-               << "' (expected 'DRAM' or 'NVM')";
+               << "' (expected 'DRAM', 'NVM' or 'DRAM_NVM')";
+  }
+  if (FLAGS_block_cache_frequency_based_admission) {
+    // This is a no-op for cache implementations which do not support
+    // admission control (e.g. the NVM cache).
+    cache->SetFrequencyBasedAdmission(true);
   }
-  return NewLRUCache(t, capacity, "block_cache");
+  return cache;
 }
 
 } // anonymous namespace
@@ -68,12 +120,34 @@ BlockCache::BlockCache()
 
 BlockCache::BlockCache(size_t capacity)
   : cache_(CreateCache(capacity)) {
+  std::vector<std::string> entries = strings::Split(FLAGS_block_cache_table_shares, ",",
+                                                    strings::SkipEmpty());
+  for (const std::string& entry : entries) {
+    std::vector<std::string> parts = strings::Split(entry, "=");
+    int32_t weight;
+    if (parts.size() != 2 || !safe_strto32(parts[1], &weight) || weight <= 0) {
+      LOG(FATAL) << "Invalid entry in --block_cache_table_shares: '" << entry
+                 << "' (expected <table-id>=<positive weight>)";
+    }
+    // This is a no-op for cache implementations which do not support
+    // partitioning (e.g. the NVM cache): they return the default partition.
+    partition_by_table_id_[parts[0]] = cache_->RegisterPartition(weight);
+  }
+}
+
+int BlockCache::GetPartitionForTable(const std::string& table_id) const {
+  return FindWithDefault(partition_by_table_id_, table_id, 0);
 }
 
-BlockCache::PendingEntry BlockCache::Allocate(const CacheKey& key, size_t val_size) {
+BlockCache::PendingEntry BlockCache::Allocate(const CacheKey& key, size_t val_size,
+                                              int partition_id) {
   Slice key_slice(reinterpret_cast<const uint8_t*>(&key), sizeof(key));
   int charge = val_size;
-  return PendingEntry(cache_.get(), cache_->Allocate(key_slice, val_size, charge));
+  Cache::PendingHandle* handle = cache_->Allocate(key_slice, val_size, charge);
+  if (handle != nullptr && partition_id != 0) {
+    cache_->SetPartition(handle, partition_id);
+  }
+  return PendingEntry(cache_.get(), handle);
 }
 
 bool BlockCache::Lookup(const CacheKey& key, Cache::CacheBehavior behavior,
@@ -92,6 +166,10 @@ void BlockCache::Insert(BlockCache::PendingEntry* entry, BlockCacheHandle* inser
   inserted->SetHandle(cache_.get(), h);
 }
 
+void BlockCache::UpdateCapacity(size_t capacity) {
+  cache_->UpdateCapacity(capacity);
+}
+
 void BlockCache::StartInstrumentation(const scoped_refptr<MetricEntity>& metric_entity) {
   cache_->SetMetrics(metric_entity);
 }
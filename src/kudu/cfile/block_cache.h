@@ -19,6 +19,8 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <string>
+#include <unordered_map>
 #include <utility>
 
 #include <gflags/gflags_declare.h>
@@ -129,6 +131,19 @@ class BlockCache {
   bool Lookup(const CacheKey& key, Cache::CacheBehavior behavior,
               BlockCacheHandle* handle);
 
+  // Adjust the cache's capacity to 'capacity' bytes, synchronously evicting
+  // entries if it shrinks below current usage. Used by the memory governor
+  // to rebalance memory between the block cache and the memstores. Ignored
+  // by cache types which don't support capacity adjustment (e.g. NVM).
+  void UpdateCapacity(size_t capacity);
+
+  // Return the cache partition id for blocks belonging to the table with
+  // the given id. Tables with a share configured through
+  // --block_cache_table_shares are given their own eviction partition,
+  // weighted by the configured share; all other tables use the default
+  // partition. See Cache::RegisterPartition().
+  int GetPartitionForTable(const std::string& table_id) const;
+
   // Pass a metric entity to the cache to start recording metrics.
   // This should be called before the block cache starts serving blocks.
   // Not calling StartInstrumentation will simply result in no block cache-related metrics.
@@ -153,8 +168,10 @@ class BlockCache {
   //   BlockCacheHandle bch;
   //   cache->Insert(&entry, &bch);
 
-  // Allocate a new entry to be inserted into the cache.
-  PendingEntry Allocate(const CacheKey& key, size_t block_size);
+  // Allocate a new entry to be inserted into the cache. The entry is
+  // charged to the eviction partition 'partition_id', which must have been
+  // returned by GetPartitionForTable().
+  PendingEntry Allocate(const CacheKey& key, size_t block_size, int partition_id = 0);
 
   // Insert the given block into the cache. 'inserted' is set to refer to the
   // entry in the cache.
@@ -167,6 +184,11 @@ class BlockCache {
   DISALLOW_COPY_AND_ASSIGN(BlockCache);
 
   gscoped_ptr<Cache> cache_;
+
+  // Maps table ids with a configured share (see --block_cache_table_shares)
+  // to their cache partition ids. Built in the constructor and immutable
+  // afterwards, so lookups need no synchronization.
+  std::unordered_map<std::string, int> partition_by_table_id_;
 };
 
 // Scoped reference to a block from the block cache.
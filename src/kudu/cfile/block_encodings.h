@@ -23,8 +23,10 @@
 #include <glog/logging.h>
 
 #include "kudu/common/column_materialization_context.h"
+#include "kudu/common/column_predicate.h"
 #include "kudu/common/rowid.h"
 #include "kudu/common/rowblock.h"
+#include "kudu/common/types.h"
 #include "kudu/cfile/cfile.pb.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/util/faststring.h"
@@ -96,6 +98,62 @@ class BlockBuilder {
   DISALLOW_COPY_AND_ASSIGN(BlockBuilder);
 };
 
+// The result of evaluating a predicate against the [min, max] value range of
+// an entire block, used by decoders which support decoder-level evaluation
+// for fixed-width types.
+enum class BlockEvalResult {
+  // No value in the block can satisfy the predicate.
+  kNoneMatch,
+  // Every value in the block satisfies the predicate.
+  kAllMatch,
+  // The rows must be evaluated one by one.
+  kEvalRows,
+};
+
+// Evaluate 'pred' against a block of non-null values all of which fall in
+// ['min_value', 'max_value'] (both inclusive). Only range and equality
+// predicates (plus the trivial None/IsNotNull/IsNull cases) can be decided
+// at block granularity; everything else falls back to row-by-row
+// evaluation.
+template<DataType PhysicalType>
+BlockEvalResult EvaluatePredicateOnBlockRange(const ColumnPredicate& pred,
+                                              const void* min_value,
+                                              const void* max_value) {
+  typedef DataTypeTraits<PhysicalType> Traits;
+  switch (pred.predicate_type()) {
+    case PredicateType::None:
+    case PredicateType::IsNull:
+      return BlockEvalResult::kNoneMatch;
+    case PredicateType::IsNotNull:
+      return BlockEvalResult::kAllMatch;
+    case PredicateType::Equality: {
+      const void* value = pred.raw_lower();
+      if (Traits::Compare(value, min_value) < 0 ||
+          Traits::Compare(value, max_value) > 0) {
+        return BlockEvalResult::kNoneMatch;
+      }
+      if (Traits::Compare(min_value, max_value) == 0) {
+        return BlockEvalResult::kAllMatch;
+      }
+      return BlockEvalResult::kEvalRows;
+    }
+    case PredicateType::Range: {
+      const void* lower = pred.raw_lower();
+      const void* upper = pred.raw_upper(); // Exclusive.
+      if ((lower != nullptr && Traits::Compare(max_value, lower) < 0) ||
+          (upper != nullptr && Traits::Compare(min_value, upper) >= 0)) {
+        return BlockEvalResult::kNoneMatch;
+      }
+      if ((lower == nullptr || Traits::Compare(min_value, lower) >= 0) &&
+          (upper == nullptr || Traits::Compare(max_value, upper) < 0)) {
+        return BlockEvalResult::kAllMatch;
+      }
+      return BlockEvalResult::kEvalRows;
+    }
+    default:
+      return BlockEvalResult::kEvalRows;
+  }
+}
 
 class BlockDecoder {
  public:
@@ -20,6 +20,7 @@
 #include <memory>
 #include <ostream>
 #include <utility>
+#include <vector>
 
 #include <glog/logging.h>
 #include <gtest/gtest.h>
@@ -86,6 +87,34 @@ TEST_F(BloomFileTest, TestWriteAndRead) {
   VerifyBloomFile();
 }
 
+TEST_F(BloomFileTest, TestBatchedProbe) {
+  ASSERT_NO_FATAL_FAILURE(WriteTestBloomFile());
+  ASSERT_OK(OpenBloomFile());
+
+  // Build a sorted batch of probes covering every inserted key, so the batch
+  // spans many bloom blocks.
+  std::vector<uint64_t> keys(FLAGS_n_keys);
+  std::vector<BloomKeyProbe> probes;
+  probes.reserve(FLAGS_n_keys);
+  for (uint64_t i = 0; i < FLAGS_n_keys; i++) {
+    keys[i] = BigEndian::FromHost64(i << kKeyShift);
+    probes.emplace_back(Slice(reinterpret_cast<char*>(&keys[i]), sizeof(uint64_t)));
+  }
+
+  std::vector<bool> expected(FLAGS_n_keys);
+  for (uint64_t i = 0; i < FLAGS_n_keys; i++) {
+    bool present = false;
+    ASSERT_OK_FAST(bfr_->CheckKeyPresent(probes[i], &present));
+    expected[i] = present;
+  }
+
+  unique_ptr<bool[]> maybe_present(new bool[FLAGS_n_keys]);
+  ASSERT_OK(bfr_->CheckKeysPresent(probes.data(), FLAGS_n_keys, maybe_present.get()));
+  for (uint64_t i = 0; i < FLAGS_n_keys; i++) {
+    ASSERT_EQ(expected[i], maybe_present[i]) << "key index " << i;
+  }
+}
+
 #ifdef NDEBUG
 TEST_F(BloomFileTest, Benchmark) {
   ASSERT_NO_FATAL_FAILURE(WriteTestBloomFile());
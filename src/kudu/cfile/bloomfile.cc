@@ -36,10 +36,12 @@
 #include "kudu/common/types.h"
 #include "kudu/fs/block_manager.h"
 #include "kudu/gutil/atomicops.h"
+#include "kudu/gutil/basictypes.h"
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/stringprintf.h"
 #include "kudu/util/coding.h"
 #include "kudu/util/compression/compression.pb.h"
+#include "kudu/util/env.h"
 #include "kudu/util/hexdump.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/malloc.h"
@@ -247,6 +249,10 @@ Status BloomFileReader::InitOnce() {
     return Status::Corruption("bloom file missing value index",
                               reader_->ToString());
   }
+
+  // Bloom files are only ever probed at scattered points, so kernel
+  // readahead of them is wasted I/O. Purely advisory.
+  ignore_result(reader_->HintAccessPattern(ACCESS_PATTERN_RANDOM));
   return Status::OK();
 }
 
@@ -281,6 +287,12 @@ Status BloomFileReader::ParseBlockHeader(const Slice &block,
 
 Status BloomFileReader::CheckKeyPresent(const BloomKeyProbe &probe,
                                         bool *maybe_present) {
+  return CheckKeysPresent(&probe, 1, maybe_present);
+}
+
+Status BloomFileReader::CheckKeysPresent(const BloomKeyProbe* probes,
+                                         size_t n_probes,
+                                         bool* maybe_present) {
   DCHECK(init_once_.init_succeeded());
 
   // Since we frequently will access the same BloomFile many times in a row
@@ -299,37 +311,61 @@ Status BloomFileReader::CheckKeyPresent(const BloomKeyProbe &probe,
       << "Cached index reader does not match expected instance";
 
   IndexTreeIterator* index_iter = &bci->index_iter;
-  Status s = index_iter->SeekAtOrBefore(probe.key());
-  if (PREDICT_FALSE(s.IsNotFound())) {
-    // Seek to before the first entry in the file.
-    *maybe_present = false;
-    return Status::OK();
-  }
-  RETURN_NOT_OK(s);
-
-  // Successfully found the pointer to the bloom block.
-  BlockPointer bblk_ptr = index_iter->GetCurrentBlockPointer();
-
-  // If the previous lookup from this bloom on this thread seeked to a different
-  // block in the BloomFile, we need to read the correct block and re-hydrate the
-  // BloomFilter instance.
-  if (!bci->cur_block_pointer.Equals(bblk_ptr)) {
-    BlockHandle dblk_data;
-    RETURN_NOT_OK(reader_->ReadBlock(bblk_ptr, CFileReader::CACHE_BLOCK, &dblk_data));
-
-    // Parse the header in the block.
-    BloomBlockHeaderPB hdr;
-    Slice bloom_data;
-    RETURN_NOT_OK(ParseBlockHeader(dblk_data.data(), &hdr, &bloom_data));
-
-    // Save the data back into our threadlocal cache.
-    bci->cur_bloom = BloomFilter(bloom_data, hdr.num_hash_functions());
-    bci->cur_block_pointer = bblk_ptr;
-    bci->cur_block_handle = std::move(dblk_data);
-  }
+  size_t i = 0;
+  while (i < n_probes) {
+    DCHECK(i == 0 || probes[i - 1].key().compare(probes[i].key()) <= 0)
+        << "probe keys must be sorted";
+    Status s = index_iter->SeekAtOrBefore(probes[i].key());
+    if (PREDICT_FALSE(s.IsNotFound())) {
+      // Seek to before the first entry in the file.
+      maybe_present[i++] = false;
+      continue;
+    }
+    RETURN_NOT_OK(s);
+
+    // Successfully found the pointer to the bloom block.
+    BlockPointer bblk_ptr = index_iter->GetCurrentBlockPointer();
+
+    // If the previous lookup from this bloom on this thread seeked to a different
+    // block in the BloomFile, we need to read the correct block and re-hydrate the
+    // BloomFilter instance.
+    if (!bci->cur_block_pointer.Equals(bblk_ptr)) {
+      BlockHandle dblk_data;
+      RETURN_NOT_OK(reader_->ReadBlock(bblk_ptr, CFileReader::CACHE_BLOCK, &dblk_data));
+
+      // Parse the header in the block.
+      BloomBlockHeaderPB hdr;
+      Slice bloom_data;
+      RETURN_NOT_OK(ParseBlockHeader(dblk_data.data(), &hdr, &bloom_data));
+
+      // Save the data back into our threadlocal cache.
+      bci->cur_bloom = BloomFilter(bloom_data, hdr.num_hash_functions());
+      bci->cur_block_pointer = bblk_ptr;
+      bci->cur_block_handle = std::move(dblk_data);
+    }
 
-  // Actually check the bloom filter.
-  *maybe_present = bci->cur_bloom.MayContainKey(probe);
+    // When there are more probes after this one, find the first key of the
+    // next bloom block so that all of the probes falling in the current block
+    // can be evaluated while it's pinned, without another index descent per
+    // key. The single-probe case skips this to avoid paying for the extra
+    // index advance on the point-lookup hot path.
+    faststring block_upper_bound;
+    bool has_upper_bound = false;
+    if (i + 1 < n_probes && index_iter->HasNext()) {
+      RETURN_NOT_OK(index_iter->Next());
+      Slice next_key = index_iter->GetCurrentKey();
+      block_upper_bound.assign_copy(next_key.data(), next_key.size());
+      has_upper_bound = true;
+    }
+
+    // Evaluate this probe, and all following probes covered by the same block.
+    do {
+      maybe_present[i] = bci->cur_bloom.MayContainKey(probes[i]);
+      i++;
+    } while (i < n_probes &&
+             (!has_upper_bound ||
+              probes[i].key().compare(Slice(block_upper_bound)) < 0));
+  }
   return Status::OK();
 }
 
@@ -115,6 +115,16 @@ class BloomFileReader {
   Status CheckKeyPresent(const BloomKeyProbe &probe,
                          bool* maybe_present);
 
+  // Check a batch of 'n_probes' probe keys, which must be in ascending
+  // sorted order, setting the corresponding entries of 'maybe_present'.
+  //
+  // Compared to calling CheckKeyPresent() in a loop, this reads and parses
+  // each bloom block only once, evaluating every probe covered by a block
+  // while it is pinned.
+  Status CheckKeysPresent(const BloomKeyProbe* probes,
+                          size_t n_probes,
+                          bool* maybe_present);
+
   // Can be called before Init().
   uint64_t FileSize() const {
     return reader_->file_size();
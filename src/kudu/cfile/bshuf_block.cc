@@ -17,13 +17,74 @@
 #include "kudu/cfile/bshuf_block.h"
 
 #include <algorithm>
+#include <cstring>
 #include <limits>
 
+#ifdef __x86_64__
+#include <smmintrin.h>
+#endif
+
 #include "kudu/gutil/port.h"
 
 namespace kudu {
 namespace cfile {
 
+namespace {
+
+// Load one SrcType value from 'p', zero-extended to uint32.
+template<typename SrcType>
+inline uint32_t LoadWidened(const uint8_t* p) {
+  SrcType v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+#ifdef __x86_64__
+// Load four consecutive SrcType values from 'p', zero-extended to four
+// uint32 lanes.
+template<typename SrcType>
+inline __m128i LoadFourWidened(const uint8_t* p);
+
+template<>
+inline __m128i LoadFourWidened<uint8_t>(const uint8_t* p) {
+  return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(UNALIGNED_LOAD32(p)));
+}
+
+template<>
+inline __m128i LoadFourWidened<uint16_t>(const uint8_t* p) {
+  return _mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+}
+#endif
+
+// Widen 'count' packed SrcType values at the start of 'array' into uint32
+// values, in place. The values are processed back to front so that no source
+// byte is overwritten before it has been read.
+template<typename SrcType>
+void ExpandToUint32InPlace(uint8_t* array, size_t count) {
+#ifdef __x86_64__
+  // All x86-64 Kudu builds require SSE4.2 at startup (see CheckCPUFlags()),
+  // so the SSE4.1 zero-extension instructions can be used without runtime
+  // dispatch. Handle the unaligned tail with scalar stores, then widen four
+  // values per iteration.
+  size_t aligned = count & ~static_cast<size_t>(3);
+  for (size_t i = count; i > aligned; i--) {
+    uint32_t value = LoadWidened<SrcType>(&array[(i - 1) * sizeof(SrcType)]);
+    memcpy(&array[(i - 1) * sizeof(uint32_t)], &value, sizeof(value));
+  }
+  for (size_t i = aligned; i >= 4; i -= 4) {
+    __m128i v = LoadFourWidened<SrcType>(&array[(i - 4) * sizeof(SrcType)]);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&array[(i - 4) * sizeof(uint32_t)]), v);
+  }
+#else
+  for (size_t i = count; i > 0; i--) {
+    uint32_t value = LoadWidened<SrcType>(&array[(i - 1) * sizeof(SrcType)]);
+    memcpy(&array[(i - 1) * sizeof(uint32_t)], &value, sizeof(value));
+  }
+#endif
+}
+
+} // anonymous namespace
+
 void AbortWithBitShuffleError(int64_t val) {
   switch (val) {
     case -1:
@@ -149,15 +210,9 @@ Status BShufBlockDecoder<UINT32>::CopyNextValuesToArray(size_t* n, uint8_t* arra
   // Then, "expand" it out to the correct output size. We only need to do
   // the expansion for size = 1 or size = 2.
   if (size_of_elem_ == 1) {
-    for (int i = max_fetch - 1; i >= 0; i--) {
-      uint32_t value = array[i];
-      memcpy(&array[i * sizeof(uint32_t)], &value, sizeof(value));
-    }
+    ExpandToUint32InPlace<uint8_t>(array, max_fetch);
   } else if (size_of_elem_ == 2) {
-    for (int i = max_fetch - 1; i >= 0; i--) {
-      uint32_t value = UNALIGNED_LOAD16(&array[i * sizeof(uint16_t)]);
-      memcpy(&array[i * sizeof(uint32_t)], &value, sizeof(value));
-    }
+    ExpandToUint32InPlace<uint16_t>(array, max_fetch);
   }
 
   return Status::OK();
@@ -237,7 +237,9 @@ class BShufBlockDecoder final : public BlockDecoder {
         num_elems_(0),
         compressed_size_(0),
         num_elems_after_padding_(0),
-        cur_idx_(0) {
+        cur_idx_(0),
+        computed_min_max_(false),
+        have_min_max_(false) {
   }
 
   Status ParseHeader() OVERRIDE {
@@ -329,6 +331,51 @@ class BShufBlockDecoder final : public BlockDecoder {
     return CopyNextValuesToArray(n, dst->data());
   }
 
+  Status CopyNextAndEval(size_t* n,
+                         ColumnMaterializationContext* ctx,
+                         SelectionVectorView* sel,
+                         ColumnDataView* dst) OVERRIDE {
+    ctx->SetDecoderEvalSupported();
+    DCHECK(parsed_);
+    if (PREDICT_FALSE(*n == 0 || cur_idx_ >= num_elems_)) {
+      *n = 0;
+      return Status::OK();
+    }
+
+    // First evaluate the predicate against the whole block's min/max: if no
+    // value in the block can match we can skip the copy (and the per-row
+    // evaluation) entirely, and if every value matches we can skip just the
+    // per-row evaluation.
+    size_t max_fetch = std::min(*n, static_cast<size_t>(num_elems_ - cur_idx_));
+    if (PREDICT_FALSE(!computed_min_max_)) {
+      ComputeMinMax();
+    }
+    if (have_min_max_) {
+      switch (EvaluatePredicateOnBlockRange<Type>(*ctx->pred(),
+                                                  &min_value_, &max_value_)) {
+        case BlockEvalResult::kNoneMatch:
+          sel->ClearBits(max_fetch);
+          cur_idx_ += max_fetch;
+          *n = max_fetch;
+          return Status::OK();
+        case BlockEvalResult::kAllMatch:
+          return CopyNextValues(n, dst);
+        case BlockEvalResult::kEvalRows:
+          break;
+      }
+    }
+
+    RETURN_NOT_OK(CopyNextValues(&max_fetch, dst));
+    const uint8_t* cell = dst->data();
+    for (size_t i = 0; i < max_fetch; i++, cell += size_of_type) {
+      if (sel->TestBit(i) && !ctx->pred()->EvaluateCell<Type>(cell)) {
+        sel->ClearBit(i);
+      }
+    }
+    *n = max_fetch;
+    return Status::OK();
+  }
+
   // Copy the codewords to a temporary buffer.
   // This API provides a more convenient way for the dictionary decoder to copy out
   // integer codewords and then look up the strings. If we use the CopyNextValuesToArray()
@@ -375,6 +422,33 @@ class BShufBlockDecoder final : public BlockDecoder {
     return result;
   }
 
+  // Compute the minimum and maximum values stored in the block, so that
+  // predicates can be evaluated against the block as a whole. Computed
+  // lazily on the first call to CopyNextAndEval(). Sets 'have_min_max_'
+  // to false when the stored element width differs from the type width
+  // (only possible for UINT32), in which case per-block evaluation is
+  // skipped rather than re-expanding every element.
+  void ComputeMinMax() {
+    computed_min_max_ = true;
+    if (PREDICT_FALSE(size_of_elem_ != size_of_type)) {
+      have_min_max_ = false;
+      return;
+    }
+    DCHECK_GT(num_elems_, 0);
+    const uint8_t* p = decoded_.data();
+    min_value_ = max_value_ = Decode<CppType>(p);
+    for (uint32_t i = 1; i < num_elems_; i++) {
+      p += size_of_type;
+      CppType v = Decode<CppType>(p);
+      if (DataTypeTraits<Type>::Compare(&v, &min_value_) < 0) {
+        min_value_ = v;
+      } else if (DataTypeTraits<Type>::Compare(&v, &max_value_) > 0) {
+        max_value_ = v;
+      }
+    }
+    have_min_max_ = true;
+  }
+
   Status Expand() {
     if (num_elems_ > 0) {
       int64_t bytes;
@@ -413,6 +487,11 @@ class BShufBlockDecoder final : public BlockDecoder {
 
   size_t cur_idx_;
   faststring decoded_;
+
+  bool computed_min_max_;
+  bool have_min_max_;
+  CppType min_value_;
+  CppType max_value_;
 };
 
 template<>
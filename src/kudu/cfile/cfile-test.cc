@@ -73,8 +73,10 @@
 #include "kudu/util/test_macros.h"
 #include "kudu/util/test_util.h"
 
+DECLARE_bool(cfile_adaptive_compression);
 DECLARE_bool(cfile_write_checksums);
 DECLARE_bool(cfile_verify_checksums);
+DECLARE_int32(cfile_dictionary_block_size);
 
 #if defined(__linux__)
 DECLARE_string(nvm_cache_path);
@@ -185,6 +187,24 @@ class TestCFile : public CFileTestBase {
       out[i] = 0;
     }
 
+    // Seek forward repeatedly in small steps. After the first seek, most of
+    // these land in a block which is already prepared and should be served
+    // without re-walking the position index.
+    ASSERT_OK(iter->SeekToOrdinal(5000));
+    for (int i = 0; i < 10; i++) {
+      rowid_t target = 5000 + i * 3;
+      ASSERT_OK(iter->SeekToOrdinal(target));
+      ASSERT_EQ(target, iter->GetCurrentOrdinal());
+
+      ScopedColumnBlock<DataGeneratorType::kDataType> one(1);
+      SelectionVector one_sel(1);
+      ColumnMaterializationContext one_ctx = CreateNonDecoderEvalContext(&one, &one_sel);
+      size_t n_one = 1;
+      ASSERT_OK_FAST(iter->CopyNextValues(&n_one, &one_ctx));
+      ASSERT_EQ(1, n_one);
+      ASSERT_EQ(data_generator_post.BuildTestValue(0, target), one[0]);
+    }
+
     TimeReadFile(fs_manager_.get(), block_id, &n);
     ASSERT_EQ(10000, n);
   }
@@ -524,6 +544,23 @@ TEST_P(TestCFileBothCacheTypes, TestWrite1MLowCardinalityStringsDictEncoding) {
   TestWriteDictEncodingLowCardinalityStrings(1000000);
 }
 
+// Test that the dictionary size limit can be tuned independently of the data
+// block size. With a tiny dictionary budget, unique strings overflow the
+// dictionary almost immediately, exercising the fallback to plain-encoded
+// data blocks mid-file.
+TEST_P(TestCFileBothCacheTypes, TestDictEncodingDictionaryBlockSizeLimit) {
+  google::FlagSaver saver;
+  FLAGS_cfile_dictionary_block_size = 1024;
+
+  BlockId block_id;
+  StringDataGenerator<false> generator("hello %zu");
+  WriteTestFile(&generator, DICT_ENCODING, NO_COMPRESSION, 10000, NO_FLAGS, &block_id);
+
+  size_t n;
+  TimeReadFile(fs_manager_.get(), block_id, &n);
+  ASSERT_EQ(10000, n);
+}
+
 TEST_P(TestCFileBothCacheTypes, TestReadWriteUInt32) {
   for (auto enc : { PLAIN_ENCODING, RLE }) {
     TestReadWriteFixedSizeTypes<UInt32DataGenerator<false>>(enc);
@@ -832,6 +869,47 @@ TEST_P(TestCFileBothCacheTypes, TestAppendRaw) {
   TestReadWriteRawBlocks(ZLIB, 1000);
 }
 
+TEST_P(TestCFileBothCacheTypes, TestAdaptiveCompression) {
+  FLAGS_cfile_adaptive_compression = true;
+
+  // Highly redundant data should be stored with the heavier codec, while
+  // incompressible-looking data should be left uncompressed.
+  string repetitive(4096, 'x');
+  string random_data(4096, '\0');
+  for (size_t i = 0; i < random_data.size(); i++) {
+    random_data[i] = random();
+  }
+  struct {
+    Slice data;
+    CompressionType expected;
+  } cases[] = {
+    { Slice(repetitive), ZLIB },
+    { Slice(random_data), NO_COMPRESSION },
+  };
+
+  for (const auto& test_case : cases) {
+    unique_ptr<WritableBlock> sink;
+    ASSERT_OK(fs_manager_->CreateNewBlock({}, &sink));
+    BlockId id = sink->id();
+    WriterOptions opts;
+    opts.storage_attributes.compression = ZLIB;
+    opts.storage_attributes.encoding = PLAIN_ENCODING;
+    CFileWriter w(opts, GetTypeInfo(STRING), false, std::move(sink));
+    ASSERT_OK(w.Start());
+    vector<Slice> slices = { test_case.data };
+    ASSERT_OK(w.AppendRawBlock(slices, 0, nullptr, Slice(), "raw-data"));
+    ASSERT_OK(w.Finish());
+
+    unique_ptr<ReadableBlock> source;
+    ASSERT_OK(fs_manager_->OpenBlock(id, &source));
+    unique_ptr<CFileReader> reader;
+    ASSERT_OK(CFileReader::Open(std::move(source), ReaderOptions(), &reader));
+    ASSERT_EQ(test_case.expected, reader->footer().compression());
+  }
+
+  FLAGS_cfile_adaptive_compression = false;
+}
+
 TEST_P(TestCFileBothCacheTypes, TestChecksumFlags) {
   for (bool write_checksums : {false, true}) {
     for (bool verify_checksums : {false, true}) {
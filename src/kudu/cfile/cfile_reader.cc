@@ -49,6 +49,7 @@
 #include "kudu/gutil/move.h"
 #include "kudu/gutil/stringprintf.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/gutil/walltime.h"
 #include "kudu/util/array_view.h"
 #include "kudu/util/bitmap.h"
 #include "kudu/util/cache.h"
@@ -56,6 +57,7 @@
 #include "kudu/util/compression/compression_codec.h"
 #include "kudu/util/crc.h"
 #include "kudu/util/debug/trace_event.h"
+#include "kudu/util/env.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/malloc.h"
@@ -76,6 +78,15 @@ DEFINE_bool(cfile_verify_checksums, true,
             "Verify the checksum for each block on read if one exists");
 TAG_FLAG(cfile_verify_checksums, evolving);
 
+DEFINE_int32(cfile_readahead_bytes, 1024 * 1024,
+             "Number of bytes following the current data block for which an "
+             "advisory read-ahead hint is issued to the OS during sequential "
+             "cfile scans. A value of 0 disables read-ahead hints.");
+TAG_FLAG(cfile_readahead_bytes, advanced);
+TAG_FLAG(cfile_readahead_bytes, runtime);
+
+DECLARE_bool(scan_cycle_accounting);
+
 using kudu::fs::ReadableBlock;
 using kudu::pb_util::SecureDebugString;
 using std::string;
@@ -126,6 +137,7 @@ CFileReader::CFileReader(ReaderOptions options,
                          unique_ptr<ReadableBlock> block) :
   block_(std::move(block)),
   file_size_(file_size),
+  cache_partition_(options.block_cache_partition),
   codec_(nullptr),
   mem_consumption_(std::move(options.parent_mem_tracker),
                    memory_footprint()) {
@@ -359,9 +371,10 @@ class ScratchMemory {
   // no capacity and cannot evict to make room, this will fall back
   // to allocating from the heap. In that case, IsFromCache() will
   // return false.
-  void TryAllocateFromCache(BlockCache* cache, const BlockCache::CacheKey& key, int size) {
+  void TryAllocateFromCache(BlockCache* cache, const BlockCache::CacheKey& key, int size,
+                            int cache_partition) {
     DCHECK(!ptr_);
-    from_cache_ = cache->Allocate(key, size);
+    from_cache_ = cache->Allocate(key, size, cache_partition);
     if (!from_cache_.valid()) {
       AllocateFromHeap(size);
       return;
@@ -460,7 +473,7 @@ Status CFileReader::ReadBlock(const BlockPointer &ptr, CacheControl cache_contro
   // then we should allocate our scratch memory directly from the cache.
   // This avoids an extra memory copy in the case of an NVM cache.
   if (codec_ == nullptr && cache_control == CACHE_BLOCK) {
-    scratch.TryAllocateFromCache(cache, key, data_size);
+    scratch.TryAllocateFromCache(cache, key, data_size, cache_partition_);
   } else {
     scratch.AllocateFromHeap(data_size);
   }
@@ -500,7 +513,7 @@ Status CFileReader::ReadBlock(const BlockPointer &ptr, CacheControl cache_contro
     // decompress directly into the cache's memory (to avoid a memcpy for NVM).
     ScratchMemory decompressed_scratch;
     if (cache_control == CACHE_BLOCK) {
-      decompressed_scratch.TryAllocateFromCache(cache, key, uncompressed_size);
+      decompressed_scratch.TryAllocateFromCache(cache, key, uncompressed_size, cache_partition_);
     } else {
       decompressed_scratch.AllocateFromHeap(uncompressed_size);
     }
@@ -662,12 +675,48 @@ CFileIterator::CFileIterator(CFileReader* reader,
     cache_control_(cache_control),
     last_prepare_idx_(-1),
     last_prepare_count_(-1) {
+  // Iterators which bypass the block cache (compaction inputs and other
+  // large streaming scans) read the file front to back; let the kernel
+  // know so that it ramps up readahead. Purely advisory.
+  if (cache_control == CFileReader::DONT_CACHE_BLOCK) {
+    ignore_result(reader->HintAccessPattern(ACCESS_PATTERN_SEQUENTIAL));
+  }
 }
 
 CFileIterator::~CFileIterator() {
 }
 
 Status CFileIterator::SeekToOrdinal(rowid_t ord_idx) {
+  // Fast path: if the target ordinal falls within a block which is already
+  // prepared, seek within it instead of re-walking the position index.
+  // This is common with lazy column materialization: a column which was
+  // skipped ahead within a block (e.g. because predicates on other columns
+  // eliminated the intervening rows) is re-seeked forward, usually to a
+  // nearby row, and the index walk would re-read the same index blocks
+  // every time.
+  if (seeked_ != nullptr && seeked_ == posidx_iter_.get() && !prepared_ &&
+      !prepared_blocks_.empty() &&
+      ord_idx >= prepared_blocks_.front()->first_row_idx() &&
+      ord_idx <= prepared_blocks_.back()->last_row_idx()) {
+    // Destroy any prepared blocks which precede the target. The blocks are
+    // contiguous, so afterwards the front block contains 'ord_idx'.
+    auto it = prepared_blocks_.begin();
+    while ((*it)->last_row_idx() < ord_idx) {
+      prepared_block_pool_.Destroy(*it);
+      ++it;
+    }
+    prepared_blocks_.erase(prepared_blocks_.begin(), it);
+
+    PreparedBlock* b = prepared_blocks_.front();
+    DCHECK_GE(ord_idx, b->first_row_idx());
+    SeekToPositionInBlock(b, ord_idx - b->first_row_idx());
+    last_prepare_idx_ = ord_idx;
+    last_prepare_count_ = 0;
+
+    CHECK_EQ(ord_idx, GetCurrentOrdinal());
+    return Status::OK();
+  }
+
   RETURN_NOT_OK(PrepareForNewSeek());
   if (PREDICT_FALSE(posidx_iter_ == nullptr)) {
     return Status::NotSupported("no positional index in file");
@@ -677,7 +726,6 @@ Status CFileIterator::SeekToOrdinal(rowid_t ord_idx) {
   KeyEncoderTraits<UINT32, faststring>::Encode(ord_idx, &tmp_buf_);
   RETURN_NOT_OK(posidx_iter_->SeekAtOrBefore(Slice(tmp_buf_)));
 
-  // TODO: fast seek within block (without reseeking index)
   pblock_pool_scoped_ptr b = prepared_block_pool_.make_scoped_ptr(
     prepared_block_pool_.Construct());
   RETURN_NOT_OK(ReadCurrentDataBlock(*posidx_iter_, b.get()));
@@ -896,6 +944,21 @@ Status CFileIterator::ReadCurrentDataBlock(const IndexTreeIterator &idx_iter,
   prep_block->dblk_ptr_ = idx_iter.GetCurrentBlockPointer();
   RETURN_NOT_OK(reader_->ReadBlock(prep_block->dblk_ptr_, cache_control_, &prep_block->dblk_data_));
 
+  // Hint to the OS that we're likely to soon read the bytes following this
+  // block, so it can start paging them in while we decode. The hint is only
+  // issued when we cross beyond the previously-hinted range, so that a
+  // sequential scan issues one hint per readahead window rather than one
+  // per block.
+  int32_t readahead_bytes = FLAGS_cfile_readahead_bytes;
+  if (readahead_bytes > 0) {
+    uint64_t block_end = prep_block->dblk_ptr_.offset() + prep_block->dblk_ptr_.size();
+    if (block_end >= next_readahead_offset_ && block_end < reader_->file_size()) {
+      // This is purely advisory; ignore any errors.
+      ignore_result(reader_->ReadAhead(block_end, readahead_bytes));
+      next_readahead_offset_ = block_end + readahead_bytes;
+    }
+  }
+
   uint32_t num_rows_in_block = 0;
   Slice data_block = prep_block->dblk_data_.data();
   if (reader_->is_nullable()) {
@@ -1041,6 +1104,16 @@ Status CFileIterator::FinishBatch() {
 }
 
 Status CFileIterator::Scan(ColumnMaterializationContext* ctx) {
+  if (PREDICT_FALSE(FLAGS_scan_cycle_accounting)) {
+    const int64_t start_cycles = CycleClock::Now();
+    Status s = DoScan(ctx);
+    io_stats_.decode_cycles += CycleClock::Now() - start_cycles;
+    return s;
+  }
+  return DoScan(ctx);
+}
+
+Status CFileIterator::DoScan(ColumnMaterializationContext* ctx) {
   CHECK(seeked_) << "not seeked";
 
   // Use views to advance the block and selection vector as we read into them.
@@ -1056,12 +1129,15 @@ Status CFileIterator::Scan(ColumnMaterializationContext* ctx) {
     if (nwords > 0) {
       codewords_matching_pred_.reset(new SelectionVector(nwords));
       codewords_matching_pred_->SetAllFalse();
+      size_t nmatching = 0;
       for (size_t i = 0; i < nwords; i++) {
         Slice cur_string = dict_decoder_->string_at_index(i);
         if (ctx->pred()->EvaluateCell<BINARY>(static_cast<const void *>(&cur_string))) {
           BitmapSet(codewords_matching_pred_->mutable_bitmap(), i);
+          nmatching++;
         }
       }
+      codewords_all_match_pred_ = nmatching == nwords;
     }
   }
   for (PreparedBlock *pb : prepared_blocks_) {
@@ -126,6 +126,20 @@ class CFileReader {
     return file_size_;
   }
 
+  // Issue an advisory read-ahead hint for the given byte range of the
+  // underlying block. This is purely a hint to the OS; errors are returned
+  // but may safely be ignored by callers.
+  Status ReadAhead(uint64_t offset, size_t length) const {
+    return block_->ReadAhead(offset, length);
+  }
+
+  // Hint the expected access pattern for reads of the underlying block.
+  // This is purely a hint to the OS; errors are returned but may safely
+  // be ignored by callers.
+  Status HintAccessPattern(FileAccessPattern pattern) const {
+    return block_->HintAccessPattern(pattern);
+  }
+
   // Can be called before Init().
   const BlockId& block_id() const {
     return block_->id();
@@ -206,6 +220,9 @@ class CFileReader {
   const std::unique_ptr<fs::ReadableBlock> block_;
   const uint64_t file_size_;
 
+  // The block cache partition that cached blocks are charged to.
+  const int cache_partition_;
+
   uint8_t cfile_version_;
 
   gscoped_ptr<CFileHeaderPB> header_;
@@ -397,9 +414,18 @@ class CFileIterator : public ColumnIterator {
   // single set of predicate-satisfying codewords.
   SelectionVector* GetCodeWordsMatchingPredicate() { return codewords_matching_pred_.get(); }
 
+  // Returns true if every codeword in the cfile's vocabulary passes the
+  // predicate, in which case decoders can skip the per-row codeword test
+  // entirely. Only valid once GetCodeWordsMatchingPredicate() is non-NULL.
+  bool CodeWordsAllMatchPredicate() const { return codewords_all_match_pred_; }
+
  private:
   DISALLOW_COPY_AND_ASSIGN(CFileIterator);
 
+  // Implementation of Scan(); the public method wraps it with optional
+  // cycle accounting.
+  Status DoScan(ColumnMaterializationContext* ctx);
+
   struct PreparedBlock {
     BlockPointer dblk_ptr_;
     BlockHandle dblk_data_;
@@ -470,6 +496,9 @@ class CFileIterator : public ColumnIterator {
   // Set containing the codewords that match the predicate in a dictionary.
   std::unique_ptr<SelectionVector> codewords_matching_pred_;
 
+  // True if every entry of 'codewords_matching_pred_' is set.
+  bool codewords_all_match_pred_ = false;
+
   // The currently in-use index iterator. This is equal to either
   // posidx_iter_.get(), validx_iter_.get(), or NULL if not seeked.
   IndexTreeIterator *seeked_;
@@ -498,6 +527,12 @@ class CFileIterator : public ColumnIterator {
 
   IteratorStats io_stats_;
 
+  // End of the byte range most recently covered by an advisory read-ahead
+  // hint. Used to avoid re-issuing hints for every block during a
+  // sequential scan. Not reset on seek: a backward seek simply re-reads
+  // already-hinted (and likely cached) data.
+  uint64_t next_readahead_offset_ = 0;
+
   // a temporary buffer for encoding
   faststring tmp_buf_;
 };
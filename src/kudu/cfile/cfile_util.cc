@@ -93,7 +93,8 @@ Status DumpIterator(const CFileReader& reader,
 }
 
 ReaderOptions::ReaderOptions()
-  : parent_mem_tracker(MemTracker::GetRootTracker()) {
+  : parent_mem_tracker(MemTracker::GetRootTracker()),
+    block_cache_partition(0) {
 }
 
 size_t CommonPrefixLength(const Slice& slice_a, const Slice& slice_b) {
@@ -56,7 +56,7 @@ struct WriterOptions {
   //
   // This is currently only used by StringPrefixBlockBuilder
   //
-  // Default: 16
+  // Default: --cfile_block_restart_interval (16)
   int block_restart_interval;
 
   // Whether the file needs a positional index.
@@ -85,6 +85,12 @@ struct ReaderOptions {
   //
   // Default: the root tracker.
   std::shared_ptr<MemTracker> parent_mem_tracker;
+
+  // The block cache partition that cached blocks read through this reader
+  // are charged to. See BlockCache::GetPartitionForTable().
+  //
+  // Default: the default partition.
+  int block_cache_partition;
 };
 
 // Dumps the contents of a cfile to 'out'; 'reader' and 'iterator'
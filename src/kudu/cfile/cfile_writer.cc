@@ -17,6 +17,7 @@
 
 #include "kudu/cfile/cfile_writer.h"
 
+#include <cmath>
 #include <numeric>
 #include <ostream>
 #include <utility>
@@ -50,10 +51,29 @@
 DEFINE_int32(cfile_default_block_size, 256*1024, "The default block size to use in cfiles");
 TAG_FLAG(cfile_default_block_size, advanced);
 
+DEFINE_int32(cfile_block_restart_interval, 16,
+             "The number of keys between restart points within a "
+             "prefix-encoded cfile block. Seeking within a block must decode "
+             "up to this many entries past the nearest restart point, so "
+             "smaller values make seeks cheaper at the cost of worse "
+             "compression, and vice versa.");
+TAG_FLAG(cfile_block_restart_interval, advanced);
+TAG_FLAG(cfile_block_restart_interval, experimental);
+
 DEFINE_string(cfile_default_compression_codec, "none",
               "Default cfile block compression codec.");
 TAG_FLAG(cfile_default_compression_codec, advanced);
 
+DEFINE_bool(cfile_adaptive_compression, false,
+            "Whether to choose each cfile's block compression codec from a "
+            "sample of its own data instead of using the column's configured "
+            "codec. The first block written to the file is sampled for byte "
+            "entropy: incompressible-looking data is stored uncompressed, "
+            "lightly redundant data uses LZ4, and highly redundant data uses "
+            "ZLIB. Has no effect on columns configured with no compression.");
+TAG_FLAG(cfile_adaptive_compression, advanced);
+TAG_FLAG(cfile_adaptive_compression, experimental);
+
 DEFINE_bool(cfile_write_checksums, true,
             "Write CRC32 checksums for each block");
 TAG_FLAG(cfile_write_checksums, evolving);
@@ -82,12 +102,46 @@ static CompressionType GetDefaultCompressionCodec() {
   return GetCompressionCodecType(FLAGS_cfile_default_compression_codec);
 }
 
+// Entropy thresholds (in bits per byte, out of a maximum of 8) used by
+// --cfile_adaptive_compression to pick a codec. Data whose byte entropy
+// is near the maximum is almost certainly already compressed or encrypted
+// and not worth spending any CPU on; moderately redundant data gets the
+// cheap codec; highly redundant data is worth the heavier one.
+static const double kIncompressibleEntropyThreshold = 7.5;
+static const double kLightlyCompressibleEntropyThreshold = 6.0;
+
+// Estimate the Shannon entropy of 'data_slices' in bits per byte, based
+// on the byte value distribution. This under-estimates compressibility
+// (it is blind to repeated sequences), but is cheap and monotonic enough
+// to separate pre-compressed data from lightly and highly redundant data.
+static double EstimateEntropyBitsPerByte(const vector<Slice>& data_slices) {
+  size_t counts[256] = { 0 };
+  size_t total = 0;
+  for (const Slice& data : data_slices) {
+    for (size_t i = 0; i < data.size(); i++) {
+      counts[data.data()[i]]++;
+    }
+    total += data.size();
+  }
+  if (total == 0) {
+    return 0;
+  }
+  double entropy = 0;
+  for (size_t count : counts) {
+    if (count > 0) {
+      double p = static_cast<double>(count) / total;
+      entropy -= p * log2(p);
+    }
+  }
+  return entropy;
+}
+
 ////////////////////////////////////////////////////////////
 // Options
 ////////////////////////////////////////////////////////////
 WriterOptions::WriterOptions()
   : index_block_size(32*1024),
-    block_restart_interval(16),
+    block_restart_interval(FLAGS_cfile_block_restart_interval),
     write_posidx(false),
     write_validx(false),
     optimize_index_keys(true) {
@@ -127,6 +181,12 @@ CFileWriter::CFileWriter(const WriterOptions &options,
   if (compression_ == DEFAULT_COMPRESSION) {
     compression_ = GetDefaultCompressionCodec();
   }
+  // If adaptive compression is enabled, the codec choice is deferred until
+  // the first block is appended, at which point the block's contents can
+  // be sampled. Columns explicitly configured with no compression are
+  // left alone.
+  adapt_compression_ = FLAGS_cfile_adaptive_compression &&
+      compression_ != NO_COMPRESSION;
 
   if (options_.storage_attributes.cfile_block_size <= 0) {
     options_.storage_attributes.cfile_block_size = FLAGS_cfile_default_block_size;
@@ -156,7 +216,7 @@ Status CFileWriter::Start() {
   CHECK(state_ == kWriterInitialized) <<
     "bad state for Start(): " << state_;
 
-  if (compression_ != NO_COMPRESSION) {
+  if (compression_ != NO_COMPRESSION && !adapt_compression_) {
     const CompressionCodec* codec;
     RETURN_NOT_OK(GetCompressionCodec(compression_, &codec));
     block_compressor_ .reset(new CompressedBlockBuilder(codec));
@@ -464,12 +524,40 @@ Status CFileWriter::AppendRawBlock(const vector<Slice> &data_slices,
   return s;
 }
 
+Status CFileWriter::ChooseCompressionFromSample(const vector<Slice>& data_slices) {
+  double entropy = EstimateEntropyBitsPerByte(data_slices);
+  if (entropy >= kIncompressibleEntropyThreshold) {
+    compression_ = NO_COMPRESSION;
+  } else if (entropy >= kLightlyCompressibleEntropyThreshold) {
+    compression_ = LZ4;
+  } else {
+    compression_ = ZLIB;
+  }
+  VLOG(1) << "Sampled entropy " << entropy << " bits/byte for first block: "
+          << "using compression codec " << CompressionType_Name(compression_);
+
+  if (compression_ != NO_COMPRESSION) {
+    const CompressionCodec* codec;
+    RETURN_NOT_OK(GetCompressionCodec(compression_, &codec));
+    block_compressor_.reset(new CompressedBlockBuilder(codec));
+  }
+  return Status::OK();
+}
+
 Status CFileWriter::AddBlock(const vector<Slice> &data_slices,
                              BlockPointer *block_ptr,
                              const char *name_for_log) {
   uint64_t start_offset = off_;
   vector<Slice> out_slices;
 
+  // All of the file's blocks must use the same codec (the footer records a
+  // single compression type), so an adaptive choice has to be made before
+  // anything is written: sample the first block appended.
+  if (PREDICT_FALSE(adapt_compression_)) {
+    RETURN_NOT_OK(ChooseCompressionFromSample(data_slices));
+    adapt_compression_ = false;
+  }
+
   if (block_compressor_ != nullptr) {
     // Write compressed block
     Status s = block_compressor_->Compress(data_slices, &out_slices);
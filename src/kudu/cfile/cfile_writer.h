@@ -197,6 +197,11 @@ class CFileWriter {
                   BlockPointer *block_ptr,
                   const char *name_for_log);
 
+  // Pick the file's compression codec based on a sample of the first
+  // block's data, instantiating 'block_compressor_' if the chosen codec
+  // is not NO_COMPRESSION. Used when --cfile_adaptive_compression is set.
+  Status ChooseCompressionFromSample(const std::vector<Slice>& data_slices);
+
   Status WriteRawData(const std::vector<Slice>& data);
 
   Status FinishCurDataBlock();
@@ -219,6 +224,10 @@ class CFileWriter {
   // Type of data being written
   bool is_nullable_;
   CompressionType compression_;
+
+  // Whether the codec choice is still pending on a sample of the first
+  // block. See --cfile_adaptive_compression.
+  bool adapt_compression_;
   const TypeInfo* typeinfo_;
   const TypeEncodingInfo* type_encoding_info_;
 
@@ -32,6 +32,7 @@
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
+#include "kudu/cfile/binary_bitmap_block.h"
 #include "kudu/cfile/binary_plain_block.h"
 #include "kudu/cfile/binary_prefix_block.h"
 #include "kudu/cfile/block_encodings.h"
@@ -40,8 +41,11 @@
 #include "kudu/cfile/plain_bitmap_block.h"
 #include "kudu/cfile/plain_block.h"
 #include "kudu/cfile/rle_block.h"
+#include "kudu/common/column_materialization_context.h"
+#include "kudu/common/column_predicate.h"
 #include "kudu/common/columnblock.h"
 #include "kudu/common/common.pb.h"
+#include "kudu/common/rowblock.h"
 #include "kudu/common/schema.h"
 #include "kudu/common/types.h"
 #include "kudu/gutil/gscoped_ptr.h"
@@ -313,6 +317,10 @@ class TestEncoding : public KuduTest {
     for (int i = kCount - 1; i >= 0; i--) {
       sbd.SeekToPositionInBlock(i);
       ASSERT_EQ(i, sbd.GetCurrentIndex());
+      // Verify that the value was correctly reconstructed by the seek.
+      Slice seeked;
+      CopyOne<STRING>(&sbd, &seeked);
+      ASSERT_EQ(GenTestString(i), seeked.ToString()) << "failed at seek to " << i;
     }
 
     // Test the special case of seeking to the end of the block.
@@ -675,6 +683,76 @@ class TestEncoding : public KuduTest {
     }
   }
 
+  // Test that CopyNextAndEval() for a fixed-width decoder evaluates the
+  // predicate inside the decoder, both when the block's min/max range
+  // partially overlaps the predicate (per-row evaluation) and when it is
+  // entirely excluded (block-level short circuit).
+  template <DataType Type, class BlockBuilderType, class BlockDecoderType>
+  void TestFixedWidthCopyNextAndEval() {
+    typedef typename TypeTraits<Type>::cpp_type CppType;
+    const uint32_t kSize = 100;
+
+    vector<CppType> src(kSize);
+    for (uint32_t i = 0; i < kSize; i++) {
+      src[i] = i;
+    }
+
+    gscoped_ptr<WriterOptions> opts(NewWriterOptions());
+    BlockBuilderType bb(opts.get());
+    bb.Add(reinterpret_cast<const uint8_t *>(src.data()), kSize);
+    Slice s = bb.Finish(0);
+
+    BlockDecoderType bd(s);
+    ASSERT_OK(bd.ParseHeader());
+
+    ColumnSchema col_schema("col", Type);
+    vector<CppType> decoded(kSize);
+    ColumnBlock dst_block(GetTypeInfo(Type), nullptr, &decoded[0], kSize, &arena_);
+
+    // A range predicate covering part of the block should select exactly the
+    // rows that fall within the range.
+    {
+      CppType lower = 20;
+      CppType upper = 40; // Exclusive.
+      ColumnPredicate pred = ColumnPredicate::Range(col_schema, &lower, &upper);
+      SelectionVector sel(kSize);
+      sel.SetAllTrue();
+      ColumnMaterializationContext ctx(0, &pred, &dst_block, &sel);
+      SelectionVectorView sel_view(&sel);
+      ColumnDataView view(&dst_block);
+
+      bd.SeekToPositionInBlock(0);
+      size_t n = kSize;
+      ASSERT_OK(bd.CopyNextAndEval(&n, &ctx, &sel_view, &view));
+      ASSERT_EQ(kSize, n);
+      ASSERT_FALSE(ctx.DecoderEvalNotSupported());
+      for (uint32_t i = 0; i < kSize; i++) {
+        ASSERT_EQ(src[i] >= lower && src[i] < upper, sel.IsRowSelected(i))
+            << "at index " << i;
+      }
+    }
+
+    // A range predicate entirely above the block's values should deselect
+    // every row via the block-level min/max check.
+    {
+      CppType lower = 1000;
+      CppType upper = 2000;
+      ColumnPredicate pred = ColumnPredicate::Range(col_schema, &lower, &upper);
+      SelectionVector sel(kSize);
+      sel.SetAllTrue();
+      ColumnMaterializationContext ctx(0, &pred, &dst_block, &sel);
+      SelectionVectorView sel_view(&sel);
+      ColumnDataView view(&dst_block);
+
+      bd.SeekToPositionInBlock(0);
+      size_t n = kSize;
+      ASSERT_OK(bd.CopyNextAndEval(&n, &ctx, &sel_view, &view));
+      ASSERT_EQ(kSize, n);
+      ASSERT_FALSE(ctx.DecoderEvalNotSupported());
+      ASSERT_FALSE(sel.AnySelected());
+    }
+  }
+
   Arena arena_;
 };
 
@@ -690,6 +768,16 @@ TEST_F(TestEncoding, TestPlainBlockEncoder) {
                                     PlainBlockDecoder<INT32> >(ints.get(), kSize);
 }
 
+TEST_F(TestEncoding, TestPlainBlockDecoderEval) {
+  TestFixedWidthCopyNextAndEval<INT32, PlainBlockBuilder<INT32>,
+                                PlainBlockDecoder<INT32> >();
+}
+
+TEST_F(TestEncoding, TestBShufBlockDecoderEval) {
+  TestFixedWidthCopyNextAndEval<INT32, BShufBlockBuilder<INT32>,
+                                BShufBlockDecoder<INT32> >();
+}
+
 // Test for bitshuffle block, for INT32, FLOAT, DOUBLE
 TEST_F(TestEncoding, TestBShufIntBlockEncoder) {
   const uint32_t kSize = 10000;
@@ -805,6 +893,76 @@ TEST_F(TestEncoding, TestBinaryPrefixBlockBuilderTruncation) {
   TestBinaryBlockTruncation<BinaryPrefixBlockBuilder, BinaryPrefixBlockDecoder>();
 }
 
+TEST_F(TestEncoding, TestBinaryBitmapBlockBuilderRoundTrip) {
+  TestBinaryBlockRoundTrip<BinaryBitmapBlockBuilder, BinaryBitmapBlockDecoder>();
+}
+
+TEST_F(TestEncoding, TestBinaryBitmapEmptyBlockEncodeDecode) {
+  TestEmptyBlockEncodeDecode<BinaryBitmapBlockBuilder, BinaryBitmapBlockDecoder>();
+}
+
+// Test that CopyNextAndEval() for a bitmap encoded block resolves equality
+// predicates through the per-value bitmaps, both when one of the block's
+// values matches and when none does.
+TEST_F(TestEncoding, TestBinaryBitmapBlockDecoderEval) {
+  const uint kCount = 100;
+  gscoped_ptr<WriterOptions> opts(NewWriterOptions());
+  BinaryBitmapBlockBuilder bbb(opts.get());
+  const char* kValues[] = { "apple", "banana", "cherry" };
+  Slice s = CreateBinaryBlock(
+      &bbb, kCount, [&](int i) { return string(kValues[i % 3]); });
+
+  BinaryBitmapBlockDecoder bbd(s);
+  ASSERT_OK(bbd.ParseHeader());
+  ASSERT_EQ(kCount, bbd.Count());
+
+  ColumnSchema col_schema("col", STRING);
+  ScopedColumnBlock<STRING> cb(kCount);
+
+  // An equality predicate should select exactly the rows holding the
+  // matching value.
+  {
+    Slice pred_val("banana");
+    ColumnPredicate pred = ColumnPredicate::Equality(col_schema, &pred_val);
+    SelectionVector sel(kCount);
+    sel.SetAllTrue();
+    ColumnMaterializationContext ctx(0, &pred, &cb, &sel);
+    SelectionVectorView sel_view(&sel);
+    ColumnDataView view(&cb);
+
+    bbd.SeekToPositionInBlock(0);
+    size_t n = kCount;
+    ASSERT_OK(bbd.CopyNextAndEval(&n, &ctx, &sel_view, &view));
+    ASSERT_EQ(kCount, n);
+    ASSERT_FALSE(ctx.DecoderEvalNotSupported());
+    for (uint i = 0; i < kCount; i++) {
+      ASSERT_EQ(i % 3 == 1, sel.IsRowSelected(i)) << "at index " << i;
+      if (i % 3 == 1) {
+        ASSERT_EQ("banana", cb[i].ToString());
+      }
+    }
+  }
+
+  // A predicate matched by no value in the block should deselect every row
+  // without decoding any data.
+  {
+    Slice pred_val("durian");
+    ColumnPredicate pred = ColumnPredicate::Equality(col_schema, &pred_val);
+    SelectionVector sel(kCount);
+    sel.SetAllTrue();
+    ColumnMaterializationContext ctx(0, &pred, &cb, &sel);
+    SelectionVectorView sel_view(&sel);
+    ColumnDataView view(&cb);
+
+    bbd.SeekToPositionInBlock(0);
+    size_t n = kCount;
+    ASSERT_OK(bbd.CopyNextAndEval(&n, &ctx, &sel_view, &view));
+    ASSERT_EQ(kCount, n);
+    ASSERT_FALSE(ctx.DecoderEvalNotSupported());
+    ASSERT_FALSE(sel.AnySelected());
+  }
+}
+
 // We have several different encodings for INT blocks.
 // The following tests use GTest's TypedTest functionality to run the tests
 // for each of the encodings.
@@ -19,6 +19,7 @@
 #include <cstdio>
 #include <cstring>
 #include <string>
+#include <vector>
 
 #include <glog/logging.h>
 #include <gtest/gtest.h>
@@ -295,6 +296,55 @@ TEST(TestIndexBlock, TestIndexBlockWithStrings) {
   EXPECT_EQ("hello-40", match);
 }
 
+// Test a block whose keys share a long common prefix. This exercises the
+// prefix-resuming comparisons in SeekAtOrBefore().
+TEST(TestIndexBlock, TestIndexBlockWithSharedPrefixes) {
+  WriterOptions opts;
+  IndexBlockBuilder idx(&opts, true);
+
+  const std::string kPrefix = "tenant-0000000001.2016-01-01.";
+  const int kCount = 100;
+  std::vector<std::string> keys;
+  for (int i = 0; i < kCount; i++) {
+    char suffix[16];
+    snprintf(suffix, sizeof(suffix), "%04d", i * 10);
+    keys.push_back(kPrefix + suffix);
+  }
+  for (int i = 0; i < kCount; i++) {
+    idx.Add(Slice(keys[i]), BlockPointer(i, 64 * 1024));
+  }
+  Slice s = idx.Finish();
+
+  IndexBlockReader reader;
+  ASSERT_OK(reader.Parse(s));
+
+  BlockPointer ptr;
+  Slice match;
+
+  // A key sorting before the shared prefix is not found, and neither is the
+  // bare prefix itself (it is a strict prefix of the first key).
+  EXPECT_TRUE(SearchInReaderString(reader, "tenant-0000000000", &ptr, &match).IsNotFound());
+  EXPECT_TRUE(SearchInReaderString(reader, kPrefix, &ptr, &match).IsNotFound());
+
+  for (int i = 0; i < kCount; i++) {
+    SCOPED_TRACE(i);
+
+    // An exact match seeks to the entry itself.
+    ASSERT_OK(SearchInReaderString(reader, keys[i], &ptr, &match));
+    EXPECT_EQ(i, static_cast<int>(ptr.offset()));
+    EXPECT_EQ(keys[i], match);
+
+    // A key between this entry and the next (an extension of this key)
+    // seeks to this entry.
+    ASSERT_OK(SearchInReaderString(reader, keys[i] + "5", &ptr, &match));
+    EXPECT_EQ(i, static_cast<int>(ptr.offset()));
+  }
+
+  // A key past the last entry seeks to the last entry.
+  ASSERT_OK(SearchInReaderString(reader, "tenant-0000000002", &ptr, &match));
+  EXPECT_EQ(kCount - 1, static_cast<int>(ptr.offset()));
+}
+
 // Test seeking around using the IndexBlockIterator class
 TEST(TestIndexBlock, TestIterator) {
   // Encode an index block with 1000 entries.
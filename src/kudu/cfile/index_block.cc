@@ -17,6 +17,7 @@
 
 #include "kudu/cfile/index_block.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <ostream>
 #include <string>
@@ -193,7 +194,8 @@ bool IndexBlockReader::IsLeaf() {
 }
 
 int IndexBlockReader::CompareKey(int idx_in_block,
-                                 const Slice &search_key) const {
+                                 const Slice &search_key,
+                                 size_t* skip) const {
   const uint8_t *key_ptr, *limit;
   GetKeyPointer(idx_in_block, &key_ptr, &limit);
   Slice this_slice;
@@ -202,7 +204,20 @@ int IndexBlockReader::CompareKey(int idx_in_block,
     return 0;
   }
 
-  return this_slice.compare(search_key);
+  size_t n = std::min(this_slice.size(), search_key.size());
+  // The caller guarantees that the first '*skip' bytes are equal, but clamp
+  // defensively in case of a corrupt (truncated) key.
+  size_t i = std::min(*skip, n);
+  while (i < n && this_slice[i] == search_key[i]) {
+    i++;
+  }
+  *skip = i;
+  if (i < n) {
+    return this_slice[i] < search_key[i] ? -1 : 1;
+  }
+  if (this_slice.size() < search_key.size()) return -1;
+  if (this_slice.size() > search_key.size()) return 1;
+  return 0;
 }
 
 Status IndexBlockReader::ReadEntry(size_t idx, Slice *key, BlockPointer *block_ptr) const {
@@ -265,22 +280,39 @@ void IndexBlockIterator::Reset() {
 Status IndexBlockIterator::SeekAtOrBefore(const Slice &search_key) {
   size_t left = 0;
   size_t right = reader_->Count() - 1;
+
+  // Lengths of the common prefixes shared between the search key and the
+  // keys bounding the current search range ('left_lcp' for the key at
+  // 'left', 'right_lcp' for the key at the upper bound). Since the keys are
+  // sorted, every key in the range shares at least min(left_lcp, right_lcp)
+  // leading bytes with the search key, so each probe's comparison can
+  // resume beyond the already-matched prefix. With composite keys that
+  // share long common prefixes (e.g. a leading tenant or date component),
+  // this avoids re-scanning those bytes at every level of the search.
+  size_t left_lcp = 0;
+  size_t right_lcp = 0;
   while (left < right) {
     int mid = (left + right + 1) / 2;
 
-    int compare = reader_->CompareKey(mid, search_key);
+    size_t lcp = std::min(left_lcp, right_lcp);
+    int compare = reader_->CompareKey(mid, search_key, &lcp);
     if (compare < 0) {  // mid < search
       left = mid;
+      left_lcp = lcp;
     } else if (compare > 0) {  // mid > search
+      // Keys in [left, mid - 1] are bounded above by the key at 'mid', so
+      // its common prefix with the search key remains a valid bound.
       right = mid - 1;
+      right_lcp = lcp;
     } else {  // mid == search
       left = mid;
+      left_lcp = lcp;
       break;
     }
   }
 
   // closest is now 'left'
-  int compare = reader_->CompareKey(left, search_key);
+  int compare = reader_->CompareKey(left, search_key, &left_lcp);
   if (compare > 0) {
     // The last midpoint was still greater than the
     // provided key, which implies that the key is
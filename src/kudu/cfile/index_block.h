@@ -117,7 +117,15 @@ class IndexBlockReader {
  private:
   friend class IndexBlockIterator;
 
-  int CompareKey(int idx_in_block, const Slice &search_key) const;
+  // Compare the key at 'idx_in_block' against 'search_key', returning a
+  // value <0, 0, or >0 as in Slice::compare().
+  //
+  // '*skip' is the number of leading bytes of the two keys which the caller
+  // already knows to be equal; the comparison resumes from that offset. On
+  // return, '*skip' is updated to the length of the common prefix between
+  // the two keys. This allows a binary search to avoid re-comparing long
+  // shared key prefixes at every probe (see SeekAtOrBefore()).
+  int CompareKey(int idx_in_block, const Slice &search_key, size_t* skip) const;
 
   Status ReadEntry(size_t idx, Slice *key, BlockPointer *block_ptr) const;
 
@@ -116,7 +116,8 @@ class PlainBlockDecoder final : public BlockDecoder {
         parsed_(false),
         num_elems_(0),
         ordinal_pos_base_(0),
-        cur_idx_(0) {
+        cur_idx_(0),
+        computed_min_max_(false) {
   }
 
   virtual Status ParseHeader() OVERRIDE {
@@ -208,6 +209,55 @@ class PlainBlockDecoder final : public BlockDecoder {
     return Status::OK();
   }
 
+  virtual Status CopyNextAndEval(size_t* n,
+                                 ColumnMaterializationContext* ctx,
+                                 SelectionVectorView* sel,
+                                 ColumnDataView* dst) OVERRIDE {
+    ctx->SetDecoderEvalSupported();
+    DCHECK(parsed_);
+    DCHECK_LE(*n, dst->nrows());
+    DCHECK_EQ(dst->stride(), sizeof(CppType));
+
+    if (PREDICT_FALSE(*n == 0 || cur_idx_ >= num_elems_)) {
+      *n = 0;
+      return Status::OK();
+    }
+
+    // First evaluate the predicate against the whole block's min/max, which
+    // lets us skip the copy (and the per-row evaluation) entirely if the
+    // block provably contains no matching values, or skip just the per-row
+    // evaluation if every value matches.
+    if (PREDICT_FALSE(!computed_min_max_)) {
+      ComputeMinMax();
+    }
+    size_t max_fetch = std::min(*n, static_cast<size_t>(num_elems_ - cur_idx_));
+    switch (EvaluatePredicateOnBlockRange<Type>(*ctx->pred(),
+                                                &min_value_, &max_value_)) {
+      case BlockEvalResult::kNoneMatch:
+        sel->ClearBits(max_fetch);
+        cur_idx_ += max_fetch;
+        *n = max_fetch;
+        return Status::OK();
+      case BlockEvalResult::kAllMatch:
+        return CopyNextValues(n, dst);
+      case BlockEvalResult::kEvalRows:
+        break;
+    }
+
+    memcpy(dst->data(),
+           &data_[kPlainBlockHeaderSize + cur_idx_ * size_of_type],
+           max_fetch * size_of_type);
+    const uint8_t* cell = dst->data();
+    for (size_t i = 0; i < max_fetch; i++, cell += size_of_type) {
+      if (sel->TestBit(i) && !ctx->pred()->EvaluateCell<Type>(cell)) {
+        sel->ClearBit(i);
+      }
+    }
+    cur_idx_ += max_fetch;
+    *n = max_fetch;
+    return Status::OK();
+  }
+
   virtual bool HasNext() const OVERRIDE {
     return cur_idx_ < num_elems_;
   }
@@ -225,17 +275,39 @@ class PlainBlockDecoder final : public BlockDecoder {
   }
 
  private:
+  typedef typename TypeTraits<Type>::cpp_type CppType;
+  enum {
+    size_of_type = TypeTraits<Type>::size
+  };
+
+  // Compute the minimum and maximum values stored in the block, so that
+  // predicates can be evaluated against the block as a whole. Computed
+  // lazily on the first call to CopyNextAndEval().
+  void ComputeMinMax() {
+    DCHECK_GT(num_elems_, 0);
+    const uint8_t* p = &data_[kPlainBlockHeaderSize];
+    min_value_ = max_value_ = Decode<CppType>(p);
+    for (uint32_t i = 1; i < num_elems_; i++) {
+      p += size_of_type;
+      CppType v = Decode<CppType>(p);
+      if (DataTypeTraits<Type>::Compare(&v, &min_value_) < 0) {
+        min_value_ = v;
+      } else if (DataTypeTraits<Type>::Compare(&v, &max_value_) > 0) {
+        max_value_ = v;
+      }
+    }
+    computed_min_max_ = true;
+  }
 
   Slice data_;
   bool parsed_;
   uint32_t num_elems_;
   rowid_t ordinal_pos_base_;
   uint32_t cur_idx_;
-  typedef typename TypeTraits<Type>::cpp_type CppType;
-  enum {
-    size_of_type = TypeTraits<Type>::size
-  };
 
+  bool computed_min_max_;
+  CppType min_value_;
+  CppType max_value_;
 };
 
 } // namespace cfile
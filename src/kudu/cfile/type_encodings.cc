@@ -25,6 +25,7 @@
 #include "kudu/cfile/plain_bitmap_block.h"
 #include "kudu/cfile/plain_block.h"
 #include "kudu/cfile/rle_block.h"
+#include "kudu/cfile/binary_bitmap_block.h"
 #include "kudu/cfile/binary_dict_block.h"
 #include "kudu/cfile/binary_plain_block.h"
 #include "kudu/cfile/binary_prefix_block.h"
@@ -171,6 +172,22 @@ struct DataTypeEncodingTraits<BINARY, DICT_ENCODING> {
   }
 };
 
+// Template for bitmap encoding
+template<>
+struct DataTypeEncodingTraits<BINARY, BITMAP> {
+
+  static Status CreateBlockBuilder(BlockBuilder **bb, const WriterOptions *options) {
+    *bb = new BinaryBitmapBlockBuilder(options);
+    return Status::OK();
+  }
+
+  static Status CreateBlockDecoder(BlockDecoder **bd, const Slice &slice,
+                                   CFileIterator *iter) {
+    *bd = new BinaryBitmapBlockDecoder(slice);
+    return Status::OK();
+  }
+};
+
 template<DataType IntType>
 struct DataTypeEncodingTraits<IntType, RLE> {
 
@@ -272,6 +289,7 @@ class TypeEncodingResolver {
     AddMapping<BINARY, DICT_ENCODING>();
     AddMapping<BINARY, PLAIN_ENCODING>();
     AddMapping<BINARY, PREFIX_ENCODING>();
+    AddMapping<BINARY, BITMAP>();
     AddMapping<BOOL, RLE>();
     AddMapping<BOOL, PLAIN_ENCODING>();
   }
@@ -467,7 +467,8 @@ Batcher::Batcher(KuduClient* client,
     next_op_sequence_number_(0),
     timeout_(client->default_rpc_timeout()),
     outstanding_lookups_(0),
-    buffer_bytes_used_(0) {
+    buffer_bytes_used_(0),
+    partition_key_cache_table_(nullptr) {
 }
 
 void Batcher::Abort() {
@@ -585,7 +586,15 @@ Status Batcher::Add(KuduWriteOperation* write_op) {
   // so that when the user calls Flush, we are ready to go.
   gscoped_ptr<InFlightOp> op(new InFlightOp());
   string partition_key;
-  RETURN_NOT_OK(write_op->table_->partition_schema().EncodeKey(write_op->row(), &partition_key));
+  // Ops commonly arrive in runs sharing the same hash column values, so
+  // memoize the hash bucket computations across consecutive Add() calls.
+  // The cache is only valid against a single table's partition schema.
+  if (write_op->table_.get() != partition_key_cache_table_) {
+    partition_key_cache_.Reset();
+    partition_key_cache_table_ = write_op->table_.get();
+  }
+  RETURN_NOT_OK(write_op->table_->partition_schema().EncodeKey(
+      write_op->row(), &partition_key_cache_, &partition_key));
   op->write_op.reset(write_op);
   op->state = InFlightOp::kLookingUpTablet;
 
@@ -26,6 +26,7 @@
 #include "kudu/client/client.h"
 #include "kudu/client/shared_ptr.h"
 #include "kudu/client/write_op.h"
+#include "kudu/common/partition.h"
 #include "kudu/gutil/atomicops.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/port.h"
@@ -55,6 +56,18 @@ class WriteRpc;
 // reference, and all of the in-flight operations hold others. This allows the client
 // session to be destructed while ops are still in-flight, without the async callbacks
 // attempting to access a destructed Batcher.
+//
+// NOTE on memory bounding: the batcher itself buffers without limit; bounding
+// is the session's job. KuduSession::Data tracks the bytes pending across all
+// of its batchers against the buffer size configured via
+// KuduSession::SetMutationBufferSpace(), blocks Apply() once the limit is
+// reached, and (in AUTO_FLUSH_BACKGROUND mode) triggers a flush at the
+// configured watermark. Replacing the per-op KuduWriteOperation/InFlightOp
+// objects with a more compact encoded representation isn't possible with the
+// current public API: Apply() transfers ownership of the caller's
+// KuduWriteOperation to the session, and per-op error reporting hands the
+// very same object back through KuduError, so the op must be kept alive
+// until its write is resolved.
 class Batcher : public RefCountedThreadSafe<Batcher> {
  public:
   // Create a new batcher associated with the given session.
@@ -230,6 +243,17 @@ class Batcher : public RefCountedThreadSafe<Batcher> {
   // The number of bytes used in the buffer for pending operations.
   AtomicInt<int64_t> buffer_bytes_used_;
 
+  // Memoizes hash bucket computations across consecutively added operations,
+  // which frequently share hash column values (e.g. time series writes
+  // clustered by entity). Only valid for operations against
+  // 'partition_key_cache_table_'; reset when the batcher sees an operation
+  // for a different table.
+  //
+  // Only accessed from Add(), which, like the rest of the session write
+  // path, is not thread-safe.
+  PartitionSchema::HashBucketCache partition_key_cache_;
+  const KuduTable* partition_key_cache_table_;
+
   DISALLOW_COPY_AND_ASSIGN(Batcher);
 };
 
@@ -0,0 +1,77 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/client/callbacks.h"
+
+#include <deque>
+#include <mutex>
+
+#include "kudu/util/condition_variable.h"
+#include "kudu/util/mutex.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+namespace client {
+
+class KuduStatusCompletionQueue::Data {
+ public:
+  Data()
+      : cond_(&mutex_) {
+  }
+
+  Mutex mutex_;
+  ConditionVariable cond_;
+  std::deque<Status> completions_; // protected by mutex_
+};
+
+KuduStatusCompletionQueue::KuduStatusCompletionQueue()
+    : data_(new KuduStatusCompletionQueue::Data) {
+}
+
+KuduStatusCompletionQueue::~KuduStatusCompletionQueue() {
+  delete data_;
+}
+
+void KuduStatusCompletionQueue::Run(const Status& s) {
+  std::lock_guard<Mutex> l(data_->mutex_);
+  data_->completions_.push_back(s);
+  // Each queued entry satisfies exactly one reaper, so there's no need
+  // to broadcast.
+  data_->cond_.Signal();
+}
+
+bool KuduStatusCompletionQueue::Poll(Status* s) {
+  std::lock_guard<Mutex> l(data_->mutex_);
+  if (data_->completions_.empty()) {
+    return false;
+  }
+  *s = data_->completions_.front();
+  data_->completions_.pop_front();
+  return true;
+}
+
+void KuduStatusCompletionQueue::Wait(Status* s) {
+  std::lock_guard<Mutex> l(data_->mutex_);
+  while (data_->completions_.empty()) {
+    data_->cond_.Wait();
+  }
+  *s = data_->completions_.front();
+  data_->completions_.pop_front();
+}
+
+} // namespace client
+} // namespace kudu
@@ -234,6 +234,48 @@ class KUDU_EXPORT KuduStatusFunctionCallback : public KuduStatusCallback {
   T arg_;
 };
 
+/// @brief A status callback which queues reported statuses for polling.
+///
+/// Unlike the other KuduStatusCallback implementations, this one runs no
+/// application code at the point where a status is reported: Run() merely
+/// appends the status to an internal queue. The application's own threads
+/// then reap completed statuses with Poll() or Wait(). This sidesteps both
+/// the restriction that callbacks must not block and the scheduling jitter
+/// incurred by running completion logic on the client's internal threads.
+///
+/// A single instance may be passed to any number of
+/// KuduSession::FlushAsync() calls; each completed flush adds one entry to
+/// the queue. All methods of this class are thread-safe.
+class KUDU_EXPORT KuduStatusCompletionQueue : public KuduStatusCallback {
+ public:
+  KuduStatusCompletionQueue();
+  virtual ~KuduStatusCompletionQueue();
+
+  /// @copydoc KuduStatusCallback::Run()
+  virtual void Run(const Status& s) OVERRIDE;
+
+  /// Reap one completed status, if any, without blocking.
+  ///
+  /// @param [out] s
+  ///   The completed status. Untouched if this method returns @c false.
+  /// @return @c true iff a completed status was reaped.
+  bool Poll(Status* s);
+
+  /// Reap one completed status, blocking until one is available.
+  ///
+  /// @param [out] s
+  ///   The completed status.
+  void Wait(Status* s);
+
+ private:
+  class KUDU_NO_EXPORT Data;
+
+  // Owned.
+  Data* data_;
+
+  DISALLOW_COPY_AND_ASSIGN(KuduStatusCompletionQueue);
+};
+
 } // namespace client
 } // namespace kudu
 
@@ -19,6 +19,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <cstdlib>
 #include <functional>
 #include <limits>
 #include <memory>
@@ -356,6 +357,48 @@ KuduClient::Data::~Data() {
   dns_resolver_.reset();
 }
 
+namespace {
+
+// Pick a replica at random, weighting each candidate by the inverse of the
+// scan latency observed against it so that scanner load spreads across
+// replicas in proportion to how quickly each one has been serving us.
+// Candidates with no recorded latency are given the weight of the fastest
+// candidate so that they still get probed.
+RemoteTabletServer* PickLatencyWeightedReplica(
+    const vector<RemoteTabletServer*>& candidates) {
+  int64_t min_latency = std::numeric_limits<int64_t>::max();
+  for (RemoteTabletServer* rts : candidates) {
+    int64_t latency = rts->observed_scan_latency_us();
+    if (latency > 0 && latency < min_latency) {
+      min_latency = latency;
+    }
+  }
+  if (min_latency == std::numeric_limits<int64_t>::max()) {
+    // No latency observations yet: fall back to a uniformly random choice.
+    return candidates[rand() % candidates.size()];
+  }
+
+  double total_weight = 0;
+  vector<double> weights;
+  weights.reserve(candidates.size());
+  for (RemoteTabletServer* rts : candidates) {
+    int64_t latency = std::max(rts->observed_scan_latency_us(), min_latency);
+    double weight = 1.0 / latency;
+    weights.push_back(weight);
+    total_weight += weight;
+  }
+  double r = rand() / (RAND_MAX + 1.0) * total_weight;
+  for (size_t i = 0; i < candidates.size(); i++) {
+    r -= weights[i];
+    if (r <= 0) {
+      return candidates[i];
+    }
+  }
+  return candidates.back();
+}
+
+} // anonymous namespace
+
 RemoteTabletServer* KuduClient::Data::SelectTServer(const scoped_refptr<RemoteTablet>& rt,
                                                     const ReplicaSelection selection,
                                                     const set<string>& blacklist,
@@ -397,9 +440,9 @@ RemoteTabletServer* KuduClient::Data::SelectTServer(const scoped_refptr<RemoteTa
             break;
           }
         }
-        // Fallback to a random replica if none are local.
+        // Fall back to a latency-weighted random replica if none are local.
         if (ret == nullptr && !filtered.empty()) {
-          ret = filtered[rand() % filtered.size()];
+          ret = PickLatencyWeightedReplica(filtered);
         }
       }
       break;
@@ -46,6 +46,7 @@
 #include "kudu/client/client.h"
 #include "kudu/client/error_collector.h"
 #include "kudu/client/meta_cache.h"
+#include "kudu/client/replica_controller-internal.h"
 #include "kudu/client/resource_metrics.h"
 #include "kudu/client/row_result.h"
 #include "kudu/client/scan_batch.h"
@@ -2241,6 +2242,39 @@ TEST_F(ClientTest, TestAsyncFlushResponseAfterSessionDropped) {
   ASSERT_FALSE(s.Wait().ok());
 }
 
+// Test reaping async flush completions from the application's thread
+// via KuduStatusCompletionQueue instead of running callbacks on the
+// client's internal threads.
+TEST_F(ClientTest, TestAsyncFlushCompletionQueue) {
+  shared_ptr<KuduSession> session = client_->NewSession();
+  ASSERT_OK(session->SetFlushMode(KuduSession::MANUAL_FLUSH));
+
+  KuduStatusCompletionQueue queue;
+  Status s;
+  ASSERT_FALSE(queue.Poll(&s));
+
+  // A single queue instance can back multiple outstanding flushes;
+  // each completed flush adds one entry.
+  ASSERT_OK(ApplyInsertToSession(session.get(), client_table_, 1, 1, "row"));
+  session->FlushAsync(&queue);
+  ASSERT_OK(ApplyInsertToSession(session.get(), client_table_, 2, 2, "row"));
+  session->FlushAsync(&queue);
+
+  queue.Wait(&s);
+  ASSERT_OK(s);
+  queue.Wait(&s);
+  ASSERT_OK(s);
+  ASSERT_FALSE(queue.Poll(&s));
+
+  // An error status (re-inserting the same row) is reported through
+  // the queue the same way a callback would have received it.
+  ASSERT_OK(ApplyInsertToSession(session.get(), client_table_, 1, 1, "row"));
+  session->FlushAsync(&queue);
+  queue.Wait(&s);
+  ASSERT_TRUE(s.IsIOError()) << s.ToString();
+  ASSERT_EQ(2, CountRowsFromClient(client_table_.get()));
+}
+
 TEST_F(ClientTest, TestSessionClose) {
   shared_ptr<KuduSession> session = client_->NewSession();
   ASSERT_OK(session->SetFlushMode(KuduSession::MANUAL_FLUSH));
@@ -4539,6 +4573,40 @@ TEST_F(ClientTest, TestReadAtSnapshotNoTimestampSet) {
   EXPECT_EQ(kTabletsNum * kRowsPerTablet, total_row_count);
 }
 
+// Test for freshness-bounded scans: when a staleness tolerance is set on a
+// scanner, the scan runs in READ_AT_SNAPSHOT mode at a snapshot pinned no
+// further than the tolerance behind the current time.
+TEST_F(ClientTest, TestStalenessBoundedScan) {
+  static const int kNumRows = 100;
+  NO_FATALS(InsertTestRows(client_table_.get(), kNumRows));
+
+  // Let the inserted rows age past the staleness tolerance so that the
+  // snapshot pinned by the scanner covers them.
+  const MonoDelta kTolerance = MonoDelta::FromMilliseconds(50);
+  SleepFor(MonoDelta::FromMilliseconds(200));
+
+  KuduScanner scanner(client_table_.get());
+  ASSERT_OK(internal::ReplicaController::SetStalenessTolerance(&scanner,
+                                                               kTolerance));
+  ASSERT_OK(scanner.Open());
+
+  // The staleness tolerance should have switched the scan to
+  // READ_AT_SNAPSHOT and pinned a snapshot timestamp.
+  ASSERT_EQ(KuduScanner::READ_AT_SNAPSHOT,
+            scanner.data_->configuration().read_mode());
+  ASSERT_TRUE(scanner.data_->configuration().has_snapshot_timestamp());
+
+  // All the rows were written before the pinned snapshot, so the scan
+  // should see every one of them.
+  size_t total_row_count = 0;
+  while (scanner.HasMoreRows()) {
+    KuduScanBatch batch;
+    ASSERT_OK(scanner.NextBatch(&batch));
+    total_row_count += batch.NumRows();
+  }
+  EXPECT_EQ(kNumRows, total_row_count);
+}
+
 enum IntEncoding {
   kPlain,
   kBitShuffle,
@@ -5000,6 +5068,56 @@ TEST_F(ClientTest, TestGetTablet) {
   }
 }
 
+// Tests that KuduMergeScanner merges the per-tablet streams of a
+// hash-partitioned table into a single stream ordered by primary key.
+TEST_F(ClientTest, TestMergeScanner) {
+  const char* kTableName = "client-testmergescan";
+  const int kNumRows = 1000;
+
+  // Use enough hash buckets that rows interleave across tablets.
+  shared_ptr<KuduTable> table;
+  unique_ptr<KuduTableCreator> table_creator(client_->NewTableCreator());
+  ASSERT_OK(table_creator->table_name(kTableName)
+            .schema(&schema_)
+            .num_replicas(1)
+            .add_hash_partitions({ "key" }, 4)
+            .Create());
+  ASSERT_OK(client_->OpenTable(kTableName, &table));
+  NO_FATALS(InsertTestRows(table.get(), kNumRows));
+
+  // A projection which omits the key can't be merged.
+  {
+    KuduMergeScanner scanner(table.get());
+    ASSERT_OK(scanner.SetProjectedColumnNames({ "int_val" }));
+    Status s = scanner.Open();
+    ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+    ASSERT_STR_CONTAINS(s.ToString(), "must include all primary key columns");
+  }
+
+  // Scan the table and check that every row comes back, in key order.
+  KuduMergeScanner scanner(table.get());
+  ASSERT_OK(scanner.SetProjectedColumnNames({ "key", "int_val" }));
+  // Use a small batch size so that the merge cycles through many batches
+  // per source.
+  ASSERT_OK(scanner.SetBatchSizeBytes(1024));
+  ASSERT_OK(scanner.Open());
+  vector<KuduScanBatch::RowPtr> rows;
+  int next_key = 0;
+  while (scanner.HasMoreRows()) {
+    ASSERT_OK(scanner.NextRows(&rows));
+    for (const KuduScanBatch::RowPtr& row : rows) {
+      int32_t key;
+      int32_t int_val;
+      ASSERT_OK(row.GetInt32(0, &key));
+      ASSERT_OK(row.GetInt32(1, &int_val));
+      ASSERT_EQ(next_key, key);
+      ASSERT_EQ(key * 2, int_val);
+      next_key++;
+    }
+  }
+  ASSERT_EQ(kNumRows, next_key);
+}
+
 TEST_F(ClientTest, TestErrorCollector) {
     shared_ptr<KuduSession> session(client_->NewSession());
     ASSERT_OK(session->SetFlushMode(KuduSession::MANUAL_FLUSH));
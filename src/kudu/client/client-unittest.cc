@@ -207,6 +207,19 @@ TEST(ClientUnitTest, TestErrorCollector) {
                         "cannot set new limit: already dropped some errors");
   }
 
+  // Check that the overflow mode can be changed freely until an error has
+  // been dropped, and not afterwards.
+  {
+    scoped_refptr<ErrorCollector> ec(new ErrorCollector);
+    EXPECT_OK(ec->SetOverflowMode(ErrorCollector::SAMPLE_ON_OVERFLOW));
+    EXPECT_OK(ec->SetOverflowMode(ErrorCollector::DROP_ON_OVERFLOW));
+    ec->dropped_errors_cnt_ = 1;
+    Status s = ec->SetOverflowMode(ErrorCollector::SAMPLE_ON_OVERFLOW);
+    EXPECT_TRUE(s.IsIllegalState());
+    ASSERT_STR_CONTAINS(s.ToString(),
+                        "cannot set new overflow mode: already dropped some errors");
+  }
+
   // Check that the error collector does not overflow post-factum on call of the
   // SetMaxMemSize() method.
   {
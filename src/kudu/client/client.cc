@@ -993,6 +993,12 @@ Status KuduSession::SetErrorBufferSpace(size_t size_bytes) {
   return data_->error_collector_->SetMaxMemSize(size_bytes);
 }
 
+Status KuduSession::SetErrorBufferOverflowMode(ErrorBufferOverflowMode mode) {
+  return data_->error_collector_->SetOverflowMode(
+      mode == SAMPLE_ON_OVERFLOW ? internal::ErrorCollector::SAMPLE_ON_OVERFLOW
+                                 : internal::ErrorCollector::DROP_ON_OVERFLOW);
+}
+
 int KuduSession::CountPendingErrors() const {
   return data_->error_collector_->CountErrors();
 }
@@ -1635,10 +1641,77 @@ Status KuduScanTokenBuilder::SetCacheBlocks(bool cache_blocks) {
   return data_->mutable_configuration()->SetCacheBlocks(cache_blocks);
 }
 
+Status KuduScanTokenBuilder::SetSplitSizeBytes(uint64_t split_size_bytes) {
+  data_->SetSplitSizeBytes(split_size_bytes);
+  return Status::OK();
+}
+
 Status KuduScanTokenBuilder::Build(vector<KuduScanToken*>* tokens) {
   return data_->Build(tokens);
 }
 
+////////////////////////////////////////////////////////////
+// KuduMergeScanner
+////////////////////////////////////////////////////////////
+
+KuduMergeScanner::KuduMergeScanner(KuduTable* table)
+  : data_(new KuduMergeScanner::Data(table)) {
+}
+
+KuduMergeScanner::~KuduMergeScanner() {
+  Close();
+  delete data_;
+}
+
+Status KuduMergeScanner::SetProjectedColumnNames(const vector<string>& col_names) {
+  if (data_->open_) {
+    return Status::IllegalState("Projection must be set before Open()");
+  }
+  // Remember the names so that Open() can locate the key columns within
+  // the projection.
+  data_->projected_names_ = col_names;
+  return data_->token_builder_.SetProjectedColumnNames(col_names);
+}
+
+Status KuduMergeScanner::AddConjunctPredicate(KuduPredicate* pred) {
+  if (data_->open_) {
+    // Take ownership even if we return a bad status.
+    delete pred;
+    return Status::IllegalState("Predicate must be set before Open()");
+  }
+  return data_->token_builder_.AddConjunctPredicate(pred);
+}
+
+Status KuduMergeScanner::SetBatchSizeBytes(uint32_t batch_size) {
+  if (data_->open_) {
+    return Status::IllegalState("Batch size must be set before Open()");
+  }
+  return data_->token_builder_.SetBatchSizeBytes(batch_size);
+}
+
+Status KuduMergeScanner::SetTimeoutMillis(int millis) {
+  if (data_->open_) {
+    return Status::IllegalState("Timeout must be set before Open()");
+  }
+  return data_->token_builder_.SetTimeoutMillis(millis);
+}
+
+Status KuduMergeScanner::Open() {
+  return data_->OpenSources(data_->table_->schema().schema_);
+}
+
+bool KuduMergeScanner::HasMoreRows() const {
+  return data_->HasMoreRows();
+}
+
+Status KuduMergeScanner::NextRows(vector<KuduScanBatch::RowPtr>* rows) {
+  return data_->NextRows(rows);
+}
+
+void KuduMergeScanner::Close() {
+  data_->Close();
+}
+
 ////////////////////////////////////////////////////////////
 // KuduReplica
 ////////////////////////////////////////////////////////////
@@ -1582,7 +1582,10 @@ class KUDU_EXPORT KuduSession : public sp::enable_shared_from_this<KuduSession>
   /// @endcode
   /// Note that, as in all other async functions in Kudu, the callback
   /// may be called either from an IO thread or the same thread which calls
-  /// FlushAsync. The callback should not block.
+  /// FlushAsync. The callback should not block. Applications which prefer
+  /// to run completion logic on their own threads can pass a
+  /// KuduStatusCompletionQueue and reap completed flushes from it with
+  /// KuduStatusCompletionQueue::Poll() or Wait() instead.
   ///
   /// @param [in] cb
   ///   Callback to call upon flush completion. The @c cb must remain valid
@@ -1654,6 +1657,37 @@ class KUDU_EXPORT KuduSession : public sp::enable_shared_from_this<KuduSession>
   ///     accumulated errors.
   Status SetErrorBufferSpace(size_t size_bytes);
 
+  /// Overflow behaviors for the session's error buffer. See the
+  /// SetErrorBufferSpace() method for details on the buffer itself.
+  enum ErrorBufferOverflowMode {
+    /// Drop the first error that would overflow the buffer as well as all
+    /// subsequent errors until the buffer is emptied using the
+    /// GetPendingErrors() method. The accumulated errors never contain
+    /// gaps: they are always the earliest errors seen. This is the default.
+    DROP_ON_OVERFLOW,
+
+    /// Keep a uniform random sample of all errors: once the buffer is full,
+    /// new errors randomly replace previously retained ones. Errors which
+    /// are not retained are still counted by CountPendingErrors(), and
+    /// GetPendingErrors() still reports the overflow. This mode is useful
+    /// under error storms, where a representative sample of the errors
+    /// along with the full error count is more valuable than retaining
+    /// only the earliest ones.
+    SAMPLE_ON_OVERFLOW,
+  };
+
+  /// Set the behavior of this session's error buffer when it overflows.
+  ///
+  /// The mode only matters when a limit on the buffer space is set using
+  /// the SetErrorBufferSpace() method.
+  ///
+  /// @param [in] mode
+  ///   Overflow mode to use.
+  /// @return Operation result status. An error is returned on an attempt
+  ///   to change the mode if the session has already dropped at least one
+  ///   error since the last call to the GetPendingErrors() method.
+  Status SetErrorBufferOverflowMode(ErrorBufferOverflowMode mode);
+
   /// Get error count for pending operations.
   ///
   /// Errors may accumulate in session's lifetime; use this method to
@@ -2087,11 +2121,13 @@ class KUDU_EXPORT KuduScanner {
   class KUDU_NO_EXPORT Data;
 
   friend class KuduScanToken;
+  friend class internal::ReplicaController;
   FRIEND_TEST(ClientTest, TestScanCloseProxy);
   FRIEND_TEST(ClientTest, TestScanFaultTolerance);
   FRIEND_TEST(ClientTest, TestScanNoBlockCaching);
   FRIEND_TEST(ClientTest, TestScanTimeout);
   FRIEND_TEST(ClientTest, TestReadAtSnapshotNoTimestampSet);
+  FRIEND_TEST(ClientTest, TestStalenessBoundedScan);
   FRIEND_TEST(ConsistencyITest, TestSnapshotScanTimestampReuse);
   FRIEND_TEST(ScanTokenTest, TestScanTokens);
 
@@ -2261,6 +2297,21 @@ class KUDU_EXPORT KuduScanTokenBuilder {
   /// @copydoc KuduScanner::SetTimeoutMillis
   Status SetTimeoutMillis(int millis) WARN_UNUSED_RESULT;
 
+  /// Set the data size of the key range each token should cover.
+  ///
+  /// If set to a non-zero value, Build() splits each tablet's primary key
+  /// space into ranges covering roughly @c split_size_bytes of data and
+  /// produces one token per range, so that a single large tablet can be
+  /// scanned by multiple clients in parallel. The split points are based
+  /// on the sizes and bounds of the tablet's rowsets, and are approximate.
+  ///
+  /// If set to 0 (the default), one token is produced per tablet.
+  ///
+  /// @param [in] split_size_bytes
+  ///   The amount of data each key range should cover, in bytes.
+  /// @return Operation result status.
+  Status SetSplitSizeBytes(uint64_t split_size_bytes) WARN_UNUSED_RESULT;
+
   /// Build the set of scan tokens.
   ///
   /// The builder may be reused after this call.
@@ -2280,6 +2331,121 @@ class KUDU_EXPORT KuduScanTokenBuilder {
   DISALLOW_COPY_AND_ASSIGN(KuduScanTokenBuilder);
 };
 
+/// @brief A scanner which merges the streams of every tablet of a table
+///   into a single sequence of rows ordered by primary key.
+///
+/// A KuduScanner returns rows tablet by tablet, so on a hash-partitioned
+/// table the resulting stream is not globally sorted even when the scan
+/// is fault-tolerant. KuduMergeScanner opens one fault-tolerant scanner
+/// per tablet and merges their individually-sorted outputs, yielding
+/// every matching row of the table in primary key order.
+///
+/// Sample usage:
+/// @code
+///   KuduMergeScanner scanner(table.get());
+///   KUDU_CHECK_OK(scanner.Open());
+///   std::vector<KuduScanBatch::RowPtr> rows;
+///   while (scanner.HasMoreRows()) {
+///     KUDU_CHECK_OK(scanner.NextRows(&rows));
+///     for (KuduScanBatch::RowPtr row : rows) {
+///       ... row.GetInt32(0, ...)
+///     }
+///   }
+/// @endcode
+class KUDU_EXPORT KuduMergeScanner {
+ public:
+  /// Construct a merge scanner for the given table.
+  ///
+  /// @param [in] table
+  ///   The table to scan. The given object must remain valid
+  ///   for the lifetime of this object.
+  explicit KuduMergeScanner(KuduTable* table);
+
+  ~KuduMergeScanner();
+
+  /// Set the projection for the scan using column names.
+  ///
+  /// The projection must include all of the table's primary key columns:
+  /// they are needed to merge the per-tablet streams. If this method is
+  /// never called, the scan projects all of the table's columns.
+  ///
+  /// @param [in] col_names
+  ///   Column names to use for the projection.
+  /// @return Operation result status.
+  Status SetProjectedColumnNames(const std::vector<std::string>& col_names)
+      WARN_UNUSED_RESULT;
+
+  /// Add a predicate for the scan.
+  ///
+  /// @param [in] pred
+  ///   Predicate to set. The KuduMergeScanner instance takes ownership
+  ///   of the parameter even if a bad Status is returned.
+  /// @return Operation result status.
+  Status AddConjunctPredicate(KuduPredicate* pred) WARN_UNUSED_RESULT;
+
+  /// Set the hint for the size of the next batch fetched from each tablet.
+  ///
+  /// @param [in] batch_size
+  ///   The hint of batch size in bytes. If setting to 0 before calling
+  ///   Open(), it means that the first call to the tablet server won't
+  ///   return data.
+  /// @return Operation result status.
+  Status SetBatchSizeBytes(uint32_t batch_size) WARN_UNUSED_RESULT;
+
+  /// Set the timeout for the scan operations against each tablet.
+  ///
+  /// @param [in] millis
+  ///   Timeout to set (in milliseconds). Must be a positive value.
+  /// @return Operation result status.
+  Status SetTimeoutMillis(int millis) WARN_UNUSED_RESULT;
+
+  /// Start the merge scan.
+  ///
+  /// This opens one fault-tolerant scanner per tablet of the table and
+  /// positions the merge at the smallest matching primary key.
+  ///
+  /// @return Operation result status. If the projection does not include
+  ///   all of the table's primary key columns, this fails with
+  ///   Status::InvalidArgument.
+  Status Open() WARN_UNUSED_RESULT;
+
+  /// Whether any rows may remain in the scan.
+  ///
+  /// @return @c true if there might be rows left to fetch. As with
+  ///   KuduScanner, this may return @c true even if the next call to
+  ///   NextRows() yields no rows.
+  bool HasMoreRows() const;
+
+  /// Fetch the next group of rows, ordered by primary key across all of
+  /// the table's tablets.
+  ///
+  /// A single call returns rows until one of the per-tablet batches
+  /// feeding the merge is drained, so the number of rows returned per
+  /// call varies.
+  ///
+  /// @param [out] rows
+  ///   Placeholder for the result. The vector is cleared on each call;
+  ///   the returned RowPtr objects point into per-tablet batches held by
+  ///   this object and are invalidated by the next call to NextRows()
+  ///   or by Close().
+  /// @return Operation result status.
+  Status NextRows(std::vector<KuduScanBatch::RowPtr>* rows) WARN_UNUSED_RESULT;
+
+  /// Close the scanner.
+  ///
+  /// Closes the underlying per-tablet scanners and releases their batches.
+  /// This is invoked by the destructor as well.
+  void Close();
+
+ private:
+  class KUDU_NO_EXPORT Data;
+
+  // Owned.
+  Data* data_;
+
+  DISALLOW_COPY_AND_ASSIGN(KuduMergeScanner);
+};
+
 /// @brief Builder for Partitioner instances.
 class KUDU_EXPORT KuduPartitionerBuilder {
  public:
@@ -17,8 +17,10 @@
 
 #include "kudu/client/error_collector.h"
 
+#include <cstdint>
 #include <memory>
 #include <mutex>
+#include <utility>
 #include <vector>
 
 #include "kudu/client/client.h"
@@ -27,6 +29,7 @@
 #include "kudu/gutil/gscoped_ptr.h"
 #include "kudu/gutil/stl_util.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/random_util.h"
 #include "kudu/util/status.h"
 
 using strings::Substitute;
@@ -38,7 +41,10 @@ namespace internal {
 ErrorCollector::ErrorCollector()
     : max_mem_size_bytes_(kMemSizeNoLimit),
       mem_size_bytes_(0),
-      dropped_errors_cnt_(0) {
+      dropped_errors_cnt_(0),
+      total_errors_cnt_(0),
+      overflow_mode_(DROP_ON_OVERFLOW),
+      rand_(GetRandomSeed32()) {
 }
 
 ErrorCollector::~ErrorCollector() {
@@ -66,9 +72,31 @@ Status ErrorCollector::SetMaxMemSize(size_t size_bytes) {
   return Status::OK();
 }
 
+Status ErrorCollector::SetOverflowMode(OverflowMode mode) {
+  std::lock_guard<simple_spinlock> l(lock_);
+  if (dropped_errors_cnt_ > 0) {
+    // Do not allow changing the semantics of the already-accumulated set of
+    // errors: in DROP_ON_OVERFLOW mode it's a gap-free prefix, while in
+    // SAMPLE_ON_OVERFLOW mode it's a random sample.
+    return Status::IllegalState(
+        "cannot set new overflow mode: already dropped some errors");
+  }
+  overflow_mode_ = mode;
+
+  return Status::OK();
+}
+
 void ErrorCollector::AddError(std::unique_ptr<KuduError> error) {
   std::lock_guard<simple_spinlock> l(lock_);
   const size_t error_size_bytes = error->data_->failed_op_->SizeInBuffer();
+  ++total_errors_cnt_;
+
+  if (max_mem_size_bytes_ != kMemSizeNoLimit &&
+      overflow_mode_ == SAMPLE_ON_OVERFLOW &&
+      error_size_bytes + mem_size_bytes_ > max_mem_size_bytes_) {
+    AddSampledError(std::move(error), error_size_bytes);
+    return;
+  }
 
   // If the maximum limit on the memory size is set, check whether the
   // total-size-to-be would be greater than the specified limit after adding
@@ -88,6 +116,38 @@ void ErrorCollector::AddError(std::unique_ptr<KuduError> error) {
   errors_.push_back(error.release());
 }
 
+void ErrorCollector::AddSampledError(std::unique_ptr<KuduError> error,
+                                     size_t error_size_bytes) {
+  DCHECK(lock_.is_locked());
+  // An error which can never fit into the buffer is always dropped.
+  if (error_size_bytes > max_mem_size_bytes_) {
+    ++dropped_errors_cnt_;
+    return;
+  }
+  // Retain the incoming error with probability k/n, where 'k' is the number
+  // of currently retained errors and 'n' is the number of errors seen since
+  // the last GetErrors() call. Together with the uniformly random evictions
+  // below, this keeps the buffer holding an approximately uniform sample of
+  // all the errors seen (reservoir sampling) rather than just the earliest
+  // ones.
+  if (rand_.Uniform64(total_errors_cnt_) >= errors_.size()) {
+    ++dropped_errors_cnt_;
+    return;
+  }
+  // Evict random retained errors until the incoming one fits.
+  while (error_size_bytes + mem_size_bytes_ > max_mem_size_bytes_) {
+    const size_t victim_idx = rand_.Uniform(static_cast<uint32_t>(errors_.size()));
+    KuduError* victim = errors_[victim_idx];
+    mem_size_bytes_ -= victim->data_->failed_op_->SizeInBuffer();
+    delete victim;
+    errors_[victim_idx] = errors_.back();
+    errors_.pop_back();
+    ++dropped_errors_cnt_;
+  }
+  mem_size_bytes_ += error_size_bytes;
+  errors_.push_back(error.release());
+}
+
 size_t ErrorCollector::CountErrors() const {
   std::lock_guard<simple_spinlock> l(lock_);
   return errors_.size() + dropped_errors_cnt_;
@@ -106,6 +166,7 @@ void ErrorCollector::GetErrors(std::vector<KuduError*>* errors,
     STLDeleteElements(&errors_);
   }
   dropped_errors_cnt_ = 0;
+  total_errors_cnt_ = 0;
   mem_size_bytes_ = 0;
 }
 
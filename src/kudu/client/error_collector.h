@@ -23,6 +23,7 @@
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/util/locks.h"
+#include "kudu/util/random.h"
 
 namespace kudu {
 
@@ -39,11 +40,26 @@ class ErrorCollector : public RefCountedThreadSafe<ErrorCollector> {
  public:
   static const size_t kMemSizeNoLimit = 0;
 
+  enum OverflowMode {
+    // Drop the first error that would overflow the buffer and all
+    // subsequent ones until the next GetErrors() call; the retained
+    // errors never contain gaps. This is the default.
+    DROP_ON_OVERFLOW,
+
+    // Keep a uniform random sample of all errors seen since the last
+    // GetErrors() call, randomly replacing retained errors once the
+    // buffer is full.
+    SAMPLE_ON_OVERFLOW,
+  };
+
   ErrorCollector();
 
   // See KuduSession::SetErrorBufferSpace() for details.
   Status SetMaxMemSize(size_t size_bytes);
 
+  // See KuduSession::SetErrorBufferOverflowMode() for details.
+  Status SetOverflowMode(OverflowMode mode);
+
   virtual void AddError(std::unique_ptr<KuduError> error);
 
   // See KuduSession for details.
@@ -59,11 +75,22 @@ class ErrorCollector : public RefCountedThreadSafe<ErrorCollector> {
   friend class ::kudu::client::ClientUnitTest_TestErrorCollector_Test;
   friend class RefCountedThreadSafe<ErrorCollector>;
 
+  // AddError() implementation for SAMPLE_ON_OVERFLOW mode once the buffer
+  // is full. Must be called with 'lock_' held.
+  void AddSampledError(std::unique_ptr<KuduError> error,
+                       size_t error_size_bytes);
+
   mutable simple_spinlock lock_;
   std::vector<KuduError*> errors_;
   size_t max_mem_size_bytes_;
   size_t mem_size_bytes_;
   size_t dropped_errors_cnt_;
+  // Total number of errors seen since the last GetErrors() call, whether
+  // retained or dropped. Used for reservoir sampling in SAMPLE_ON_OVERFLOW
+  // mode.
+  size_t total_errors_cnt_;
+  OverflowMode overflow_mode_;
+  Random rand_;
 
   DISALLOW_COPY_AND_ASSIGN(ErrorCollector);
 };
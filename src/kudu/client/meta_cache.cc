@@ -19,6 +19,7 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <iterator>
 #include <mutex>
 #include <ostream>
 #include <set>
@@ -88,7 +89,8 @@ namespace client {
 namespace internal {
 
 RemoteTabletServer::RemoteTabletServer(const master::TSInfoPB& pb)
-  : uuid_(pb.permanent_uuid()) {
+  : uuid_(pb.permanent_uuid()),
+    ewma_scan_latency_us_(0) {
 
   Update(pb);
 }
@@ -161,6 +163,24 @@ const string& RemoteTabletServer::permanent_uuid() const {
   return uuid_;
 }
 
+void RemoteTabletServer::RecordScanLatency(int64_t latency_us) {
+  latency_us = std::max<int64_t>(latency_us, 1);
+  std::lock_guard<simple_spinlock> l(lock_);
+  if (ewma_scan_latency_us_ == 0) {
+    ewma_scan_latency_us_ = latency_us;
+  } else {
+    // Standard EWMA with a smoothing factor of 1/4: old observations decay
+    // quickly enough to track changes in server load while damping one-off
+    // latency spikes.
+    ewma_scan_latency_us_ = (ewma_scan_latency_us_ * 3 + latency_us) / 4;
+  }
+}
+
+int64_t RemoteTabletServer::observed_scan_latency_us() const {
+  std::lock_guard<simple_spinlock> l(lock_);
+  return ewma_scan_latency_us_;
+}
+
 shared_ptr<TabletServerServiceProxy> RemoteTabletServer::proxy() const {
   std::lock_guard<simple_spinlock> l(lock_);
   CHECK(proxy_);
@@ -347,6 +367,18 @@ string MetaCacheEntry::DebugString(const KuduTable* table) const {
   }
 }
 
+const MetaCacheEntry* TableLocationsSnapshot::FindFloor(const string& partition_key) const {
+  auto it = std::upper_bound(entries_.begin(), entries_.end(), partition_key,
+                             [] (const string& key, const MetaCacheEntry& entry) {
+                               return key < entry.lower_bound_partition_key();
+                             });
+  if (it == entries_.begin()) {
+    // No entry with a lower bound partition key at or below 'partition_key'.
+    return nullptr;
+  }
+  return &*std::prev(it);
+}
+
 MetaCacheServerPicker::MetaCacheServerPicker(KuduClient* client,
                                              const scoped_refptr<MetaCache>& meta_cache,
                                              const KuduTable* table,
@@ -956,6 +988,9 @@ Status MetaCache::ProcessLookupResponse(const LookupRpc& rpc,
     }
   }
 
+  // Publish the refreshed entries for fast path lookups.
+  PublishTableLocationsSnapshot(rpc.table_id(), tablets_by_key);
+
   // Finally, lookup the discovered entry and return it to the requestor.
   *cache_entry = FindFloorOrDie(tablets_by_key, rpc.partition_key());
   if (!rpc.is_exact_lookup() && cache_entry->is_non_covered_range() &&
@@ -969,14 +1004,22 @@ Status MetaCache::ProcessLookupResponse(const LookupRpc& rpc,
 bool MetaCache::LookupTabletByKeyFastPath(const KuduTable* table,
                                           const string& partition_key,
                                           MetaCacheEntry* entry) {
-  shared_lock<rw_spinlock> l(lock_);
-  const TabletMap* tablets = FindOrNull(tablets_by_table_and_key_, table->id());
-  if (PREDICT_FALSE(!tablets)) {
-    // No cache available for this table.
-    return false;
+  // Take a reference on the table's current snapshot. This is the only
+  // synchronization on the per-operation path; the search below runs against
+  // the immutable snapshot, concurrently with any in-progress refresh.
+  scoped_refptr<const TableLocationsSnapshot> snapshot;
+  {
+    shared_lock<rw_spinlock> l(snapshot_lock_.get_lock());
+    const scoped_refptr<const TableLocationsSnapshot>* s =
+        FindOrNull(snapshots_by_table_, table->id());
+    if (PREDICT_FALSE(!s)) {
+      // No cache available for this table.
+      return false;
+    }
+    snapshot = *s;
   }
 
-  const MetaCacheEntry* e = FindFloorOrNull(*tablets, partition_key);
+  const MetaCacheEntry* e = snapshot->FindFloor(partition_key);
   if (PREDICT_FALSE(!e)) {
     // No tablets with a start partition key lower than 'partition_key'.
     return false;
@@ -995,6 +1038,21 @@ bool MetaCache::LookupTabletByKeyFastPath(const KuduTable* table,
   return false;
 }
 
+void MetaCache::PublishTableLocationsSnapshot(const string& table_id,
+                                              const TabletMap& tablets_by_key) {
+  DCHECK(lock_.is_write_locked());
+  vector<MetaCacheEntry> entries;
+  entries.reserve(tablets_by_key.size());
+  for (const auto& entry : tablets_by_key) {
+    entries.push_back(entry.second);
+  }
+  scoped_refptr<const TableLocationsSnapshot> snapshot(
+      new TableLocationsSnapshot(std::move(entries)));
+
+  std::lock_guard<percpu_rwlock> l(snapshot_lock_);
+  snapshots_by_table_[table_id] = std::move(snapshot);
+}
+
 void MetaCache::ClearNonCoveredRangeEntries(const std::string& table_id) {
   VLOG(3) << "Clearing non-covered range entries of table " << table_id;
   std::lock_guard<rw_spinlock> l(lock_);
@@ -1012,11 +1070,16 @@ void MetaCache::ClearNonCoveredRangeEntries(const std::string& table_id) {
       it++;
     }
   }
+  PublishTableLocationsSnapshot(table_id, *tablets);
 }
 
 void MetaCache::ClearCache() {
   VLOG(3) << "Clearing cache";
   std::lock_guard<rw_spinlock> l(lock_);
+  {
+    std::lock_guard<percpu_rwlock> snapshot_l(snapshot_lock_);
+    snapshots_by_table_.clear();
+  }
   STLDeleteValues(&ts_cache_);
   tablets_by_id_.clear();
   tablets_by_table_and_key_.clear();
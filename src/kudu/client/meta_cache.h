@@ -19,6 +19,7 @@
 #ifndef KUDU_CLIENT_META_CACHE_H
 #define KUDU_CLIENT_META_CACHE_H
 
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <set>
@@ -105,6 +106,15 @@ class RemoteTabletServer {
   // Returns the remote server's uuid.
   const std::string& permanent_uuid() const;
 
+  // Record the observed round-trip latency of a scan RPC serviced by this
+  // server. Used to weight replica selection for subsequent scans.
+  void RecordScanLatency(int64_t latency_us);
+
+  // Returns an exponentially weighted moving average of the scan latencies
+  // recorded against this server, in microseconds, or 0 if no scan latency
+  // has been recorded yet.
+  int64_t observed_scan_latency_us() const;
+
  private:
   // Internal callback for DNS resolution.
   void DnsResolutionFinished(const HostPort& hp,
@@ -119,6 +129,10 @@ class RemoteTabletServer {
   std::vector<HostPort> rpc_hostports_;
   std::shared_ptr<tserver::TabletServerServiceProxy> proxy_;
 
+  // Moving average of the scan latencies observed against this server, in
+  // microseconds. 0 until the first scan latency is recorded.
+  int64_t ewma_scan_latency_us_;
+
   DISALLOW_COPY_AND_ASSIGN(RemoteTabletServer);
 };
 
@@ -363,6 +377,32 @@ class MetaCacheEntry {
   std::string upper_bound_partition_key_;
 };
 
+// An immutable snapshot of a table's meta cache entries, in ascending
+// partition key order.
+//
+// Lookup threads share a snapshot without any synchronization; the MetaCache
+// publishes a new snapshot whenever the underlying per-table cache changes,
+// and old snapshots are destroyed once the last in-flight lookup referencing
+// them completes.
+class TableLocationsSnapshot : public RefCountedThreadSafe<TableLocationsSnapshot> {
+ public:
+  explicit TableLocationsSnapshot(std::vector<MetaCacheEntry> entries)
+      : entries_(std::move(entries)) {
+  }
+
+  // Returns the entry with the greatest lower bound partition key which is
+  // not greater than 'partition_key', or nullptr if there is no such entry.
+  const MetaCacheEntry* FindFloor(const std::string& partition_key) const;
+
+ private:
+  friend class RefCountedThreadSafe<TableLocationsSnapshot>;
+  ~TableLocationsSnapshot() = default;
+
+  const std::vector<MetaCacheEntry> entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(TableLocationsSnapshot);
+};
+
 // Manager of RemoteTablets and RemoteTabletServers. The client consults
 // this class to look up a given tablet or server.
 //
@@ -420,6 +460,9 @@ class MetaCache : public RefCountedThreadSafe<MetaCache> {
   FRIEND_TEST(client::ClientTest, TestMasterLookupPermits);
   FRIEND_TEST(client::ClientTest, TestMetaCacheExpiry);
 
+  // Cache of tablets, keyed by partition key.
+  typedef std::map<std::string, MetaCacheEntry> TabletMap;
+
   // Called on the slow LookupTablet path when the master responds. Populates
   // the tablet caches and returns a reference to the first one.
   Status ProcessLookupResponse(const LookupRpc& rpc,
@@ -428,10 +471,19 @@ class MetaCache : public RefCountedThreadSafe<MetaCache> {
 
   // Lookup the given tablet by key, only consulting local information.
   // Returns true and sets *remote_tablet if successful.
+  //
+  // This is the per-operation hot path: it binary searches an immutable
+  // snapshot of the table's locations, without acquiring 'lock_'.
   bool LookupTabletByKeyFastPath(const KuduTable* table,
                                  const std::string& partition_key,
                                  MetaCacheEntry* entry);
 
+  // Publish a new immutable snapshot of 'tablets_by_key' for fast path
+  // lookups of the given table. Must be called whenever a table's entries in
+  // 'tablets_by_table_and_key_' change, with 'lock_' held for writing.
+  void PublishTableLocationsSnapshot(const std::string& table_id,
+                                     const TabletMap& tablets_by_key);
+
   // Update our information about the given tablet server.
   //
   // This is called when we get some response from the master which contains
@@ -453,16 +505,22 @@ class MetaCache : public RefCountedThreadSafe<MetaCache> {
   // Protected by lock_.
   TabletServerMap ts_cache_;
 
-  // Cache of tablets, keyed by partition key.
-  //
-  // Protected by lock_.
-  typedef std::map<std::string, MetaCacheEntry> TabletMap;
-
   // Cache of tablets and non-covered ranges, keyed by table id.
   //
   // Protected by lock_.
   std::unordered_map<std::string, TabletMap> tablets_by_table_and_key_;
 
+  // Immutable per-table snapshots of 'tablets_by_table_and_key_', swapped
+  // out wholesale whenever the underlying table's entries change.
+  //
+  // Protected by snapshot_lock_. A percpu_rwlock is used so that concurrent
+  // fast path lookups (which only hold the lock long enough to take a
+  // reference on a snapshot) don't contend on a shared cache line; 'lock_'
+  // must never be acquired while holding this lock.
+  mutable percpu_rwlock snapshot_lock_;
+  std::unordered_map<std::string,
+                     scoped_refptr<const TableLocationsSnapshot>> snapshots_by_table_;
+
   // Cache of tablets, keyed by tablet ID.
   //
   // Protected by lock_
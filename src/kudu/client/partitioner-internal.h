@@ -22,6 +22,7 @@
 
 #include "kudu/client/client.h"
 #include "kudu/client/shared_ptr.h"
+#include "kudu/common/partition.h"
 #include "kudu/util/monotime.h"
 #include "kudu/util/status.h"
 
@@ -71,6 +72,10 @@ class KuduPartitioner::Data {
   std::map<std::string, int> partitions_by_start_key_;
   int num_partitions_ = 0;
   std::string tmp_buf_;
+  // Memoizes hash bucket computations across consecutive PartitionRow()
+  // calls, which commonly share hash column values when callers route
+  // pre-sorted batches.
+  PartitionSchema::HashBucketCache bucket_cache_;
 };
 
 
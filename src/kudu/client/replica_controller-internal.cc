@@ -20,6 +20,8 @@
 #include "kudu/client/client.h"
 #include "kudu/client/client_builder-internal.h"
 #include "kudu/client/replica-internal.h"
+#include "kudu/client/scan_configuration.h"
+#include "kudu/client/scanner-internal.h"
 
 namespace kudu {
 namespace client {
@@ -35,6 +37,11 @@ bool ReplicaController::is_voter(const KuduReplica& replica) {
   return replica.data_->is_voter_;
 }
 
+Status ReplicaController::SetStalenessTolerance(KuduScanner* scanner,
+                                                const MonoDelta& tolerance) {
+  return scanner->data_->mutable_configuration()->SetStalenessTolerance(tolerance);
+}
+
 } // namespace internal
 } // namespace client
 } // namespace kudu
@@ -17,12 +17,17 @@
 #pragma once
 
 #include "kudu/gutil/macros.h"
+#include "kudu/util/status.h"
 
 namespace kudu {
+
+class MonoDelta;
+
 namespace client {
 
 class KuduClientBuilder;
 class KuduReplica;
+class KuduScanner;
 
 namespace internal {
 
@@ -46,6 +51,15 @@ class ReplicaController {
 
   static bool is_voter(const KuduReplica& replica);
 
+  // Bound the staleness of the given scanner instead of requiring fresh
+  // data: the scan is pinned to a snapshot no older than 'tolerance' behind
+  // the current time and may be served by any replica whose safe time has
+  // caught up to that snapshot. Combined with the latency-weighted
+  // CLOSEST_REPLICA selection, this spreads scanner load across all replicas
+  // of a hot tablet instead of concentrating it on the leader.
+  static Status SetStalenessTolerance(KuduScanner* scanner,
+                                      const MonoDelta& tolerance);
+
  private:
   ReplicaController();
 
@@ -180,6 +180,17 @@ void ScanConfiguration::SetSnapshotRaw(uint64_t snapshot_timestamp) {
   snapshot_timestamp_ = snapshot_timestamp;
 }
 
+Status ScanConfiguration::SetStalenessTolerance(const MonoDelta& tolerance) {
+  if (has_snapshot_timestamp()) {
+    return Status::IllegalState("staleness tolerance conflicts with an "
+                                "explicit snapshot timestamp");
+  }
+  RETURN_NOT_OK(SetReadMode(KuduScanner::READ_AT_SNAPSHOT));
+  RETURN_NOT_OK(SetSelection(KuduClient::CLOSEST_REPLICA));
+  staleness_tolerance_ = tolerance;
+  return Status::OK();
+}
+
 void ScanConfiguration::SetTimeoutMillis(int millis) {
   timeout_ = MonoDelta::FromMilliseconds(millis);
 }
@@ -86,6 +86,15 @@ class ScanConfiguration {
 
   void SetSnapshotRaw(uint64_t snapshot_timestamp);
 
+  // Bound the staleness of the scan instead of requiring fresh data: the
+  // scanner pins a READ_AT_SNAPSHOT timestamp no older than 'tolerance'
+  // behind the current time, so any replica whose safe time has caught up
+  // to that snapshot may serve the scan. Sets the read mode to
+  // READ_AT_SNAPSHOT and the replica selection to CLOSEST_REPLICA.
+  //
+  // Not yet exposed on KuduScanner; see internal::ReplicaController.
+  Status SetStalenessTolerance(const MonoDelta& tolerance) WARN_UNUSED_RESULT;
+
   void SetTimeoutMillis(int millis);
 
   Status SetRowFormatFlags(uint64_t flags);
@@ -144,6 +153,15 @@ class ScanConfiguration {
     return snapshot_timestamp_;
   }
 
+  bool has_staleness_tolerance() const {
+    return staleness_tolerance_.Initialized();
+  }
+
+  const MonoDelta& staleness_tolerance() const {
+    CHECK(has_staleness_tolerance());
+    return staleness_tolerance_;
+  }
+
   const MonoDelta& timeout() const {
     return timeout_;
   }
@@ -184,6 +202,10 @@ class ScanConfiguration {
 
   uint64_t snapshot_timestamp_;
 
+  // Maximum tolerated staleness for a freshness-bounded scan. Uninitialized
+  // unless SetStalenessTolerance() was called.
+  MonoDelta staleness_tolerance_;
+
   MonoDelta timeout_;
 
   // Manages interior allocations for the scan spec and copied bounds.
@@ -49,6 +49,9 @@
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/gutil/stl_util.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/rpc/rpc_controller.h"
+#include "kudu/tserver/tserver.pb.h"
+#include "kudu/tserver/tserver_service.proxy.h"
 #include "kudu/util/async_util.h"
 #include "kudu/util/monotime.h"
 #include "kudu/util/net/net_util.h"
@@ -192,7 +195,56 @@ Status KuduScanToken::Data::PBIntoScanner(KuduClient* client,
 }
 
 KuduScanTokenBuilder::Data::Data(KuduTable* table)
-    : configuration_(table) {
+    : configuration_(table),
+      split_size_bytes_(0) {
+}
+
+Status KuduScanTokenBuilder::Data::SplitKeyRanges(
+    KuduClient* client,
+    const scoped_refptr<internal::RemoteTablet>& tablet,
+    const vector<internal::RemoteReplica>& replicas,
+    const ScanTokenPB& pb,
+    vector<KeyRangePB>* ranges) {
+  // Prefer the leader replica, which is guaranteed to have the most
+  // up-to-date view of the tablet's rowsets.
+  internal::RemoteTabletServer* ts = nullptr;
+  for (const auto& r : replicas) {
+    if (r.role == consensus::RaftPeerPB::LEADER) {
+      ts = r.ts;
+      break;
+    }
+  }
+  if (ts == nullptr && !replicas.empty()) {
+    ts = replicas[0].ts;
+  }
+  if (ts == nullptr) {
+    return Status::IllegalState("no replica available to split key range "
+                                "for tablet", tablet->tablet_id());
+  }
+
+  Synchronizer init_sync;
+  ts->InitProxy(client, init_sync.AsStatusCallback());
+  RETURN_NOT_OK(init_sync.Wait());
+
+  tserver::SplitKeyRangeRequestPB req;
+  req.set_tablet_id(tablet->tablet_id());
+  if (pb.has_lower_bound_primary_key()) {
+    req.set_start_primary_key(pb.lower_bound_primary_key());
+  }
+  if (pb.has_upper_bound_primary_key()) {
+    req.set_stop_primary_key(pb.upper_bound_primary_key());
+  }
+  req.set_target_chunk_size_bytes(split_size_bytes_);
+
+  tserver::SplitKeyRangeResponsePB resp;
+  rpc::RpcController controller;
+  controller.set_timeout(client->default_rpc_timeout());
+  RETURN_NOT_OK(ts->proxy()->SplitKeyRange(req, &resp, &controller));
+  if (resp.has_error()) {
+    return StatusFromPB(resp.error().status());
+  }
+  ranges->assign(resp.ranges().begin(), resp.ranges().end());
+  return Status::OK();
 }
 
 Status KuduScanTokenBuilder::Data::Build(vector<KuduScanToken*>* tokens) {
@@ -291,47 +343,78 @@ Status KuduScanTokenBuilder::Data::Build(vector<KuduScanToken*>* tokens) {
     vector<internal::RemoteReplica> replicas;
     tablet->GetRemoteReplicas(&replicas);
 
-    vector<const KuduReplica*> client_replicas;
-    ElementDeleter deleter(&client_replicas);
-
-    // Convert the replicas from their internal format to something appropriate
-    // for clients.
-    for (const auto& r : replicas) {
-      vector<HostPort> host_ports;
-      r.ts->GetHostPorts(&host_ports);
-      if (host_ports.empty()) {
-        return Status::IllegalState(Substitute(
-            "No host found for tablet server $0", r.ts->ToString()));
+    // Determine the primary key ranges to tokenize. By default a tablet
+    // becomes a single token; if a split size was set, ask the tablet
+    // server to split the tablet's key space into ranges of roughly that
+    // size so that one large tablet can be scanned in parallel.
+    vector<KeyRangePB> ranges;
+    if (split_size_bytes_ > 0) {
+      RETURN_NOT_OK(SplitKeyRanges(client, tablet, replicas, pb, &ranges));
+    }
+    if (ranges.empty()) {
+      KeyRangePB whole_tablet;
+      if (pb.has_lower_bound_primary_key()) {
+        whole_tablet.set_start_primary_key(pb.lower_bound_primary_key());
+      }
+      if (pb.has_upper_bound_primary_key()) {
+        whole_tablet.set_stop_primary_key(pb.upper_bound_primary_key());
       }
-      unique_ptr<KuduTabletServer> client_ts(new KuduTabletServer);
-      client_ts->data_ = new KuduTabletServer::Data(r.ts->permanent_uuid(),
-                                                    host_ports[0]);
-      bool is_leader = r.role == consensus::RaftPeerPB::LEADER;
-      bool is_voter = is_leader || r.role == consensus::RaftPeerPB::FOLLOWER;
-      unique_ptr<KuduReplica> client_replica(new KuduReplica);
-      client_replica->data_ = new KuduReplica::Data(is_leader, is_voter,
-                                                    std::move(client_ts));
-      client_replicas.push_back(client_replica.release());
+      ranges.emplace_back(std::move(whole_tablet));
     }
 
-    unique_ptr<KuduTablet> client_tablet(new KuduTablet);
-    client_tablet->data_ = new KuduTablet::Data(tablet->tablet_id(),
-                                                std::move(client_replicas));
-    client_replicas.clear();
-
-    // Create the scan token itself.
-    ScanTokenPB message;
-    message.CopyFrom(pb);
-    message.set_lower_bound_partition_key(
-        tablet->partition().partition_key_start());
-    message.set_upper_bound_partition_key(
-        tablet->partition().partition_key_end());
-    unique_ptr<KuduScanToken> client_scan_token(new KuduScanToken);
-    client_scan_token->data_ =
-        new KuduScanToken::Data(table,
-                                std::move(message),
-                                std::move(client_tablet));
-    tokens->push_back(client_scan_token.release());
+    for (const KeyRangePB& range : ranges) {
+      vector<const KuduReplica*> client_replicas;
+      ElementDeleter deleter(&client_replicas);
+
+      // Convert the replicas from their internal format to something appropriate
+      // for clients.
+      for (const auto& r : replicas) {
+        vector<HostPort> host_ports;
+        r.ts->GetHostPorts(&host_ports);
+        if (host_ports.empty()) {
+          return Status::IllegalState(Substitute(
+              "No host found for tablet server $0", r.ts->ToString()));
+        }
+        unique_ptr<KuduTabletServer> client_ts(new KuduTabletServer);
+        client_ts->data_ = new KuduTabletServer::Data(r.ts->permanent_uuid(),
+                                                      host_ports[0]);
+        bool is_leader = r.role == consensus::RaftPeerPB::LEADER;
+        bool is_voter = is_leader || r.role == consensus::RaftPeerPB::FOLLOWER;
+        unique_ptr<KuduReplica> client_replica(new KuduReplica);
+        client_replica->data_ = new KuduReplica::Data(is_leader, is_voter,
+                                                      std::move(client_ts));
+        client_replicas.push_back(client_replica.release());
+      }
+
+      unique_ptr<KuduTablet> client_tablet(new KuduTablet);
+      client_tablet->data_ = new KuduTablet::Data(tablet->tablet_id(),
+                                                  std::move(client_replicas));
+      client_replicas.clear();
+
+      // Create the scan token itself.
+      ScanTokenPB message;
+      message.CopyFrom(pb);
+      if (range.has_start_primary_key()) {
+        message.set_lower_bound_primary_key(range.start_primary_key());
+      } else {
+        message.clear_lower_bound_primary_key();
+      }
+      if (range.has_stop_primary_key()) {
+        message.set_upper_bound_primary_key(range.stop_primary_key());
+      } else {
+        message.clear_upper_bound_primary_key();
+      }
+      message.set_lower_bound_partition_key(
+          tablet->partition().partition_key_start());
+      message.set_upper_bound_partition_key(
+          tablet->partition().partition_key_end());
+      unique_ptr<KuduScanToken> client_scan_token(new KuduScanToken);
+      client_scan_token->data_ =
+          new KuduScanToken::Data(table,
+                                  std::move(message),
+                                  std::move(client_tablet));
+      tokens->push_back(client_scan_token.release());
+    }
     pruner.RemovePartitionKeyRange(tablet->partition().partition_key_end());
   }
   return Status::OK();
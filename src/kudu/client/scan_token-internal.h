@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -24,11 +25,18 @@
 #include "kudu/client/client.h"
 #include "kudu/client/client.pb.h"
 #include "kudu/client/scan_configuration.h"
+#include "kudu/common/common.pb.h"
+#include "kudu/gutil/ref_counted.h"
 #include "kudu/util/status.h"
 
 namespace kudu {
 namespace client {
 
+namespace internal {
+class RemoteTablet;
+struct RemoteReplica;
+} // namespace internal
+
 class KuduScanToken::Data {
  public:
   explicit Data(KuduTable* table,
@@ -72,8 +80,25 @@ class KuduScanTokenBuilder::Data {
     return &configuration_;
   }
 
+  void SetSplitSizeBytes(uint64_t split_size_bytes) {
+    split_size_bytes_ = split_size_bytes;
+  }
+
  private:
+  // Ask the leader replica of 'tablet' to split its key space into ranges
+  // of roughly 'split_size_bytes_' each, bounded by the scan's primary key
+  // bounds in 'pb'.
+  Status SplitKeyRanges(KuduClient* client,
+                        const scoped_refptr<internal::RemoteTablet>& tablet,
+                        const std::vector<internal::RemoteReplica>& replicas,
+                        const ScanTokenPB& pb,
+                        std::vector<KeyRangePB>* ranges);
+
   ScanConfiguration configuration_;
+
+  // If non-zero, Build() produces one token per key range of roughly this
+  // many bytes within each tablet, instead of one token per tablet.
+  uint64_t split_size_bytes_;
 };
 
 } // namespace client
@@ -19,6 +19,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <memory>
 #include <ostream>
 #include <string>
 #include <unordered_map>
@@ -35,9 +36,12 @@
 #include "kudu/common/partition.h"
 #include "kudu/common/scan_spec.h"
 #include "kudu/common/schema.h"
+#include "kudu/common/types.h"
 #include "kudu/common/wire_protocol.h"
 #include "kudu/gutil/port.h"
+#include "kudu/gutil/stl_util.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/gutil/walltime.h"
 #include "kudu/rpc/connection.h"
 #include "kudu/rpc/rpc_controller.h"
 #include "kudu/rpc/rpc_header.pb.h"
@@ -291,6 +295,7 @@ ScanRpcStatus KuduScanner::Data::SendScanRpc(const MonoTime& overall_deadline,
   if (configuration().row_format_flags() & KuduScanner::PAD_UNIXTIME_MICROS_TO_16_BYTES) {
     controller_.RequireServerFeature(TabletServerFeatures::PAD_UNIXTIME_MICROS_TO_16_BYTES);
   }
+  const MonoTime rpc_start = MonoTime::Now();
   ScanRpcStatus scan_status = AnalyzeResponse(
       proxy_->Scan(next_req_,
                    &last_response_,
@@ -298,6 +303,9 @@ ScanRpcStatus KuduScanner::Data::SendScanRpc(const MonoTime& overall_deadline,
       rpc_deadline, overall_deadline);
   if (scan_status.result == ScanRpcStatus::OK) {
     UpdateResourceMetrics();
+    // Feed the observed round-trip time back into the meta cache so that
+    // replica selection can weight future scans towards faster servers.
+    ts_->RecordScanLatency((MonoTime::Now() - rpc_start).ToMicroseconds());
   }
   return scan_status;
 }
@@ -321,6 +329,16 @@ Status KuduScanner::Data::OpenTablet(const string& partition_key,
       break;
     case KuduScanner::READ_AT_SNAPSHOT:
       scan->set_read_mode(kudu::READ_AT_SNAPSHOT);
+      if (!configuration_.has_snapshot_timestamp() &&
+          configuration_.has_staleness_tolerance()) {
+        // Freshness-bounded scan: pin the snapshot to the oldest point in
+        // time the caller is willing to read at. Replicas whose safe time
+        // has reached that point can serve the scan without waiting on the
+        // leader, leaving the scanner free to spread load across followers.
+        configuration_.SetSnapshotMicros(
+            GetCurrentTimeMicros() -
+            configuration_.staleness_tolerance().ToMicroseconds());
+      }
       if (configuration_.has_snapshot_timestamp()) {
         scan->set_snap_timestamp(configuration_.snapshot_timestamp());
       }
@@ -623,5 +641,195 @@ void KuduScanBatch::Data::Clear() {
   controller_.Reset();
 }
 
+////////////////////////////////////////////////////////////
+// KuduMergeScanner
+////////////////////////////////////////////////////////////
+
+// Sentinel for loser tree nodes which haven't yet had a match played at them
+// during a rebuild. See MergeIterator in common/generic_iterators.cc.
+static const size_t kInvalidTreeEntry = ~static_cast<size_t>(0);
+
+KuduMergeScanner::Data::Data(KuduTable* table)
+    : table_(table),
+      token_builder_(table),
+      open_(false) {
+}
+
+KuduMergeScanner::Data::~Data() {
+}
+
+Status KuduMergeScanner::Data::OpenSources(const Schema* table_schema) {
+  CHECK(!open_);
+
+  // The merge compares rows by primary key, so the projection must contain
+  // every key column. Map each key column to its index in the projection.
+  key_idxs_.clear();
+  key_types_.clear();
+  for (size_t i = 0; i < table_schema->num_key_columns(); i++) {
+    const ColumnSchema& col = table_schema->column(i);
+    int idx;
+    if (projected_names_.empty()) {
+      // No explicit projection: all columns, in table schema order.
+      idx = static_cast<int>(i);
+    } else {
+      auto it = std::find(projected_names_.begin(), projected_names_.end(),
+                          col.name());
+      if (it == projected_names_.end()) {
+        return Status::InvalidArgument(Substitute(
+            "ordered scan projection must include all primary key columns: "
+            "column '$0' is missing", col.name()));
+      }
+      idx = static_cast<int>(it - projected_names_.begin());
+    }
+    key_idxs_.push_back(idx);
+    key_types_.push_back(col.type_info());
+  }
+
+  // Fault-tolerant scans return rows in primary key order within each
+  // tablet, which the merge relies on.
+  RETURN_NOT_OK(token_builder_.SetFaultTolerant());
+
+  vector<KuduScanToken*> tokens;
+  ElementDeleter deleter(&tokens);
+  RETURN_NOT_OK(token_builder_.Build(&tokens));
+
+  for (KuduScanToken* token : tokens) {
+    std::unique_ptr<MergeSource> source(new MergeSource());
+    KuduScanner* scanner;
+    RETURN_NOT_OK(token->IntoKuduScanner(&scanner));
+    source->scanner.reset(scanner);
+    RETURN_NOT_OK(scanner->Open());
+
+    // Drop tablets with no matching rows up front so that the tree below
+    // only ever contains sources with a valid head row.
+    bool has_rows;
+    RETURN_NOT_OK(PullNextBatch(source.get(), &has_rows));
+    if (has_rows) {
+      sources_.push_back(std::move(source));
+    }
+  }
+
+  RebuildLoserTree();
+  open_ = true;
+  return Status::OK();
+}
+
+Status KuduMergeScanner::Data::NextRows(vector<KuduScanBatch::RowPtr>* rows) {
+  CHECK(open_);
+  rows->clear();
+
+  // Drained batches are refilled up front rather than as they empty so
+  // that the RowPtrs handed out by the previous call stay valid until
+  // this one.
+  RETURN_NOT_OK(RefillExhaustedSources());
+
+  while (!sources_.empty()) {
+    // The root of the loser tree tracks the source whose head row is
+    // smallest.
+    size_t smallest_idx = loser_tree_[0];
+    MergeSource* smallest = sources_[smallest_idx].get();
+
+    rows->push_back(smallest->batch.Row(smallest->row_idx));
+    smallest->row_idx++;
+    if (smallest->row_idx >= smallest->batch.NumRows()) {
+      // Fetching the next batch now would invalidate the rows already
+      // handed out, so stop here; the next call refills this source.
+      break;
+    }
+
+    // Replay the matches on the winner's root path against its new head row.
+    ReplayLoserTree(smallest_idx);
+  }
+  return Status::OK();
+}
+
+void KuduMergeScanner::Data::Close() {
+  sources_.clear();
+  loser_tree_.clear();
+  open_ = false;
+}
+
+Status KuduMergeScanner::Data::PullNextBatch(MergeSource* source, bool* has_rows) {
+  source->row_idx = 0;
+  while (source->scanner->HasMoreRows()) {
+    RETURN_NOT_OK(source->scanner->NextBatch(&source->batch));
+    if (source->batch.NumRows() > 0) {
+      *has_rows = true;
+      return Status::OK();
+    }
+  }
+  *has_rows = false;
+  return Status::OK();
+}
+
+Status KuduMergeScanner::Data::RefillExhaustedSources() {
+  bool changed = false;
+  for (auto it = sources_.begin(); it != sources_.end();) {
+    MergeSource* source = it->get();
+    if (source->row_idx < source->batch.NumRows()) {
+      ++it;
+      continue;
+    }
+    changed = true;
+    bool has_rows;
+    RETURN_NOT_OK(PullNextBatch(source, &has_rows));
+    if (has_rows) {
+      ++it;
+    } else {
+      it = sources_.erase(it);
+    }
+  }
+  if (changed) {
+    // Either a head row changed or the leaf indices shifted; in both cases
+    // the matches recorded in the tree are stale. This is cheap relative
+    // to the batch of rows it amortizes over.
+    RebuildLoserTree();
+  }
+  return Status::OK();
+}
+
+int KuduMergeScanner::Data::CompareSourceRows(const MergeSource& a,
+                                              const MergeSource& b) const {
+  KuduScanBatch::RowPtr row_a = a.batch.Row(a.row_idx);
+  KuduScanBatch::RowPtr row_b = b.batch.Row(b.row_idx);
+  for (size_t i = 0; i < key_idxs_.size(); i++) {
+    int c = key_types_[i]->Compare(row_a.cell(key_idxs_[i]),
+                                   row_b.cell(key_idxs_[i]));
+    if (c != 0) return c;
+  }
+  return 0;
+}
+
+bool KuduMergeScanner::Data::SourceLessThan(size_t a, size_t b) const {
+  int c = CompareSourceRows(*sources_[a], *sources_[b]);
+  return c < 0 || (c == 0 && a < b);
+}
+
+void KuduMergeScanner::Data::ReplayLoserTree(size_t leaf_idx) {
+  const size_t k = sources_.size();
+  size_t winner = leaf_idx;
+  for (size_t node = (leaf_idx + k) / 2; node > 0; node /= 2) {
+    size_t& loser = loser_tree_[node];
+    if (PREDICT_FALSE(loser == kInvalidTreeEntry)) {
+      // Still rebuilding: deposit the current winner at the first node which
+      // hasn't played a match yet.
+      loser = winner;
+      return;
+    }
+    if (SourceLessThan(loser, winner)) {
+      std::swap(loser, winner);
+    }
+  }
+  loser_tree_[0] = winner;
+}
+
+void KuduMergeScanner::Data::RebuildLoserTree() {
+  const size_t k = sources_.size();
+  loser_tree_.assign(std::max<size_t>(k, 1), kInvalidTreeEntry);
+  for (size_t i = 0; i < k; i++) {
+    ReplayLoserTree(i);
+  }
+}
+
 } // namespace client
 } // namespace kudu
@@ -340,6 +340,82 @@ class KuduScanBatch::Data {
   size_t projected_row_size_;
 };
 
+class KuduMergeScanner::Data {
+ public:
+  explicit Data(KuduTable* table);
+  ~Data();
+
+  // State for one per-tablet scanner feeding the merge.
+  struct MergeSource {
+    MergeSource() : row_idx(0) {}
+
+    std::unique_ptr<KuduScanner> scanner;
+    KuduScanBatch batch;
+
+    // Index within 'batch' of the head row, i.e. the next row to emit.
+    int row_idx;
+  };
+
+  // Opens one fault-tolerant scanner per tablet, pulls the first batch
+  // from each, and builds the tournament tree over the head rows.
+  // 'table_schema' is the table's internal schema, used to locate the
+  // primary key columns within the projection.
+  Status OpenSources(const Schema* table_schema);
+
+  // Emits rows in primary key order until one of the sources drains its
+  // current batch. The returned RowPtr objects stay valid until the next
+  // call (see the comment in the implementation).
+  Status NextRows(std::vector<KuduScanBatch::RowPtr>* rows);
+
+  bool HasMoreRows() const {
+    return open_ && !sources_.empty();
+  }
+
+  void Close();
+
+  // Pulls batches from 'source' until a non-empty one arrives or the
+  // underlying scanner is exhausted. Sets 'has_rows' accordingly.
+  Status PullNextBatch(MergeSource* source, bool* has_rows);
+
+  // Refills (or removes) any source whose current batch has been fully
+  // emitted, rebuilding the tournament tree if any head rows changed.
+  Status RefillExhaustedSources();
+
+  // Three-way comparison of the head rows of two sources by primary key.
+  int CompareSourceRows(const MergeSource& a, const MergeSource& b) const;
+
+  // Tournament tree operations. These mirror MergeIterator in
+  // common/generic_iterators.cc; see there for a description of the
+  // tree layout.
+  bool SourceLessThan(size_t a, size_t b) const;
+  void ReplayLoserTree(size_t leaf_idx);
+  void RebuildLoserTree();
+
+  KuduTable* table_;
+
+  // Used to create the per-tablet scanners in OpenSources().
+  KuduScanTokenBuilder token_builder_;
+
+  // The projected column names, or empty if SetProjectedColumnNames()
+  // was never called (i.e. all columns are projected).
+  std::vector<std::string> projected_names_;
+
+  bool open_;
+
+  // For each primary key column, in table key order: its index in the
+  // projection and its type.
+  std::vector<int> key_idxs_;
+  std::vector<const TypeInfo*> key_types_;
+
+  // The per-tablet sources which still have rows left. Sources are
+  // removed as their scanners are exhausted.
+  std::vector<std::unique_ptr<MergeSource>> sources_;
+
+  // Loser tree over 'sources_'. The root (element 0) holds the index of
+  // the source whose head row is smallest.
+  std::vector<size_t> loser_tree_;
+};
+
 } // namespace client
 } // namespace kudu
 
@@ -71,6 +71,7 @@ class KUDU_EXPORT KuduColumnStorageAttributes {
     RLE = 4,
     DICT_ENCODING = 5,
     BIT_SHUFFLE = 6,
+    BITMAP = 7,
 
     /// @deprecated GROUP_VARINT is not supported for valid types, and
     /// will fall back to another encoding on the server side.
@@ -500,6 +501,7 @@ class KUDU_EXPORT KuduSchema {
  private:
   friend class ClientTest;
   friend class KuduClient;
+  friend class KuduMergeScanner;
   friend class KuduScanner;
   friend class KuduScanToken;
   friend class KuduScanTokenBuilder;
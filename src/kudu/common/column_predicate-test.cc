@@ -26,10 +26,13 @@
 #include <gflags/gflags.h>
 #include <gtest/gtest.h>
 
+#include "kudu/common/columnblock.h"
 #include "kudu/common/common.pb.h"
+#include "kudu/common/rowblock.h"
 #include "kudu/common/schema.h"
 #include "kudu/common/types.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/bloom_filter.h"
 #include "kudu/util/memory/arena.h"
 #include "kudu/util/slice.h"
 #include "kudu/util/test_util.h"
@@ -1047,6 +1050,75 @@ TEST_F(TestColumnPredicate, TestInList) {
   }
 }
 
+TEST_F(TestColumnPredicate, TestInBloomFilter) {
+  ColumnSchema column("c", INT32);
+
+  // Build a bloom filter containing the even values in [0, 100).
+  BloomFilterBuilder bfb(BloomFilterSizing::ByCountAndFPRate(50, 0.01));
+  for (int32_t v = 0; v < 100; v += 2) {
+    bfb.AddKey(BloomKeyProbe(Slice(reinterpret_cast<const uint8_t*>(&v), sizeof(v))));
+  }
+  BloomFilter bf(bfb.slice(), bfb.n_hashes());
+  ColumnPredicate bloom_pred = ColumnPredicate::InBloomFilter(column, &bf);
+  ASSERT_EQ(PredicateType::InBloomFilter, bloom_pred.predicate_type());
+
+  // Inserted values must always be found. Values not inserted may be false
+  // positives, but at a 1% false positive rate not many of them.
+  int false_positives = 0;
+  for (int32_t v = 0; v < 100; v++) {
+    bool may_contain = bloom_pred.EvaluateCell<INT32>(&v);
+    if (v % 2 == 0) {
+      ASSERT_TRUE(may_contain) << v;
+    } else if (may_contain) {
+      false_positives++;
+    }
+  }
+  ASSERT_LT(false_positives, 25);
+
+  // Block evaluation must agree with the cell-at-a-time results.
+  vector<int32_t> values(100);
+  for (int32_t i = 0; i < 100; i++) {
+    values[i] = i;
+  }
+  ColumnBlock block(GetTypeInfo(INT32), nullptr, values.data(), values.size(), nullptr);
+  SelectionVector sel(values.size());
+  sel.SetAllTrue();
+  bloom_pred.Evaluate(block, &sel);
+  for (size_t i = 0; i < values.size(); i++) {
+    ASSERT_EQ(bloom_pred.EvaluateCell<INT32>(&values[i]), sel.IsRowSelected(i)) << "row " << i;
+  }
+
+  // Merging with an exact range predicate drops the approximate filter. This
+  // is safe, since the filter only admits additional false positives, which
+  // the consumer of the filter must handle anyway.
+  int32_t zero = 0;
+  int32_t ten = 10;
+  TestMerge(bloom_pred,
+            ColumnPredicate::Range(column, &zero, &ten),
+            ColumnPredicate::Range(column, &zero, &ten),
+            PredicateType::Range);
+
+  // An equality value contained in the filter is retained.
+  int32_t two = 2;
+  TestMerge(bloom_pred,
+            ColumnPredicate::Equality(column, &two),
+            ColumnPredicate::Equality(column, &two),
+            PredicateType::Equality);
+
+  // IS NOT NULL does not affect the filter.
+  TestMerge(bloom_pred,
+            ColumnPredicate::IsNotNull(column),
+            bloom_pred,
+            PredicateType::InBloomFilter);
+
+  // IS NULL can never pass the filter.
+  ColumnSchema nullable_column("n", INT32, true);
+  TestMerge(ColumnPredicate::InBloomFilter(nullable_column, &bf),
+            ColumnPredicate::IsNull(nullable_column),
+            ColumnPredicate::None(nullable_column),
+            PredicateType::None);
+}
+
 // Test that column predicate comparison works correctly: ordered by predicate
 // type first, then size of the column type.
 TEST_F(TestColumnPredicate, TestSelectivity) {
@@ -1092,6 +1164,41 @@ TEST_F(TestColumnPredicate, TestSelectivity) {
             0);
 }
 
+// Test that the batched (SIMD-capable) evaluation path over a non-nullable
+// column block agrees with the cell-at-a-time EvaluateCell() results,
+// including for the scalar-evaluated tail of rows past the last full batch.
+TEST_F(TestColumnPredicate, TestBatchedEvaluate) {
+  // An awkward row count: three full batches of 32, plus a 5-row tail.
+  const size_t kNumRows = 101;
+  ColumnSchema column("a", INT32, false);
+
+  vector<int32_t> values(kNumRows);
+  for (size_t i = 0; i < kNumRows; i++) {
+    values[i] = static_cast<int32_t>(i % 16);
+  }
+  ColumnBlock block(GetTypeInfo(INT32), nullptr, values.data(), kNumRows, nullptr);
+
+  int32_t lower = 3;
+  int32_t upper = 9;
+  for (const auto& pred : { ColumnPredicate::Range(column, &lower, &upper),
+                            ColumnPredicate::Range(column, &lower, nullptr),
+                            ColumnPredicate::Range(column, nullptr, &upper),
+                            ColumnPredicate::Equality(column, &lower) }) {
+    SCOPED_TRACE(pred.ToString());
+    SelectionVector sel(kNumRows);
+    sel.SetAllTrue();
+    // Clear a few bits up front to check that already-deselected rows stay
+    // deselected.
+    sel.SetRowUnselected(0);
+    sel.SetRowUnselected(50);
+    pred.Evaluate(block, &sel);
+    for (size_t i = 0; i < kNumRows; i++) {
+      bool expected = i != 0 && i != 50 && pred.EvaluateCell<INT32>(&values[i]);
+      ASSERT_EQ(expected, sel.IsRowSelected(i)) << "row " << i;
+    }
+  }
+}
+
 TEST_F(TestColumnPredicate, TestRedaction) {
   ASSERT_NE("", gflags::SetCommandLineOption("redact", "log"));
   ColumnSchema column_i32("a", INT32, true);
@@ -18,7 +18,9 @@
 #include "kudu/common/column_predicate.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <cstring>
+#include <type_traits>
 
 #include <boost/optional/optional.hpp>
 
@@ -27,6 +29,8 @@
 #include "kudu/common/rowblock.h"
 #include "kudu/common/schema.h"
 #include "kudu/common/types.h"
+#include "kudu/gutil/cpu.h"
+#include "kudu/gutil/port.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/util/bitmap.h"
 #include "kudu/util/memory/arena.h"
@@ -44,7 +48,8 @@ ColumnPredicate::ColumnPredicate(PredicateType predicate_type,
     : predicate_type_(predicate_type),
       column_(move(column)),
       lower_(lower),
-      upper_(upper) {
+      upper_(upper),
+      bloom_filter_(nullptr) {
 }
 
 ColumnPredicate::ColumnPredicate(PredicateType predicate_type,
@@ -53,10 +58,21 @@ ColumnPredicate::ColumnPredicate(PredicateType predicate_type,
     : predicate_type_(predicate_type),
       column_(move(column)),
       lower_(nullptr),
-      upper_(nullptr) {
+      upper_(nullptr),
+      bloom_filter_(nullptr) {
   values_.swap(*values);
 }
 
+ColumnPredicate::ColumnPredicate(PredicateType predicate_type,
+                                 ColumnSchema column,
+                                 const BloomFilter* bloom_filter)
+    : predicate_type_(predicate_type),
+      column_(move(column)),
+      lower_(nullptr),
+      upper_(nullptr),
+      bloom_filter_(bloom_filter) {
+}
+
 ColumnPredicate ColumnPredicate::Equality(ColumnSchema column, const void* value) {
   CHECK(value != nullptr);
   return ColumnPredicate(PredicateType::Equality, move(column), value, nullptr);
@@ -155,6 +171,12 @@ ColumnPredicate ColumnPredicate::IsNull(ColumnSchema column) {
          None(move(column));
 }
 
+ColumnPredicate ColumnPredicate::InBloomFilter(ColumnSchema column,
+                                               const BloomFilter* bloom_filter) {
+  CHECK(bloom_filter != nullptr);
+  return ColumnPredicate(PredicateType::InBloomFilter, move(column), bloom_filter);
+}
+
 ColumnPredicate ColumnPredicate::None(ColumnSchema column) {
   return ColumnPredicate(PredicateType::None, move(column), nullptr, nullptr);
 }
@@ -163,6 +185,7 @@ void ColumnPredicate::SetToNone() {
   predicate_type_ = PredicateType::None;
   lower_ = nullptr;
   upper_ = nullptr;
+  bloom_filter_ = nullptr;
 }
 
 void ColumnPredicate::Simplify() {
@@ -172,6 +195,7 @@ void ColumnPredicate::Simplify() {
     case PredicateType::Equality:
     case PredicateType::IsNotNull: return;
     case PredicateType::IsNull: return;
+    case PredicateType::InBloomFilter: return;
     case PredicateType::Range: {
       DCHECK(lower_ != nullptr || upper_ != nullptr);
       if (lower_ != nullptr && upper_ != nullptr) {
@@ -253,6 +277,10 @@ void ColumnPredicate::Merge(const ColumnPredicate& other) {
       MergeIntoInList(other);
       return;
     };
+    case PredicateType::InBloomFilter: {
+      MergeIntoBloomFilter(other);
+      return;
+    };
   }
   LOG(FATAL) << "unknown predicate type";
 }
@@ -319,6 +347,12 @@ void ColumnPredicate::MergeIntoRange(const ColumnPredicate& other) {
       Simplify();
       return;
     };
+    case PredicateType::InBloomFilter: {
+      // Keep the exact range predicate. Dropping the bloom filter check is
+      // safe since an InBloomFilter predicate only admits additional false
+      // positives, which the caller must handle anyway.
+      return;
+    };
   }
   LOG(FATAL) << "unknown predicate type";
 }
@@ -356,6 +390,13 @@ void ColumnPredicate::MergeIntoEquality(const ColumnPredicate& other) {
       }
       return;
     };
+    case PredicateType::InBloomFilter: {
+      // The equality value needs to (possibly) be in the bloom filter.
+      if (!other.EvaluateCell(column_.type_info()->physical_type(), lower_)) {
+        SetToNone();
+      }
+      return;
+    };
   }
   LOG(FATAL) << "unknown predicate type";
 }
@@ -374,6 +415,7 @@ void ColumnPredicate::MergeIntoIsNotNull(const ColumnPredicate &other) {
       lower_ = other.lower_;
       upper_ = other.upper_;
       values_ = other.values_;
+      bloom_filter_ = other.bloom_filter_;
       return;
     }
   }
@@ -495,11 +537,246 @@ void ColumnPredicate::MergeIntoInList(const ColumnPredicate &other) {
       Simplify();
       return;
     };
+    case PredicateType::InBloomFilter: {
+      // Retain only the values which may be in the bloom filter.
+      const DataType physical_type = column_.type_info()->physical_type();
+      values_.erase(std::remove_if(values_.begin(), values_.end(),
+                                   [&] (const void* v) {
+                                     return !other.EvaluateCell(physical_type, v);
+                                   }), values_.end());
+      Simplify();
+      return;
+    };
+  }
+  LOG(FATAL) << "unknown predicate type";
+}
+
+void ColumnPredicate::MergeIntoBloomFilter(const ColumnPredicate& other) {
+  CHECK(predicate_type_ == PredicateType::InBloomFilter);
+
+  switch (other.predicate_type()) {
+    case PredicateType::None: {
+      SetToNone();
+      return;
+    };
+    case PredicateType::Range: {
+      // Become the exact range predicate. Dropping the bloom filter check is
+      // safe since an InBloomFilter predicate only admits additional false
+      // positives, which the caller must handle anyway.
+      predicate_type_ = PredicateType::Range;
+      lower_ = other.lower_;
+      upper_ = other.upper_;
+      bloom_filter_ = nullptr;
+      Simplify();
+      return;
+    };
+    case PredicateType::Equality: {
+      if (EvaluateCell(column_.type_info()->physical_type(), other.lower_)) {
+        predicate_type_ = PredicateType::Equality;
+        lower_ = other.lower_;
+        bloom_filter_ = nullptr;
+      } else {
+        SetToNone();
+      }
+      return;
+    };
+    case PredicateType::IsNotNull: return;
+    case PredicateType::IsNull: {
+      SetToNone();
+      return;
+    };
+    case PredicateType::InList: {
+      // Retain only the values which may be in the bloom filter.
+      const DataType physical_type = column_.type_info()->physical_type();
+      values_ = other.values_;
+      values_.erase(std::remove_if(values_.begin(), values_.end(),
+                                   [&] (const void* v) {
+                                     return !EvaluateCell(physical_type, v);
+                                   }), values_.end());
+      predicate_type_ = PredicateType::InList;
+      bloom_filter_ = nullptr;
+      Simplify();
+      return;
+    };
+    case PredicateType::InBloomFilter: {
+      // Keep this bloom filter. A single predicate can only carry one bloom
+      // filter; admitting the other filter's false positives is safe.
+      return;
+    };
   }
   LOG(FATAL) << "unknown predicate type";
 }
 
 namespace {
+
+// Batched predicate evaluation
+// ----------------------------
+// For fixed-width physical types on non-nullable blocks, the cell values are
+// laid out contiguously, so range and equality predicates can be evaluated a
+// batch of cells at a time. Each batch produces a bitmask of the passing rows
+// which is ANDed directly into the selection vector, avoiding the per-row
+// branch on the selection bit. The batch kernels are additionally compiled
+// with AVX2 and AVX-512 codegen enabled; since the loops have a fixed trip
+// count and compare against loop-invariant bounds, they compile down to
+// vector compares plus a movemask. The right kernel for the runtime CPU is
+// picked once per instantiation (see ChooseBatchEvalFn() below), with the
+// plain scalar build as the fallback.
+
+constexpr size_t kEvalBatchSize = 32;
+
+enum class BatchOp {
+  // Selected iff lower <= cell < upper.
+  RANGE_BOTH,
+  // Selected iff lower <= cell.
+  RANGE_LOWER,
+  // Selected iff cell < upper.
+  RANGE_UPPER,
+  // Selected iff cell == lower.
+  EQUALITY,
+};
+
+// Evaluate 'OP' on a single cell. The comparisons are phrased exclusively in
+// terms of operator< so that the results match GenericCompare<>() exactly,
+// including for NaN floating-point values, which compare as equal to
+// everything there.
+template <typename T, BatchOp OP>
+ATTRIBUTE_ALWAYS_INLINE
+inline bool EvalCellForBatchOp(T cell, T lower, T upper) {
+  switch (OP) {
+    case BatchOp::RANGE_BOTH: return cell < upper && !(cell < lower);
+    case BatchOp::RANGE_LOWER: return !(cell < lower);
+    case BatchOp::RANGE_UPPER: return cell < upper;
+    case BatchOp::EQUALITY: return !(cell < lower) && !(lower < cell);
+  }
+  return false; // unreachable
+}
+
+// Evaluate 'OP' on a batch of kEvalBatchSize cells, returning a bitmask of
+// the cells for which the predicate holds.
+template <typename T, BatchOp OP>
+ATTRIBUTE_ALWAYS_INLINE
+inline uint32_t EvalBatch(const T* cells, T lower, T upper) {
+  uint32_t mask = 0;
+  for (size_t i = 0; i < kEvalBatchSize; i++) {
+    mask |= static_cast<uint32_t>(EvalCellForBatchOp<T, OP>(cells[i], lower, upper)) << i;
+  }
+  return mask;
+}
+
+template <typename T, BatchOp OP>
+uint32_t EvalBatchScalar(const T* cells, T lower, T upper) {
+  return EvalBatch<T, OP>(cells, lower, upper);
+}
+
+#if defined(__x86_64__) && !defined(__APPLE__)
+template <typename T, BatchOp OP>
+__attribute__((target("avx2")))
+uint32_t EvalBatchAvx2(const T* cells, T lower, T upper) {
+  return EvalBatch<T, OP>(cells, lower, upper);
+}
+
+template <typename T, BatchOp OP>
+__attribute__((target("avx512f,avx512bw,avx512vl,avx512dq")))
+uint32_t EvalBatchAvx512(const T* cells, T lower, T upper) {
+  return EvalBatch<T, OP>(cells, lower, upper);
+}
+#endif
+
+template <typename T>
+using BatchEvalFn = uint32_t (*)(const T*, T, T);
+
+// Pick the widest batch kernel supported by the runtime CPU. The choice is
+// latched in a function-local static so the CPU check runs once per
+// instantiation, not once per block.
+template <typename T, BatchOp OP>
+BatchEvalFn<T> ChooseBatchEvalFn() {
+#if defined(__x86_64__) && !defined(__APPLE__)
+  static const BatchEvalFn<T> fn = [] () -> BatchEvalFn<T> {
+    // base::CPU doesn't expose the AVX-512 feature bits, so query the
+    // compiler's CPU model directly for those.
+    if (__builtin_cpu_supports("avx512bw") &&
+        __builtin_cpu_supports("avx512vl") &&
+        __builtin_cpu_supports("avx512dq")) {
+      return &EvalBatchAvx512<T, OP>;
+    }
+    if (base::CPU().has_avx2()) {
+      return &EvalBatchAvx2<T, OP>;
+    }
+    return &EvalBatchScalar<T, OP>;
+  }();
+  return fn;
+#else
+  return &EvalBatchScalar<T, OP>;
+#endif
+}
+
+template <DataType PhysicalType, BatchOp OP>
+void ApplyBatchedPredicate(const ColumnBlock& block, SelectionVector* sel,
+                           const void* lower, const void* upper) {
+  typedef typename DataTypeTraits<PhysicalType>::cpp_type T;
+  const T l = lower != nullptr ? *reinterpret_cast<const T*>(lower) : T();
+  const T u = upper != nullptr ? *reinterpret_cast<const T*>(upper) : T();
+  const BatchEvalFn<T> fn = ChooseBatchEvalFn<T, OP>();
+  const T* cells = reinterpret_cast<const T*>(block.cell_ptr(0));
+  uint8_t* bitmap = sel->mutable_bitmap();
+  const size_t nrows = block.nrows();
+  const size_t batched_rows = nrows - nrows % kEvalBatchSize;
+  for (size_t i = 0; i < batched_rows; i += kEvalBatchSize) {
+    uint32_t mask = fn(cells + i, l, u);
+    // Since 'i' is a multiple of 8, the batch covers whole bytes of the
+    // selection bitmap, and bits k*8..k*8+7 of the mask line up with the
+    // k-th of those bytes.
+    uint8_t* p = &bitmap[i / 8];
+    p[0] &= static_cast<uint8_t>(mask);
+    p[1] &= static_cast<uint8_t>(mask >> 8);
+    p[2] &= static_cast<uint8_t>(mask >> 16);
+    p[3] &= static_cast<uint8_t>(mask >> 24);
+  }
+  for (size_t i = batched_rows; i < nrows; i++) {
+    if (!EvalCellForBatchOp<T, OP>(cells[i], l, u)) {
+      BitmapClear(bitmap, i);
+    }
+  }
+}
+
+// Returns true if the predicate was handled by the batched implementation,
+// false if the caller should fall back to the cell-at-a-time path.
+template <DataType PhysicalType>
+typename std::enable_if<
+    std::is_arithmetic<typename DataTypeTraits<PhysicalType>::cpp_type>::value, bool>::type
+TryApplyBatchedPredicate(PredicateType predicate_type,
+                         const void* lower, const void* upper,
+                         const ColumnBlock& block, SelectionVector* sel) {
+  // Nullable blocks require the null-bitmap check per cell; leave them to the
+  // scalar path.
+  if (block.is_nullable()) return false;
+  switch (predicate_type) {
+    case PredicateType::Range:
+      if (lower == nullptr) {
+        ApplyBatchedPredicate<PhysicalType, BatchOp::RANGE_UPPER>(block, sel, lower, upper);
+      } else if (upper == nullptr) {
+        ApplyBatchedPredicate<PhysicalType, BatchOp::RANGE_LOWER>(block, sel, lower, upper);
+      } else {
+        ApplyBatchedPredicate<PhysicalType, BatchOp::RANGE_BOTH>(block, sel, lower, upper);
+      }
+      return true;
+    case PredicateType::Equality:
+      ApplyBatchedPredicate<PhysicalType, BatchOp::EQUALITY>(block, sel, lower, upper);
+      return true;
+    default:
+      return false;
+  }
+}
+
+template <DataType PhysicalType>
+typename std::enable_if<
+    !std::is_arithmetic<typename DataTypeTraits<PhysicalType>::cpp_type>::value, bool>::type
+TryApplyBatchedPredicate(PredicateType /*predicate_type*/,
+                         const void* /*lower*/, const void* /*upper*/,
+                         const ColumnBlock& /*block*/, SelectionVector* /*sel*/) {
+  return false;
+}
+
 template <typename P>
 void ApplyPredicate(const ColumnBlock& block, SelectionVector* sel, P p) {
   if (block.is_nullable()) {
@@ -525,6 +802,9 @@ void ApplyPredicate(const ColumnBlock& block, SelectionVector* sel, P p) {
 template <DataType PhysicalType>
 void ColumnPredicate::EvaluateForPhysicalType(const ColumnBlock& block,
                                               SelectionVector* sel) const {
+  if (TryApplyBatchedPredicate<PhysicalType>(predicate_type(), lower_, upper_, block, sel)) {
+    return;
+  }
   switch (predicate_type()) {
     case PredicateType::Range: {
       if (lower_ == nullptr) {
@@ -583,6 +863,12 @@ void ColumnPredicate::EvaluateForPhysicalType(const ColumnBlock& block,
       });
       return;
     };
+    case PredicateType::InBloomFilter: {
+      ApplyPredicate(block, sel, [this] (const void* cell) {
+        return bloom_filter_->MayContainKey(BloomKeyProbe(CellSlice<PhysicalType>(cell)));
+      });
+      return;
+    };
     case PredicateType::None: LOG(FATAL) << "NONE predicate evaluation";
   }
   LOG(FATAL) << "unknown predicate type";
@@ -665,6 +951,9 @@ string ColumnPredicate::ToString() const {
       ss.append(")");
       return ss;
     };
+    case PredicateType::InBloomFilter: {
+      return strings::Substitute("`$0` IN BLOOM FILTER", column_.name());
+    };
   }
   LOG(FATAL) << "unknown predicate type";
 }
@@ -691,6 +980,11 @@ bool ColumnPredicate::operator==(const ColumnPredicate& other) const {
       }
       return true;
     };
+    case PredicateType::InBloomFilter: {
+      // Bloom filters are compared by identity; there is no cheap way to
+      // check two filters for equivalence.
+      return bloom_filter_ == other.bloom_filter_;
+    };
     case PredicateType::None:
     case PredicateType::IsNotNull:
     case PredicateType::IsNull: return true;
@@ -720,7 +1014,10 @@ int SelectivityRank(const ColumnPredicate& predicate) {
     case PredicateType::Equality: rank = 2; break;
     case PredicateType::InList: rank = 3; break;
     case PredicateType::Range: rank = 4; break;
-    case PredicateType::IsNotNull: rank = 5; break;
+    // Evaluated after the exact predicates: checking the bloom filter
+    // requires hashing each cell.
+    case PredicateType::InBloomFilter: rank = 5; break;
+    case PredicateType::IsNotNull: rank = 6; break;
     default: LOG(FATAL) << "unknown predicate type";
   }
   return rank * (kLargestTypeSize + 1) + predicate.column().type_info()->size();
@@ -28,6 +28,8 @@
 #include "kudu/common/common.pb.h"
 #include "kudu/common/schema.h"
 #include "kudu/common/types.h"
+#include "kudu/util/bloom_filter.h"
+#include "kudu/util/slice.h"
 
 namespace kudu {
 
@@ -56,6 +58,13 @@ enum class PredicateType {
   // A predicate which evaluates to true if the column value is present in
   // a value list.
   InList,
+
+  // A predicate which evaluates to true if the column value may be present
+  // in a bloom filter. Unlike the other predicate types, this predicate is
+  // approximate: it admits false positives, so rows which pass it must
+  // still be checked by the caller (e.g. the join that produced the
+  // filter).
+  InBloomFilter,
 };
 
 // A predicate which can be evaluated over a block of column values.
@@ -130,6 +139,16 @@ class ColumnPredicate {
   // The InList will be simplified into an Equality, Range or None if possible.
   static ColumnPredicate InList(ColumnSchema column, std::vector<const void*>* values);
 
+  // Creates a new bloom filter predicate for the column.
+  //
+  // Keys must have been inserted into the bloom filter using the column
+  // value encoding: the exact value for columns with a BINARY physical
+  // type, or the raw in-memory representation for other types.
+  //
+  // The bloom filter is not copied, and must outlive the returned
+  // predicate.
+  static ColumnPredicate InBloomFilter(ColumnSchema column, const BloomFilter* bloom_filter);
+
   // Creates a new predicate which matches no values.
   static ColumnPredicate None(ColumnSchema column);
 
@@ -196,6 +215,9 @@ class ColumnPredicate {
                                     return DataTypeTraits<PhysicalType>::Compare(lhs, rhs) < 0;
                                   });
       };
+      case PredicateType::InBloomFilter: {
+        return bloom_filter_->MayContainKey(BloomKeyProbe(CellSlice<PhysicalType>(cell)));
+      };
     }
     LOG(FATAL) << "unknown predicate type";
   }
@@ -234,8 +256,25 @@ class ColumnPredicate {
     return values_;
   }
 
+  // Returns the bloom filter if this is a bloom filter predicate.
+  const BloomFilter* bloom_filter() const {
+    return bloom_filter_;
+  }
+
  private:
 
+  // Returns a slice over the bloom filter key encoding of the cell: the
+  // referenced data for columns with a BINARY physical type, or the raw
+  // in-memory representation for other types.
+  template <DataType PhysicalType>
+  static Slice CellSlice(const void* cell) {
+    if (PhysicalType == BINARY) {
+      return *reinterpret_cast<const Slice*>(cell);
+    }
+    return Slice(reinterpret_cast<const uint8_t*>(cell),
+                 sizeof(typename DataTypeTraits<PhysicalType>::cpp_type));
+  }
+
   friend class TestColumnPredicate;
 
   // Creates a new range or equality column predicate.
@@ -249,6 +288,11 @@ class ColumnPredicate {
                   ColumnSchema column,
                   std::vector<const void*>* values);
 
+  // Creates a new InBloomFilter column predicate.
+  ColumnPredicate(PredicateType predicate_type,
+                  ColumnSchema column,
+                  const BloomFilter* bloom_filter);
+
   // Transition to a None predicate type.
   void SetToNone();
 
@@ -276,6 +320,9 @@ class ColumnPredicate {
   // Merge another predicate into this InList predicate.
   void MergeIntoInList(const ColumnPredicate& other);
 
+  // Merge another predicate into this InBloomFilter predicate.
+  void MergeIntoBloomFilter(const ColumnPredicate& other);
+
   // For a Range type predicate, this helper function checks
   // whether a given value is in the range.
   bool CheckValueInRange(const void* value) const;
@@ -299,6 +346,10 @@ class ColumnPredicate {
 
   // The list of values to check column against if this is an InList predicate.
   std::vector<const void*> values_;
+
+  // The bloom filter to check column values against if this is an
+  // InBloomFilter predicate. Not owned.
+  const BloomFilter* bloom_filter_;
 };
 
 // Compares predicates according to selectivity. Predicates that match fewer
@@ -51,6 +51,16 @@ EncodedKey::EncodedKey(faststring* data,
   raw_keys_.swap(*raw_keys);
 }
 
+EncodedKey::EncodedKey(Slice encoded,
+                       vector<const void *> *raw_keys,
+                       size_t num_key_cols)
+  : num_key_cols_(num_key_cols),
+    encoded_key_(encoded) {
+  DCHECK_LE(raw_keys->size(), num_key_cols);
+
+  raw_keys_.swap(*raw_keys);
+}
+
 gscoped_ptr<EncodedKey> EncodedKey::FromContiguousRow(const ConstContiguousRow& row) {
   EncodedKeyBuilder kb(row.schema());
   for (int i = 0; i < row.schema()->num_key_columns(); i++) {
@@ -60,6 +70,14 @@ gscoped_ptr<EncodedKey> EncodedKey::FromContiguousRow(const ConstContiguousRow&
 
 }
 
+EncodedKey* EncodedKey::FromContiguousRow(const ConstContiguousRow& row, Arena* arena) {
+  EncodedKeyBuilder kb(row.schema());
+  for (int i = 0; i < row.schema()->num_key_columns(); i++) {
+    kb.AddColumnKey(row.cell_ptr(i));
+  }
+  return kb.BuildEncodedKey(arena);
+}
+
 Status EncodedKey::DecodeEncodedString(const Schema& schema,
                                        Arena* arena,
                                        const Slice& encoded,
@@ -178,6 +196,19 @@ EncodedKey *EncodedKeyBuilder::BuildEncodedKey() {
   return ret;
 }
 
+EncodedKey *EncodedKeyBuilder::BuildEncodedKey(Arena* arena) {
+  if (idx_ == 0) {
+    return nullptr;
+  }
+  uint8_t* data = static_cast<uint8_t*>(arena->AllocateBytes(encoded_key_.size()));
+  CHECK(data) << "could not allocate " << encoded_key_.size() << " bytes from arena";
+  memcpy(data, encoded_key_.data(), encoded_key_.size());
+  auto ret = arena->NewObject<EncodedKey>(Slice(data, encoded_key_.size()),
+                                          &raw_keys_, num_key_cols_);
+  idx_ = 0;
+  return ret;
+}
+
 void EncodedKeyBuilder::AssignCopy(const EncodedKeyBuilder &other) {
   DCHECK_SCHEMA_EQ(*schema_, *other.schema_);
 
@@ -46,8 +46,21 @@ class EncodedKey {
              std::vector<const void *> *raw_keys,
              size_t num_key_cols);
 
+  // Constructs a new EncodedKey which does not own its encoded data:
+  // 'encoded' must remain valid for the lifetime of this object. As above,
+  // this takes over the contents of 'raw_keys'.
+  EncodedKey(Slice encoded,
+             std::vector<const void *> *raw_keys,
+             size_t num_key_cols);
+
   static gscoped_ptr<EncodedKey> FromContiguousRow(const ConstContiguousRow& row);
 
+  // As above, but allocates both the returned object and its encoded data
+  // from 'arena'. The raw key pointers refer into 'row', which must outlive
+  // the returned key. The caller is responsible for running the returned
+  // key's destructor before the arena is reset; it must not be deleted.
+  static EncodedKey* FromContiguousRow(const ConstContiguousRow& row, Arena* arena);
+
   // Decode the encoded key specified in 'encoded', which must correspond to the
   // provided schema.
   // The returned row data is allocated from 'arena' and returned in '*result'.
@@ -108,6 +121,11 @@ class EncodedKeyBuilder {
 
   EncodedKey *BuildEncodedKey();
 
+  // As above, but allocates the returned key and its encoded data from
+  // 'arena'. See EncodedKey::FromContiguousRow(row, arena) for the
+  // lifetime requirements on the returned key.
+  EncodedKey *BuildEncodedKey(Arena* arena);
+
   void AssignCopy(const EncodedKeyBuilder &other);
 
  private:
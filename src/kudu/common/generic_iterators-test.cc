@@ -22,6 +22,7 @@
 #include <ostream>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <gflags/gflags.h>
@@ -33,6 +34,7 @@
 #include "kudu/common/columnblock.h"
 #include "kudu/common/common.pb.h"
 #include "kudu/common/iterator.h"
+#include "kudu/common/iterator_stats.h"
 #include "kudu/common/generic_iterators.h"
 #include "kudu/common/column_materialization_context.h"
 #include "kudu/common/rowblock.h"
@@ -47,6 +49,8 @@
 #include "kudu/util/stopwatch.h"
 #include "kudu/util/test_macros.h"
 
+DECLARE_bool(scan_cycle_accounting);
+
 DEFINE_int32(num_lists, 3, "Number of lists to merge");
 DEFINE_int32(num_rows, 1000, "Number of entries per list");
 DEFINE_int32(num_iters, 1, "Number of times to run merge");
@@ -57,8 +61,6 @@ using std::vector;
 
 namespace kudu {
 
-struct IteratorStats;
-
 static const Schema kIntSchema({ ColumnSchema("val", UINT32) }, 1);
 
 // Test iterator which just yields integer rows from a provided
@@ -277,6 +279,35 @@ TEST(TestMaterializingIterator, TestMaterializingPredicatePushdown) {
   ASSERT_FALSE(dst.selection_vector()->IsRowSelected(30));
 }
 
+// Test that enabling --scan_cycle_accounting records cycles spent evaluating
+// pushed-down predicates in the iterator stats.
+TEST(TestMaterializingIterator, TestPredicateCycleAccounting) {
+  FLAGS_scan_cycle_accounting = true;
+  ScanSpec spec;
+  TestIntRangePredicate pred1(20, 30);
+  spec.AddPredicate(pred1.pred_);
+
+  vector<uint32_t> ints;
+  for (int i = 0; i < 100; i++) {
+    ints.push_back(i);
+  }
+
+  shared_ptr<VectorIterator> colwise(new VectorIterator(ints));
+  MaterializingIterator materializing(colwise);
+  ASSERT_OK(materializing.Init(&spec));
+
+  Arena arena(1024);
+  RowBlock dst(kIntSchema, 100, &arena);
+  ASSERT_OK(materializing.NextBlock(&dst));
+  ASSERT_EQ(10, dst.selection_vector()->CountSelected());
+
+  vector<IteratorStats> stats;
+  materializing.GetIteratorStats(&stats);
+  ASSERT_EQ(1, stats.size());
+  ASSERT_GT(stats[0].predicate_cycles, 0);
+  FLAGS_scan_cycle_accounting = false;
+}
+
 // Test that PredicateEvaluatingIterator will properly evaluate predicates on its
 // input.
 TEST(TestPredicateEvaluatingIterator, TestPredicateEvaluation) {
@@ -338,4 +369,135 @@ TEST(TestPredicateEvaluatingIterator, TestDontWrapWhenNoPredicates) {
   ASSERT_EQ(outer_iter, materializing) << "InitAndMaybeWrap should not have wrapped iter";
 }
 
+static const Schema kPairSchema({ ColumnSchema("g", UINT32),
+                                  ColumnSchema("val", UINT32) }, 1);
+
+// Test iterator which yields (group, value) rows from a provided vector.
+class PairVectorIterator : public RowwiseIterator {
+ public:
+  explicit PairVectorIterator(vector<std::pair<uint32_t, uint32_t>> rows)
+      : rows_(std::move(rows)),
+        cur_idx_(0) {
+  }
+
+  Status Init(ScanSpec* spec) OVERRIDE {
+    return Status::OK();
+  }
+
+  virtual Status NextBlock(RowBlock* dst) OVERRIDE {
+    size_t n = std::min(dst->row_capacity(), rows_.size() - cur_idx_);
+    dst->Resize(n);
+    dst->selection_vector()->SetAllTrue();
+    for (size_t i = 0; i < n; i++) {
+      dst->column_block(0).SetCellValue(i, &rows_[cur_idx_].first);
+      dst->column_block(1).SetCellValue(i, &rows_[cur_idx_].second);
+      cur_idx_++;
+    }
+    return Status::OK();
+  }
+
+  virtual bool HasNext() const OVERRIDE {
+    return cur_idx_ < rows_.size();
+  }
+
+  virtual string ToString() const OVERRIDE {
+    return string("PairVectorIterator");
+  }
+
+  virtual const Schema& schema() const OVERRIDE {
+    return kPairSchema;
+  }
+
+  virtual void GetIteratorStats(vector<IteratorStats>* stats) const OVERRIDE {
+    stats->resize(schema().num_columns());
+  }
+
+ private:
+  vector<std::pair<uint32_t, uint32_t>> rows_;
+  size_t cur_idx_;
+};
+
+// Test aggregation with no group-by columns, which collapses the entire
+// input into a single row.
+TEST(TestAggregatingIterator, TestGlobalAggregate) {
+  vector<std::pair<AggregatingIterator::AggregateFunc, uint32_t>> cases = {
+    { AggregatingIterator::SUM, 19 },
+    { AggregatingIterator::MIN, 1 },
+    { AggregatingIterator::MAX, 9 },
+    { AggregatingIterator::COUNT, 4 }
+  };
+  for (const auto& test_case : cases) {
+    vector<uint32_t> ints = { 5, 1, 9, 4 };
+    shared_ptr<RowwiseIterator> materializing(
+        new MaterializingIterator(
+            shared_ptr<ColumnwiseIterator>(new VectorIterator(ints))));
+    ScanSpec spec;
+    ASSERT_OK(materializing->Init(&spec));
+    AggregatingIterator agg(materializing, 0, { test_case.first });
+    ASSERT_OK(agg.Init(nullptr));
+
+    Arena arena(1024);
+    RowBlock dst(kIntSchema, 100, &arena);
+    ASSERT_OK(agg.NextBlock(&dst));
+    ASSERT_EQ(1, dst.nrows());
+    ASSERT_EQ(test_case.second,
+              *reinterpret_cast<const uint32_t*>(dst.row(0).cell_ptr(0)));
+    ASSERT_FALSE(agg.HasNext());
+  }
+}
+
+// Test aggregation grouped on a key prefix, including emission across
+// multiple small destination blocks.
+TEST(TestAggregatingIterator, TestGroupedAggregate) {
+  vector<std::pair<uint32_t, uint32_t>> rows = {
+    { 1, 5 }, { 1, 7 }, { 2, 3 }, { 4, 10 }, { 4, 1 }, { 4, 2 }
+  };
+  vector<std::pair<AggregatingIterator::AggregateFunc,
+                   vector<std::pair<uint32_t, uint32_t>>>> cases = {
+    { AggregatingIterator::SUM, { { 1, 12 }, { 2, 3 }, { 4, 13 } } },
+    { AggregatingIterator::MIN, { { 1, 5 }, { 2, 3 }, { 4, 1 } } },
+    { AggregatingIterator::MAX, { { 1, 7 }, { 2, 3 }, { 4, 10 } } },
+    { AggregatingIterator::COUNT, { { 1, 2 }, { 2, 1 }, { 4, 3 } } }
+  };
+  for (const auto& test_case : cases) {
+    shared_ptr<RowwiseIterator> base(new PairVectorIterator(rows));
+    ASSERT_OK(base->Init(nullptr));
+    AggregatingIterator agg(base, 1, { test_case.first });
+    ASSERT_OK(agg.Init(nullptr));
+
+    // Use a two-row destination block so that the three result groups span
+    // multiple NextBlock() calls.
+    Arena arena(1024);
+    RowBlock dst(kPairSchema, 2, &arena);
+    vector<std::pair<uint32_t, uint32_t>> results;
+    while (agg.HasNext()) {
+      ASSERT_OK(agg.NextBlock(&dst));
+      for (size_t i = 0; i < dst.nrows(); i++) {
+        results.emplace_back(
+            *reinterpret_cast<const uint32_t*>(dst.row(i).cell_ptr(0)),
+            *reinterpret_cast<const uint32_t*>(dst.row(i).cell_ptr(1)));
+      }
+    }
+    ASSERT_EQ(test_case.second, results);
+  }
+}
+
+// Test that invalid aggregate specifications are rejected.
+TEST(TestAggregatingIterator, TestInvalidSpec) {
+  {
+    // Too many group-by columns.
+    shared_ptr<RowwiseIterator> base(new PairVectorIterator({}));
+    ASSERT_OK(base->Init(nullptr));
+    AggregatingIterator agg(base, 2, {});
+    ASSERT_TRUE(agg.Init(nullptr).IsInvalidArgument());
+  }
+  {
+    // Wrong number of aggregate functions.
+    shared_ptr<RowwiseIterator> base(new PairVectorIterator({}));
+    ASSERT_OK(base->Init(nullptr));
+    AggregatingIterator agg(base, 1, {});
+    ASSERT_TRUE(agg.Init(nullptr).IsInvalidArgument());
+  }
+}
+
 } // namespace kudu
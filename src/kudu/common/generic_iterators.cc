@@ -19,11 +19,11 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <iterator>
 #include <memory>
 #include <mutex>
 #include <string>
-#include <tuple>
 #include <unordered_map>
 #include <utility>
 
@@ -37,21 +37,25 @@
 #include "kudu/common/iterator_stats.h"
 #include "kudu/common/row.h"
 #include "kudu/common/rowblock.h"
+#include "kudu/common/types.h"
 #include "kudu/gutil/gscoped_ptr.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/map-util.h"
+#include "kudu/gutil/once.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/gutil/walltime.h"
+#include "kudu/util/countdown_latch.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/memory/arena.h"
+#include "kudu/util/threadpool.h"
 
 using std::all_of;
-using std::get;
 using std::move;
 using std::remove_if;
 using std::shared_ptr;
 using std::sort;
+using std::stable_sort;
 using std::string;
-using std::tuple;
 using std::unique_ptr;
 using std::vector;
 
@@ -63,6 +67,18 @@ DEFINE_bool(materializing_iterator_decoder_eval, true,
 TAG_FLAG(materializing_iterator_decoder_eval, hidden);
 TAG_FLAG(materializing_iterator_decoder_eval, runtime);
 
+DECLARE_bool(scan_cycle_accounting);
+
+DEFINE_int32(num_column_materialization_threads, 0,
+             "Number of threads in the process-wide pool used to materialize "
+             "the columns of a scan batch in parallel. When non-zero, "
+             "fixed-size columns without predicates are decoded concurrently "
+             "on the pool, which can scale the throughput of a single "
+             "wide-projection scan across cores. Set to 0 to materialize "
+             "columns serially in the scanning thread.");
+TAG_FLAG(num_column_materialization_threads, advanced);
+TAG_FLAG(num_column_materialization_threads, experimental);
+
 namespace kudu {
 namespace {
 void AddIterStats(const RowwiseIterator& iter,
@@ -74,6 +90,31 @@ void AddIterStats(const RowwiseIterator& iter,
     (*stats)[i].AddStats(iter_stats[i]);
   }
 }
+
+// The pool shared by all MaterializingIterators for parallel column
+// materialization. Created on first use and intentionally never destroyed.
+ThreadPool* g_column_materialization_pool = nullptr;
+GoogleOnceType g_column_materialization_pool_once = GOOGLE_ONCE_INIT;
+
+void CreateColumnMaterializationPool() {
+  gscoped_ptr<ThreadPool> pool;
+  CHECK_OK(ThreadPoolBuilder("col-materialize")
+           .set_max_threads(FLAGS_num_column_materialization_threads)
+           .Build(&pool));
+  g_column_materialization_pool = pool.release();
+}
+
+// Return the shared column materialization pool, or nullptr if parallel
+// materialization is disabled.
+ThreadPool* ColumnMaterializationPool() {
+  if (FLAGS_num_column_materialization_threads <= 0) {
+    return nullptr;
+  }
+  GoogleOnceInit(&g_column_materialization_pool_once,
+                 &CreateColumnMaterializationPool);
+  return g_column_materialization_pool;
+}
+
 } // anonymous namespace
 
 ////////////////////////////////////////////////////////////
@@ -214,6 +255,8 @@ Status MergeIterator::Init(ScanSpec *spec) {
       }),
       iters_.end());
 
+  RebuildLoserTree();
+
   initted_ = true;
   return Status::OK();
 }
@@ -265,6 +308,41 @@ void MergeIterator::PrepareBatch(RowBlock* dst) {
   dst->Resize(std::min(dst->row_capacity(), available));
 }
 
+// Sentinel for loser tree nodes which haven't yet had a match played at them
+// during a rebuild.
+static const size_t kInvalidTreeEntry = ~static_cast<size_t>(0);
+
+bool MergeIterator::LeafLessThan(size_t a, size_t b) const {
+  int c = schema_.Compare(iters_[a]->next_row(), iters_[b]->next_row());
+  return c < 0 || (c == 0 && a < b);
+}
+
+void MergeIterator::ReplayLoserTree(size_t leaf_idx) {
+  const size_t k = iters_.size();
+  size_t winner = leaf_idx;
+  for (size_t node = (leaf_idx + k) / 2; node > 0; node /= 2) {
+    size_t& loser = loser_tree_[node];
+    if (PREDICT_FALSE(loser == kInvalidTreeEntry)) {
+      // Still rebuilding: deposit the current winner at the first node which
+      // hasn't played a match yet.
+      loser = winner;
+      return;
+    }
+    if (LeafLessThan(loser, winner)) {
+      std::swap(loser, winner);
+    }
+  }
+  loser_tree_[0] = winner;
+}
+
+void MergeIterator::RebuildLoserTree() {
+  const size_t k = iters_.size();
+  loser_tree_.assign(std::max<size_t>(k, 1), kInvalidTreeEntry);
+  for (size_t i = 0; i < k; i++) {
+    ReplayLoserTree(i);
+  }
+}
+
 // TODO: this is an obvious spot to add codegen - there's a ton of branching
 // and such around the comparisons. A simple experiment indicated there's some
 // 2x to be gained.
@@ -275,33 +353,30 @@ Status MergeIterator::MaterializeBlock(RowBlock *dst) {
   for (size_t dst_row_idx = 0; dst_row_idx < dst->nrows(); dst_row_idx++) {
     RowBlockRow dst_row = dst->row(dst_row_idx);
 
-    // Find the sub-iterator which is currently smallest
-    MergeIterState *smallest = nullptr;
-    ssize_t smallest_idx = -1;
+    // If no iterators have any rows left, then we're done iterating.
+    if (PREDICT_FALSE(iters_.empty())) break;
 
-    // Typically the number of iters_ is not that large, so using a priority
-    // queue is not worth it
-    for (size_t i = 0; i < iters_.size(); i++) {
-      unique_ptr<MergeIterState> &state = iters_[i];
+    // The root of the loser tree tracks the sub-iterator whose current row is
+    // smallest.
+    size_t smallest_idx = loser_tree_[0];
+    MergeIterState* smallest = iters_[smallest_idx].get();
 
-      if (smallest == nullptr ||
-          schema_.Compare(state->next_row(), smallest->next_row()) < 0) {
-        smallest = state.get();
-        smallest_idx = i;
-      }
-    }
-
-    // If no iterators had any row left, then we're done iterating.
-    if (PREDICT_FALSE(smallest == nullptr)) break;
-
-    // Otherwise, copy the row from the smallest one, and advance it
+    // Copy the row from the smallest sub-iterator, and advance it.
     RETURN_NOT_OK(CopyRow(smallest->next_row(), &dst_row, dst->arena()));
     RETURN_NOT_OK(smallest->Advance());
 
     if (smallest->IsFullyExhausted()) {
-      std::lock_guard<rw_spinlock> l(iters_lock_);
-      AddIterStats(*smallest->iter(), &finished_iter_stats_by_col_);
-      iters_.erase(iters_.begin() + smallest_idx);
+      {
+        std::lock_guard<rw_spinlock> l(iters_lock_);
+        AddIterStats(*smallest->iter(), &finished_iter_stats_by_col_);
+        iters_.erase(iters_.begin() + smallest_idx);
+      }
+      // The leaf indices shifted, so the tree must be rebuilt. This happens
+      // only once per fully-consumed sub-iterator.
+      RebuildLoserTree();
+    } else {
+      // Replay the matches on the winner's root path against its new row.
+      ReplayLoserTree(smallest_idx);
     }
   }
 
@@ -450,6 +525,7 @@ void UnionIterator::GetIteratorStats(std::vector<IteratorStats>* stats) const {
 
 MaterializingIterator::MaterializingIterator(shared_ptr<ColumnwiseIterator> iter)
     : iter_(move(iter)),
+      blocks_since_reorder_(0),
       disallow_pushdown_for_tests_(!FLAGS_materializing_iterator_do_pushdown),
       disallow_decoder_eval_(!FLAGS_materializing_iterator_decoder_eval) {
 }
@@ -493,14 +569,24 @@ Status MaterializingIterator::Init(ScanSpec *spec) {
 
   // Sort the predicates by selectivity so that the most selective are evaluated earlier.
   sort(col_idx_predicates_.begin(), col_idx_predicates_.end(),
-       [] (const tuple<int32_t, ColumnPredicate>& left,
-           const tuple<int32_t, ColumnPredicate>& right) {
-         return SelectivityComparator(get<1>(left), get<1>(right));
+       [] (const ColumnPredicateInfo& left, const ColumnPredicateInfo& right) {
+         return SelectivityComparator(left.pred, right.pred);
        });
 
+  if (PREDICT_FALSE(FLAGS_scan_cycle_accounting)) {
+    predicate_cycles_by_col_.assign(num_columns, 0);
+  }
+
   return Status::OK();
 }
 
+void MaterializingIterator::GetIteratorStats(vector<IteratorStats>* stats) const {
+  iter_->GetIteratorStats(stats);
+  for (size_t i = 0; i < predicate_cycles_by_col_.size() && i < stats->size(); i++) {
+    (*stats)[i].predicate_cycles += predicate_cycles_by_col_[i];
+  }
+}
+
 bool MaterializingIterator::HasNext() const {
   return iter_->HasNext();
 }
@@ -524,11 +610,16 @@ Status MaterializingIterator::MaterializeBlock(RowBlock *dst) {
   // been deleted.
   RETURN_NOT_OK(iter_->InitializeSelectionVector(dst->selection_vector()));
 
-  for (const auto& col_pred : col_idx_predicates_) {
+  if (!col_idx_predicates_.empty()) {
+    MaybeReorderPredicates();
+  }
+
+  size_t n_live = dst->selection_vector()->CountSelected();
+  for (auto& cpi : col_idx_predicates_) {
     // Materialize the column itself into the row block.
-    ColumnBlock dst_col(dst->column_block(get<0>(col_pred)));
-    ColumnMaterializationContext ctx(get<0>(col_pred),
-                                     &get<1>(col_pred),
+    ColumnBlock dst_col(dst->column_block(cpi.col_idx));
+    ColumnMaterializationContext ctx(cpi.col_idx,
+                                     &cpi.pred,
                                      &dst_col,
                                      dst->selection_vector());
     // None predicates should be short-circuited in scan spec.
@@ -538,25 +629,40 @@ Status MaterializingIterator::MaterializeBlock(RowBlock *dst) {
     }
     RETURN_NOT_OK(iter_->MaterializeColumn(&ctx));
     if (ctx.DecoderEvalNotSupported()) {
-      get<1>(col_pred).Evaluate(dst_col, dst->selection_vector());
+      if (PREDICT_FALSE(FLAGS_scan_cycle_accounting)) {
+        const int64_t start_cycles = CycleClock::Now();
+        cpi.pred.Evaluate(dst_col, dst->selection_vector());
+        predicate_cycles_by_col_[cpi.col_idx] += CycleClock::Now() - start_cycles;
+      } else {
+        cpi.pred.Evaluate(dst_col, dst->selection_vector());
+      }
     }
 
+    // Track how selective this predicate has proven to be, so that
+    // MaybeReorderPredicates() can move the most effective predicates to
+    // the front.
+    size_t n_remaining = dst->selection_vector()->CountSelected();
+    cpi.rows_evaluated += n_live;
+    cpi.rows_rejected += n_live - n_remaining;
+    n_live = n_remaining;
+
     // If after evaluating this predicate the entire row block has been filtered
     // out, we don't need to materialize other columns at all.
-    if (!dst->selection_vector()->AnySelected()) {
+    if (n_remaining == 0) {
       DVLOG(1) << "0/" << dst->nrows() << " passed predicate";
       return Status::OK();
     }
   }
 
-  for (size_t col_idx : non_predicate_column_indexes_) {
-    // Materialize the column itself into the row block.
-    ColumnBlock dst_col(dst->column_block(col_idx));
-    ColumnMaterializationContext ctx(col_idx,
-                                     nullptr,
-                                     &dst_col,
-                                     dst->selection_vector());
-    RETURN_NOT_OK(iter_->MaterializeColumn(&ctx));
+  ThreadPool* pool = ColumnMaterializationPool();
+  if (pool != nullptr &&
+      non_predicate_column_indexes_.size() > 1 &&
+      iter_->SupportsConcurrentColumnMaterialization()) {
+    RETURN_NOT_OK(MaterializeColumnsInParallel(pool, dst));
+  } else {
+    for (size_t col_idx : non_predicate_column_indexes_) {
+      RETURN_NOT_OK(MaterializeSingleColumn(col_idx, dst));
+    }
   }
 
   DVLOG(1) << dst->selection_vector()->CountSelected() << "/"
@@ -564,6 +670,96 @@ Status MaterializingIterator::MaterializeBlock(RowBlock *dst) {
   return Status::OK();
 }
 
+Status MaterializingIterator::MaterializeSingleColumn(size_t col_idx, RowBlock* dst) {
+  ColumnBlock dst_col(dst->column_block(col_idx));
+  ColumnMaterializationContext ctx(col_idx,
+                                   nullptr,
+                                   &dst_col,
+                                   dst->selection_vector());
+  return iter_->MaterializeColumn(&ctx);
+}
+
+Status MaterializingIterator::MaterializeColumnsInParallel(ThreadPool* pool, RowBlock* dst) {
+  // Columns with indirect data (e.g. strings) copy their values into the
+  // destination block's arena, which is not thread-safe. Those columns are
+  // materialized in the calling thread while the fixed-size columns are
+  // farmed out to the pool.
+  vector<size_t> parallel_cols;
+  vector<size_t> serial_cols;
+  for (size_t col_idx : non_predicate_column_indexes_) {
+    if (schema().column(col_idx).type_info()->physical_type() == BINARY) {
+      serial_cols.push_back(col_idx);
+    } else {
+      parallel_cols.push_back(col_idx);
+    }
+  }
+
+  vector<Status> results(parallel_cols.size());
+  CountDownLatch latch(parallel_cols.size());
+  for (size_t i = 0; i < parallel_cols.size(); i++) {
+    Status submit = pool->SubmitFunc([this, i, &parallel_cols, &results, &latch, dst]() {
+      results[i] = MaterializeSingleColumn(parallel_cols[i], dst);
+      latch.CountDown();
+    });
+    if (!submit.ok()) {
+      // The pool is shutting down or its queue is full; fall back to
+      // materializing this column in the calling thread.
+      results[i] = MaterializeSingleColumn(parallel_cols[i], dst);
+      latch.CountDown();
+    }
+  }
+
+  // Materialize the arena-using columns while the pool works on the rest.
+  Status serial_status;
+  for (size_t col_idx : serial_cols) {
+    serial_status = MaterializeSingleColumn(col_idx, dst);
+    if (!serial_status.ok()) {
+      break;
+    }
+  }
+  latch.Wait();
+
+  RETURN_NOT_OK(serial_status);
+  for (const Status& s : results) {
+    RETURN_NOT_OK(s);
+  }
+  return Status::OK();
+}
+
+void MaterializingIterator::MaybeReorderPredicates() {
+  // How many blocks to materialize between reconsiderations of the
+  // predicate order.
+  static const int kPredicateReorderPeriod = 16;
+  // The minimum number of rows a predicate must have been evaluated against
+  // before its observed rejection rate is considered meaningful.
+  static const int64_t kMinRowsSampledForReorder = 1000;
+
+  if (col_idx_predicates_.size() < 2 ||
+      ++blocks_since_reorder_ < kPredicateReorderPeriod) {
+    return;
+  }
+  blocks_since_reorder_ = 0;
+
+  // Only reorder once every predicate has a meaningful sample. Predicates
+  // further down the list see fewer rows (earlier predicates have already
+  // filtered some out), so mixing observed rates with the static initial
+  // order could yield an inconsistent comparison.
+  for (const auto& cpi : col_idx_predicates_) {
+    if (cpi.rows_evaluated < kMinRowsSampledForReorder) {
+      return;
+    }
+  }
+
+  // Sort by observed rejection rate, descending. Comparing via
+  // cross-multiplication avoids floating point. stable_sort keeps the
+  // static selectivity order as a tie-breaker.
+  stable_sort(col_idx_predicates_.begin(), col_idx_predicates_.end(),
+              [] (const ColumnPredicateInfo& left, const ColumnPredicateInfo& right) {
+                return left.rows_rejected * right.rows_evaluated >
+                    right.rows_rejected * left.rows_evaluated;
+              });
+}
+
 string MaterializingIterator::ToString() const {
   string s;
   s.append("Materializing(").append(iter_->ToString()).append(")");
@@ -606,9 +802,20 @@ Status PredicateEvaluatingIterator::Init(ScanSpec *spec) {
   // Sort the predicates by selectivity so that the most selective are evaluated earlier.
   sort(col_idx_predicates_.begin(), col_idx_predicates_.end(), SelectivityComparator);
 
+  if (PREDICT_FALSE(FLAGS_scan_cycle_accounting)) {
+    predicate_cycles_by_col_.assign(schema().num_columns(), 0);
+  }
+
   return Status::OK();
 }
 
+void PredicateEvaluatingIterator::GetIteratorStats(vector<IteratorStats>* stats) const {
+  base_iter_->GetIteratorStats(stats);
+  for (size_t i = 0; i < predicate_cycles_by_col_.size() && i < stats->size(); i++) {
+    (*stats)[i].predicate_cycles += predicate_cycles_by_col_[i];
+  }
+}
+
 bool PredicateEvaluatingIterator::HasNext() const {
   return base_iter_->HasNext();
 }
@@ -621,7 +828,14 @@ Status PredicateEvaluatingIterator::NextBlock(RowBlock *dst) {
     if (col_idx == Schema::kColumnNotFound) {
       return Status::InvalidArgument("Unknown column in predicate", predicate.ToString());
     }
-    predicate.Evaluate(dst->column_block(col_idx), dst->selection_vector());
+    if (PREDICT_FALSE(FLAGS_scan_cycle_accounting) &&
+        static_cast<size_t>(col_idx) < predicate_cycles_by_col_.size()) {
+      const int64_t start_cycles = CycleClock::Now();
+      predicate.Evaluate(dst->column_block(col_idx), dst->selection_vector());
+      predicate_cycles_by_col_[col_idx] += CycleClock::Now() - start_cycles;
+    } else {
+      predicate.Evaluate(dst->column_block(col_idx), dst->selection_vector());
+    }
 
     // If after evaluating this predicate, the entire row block has now been
     // filtered out, we don't need to evaluate any further predicates.
@@ -637,4 +851,332 @@ string PredicateEvaluatingIterator::ToString() const {
   return strings::Substitute("PredicateEvaluating($0)", base_iter_->ToString());
 }
 
+////////////////////////////////////////////////////////////
+// AggregatingIterator
+////////////////////////////////////////////////////////////
+
+namespace {
+
+// Number of rows fetched from the base iterator at a time.
+const int kAggregateBatchSize = 1024;
+
+// Reads a cell of an integer-physical type as an int64_t.
+int64_t IntCellValue(const TypeInfo* type_info, const void* cell) {
+  switch (type_info->physical_type()) {
+    case BOOL: return *reinterpret_cast<const bool*>(cell);
+    case UINT8: return *reinterpret_cast<const uint8_t*>(cell);
+    case INT8: return *reinterpret_cast<const int8_t*>(cell);
+    case UINT16: return *reinterpret_cast<const uint16_t*>(cell);
+    case INT16: return *reinterpret_cast<const int16_t*>(cell);
+    case UINT32: return *reinterpret_cast<const uint32_t*>(cell);
+    case INT32: return *reinterpret_cast<const int32_t*>(cell);
+    case UINT64: return static_cast<int64_t>(*reinterpret_cast<const uint64_t*>(cell));
+    case INT64: return *reinterpret_cast<const int64_t*>(cell);
+    default: LOG(FATAL) << "not an integer type: " << type_info->name();
+  }
+  return 0; // unreachable
+}
+
+// Writes 'value' into 'cell', casting it to the given integer-physical type.
+void SetIntCellValue(const TypeInfo* type_info, int64_t value, void* cell) {
+  switch (type_info->physical_type()) {
+    case BOOL: *reinterpret_cast<bool*>(cell) = value; break;
+    case UINT8: *reinterpret_cast<uint8_t*>(cell) = value; break;
+    case INT8: *reinterpret_cast<int8_t*>(cell) = value; break;
+    case UINT16: *reinterpret_cast<uint16_t*>(cell) = value; break;
+    case INT16: *reinterpret_cast<int16_t*>(cell) = value; break;
+    case UINT32: *reinterpret_cast<uint32_t*>(cell) = value; break;
+    case INT32: *reinterpret_cast<int32_t*>(cell) = value; break;
+    case UINT64: *reinterpret_cast<uint64_t*>(cell) = value; break;
+    case INT64: *reinterpret_cast<int64_t*>(cell) = value; break;
+    default: LOG(FATAL) << "not an integer type: " << type_info->name();
+  }
+}
+
+} // anonymous namespace
+
+AggregatingIterator::AggregatingIterator(shared_ptr<RowwiseIterator> base_iter,
+                                         int num_group_by_cols,
+                                         vector<AggregateFunc> funcs)
+    : base_iter_(move(base_iter)),
+      num_group_by_cols_(num_group_by_cols),
+      funcs_(move(funcs)),
+      initted_(false),
+      src_arena_(32 * 1024),
+      src_pos_(0),
+      in_group_(false) {
+}
+
+Status AggregatingIterator::Init(ScanSpec* spec) {
+  CHECK(!initted_);
+
+  // base_iter_ is already Init()ed before this is constructed, and must have
+  // accepted all predicates; aggregating unfiltered rows would produce wrong
+  // results.
+  CHECK(spec == nullptr || spec->predicates().empty());
+
+  const Schema& s = schema();
+  if (num_group_by_cols_ < 0 || num_group_by_cols_ >= s.num_columns()) {
+    return Status::InvalidArgument(
+        strings::Substitute("invalid number of group-by columns: $0",
+                            num_group_by_cols_));
+  }
+  if (funcs_.size() != s.num_columns() - num_group_by_cols_) {
+    return Status::InvalidArgument(
+        strings::Substitute("expected $0 aggregate functions but got $1",
+                            s.num_columns() - num_group_by_cols_, funcs_.size()));
+  }
+  for (int i = 0; i < funcs_.size(); i++) {
+    const ColumnSchema& col = s.column(num_group_by_cols_ + i);
+    DataType physical = col.type_info()->physical_type();
+    if (funcs_[i] != COUNT && physical == BINARY) {
+      return Status::InvalidArgument(
+          "aggregate not supported for column type", col.ToString());
+    }
+    if (funcs_[i] == SUM && physical == BOOL) {
+      return Status::InvalidArgument(
+          "SUM not supported for column type", col.ToString());
+    }
+  }
+
+  group_key_.reset(new GroupKeyCol[num_group_by_cols_]);
+  agg_states_.resize(funcs_.size());
+  src_block_.reset(new RowBlock(s, kAggregateBatchSize, &src_arena_));
+  src_block_->Resize(0);
+  initted_ = true;
+  return Status::OK();
+}
+
+bool AggregatingIterator::HasNext() const {
+  return in_group_ || src_pos_ < src_block_->nrows() || base_iter_->HasNext();
+}
+
+bool AggregatingIterator::RowInCurrentGroup(const RowBlockRow& row) const {
+  for (int i = 0; i < num_group_by_cols_; i++) {
+    const ColumnSchema& col = schema().column(i);
+    bool row_null = col.is_nullable() && row.is_null(i);
+    if (row_null != group_key_[i].is_null) {
+      return false;
+    }
+    if (row_null) {
+      continue;
+    }
+    if (col.type_info()->physical_type() == BINARY) {
+      const Slice* cell = reinterpret_cast<const Slice*>(row.cell_ptr(i));
+      if (cell->compare(Slice(group_key_[i].value)) != 0) {
+        return false;
+      }
+    } else if (col.type_info()->Compare(row.cell_ptr(i),
+                                        group_key_[i].value.data()) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void AggregatingIterator::StartGroup(const RowBlockRow& row) {
+  for (int i = 0; i < num_group_by_cols_; i++) {
+    const ColumnSchema& col = schema().column(i);
+    GroupKeyCol* key = &group_key_[i];
+    key->is_null = col.is_nullable() && row.is_null(i);
+    key->value.clear();
+    if (key->is_null) {
+      continue;
+    }
+    if (col.type_info()->physical_type() == BINARY) {
+      const Slice* cell = reinterpret_cast<const Slice*>(row.cell_ptr(i));
+      key->value.append(cell->data(), cell->size());
+    } else {
+      key->value.append(row.cell_ptr(i), col.type_info()->size());
+    }
+  }
+  for (AggState& state : agg_states_) {
+    state.has_value = false;
+    state.sum_int = 0;
+    state.sum_double = 0;
+    state.count = 0;
+  }
+  in_group_ = true;
+}
+
+void AggregatingIterator::AccumulateRow(const RowBlockRow& row) {
+  for (int i = 0; i < funcs_.size(); i++) {
+    int col_idx = num_group_by_cols_ + i;
+    const ColumnSchema& col = schema().column(col_idx);
+    if (col.is_nullable() && row.is_null(col_idx)) {
+      continue;
+    }
+    AggState* state = &agg_states_[i];
+    state->count++;
+    const TypeInfo* type_info = col.type_info();
+    const void* cell = row.cell_ptr(col_idx);
+    switch (funcs_[i]) {
+      case MIN:
+        if (!state->has_value || type_info->Compare(cell, state->min_max) < 0) {
+          memcpy(state->min_max, cell, type_info->size());
+        }
+        break;
+      case MAX:
+        if (!state->has_value || type_info->Compare(cell, state->min_max) > 0) {
+          memcpy(state->min_max, cell, type_info->size());
+        }
+        break;
+      case SUM:
+        switch (type_info->physical_type()) {
+          case FLOAT:
+            state->sum_double += *reinterpret_cast<const float*>(cell);
+            break;
+          case DOUBLE:
+            state->sum_double += *reinterpret_cast<const double*>(cell);
+            break;
+          default:
+            state->sum_int += IntCellValue(type_info, cell);
+            break;
+        }
+        break;
+      case COUNT:
+        break;
+    }
+    state->has_value = true;
+  }
+}
+
+Status AggregatingIterator::EmitGroup(RowBlock* dst, size_t dst_idx) {
+  for (int i = 0; i < num_group_by_cols_; i++) {
+    const ColumnSchema& col = schema().column(i);
+    ColumnBlock cb = dst->column_block(i);
+    if (col.is_nullable()) {
+      cb.SetCellIsNull(dst_idx, group_key_[i].is_null);
+    }
+    if (group_key_[i].is_null) {
+      continue;
+    }
+    if (col.type_info()->physical_type() == BINARY) {
+      Slice relocated;
+      if (!dst->arena()->RelocateSlice(Slice(group_key_[i].value), &relocated)) {
+        return Status::IOError("out of memory copying group key to arena");
+      }
+      cb.SetCellValue(dst_idx, &relocated);
+    } else {
+      cb.SetCellValue(dst_idx, group_key_[i].value.data());
+    }
+  }
+  for (int i = 0; i < funcs_.size(); i++) {
+    int col_idx = num_group_by_cols_ + i;
+    const ColumnSchema& col = schema().column(col_idx);
+    const TypeInfo* type_info = col.type_info();
+    ColumnBlock cb = dst->column_block(col_idx);
+    const AggState& state = agg_states_[i];
+
+    // COUNT never yields NULL; the other aggregates do when the group had no
+    // non-null cells (only possible for nullable columns).
+    bool is_null = funcs_[i] != COUNT && !state.has_value;
+    if (col.is_nullable()) {
+      cb.SetCellIsNull(dst_idx, is_null);
+    }
+    if (is_null) {
+      DCHECK(col.is_nullable());
+      continue;
+    }
+    void* cell = cb.mutable_cell_ptr(dst_idx);
+    switch (funcs_[i]) {
+      case MIN:
+      case MAX:
+        memcpy(cell, state.min_max, type_info->size());
+        break;
+      case SUM:
+        switch (type_info->physical_type()) {
+          case FLOAT:
+            *reinterpret_cast<float*>(cell) = state.sum_double;
+            break;
+          case DOUBLE:
+            *reinterpret_cast<double*>(cell) = state.sum_double;
+            break;
+          default:
+            SetIntCellValue(type_info, state.sum_int, cell);
+            break;
+        }
+        break;
+      case COUNT:
+        switch (type_info->physical_type()) {
+          case FLOAT:
+            *reinterpret_cast<float*>(cell) = state.count;
+            break;
+          case DOUBLE:
+            *reinterpret_cast<double*>(cell) = state.count;
+            break;
+          case BINARY: {
+            // COUNT over a binary column yields the decimal representation,
+            // there being no numeric cell to write into.
+            Slice relocated;
+            if (!dst->arena()->RelocateSlice(
+                    Slice(std::to_string(state.count)), &relocated)) {
+              return Status::IOError("out of memory copying count to arena");
+            }
+            *reinterpret_cast<Slice*>(cell) = relocated;
+            break;
+          }
+          default:
+            SetIntCellValue(type_info, state.count, cell);
+            break;
+        }
+        break;
+    }
+  }
+  return Status::OK();
+}
+
+Status AggregatingIterator::NextBlock(RowBlock* dst) {
+  DCHECK(initted_);
+  size_t out_rows = 0;
+  while (true) {
+    if (out_rows == dst->row_capacity()) {
+      break;
+    }
+    if (src_pos_ == src_block_->nrows()) {
+      // The current source block is exhausted; fetch another.
+      if (!base_iter_->HasNext()) {
+        break;
+      }
+      src_arena_.Reset();
+      src_block_->Resize(kAggregateBatchSize);
+      RETURN_NOT_OK(base_iter_->NextBlock(src_block_.get()));
+      src_pos_ = 0;
+      continue;
+    }
+    if (!src_block_->selection_vector()->IsRowSelected(src_pos_)) {
+      src_pos_++;
+      continue;
+    }
+    RowBlockRow row = src_block_->row(src_pos_);
+    if (in_group_ && !RowInCurrentGroup(row)) {
+      // This row begins a new group; emit the finished one. The row itself
+      // is left unconsumed so that the capacity check above reruns first.
+      RETURN_NOT_OK(EmitGroup(dst, out_rows++));
+      in_group_ = false;
+      continue;
+    }
+    if (!in_group_) {
+      StartGroup(row);
+    }
+    AccumulateRow(row);
+    src_pos_++;
+  }
+
+  // Flush the last group once the input is exhausted.
+  if (in_group_ && out_rows < dst->row_capacity() &&
+      src_pos_ == src_block_->nrows() && !base_iter_->HasNext()) {
+    RETURN_NOT_OK(EmitGroup(dst, out_rows++));
+    in_group_ = false;
+  }
+
+  dst->Resize(out_rows);
+  dst->selection_vector()->SetAllTrue();
+  return Status::OK();
+}
+
+string AggregatingIterator::ToString() const {
+  return strings::Substitute("Aggregating($0)", base_iter_->ToString());
+}
+
 } // namespace kudu
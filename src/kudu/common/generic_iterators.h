@@ -23,7 +23,6 @@
 #include <memory>
 #include <ostream>
 #include <string>
-#include <tuple>
 #include <vector>
 
 #include <glog/logging.h>
@@ -36,7 +35,9 @@
 #include "kudu/common/schema.h"
 #include "kudu/gutil/gscoped_ptr.h"
 #include "kudu/gutil/port.h"
+#include "kudu/util/faststring.h"
 #include "kudu/util/locks.h"
+#include "kudu/util/memory/arena.h"
 #include "kudu/util/object_pool.h"
 #include "kudu/util/status.h"
 
@@ -44,6 +45,8 @@ namespace kudu {
 
 class MergeIterState;
 class RowBlock;
+class RowBlockRow;
+class ThreadPool;
 
 // An iterator which merges the results of other iterators, comparing
 // based on keys.
@@ -74,6 +77,18 @@ class MergeIterator : public RowwiseIterator {
   Status MaterializeBlock(RowBlock* dst);
   Status InitSubIterators(ScanSpec *spec);
 
+  // Rebuild 'loser_tree_' from scratch over the current contents of 'iters_'.
+  // Called whenever the set of sub-iterators changes.
+  void RebuildLoserTree();
+
+  // Replay the tournament matches along the path from leaf 'leaf_idx' to the
+  // root, after the corresponding sub-iterator has advanced to a new row.
+  void ReplayLoserTree(size_t leaf_idx);
+
+  // Returns true if the current row of sub-iterator 'a' merges before that of
+  // sub-iterator 'b'. Ties are broken by position so the merge is stable.
+  bool LeafLessThan(size_t a, size_t b) const;
+
   const Schema schema_;
 
   bool initted_;
@@ -87,6 +102,14 @@ class MergeIterator : public RowwiseIterator {
   mutable rw_spinlock iters_lock_;
   std::vector<std::unique_ptr<MergeIterState>> iters_;
 
+  // Tournament (loser) tree over 'iters_', in the classic array layout: entry
+  // 0 holds the index of the overall winner (the sub-iterator with the
+  // smallest current row), and entries 1..k-1 hold the losers of the internal
+  // matches. Each advance of the winner replays only its root path, so
+  // selecting the next row costs O(log k) comparisons rather than a linear
+  // scan of all sub-iterators.
+  std::vector<size_t> loser_tree_;
+
   // Statistics (keyed by projection column index) accumulated so far by any
   // fully-consumed sub-iterators.
   std::vector<IteratorStats> finished_iter_stats_by_col_;
@@ -189,9 +212,7 @@ class MaterializingIterator : public RowwiseIterator {
     return iter_->schema();
   }
 
-  virtual void GetIteratorStats(std::vector<IteratorStats>* stats) const OVERRIDE {
-    iter_->GetIteratorStats(stats);
-  }
+  virtual void GetIteratorStats(std::vector<IteratorStats>* stats) const OVERRIDE;
 
   virtual Status NextBlock(RowBlock* dst) OVERRIDE;
 
@@ -201,14 +222,57 @@ class MaterializingIterator : public RowwiseIterator {
 
   Status MaterializeBlock(RowBlock *dst);
 
+  // Materialize the single non-predicate column 'col_idx' into 'dst'.
+  Status MaterializeSingleColumn(size_t col_idx, RowBlock* dst);
+
+  // Materialize all non-predicate columns into 'dst', farming the
+  // fixed-size columns out to 'pool'.
+  Status MaterializeColumnsInParallel(ThreadPool* pool, RowBlock* dst);
+
+  // A predicate pushed down into this iterator, along with bookkeeping on
+  // how effective the predicate has been observed to be.
+  struct ColumnPredicateInfo {
+    ColumnPredicateInfo(int32_t col_idx, ColumnPredicate pred)
+        : col_idx(col_idx),
+          pred(std::move(pred)),
+          rows_evaluated(0),
+          rows_rejected(0) {}
+
+    int32_t col_idx;
+    ColumnPredicate pred;
+
+    // The number of live rows this predicate has been evaluated against,
+    // and how many of those it rejected. Used by MaybeReorderPredicates()
+    // to move the predicate observed to filter the most rows to the front,
+    // so that its column is materialized first and the other columns are
+    // only materialized for rows which survive it.
+    int64_t rows_evaluated;
+    int64_t rows_rejected;
+  };
+
+  // Periodically reorder 'col_idx_predicates_' by their observed
+  // selectivity, once each predicate has been evaluated against enough rows
+  // for its observed rejection rate to be meaningful.
+  void MaybeReorderPredicates();
+
   std::shared_ptr<ColumnwiseIterator> iter_;
 
-  // List of (column index, predicate) in order of most to least selective.
-  std::vector<std::tuple<int32_t, ColumnPredicate>> col_idx_predicates_;
+  // List of pushed-down predicates, ordered most to least selective:
+  // initially by the static selectivity of the predicate types, and
+  // thereafter adaptively by observed selectivity.
+  std::vector<ColumnPredicateInfo> col_idx_predicates_;
 
   // List of column indexes without predicates to materialize.
   std::vector<int32_t> non_predicate_column_indexes_;
 
+  // Number of row blocks materialized since 'col_idx_predicates_' was last
+  // considered for reordering.
+  int blocks_since_reorder_;
+
+  // Per-column CPU cycles spent evaluating pushed-down predicates. Only
+  // populated when --scan_cycle_accounting is enabled; sized in Init().
+  std::vector<int64_t> predicate_cycles_by_col_;
+
   // Set only by test code to disallow pushdown.
   bool disallow_pushdown_for_tests_;
   bool disallow_decoder_eval_;
@@ -243,9 +307,7 @@ class PredicateEvaluatingIterator : public RowwiseIterator {
     return base_iter_->schema();
   }
 
-  virtual void GetIteratorStats(std::vector<IteratorStats>* stats) const OVERRIDE {
-    base_iter_->GetIteratorStats(stats);
-  }
+  virtual void GetIteratorStats(std::vector<IteratorStats>* stats) const OVERRIDE;
 
  private:
   // Construct the evaluating iterator.
@@ -259,6 +321,122 @@ class PredicateEvaluatingIterator : public RowwiseIterator {
 
   // List of (column index, predicate) in order of most to least selective.
   std::vector<ColumnPredicate> col_idx_predicates_;
+
+  // Per-column CPU cycles spent evaluating predicates. Only populated when
+  // --scan_cycle_accounting is enabled; sized in Init().
+  std::vector<int64_t> predicate_cycles_by_col_;
+};
+
+// An iterator which wraps an ordered iterator and collapses consecutive rows
+// sharing a group-by key prefix into single aggregated rows, so that only
+// one row per group is returned to the caller.
+class AggregatingIterator : public RowwiseIterator {
+ public:
+  // The aggregate functions which may be applied to a column.
+  enum AggregateFunc {
+    MIN,
+    MAX,
+    SUM,
+    COUNT
+  };
+
+  // Construct an aggregating iterator over 'base_iter'.
+  //
+  // The first 'num_group_by_cols' columns of the base iterator's schema form
+  // the group-by key; 'funcs' holds one aggregate function per remaining
+  // column, in schema order. The base iterator must return rows ordered by
+  // the group-by columns (e.g. a tablet scan grouped on a prefix of the
+  // primary key) so that each group's rows are consecutive and a single
+  // set of accumulators suffices.
+  //
+  // Aggregates are computed in 64-bit accumulators but emitted in the
+  // aggregated column's own type, so SUM and COUNT results over narrower
+  // columns may overflow on wraparound; callers should aggregate over 64-bit
+  // columns when the sums may be large.
+  //
+  // The passed-in iterator should be already initialized.
+  AggregatingIterator(std::shared_ptr<RowwiseIterator> base_iter,
+                      int num_group_by_cols,
+                      std::vector<AggregateFunc> funcs);
+
+  // Initialize the iterator, validating the aggregate specification against
+  // the schema. MIN/MAX/SUM are not supported for string or binary columns,
+  // nor is SUM for bool columns.
+  Status Init(ScanSpec* spec) OVERRIDE;
+
+  virtual Status NextBlock(RowBlock* dst) OVERRIDE;
+
+  bool HasNext() const OVERRIDE;
+
+  std::string ToString() const OVERRIDE;
+
+  const Schema& schema() const OVERRIDE {
+    return base_iter_->schema();
+  }
+
+  virtual void GetIteratorStats(std::vector<IteratorStats>* stats) const OVERRIDE {
+    base_iter_->GetIteratorStats(stats);
+  }
+
+ private:
+  // The group-by key cell of the group currently being accumulated.
+  struct GroupKeyCol {
+    bool is_null;
+
+    // The raw cell value for fixed-size types, or the referenced data for
+    // binary types. Copied out of the source block since the group may span
+    // multiple blocks.
+    faststring value;
+  };
+
+  // Per-aggregated-column accumulator state for the group currently being
+  // accumulated.
+  struct AggState {
+    // Whether any non-null cell has been accumulated.
+    bool has_value;
+
+    // Raw cell storage for MIN/MAX. Large enough for any fixed-size type.
+    uint8_t min_max[16];
+
+    // 64-bit accumulators for SUM.
+    int64_t sum_int;
+    double sum_double;
+
+    // The number of non-null cells, for COUNT.
+    int64_t count;
+  };
+
+  // Returns true if 'row' has the same group-by key as the group currently
+  // being accumulated.
+  bool RowInCurrentGroup(const RowBlockRow& row) const;
+
+  // Begin a new group whose key is taken from 'row'.
+  void StartGroup(const RowBlockRow& row);
+
+  // Fold 'row' into the current group's accumulators.
+  void AccumulateRow(const RowBlockRow& row);
+
+  // Write the current group's key and aggregates to row 'dst_idx' of 'dst'.
+  Status EmitGroup(RowBlock* dst, size_t dst_idx);
+
+  std::shared_ptr<RowwiseIterator> base_iter_;
+  const int num_group_by_cols_;
+  const std::vector<AggregateFunc> funcs_;
+
+  bool initted_;
+
+  // Buffer for rows fetched from the base iterator, and the position of the
+  // next unconsumed row within it.
+  Arena src_arena_;
+  gscoped_ptr<RowBlock> src_block_;
+  size_t src_pos_;
+
+  // Whether a group is currently being accumulated.
+  bool in_group_;
+
+  // Key and accumulators for that group. Sized during Init().
+  std::unique_ptr<GroupKeyCol[]> group_key_;
+  std::vector<AggState> agg_states_;
 };
 
 } // namespace kudu
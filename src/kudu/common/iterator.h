@@ -100,6 +100,18 @@ class ColumnwiseIterator : public virtual IteratorBase {
   // arena, if non-null.
   virtual Status MaterializeColumn(ColumnMaterializationContext* ctx) = 0;
 
+  // Return true if MaterializeColumn() may be called concurrently from
+  // multiple threads for *distinct* columns of the same prepared batch.
+  // Implementations whose columns share mutable state (e.g. a common delta
+  // iterator) must return false.
+  //
+  // NOTE: even when this returns true, callers must still serialize
+  // materialization of columns which copy indirect data, since the
+  // destination block's arena is not thread-safe.
+  virtual bool SupportsConcurrentColumnMaterialization() const {
+    return false;
+  }
+
   // Finish the current batch.
   virtual Status FinishBatch() = 0;
 
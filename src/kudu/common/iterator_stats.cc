@@ -17,9 +17,20 @@
 
 #include "kudu/common/iterator_stats.h"
 
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/flag_tags.h"
+
+DEFINE_bool(scan_cycle_accounting, false,
+            "Whether to record per-stage CPU cycle counts (column decode, "
+            "delta application, predicate evaluation, row serialization) for "
+            "scans. The counts are exposed in the scan trace and on the "
+            "/scans web page. Adds a pair of cycle counter reads around each "
+            "stage of every scanned block, so it is off by default.");
+TAG_FLAG(scan_cycle_accounting, advanced);
+TAG_FLAG(scan_cycle_accounting, runtime);
 
 namespace kudu {
 
@@ -29,22 +40,34 @@ using strings::Substitute;
 IteratorStats::IteratorStats()
     : data_blocks_read_from_disk(0),
       bytes_read_from_disk(0),
-      cells_read_from_disk(0) {
+      cells_read_from_disk(0),
+      decode_cycles(0),
+      delta_apply_cycles(0),
+      predicate_cycles(0) {
 }
 
 string IteratorStats::ToString() const {
   return Substitute("data_blocks_read_from_disk=$0 "
                     "bytes_read_from_disk=$1 "
-                    "cells_read_from_disk=$2",
+                    "cells_read_from_disk=$2 "
+                    "decode_cycles=$3 "
+                    "delta_apply_cycles=$4 "
+                    "predicate_cycles=$5",
                     data_blocks_read_from_disk,
                     bytes_read_from_disk,
-                    cells_read_from_disk);
+                    cells_read_from_disk,
+                    decode_cycles,
+                    delta_apply_cycles,
+                    predicate_cycles);
 }
 
 void IteratorStats::AddStats(const IteratorStats& other) {
   data_blocks_read_from_disk += other.data_blocks_read_from_disk;
   bytes_read_from_disk += other.bytes_read_from_disk;
   cells_read_from_disk += other.cells_read_from_disk;
+  decode_cycles += other.decode_cycles;
+  delta_apply_cycles += other.delta_apply_cycles;
+  predicate_cycles += other.predicate_cycles;
   DCheckNonNegative();
 }
 
@@ -52,6 +75,9 @@ void IteratorStats::SubtractStats(const IteratorStats& other) {
   data_blocks_read_from_disk -= other.data_blocks_read_from_disk;
   bytes_read_from_disk -= other.bytes_read_from_disk;
   cells_read_from_disk -= other.cells_read_from_disk;
+  decode_cycles -= other.decode_cycles;
+  delta_apply_cycles -= other.delta_apply_cycles;
+  predicate_cycles -= other.predicate_cycles;
   DCheckNonNegative();
 }
 
@@ -59,6 +85,9 @@ void IteratorStats::DCheckNonNegative() const {
   DCHECK_GE(data_blocks_read_from_disk, 0);
   DCHECK_GE(bytes_read_from_disk, 0);
   DCHECK_GE(cells_read_from_disk, 0);
+  DCHECK_GE(decode_cycles, 0);
+  DCHECK_GE(delta_apply_cycles, 0);
+  DCHECK_GE(predicate_cycles, 0);
 }
 
 
@@ -37,6 +37,19 @@ struct IteratorStats {
   // they were decoded/materialized.
   int64_t cells_read_from_disk;
 
+  // CPU cycles spent decoding data blocks and copying their cells into the
+  // destination row block. Only recorded when --scan_cycle_accounting is
+  // enabled; zero otherwise.
+  int64_t decode_cycles;
+
+  // CPU cycles spent applying deltas (updates and deletes) to the column.
+  // Only recorded when --scan_cycle_accounting is enabled.
+  int64_t delta_apply_cycles;
+
+  // CPU cycles spent evaluating predicates against the column.
+  // Only recorded when --scan_cycle_accounting is enabled.
+  int64_t predicate_cycles;
+
   // Add statistics contained 'other' to this object (for each field
   // in this object, increment it by the value of the equivalent field
   // in 'other').
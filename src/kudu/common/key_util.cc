@@ -244,6 +244,7 @@ int PushUpperBoundKeyPredicates(ColIdxIter first,
         break;
       case PredicateType::IsNotNull: // Fallthrough intended
       case PredicateType::IsNull:
+      case PredicateType::InBloomFilter:
         break_loop = true;
         break;
       case PredicateType::InList:
@@ -306,6 +307,7 @@ int PushLowerBoundKeyPredicates(ColIdxIter first,
         break;
       case PredicateType::IsNotNull: // Fallthrough intended
       case PredicateType::IsNull:
+      case PredicateType::InBloomFilter:
         break_loop = true;
         break;
       case PredicateType::InList:
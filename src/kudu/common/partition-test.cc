@@ -32,6 +32,7 @@
 #include "kudu/common/partition.h"
 #include "kudu/common/schema.h"
 #include "kudu/gutil/strings/join.h"
+#include "kudu/gutil/strings/substitute.h"
 #include "kudu/util/slice.h"
 #include "kudu/util/status.h"
 #include "kudu/util/test_macros.h"
@@ -309,6 +310,46 @@ TEST_F(PartitionTest, TestPartitionKeyEncoding) {
   }
 }
 
+TEST_F(PartitionTest, TestHashBucketCacheEncoding) {
+  // CREATE TABLE t (a INT32, b VARCHAR, c VARCHAR, PRIMARY KEY (a, b, c))
+  // PARITITION BY [HASH BUCKET (a, b), HASH BUCKET (c), RANGE (a, b, c)];
+  Schema schema({ ColumnSchema("a", INT32),
+                  ColumnSchema("b", STRING),
+                  ColumnSchema("c", STRING) },
+                { ColumnId(0), ColumnId(1), ColumnId(2) }, 3);
+
+  PartitionSchemaPB schema_builder;
+  AddHashBucketComponent(&schema_builder, { "a", "b" }, 32, 0);
+  AddHashBucketComponent(&schema_builder, { "c" }, 32, 42);
+  PartitionSchema partition_schema;
+  ASSERT_OK(PartitionSchema::FromPB(schema_builder, schema, &partition_schema));
+
+  // Encode a sequence of rows which alternates between repeating and
+  // changing the hash column values, and check that the cache-aware
+  // overload always produces the same key as the plain one. Leave 'b'
+  // unset on some rows to exercise the min-value encoding path.
+  PartitionSchema::HashBucketCache cache;
+  for (int i = 0; i < 100; i++) {
+    KuduPartialRow row(&schema);
+    ASSERT_OK(row.SetInt32("a", i / 10));
+    if (i % 7 != 0) {
+      ASSERT_OK(row.SetStringCopy("b", i % 20 == 0 ? "" : "b"));
+    }
+    ASSERT_OK(row.SetStringCopy("c", strings::Substitute("c$0", i / 25)));
+
+    string expected_key;
+    ASSERT_OK(partition_schema.EncodeKey(row, &expected_key));
+
+    string cached_key;
+    ASSERT_OK(partition_schema.EncodeKey(row, &cache, &cached_key));
+    ASSERT_EQ(expected_key, cached_key);
+
+    if (i % 30 == 0) {
+      cache.Reset();
+    }
+  }
+}
+
 TEST_F(PartitionTest, TestCreateRangePartitions) {
   {
     // Splits:
@@ -220,6 +220,66 @@ Status PartitionSchema::EncodeKey(const ConstContiguousRow& row, string* buf) co
   return EncodeColumns(row, range_schema_.column_ids, buf);
 }
 
+template<typename Row>
+Status PartitionSchema::EncodeKeyWithCacheImpl(const Row& row,
+                                               HashBucketCache* cache,
+                                               string* buf) const {
+  const KeyEncoder<string>& hash_encoder = GetKeyEncoder<string>(GetTypeInfo(UINT32));
+
+  if (PREDICT_FALSE(cache->plan_schema_ != row.schema())) {
+    BuildEncoderPlan(*row.schema(), cache);
+  }
+
+  cache->entries_.resize(hash_bucket_schemas_.size());
+  for (int i = 0; i < hash_bucket_schemas_.size(); i++) {
+    const HashBucketSchema& hash_bucket_schema = hash_bucket_schemas_[i];
+    HashBucketCache::Entry* entry = &cache->entries_[i];
+    cache->tmp_.clear();
+    RETURN_NOT_OK(EncodeColumnsWithPlan(row, cache->column_plans_[i], &cache->tmp_));
+    if (PREDICT_FALSE(!entry->valid || cache->tmp_ != entry->encoded_columns)) {
+      entry->bucket = BucketForEncodedColumns(cache->tmp_, hash_bucket_schema);
+      entry->encoded_columns.swap(cache->tmp_);
+      entry->valid = true;
+    }
+    hash_encoder.Encode(&entry->bucket, buf);
+  }
+
+  return EncodeColumnsWithPlan(row, cache->column_plans_.back(), buf);
+}
+
+void PartitionSchema::BuildEncoderPlan(const Schema& schema, HashBucketCache* cache) const {
+  auto build_plan = [&schema](const vector<ColumnId>& column_ids,
+                              vector<HashBucketCache::ColumnPlan>* plan) {
+    plan->clear();
+    plan->reserve(column_ids.size());
+    for (const ColumnId& column_id : column_ids) {
+      int32_t column_idx = schema.find_column_by_id(column_id);
+      CHECK(column_idx != Schema::kColumnNotFound);
+      const TypeInfo* type_info = schema.column(column_idx).type_info();
+      plan->push_back({ column_idx, type_info, &GetKeyEncoder<string>(type_info) });
+    }
+  };
+
+  cache->column_plans_.resize(hash_bucket_schemas_.size() + 1);
+  for (int i = 0; i < hash_bucket_schemas_.size(); i++) {
+    build_plan(hash_bucket_schemas_[i].column_ids, &cache->column_plans_[i]);
+  }
+  build_plan(range_schema_.column_ids, &cache->column_plans_.back());
+  cache->plan_schema_ = &schema;
+}
+
+Status PartitionSchema::EncodeKey(const KuduPartialRow& row,
+                                  HashBucketCache* cache,
+                                  string* buf) const {
+  return EncodeKeyWithCacheImpl(row, cache, buf);
+}
+
+Status PartitionSchema::EncodeKey(const ConstContiguousRow& row,
+                                  HashBucketCache* cache,
+                                  string* buf) const {
+  return EncodeKeyWithCacheImpl(row, cache, buf);
+}
+
 Status PartitionSchema::EncodeRangeKey(const KuduPartialRow& row,
                                        const Schema& schema,
                                        string* key) const {
@@ -915,6 +975,33 @@ Status PartitionSchema::EncodeColumns(const KuduPartialRow& row,
   return Status::OK();
 }
 
+Status PartitionSchema::EncodeColumnsWithPlan(const ConstContiguousRow& row,
+                                              const vector<HashBucketCache::ColumnPlan>& plan,
+                                              string* buf) {
+  for (int i = 0; i < plan.size(); i++) {
+    const HashBucketCache::ColumnPlan& p = plan[i];
+    p.encoder->Encode(row.cell_ptr(p.column_idx), i + 1 == plan.size(), buf);
+  }
+  return Status::OK();
+}
+
+Status PartitionSchema::EncodeColumnsWithPlan(const KuduPartialRow& row,
+                                              const vector<HashBucketCache::ColumnPlan>& plan,
+                                              string* buf) {
+  for (int i = 0; i < plan.size(); i++) {
+    const HashBucketCache::ColumnPlan& p = plan[i];
+    if (PREDICT_FALSE(!row.IsColumnSet(p.column_idx))) {
+      uint8_t min_value[kLargestTypeSize];
+      p.type_info->CopyMinValue(min_value);
+      p.encoder->Encode(min_value, i + 1 == plan.size(), buf);
+    } else {
+      ContiguousRow cont_row(row.schema(), row.row_data_);
+      p.encoder->Encode(cont_row.cell_ptr(p.column_idx), i + 1 == plan.size(), buf);
+    }
+  }
+  return Status::OK();
+}
+
 int32_t PartitionSchema::BucketForEncodedColumns(const string& encoded_key,
                                                  const HashBucketSchema& hash_bucket_schema) {
   uint64_t hash = HashUtil::MurmurHash2_64(encoded_key.data(),
@@ -36,6 +36,10 @@ class ConstContiguousRow;
 class KuduPartialRow;
 class PartitionSchemaPB;
 class PartitionPB;
+class TypeInfo;
+
+template <typename Buffer>
+class KeyEncoder;
 
 // A Partition describes the set of rows that a Tablet is responsible for
 // serving. Each tablet is assigned a single Partition.
@@ -150,6 +154,76 @@ class PartitionSchema {
   Status EncodeKey(const KuduPartialRow& row, std::string* buf) const WARN_UNUSED_RESULT;
   Status EncodeKey(const ConstContiguousRow& row, std::string* buf) const WARN_UNUSED_RESULT;
 
+  // Memoizes the hash bucket components of encoded partition keys across
+  // consecutively encoded rows.
+  //
+  // Many write workloads send long runs of rows with identical hash column
+  // values (e.g. time series clustered by device). When the encoded hash
+  // columns of a row match those of the previously encoded row, the cached
+  // bucket is reused rather than re-hashed. The cache also reuses its
+  // encoding buffers, avoiding a per-row allocation for each hash bucket
+  // component.
+  //
+  // A cache instance is only valid against a single partition schema unless
+  // Reset() between uses. Not thread-safe.
+  class HashBucketCache {
+   public:
+    HashBucketCache() : plan_schema_(nullptr) {}
+
+    // Invalidates any cached buckets and column plans, e.g. in order to
+    // reuse the cache against a different partition schema.
+    void Reset() {
+      entries_.clear();
+      plan_schema_ = nullptr;
+    }
+
+   private:
+    friend class PartitionSchema;
+
+    struct Entry {
+      Entry() : bucket(0), valid(false) {}
+
+      // The encoded hash columns of the previously encoded row.
+      std::string encoded_columns;
+      // The bucket computed from 'encoded_columns'.
+      int32_t bucket;
+      // Whether 'bucket' has been computed yet.
+      bool valid;
+    };
+
+    // The resolved encoding steps for one column: where the column lives in
+    // the row's schema and how to encode it. Looking these up once per schema
+    // instead of once per row keeps the per-row hash setup off the hot path.
+    struct ColumnPlan {
+      int32_t column_idx;
+      const TypeInfo* type_info;
+      const KeyEncoder<std::string>* encoder;
+    };
+
+    // One entry per hash bucket component of the partition schema.
+    std::vector<Entry> entries_;
+
+    // The schema for which 'column_plans_' was built, or NULL if no plan
+    // has been built yet.
+    const Schema* plan_schema_;
+
+    // One plan per hash bucket component of the partition schema, followed
+    // by one for the range component.
+    std::vector<std::vector<ColumnPlan>> column_plans_;
+
+    // Scratch buffer for encoding the hash columns of the current row.
+    std::string tmp_;
+  };
+
+  // Like EncodeKey() above, but memoizes the hash bucket computations in
+  // 'cache' across calls.
+  Status EncodeKey(const KuduPartialRow& row,
+                   HashBucketCache* cache,
+                   std::string* buf) const WARN_UNUSED_RESULT;
+  Status EncodeKey(const ConstContiguousRow& row,
+                   HashBucketCache* cache,
+                   std::string* buf) const WARN_UNUSED_RESULT;
+
   // Creates the set of table partitions for a partition schema and collection
   // of split rows and split bounds.
   //
@@ -266,6 +340,20 @@ class PartitionSchema {
                               const std::vector<ColumnId>& column_ids,
                               std::string* buf);
 
+  // Builds the per-schema column plans in 'cache' for this partition
+  // schema's hash and range components, resolving the column indexes and
+  // key encoders once so that per-row encoding can skip the lookups.
+  void BuildEncoderPlan(const Schema& schema, HashBucketCache* cache) const;
+
+  // Like EncodeColumns(), but uses the pre-resolved column indexes and
+  // encoders from a HashBucketCache column plan.
+  static Status EncodeColumnsWithPlan(const KuduPartialRow& row,
+                                      const std::vector<HashBucketCache::ColumnPlan>& plan,
+                                      std::string* buf);
+  static Status EncodeColumnsWithPlan(const ConstContiguousRow& row,
+                                      const std::vector<HashBucketCache::ColumnPlan>& plan,
+                                      std::string* buf);
+
   // Returns the hash bucket of the encoded hash column. The encoded columns must match the
   // columns of the hash bucket schema.
   static int32_t BucketForEncodedColumns(const std::string& encoded_hash_columns,
@@ -291,6 +379,12 @@ class PartitionSchema {
   template<typename Row>
   Status EncodeKeyImpl(const Row& row, std::string* buf) const;
 
+  // Private templated helper for the cache-aware EncodeKey overloads.
+  template<typename Row>
+  Status EncodeKeyWithCacheImpl(const Row& row,
+                                HashBucketCache* cache,
+                                std::string* buf) const;
+
   // Returns true if all of the columns in the range partition key are unset in
   // the row.
   bool IsRangePartitionKeyEmpty(const KuduPartialRow& row) const;
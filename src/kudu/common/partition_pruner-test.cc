@@ -592,6 +592,171 @@ TEST_F(PartitionPrunerTest, TestRangePruning) {
   Check({ ColumnPredicate::IsNotNull(schema.column(2)) }, 3);
 }
 
+TEST_F(PartitionPrunerTest, TestInListRangePruning) {
+  // CREATE TABLE t
+  // (a INT8, b STRING, c INT8)
+  // PRIMARY KEY (a, b, c))
+  // DISTRIBUTE BY RANGE(c, b);
+  // SPLIT ROWS [(0, "m"), (10, "r")];
+  Schema schema({ ColumnSchema("a", INT8),
+                  ColumnSchema("b", STRING),
+                  ColumnSchema("c", INT8) },
+                { ColumnId(0), ColumnId(1), ColumnId(2) },
+                3);
+
+  PartitionSchema partition_schema;
+  auto pb = PartitionSchemaPB();
+  auto range_schema = pb.mutable_range_schema();
+  range_schema->add_columns()->set_name("c");
+  range_schema->add_columns()->set_name("b");
+  ASSERT_OK(PartitionSchema::FromPB(pb, schema, &partition_schema));
+
+  KuduPartialRow split1(&schema);
+  ASSERT_OK(split1.SetInt8("c", 0));
+  ASSERT_OK(split1.SetStringCopy("b", "m"));
+
+  KuduPartialRow split2(&schema);
+  ASSERT_OK(split2.SetInt8("c", 10));
+  ASSERT_OK(split2.SetStringCopy("b", "r"));
+
+  vector<Partition> partitions;
+  ASSERT_OK(partition_schema.CreatePartitions({ split1, split2 }, {}, schema, &partitions));
+
+  // Applies the specified predicates to a scan and checks that the expected
+  // number of partitions are pruned, and that the pruner splits the scan into
+  // the expected number of partition key ranges.
+  auto Check = [&] (const vector<ColumnPredicate>& predicates,
+                    size_t remaining_tablets,
+                    size_t pruner_ranges) {
+    ScanSpec spec;
+
+    for (const auto& pred : predicates) {
+      spec.AddPredicate(pred);
+    }
+
+    CheckPrunedPartitions(schema, partition_schema, partitions, spec,
+                          remaining_tablets, pruner_ranges);
+  };
+
+  int8_t neg_five = -5;
+  int8_t zero = 0;
+  int8_t five = 5;
+  int8_t fifty = 50;
+  int8_t max = INT8_MAX;
+
+  Slice a = "a";
+  Slice m = "m";
+  Slice z = "z";
+
+  vector<const void*> b_values;
+  vector<const void*> c_values;
+
+  // c IN (-5, 5)
+  c_values = { &neg_five, &five };
+  Check({ ColumnPredicate::InList(schema.column(2), &c_values) }, 2, 2);
+
+  // c IN (-5, 50)
+  //
+  // Without per-value splitting this would cover the middle tablet as well.
+  c_values = { &neg_five, &fifty };
+  Check({ ColumnPredicate::InList(schema.column(2), &c_values) }, 2, 2);
+
+  // c IN (-5, 5)
+  // b = "m"
+  c_values = { &neg_five, &five };
+  Check({ ColumnPredicate::InList(schema.column(2), &c_values),
+          ColumnPredicate::Equality(schema.column(1), &m) },
+        2, 2);
+
+  // c = 0
+  // b IN ("a", "z")
+  b_values = { &a, &z };
+  Check({ ColumnPredicate::Equality(schema.column(2), &zero),
+          ColumnPredicate::InList(schema.column(1), &b_values) },
+        2, 2);
+
+  // b IN ("a", "z")
+  //
+  // The in-list isn't on the first range column and c is unconstrained, so no
+  // splitting (or pruning) occurs.
+  b_values = { &a, &z };
+  Check({ ColumnPredicate::InList(schema.column(1), &b_values) }, 3, 1);
+
+  // c IN (0, MAX)
+  //
+  // The exclusive upper bound of the MAX branch isn't representable, so the
+  // scan falls back to a single contiguous range with no upper bound.
+  c_values = { &zero, &max };
+  Check({ ColumnPredicate::InList(schema.column(2), &c_values) }, 3, 1);
+}
+
+TEST_F(PartitionPrunerTest, TestInListRangePruningWithPrimaryKeyPrefix) {
+  // CREATE TABLE t
+  // (a INT8, b STRING)
+  // PRIMARY KEY (a, b))
+  // DISTRIBUTE BY RANGE(a);
+  // SPLIT ROWS [(0), (10)];
+  Schema schema({ ColumnSchema("a", INT8),
+                  ColumnSchema("b", STRING) },
+                { ColumnId(0), ColumnId(1) },
+                2);
+
+  PartitionSchema partition_schema;
+  auto pb = PartitionSchemaPB();
+  auto range_schema = pb.mutable_range_schema();
+  range_schema->add_columns()->set_name("a");
+  ASSERT_OK(PartitionSchema::FromPB(pb, schema, &partition_schema));
+
+  KuduPartialRow split1(&schema);
+  ASSERT_OK(split1.SetInt8("a", 0));
+
+  KuduPartialRow split2(&schema);
+  ASSERT_OK(split2.SetInt8("a", 10));
+
+  vector<Partition> partitions;
+  ASSERT_OK(partition_schema.CreatePartitions({ split1, split2 }, {}, schema, &partitions));
+
+  // Applies the specified predicates to a scan and checks that the expected
+  // number of partitions are pruned, and that the pruner splits the scan into
+  // the expected number of partition key ranges.
+  auto Check = [&] (const vector<ColumnPredicate>& predicates,
+                    size_t remaining_tablets,
+                    size_t pruner_ranges) {
+    ScanSpec spec;
+
+    for (const auto& pred : predicates) {
+      spec.AddPredicate(pred);
+    }
+
+    CheckPrunedPartitions(schema, partition_schema, partitions, spec,
+                          remaining_tablets, pruner_ranges);
+  };
+
+  int8_t neg_five = -5;
+  int8_t five = 5;
+  int8_t fifty = 50;
+
+  vector<const void*> a_values;
+
+  // a IN (-5, 5)
+  a_values = { &neg_five, &five };
+  Check({ ColumnPredicate::InList(schema.column(0), &a_values) }, 2, 2);
+
+  // a IN (-5, 50)
+  //
+  // Without per-value splitting the scan's primary key bounds would cover the
+  // middle tablet as well.
+  a_values = { &neg_five, &fifty };
+  Check({ ColumnPredicate::InList(schema.column(0), &a_values) }, 2, 2);
+
+  // a IN (-5, 5, 50)
+  a_values = { &neg_five, &five, &fifty };
+  Check({ ColumnPredicate::InList(schema.column(0), &a_values) }, 3, 3);
+
+  // a = 5
+  Check({ ColumnPredicate::Equality(schema.column(0), &five) }, 1, 1);
+}
+
 TEST_F(PartitionPrunerTest, TestHashPruning) {
   // CREATE TABLE t
   // (a INT8, b INT8, c INT8)
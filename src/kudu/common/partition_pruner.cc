@@ -151,12 +151,18 @@ void EncodeRangeKeysFromPrimaryKeyBounds(const Schema& schema,
   }
 }
 
-// Push the scan predicates into the range keys.
+// Push the scan predicates into one or more range key bounds.
+//
+// An in-list predicate on a range column whose preceding range columns are
+// all equality-constrained is split into one minimal range per list value,
+// rather than a single range spanning from the smallest to the largest
+// value. This keeps a scan with e.g. an in-list on the leading range column
+// (a common multi-tenant pattern) from covering the tablets of every value
+// in between.
 void EncodeRangeKeysFromPredicates(const Schema& schema,
                                    const unordered_map<string, ColumnPredicate>& predicates,
                                    const vector<ColumnId>& range_columns,
-                                   string* range_key_start,
-                                   string* range_key_end) {
+                                   vector<tuple<string, string>>* range_bounds) {
   // Find the column indexes of the range columns.
   vector<int32_t> col_idxs;
   col_idxs.reserve(range_columns.size());
@@ -173,12 +179,69 @@ void EncodeRangeKeysFromPredicates(const Schema& schema,
   uint8_t* buf = static_cast<uint8_t*>(CHECK_NOTNULL(arena.AllocateBytes(schema.key_byte_size())));
   ContiguousRow row(&schema, buf);
 
+  // Look for an in-list predicate to split on: it must be on a range column
+  // whose preceding range columns are all equality-constrained.
+  int32_t split_idx = -1;
+  for (int32_t col_idx : col_idxs) {
+    const ColumnPredicate* predicate = FindOrNull(predicates, schema.column(col_idx).name());
+    if (predicate == nullptr ||
+        (predicate->predicate_type() != PredicateType::Equality &&
+         predicate->predicate_type() != PredicateType::InList)) {
+      break;
+    }
+    if (predicate->predicate_type() == PredicateType::InList) {
+      split_idx = col_idx;
+      break;
+    }
+  }
+
+  if (split_idx != -1) {
+    const ColumnSchema& split_column = schema.column(split_idx);
+    const auto& values = FindOrDie(predicates, split_column.name()).raw_values();
+    vector<tuple<string, string>> split_bounds;
+    split_bounds.reserve(values.size());
+    bool valid = true;
+    // The in-list values are sorted, so the resulting ranges are ascending
+    // and disjoint.
+    for (const void* value : values) {
+      unordered_map<string, ColumnPredicate> branch_predicates(predicates);
+      branch_predicates.erase(split_column.name());
+      branch_predicates.emplace(split_column.name(),
+                                ColumnPredicate::Equality(split_column, value));
+      string lower;
+      string upper;
+      if (key_util::PushLowerBoundKeyPredicates(col_idxs, branch_predicates, &row, &arena) > 0) {
+        key_util::EncodeKey(col_idxs, row, &lower);
+      }
+      if (key_util::PushUpperBoundKeyPredicates(col_idxs, branch_predicates, &row, &arena) > 0) {
+        key_util::EncodeKey(col_idxs, row, &upper);
+      }
+      if (upper.empty()) {
+        // The branch's exclusive upper bound isn't representable (the value
+        // can't be incremented); fall back to a single contiguous range.
+        valid = false;
+        break;
+      }
+      split_bounds.emplace_back(move(lower), move(upper));
+    }
+    if (valid) {
+      *range_bounds = move(split_bounds);
+      return;
+    }
+  }
+
+  string range_key_start;
+  string range_key_end;
   if (key_util::PushLowerBoundKeyPredicates(col_idxs, predicates, &row, &arena) > 0) {
-    key_util::EncodeKey(col_idxs, row, range_key_start);
+    key_util::EncodeKey(col_idxs, row, &range_key_start);
   }
 
   if (key_util::PushUpperBoundKeyPredicates(col_idxs, predicates, &row, &arena) > 0) {
-    key_util::EncodeKey(col_idxs, row, range_key_end);
+    key_util::EncodeKey(col_idxs, row, &range_key_end);
+  }
+
+  if (!range_key_start.empty() || !range_key_end.empty()) {
+    range_bounds->emplace_back(move(range_key_start), move(range_key_end));
   }
 }
 } // anonymous namespace
@@ -301,25 +364,48 @@ void PartitionPruner::Init(const Schema& schema,
   //    since it is precisely these highly-hash-partitioned tables which get the
   //    most benefit from pruning.
 
-  // Step 1: Build the range portion of the partition key.
-  string range_lower_bound;
-  string range_upper_bound;
+  // Step 1: Build the range portion(s) of the partition key. An in-list
+  // predicate on the range columns may produce multiple disjoint range
+  // bounds; see EncodeRangeKeysFromPredicates().
+  vector<tuple<string, string>> range_bounds;
   const vector<ColumnId>& range_columns = partition_schema.range_schema_.column_ids;
   if (!range_columns.empty()) {
     if (AreRangeColumnsPrefixOfPrimaryKey(schema, range_columns)) {
-      EncodeRangeKeysFromPrimaryKeyBounds(schema,
-                                          scan_spec,
-                                          range_columns.size(),
-                                          &range_lower_bound,
-                                          &range_upper_bound);
+      // An eligible in-list predicate may split the scan into multiple
+      // disjoint ranges. This is strictly more selective than the single
+      // range derived from the primary key bounds, which collapses an
+      // in-list to its smallest and largest values (in-list predicates
+      // survive scan optimization, so they are visible here).
+      EncodeRangeKeysFromPredicates(schema,
+                                    scan_spec.predicates(),
+                                    range_columns,
+                                    &range_bounds);
+      if (range_bounds.size() <= 1) {
+        // No split occurred; the primary key bounds are at least as tight
+        // as the predicate-derived bounds.
+        range_bounds.clear();
+        string range_lower_bound;
+        string range_upper_bound;
+        EncodeRangeKeysFromPrimaryKeyBounds(schema,
+                                            scan_spec,
+                                            range_columns.size(),
+                                            &range_lower_bound,
+                                            &range_upper_bound);
+        if (!range_lower_bound.empty() || !range_upper_bound.empty()) {
+          range_bounds.emplace_back(move(range_lower_bound), move(range_upper_bound));
+        }
+      }
     } else {
       EncodeRangeKeysFromPredicates(schema,
                                     scan_spec.predicates(),
                                     range_columns,
-                                    &range_lower_bound,
-                                    &range_upper_bound);
+                                    &range_bounds);
     }
   }
+  if (range_bounds.empty()) {
+    // The range component is unconstrained.
+    range_bounds.emplace_back(string(), string());
+  }
 
   // Step 2: Create the hash bucket portion of the partition key.
 
@@ -352,7 +438,9 @@ void PartitionPruner::Init(const Schema& schema,
 
   // The index of the final constrained component in the partition key.
   int constrained_index;
-  if (!range_lower_bound.empty() || !range_upper_bound.empty()) {
+  if (range_bounds.size() > 1 ||
+      !get<0>(range_bounds[0]).empty() ||
+      !get<1>(range_bounds[0]).empty()) {
     // The range component is constrained.
     constrained_index = partition_schema.hash_bucket_schemas_.size();
   } else {
@@ -379,7 +467,8 @@ void PartitionPruner::Init(const Schema& schema,
     // bucket, and the range upper bound is empty. In this case we need to
     // increment the bucket on the upper bound to convert from inclusive to
     // exclusive.
-    bool is_last = hash_idx + 1 == constrained_index && range_upper_bound.empty();
+    bool is_last = hash_idx + 1 == constrained_index &&
+        range_bounds.size() == 1 && get<1>(range_bounds[0]).empty();
 
     vector<tuple<string, string>> new_partition_key_ranges;
     for (const auto& partition_key_range : partition_key_ranges) {
@@ -399,10 +488,21 @@ void PartitionPruner::Init(const Schema& schema,
     partition_key_ranges.swap(new_partition_key_ranges);
   }
 
-  // Step 3: append the (possibly empty) range bounds to the partition key ranges.
-  for (auto& range : partition_key_ranges) {
-    get<0>(range).append(range_lower_bound);
-    get<1>(range).append(range_upper_bound);
+  // Step 3: append the (possibly empty, possibly multiple) range bounds to
+  // the partition key ranges. Since the range bounds are ascending and
+  // disjoint, the result remains sorted.
+  {
+    vector<tuple<string, string>> bounded_partition_key_ranges;
+    bounded_partition_key_ranges.reserve(
+        partition_key_ranges.size() * range_bounds.size());
+    for (const auto& partition_key_range : partition_key_ranges) {
+      for (const auto& range_bound : range_bounds) {
+        bounded_partition_key_ranges.push_back(
+            make_tuple(get<0>(partition_key_range) + get<0>(range_bound),
+                       get<1>(partition_key_range) + get<1>(range_bound)));
+      }
+    }
+    partition_key_ranges.swap(bounded_partition_key_ranges);
   }
 
   // Step 4: remove all partition key ranges past the scan spec's upper bound partition key.
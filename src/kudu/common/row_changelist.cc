@@ -252,10 +252,15 @@ Status RowChangeListDecoder::MutateRowAndCaptureChanges(RowBlockRow* dst_row,
 Status RowChangeListDecoder::ApplyToOneColumn(size_t row_idx, ColumnBlock* dst_col,
                                               const Schema& dst_schema,
                                               int col_idx, Arena *arena) {
-  DCHECK(is_reinsert() || is_update());
+  return ApplyToOneColumn(row_idx, dst_col,
+                          dst_schema.column(col_idx), dst_schema.column_id(col_idx),
+                          arena);
+}
 
-  const ColumnSchema& col_schema = dst_schema.column(col_idx);
-  ColumnId col_id = dst_schema.column_id(col_idx);
+Status RowChangeListDecoder::ApplyToOneColumn(size_t row_idx, ColumnBlock* dst_col,
+                                              const ColumnSchema& col_schema,
+                                              ColumnId col_id, Arena *arena) {
+  DCHECK(is_reinsert() || is_update());
 
   while (HasNext()) {
     DecodedUpdate dec;
@@ -264,10 +269,8 @@ Status RowChangeListDecoder::ApplyToOneColumn(size_t row_idx, ColumnBlock* dst_c
       continue;
     }
 
-    int junk_col_idx;
     const void* new_val;
-    RETURN_NOT_OK(dec.Validate(dst_schema, &junk_col_idx, &new_val));
-    DCHECK_EQ(junk_col_idx, col_idx);
+    RETURN_NOT_OK(dec.ValidateForColumn(col_schema, &new_val));
 
     SimpleConstCell src(&col_schema, new_val);
     ColumnBlock::Cell dst_cell = dst_col->cell(row_idx);
@@ -344,8 +347,11 @@ Status RowChangeListDecoder::DecodedUpdate::Validate(const Schema& schema,
   }
 
   // It's a valid column - validate it.
-  const ColumnSchema& col = schema.column(*col_idx);
+  return ValidateForColumn(schema.column(*col_idx), value);
+}
 
+Status RowChangeListDecoder::DecodedUpdate::ValidateForColumn(const ColumnSchema& col,
+                                                              const void** value) const {
   if (null) {
     if (!col.is_nullable()) {
       return Status::Corruption("decoded set-to-NULL for non-nullable column",
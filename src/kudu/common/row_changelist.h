@@ -273,10 +273,24 @@ class RowChangeListDecoder {
       type_(RowChangeList::kUninitialized) {
   }
 
+  // Construct a decoder with no source, for use as reusable decode scratch.
+  // Reset() must be called before the decoder can be used.
+  RowChangeListDecoder()
+    : type_(RowChangeList::kUninitialized) {
+  }
+
   // Initialize the decoder. This will return an invalid Status if the RowChangeList
   // appears to be corrupt/malformed.
   Status Init();
 
+  // Reset the decoder to decode 'src'. This allows a single decoder instance
+  // to be reused across many mutations in a hot loop. Init() (or
+  // InitNoSafetyChecks()) must be called again before decoding.
+  void Reset(const RowChangeList& src) {
+    remaining_ = src.slice();
+    type_ = RowChangeList::kUninitialized;
+  }
+
   // Like Init() above, but does not perform any safety checks in a release build.
   // This can be used when it's known that the source of the RowChangeList is
   // guaranteed to be non-corrupt (e.g. we created it and have kept it in memory).
@@ -343,6 +357,13 @@ class RowChangeListDecoder {
   Status ApplyToOneColumn(size_t row_idx, ColumnBlock* dst_col,
                           const Schema& dst_schema, int col_idx, Arena *arena);
 
+  // As above, but with the target column's schema and ID already resolved.
+  // Callers applying many mutations to the same column should prefer this
+  // overload, which avoids a per-mutation column lookup in the schema.
+  Status ApplyToOneColumn(size_t row_idx, ColumnBlock* dst_col,
+                          const ColumnSchema& col_schema, ColumnId col_id,
+                          Arena *arena);
+
   // If this changelist is a DELETE or REINSERT, twiddle '*deleted' to reference
   // the new state of the row. If it is an UPDATE, this call has no effect.
   //
@@ -406,6 +427,11 @@ class RowChangeListDecoder {
     Status Validate(const Schema& s,
                     int* col_idx,
                     const void** valid_value) const;
+
+    // Validate the decoded update against an already-resolved column,
+    // avoiding the schema lookup performed by Validate() above.
+    Status ValidateForColumn(const ColumnSchema& col,
+                             const void** valid_value) const;
   };
 
   // Decode the next updated column into '*update'.
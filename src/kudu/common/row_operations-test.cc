@@ -503,6 +503,52 @@ TEST_F(RowOperationsTest, ProjectionTestWithClientHavingValidSubset) {
   }
 }
 
+// Test that decoding with a previously-validated column mapping produces the
+// same result as a full validating decode.
+TEST_F(RowOperationsTest, TestDecodeWithCachedMapping) {
+  int32_t nullable_default = 123;
+  SchemaBuilder b;
+  CHECK_OK(b.AddKeyColumn("key", INT32));
+  CHECK_OK(b.AddColumn("int_val", INT32));
+  CHECK_OK(b.AddColumn("new_int_with_default", INT32, false,
+                       &nullable_default, &nullable_default));
+  Schema server_schema = b.Build();
+
+  Schema client_schema({ ColumnSchema("key", INT32),
+                         ColumnSchema("int_val", INT32) },
+                       1);
+
+  KuduPartialRow client_row(&client_schema);
+  CHECK_OK(client_row.SetInt32("key", 12345));
+  CHECK_OK(client_row.SetInt32("int_val", 54321));
+  RowOperationsPB pb;
+  RowOperationsPBEncoder enc(&pb);
+  enc.Add(RowOperationsPB::INSERT, client_row);
+
+  // Decode with full validation, capturing the column mapping.
+  Arena arena(1024);
+  vector<DecodedRowOperation> ops;
+  vector<int> mapping;
+  {
+    RowOperationsPBDecoder dec(&pb, &client_schema, &server_schema, &arena);
+    ASSERT_OK(dec.DecodeOperations(&ops, &mapping));
+  }
+  ASSERT_EQ(1, ops.size());
+  ASSERT_EQ(2, mapping.size());
+
+  // Decode again reusing the mapping, and verify the result is identical.
+  vector<DecodedRowOperation> ops2;
+  {
+    RowOperationsPBDecoder dec(&pb, &client_schema, &server_schema, &arena);
+    ASSERT_OK(dec.DecodeOperationsWithMapping(mapping, &ops2));
+  }
+  ASSERT_EQ(1, ops2.size());
+  EXPECT_EQ(ops[0].ToString(server_schema), ops2[0].ToString(server_schema));
+  EXPECT_EQ("INSERT (int32 key=12345, int32 int_val=54321,"
+            " int32 new_int_with_default=123)",
+            ops2[0].ToString(server_schema));
+}
+
 // Test cases where the client is missing a column which is non-null
 // and has no default. This is an incompatible client.
 TEST_F(RowOperationsTest, ProjectionTestWithClientHavingInvalidSubset) {
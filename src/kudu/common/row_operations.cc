@@ -20,6 +20,7 @@
 #include <cstring>
 #include <ostream>
 #include <string>
+#include <utility>
 
 #include <glog/logging.h>
 
@@ -199,7 +200,9 @@ Status RowOperationsPBDecoder::GetColumnSlice(const ColumnSchema& col, Slice* sl
   // Find the data
   if (col.type_info()->physical_type() == BINARY) {
     // The Slice in the protobuf has a pointer relative to the indirect data,
-    // not a real pointer. Need to fix that.
+    // not a real pointer. Need to fix that. The returned Slice aliases the
+    // protobuf's indirect data rather than copying it into the arena; see
+    // the lifetime note on RowOperationsPBDecoder.
     const Slice* ptr_slice = reinterpret_cast<const Slice*>(src_.data());
     size_t offset_in_indirect = reinterpret_cast<uintptr_t>(ptr_slice->data());
     bool overflowed = false;
@@ -265,6 +268,21 @@ class ClientServerMapping {
       saw_tablet_col_(tablet_schema->num_columns()) {
   }
 
+  // Construct from a mapping previously built (and validated) by
+  // GetProjectionMapping() against equal schemas, skipping re-validation.
+  ClientServerMapping(const Schema* client_schema,
+                      const Schema* tablet_schema,
+                      vector<int> client_to_tablet)
+    : client_schema_(client_schema),
+      tablet_schema_(tablet_schema),
+      client_to_tablet_(std::move(client_to_tablet)),
+      saw_tablet_col_(tablet_schema->num_columns()) {
+    for (int tablet_idx : client_to_tablet_) {
+      DCHECK_LT(tablet_idx, saw_tablet_col_.size());
+      saw_tablet_col_[tablet_idx] = 1;
+    }
+  }
+
   Status ProjectBaseColumn(size_t client_col_idx, size_t tablet_col_idx) {
     // We should get this called exactly once for every input column,
     // since the input columns must be a strict subset of the tablet columns.
@@ -297,6 +315,10 @@ class ClientServerMapping {
     return client_to_tablet_.size();
   }
 
+  const vector<int>& client_to_tablet() const {
+    return client_to_tablet_;
+  }
+
   // Ensure that any required (non-null, non-defaulted) columns from the
   // server side schema are found in the client-side schema. If not,
   // returns an InvalidArgument.
@@ -557,7 +579,8 @@ Status RowOperationsPBDecoder::DecodeSplitRow(const ClientServerMapping& mapping
   return Status::OK();
 }
 
-Status RowOperationsPBDecoder::DecodeOperations(vector<DecodedRowOperation>* ops) {
+Status RowOperationsPBDecoder::DecodeOperations(vector<DecodedRowOperation>* ops,
+                                                vector<int>* client_to_tablet_mapping) {
   // TODO: there's a bug here, in that if a client passes some column
   // in its schema that has been deleted on the server, it will fail
   // even if the client never actually specified any values for it.
@@ -572,7 +595,24 @@ Status RowOperationsPBDecoder::DecodeOperations(vector<DecodedRowOperation>* ops
   RETURN_NOT_OK(client_schema_->GetProjectionMapping(*tablet_schema_, &mapping));
   DCHECK_EQ(mapping.num_mapped(), client_schema_->num_columns());
   RETURN_NOT_OK(mapping.CheckAllRequiredColumnsPresent());
+  if (client_to_tablet_mapping != nullptr) {
+    *client_to_tablet_mapping = mapping.client_to_tablet();
+  }
+  return DecodeOps(mapping, ops);
+}
+
+Status RowOperationsPBDecoder::DecodeOperationsWithMapping(
+    const vector<int>& client_to_tablet_mapping,
+    vector<DecodedRowOperation>* ops) {
+  CHECK(!client_schema_->has_column_ids());
+  DCHECK(tablet_schema_->has_column_ids());
+  DCHECK_EQ(client_to_tablet_mapping.size(), client_schema_->num_columns());
+  ClientServerMapping mapping(client_schema_, tablet_schema_, client_to_tablet_mapping);
+  return DecodeOps(mapping, ops);
+}
 
+Status RowOperationsPBDecoder::DecodeOps(const ClientServerMapping& mapping,
+                                         vector<DecodedRowOperation>* ops) {
   // Make a "prototype row" which has all the defaults filled in. We can copy
   // this to create a starting point for each row as we decode it, with
   // all the defaults in place without having to loop.
@@ -56,6 +56,10 @@ struct DecodedRowOperation {
 
   // For INSERT or UPSERT, the whole projected row.
   // For UPDATE or DELETE, the row key.
+  //
+  // NOTE: for columns with indirect (BINARY) data, the stored Slices point
+  // back into the RowOperationsPB that was decoded, not into the decoder's
+  // arena. See the note on RowOperationsPBDecoder.
   const uint8_t* row_data;
 
   // For INSERT or UPDATE, a bitmap indicating which of the cells were
@@ -73,6 +77,16 @@ struct DecodedRowOperation {
   std::string ToString(const Schema& schema) const;
 };
 
+// Decodes the row operations documented in the comment for RowOperationsPB,
+// projecting them into rows with the tablet's schema.
+//
+// NOTE: the decoder borrows rather than copies indirect (BINARY) cell data:
+// the decoded operations contain Slices which alias 'pb'->indirect_data()
+// directly, and only fixed-size row data is copied into 'dst_arena'. The
+// caller must therefore keep 'pb' (in practice, the WriteRequestPB owned by
+// the inbound RPC or by the consensus replicate message) alive and unmodified
+// until the decoded operations have been applied, at which point the memory
+// stores make their own copies of any data they retain.
 class RowOperationsPBDecoder {
  public:
   RowOperationsPBDecoder(const RowOperationsPB* pb,
@@ -81,7 +95,20 @@ class RowOperationsPBDecoder {
                          Arena* dst_arena);
   ~RowOperationsPBDecoder();
 
-  Status DecodeOperations(std::vector<DecodedRowOperation>* ops);
+  // Validate the client schema against the tablet schema and decode the
+  // operations. If 'client_to_tablet_mapping' is non-NULL, it is filled in
+  // with the validated column index mapping (element i is the tablet schema
+  // index of client column i), which may then be passed to
+  // DecodeOperationsWithMapping() by decoders constructed with equal
+  // schemas.
+  Status DecodeOperations(std::vector<DecodedRowOperation>* ops,
+                          std::vector<int>* client_to_tablet_mapping = nullptr);
+
+  // Like DecodeOperations(), but uses a column index mapping previously
+  // returned by it instead of re-validating the client schema. The mapping
+  // must have been computed for schemas equal to this decoder's.
+  Status DecodeOperationsWithMapping(const std::vector<int>& client_to_tablet_mapping,
+                                     std::vector<DecodedRowOperation>* ops);
 
  private:
   Status ReadOpType(RowOperationsPB::Type* type);
@@ -106,6 +133,10 @@ class RowOperationsPBDecoder {
   Status DecodeSplitRow(const ClientServerMapping& mapping,
                         DecodedRowOperation* op);
 
+  // Decode all of the operations using the given validated mapping.
+  Status DecodeOps(const ClientServerMapping& mapping,
+                   std::vector<DecodedRowOperation>* ops);
+
   const RowOperationsPB* const pb_;
   const Schema* const client_schema_;
   const Schema* const tablet_schema_;
@@ -0,0 +1,113 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/common/rowblock.h"
+
+#include <gtest/gtest.h>
+
+#include "kudu/util/random.h"
+#include "kudu/util/test_util.h"
+
+namespace kudu {
+
+class SelectionVectorTest : public KuduTest {};
+
+// Verify CountSelected() and AnySelected() against a bit-at-a-time
+// reference count, across sizes which exercise the 64-byte chunked path,
+// the word-at-a-time path, and the byte tail.
+TEST_F(SelectionVectorTest, TestCountAndAnySelected) {
+  Random rng(SeedRandom());
+  for (size_t n_rows : { 1, 7, 8, 9, 63, 64, 65, 512, 517, 1024, 5000 }) {
+    SelectionVector sv(n_rows);
+    sv.SetAllFalse();
+    ASSERT_EQ(0, sv.CountSelected());
+    ASSERT_FALSE(sv.AnySelected());
+
+    size_t expected = 0;
+    for (size_t i = 0; i < n_rows; i++) {
+      if (rng.OneIn(3)) {
+        sv.SetRowSelected(i);
+        expected++;
+      }
+    }
+    ASSERT_EQ(expected, sv.CountSelected());
+    ASSERT_EQ(expected > 0, sv.AnySelected());
+
+    sv.SetAllTrue();
+    ASSERT_EQ(n_rows, sv.CountSelected());
+    ASSERT_TRUE(sv.AnySelected());
+  }
+}
+
+TEST_F(SelectionVectorTest, TestAndWithOrWith) {
+  Random rng(SeedRandom());
+  for (size_t n_rows : { 1, 8, 100, 1000 }) {
+    SelectionVector a(n_rows);
+    SelectionVector b(n_rows);
+    a.SetAllFalse();
+    b.SetAllFalse();
+    for (size_t i = 0; i < n_rows; i++) {
+      if (rng.OneIn(2)) a.SetRowSelected(i);
+      if (rng.OneIn(2)) b.SetRowSelected(i);
+    }
+
+    SelectionVector intersection(n_rows);
+    intersection.SetAllFalse();
+    SelectionVector sum(n_rows);
+    sum.SetAllFalse();
+    size_t expected_intersection = 0;
+    size_t expected_sum = 0;
+    for (size_t i = 0; i < n_rows; i++) {
+      if (a.IsRowSelected(i) && b.IsRowSelected(i)) {
+        intersection.SetRowSelected(i);
+        expected_intersection++;
+      }
+      if (a.IsRowSelected(i) || b.IsRowSelected(i)) {
+        sum.SetRowSelected(i);
+        expected_sum++;
+      }
+    }
+
+    SelectionVector anded(n_rows);
+    anded.SetAllFalse();
+    anded.OrWith(a);
+    anded.AndWith(b);
+    ASSERT_EQ(expected_intersection, anded.CountSelected());
+    for (size_t i = 0; i < n_rows; i++) {
+      ASSERT_EQ(intersection.IsRowSelected(i), anded.IsRowSelected(i));
+    }
+
+    SelectionVector ored(n_rows);
+    ored.SetAllFalse();
+    ored.OrWith(a);
+    ored.OrWith(b);
+    ASSERT_EQ(expected_sum, ored.CountSelected());
+    for (size_t i = 0; i < n_rows; i++) {
+      ASSERT_EQ(sum.IsRowSelected(i), ored.IsRowSelected(i));
+    }
+
+    // OR-ing may not select rows past the end of the vector: the trailer
+    // bits of the last byte must stay zero so that CountSelected() remains
+    // correct.
+    SelectionVector all(n_rows);
+    all.SetAllTrue();
+    ored.OrWith(all);
+    ASSERT_EQ(n_rows, ored.CountSelected());
+  }
+}
+
+} // namespace kudu
@@ -19,10 +19,66 @@
 #include <glog/logging.h>
 
 #include "kudu/gutil/bits.h"
+#include "kudu/gutil/cpu.h"
+#include "kudu/gutil/port.h"
 #include "kudu/util/bitmap.h"
 
 namespace kudu {
 
+namespace {
+
+enum class BitmapOp {
+  AND,
+  OR,
+};
+
+// Combine 'n_bytes' bytes of 'src' into 'dst' with the given operation.
+// Written as a simple byte loop so that, when compiled for a wide target
+// below, the compiler vectorizes it to the widest instructions available.
+template <BitmapOp OP>
+ATTRIBUTE_ALWAYS_INLINE
+inline void ApplyBitmapOp(uint8_t* __restrict__ dst,
+                          const uint8_t* __restrict__ src,
+                          size_t n_bytes) {
+  for (size_t i = 0; i < n_bytes; i++) {
+    if (OP == BitmapOp::AND) {
+      dst[i] &= src[i];
+    } else {
+      dst[i] |= src[i];
+    }
+  }
+}
+
+template <BitmapOp OP>
+void ApplyBitmapOpScalar(uint8_t* dst, const uint8_t* src, size_t n_bytes) {
+  ApplyBitmapOp<OP>(dst, src, n_bytes);
+}
+
+#if defined(__x86_64__) && !defined(__APPLE__)
+template <BitmapOp OP>
+__attribute__((target("avx2")))
+void ApplyBitmapOpAvx2(uint8_t* dst, const uint8_t* src, size_t n_bytes) {
+  ApplyBitmapOp<OP>(dst, src, n_bytes);
+}
+#endif
+
+typedef void (*BitmapOpFn)(uint8_t*, const uint8_t*, size_t);
+
+// Pick the widest bitmap-combining kernel supported by the runtime CPU,
+// latched in a function-local static so the CPU check runs only once.
+template <BitmapOp OP>
+BitmapOpFn ChooseBitmapOpFn() {
+#if defined(__x86_64__) && !defined(__APPLE__)
+  static const BitmapOpFn fn =
+      base::CPU().has_avx2() ? &ApplyBitmapOpAvx2<OP> : &ApplyBitmapOpScalar<OP>;
+  return fn;
+#else
+  return &ApplyBitmapOpScalar<OP>;
+#endif
+}
+
+} // anonymous namespace
+
 SelectionVector::SelectionVector(size_t row_capacity)
   : bytes_capacity_(BitmapSize(row_capacity)),
     n_rows_(row_capacity),
@@ -45,33 +101,72 @@ void SelectionVector::Resize(size_t n_rows) {
 }
 
 size_t SelectionVector::CountSelected() const {
-  return Bits::Count(&bitmap_[0], n_bytes_);
+  // Count eight bytes at a time with the POPCNT instruction; every CPU which
+  // satisfies the SSE4.2 baseline of the build also supports it. The 64-byte
+  // chunks use independent accumulators so the popcounts can overlap instead
+  // of serializing on a single sum.
+  const uint8_t *p = &bitmap_[0];
+  size_t rem = n_bytes_;
+  size_t c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+  while (rem >= 64) {
+    c0 += Bits::CountOnes64withPopcount(UNALIGNED_LOAD64(p));
+    c1 += Bits::CountOnes64withPopcount(UNALIGNED_LOAD64(p + 8));
+    c2 += Bits::CountOnes64withPopcount(UNALIGNED_LOAD64(p + 16));
+    c3 += Bits::CountOnes64withPopcount(UNALIGNED_LOAD64(p + 24));
+    c0 += Bits::CountOnes64withPopcount(UNALIGNED_LOAD64(p + 32));
+    c1 += Bits::CountOnes64withPopcount(UNALIGNED_LOAD64(p + 40));
+    c2 += Bits::CountOnes64withPopcount(UNALIGNED_LOAD64(p + 48));
+    c3 += Bits::CountOnes64withPopcount(UNALIGNED_LOAD64(p + 56));
+    p += 64;
+    rem -= 64;
+  }
+  size_t count = c0 + c1 + c2 + c3;
+  while (rem >= 8) {
+    count += Bits::CountOnes64withPopcount(UNALIGNED_LOAD64(p));
+    p += 8;
+    rem -= 8;
+  }
+  if (rem > 0) {
+    count += Bits::Count(p, rem);
+  }
+  return count;
 }
 
 bool SelectionVector::AnySelected() const {
+  const uint8_t *p = &bitmap_[0];
   size_t rem = n_bytes_;
-  const uint32_t *p32 = reinterpret_cast<const uint32_t *>(
-    &bitmap_[0]);
-  while (rem >= 4) {
-    if (*p32 != 0) {
+  while (rem >= 8) {
+    if (UNALIGNED_LOAD64(p) != 0) {
       return true;
     }
-    p32++;
-    rem -= 4;
+    p += 8;
+    rem -= 8;
   }
 
-  const uint8_t *p8 = reinterpret_cast<const uint8_t *>(p32);
   while (rem > 0) {
-    if (*p8 != 0) {
+    if (*p != 0) {
       return true;
     }
-    p8++;
+    p++;
     rem--;
   }
 
   return false;
 }
 
+void SelectionVector::AndWith(const SelectionVector& other) {
+  DCHECK_EQ(n_rows_, other.n_rows_);
+  ChooseBitmapOpFn<BitmapOp::AND>()(&bitmap_[0], &other.bitmap_[0], n_bytes_);
+}
+
+void SelectionVector::OrWith(const SelectionVector& other) {
+  // Any bits in the last byte beyond n_rows_ are zero in both vectors
+  // (Resize() and SetAllTrue() maintain that invariant), so OR-ing whole
+  // bytes cannot select out-of-range rows.
+  DCHECK_EQ(n_rows_, other.n_rows_);
+  ChooseBitmapOpFn<BitmapOp::OR>()(&bitmap_[0], &other.bitmap_[0], n_bytes_);
+}
+
 //////////////////////////////
 // RowBlock
 //////////////////////////////
@@ -70,6 +70,14 @@ class SelectionVector {
   // This is equivalent to (CountSelected() > 0), but faster.
   bool AnySelected() const;
 
+  // Intersect this vector with 'other', deselecting any rows which are not
+  // selected in both. The two vectors must have the same number of rows.
+  void AndWith(const SelectionVector& other);
+
+  // Union this vector with 'other', selecting any rows which are selected
+  // in either. The two vectors must have the same number of rows.
+  void OrWith(const SelectionVector& other);
+
   bool IsRowSelected(size_t row) const {
     DCHECK_LT(row, n_rows_);
     return BitmapTest(&bitmap_[0], row);
@@ -24,12 +24,14 @@
 #include <unordered_map>
 #include <vector>
 
+#include <gflags/gflags.h>
 #include <glog/logging.h> // IWYU pragma: keep
 #include <gtest/gtest.h>
 
 #include "kudu/common/common.pb.h"
 #include "kudu/common/key_encoder.h"
 #include "kudu/common/row.h"
+#include "kudu/common/schema_intern.h"
 #include "kudu/common/types.h"
 #include "kudu/gutil/strings/stringpiece.h"
 #include "kudu/gutil/strings/substitute.h"
@@ -42,9 +44,12 @@
 #include "kudu/util/test_macros.h"
 #include "kudu/util/test_util.h"
 
+DECLARE_int32(schema_intern_table_max_entries);
+
 namespace kudu {
 namespace tablet {
 
+using std::shared_ptr;
 using std::string;
 using std::unordered_map;
 using std::vector;
@@ -327,6 +332,12 @@ TEST_F(TestSchema, TestRowOperations) {
 
   ASSERT_EQ(R"((string col1="row_a_1", string col2="row_a_2", uint32 col3=3, int32 col4=-3))",
             schema.DebugRow(row_a));
+
+  // The relocated indirect data for a row is packed into a single contiguous
+  // arena chunk, so the second string should directly follow the first.
+  const Slice* a_col1 = reinterpret_cast<const Slice*>(row_a.cell_ptr(0));
+  const Slice* a_col2 = reinterpret_cast<const Slice*>(row_a.cell_ptr(1));
+  ASSERT_EQ(a_col1->data() + a_col1->size(), a_col2->data());
 }
 
 TEST(TestKeyEncoder, TestKeyEncoder) {
@@ -456,6 +467,65 @@ TEST_F(TestSchema, TestCreateProjection) {
             partial_schema.ToString());
 }
 
+TEST_F(TestSchema, TestSchemaIntern) {
+  SchemaInternTable* intern = SchemaInternTable::GetInstance();
+
+  Schema schema({ ColumnSchema("col1", STRING),
+                  ColumnSchema("col2", STRING),
+                  ColumnSchema("col3", UINT32) },
+                1);
+
+  // Identical schemas intern to the same handle.
+  shared_ptr<const Schema> h1 = intern->Intern(schema);
+  shared_ptr<const Schema> h2 = intern->Intern(Schema(schema));
+  ASSERT_EQ(h1.get(), h2.get());
+  ASSERT_TRUE(h1->Equals(schema));
+
+  // A schema which differs only by having column IDs gets its own handle.
+  Schema with_ids = schema.CopyWithColumnIds();
+  shared_ptr<const Schema> h3 = intern->Intern(with_ids);
+  ASSERT_NE(h1.get(), h3.get());
+  ASSERT_TRUE(h3->has_column_ids());
+
+  // The mapped read projection is computed once per pair of handles and
+  // then shared.
+  Schema projection({ ColumnSchema("col1", STRING) }, 0);
+  shared_ptr<const Schema> proj = intern->Intern(projection);
+  shared_ptr<const Schema> mapped1;
+  ASSERT_OK(intern->GetMappedReadProjection(h3, proj, &mapped1));
+  shared_ptr<const Schema> mapped2;
+  ASSERT_OK(intern->GetMappedReadProjection(h3, proj, &mapped2));
+  ASSERT_EQ(mapped1.get(), mapped2.get());
+
+  // The cached mapping matches what GetMappedReadProjection() computes
+  // directly.
+  Schema expected;
+  ASSERT_OK(with_ids.GetMappedReadProjection(projection, &expected));
+  ASSERT_TRUE(mapped1->Equals(expected));
+  ASSERT_TRUE(mapped1->has_column_ids());
+}
+
+TEST_F(TestSchema, TestSchemaInternTableBounded) {
+  google::FlagSaver saver;
+  FLAGS_schema_intern_table_max_entries = 4;
+  SchemaInternTable* intern = SchemaInternTable::GetInstance();
+
+  // Interning many distinct schemas (e.g. arbitrary client projections)
+  // must not grow the table without bound.
+  shared_ptr<const Schema> last;
+  for (int i = 0; i < 100; i++) {
+    Schema schema({ ColumnSchema(Substitute("col$0", i), STRING) }, 1);
+    last = intern->Intern(schema);
+    ASSERT_LE(intern->num_interned(), 4);
+  }
+
+  // Handles handed out before a purge remain valid.
+  ASSERT_EQ("col99", last->column(0).name());
+  shared_ptr<const Schema> again =
+      intern->Intern(Schema({ ColumnSchema("col99", STRING) }, 1));
+  ASSERT_TRUE(again->Equals(*last));
+}
+
 #ifdef NDEBUG
 TEST(TestKeyEncoder, BenchmarkSimpleKey) {
   faststring fs;
@@ -0,0 +1,161 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#include "kudu/common/schema_intern.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include <gflags/gflags.h>
+
+#include "kudu/common/schema.h"
+#include "kudu/gutil/hash/hash.h"
+#include "kudu/gutil/singleton.h"
+#include "kudu/util/flag_tags.h"
+#include "kudu/util/logging.h"
+
+DEFINE_int32(schema_intern_table_max_entries, 1024,
+             "Maximum number of schemas retained in the process-wide schema "
+             "intern table (and, separately, in its mapped read projection "
+             "cache). When the limit is exceeded the table is emptied and "
+             "re-fills with the schemas in active use. This bounds the "
+             "memory retained when clients send many distinct scan "
+             "projections.");
+TAG_FLAG(schema_intern_table_max_entries, advanced);
+TAG_FLAG(schema_intern_table_max_entries, runtime);
+
+using std::shared_ptr;
+
+namespace kudu {
+
+namespace {
+
+// Hash the full contents of 'schema': column names, types, nullability and
+// column IDs. Defaults and storage attributes are deliberately left out of
+// the hash (they rarely differ between otherwise-identical schemas); the
+// equality check below still compares them via ColumnSchema::Equals().
+size_t HashSchema(const Schema& schema) {
+  uint64 h = Hash64NumWithSeed(schema.num_key_columns(), schema.num_columns());
+  for (size_t i = 0; i < schema.num_columns(); i++) {
+    const ColumnSchema& col = schema.column(i);
+    h = Hash64StringWithSeed(col.name(), h);
+    h = Hash64NumWithSeed(col.type_info()->type(), h);
+    h = Hash64NumWithSeed(col.is_nullable(), h);
+    if (schema.has_column_ids()) {
+      h = Hash64NumWithSeed(schema.column_id(i), h);
+    }
+  }
+  return h;
+}
+
+// Full-contents equality for interning purposes: Schema::Equals() (which
+// includes per-column defaults and attributes) plus column ID identity,
+// which Equals() ignores.
+bool SchemasIdentical(const Schema& a, const Schema& b) {
+  if (a.has_column_ids() != b.has_column_ids()) return false;
+  if (!a.Equals(b)) return false;
+  if (a.has_column_ids()) {
+    for (size_t i = 0; i < a.num_columns(); i++) {
+      if (a.column_id(i) != b.column_id(i)) return false;
+    }
+  }
+  return true;
+}
+
+} // anonymous namespace
+
+size_t SchemaInternTable::SchemaPairHash::operator()(const SchemaPair& p) const {
+  return Hash64NumWithSeed(reinterpret_cast<uintptr_t>(p.first.get()),
+                           reinterpret_cast<uintptr_t>(p.second.get()));
+}
+
+SchemaInternTable* SchemaInternTable::GetInstance() {
+  return Singleton<SchemaInternTable>::get();
+}
+
+shared_ptr<const Schema> SchemaInternTable::Intern(const Schema& schema) {
+  size_t h = HashSchema(schema);
+  {
+    shared_lock<rw_spinlock> l(lock_);
+    for (auto it = schemas_.find(h); it != schemas_.end() && it->first == h; ++it) {
+      if (SchemasIdentical(*it->second, schema)) {
+        return it->second;
+      }
+    }
+  }
+
+  shared_ptr<const Schema> entry = std::make_shared<Schema>(schema);
+  std::lock_guard<rw_spinlock> l(lock_);
+  // Another thread may have interned an identical schema in the meantime;
+  // re-check so all callers converge on the same handle.
+  for (auto it = schemas_.find(h); it != schemas_.end() && it->first == h; ++it) {
+    if (SchemasIdentical(*it->second, schema)) {
+      return it->second;
+    }
+  }
+  // Bound the table: clients can send arbitrarily many distinct scan
+  // projections, and without a limit each would be retained forever.
+  // Emptying the whole table is crude but safe -- handles held by callers
+  // stay valid, and the schemas in active use are promptly re-interned.
+  if (schemas_.size() >= static_cast<size_t>(FLAGS_schema_intern_table_max_entries)) {
+    KLOG_EVERY_N_SECS(WARNING, 60)
+        << "Purging schema intern table (" << schemas_.size() << " entries); "
+        << "consider raising --schema_intern_table_max_entries if this "
+        << "happens frequently";
+    schemas_.clear();
+    mapped_projections_.clear();
+  }
+  schemas_.emplace(h, entry);
+  return entry;
+}
+
+Status SchemaInternTable::GetMappedReadProjection(
+    const shared_ptr<const Schema>& base,
+    const shared_ptr<const Schema>& projection,
+    shared_ptr<const Schema>* mapped) {
+  SchemaPair key(base, projection);
+  {
+    shared_lock<rw_spinlock> l(lock_);
+    auto it = mapped_projections_.find(key);
+    if (it != mapped_projections_.end()) {
+      *mapped = it->second;
+      return Status::OK();
+    }
+  }
+
+  Schema mapped_schema;
+  RETURN_NOT_OK(base->GetMappedReadProjection(*projection, &mapped_schema));
+  shared_ptr<const Schema> entry = Intern(mapped_schema);
+
+  std::lock_guard<rw_spinlock> l(lock_);
+  // Bound the cache the same way as the intern table; see Intern().
+  if (mapped_projections_.size() >=
+      static_cast<size_t>(FLAGS_schema_intern_table_max_entries)) {
+    mapped_projections_.clear();
+  }
+  auto it = mapped_projections_.emplace(std::move(key), entry).first;
+  *mapped = it->second;
+  return Status::OK();
+}
+
+size_t SchemaInternTable::num_interned() const {
+  shared_lock<rw_spinlock> l(lock_);
+  return schemas_.size();
+}
+
+} // namespace kudu
@@ -0,0 +1,109 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#ifndef KUDU_COMMON_SCHEMA_INTERN_H
+#define KUDU_COMMON_SCHEMA_INTERN_H
+
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+#include "kudu/gutil/macros.h"
+#include "kudu/util/locks.h"
+#include "kudu/util/status.h"
+
+template <typename T> class Singleton;
+
+namespace kudu {
+
+class Schema;
+
+// A process-wide intern table for Schema objects.
+//
+// Schema is a fairly heavyweight value type: copying one duplicates the
+// column vector, the name-to-index map, and the ID mapping, which shows up
+// in profiles of scan setup and RPC decoding. Interning a schema yields an
+// immutable shared handle, so that repeated setups of the same scan share a
+// single Schema instance instead of each making a copy, and so that derived
+// schemas (currently the mapped read projection computed for every new
+// iterator) can be computed once and cached.
+//
+// Two schemas intern to the same handle only if they are fully identical:
+// same columns (including defaults and storage attributes) and same column
+// IDs (or both lacking IDs). This is stricter than Schema::Equals(), which
+// ignores IDs; conflating a schema with its ID-less counterpart would break
+// callers which dispatch on has_column_ids().
+//
+// The table holds strong references to interned schemas, but its size is
+// bounded: client-supplied scan projections are interned too, so arbitrary
+// distinct projections from untrusted clients must not grow the table
+// without limit. When the number of entries exceeds
+// --schema_intern_table_max_entries, the table is emptied and re-fills with
+// the schemas in active use; handles held by callers remain valid across
+// the purge, they just no longer converge on a shared instance until
+// re-interned. In the expected steady state (a handful of schemas per
+// table) the limit is never reached.
+//
+// This class is thread-safe.
+class SchemaInternTable {
+ public:
+  static SchemaInternTable* GetInstance();
+
+  // Return a shared immutable handle equal to 'schema', inserting a copy
+  // into the table if no identical schema has been interned yet.
+  std::shared_ptr<const Schema> Intern(const Schema& schema);
+
+  // Equivalent to base->GetMappedReadProjection(*projection, ...), but the
+  // result is computed at most once per (base, projection) pair of interned
+  // handles and shared thereafter.
+  Status GetMappedReadProjection(const std::shared_ptr<const Schema>& base,
+                                 const std::shared_ptr<const Schema>& projection,
+                                 std::shared_ptr<const Schema>* mapped);
+
+  // Return the number of distinct schemas currently interned. Exposed for
+  // tests.
+  size_t num_interned() const;
+
+ private:
+  friend class Singleton<SchemaInternTable>;
+  SchemaInternTable() = default;
+
+  typedef std::pair<std::shared_ptr<const Schema>,
+                    std::shared_ptr<const Schema>> SchemaPair;
+  struct SchemaPairHash {
+    size_t operator()(const SchemaPair& p) const;
+  };
+
+  mutable rw_spinlock lock_;
+
+  // Interned schemas, keyed by a hash of their full contents. A multimap
+  // handles the (rare) case of hash collisions between distinct schemas.
+  std::unordered_multimap<size_t, std::shared_ptr<const Schema>> schemas_;
+
+  // Cached mapped read projections, keyed by the identity of the interned
+  // (base, projection) handles. The keys hold strong references so that the
+  // keyed-on schemas can't be freed (and their addresses reused) while an
+  // entry refers to them, even after 'schemas_' has been purged.
+  std::unordered_map<SchemaPair, std::shared_ptr<const Schema>,
+                     SchemaPairHash> mapped_projections_;
+
+  DISALLOW_COPY_AND_ASSIGN(SchemaInternTable);
+};
+
+} // namespace kudu
+
+#endif
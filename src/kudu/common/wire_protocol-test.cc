@@ -31,7 +31,10 @@
 #include "kudu/common/schema.h"
 #include "kudu/common/wire_protocol.h"
 #include "kudu/common/wire_protocol.pb.h"
+#include "kudu/gutil/strings/substitute.h"
 #include "kudu/util/bitmap.h"
+#include "kudu/util/bloom_filter.h"
+#include "kudu/util/coding.h"
 #include "kudu/util/faststring.h"
 #include "kudu/util/hexdump.h"
 #include "kudu/util/memory/arena.h"
@@ -211,6 +214,56 @@ TEST_F(WireProtocolTest, TestBadSchema_DuplicateColumnName) {
   ASSERT_EQ("Invalid argument: Duplicate column name: c0", s.ToString());
 }
 
+// Serialize a block of rows into the columnar wire layout and verify the
+// resulting per-column buffers.
+TEST_F(WireProtocolTest, TestSerializeRowBlockColumnar) {
+  Arena arena(1024);
+  RowBlock block(schema_, 10, &arena);
+  FillRowBlockWithTestRows(&block);
+
+  // Deselect a couple of rows and NULL out another, to exercise the
+  // selection and validity handling.
+  block.selection_vector()->SetRowUnselected(0);
+  block.selection_vector()->SetRowUnselected(5);
+  block.row(3).cell(2).set_null(true);
+
+  ColumnarSerializedBatch batch;
+  SerializeRowBlockColumnar(block, nullptr, &batch);
+  ASSERT_EQ(8, batch.num_rows);
+  ASSERT_EQ(3, batch.columns.size());
+
+  // The STRING column should have 'num_rows + 1' offsets and densely-packed
+  // cell data.
+  const ColumnarSerializedBatch::Column& col1 = batch.columns[0];
+  ASSERT_TRUE(col1.is_varlen);
+  ASSERT_EQ((8 + 1) * sizeof(uint32_t), col1.data.size());
+  const string kCol1Val = "hello world col1";
+  ASSERT_EQ(8 * kCol1Val.size(), col1.varlen_data.size());
+  for (int i = 0; i < 8; i++) {
+    uint32_t start = DecodeFixed32(col1.data.data() + i * sizeof(uint32_t));
+    uint32_t end = DecodeFixed32(col1.data.data() + (i + 1) * sizeof(uint32_t));
+    ASSERT_EQ(kCol1Val, Slice(col1.varlen_data.data() + start, end - start).ToString());
+  }
+
+  // The nullable UINT32 column should carry the selected cell values and a
+  // validity bitmap with a cleared bit for the NULLed row (the third
+  // selected row, given rows 0 and 5 are deselected).
+  const ColumnarSerializedBatch::Column& col3 = batch.columns[2];
+  ASSERT_TRUE(col3.is_nullable);
+  ASSERT_EQ(8 * sizeof(uint32_t), col3.data.size());
+  vector<uint32_t> expected = { 1, 2, 0 /* NULL, zeroed */, 4, 6, 7, 8, 9 };
+  for (int i = 0; i < 8; i++) {
+    ASSERT_EQ(expected[i], DecodeFixed32(col3.data.data() + i * sizeof(uint32_t)));
+    ASSERT_EQ(i != 2, BitmapTest(col3.non_null_bitmap.data(), i));
+  }
+
+  // Serializing a second block should append to the same buffers.
+  SerializeRowBlockColumnar(block, nullptr, &batch);
+  ASSERT_EQ(16, batch.num_rows);
+  ASSERT_EQ((16 + 1) * sizeof(uint32_t), batch.columns[0].data.size());
+  ASSERT_EQ(16 * kCol1Val.size(), batch.columns[0].varlen_data.size());
+}
+
 // Create a block of rows in columnar layout and ensure that it can be
 // converted to and from protobuf.
 TEST_F(WireProtocolTest, TestColumnarRowBlockToPB) {
@@ -240,6 +293,60 @@ TEST_F(WireProtocolTest, TestColumnarRowBlockToPB) {
   }
 }
 
+// Serialize a block with a sparse selection vector and ensure the selected
+// rows round-trip. This exercises the run-at-a-time copy paths in
+// CopyColumn() across runs of varying lengths and alignments.
+TEST_F(WireProtocolTest, TestRowBlockToPBWithSparseSelection) {
+  const int kNumRows = 100;
+  Arena arena(1024);
+  Schema schema({ ColumnSchema("key", INT32),
+                  ColumnSchema("int_val", INT64),
+                  ColumnSchema("string_val", STRING),
+                  ColumnSchema("nullable_val", INT32, true /* nullable */) },
+                1);
+  RowBlock block(schema, kNumRows, &arena);
+  block.selection_vector()->SetAllTrue();
+
+  for (int i = 0; i < block.nrows(); i++) {
+    RowBlockRow row = block.row(i);
+    *reinterpret_cast<int32_t*>(row.mutable_cell_ptr(0)) = i;
+    *reinterpret_cast<int64_t*>(row.mutable_cell_ptr(1)) = i * 10;
+    Slice s;
+    CHECK(arena.RelocateSlice(strings::Substitute("row $0", i), &s));
+    *reinterpret_cast<Slice*>(row.mutable_cell_ptr(2)) = s;
+    if (i % 3 == 0) {
+      row.cell(3).set_null(true);
+    } else {
+      row.cell(3).set_null(false);
+      *reinterpret_cast<int32_t*>(row.mutable_cell_ptr(3)) = -i;
+    }
+    // Deselect rows in a pattern which produces selected runs of varying
+    // lengths, including runs crossing bitmap word boundaries.
+    if (i % 7 == 0 || (i >= 20 && i < 35)) {
+      block.selection_vector()->SetRowUnselected(i);
+    }
+  }
+
+  RowwiseRowBlockPB pb;
+  faststring direct, indirect;
+  SerializeRowBlock(block, &pb, nullptr, &direct, &indirect);
+  ASSERT_EQ(block.selection_vector()->CountSelected(), pb.num_rows());
+
+  vector<const uint8_t*> row_ptrs;
+  Slice direct_sidecar = direct;
+  ASSERT_OK(ExtractRowsFromRowBlockPB(schema, pb, indirect,
+                                      &direct_sidecar, &row_ptrs));
+  int dst_idx = 0;
+  for (int i = 0; i < block.nrows(); i++) {
+    if (!block.selection_vector()->IsRowSelected(i)) continue;
+    ConstContiguousRow row_roundtripped(&schema, row_ptrs[dst_idx]);
+    EXPECT_EQ(schema.DebugRow(block.row(i)),
+              schema.DebugRow(row_roundtripped));
+    dst_idx++;
+  }
+  ASSERT_EQ(row_ptrs.size(), dst_idx);
+}
+
 // Create a block of rows in columnar layout and ensure that it can be
 // converted to and from protobuf.
 TEST_F(WireProtocolTest, TestColumnarRowBlockToPBWithPadding) {
@@ -499,4 +606,50 @@ TEST_F(WireProtocolTest, TestColumnPredicateInList) {
     ASSERT_TRUE(ColumnPredicateFromPB(schema, &arena, pb, &predicate).IsInvalidArgument());
   }
 }
+
+TEST_F(WireProtocolTest, TestColumnPredicateInBloomFilter) {
+  ColumnSchema col1("col1", INT32);
+  vector<ColumnSchema> cols = { col1 };
+  Schema schema(cols, 1);
+  Arena arena(1024);
+  boost::optional<ColumnPredicate> predicate;
+
+  BloomFilterBuilder bfb(BloomFilterSizing::ByCountAndFPRate(10, 0.01));
+  for (int32_t v = 0; v < 10; v++) {
+    bfb.AddKey(BloomKeyProbe(Slice(reinterpret_cast<const uint8_t*>(&v), sizeof(v))));
+  }
+  BloomFilter bf(bfb.slice(), bfb.n_hashes());
+
+  { // Round trip.
+    kudu::ColumnPredicate cp = kudu::ColumnPredicate::InBloomFilter(col1, &bf);
+    ColumnPredicatePB pb;
+    ASSERT_NO_FATAL_FAILURE(ColumnPredicateToPB(cp, &pb));
+    ASSERT_EQ(bfb.n_bytes(), pb.in_bloom_filter().bloom_data().size());
+    ASSERT_EQ(bfb.n_hashes(), pb.in_bloom_filter().n_hashes());
+
+    ASSERT_OK(ColumnPredicateFromPB(schema, &arena, pb, &predicate));
+    ASSERT_EQ(PredicateType::InBloomFilter, predicate->predicate_type());
+    // The deserialized filter must contain the same keys.
+    for (int32_t v = 0; v < 10; v++) {
+      ASSERT_TRUE(predicate->EvaluateCell<INT32>(&v)) << v;
+    }
+  }
+
+  { // Missing bloom filter data.
+    ColumnPredicatePB pb;
+    pb.set_column("col1");
+    pb.mutable_in_bloom_filter()->set_n_hashes(4);
+
+    ASSERT_TRUE(ColumnPredicateFromPB(schema, &arena, pb, &predicate).IsInvalidArgument());
+  }
+
+  { // Invalid hash count.
+    ColumnPredicatePB pb;
+    pb.set_column("col1");
+    pb.mutable_in_bloom_filter()->set_bloom_data(string("\0\0\0\0", 4));
+    pb.mutable_in_bloom_filter()->set_n_hashes(0);
+
+    ASSERT_TRUE(ColumnPredicateFromPB(schema, &arena, pb, &predicate).IsInvalidArgument());
+  }
+}
 } // namespace kudu
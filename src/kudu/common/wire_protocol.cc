@@ -40,6 +40,8 @@
 #include "kudu/gutil/strings/fastmem.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/util/bitmap.h"
+#include "kudu/util/bloom_filter.h"
+#include "kudu/util/coding.h"
 #include "kudu/util/compression/compression.pb.h"
 #include "kudu/util/faststring.h"
 #include "kudu/util/memory/arena.h"
@@ -461,6 +463,14 @@ void ColumnPredicateToPB(const ColumnPredicate& predicate,
       }
       return;
     };
+    case PredicateType::InBloomFilter: {
+      auto* bloom_pred = pb->mutable_in_bloom_filter();
+      const BloomFilter* bloom_filter = predicate.bloom_filter();
+      Slice bloom_data = bloom_filter->slice();
+      bloom_pred->set_bloom_data(bloom_data.data(), bloom_data.size());
+      bloom_pred->set_n_hashes(bloom_filter->n_hashes());
+      return;
+    };
     case PredicateType::None: LOG(FATAL) << "None predicate may not be converted to protobuf";
   }
   LOG(FATAL) << "unknown predicate type";
@@ -530,6 +540,23 @@ Status ColumnPredicateFromPB(const Schema& schema,
         *predicate = ColumnPredicate::IsNull(col);
         break;
       }
+    case ColumnPredicatePB::kInBloomFilter: {
+      const auto& bloom = pb.in_bloom_filter();
+      if (!bloom.has_bloom_data() || bloom.bloom_data().empty() ||
+          !bloom.has_n_hashes() || bloom.n_hashes() <= 0) {
+        return Status::InvalidArgument("Invalid bloom filter predicate on column",
+                                       col.name());
+      }
+      // Copy the bloom filter data into the arena so that it outlives the
+      // predicate.
+      const string& bloom_data = bloom.bloom_data();
+      uint8_t* data_copy = static_cast<uint8_t*>(arena->AllocateBytes(bloom_data.size()));
+      memcpy(data_copy, bloom_data.data(), bloom_data.size());
+      const BloomFilter* bloom_filter = arena->NewObject<BloomFilter>(
+          Slice(data_copy, bloom_data.size()), bloom.n_hashes());
+      *predicate = ColumnPredicate::InBloomFilter(col, bloom_filter);
+      break;
+    };
     default: return Status::InvalidArgument("Unknown predicate type for column", col.name());
   }
   return Status::OK();
@@ -707,6 +734,20 @@ void AppendRowToString<RowBlockRow>(const RowBlockRow& row, string* buf) {
   CHECK_OK(CopyRow(row, &copied_row, reinterpret_cast<Arena*>(NULL)));
 }
 
+// Copy 'nrows' densely-packed cells of CELL_SIZE bytes from 'src' into
+// 'dst', advancing 'dst' by 'row_stride' per cell. The cell size is a
+// template parameter so that the compiler emits a tight copy loop with no
+// per-cell size dispatch.
+template<size_t CELL_SIZE>
+static void CopyCellRun(uint8_t* dst, size_t row_stride,
+                        const uint8_t* src, int nrows) {
+  for (int i = 0; i < nrows; i++) {
+    memcpy(dst, src, CELL_SIZE);
+    dst += row_stride;
+    src += CELL_SIZE;
+  }
+}
+
 // Copy a column worth of data from the given RowBlock into the output
 // protobuf.
 //
@@ -742,6 +783,44 @@ static void CopyColumn(const RowBlock& block, int col_idx, int dst_col_idx, uint
       row_idx += run_size;
       continue;
     }
+    if (!IS_NULLABLE && !IS_VARLEN) {
+      // Fixed-length non-nullable columns can copy a whole selected run at
+      // once. For a fully-selected block (e.g. a scan with no predicates)
+      // this replaces the per-cell loop below with a single run copy.
+      if (cell_size == row_stride) {
+        // Single-column projection: the destination is contiguous.
+        memcpy(dst, src, cell_size * run_size);
+      } else {
+        switch (cell_size) {
+          case 1: CopyCellRun<1>(dst, row_stride, src, run_size); break;
+          case 2: CopyCellRun<2>(dst, row_stride, src, run_size); break;
+          case 4: CopyCellRun<4>(dst, row_stride, src, run_size); break;
+          case 8: CopyCellRun<8>(dst, row_stride, src, run_size); break;
+          default:
+            for (int i = 0; i < run_size; i++) {
+              strings::memcpy_inlined(dst + i * row_stride, src + i * cell_size, cell_size);
+            }
+            break;
+        }
+      }
+      dst += row_stride * run_size;
+      src += cell_size * run_size;
+      row_idx += run_size;
+      continue;
+    }
+    if (IS_VARLEN) {
+      // Reserve space for the whole run's indirect data up front so the
+      // per-cell appends below never grow the buffer mid-run.
+      size_t run_indirect_size = 0;
+      const uint8_t* p = src;
+      for (int i = 0; i < run_size; i++) {
+        if (!IS_NULLABLE || !cblock.is_null(row_idx + i)) {
+          run_indirect_size += reinterpret_cast<const Slice*>(p)->size();
+        }
+        p += cell_size;
+      }
+      indirect_data->reserve(indirect_data->size() + run_indirect_size);
+    }
     for (int i = 0; i < run_size; i++) {
       if (IS_NULLABLE && cblock.is_null(row_idx)) {
         BitmapChange(dst + offset_to_null_bitmap, dst_col_idx, true);
@@ -854,4 +933,166 @@ void SerializeRowBlock(const RowBlock& block,
   rowblock_pb->set_num_rows(rowblock_pb->num_rows() + num_rows);
 }
 
+// Serialize a column worth of data from the given RowBlock in columnar
+// layout, appending to the buffers in 'dst'.
+//
+// As with CopyColumn() above, IS_NULLABLE and IS_VARLEN are template
+// parameters so the branches are resolved outside the per-cell loop.
+template<bool IS_NULLABLE, bool IS_VARLEN>
+static void CopyColumnToColumnarBatch(const RowBlock& block, int col_idx,
+                                      int64_t first_row_idx,
+                                      ColumnarSerializedBatch::Column* dst) {
+  ColumnBlock cblock = block.column_block(col_idx);
+  size_t cell_size = cblock.stride();
+  const uint8_t* src = cblock.cell_ptr(0);
+
+  BitmapIterator selected_row_iter(block.selection_vector()->bitmap(), block.nrows());
+  int run_size;
+  bool selected;
+  int row_idx = 0;
+  int64_t dst_idx = first_row_idx;
+  while ((run_size = selected_row_iter.Next(&selected))) {
+    if (!selected) {
+      src += run_size * cell_size;
+      row_idx += run_size;
+      continue;
+    }
+    if (!IS_NULLABLE && !IS_VARLEN) {
+      // Fixed-length non-nullable cells in a selected run are contiguous:
+      // copy the whole run at once.
+      dst->data.append(src, run_size * cell_size);
+      src += run_size * cell_size;
+      row_idx += run_size;
+      dst_idx += run_size;
+      continue;
+    }
+    if (IS_NULLABLE && !IS_VARLEN) {
+      // Split the selected run into alternating non-null and null sub-runs
+      // based on the column's null bitmap. Non-null sub-runs are copied with
+      // a single memcpy and a single ranged bitmap update instead of a
+      // branch per cell; null cells typically cluster, so most runs resolve
+      // in a handful of word-at-a-time bitmap scans.
+      const uint8_t* null_bitmap = cblock.null_bitmap();
+      const int run_end = row_idx + run_size;
+      while (row_idx < run_end) {
+        // In the null bitmap, a set bit means the cell is non-null.
+        bool non_null = BitmapTest(null_bitmap, row_idx);
+        size_t sub_end;
+        if (!BitmapFindFirst(null_bitmap, row_idx, run_end, !non_null, &sub_end)) {
+          sub_end = run_end;
+        }
+        int sub_run = static_cast<int>(sub_end) - row_idx;
+        if (non_null) {
+          BitmapChangeBits(dst->non_null_bitmap.data(), dst_idx, sub_run, true);
+          dst->data.append(src, sub_run * cell_size);
+        } else {
+          // NULL slots ship with zeroed contents to avoid leaking stale
+          // memory and to improve RPC compression. The destination bitmap
+          // was pre-extended and zeroed by the caller.
+          size_t offset = dst->data.size();
+          dst->data.resize(offset + sub_run * cell_size);
+          memset(dst->data.data() + offset, 0, sub_run * cell_size);
+        }
+        src += sub_run * cell_size;
+        row_idx += sub_run;
+        dst_idx += sub_run;
+      }
+      continue;
+    }
+    for (int i = 0; i < run_size; i++) {
+      bool is_null = IS_NULLABLE && cblock.is_null(row_idx);
+      if (IS_NULLABLE) {
+        // The bitmap was pre-extended and zeroed by the caller, so only
+        // non-null cells need a bitmap write.
+        if (!is_null) {
+          BitmapSet(dst->non_null_bitmap.data(), dst_idx);
+        }
+      }
+      if (IS_VARLEN) {
+        if (!is_null) {
+          const Slice* slice = reinterpret_cast<const Slice*>(src);
+          dst->varlen_data.append(slice->data(), slice->size());
+        }
+        // Each cell appends its end offset; combined with the leading zero
+        // seeded by the caller, cell N's extent is [offset[N], offset[N+1]).
+        // NULL cells thus get an empty byte range.
+        PutFixed32(&dst->data, dst->varlen_data.size());
+      } else {
+        // NULL slots ship with zeroed contents to avoid leaking stale
+        // memory and to improve RPC compression.
+        if (is_null) {
+          size_t offset = dst->data.size();
+          dst->data.resize(offset + cell_size);
+          memset(dst->data.data() + offset, 0, cell_size);
+        } else {
+          dst->data.append(src, cell_size);
+        }
+      }
+      dst_idx++;
+      src += cell_size;
+      row_idx++;
+    }
+  }
+}
+
+void SerializeRowBlockColumnar(const RowBlock& block,
+                               const Schema* projection_schema,
+                               ColumnarSerializedBatch* out) {
+  DCHECK_GT(block.nrows(), 0);
+  const Schema& tablet_schema = block.schema();
+  if (projection_schema == nullptr) {
+    projection_schema = &tablet_schema;
+  }
+
+  if (out->columns.empty()) {
+    out->columns.resize(projection_schema->num_columns());
+    for (int i = 0; i < projection_schema->num_columns(); i++) {
+      const ColumnSchema& col = projection_schema->column(i);
+      ColumnarSerializedBatch::Column* dst = &out->columns[i];
+      dst->is_varlen = col.type_info()->physical_type() == BINARY;
+      dst->is_nullable = col.is_nullable();
+      // Variable-length columns carry 'num_rows + 1' offsets so that the
+      // extent of every cell (including the last) is computable; seed the
+      // leading zero offset up front.
+      if (dst->is_varlen) {
+        PutFixed32(&dst->data, 0);
+      }
+    }
+  }
+  DCHECK_EQ(out->columns.size(), projection_schema->num_columns());
+
+  int64_t num_rows = block.selection_vector()->CountSelected();
+  if (num_rows == 0) return;
+  int64_t first_row_idx = out->num_rows;
+
+  for (int p_schema_idx = 0; p_schema_idx < projection_schema->num_columns(); p_schema_idx++) {
+    const ColumnSchema& col = projection_schema->column(p_schema_idx);
+    int t_schema_idx = tablet_schema.find_column(col.name());
+    DCHECK_NE(t_schema_idx, -1);
+    ColumnarSerializedBatch::Column* dst = &out->columns[p_schema_idx];
+
+    if (col.is_nullable()) {
+      // Extend the validity bitmap with zeroed (NULL) bits; the copy loop
+      // sets the bits for non-null cells. faststring::resize() leaves new
+      // bytes uninitialized, so zero them explicitly.
+      size_t old_size = dst->non_null_bitmap.size();
+      size_t new_size = BitmapSize(first_row_idx + num_rows);
+      dst->non_null_bitmap.resize(new_size);
+      memset(dst->non_null_bitmap.data() + old_size, 0, new_size - old_size);
+    }
+
+    bool is_varlen = col.type_info()->physical_type() == BINARY;
+    if (col.is_nullable() && is_varlen) {
+      CopyColumnToColumnarBatch<true, true>(block, t_schema_idx, first_row_idx, dst);
+    } else if (col.is_nullable() && !is_varlen) {
+      CopyColumnToColumnarBatch<true, false>(block, t_schema_idx, first_row_idx, dst);
+    } else if (!col.is_nullable() && is_varlen) {
+      CopyColumnToColumnarBatch<false, true>(block, t_schema_idx, first_row_idx, dst);
+    } else {
+      CopyColumnToColumnarBatch<false, false>(block, t_schema_idx, first_row_idx, dst);
+    }
+  }
+  out->num_rows += num_rows;
+}
+
 } // namespace kudu
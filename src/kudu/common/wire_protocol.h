@@ -22,6 +22,7 @@
 #include <cstdint>
 #include <vector>
 
+#include "kudu/util/faststring.h"
 #include "kudu/util/status.h"
 
 namespace boost {
@@ -40,7 +41,6 @@ namespace kudu {
 class Arena;
 class ColumnPredicate;
 class ColumnSchema;
-class faststring;
 class HostPort;
 class RowBlock;
 class Schema;
@@ -154,6 +154,53 @@ void SerializeRowBlock(const RowBlock& block, RowwiseRowBlockPB* rowblock_pb,
                        faststring* data_buf, faststring* indirect_data,
                        bool pad_unixtime_micros_to_16_bytes = false);
 
+// Accumulator for columnar-layout scan results.
+//
+// Each projected column is serialized into its own set of buffers, which are
+// shipped to the client as separate sidecars (see ColumnarRowBlockPB). The
+// per-column buffers may accumulate data across multiple calls to
+// SerializeRowBlockColumnar().
+struct ColumnarSerializedBatch {
+  struct Column {
+    // Cell data. For fixed-length types, the cells themselves; for
+    // variable-length types, little-endian uint32 offsets into 'varlen_data'.
+    faststring data;
+
+    // Data referenced by the offsets in 'data'. Only used for
+    // variable-length columns.
+    faststring varlen_data;
+
+    // Non-null (validity) bitmap. Bit N set means cell N is non-NULL.
+    // Only used for nullable columns.
+    faststring non_null_bitmap;
+
+    // Whether this column is variable-length/nullable. These determine
+    // which of the above buffers are in use, regardless of whether any
+    // data has been appended to them yet.
+    bool is_varlen = false;
+    bool is_nullable = false;
+  };
+
+  std::vector<Column> columns;
+
+  // Total number of rows serialized into 'columns'.
+  int64_t num_rows = 0;
+};
+
+// Encode the given row block in columnar layout, appending to 'out'.
+//
+// Only rows whose selection vector entry is true are serialized; the rows of
+// each column are densely packed. If 'projection_schema' is not NULL, only
+// the columns it specifies are serialized, in its order.
+//
+// On the first call, 'out->columns' is sized to match the projection; later
+// calls must pass a block with the same projection.
+//
+// Requires that block.nrows() > 0
+void SerializeRowBlockColumnar(const RowBlock& block,
+                               const Schema* projection_schema,
+                               ColumnarSerializedBatch* out);
+
 // Rewrites the data pointed-to by row data slice 'row_data_slice' by replacing
 // relative indirect data pointers with absolute ones in 'indirect_data_slice'.
 // At the time of this writing, this rewriting is only done for STRING types.
@@ -21,6 +21,7 @@
 #include <type_traits>
 #include <utility>
 
+#include <gflags/gflags_declare.h>
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
@@ -56,6 +57,9 @@
 
 METRIC_DECLARE_entity(tablet);
 
+DECLARE_int32(raft_heartbeat_interval_ms);
+DECLARE_int32(safe_time_heartbeat_interval_ms);
+
 namespace kudu {
 namespace consensus {
 
@@ -355,6 +359,43 @@ TEST_F(ConsensusPeersTest, TestDontSendOneRpcPerWriteWhenPeerIsDown) {
   ASSERT_LT(mock_proxy->update_count(), 5);
 }
 
+// Test that when --safe_time_heartbeat_interval_ms is set lower than the Raft
+// heartbeat interval, status-only heartbeats are sent at the faster cadence
+// so idle followers' safe time keeps advancing.
+TEST_F(ConsensusPeersTest, TestSafeTimeHeartbeatInterval) {
+  FLAGS_raft_heartbeat_interval_ms = 60 * 1000;
+  FLAGS_safe_time_heartbeat_interval_ms = 20;
+
+  message_queue_->SetLeaderMode(kMinimumOpIdIndex,
+                                kMinimumTerm,
+                                BuildRaftConfigPBForTests(3));
+
+  auto mock_proxy = new MockedPeerProxy(raft_pool_.get());
+  shared_ptr<Peer> peer;
+  ASSERT_OK(Peer::NewRemotePeer(FakeRaftPeerPB(kFollowerUuid),
+                                kTabletId,
+                                kLeaderUuid,
+                                message_queue_.get(),
+                                raft_pool_token_.get(),
+                                gscoped_ptr<PeerProxy>(mock_proxy),
+                                messenger_,
+                                &peer));
+
+  ConsensusResponsePB resp;
+  resp.set_responder_uuid(kFollowerUuid);
+  resp.set_responder_term(0);
+  resp.mutable_status()->mutable_last_received()->CopyFrom(MakeOpId(0, 0));
+  resp.mutable_status()->mutable_last_received_current_leader()->CopyFrom(MakeOpId(0, 0));
+  resp.mutable_status()->set_last_committed_idx(0);
+  mock_proxy->set_update_response(resp);
+
+  // With no writes in flight, several heartbeats should go out well before
+  // a single Raft heartbeat interval elapses.
+  ASSERT_EVENTUALLY([&]() {
+    ASSERT_GE(mock_proxy->update_count(), 3);
+  });
+}
+
 }  // namespace consensus
 }  // namespace kudu
 
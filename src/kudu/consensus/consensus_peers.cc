@@ -51,6 +51,7 @@
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/monotime.h"
+#include "kudu/util/net/dns_resolver.h"
 #include "kudu/util/net/net_util.h"
 #include "kudu/util/net/sockaddr.h"
 #include "kudu/util/pb_util.h"
@@ -84,7 +85,17 @@ DEFINE_bool(enable_tablet_copy, true,
             "replica. For testing purposes only.");
 TAG_FLAG(enable_tablet_copy, unsafe);
 
+DEFINE_int32(safe_time_heartbeat_interval_ms, -1,
+             "Interval at which the leader heartbeats to idle followers in order to "
+             "advance their safe time, in milliseconds. More frequent heartbeats let "
+             "followers serve snapshot reads with a tighter staleness bound when the "
+             "tablet sees no writes. If negative, safe time advances at the Raft "
+             "heartbeat interval (--raft_heartbeat_interval_ms) instead.");
+TAG_FLAG(safe_time_heartbeat_interval_ms, advanced);
+TAG_FLAG(safe_time_heartbeat_interval_ms, experimental);
+
 DECLARE_int32(raft_heartbeat_interval_ms);
+DECLARE_bool(safe_time_advancement_without_writes);
 
 using kudu::pb_util::SecureShortDebugString;
 using kudu::rpc::Messenger;
@@ -145,6 +156,20 @@ Status Peer::Init() {
     queue_->TrackPeer(peer_pb_.permanent_uuid());
   }
 
+  // Status-only heartbeat requests double as the mechanism by which idle
+  // followers' safe time advances (see PeerMessageQueue::RequestForPeer()).
+  // If a shorter safe time heartbeat interval is configured, drive the
+  // heartbeater at that cadence so followers can serve snapshot reads with
+  // a tighter staleness bound than the Raft failure-detection interval
+  // would allow. When ops are flowing the heartbeater is snoozed and safe
+  // time advances with the ops themselves.
+  int64_t heartbeat_interval_ms = FLAGS_raft_heartbeat_interval_ms;
+  if (FLAGS_safe_time_advancement_without_writes &&
+      FLAGS_safe_time_heartbeat_interval_ms > 0) {
+    heartbeat_interval_ms = std::min<int64_t>(heartbeat_interval_ms,
+                                              FLAGS_safe_time_heartbeat_interval_ms);
+  }
+
   // Capture a weak_ptr reference into the functor so it can safely handle
   // outliving the peer.
   weak_ptr<Peer> w = shared_from_this();
@@ -155,7 +180,7 @@ Status Peer::Init() {
           p->SignalRequest(true);
         }
       },
-      MonoDelta::FromMilliseconds(FLAGS_raft_heartbeat_interval_ms));
+      MonoDelta::FromMilliseconds(heartbeat_interval_ms));
   heartbeater_->Start();
   return Status::OK();
 }
@@ -492,7 +517,9 @@ Status CreateConsensusServiceProxyForHost(const shared_ptr<Messenger>& messenger
                                           const HostPort& hostport,
                                           gscoped_ptr<ConsensusServiceProxy>* new_proxy) {
   vector<Sockaddr> addrs;
-  RETURN_NOT_OK(hostport.ResolveAddresses(&addrs));
+  // Use the shared resolver so that repeated proxy creation for stable peer
+  // hostnames is served from the DNS cache.
+  RETURN_NOT_OK(DnsResolver::GetSingleton()->ResolveAddresses(hostport, &addrs));
   if (addrs.size() > 1) {
     LOG(WARNING)<< "Peer address '" << hostport.ToString() << "' "
     << "resolves to " << addrs.size() << " different addresses. Using "
@@ -58,7 +58,9 @@
 #include "kudu/util/test_util.h"
 #include "kudu/util/threadpool.h"
 
+DECLARE_bool(consensus_adaptive_batch_size);
 DECLARE_int32(consensus_max_batch_size_bytes);
+DECLARE_int32(consensus_min_batch_size_bytes);
 
 METRIC_DECLARE_entity(tablet);
 
@@ -226,6 +228,34 @@ class ConsensusQueueTest : public KuduTest {
   scoped_refptr<clock::Clock> clock_;
 };
 
+// Tests the computation of the leader lease deadline: the lease is only
+// valid while the queue is in leader mode and a majority of voters has
+// acknowledged a recent request.
+TEST_F(ConsensusQueueTest, TestLeaderLeaseDeadline) {
+  // A queue that isn't in leader mode holds no lease.
+  ASSERT_EQ(MonoTime::Min(), queue_->GetLeaderLeaseDeadline());
+
+  queue_->SetLeaderMode(kMinimumOpIdIndex, kMinimumTerm, BuildRaftConfigPBForTests(2));
+
+  // The remote peer hasn't acknowledged any request yet, so the local peer
+  // alone doesn't constitute a majority of the two voters.
+  ASSERT_EQ(MonoTime::Min(), queue_->GetLeaderLeaseDeadline());
+
+  ConsensusRequestPB request;
+  ConsensusResponsePB response;
+  bool more_pending = false;
+  UpdatePeerWatermarkToOp(&request, &response, MinimumOpId(), MinimumOpId(), &more_pending);
+
+  // Any response from the peer counts as a grant, even the log matching
+  // error sent by the helper above, since the peer accepted our leadership
+  // when it processed the request.
+  ASSERT_GT(queue_->GetLeaderLeaseDeadline(), MonoTime::Now());
+
+  // Stepping down invalidates the lease.
+  queue_->SetNonLeaderMode();
+  ASSERT_EQ(MonoTime::Min(), queue_->GetLeaderLeaseDeadline());
+}
+
 // Tests that the queue is able to track a peer when it starts tracking a peer
 // after the initial message in the queue. In particular this creates a queue
 // with several messages and then starts to track a peer whose watermark
@@ -337,6 +367,55 @@ TEST_F(ConsensusQueueTest, TestGetPagedMessages) {
   request.mutable_ops()->ExtractSubrange(0, request.ops_size(), nullptr);
 }
 
+// Tests that failed exchanges with a peer shrink its adaptive batch size
+// target and that successful exchanges grow it back to the maximum.
+TEST_F(ConsensusQueueTest, TestAdaptiveBatchSize) {
+  google::FlagSaver saver;
+  FLAGS_consensus_adaptive_batch_size = true;
+
+  queue_->SetLeaderMode(kMinimumOpIdIndex, kMinimumTerm, BuildRaftConfigPBForTests(2));
+
+  ConsensusRequestPB request;
+  ConsensusResponsePB response;
+  response.set_responder_uuid(kPeerUuid);
+  bool more_pending = false;
+  UpdatePeerWatermarkToOp(&request, &response, MakeOpId(7, 50), MinimumOpId(), &more_pending);
+
+  // A freshly tracked peer starts with full-sized batches.
+  ASSERT_EQ(FLAGS_consensus_max_batch_size_bytes,
+            queue_->GetTrackedPeerForTests(kPeerUuid).batch_size_target_bytes);
+
+  // Each failed exchange halves the target...
+  queue_->UpdatePeerStatus(kPeerUuid, PeerStatus::RPC_LAYER_ERROR,
+                           Status::NetworkError("injected error"));
+  ASSERT_EQ(FLAGS_consensus_max_batch_size_bytes / 2,
+            queue_->GetTrackedPeerForTests(kPeerUuid).batch_size_target_bytes);
+
+  // ... down to the configured floor.
+  for (int i = 0; i < 20; i++) {
+    queue_->UpdatePeerStatus(kPeerUuid, PeerStatus::RPC_LAYER_ERROR,
+                             Status::NetworkError("injected error"));
+  }
+  ASSERT_EQ(FLAGS_consensus_min_batch_size_bytes,
+            queue_->GetTrackedPeerForTests(kPeerUuid).batch_size_target_bytes);
+
+  // Protocol-level retries don't affect the target.
+  queue_->UpdatePeerStatus(kPeerUuid, PeerStatus::LMP_MISMATCH, Status::OK());
+  ASSERT_EQ(FLAGS_consensus_min_batch_size_bytes,
+            queue_->GetTrackedPeerForTests(kPeerUuid).batch_size_target_bytes);
+
+  // Successful exchanges double the target back up to the maximum.
+  SetLastReceivedAndLastCommitted(&response, MakeOpId(7, 50));
+  queue_->ResponseFromPeer(response.responder_uuid(), response, &more_pending);
+  ASSERT_EQ(FLAGS_consensus_min_batch_size_bytes * 2,
+            queue_->GetTrackedPeerForTests(kPeerUuid).batch_size_target_bytes);
+  for (int i = 0; i < 20; i++) {
+    queue_->ResponseFromPeer(response.responder_uuid(), response, &more_pending);
+  }
+  ASSERT_EQ(FLAGS_consensus_max_batch_size_bytes,
+            queue_->GetTrackedPeerForTests(kPeerUuid).batch_size_target_bytes);
+}
+
 TEST_F(ConsensusQueueTest, TestPeersDontAckBeyondWatermarks) {
   queue_->SetLeaderMode(kMinimumOpIdIndex, kMinimumTerm, BuildRaftConfigPBForTests(3));
   AppendReplicateMessagesToQueue(queue_.get(), clock_, 1, 100);
@@ -18,6 +18,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <functional>
 #include <iostream>
 #include <mutex>
 #include <string>
@@ -56,6 +57,23 @@ DEFINE_int32(consensus_max_batch_size_bytes, 1024 * 1024,
              "The maximum per-tablet RPC batch size when updating peers.");
 TAG_FLAG(consensus_max_batch_size_bytes, advanced);
 
+DEFINE_bool(consensus_adaptive_batch_size, true,
+            "Whether to adapt the per-peer RPC batch size to the health of "
+            "each peer. When enabled, failed exchanges with a peer halve the "
+            "batch size target for that peer down to "
+            "--consensus_min_batch_size_bytes, and successful exchanges "
+            "double it back up to --consensus_max_batch_size_bytes. Healthy "
+            "peers thus replicate with full-sized batches while struggling "
+            "peers are probed with smaller payloads.");
+TAG_FLAG(consensus_adaptive_batch_size, advanced);
+TAG_FLAG(consensus_adaptive_batch_size, runtime);
+
+DEFINE_int32(consensus_min_batch_size_bytes, 32 * 1024,
+             "Lower bound for the per-peer adaptive RPC batch size target. "
+             "Only used when --consensus_adaptive_batch_size is enabled.");
+TAG_FLAG(consensus_min_batch_size_bytes, advanced);
+TAG_FLAG(consensus_min_batch_size_bytes, runtime);
+
 DEFINE_int32(follower_unavailable_considered_failed_sec, 300,
              "Seconds that a leader is unable to successfully heartbeat to a "
              "follower after which the follower is considered to be failed and "
@@ -79,6 +97,8 @@ TAG_FLAG(consensus_promotion_max_wal_entries_behind, experimental);
 DECLARE_int32(consensus_rpc_timeout_ms);
 DECLARE_bool(safe_time_advancement_without_writes);
 DECLARE_bool(raft_prepare_replacement_before_eviction);
+DECLARE_int32(raft_heartbeat_interval_ms);
+DECLARE_double(leader_failure_max_missed_heartbeat_periods);
 
 using kudu::log::Log;
 using kudu::pb_util::SecureDebugString;
@@ -238,6 +258,9 @@ void PeerMessageQueue::TrackPeerUnlocked(const string& uuid) {
   // does not have a log that matches ours, the normal queue negotiation
   // process will eventually find the right point to resume from.
   tracked_peer->next_index = queue_state_.last_appended.index() + 1;
+  // Start the peer off with full-sized batches; the target only shrinks
+  // once exchanges with the peer start failing.
+  tracked_peer->batch_size_target_bytes = FLAGS_consensus_max_batch_size_bytes;
   InsertOrDie(&peers_map_, uuid, tracked_peer);
 
   CheckPeersInActiveConfigIfLeaderUnlocked();
@@ -462,6 +485,25 @@ bool PeerMessageQueue::SafeToEvictUnlocked(const string& evict_uuid) const {
   return true;
 }
 
+void PeerMessageQueue::AdaptPeerBatchSizeUnlocked(TrackedPeer* peer, bool success) {
+  if (!FLAGS_consensus_adaptive_batch_size) return;
+  const int64_t max_target = FLAGS_consensus_max_batch_size_bytes;
+  const int64_t min_target = std::min<int64_t>(FLAGS_consensus_min_batch_size_bytes,
+                                               max_target);
+  int64_t target = peer->batch_size_target_bytes;
+  if (success) {
+    // Grow multiplicatively back towards the configured maximum, mirroring
+    // TCP slow start after a backoff. A healthy peer which never failed an
+    // exchange stays pinned at the maximum.
+    target *= 2;
+  } else {
+    // Back off so the next exchange probes the struggling peer with a
+    // smaller payload.
+    target /= 2;
+  }
+  peer->batch_size_target_bytes = std::max(min_target, std::min(max_target, target));
+}
+
 void PeerMessageQueue::UpdatePeerHealthUnlocked(TrackedPeer* peer) {
   DCHECK(queue_lock_.is_locked());
 
@@ -567,6 +609,13 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
     request->set_last_idx_appended_to_leader(queue_state_.last_appended.index());
     request->set_caller_term(current_term);
     unreachable_time = MonoTime::Now() - peer_copy.last_communication_time;
+
+    // Record when this request was prepared. If the peer responds to it,
+    // this is a lower bound on when the peer last accepted our leadership,
+    // which is what the leader lease computation needs. Peers have at most
+    // one request outstanding, so the response that comes back always
+    // corresponds to the most recently prepared request.
+    peer->last_request_prepare_time = MonoTime::Now();
   }
 
   // Always trigger a health status update check at the end of this function.
@@ -595,7 +644,12 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
 
     // The batch of messages to send to the peer.
     vector<ReplicateRefPtr> messages;
-    int max_batch_size = FLAGS_consensus_max_batch_size_bytes - request->ByteSize();
+    int64_t batch_size_target = FLAGS_consensus_max_batch_size_bytes;
+    if (FLAGS_consensus_adaptive_batch_size) {
+      batch_size_target = std::min<int64_t>(batch_size_target,
+                                            peer_copy.batch_size_target_bytes);
+    }
+    int max_batch_size = std::max<int64_t>(0, batch_size_target - request->ByteSize());
 
     // We try to get the follower's next_index from our log.
     Status s = log_cache_.ReadOps(peer_copy.next_index - 1,
@@ -824,6 +878,9 @@ void PeerMessageQueue::UpdatePeerStatus(const string& peer_uuid,
       // like shutdown and failure to deserialize a protobuf. Therefore, we
       // generally consider these errors to indicate an unreachable peer.
       DCHECK(!status.ok());
+      // This covers RPC timeouts, which with an overloaded peer or a thin
+      // link are often a symptom of over-sized batches.
+      AdaptPeerBatchSizeUnlocked(peer, /*success=*/false);
       break;
 
     case PeerStatus::TABLET_NOT_FOUND:
@@ -836,11 +893,17 @@ void PeerMessageQueue::UpdatePeerStatus(const string& peer_uuid,
     }
 
     case PeerStatus::REMOTE_ERROR:
+    case PeerStatus::CANNOT_PREPARE:
+      // These indicate the peer is up but struggling to keep up (e.g. its
+      // prepare queue is full), so retry with a smaller batch.
+      AdaptPeerBatchSizeUnlocked(peer, /*success=*/false);
+      break;
+
     case PeerStatus::INVALID_TERM:
     case PeerStatus::LMP_MISMATCH:
-    case PeerStatus::CANNOT_PREPARE:
       // No special handling here for these - we assume that we'll just retry until
-      // we make progress.
+      // we make progress. These are protocol-level negotiations rather than
+      // signs of an overloaded peer, so they don't affect the batch size.
       break;
 
     case PeerStatus::OK:
@@ -896,6 +959,13 @@ void PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
     peer->last_exchange_status = PeerStatus::OK;
     peer->last_known_committed_index = status.last_committed_idx();
     peer->last_communication_time = MonoTime::Now();
+    // Any well-formed response in our term (including one reporting a log
+    // matching error below) means the peer accepted us as leader when it
+    // processed the request, so it is withholding its vote from other
+    // candidates for the minimum election timeout counted from (at the
+    // earliest) the time we prepared that request.
+    peer->leader_lease_grant_time = peer->last_request_prepare_time;
+    AdaptPeerBatchSizeUnlocked(peer, /*success=*/true);
 
     // If the reported last-received op for the replica is in our local log,
     // then resume sending entries from that point onward. Otherwise, resume
@@ -1085,6 +1155,45 @@ void PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
   }
 }
 
+MonoTime PeerMessageQueue::GetLeaderLeaseDeadline() const {
+  std::lock_guard<simple_spinlock> lock(queue_lock_);
+  if (queue_state_.mode != LEADER) {
+    return MonoTime::Min();
+  }
+
+  // Gather, for each voter, the prepare time of the last request it has
+  // acknowledged. The local peer trivially acknowledges its own leadership.
+  std::vector<MonoTime> grant_times;
+  for (const RaftPeerPB& peer_pb : queue_state_.active_config->peers()) {
+    if (peer_pb.member_type() != RaftPeerPB::VOTER) {
+      continue;
+    }
+    if (peer_pb.permanent_uuid() == local_peer_pb_.permanent_uuid()) {
+      grant_times.emplace_back(MonoTime::Now());
+      continue;
+    }
+    const TrackedPeer* peer = FindPtrOrNull(peers_map_, peer_pb.permanent_uuid());
+    if (peer && peer->leader_lease_grant_time.Initialized()) {
+      grant_times.emplace_back(peer->leader_lease_grant_time);
+    }
+  }
+  if (static_cast<int>(grant_times.size()) < queue_state_.majority_size_) {
+    return MonoTime::Min();
+  }
+
+  // The majority-th most recent grant is the latest point in time at which
+  // some majority of voters had all acknowledged a request; no other
+  // candidate can assemble a majority of votes until the vote-withholding
+  // interval (the minimum election timeout) counted from then has passed.
+  std::nth_element(grant_times.begin(),
+                   grant_times.begin() + queue_state_.majority_size_ - 1,
+                   grant_times.end(),
+                   std::greater<MonoTime>());
+  return grant_times[queue_state_.majority_size_ - 1] +
+      MonoDelta::FromMilliseconds(FLAGS_leader_failure_max_missed_heartbeat_periods *
+                                  FLAGS_raft_heartbeat_interval_ms);
+}
+
 PeerMessageQueue::TrackedPeer PeerMessageQueue::GetTrackedPeerForTests(const string& uuid) {
   std::lock_guard<simple_spinlock> scoped_lock(queue_lock_);
   TrackedPeer* tracked = FindOrDie(peers_map_, uuid);
@@ -122,6 +122,7 @@ class PeerMessageQueue {
           last_communication_time(MonoTime::Now()),
           wal_catchup_possible(true),
           last_overall_health_status(HealthReportPB::UNKNOWN),
+          batch_size_target_bytes(0),
           last_seen_term_(0) {}
 
     TrackedPeer() = default;
@@ -167,6 +168,19 @@ class PeerMessageQueue {
     // successful communication ever took place.
     MonoTime last_communication_time;
 
+    // The time at which the last request for this peer was prepared by
+    // RequestForPeer(). This necessarily precedes the time at which the
+    // peer processed the request. Uninitialized if no request was ever
+    // prepared.
+    MonoTime last_request_prepare_time;
+
+    // The prepare time of the last request that this peer acknowledged,
+    // i.e. a lower bound on the last time the peer accepted this node's
+    // leadership (and started withholding its vote from other candidates).
+    // Used to compute the leader lease deadline. Uninitialized if the peer
+    // never responded.
+    MonoTime leader_lease_grant_time;
+
     // Set to false if it is determined that the remote peer has fallen behind
     // the local peer's WAL.
     bool wal_catchup_possible;
@@ -178,6 +192,15 @@ class PeerMessageQueue {
     // peer (eg when it is lagging, etc).
     logging::LogThrottler status_log_throttler;
 
+    // Target size, in bytes, of the batch of operations in the next request
+    // to this peer. Adjusted like a TCP congestion window: failed exchanges
+    // shrink it multiplicatively so struggling peers see smaller probes,
+    // and successful exchanges grow it back up to the configured maximum.
+    // Set by TrackPeerUnlocked() and adjusted by
+    // AdaptPeerBatchSizeUnlocked(); only consulted when
+    // --consensus_adaptive_batch_size is enabled.
+    int64_t batch_size_target_bytes;
+
    private:
     // The last term we saw from a given peer.
     // This is only used for sanity checking that a peer doesn't
@@ -297,6 +320,23 @@ class PeerMessageQueue {
                         const ConsensusResponsePB& response,
                         bool* more_pending);
 
+  // Returns the time until which this node's leadership is guarded by vote
+  // withholding on a majority of voters (a "leader lease"), or
+  // MonoTime::Min() if no such guarantee currently exists (e.g. the queue
+  // is not in leader mode, or a majority of voters hasn't acknowledged a
+  // recent request).
+  //
+  // A voter that processes a request from this node withholds its vote from
+  // other candidates for the minimum election timeout, counted from a time
+  // no earlier than the time we prepared that request. The majority-th most
+  // recent such prepare time among acknowledged requests is therefore a
+  // point in time from which no other candidate can assemble a majority of
+  // votes for the withholding period. This rests on the usual lease
+  // assumption of bounded clock rate drift between servers, and can be
+  // violated by elections that ignore the live leader (e.g. ones triggered
+  // by tooling or leadership transfer).
+  MonoTime GetLeaderLeaseDeadline() const;
+
   // Called by the consensus implementation to update the queue's watermarks
   // based on information provided by the leader. This is used for metrics and
   // log retention.
@@ -438,6 +478,13 @@ class PeerMessageQueue {
   // notifications.
   void UpdatePeerHealthUnlocked(TrackedPeer* peer);
 
+  // Adjust the adaptive batch size target for 'peer' after an exchange.
+  // Successful exchanges double the target up to
+  // --consensus_max_batch_size_bytes; failed ones halve it down to
+  // --consensus_min_batch_size_bytes. No-op unless
+  // --consensus_adaptive_batch_size is enabled.
+  static void AdaptPeerBatchSizeUnlocked(TrackedPeer* peer, bool success);
+
   // Calculate a peer's up-to-date health status based on internal fields.
   static HealthReportPB::HealthStatus PeerHealthStatus(const TrackedPeer& peer);
 
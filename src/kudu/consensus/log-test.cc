@@ -54,6 +54,7 @@
 #include "kudu/util/compression/compression.pb.h"
 #include "kudu/util/env.h"
 #include "kudu/util/metrics.h"
+#include "kudu/util/path_util.h"
 #include "kudu/util/random.h"
 #include "kudu/util/status.h"
 #include "kudu/util/stopwatch.h"
@@ -63,6 +64,9 @@
 DEFINE_int32(num_batches, 10000,
              "Number of batches to write to/read from the Log in TestWriteManyBatches");
 
+DECLARE_int32(log_group_commit_max_batch_bytes);
+DECLARE_int32(log_group_commit_window_us);
+DECLARE_bool(log_per_device_wal_syncer);
 DECLARE_int32(log_min_segments_to_retain);
 DECLARE_int32(log_max_segments_to_retain);
 DECLARE_double(log_inject_io_error_on_preallocate_fraction);
@@ -1108,6 +1112,34 @@ TEST_F(LogTest, TestFailedLogPreAllocation) {
   ASSERT_STR_CONTAINS(s.ToString(), "Injected IOError");
 }
 
+// Test that allocating segments ahead of time still produces a well-formed
+// sequence of segments on roll-over and that the pre-allocated placeholder
+// for the never-used next segment gets cleaned up on Close().
+TEST_F(LogTest, TestPreallocateSegmentsAhead) {
+  options_.preallocate_segments_ahead = true;
+  ASSERT_OK(BuildLog());
+
+  OpId opid = MakeOpId(1, 1);
+  const int kNumRolls = 3;
+  for (int i = 0; i < kNumRolls; i++) {
+    ASSERT_OK(AppendNoOps(&opid, 10));
+    ASSERT_OK(log_->AllocateSegmentAndRollOver());
+  }
+
+  SegmentSequence segments;
+  ASSERT_OK(log_->reader()->GetSegmentsSnapshot(&segments));
+  ASSERT_EQ(kNumRolls + 1, segments.size());
+
+  ASSERT_OK(log_->Close());
+
+  vector<string> files;
+  ASSERT_OK(env_->GetChildren(
+      JoinPathSegments(fs_manager_->GetWalsRootDir(), kTestTablet), &files));
+  for (const string& file : files) {
+    ASSERT_EQ(string::npos, file.find(kTmpInfix)) << "Leftover placeholder: " << file;
+  }
+}
+
 // Test the enforcement of reserving disk space for the log.
 TEST_F(LogTest, TestDiskSpaceCheck) {
   FLAGS_fs_wal_dir_reserved_bytes = 1; // Keep at least 1 byte reserved in the FS.
@@ -1146,6 +1178,40 @@ TEST_F(LogTest, TestAutoStopIdleAppendThread) {
     });
 }
 
+// Test that appends still complete correctly when the group commit linger
+// window is enabled.
+TEST_F(LogTest, TestGroupCommitLingerWindow) {
+  FLAGS_log_group_commit_window_us = 2000;
+  ASSERT_OK(BuildLog());
+  OpId opid = MakeOpId(1, 1);
+  ASSERT_OK(AppendNoOpsToLogSync(clock_, log_.get(), &opid, 10));
+  ASSERT_OK(log_->WaitUntilAllFlushed());
+
+  // A tiny byte threshold should force the append thread to skip lingering
+  // without affecting correctness.
+  FLAGS_log_group_commit_max_batch_bytes = 1;
+  ASSERT_OK(AppendNoOpsToLogSync(clock_, log_.get(), &opid, 10));
+  ASSERT_OK(log_->WaitUntilAllFlushed());
+}
+
+// Test that appends still complete correctly when fsync() calls are funneled
+// through the shared per-device syncer.
+TEST_F(LogTest, TestPerDeviceWalSyncer) {
+  options_.force_fsync_all = true;
+  FLAGS_log_per_device_wal_syncer = true;
+  ASSERT_OK(BuildLog());
+  OpId opid = MakeOpId(1, 1);
+  ASSERT_OK(AppendNoOpsToLogSync(clock_, log_.get(), &opid, 10));
+  ASSERT_OK(log_->WaitUntilAllFlushed());
+
+  // Rolling over issues a synchronous sync through the syncer, which also
+  // acts as a barrier for any earlier requests.
+  ASSERT_OK(log_->AllocateSegmentAndRollOver());
+  ASSERT_OK(AppendNoOpsToLogSync(clock_, log_.get(), &opid, 10));
+  ASSERT_OK(log_->WaitUntilAllFlushed());
+  ASSERT_OK(log_->Close());
+}
+
 // Test that Log::TotalSize() captures creation, addition, and deletion of log segments.
 TEST_P(LogTestOptionalCompression, TestTotalSize) {
   // Build a log. There is an active segment, so on-disk size should be positive.
@@ -17,11 +17,14 @@
 
 #include "kudu/consensus/log.h"
 
+#include <algorithm>
 #include <cerrno>
 #include <cstdint>
+#include <iterator>
 #include <memory>
 #include <mutex>
 #include <ostream>
+#include <unordered_map>
 #include <utility>
 
 #include <boost/range/adaptor/reversed.hpp>
@@ -37,6 +40,8 @@
 #include "kudu/gutil/bind.h"
 #include "kudu/gutil/bind_helpers.h"
 #include "kudu/gutil/dynamic_annotations.h"
+#include "kudu/gutil/map-util.h"
+#include "kudu/gutil/once.h"
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/gutil/strings/substitute.h"
@@ -84,6 +89,37 @@ DEFINE_int32(group_commit_queue_size_bytes, 4 * 1024 * 1024,
              "Maximum size of the group commit queue in bytes");
 TAG_FLAG(group_commit_queue_size_bytes, advanced);
 
+DEFINE_int32(log_group_commit_window_us, 0,
+             "Number of microseconds the log append thread will linger after "
+             "draining the queue, accumulating entries from concurrent "
+             "appenders into a single write and sync. Lingering trades a "
+             "small amount of commit latency for fewer fsyncs under "
+             "concurrent load. A value of 0 disables lingering.");
+TAG_FLAG(log_group_commit_window_us, advanced);
+TAG_FLAG(log_group_commit_window_us, runtime);
+
+DEFINE_int32(log_group_commit_max_batch_bytes, 1024 * 1024,
+             "Maximum number of bytes to accumulate in a single group commit "
+             "before syncing, when --log_group_commit_window_us is non-zero. "
+             "When the queue is deep enough that a single drain already "
+             "exceeds this threshold, the append thread syncs immediately "
+             "rather than lingering.");
+TAG_FLAG(log_group_commit_max_batch_bytes, advanced);
+TAG_FLAG(log_group_commit_max_batch_bytes, runtime);
+
+DEFINE_bool(log_per_device_wal_syncer, false,
+            "If true, WAL fsync() calls are funneled through a dedicated "
+            "syncer thread shared by all tablets whose WALs live under the "
+            "same WAL root, instead of each tablet's append thread calling "
+            "fsync() on its own. The syncer drains pending sync requests as "
+            "a group, issues a single fsync() per distinct segment in the "
+            "group, and completes all of the waiting appenders in a batch, "
+            "so a device serves one fsync() at a time no matter how many "
+            "tablets are committing to it. Only takes effect when fsync is "
+            "enabled via --log_force_fsync_all.");
+TAG_FLAG(log_per_device_wal_syncer, advanced);
+TAG_FLAG(log_per_device_wal_syncer, experimental);
+
 
 DEFINE_int32(log_thread_idle_threshold_ms, 1000,
              "Number of milliseconds after which the log append thread decides that a "
@@ -178,6 +214,122 @@ using std::vector;
 using std::unique_ptr;
 using strings::Substitute;
 
+// Funnels WAL fsync() calls from every log that lives under the same WAL
+// root through a single thread, so that the underlying device serves one
+// fsync() at a time no matter how many tablets are committing to it.
+// Requests that arrive while a sync is in flight are drained as a group:
+// the syncer issues one fsync() per distinct segment in the group and then
+// completes all of the waiting appenders in a batch.
+//
+// Instances are obtained via GetWalSyncerForRoot() and are never destroyed.
+class WalSyncer {
+ public:
+  WalSyncer() : drain_scheduled_(false) {
+    CHECK_OK(ThreadPoolBuilder("wal-sync").set_max_threads(1).Build(&pool_));
+  }
+
+  // Enqueue a sync request for 'segment', which must remain valid until
+  // 'callback' is invoked. The callback runs, possibly on the syncer thread,
+  // once a sync issued at or after this call has made the segment's appends
+  // durable.
+  void Submit(WritableLogSegment* segment, const StatusCallback& callback) {
+    bool schedule;
+    {
+      std::lock_guard<simple_spinlock> l(lock_);
+      pending_.push_back({ segment, callback });
+      schedule = !drain_scheduled_;
+      drain_scheduled_ = true;
+    }
+    if (schedule) {
+      CHECK_OK(pool_->SubmitClosure(
+          Bind(&WalSyncer::DrainAndSync, Unretained(this))));
+    }
+  }
+
+  // Synchronously sync 'segment'. Since requests complete in FIFO order,
+  // this doubles as a barrier: every previously submitted request has
+  // completed by the time it returns.
+  Status SyncSegment(WritableLogSegment* segment) {
+    Synchronizer sync;
+    Submit(segment, sync.AsStatusCallback());
+    return sync.Wait();
+  }
+
+ private:
+  struct SyncRequest {
+    WritableLogSegment* segment;
+    StatusCallback callback;
+  };
+
+  void DrainAndSync() {
+    vector<SyncRequest> reqs;
+    {
+      std::lock_guard<simple_spinlock> l(lock_);
+      reqs.swap(pending_);
+      drain_scheduled_ = false;
+    }
+
+    // One fsync() per distinct segment covers every request for that segment
+    // in the group: all of their appends were written before the requests
+    // were enqueued.
+    std::unordered_map<WritableLogSegment*, Status> results;
+    for (const SyncRequest& req : reqs) {
+      if (!ContainsKey(results, req.segment)) {
+        Status s;
+        LOG_SLOW_EXECUTION(WARNING, 50, "Fsync log took a long time") {
+          s = req.segment->Sync();
+        }
+        InsertOrDie(&results, req.segment, s);
+      }
+    }
+
+    // Complete the batch in FIFO order, so that a synchronous request acts
+    // as a barrier for all of the requests submitted before it.
+    for (const SyncRequest& req : reqs) {
+      req.callback.Run(FindOrDie(results, req.segment));
+    }
+  }
+
+  gscoped_ptr<ThreadPool> pool_;
+
+  // Protects 'drain_scheduled_' and 'pending_'.
+  simple_spinlock lock_;
+
+  // Whether a DrainAndSync() task is currently queued or running.
+  bool drain_scheduled_;
+
+  // Requests not yet picked up by a DrainAndSync() task.
+  std::vector<SyncRequest> pending_;
+
+  DISALLOW_COPY_AND_ASSIGN(WalSyncer);
+};
+
+namespace {
+
+// Registry of per-device syncers, keyed by WAL root directory. Entries live
+// for the remainder of the process: tablets come and go, but the device
+// their WALs share does not.
+GoogleOnceType g_wal_syncers_once = GOOGLE_ONCE_INIT;
+simple_spinlock* g_wal_syncers_lock = nullptr;
+std::unordered_map<string, WalSyncer*>* g_wal_syncers = nullptr;
+
+void InitWalSyncerRegistry() {
+  g_wal_syncers_lock = new simple_spinlock();
+  g_wal_syncers = new std::unordered_map<string, WalSyncer*>();
+}
+
+WalSyncer* GetWalSyncerForRoot(const string& wal_root) {
+  GoogleOnceInit(&g_wal_syncers_once, &InitWalSyncerRegistry);
+  std::lock_guard<simple_spinlock> l(*g_wal_syncers_lock);
+  WalSyncer*& syncer = (*g_wal_syncers)[wal_root];
+  if (syncer == nullptr) {
+    syncer = new WalSyncer();
+  }
+  return syncer;
+}
+
+} // anonymous namespace
+
 // Manages the thread which drains groups of batches from the log's queue and
 // appends them to the underlying log instance.
 //
@@ -233,6 +385,13 @@ class Log::AppendThread {
   // a new task was enqueued just as we were trying to go idle.
   bool GoIdle();
 
+  // If --log_group_commit_window_us is set, linger for up to that long,
+  // draining concurrently-appended batches into 'entry_batches' so that they
+  // are covered by a single sync. Returns immediately if the group already
+  // exceeds --log_group_commit_max_batch_bytes, which is the case whenever
+  // the queue is deep enough that lingering wouldn't reduce the sync rate.
+  void LingerForMoreBatches(vector<LogEntryBatch*>* entry_batches);
+
   // Handle the actual appending of a group of entries. Responsible for deleting the
   // LogEntryBatch* pointers.
   void HandleGroup(vector<LogEntryBatch*> entry_batches);
@@ -339,11 +498,39 @@ void Log::AppendThread::DoWork() {
       if (GoIdle()) break;
       continue;
     }
+    LingerForMoreBatches(&entry_batches);
     HandleGroup(std::move(entry_batches));
   }
   VLOG_WITH_PREFIX(2) << "WAL Appender going idle";
 }
 
+void Log::AppendThread::LingerForMoreBatches(vector<LogEntryBatch*>* entry_batches) {
+  int32_t window_us = FLAGS_log_group_commit_window_us;
+  if (window_us <= 0) return;
+
+  size_t max_bytes = FLAGS_log_group_commit_max_batch_bytes;
+  size_t group_bytes = 0;
+  for (const LogEntryBatch* batch : *entry_batches) {
+    group_bytes += batch->total_size_bytes();
+  }
+
+  MonoTime window_deadline = MonoTime::Now() + MonoDelta::FromMicroseconds(window_us);
+  while (group_bytes < max_bytes) {
+    vector<LogEntryBatch*> more;
+    Status s = log_->entry_queue()->BlockingDrainTo(&more, window_deadline);
+    if (PREDICT_FALSE(!s.ok())) {
+      // On timeout, the window has closed. On shutdown, process what we
+      // have; the caller's next drain will observe the abort.
+      break;
+    }
+    for (const LogEntryBatch* batch : more) {
+      group_bytes += batch->total_size_bytes();
+    }
+    std::move(more.begin(), more.end(), std::back_inserter(*entry_batches));
+    if (MonoTime::Now() >= window_deadline) break;
+  }
+}
+
 void Log::AppendThread::HandleGroup(vector<LogEntryBatch*> entry_batches) {
   if (log_->metrics_) {
     log_->metrics_->entry_batches_per_group->Increment(entry_batches.size());
@@ -469,6 +656,7 @@ Log::Log(LogOptions options, FsManager* fs_manager, string log_path,
       append_thread_(new AppendThread(this)),
       force_sync_all_(options_.force_fsync_all),
       sync_disabled_(false),
+      wal_syncer_(nullptr),
       allocation_state_(kAllocationNotStarted),
       codec_(nullptr),
       metric_entity_(metric_entity),
@@ -521,6 +709,10 @@ Status Log::Init() {
                           << "Log is configured to *not* fsync() on all Append() calls";
   }
 
+  if (FLAGS_log_per_device_wal_syncer && force_sync_all_) {
+    wal_syncer_ = GetWalSyncerForRoot(fs_manager_->GetWalsRootDir());
+  }
+
   // We always create a new segment when the log starts.
   RETURN_NOT_OK(AsyncAllocateSegment());
   RETURN_NOT_OK(allocation_status_.Get());
@@ -639,8 +831,10 @@ Status Log::DoAppend(LogEntryBatch* entry_batch) {
   }
 
   // if the size of this entry overflows the current segment, get a new one
+  bool exceeds_segment_size =
+      (active_segment_->Size() + entry_batch_bytes + 4) > max_segment_size_;
   if (allocation_state() == kAllocationNotStarted) {
-    if ((active_segment_->Size() + entry_batch_bytes + 4) > max_segment_size_) {
+    if (exceeds_segment_size) {
       LOG_WITH_PREFIX(INFO) << "Max segment size reached. Starting new segment allocation";
       RETURN_NOT_OK(AsyncAllocateSegment());
       if (!options_.async_preallocate_segments) {
@@ -650,10 +844,15 @@ Status Log::DoAppend(LogEntryBatch* entry_batch) {
       }
     }
   } else if (allocation_state() == kAllocationFinished) {
-    LOG_SLOW_EXECUTION(WARNING, 50, Substitute("$0Log roll took a long time", LogPrefix())) {
-      RETURN_NOT_OK(RollOver());
+    // Unless we're allocating segments ahead of time, a finished allocation
+    // implies the segment filled up and we should roll over to the allocated
+    // one. When allocating ahead, only roll once the segment is actually full.
+    if (exceeds_segment_size || !options_.preallocate_segments_ahead) {
+      LOG_SLOW_EXECUTION(WARNING, 50, Substitute("$0Log roll took a long time", LogPrefix())) {
+        RETURN_NOT_OK(RollOver());
+      }
     }
-  } else {
+  } else if (exceeds_segment_size) {
     VLOG_WITH_PREFIX(1) << "Segment allocation already in progress...";
   }
 
@@ -717,7 +916,11 @@ void Log::UpdateFooterForBatch(LogEntryBatch* batch) {
 }
 
 Status Log::AllocateSegmentAndRollOver() {
-  RETURN_NOT_OK(AsyncAllocateSegment());
+  // When allocating segments ahead of time the allocation may already be
+  // underway (or done), in which case RollOver() below waits for it.
+  if (allocation_state() == kAllocationNotStarted) {
+    RETURN_NOT_OK(AsyncAllocateSegment());
+  }
   return RollOver();
 }
 
@@ -741,7 +944,15 @@ Status Log::Sync() {
 
   if (force_sync_all_ && !sync_disabled_) {
     LOG_SLOW_EXECUTION(WARNING, 50, Substitute("$0Fsync log took a long time", LogPrefix())) {
-      RETURN_NOT_OK(active_segment_->Sync());
+      if (wal_syncer_ != nullptr) {
+        // Funnel the fsync() through the syncer shared with the other logs
+        // on this device rather than issuing it directly: requests from
+        // tablets committing concurrently are serviced as a batch instead of
+        // as duplicate overlapping fsync() calls contending for the device.
+        RETURN_NOT_OK(wal_syncer_->SyncSegment(active_segment_.get()));
+      } else {
+        RETURN_NOT_OK(active_segment_->Sync());
+      }
 
       if (log_hooks_) {
         RETURN_NOT_OK_PREPEND(log_hooks_->PostSyncIfFsyncEnabled(),
@@ -935,6 +1146,18 @@ Status Log::Close() {
   allocation_pool_->Shutdown();
   append_thread_->Shutdown();
 
+  // If a segment was allocated ahead of time but we never switched to it,
+  // delete the unused placeholder file.
+  {
+    std::lock_guard<RWMutex> l(allocation_lock_);
+    if (allocation_state_ == kAllocationFinished) {
+      next_segment_file_.reset();
+      WARN_NOT_OK(fs_manager_->env()->DeleteFile(next_segment_path_),
+                  LogPrefix() + "Unable to delete unused preallocated segment");
+      allocation_state_ = kAllocationNotStarted;
+    }
+  }
+
   std::lock_guard<percpu_rwlock> l(state_lock_);
   switch (log_state_) {
     case kLogWriting:
@@ -1084,6 +1307,13 @@ Status Log::SwitchToAllocatedSegment() {
 
   allocation_state_ = kAllocationNotStarted;
 
+  // When allocating ahead, immediately kick off the allocation of the next
+  // segment so that by the time this one fills up, rolling over only needs
+  // to rename the pre-created file and write its header.
+  if (options_.preallocate_segments_ahead && options_.async_preallocate_segments) {
+    RETURN_NOT_OK(AsyncAllocateSegment());
+  }
+
   return Status::OK();
 }
 
@@ -65,6 +65,7 @@ struct RetentionIndexes;
 class LogEntryBatch;
 class LogIndex;
 class LogReader;
+class WalSyncer;
 
 typedef BlockingQueue<LogEntryBatch*, LogEntryBatchLogicalSize> LogEntryBatchQueue;
 
@@ -393,6 +394,12 @@ class Log : public RefCountedThreadSafe<Log> {
   // This is used to disable fsync during bootstrap.
   bool sync_disabled_;
 
+  // Syncer shared by all logs under the same WAL root, used to serialize and
+  // batch fsync() calls to the underlying device. Set during Init() when
+  // --log_per_device_wal_syncer is enabled and fsync is in force; NULL
+  // otherwise. The pointed-to syncer lives for the remainder of the process.
+  WalSyncer* wal_syncer_;
+
   // The status of the most recent log-allocation action.
   Promise<Status> allocation_status_;
 
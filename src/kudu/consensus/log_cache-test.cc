@@ -60,6 +60,7 @@ using std::thread;
 using std::vector;
 using strings::Substitute;
 
+DECLARE_bool(log_cache_compress_evicted_ops);
 DECLARE_int32(log_cache_size_limit_mb);
 DECLARE_int32(global_log_cache_size_limit_mb);
 
@@ -177,6 +178,46 @@ TEST_F(LogCacheTest, TestAppendAndGetMessages) {
 }
 
 
+// Test the LZ4-compressed cold tier: evicted ops should be retained in
+// compressed form and inflated lazily when read back.
+TEST_F(LogCacheTest, TestCompressedColdTier) {
+  FLAGS_log_cache_compress_evicted_ops = true;
+
+  const int kPayloadSize = 10 * 1024;
+  ASSERT_OK(AppendReplicateMessagesToCache(1, 50, kPayloadSize));
+  log_->WaitUntilAllFlushed();
+
+  int64_t hot_size = cache_->BytesUsed();
+
+  // Evicting should move the ops to the cold tier rather than dropping
+  // them, and the (zero-filled) payloads should compress to a small
+  // fraction of their original footprint.
+  cache_->EvictThroughOp(50);
+  ASSERT_EQ(0, cache_->metrics_.log_cache_num_ops->value());
+  ASSERT_EQ(50, cache_->cold_cache_.size());
+  ASSERT_LT(cache_->BytesUsed(), hot_size / 2);
+
+  // Reads following eviction are served from the cold tier.
+  vector<ReplicateRefPtr> messages;
+  OpId preceding;
+  ASSERT_OK(cache_->ReadOps(0, 8 * 1024 * 1024, &messages, &preceding));
+  EXPECT_EQ(50, messages.size());
+  EXPECT_EQ("0.0", OpIdToString(preceding));
+  EXPECT_EQ("0.1", OpIdToString(messages[0]->get()->id()));
+  EXPECT_EQ(kPayloadSize,
+            messages[0]->get()->noop_request().payload_for_tests().size());
+
+  // So are OpId lookups.
+  OpId op;
+  ASSERT_OK(cache_->LookupOpId(49, &op));
+  EXPECT_EQ("7.49", OpIdToString(op));
+
+  // Overwriting operations must also truncate the cold tier.
+  messages.clear();
+  ASSERT_OK(AppendReplicateMessagesToCache(30, 1, kPayloadSize));
+  ASSERT_EQ(29, cache_->cold_cache_.size());
+}
+
 // Ensure that the cache always yields at least one message,
 // even if that message is larger than the batch size. This ensures
 // that we don't get "stuck" in the case that a large message enters
@@ -17,7 +17,9 @@
 
 #include "kudu/consensus/log_cache.h"
 
+#include <algorithm>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <ostream>
 #include <string>
@@ -37,16 +39,21 @@
 #include "kudu/consensus/ref_counted_replicate.h"
 #include "kudu/gutil/bind.h"
 #include "kudu/gutil/bind_helpers.h"
+#include "kudu/gutil/gscoped_ptr.h"
 #include "kudu/gutil/map-util.h"
+#include "kudu/gutil/port.h"
 #include "kudu/gutil/mathlimits.h"
 #include "kudu/gutil/strings/human_readable.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/compression/compression.pb.h"
+#include "kudu/util/compression/compression_codec.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/locks.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/mem_tracker.h"
 #include "kudu/util/metrics.h"
 #include "kudu/util/pb_util.h"
+#include "kudu/util/slice.h"
 
 DEFINE_int32(log_cache_size_limit_mb, 128,
              "The total per-tablet size of consensus entries which may be kept in memory. "
@@ -60,6 +67,16 @@ DEFINE_int32(global_log_cache_size_limit_mb, 1024,
              "caching log entries across all tablets is kept under this threshold.");
 TAG_FLAG(global_log_cache_size_limit_mb, advanced);
 
+DEFINE_bool(log_cache_compress_evicted_ops, false,
+            "Whether the log cache should retain evicted operations in an "
+            "LZ4-compressed cold tier rather than dropping them outright. "
+            "Compressed operations are inflated lazily when a lagging peer "
+            "reads them, which can avoid reading the on-disk log during "
+            "follower catch-up at the cost of some CPU. Cold operations are "
+            "dropped for real when the cache is under memory pressure.");
+TAG_FLAG(log_cache_compress_evicted_ops, experimental);
+TAG_FLAG(log_cache_compress_evicted_ops, runtime);
+
 using kudu::pb_util::SecureShortDebugString;
 using std::string;
 using std::vector;
@@ -115,6 +132,7 @@ LogCache::LogCache(const scoped_refptr<MetricEntity>& metric_entity,
 LogCache::~LogCache() {
   tracker_->Release(tracker_->consumption());
   cache_.clear();
+  cold_cache_.clear();
 }
 
 void LogCache::Init(const OpId& preceding_op) {
@@ -141,6 +159,11 @@ void LogCache::TruncateOpsAfterUnlocked(int64_t index) {
     ReplicateRefPtr msg = EraseKeyReturnValuePtr(&cache_, i);
     if (msg != nullptr) {
       AccountForMessageRemovalUnlocked(msg);
+    } else {
+      auto cold_iter = cold_cache_.find(i);
+      if (cold_iter != cold_cache_.end()) {
+        EvictColdMessageUnlocked(cold_iter);
+      }
     }
   }
   next_sequential_op_index_ = index + 1;
@@ -165,7 +188,7 @@ Status LogCache::AppendOperations(const vector<ReplicateRefPtr>& msgs,
 
   int64_t mem_required = 0;
   for (const auto& msg : msgs) {
-    mem_required += msg->get()->SpaceUsed();
+    mem_required += msg->SpaceUsedCached();
   }
 
   // Try to consume the memory. If it can't be consumed, we may need to evict.
@@ -270,6 +293,12 @@ Status LogCache::LookupOpId(int64_t op_index, OpId* op_id) const {
       *op_id = iter->second->get()->id();
       return Status::OK();
     }
+    auto cold_iter = cold_cache_.find(op_index);
+    if (cold_iter != cold_cache_.end()) {
+      op_id->set_term(cold_iter->second->term);
+      op_id->set_index(op_index);
+      return Status::OK();
+    }
   }
 
   // If it misses, read from the log.
@@ -306,6 +335,28 @@ Status LogCache::ReadOps(int64_t after_op_index,
     // load them.
     MessageCache::const_iterator iter = cache_.lower_bound(next_index);
     if (iter == cache_.end() || iter->first != next_index) {
+      // Check the compressed cold tier before falling back to disk.
+      auto cold_iter = cold_cache_.find(next_index);
+      if (cold_iter != cold_cache_.end()) {
+        // Hold a reference to the entry so that it stays alive even if it is
+        // concurrently evicted while we inflate it outside the lock.
+        std::shared_ptr<ColdMessage> cold = cold_iter->second;
+        l.unlock();
+        ReplicateMsg* msg = nullptr;
+        RETURN_NOT_OK_PREPEND(InflateColdMessage(*cold, &msg),
+                              Substitute("Failed to inflate cached op $0", next_index));
+        l.lock();
+
+        remaining_space -= TotalByteSizeForMessage(*msg);
+        if (remaining_space > 0 || messages->empty()) {
+          messages->push_back(make_scoped_refptr_replicate(msg));
+          next_index++;
+        } else {
+          delete msg;
+        }
+        continue;
+      }
+
       int64_t up_to;
       if (iter == cache_.end()) {
         // Read all the way to the current op
@@ -314,6 +365,12 @@ Status LogCache::ReadOps(int64_t after_op_index,
         // Read up to the next entry that's in the cache
         up_to = iter->first - 1;
       }
+      // Don't read past the next entry in the cold tier, either: those ops
+      // can be served from memory on the next time around the loop.
+      auto cold_next = cold_cache_.lower_bound(next_index);
+      if (cold_next != cold_cache_.end()) {
+        up_to = std::min<int64_t>(up_to, cold_next->first - 1);
+      }
 
       l.unlock();
 
@@ -400,19 +457,104 @@ void LogCache::EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evic
 
     VLOG_WITH_PREFIX_UNLOCKED(2) << "Evicting cache. Removing: " << msg->get()->id();
     AccountForMessageRemovalUnlocked(msg);
-    bytes_evicted += msg->get()->SpaceUsed();
+    bytes_evicted += msg->SpaceUsedCached();
+    if (PREDICT_FALSE(FLAGS_log_cache_compress_evicted_ops)) {
+      // Moving the message to the cold tier keeps some of its memory
+      // consumed, so it only counts partially toward the eviction target.
+      bytes_evicted -= MoveToColdTierUnlocked(msg);
+    }
     cache_.erase(iter++);
 
     if (bytes_evicted >= bytes_to_evict) {
       break;
     }
   }
+
+  // If that wasn't enough, we're under genuine memory pressure (rather than
+  // just advancing the watermark), so drop cold-tier entries for real,
+  // oldest first, until the trackers are back under their limits.
+  if (bytes_evicted < bytes_to_evict) {
+    for (auto iter = cold_cache_.begin();
+         iter != cold_cache_.end() &&
+         (tracker_->LimitExceeded() || parent_tracker_->LimitExceeded());) {
+      if (static_cast<int64_t>(iter->first) > stop_after_index) {
+        break;
+      }
+      bytes_evicted += sizeof(ColdMessage) + iter->second->compressed.capacity();
+      iter = EvictColdMessageUnlocked(iter);
+      if (bytes_evicted >= bytes_to_evict) {
+        break;
+      }
+    }
+  }
   VLOG_WITH_PREFIX_UNLOCKED(1) << "Evicting log cache: after state: " << ToStringUnlocked();
 }
 
+int64_t LogCache::MoveToColdTierUnlocked(const ReplicateRefPtr& msg) {
+  DCHECK(lock_.is_locked());
+
+  const CompressionCodec* codec;
+  Status s = GetCompressionCodec(LZ4, &codec);
+  if (PREDICT_FALSE(!s.ok())) {
+    KLOG_EVERY_N_SECS(WARNING, 60) << LogPrefixUnlocked()
+        << "Could not get LZ4 codec for log cache cold tier: " << s.ToString();
+    return 0;
+  }
+
+  faststring buf;
+  pb_util::AppendToString(*msg->get(), &buf);
+
+  auto cold = std::make_shared<ColdMessage>();
+  cold->term = msg->get()->id().term();
+  cold->uncompressed_size = buf.size();
+  cold->compressed.resize(codec->MaxCompressedLength(buf.size()));
+  size_t compressed_len = 0;
+  s = codec->Compress(Slice(buf), cold->compressed.data(), &compressed_len);
+  if (PREDICT_FALSE(!s.ok()) || compressed_len >= buf.size()) {
+    // Not worth retaining: either compression failed or the message is
+    // incompressible. Let it be evicted outright.
+    return 0;
+  }
+  cold->compressed.resize(compressed_len);
+  cold->compressed.shrink_to_fit();
+
+  int64_t cold_bytes = sizeof(ColdMessage) + cold->compressed.capacity();
+  InsertOrDie(&cold_cache_, msg->get()->id().index(), std::move(cold));
+  tracker_->Consume(cold_bytes);
+  metrics_.log_cache_size->IncrementBy(cold_bytes);
+  return cold_bytes;
+}
+
+LogCache::ColdMessageCache::iterator LogCache::EvictColdMessageUnlocked(
+    ColdMessageCache::iterator iter) {
+  DCHECK(lock_.is_locked());
+  int64_t cold_bytes = sizeof(ColdMessage) + iter->second->compressed.capacity();
+  tracker_->Release(cold_bytes);
+  metrics_.log_cache_size->DecrementBy(cold_bytes);
+  return cold_cache_.erase(iter);
+}
+
+Status LogCache::InflateColdMessage(const ColdMessage& cold, ReplicateMsg** msg) {
+  const CompressionCodec* codec;
+  RETURN_NOT_OK(GetCompressionCodec(LZ4, &codec));
+
+  faststring buf;
+  buf.resize(cold.uncompressed_size);
+  RETURN_NOT_OK(codec->Uncompress(Slice(cold.compressed),
+                                  buf.data(), cold.uncompressed_size));
+
+  gscoped_ptr<ReplicateMsg> m(new ReplicateMsg());
+  if (PREDICT_FALSE(!m->ParseFromArray(buf.data(), buf.size()))) {
+    return Status::Corruption("Unable to parse inflated ReplicateMsg");
+  }
+  *msg = m.release();
+  return Status::OK();
+}
+
 void LogCache::AccountForMessageRemovalUnlocked(const ReplicateRefPtr& msg) {
-  tracker_->Release(msg->get()->SpaceUsed());
-  metrics_.log_cache_size->DecrementBy(msg->get()->SpaceUsed());
+  int64_t space_used = msg->SpaceUsedCached();
+  tracker_->Release(space_used);
+  metrics_.log_cache_size->DecrementBy(space_used);
   metrics_.log_cache_num_ops->Decrement();
 }
 
@@ -426,9 +568,10 @@ string LogCache::StatsString() const {
 }
 
 string LogCache::StatsStringUnlocked() const {
-  return Substitute("LogCacheStats(num_ops=$0, bytes=$1)",
+  return Substitute("LogCacheStats(num_ops=$0, bytes=$1, cold_ops=$2)",
                     metrics_.log_cache_num_ops->value(),
-                    metrics_.log_cache_size->value());
+                    metrics_.log_cache_size->value(),
+                    cold_cache_.size());
 }
 
 std::string LogCache::ToString() const {
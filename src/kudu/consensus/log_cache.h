@@ -29,6 +29,7 @@
 #include "kudu/consensus/ref_counted_replicate.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/ref_counted.h"
+#include "kudu/util/faststring.h"
 #include "kudu/util/locks.h"
 #include "kudu/util/metrics.h"
 #include "kudu/util/status.h"
@@ -144,16 +145,46 @@ class LogCache {
 
  private:
   FRIEND_TEST(LogCacheTest, TestAppendAndGetMessages);
+  FRIEND_TEST(LogCacheTest, TestCompressedColdTier);
   FRIEND_TEST(LogCacheTest, TestGlobalMemoryLimit);
   FRIEND_TEST(LogCacheTest, TestReplaceMessages);
   FRIEND_TEST(LogCacheTest, TestTruncation);
   friend class LogCacheTest;
 
+  // A message which has been evicted from the hot cache but retained in
+  // compressed form. Its log index serves as its key in 'cold_cache_'.
+  struct ColdMessage {
+    // The term of the operation, kept so that LookupOpId() can answer
+    // without inflating the message.
+    int64_t term;
+
+    // Size of the serialized ReplicateMsg before compression.
+    int64_t uncompressed_size;
+
+    // The LZ4-compressed serialized ReplicateMsg.
+    faststring compressed;
+  };
+  typedef std::map<uint64_t, std::shared_ptr<ColdMessage>> ColdMessageCache;
+
   // Try to evict the oldest operations from the queue, stopping either when
   // 'bytes_to_evict' bytes have been evicted, or the op with index
   // 'stop_after_index' has been evicted, whichever comes first.
   void EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evict);
 
+  // Compress 'msg' and insert it into the cold tier, consuming the
+  // compressed size against the memtracker. Returns the number of bytes
+  // consumed, or 0 if the message did not compress to a smaller size (in
+  // which case it is not retained).
+  int64_t MoveToColdTierUnlocked(const ReplicateRefPtr& msg);
+
+  // Remove the cold-tier entry at 'iter', releasing its memory from the
+  // tracker. Returns an iterator to the following entry.
+  ColdMessageCache::iterator EvictColdMessageUnlocked(ColdMessageCache::iterator iter);
+
+  // Decompress and deserialize 'cold' into a newly-allocated message
+  // returned in '*msg'. The caller takes ownership.
+  static Status InflateColdMessage(const ColdMessage& cold, ReplicateMsg** msg);
+
   // Update metrics and MemTracker to account for the removal of the
   // given message.
   void AccountForMessageRemovalUnlocked(const ReplicateRefPtr& msg);
@@ -187,6 +218,13 @@ class LogCache {
   typedef std::map<uint64_t, ReplicateRefPtr> MessageCache;
   MessageCache cache_;
 
+  // Messages which have been evicted from 'cache_' but retained in
+  // LZ4-compressed form, keyed by log index. These are inflated lazily when
+  // a peer reads them, avoiding a trip to the on-disk log during follower
+  // catch-up. Only populated when --log_cache_compress_evicted_ops is
+  // enabled. An index is present in at most one of 'cache_' and this map.
+  ColdMessageCache cold_cache_;
+
   // The next log index to append. Each append operation must either
   // start with this log index, or go backward (but never skip forward).
   int64_t next_sequential_op_index_;
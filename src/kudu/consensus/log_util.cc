@@ -61,6 +61,15 @@ DEFINE_bool(log_async_preallocate_segments, true,
             "Whether the WAL segments preallocation should happen asynchronously");
 TAG_FLAG(log_async_preallocate_segments, advanced);
 
+DEFINE_bool(log_preallocate_segments_ahead, false,
+            "Whether the WAL should allocate and preallocate the next segment as soon "
+            "as the current one is opened, rather than when it fills up, so that "
+            "rolling over never waits on file creation or preallocation. This keeps "
+            "one extra pre-sized segment file on disk per tablet. Only takes effect "
+            "when --log_async_preallocate_segments is also set.");
+TAG_FLAG(log_preallocate_segments_ahead, advanced);
+TAG_FLAG(log_preallocate_segments_ahead, experimental);
+
 DEFINE_double(fault_crash_before_write_log_segment_header, 0.0,
               "Fraction of the time we will crash just before writing the log segment header");
 TAG_FLAG(fault_crash_before_write_log_segment_header, unsafe);
@@ -101,7 +110,8 @@ LogOptions::LogOptions()
 : segment_size_mb(FLAGS_log_segment_size_mb),
   force_fsync_all(FLAGS_log_force_fsync_all),
   preallocate_segments(FLAGS_log_preallocate_segments),
-  async_preallocate_segments(FLAGS_log_async_preallocate_segments) {
+  async_preallocate_segments(FLAGS_log_async_preallocate_segments),
+  preallocate_segments_ahead(FLAGS_log_preallocate_segments_ahead) {
 }
 
 ////////////////////////////////////////////////////////////
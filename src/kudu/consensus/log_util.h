@@ -72,6 +72,13 @@ struct LogOptions {
   // Whether the allocation should happen asynchronously.
   bool async_preallocate_segments;
 
+  // Whether to allocate the next segment as soon as the current one is
+  // opened, instead of when the current one fills up. This makes rolling
+  // over a metadata-only operation (rename plus header write) at the cost
+  // of keeping one extra pre-sized segment file on disk per tablet.
+  // Only takes effect when 'async_preallocate_segments' is set.
+  bool preallocate_segments_ahead;
+
   LogOptions();
 };
 
@@ -300,8 +300,15 @@ Status RaftConsensus::Start(const ConsensusBootstrapInfo& info,
                                    << SecureShortDebugString(cmeta_->ActiveConfig());
     for (ReplicateMsg* replicate : info.orphaned_replicates) {
       ReplicateRefPtr replicate_ptr = make_scoped_refptr_replicate(new ReplicateMsg(*replicate));
-      RETURN_NOT_OK(StartReplicaTransactionUnlocked(replicate_ptr));
+      Status s = StartReplicaTransactionUnlocked(replicate_ptr);
+      if (PREDICT_FALSE(!s.ok())) {
+        // Transactions which were already started must still have their
+        // prepare phase kicked off so that they can be aborted.
+        txn_factory_->FinishReplicaTransactionBatch();
+        return s;
+      }
     }
+    txn_factory_->FinishReplicaTransactionBatch();
 
     // Set the initial committed opid for the PendingRounds only after
     // appending any uncommitted replicate messages to the queue.
@@ -1346,12 +1353,23 @@ Status RaftConsensus::UpdateReplica(const ConsensusRequestPB* request,
       if (PREDICT_FALSE(!prepare_status.ok())) {
         break;
       }
-      // TODO(dralves) Without leader leases this shouldn't be a allowed to fail.
-      // Once we have that functionality we'll have to revisit this.
-      CHECK_OK(time_manager_->MessageReceivedFromLeader(*(*iter)->get()));
       ++iter;
     }
 
+    // Update the clock and the time manager with the timestamps of all the
+    // messages that were started above, in one call for the whole batch
+    // rather than taking the clock and time manager locks once per message.
+    // TODO(dralves) Without leader leases this shouldn't be a allowed to fail.
+    // Once we have that functionality we'll have to revisit this.
+    CHECK_OK(time_manager_->MessagesReceivedFromLeader(
+        deduped_req.messages, iter - deduped_req.messages.begin()));
+
+    // Kick off the prepare phase of all the transactions started above as a
+    // single unit. This must happen whether or not we managed to start all
+    // of them: transactions already started must prepare so that they can be
+    // continued (or aborted) later.
+    txn_factory_->FinishReplicaTransactionBatch();
+
     // If we stopped before reaching the end we failed to prepare some message(s) and need
     // to perform cleanup, namely trimming deduped_req.messages to only contain the messages
     // that were actually prepared, and deleting the other ones since we've taken ownership
@@ -2218,6 +2236,12 @@ RaftPeerPB::Role RaftConsensus::role() const {
   return cmeta_->active_role();
 }
 
+MonoTime RaftConsensus::LeaderLeaseDeadline() const {
+  // The queue tracks leadership itself and returns MonoTime::Min() when it
+  // is not in leader mode, so no consensus lock is needed here.
+  return queue_->GetLeaderLeaseDeadline();
+}
+
 int64_t RaftConsensus::CurrentTerm() const {
   LockGuard l(lock_);
   return CurrentTermUnlocked();
@@ -274,6 +274,13 @@ class RaftConsensus : public std::enable_shared_from_this<RaftConsensus>,
   // Returns the current Raft role of this instance.
   RaftPeerPB::Role role() const;
 
+  // If this replica is the leader, returns the time until which its
+  // leadership is guarded by vote withholding on a majority of voters;
+  // see PeerMessageQueue::GetLeaderLeaseDeadline(). Returns
+  // MonoTime::Min() if this replica is not the leader or holds no such
+  // guarantee.
+  MonoTime LeaderLeaseDeadline() const;
+
   // Returns the current term.
   int64_t CurrentTerm() const;
 
@@ -911,6 +918,15 @@ class ReplicaTransactionFactory {
  public:
   virtual Status StartReplicaTransaction(const scoped_refptr<ConsensusRound>& context) = 0;
 
+  // Called once after a run of consecutive StartReplicaTransaction() calls
+  // made on behalf of a single consensus request or log replay pass. This
+  // gives the factory the opportunity to defer kicking off the prepare phase
+  // of the started transactions and submit them as a single unit, rather
+  // than paying one prepare pool submission per transaction. The default
+  // implementation does nothing, for factories which start transactions
+  // eagerly.
+  virtual void FinishReplicaTransactionBatch() {}
+
   virtual ~ReplicaTransactionFactory() {}
 };
 
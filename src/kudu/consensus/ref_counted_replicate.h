@@ -18,7 +18,10 @@
 #ifndef KUDU_CONSENSUS_REF_COUNTED_REPLICATE_H_
 #define KUDU_CONSENSUS_REF_COUNTED_REPLICATE_H_
 
+#include <cstdint>
+
 #include "kudu/consensus/consensus.pb.h"
+#include "kudu/gutil/port.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/gutil/gscoped_ptr.h"
 
@@ -28,14 +31,32 @@ namespace consensus {
 // A simple ref-counted wrapper around ReplicateMsg.
 class RefCountedReplicate : public RefCountedThreadSafe<RefCountedReplicate> {
  public:
-  explicit RefCountedReplicate(ReplicateMsg* msg) : msg_(msg) {}
+  explicit RefCountedReplicate(ReplicateMsg* msg) : msg_(msg), space_used_cached_(0) {}
 
   ReplicateMsg* get() {
     return msg_.get();
   }
 
+  // Returns the heap space used by the wrapped message, equivalent to
+  // msg->SpaceUsed(). The value is computed on the first call and memoized:
+  // SpaceUsed() walks the entire message tree, and callers such as the log
+  // cache consult the size of a message several times over its lifetime.
+  //
+  // Memoizing also guarantees that memory-tracker consumption and release
+  // are symmetric, even if the message were mutated in between.
+  //
+  // The message must not be mutated concurrently with (or after) the first
+  // call.
+  int64_t SpaceUsedCached() {
+    if (PREDICT_FALSE(space_used_cached_ == 0)) {
+      space_used_cached_ = msg_->SpaceUsed();
+    }
+    return space_used_cached_;
+  }
+
  private:
   gscoped_ptr<ReplicateMsg> msg_;
+  int64_t space_used_cached_;
 };
 
 typedef scoped_refptr<RefCountedReplicate> ReplicateRefPtr;
@@ -26,6 +26,7 @@
 #include "kudu/clock/hybrid_clock.h"
 #include "kudu/common/timestamp.h"
 #include "kudu/consensus/consensus.pb.h"
+#include "kudu/consensus/ref_counted_replicate.h"
 #include "kudu/consensus/time_manager.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/util/countdown_latch.h"
@@ -204,5 +205,33 @@ TEST_F(TimeManagerTest, TestTimeManagerLeaderMode) {
   after_latch->Wait();
 }
 
+// Tests that the batched version of MessageReceivedFromLeader() is equivalent to
+// processing each message individually.
+TEST_F(TimeManagerTest, TestBatchedMessagesFromLeader) {
+  InitTimeManager();
+  Timestamp base = clock_->Now();
+
+  std::vector<ReplicateRefPtr> messages;
+  for (int i = 0; i < 3; i++) {
+    auto* msg = new ReplicateMsg();
+    msg->set_timestamp(base.value() + 10 + i);
+    messages.push_back(make_scoped_refptr_replicate(msg));
+  }
+
+  // Process only the first two messages of the batch: the last serial timestamp
+  // should be that of the second message and the clock should have moved past it.
+  ASSERT_OK(time_manager_->MessagesReceivedFromLeader(messages, 2));
+  ASSERT_EQ(time_manager_->last_serial_ts_assigned_.value(), base.value() + 11);
+  ASSERT_GT(clock_->Now().value(), base.value() + 11);
+
+  // An empty batch is a no-op.
+  ASSERT_OK(time_manager_->MessagesReceivedFromLeader(messages, 0));
+  ASSERT_EQ(time_manager_->last_serial_ts_assigned_.value(), base.value() + 11);
+
+  // The full batch moves the last serial timestamp to the final message's.
+  ASSERT_OK(time_manager_->MessagesReceivedFromLeader(messages, messages.size()));
+  ASSERT_EQ(time_manager_->last_serial_ts_assigned_.value(), base.value() + 12);
+}
+
 } // namespace consensus
 } // namespace kudu
@@ -137,6 +137,38 @@ Status TimeManager::MessageReceivedFromLeader(const ReplicateMsg& message) {
   return Status::OK();
 }
 
+Status TimeManager::MessagesReceivedFromLeader(const std::vector<ReplicateRefPtr>& messages,
+                                               size_t num_messages) {
+  DCHECK_LE(num_messages, messages.size());
+  if (num_messages == 0) return Status::OK();
+
+  // Since Clock::Update() only ever moves the clock forward, updating it once
+  // with the maximum timestamp of the batch is equivalent to updating it with
+  // each message's timestamp in turn.
+  Timestamp max_timestamp = Timestamp::kMin;
+  Timestamp last_serial_ts = Timestamp::kInvalidTimestamp;
+  for (size_t i = 0; i < num_messages; i++) {
+    const ReplicateMsg* message = messages[i]->get();
+    DCHECK(message->has_timestamp());
+    Timestamp t(message->timestamp());
+    if (max_timestamp < t) {
+      max_timestamp = t;
+    }
+    if (GetMessageConsistencyMode(*message) == CLIENT_PROPAGATED) {
+      last_serial_ts = t;
+    }
+  }
+  RETURN_NOT_OK(clock_->Update(max_timestamp));
+  {
+    Lock l(lock_);
+    CHECK_EQ(mode_, NON_LEADER) << "Cannot receive messages from a leader in leader mode.";
+    if (last_serial_ts != Timestamp::kInvalidTimestamp) {
+      last_serial_ts_assigned_ = last_serial_ts;
+    }
+  }
+  return Status::OK();
+}
+
 void TimeManager::AdvanceSafeTimeWithMessage(const ReplicateMsg& message) {
   Lock l(lock_);
   if (GetMessageConsistencyMode(message) == CLIENT_PROPAGATED) {
@@ -24,6 +24,7 @@
 #include "kudu/clock/clock.h"
 #include "kudu/common/common.pb.h"
 #include "kudu/common/timestamp.h"
+#include "kudu/consensus/ref_counted_replicate.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/util/locks.h"
 #include "kudu/util/monotime.h"
@@ -102,6 +103,15 @@ class TimeManager : public RefCountedThreadSafe<TimeManager> {
   // Requires non-leader mode (CHECK failure if it isn't).
   Status MessageReceivedFromLeader(const ReplicateMsg& message);
 
+  // Batch equivalent of MessageReceivedFromLeader(): updates the internal
+  // state based on the first 'num_messages' entries of 'messages', updating
+  // the clock and taking the internal lock only once for the whole batch
+  // rather than once per message.
+  //
+  // Requires non-leader mode (CHECK failure if it isn't).
+  Status MessagesReceivedFromLeader(const std::vector<ReplicateRefPtr>& messages,
+                                    size_t num_messages);
+
   // Advances safe time based on the timestamp and type of 'message'.
   //
   // This only moves safe time if 'message's timestamp is higher than the currently known one.
@@ -141,6 +151,7 @@ class TimeManager : public RefCountedThreadSafe<TimeManager> {
  private:
   FRIEND_TEST(TimeManagerTest, TestTimeManagerNonLeaderMode);
   FRIEND_TEST(TimeManagerTest, TestTimeManagerLeaderMode);
+  FRIEND_TEST(TimeManagerTest, TestBatchedMessagesFromLeader);
 
   // Returns whether we've advanced safe time recently.
   // If this returns false we might be partitioned or there might be election churn.
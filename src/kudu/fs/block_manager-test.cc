@@ -76,6 +76,8 @@ DECLARE_int64(fs_data_dirs_reserved_bytes);
 DECLARE_int64(disk_reserved_bytes_free_for_testing);
 DECLARE_int32(fs_data_dirs_full_disk_cache_seconds);
 DECLARE_int32(fs_target_data_dirs_per_tablet);
+DECLARE_bool(block_manager_evict_written_data);
+DECLARE_int32(block_manager_background_write_mb_per_sec);
 DECLARE_string(block_manager);
 DECLARE_double(env_inject_eio);
 DECLARE_bool(crash_on_eio);
@@ -455,6 +457,15 @@ TYPED_TEST(BlockManagerTest, EndToEndTest) {
   ASSERT_EQ(test_data.substr(0, size1), data1);
   ASSERT_EQ(test_data.substr(size1, size2), data2);
 
+  // Read the data back as a batch of ranges.
+  vector<ReadRange> ranges = {
+    { 0, data1 },
+    { size1, data2 },
+  };
+  ASSERT_OK(read_block->ReadBatch(ranges));
+  ASSERT_EQ(test_data.substr(0, size1), ranges[0].data);
+  ASSERT_EQ(test_data.substr(size1, size2), ranges[1].data);
+
   // We don't actually do anything with the result of this call; we just want
   // to make sure it doesn't trigger a crash (see KUDU-1931).
   LOG(INFO) << "Block memory footprint: " << read_block->memory_footprint();
@@ -470,6 +481,42 @@ TYPED_TEST(BlockManagerTest, EndToEndTest) {
               .IsNotFound());
 }
 
+// Test that writes issued under ScopedBackgroundBlockWrites are rate-limited
+// by --block_manager_background_write_mb_per_sec while foreground writes
+// are not.
+TYPED_TEST(BlockManagerTest, BackgroundWriteThrottlingTest) {
+  FLAGS_block_manager_background_write_mb_per_sec = 1;
+
+  const string chunk(64 * 1024, 'x');
+  const int kNumChunks = 4;
+
+  // A foreground write of the same size is not throttled.
+  ASSERT_FALSE(fs::ScopedBackgroundBlockWrites::on_current_thread());
+  unique_ptr<WritableBlock> fg_block;
+  ASSERT_OK(this->bm_->CreateBlock(this->test_block_opts_, &fg_block));
+  for (int i = 0; i < kNumChunks; i++) {
+    ASSERT_OK(fg_block->Append(chunk));
+  }
+  ASSERT_OK(fg_block->Close());
+
+  // 256KB at 1MB/s should take roughly 250ms; allow generous slop for
+  // scheduling delays but make sure the throttle actually bit.
+  unique_ptr<WritableBlock> bg_block;
+  ASSERT_OK(this->bm_->CreateBlock(this->test_block_opts_, &bg_block));
+  MonoTime start = MonoTime::Now();
+  {
+    fs::ScopedBackgroundBlockWrites bg;
+    ASSERT_TRUE(fs::ScopedBackgroundBlockWrites::on_current_thread());
+    for (int i = 0; i < kNumChunks; i++) {
+      ASSERT_OK(bg_block->Append(chunk));
+    }
+  }
+  ASSERT_FALSE(fs::ScopedBackgroundBlockWrites::on_current_thread());
+  MonoDelta elapsed = MonoTime::Now() - start;
+  ASSERT_GE(elapsed.ToMilliseconds(), 150);
+  ASSERT_OK(bg_block->Close());
+}
+
 TYPED_TEST(BlockManagerTest, CreateBlocksInDataDirs) {
   // Create a block before creating a data dir group.
   CreateBlockOptions fake_block_opts({ "fake_tablet_name" });
@@ -520,6 +567,25 @@ TYPED_TEST(BlockManagerTest, ReadAfterDeleteTest) {
   ASSERT_EQ(test_data, data);
 }
 
+TYPED_TEST(BlockManagerTest, EvictWrittenDataTest) {
+  // Evicting written data from the page cache must not affect what's
+  // subsequently read back from the block.
+  FLAGS_block_manager_evict_written_data = true;
+
+  unique_ptr<WritableBlock> written_block;
+  ASSERT_OK(this->bm_->CreateBlock(this->test_block_opts_, &written_block));
+  string test_data = "test data";
+  ASSERT_OK(written_block->Append(test_data));
+  ASSERT_OK(written_block->Close());
+
+  unique_ptr<ReadableBlock> read_block;
+  ASSERT_OK(this->bm_->OpenBlock(written_block->id(), &read_block));
+  gscoped_ptr<uint8_t[]> scratch(new uint8_t[test_data.length()]);
+  Slice data(scratch.get(), test_data.length());
+  ASSERT_OK(read_block->Read(0, data));
+  ASSERT_EQ(test_data, data);
+}
+
 TYPED_TEST(BlockManagerTest, CloseTwiceTest) {
   // Create a new block and close it repeatedly.
   unique_ptr<WritableBlock> written_block;
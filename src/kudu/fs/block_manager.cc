@@ -17,6 +17,7 @@
 
 #include "kudu/fs/block_manager.h"
 
+#include <algorithm>
 #include <mutex>
 #include <ostream>
 
@@ -24,9 +25,12 @@
 #include <glog/logging.h>
 
 #include "kudu/gutil/macros.h"
+#include "kudu/gutil/port.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/util/env.h"
 #include "kudu/util/flag_tags.h"
+#include "kudu/util/monotime.h"
+#include "kudu/util/throttler.h"
 
 // The default value is optimized for throughput in the case that
 // there are multiple drives backing the tablet. By asynchronously
@@ -49,6 +53,28 @@ DEFINE_string(block_manager_preflush_control, "finalize",
               "never be pre-flushed but still be flushed when closed.");
 TAG_FLAG(block_manager_preflush_control, experimental);
 
+DEFINE_bool(block_manager_evict_written_data, false,
+            "Whether to evict a block's data from the kernel page cache once "
+            "the block has been written and made durable. All block writes "
+            "are background maintenance operations (flushes and compactions), "
+            "so enabling this keeps large background writes from pushing hot, "
+            "already-cached data out of the page cache, at the cost of "
+            "re-reading the new blocks from disk if they are scanned soon "
+            "after being written. Has no effect unless "
+            "--enable_data_block_fsync is also enabled, since dirty pages "
+            "cannot be evicted.");
+TAG_FLAG(block_manager_evict_written_data, advanced);
+TAG_FLAG(block_manager_evict_written_data, experimental);
+
+DEFINE_bool(block_manager_direct_io_reads, false,
+            "Whether to bypass the kernel page cache when reading data "
+            "blocks (O_DIRECT). Avoids double-buffering data that is already "
+            "cached by the Kudu block cache, which can account for a large "
+            "fraction of the process RSS on hosts with fast storage. "
+            "Currently only supported by the file block manager.");
+TAG_FLAG(block_manager_direct_io_reads, advanced);
+TAG_FLAG(block_manager_direct_io_reads, experimental);
+
 DEFINE_bool(block_manager_lock_dirs, true,
             "Lock the data block directories to prevent concurrent usage. "
             "Note that read-only concurrent usage is still allowed.");
@@ -71,6 +97,18 @@ static bool ValidateMaxOpenFiles(const char* /*flagname*/, int64_t value) {
 }
 DEFINE_validator(block_manager_max_open_files, &ValidateMaxOpenFiles);
 
+DEFINE_int32(block_manager_background_write_mb_per_sec, 0,
+             "Maximum aggregate rate, in megabytes per second, of data block "
+             "writes issued by low-priority background operations "
+             "(compactions and tablet copies). WAL appends and memstore "
+             "flushes are never throttled. Bounding background writes keeps "
+             "bursts of compaction I/O from queueing ahead of WAL fsyncs on "
+             "hosts where the WAL shares a device with the data directories. "
+             "If 0, background writes are not throttled. The rate is read "
+             "once, when the first throttled write is issued.");
+TAG_FLAG(block_manager_background_write_mb_per_sec, advanced);
+TAG_FLAG(block_manager_background_write_mb_per_sec, experimental);
+
 using strings::Substitute;
 
 namespace kudu {
@@ -79,6 +117,47 @@ namespace fs {
 BlockManagerOptions::BlockManagerOptions()
   : read_only(false) {}
 
+__thread bool ScopedBackgroundBlockWrites::tls_marked_ = false;
+
+ScopedBackgroundBlockWrites::ScopedBackgroundBlockWrites()
+    : marked_(!tls_marked_) {
+  tls_marked_ = true;
+}
+
+ScopedBackgroundBlockWrites::~ScopedBackgroundBlockWrites() {
+  if (marked_) {
+    tls_marked_ = false;
+  }
+}
+
+void MaybeThrottleBackgroundBlockWrite(size_t num_bytes) {
+  if (PREDICT_TRUE(!ScopedBackgroundBlockWrites::on_current_thread() ||
+                   FLAGS_block_manager_background_write_mb_per_sec <= 0)) {
+    return;
+  }
+
+  const uint64_t bytes_per_sec =
+      static_cast<uint64_t>(FLAGS_block_manager_background_write_mb_per_sec) * 1024 * 1024;
+
+  // Shared by all background writers so that the configured rate bounds the
+  // process-wide aggregate, not each thread individually.
+  static Throttler* throttler = new Throttler(MonoTime::Now(), 0, bytes_per_sec, 1.0);
+
+  // The throttler refills its token bucket once per refill period, so a
+  // single Take() can never succeed for more than one period's worth of
+  // bytes; larger writes are metered out in period-sized chunks.
+  const uint64_t max_chunk = std::max<uint64_t>(
+      1, bytes_per_sec * Throttler::kRefillPeriodMicros / MonoTime::kMicrosecondsPerSecond);
+  uint64_t remaining = num_bytes;
+  while (remaining > 0) {
+    uint64_t chunk = std::min(remaining, max_chunk);
+    while (!throttler->Take(MonoTime::Now(), 0, chunk)) {
+      SleepFor(MonoDelta::FromMicroseconds(Throttler::kRefillPeriodMicros / 2));
+    }
+    remaining -= chunk;
+  }
+}
+
 int64_t GetFileCacheCapacityForBlockManager(Env* env) {
   // Maximize this process' open file limit first, if possible.
   static std::once_flag once;
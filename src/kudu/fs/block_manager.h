@@ -23,6 +23,7 @@
 #include <string>
 #include <vector>
 
+#include "kudu/gutil/macros.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/util/metrics.h"
 #include "kudu/util/status.h"
@@ -33,6 +34,9 @@ class BlockId;
 class Env;
 class MemTracker;
 class Slice;
+struct ReadRange;
+
+enum FileAccessPattern : uint8_t; // defined in kudu/util/env.h
 
 template <typename T>
 class ArrayView;
@@ -162,16 +166,82 @@ class ReadableBlock : public Block {
   // If an error was encountered, returns a non-OK status.
   virtual Status ReadV(uint64_t offset, ArrayView<Slice> results) const = 0;
 
+  // Reads a batch of byte ranges from the block, each into its own
+  // preallocated buffer. The offsets in 'ranges' are relative to the start
+  // of the block and should be sorted in ascending order. Where the
+  // underlying storage allows it, contiguous ranges are read with a single
+  // vectored read syscall. See RWFile::ReadBatch().
+  // If an error was encountered, returns a non-OK status.
+  virtual Status ReadBatch(ArrayView<ReadRange> ranges) const = 0;
+
+  // Hint that the given byte range of the block will soon be read, allowing
+  // the implementation to begin readahead of it asynchronously. Purely
+  // advisory: implementations may ignore it, and the range is clamped to the
+  // block's extent.
+  virtual Status ReadAhead(uint64_t /*offset*/, size_t /*length*/) const {
+    return Status::OK();
+  }
+
+  // Hint the expected pattern of future reads of this block (sequential
+  // streaming vs. scattered point reads), allowing the implementation to
+  // tune kernel readahead for the underlying file. Purely advisory;
+  // see RandomAccessFile::HintAccessPattern().
+  virtual Status HintAccessPattern(FileAccessPattern /*pattern*/) const {
+    return Status::OK();
+  }
+
   // Returns the memory usage of this object including the object itself.
   virtual size_t memory_footprint() const = 0;
 };
 
+// Marks all block writes issued by the current thread as low-priority
+// background I/O for as long as it is in scope.
+//
+// Background writes are subject to the
+// --block_manager_background_write_mb_per_sec throttle, which bounds the
+// rate at which large maintenance operations fill the kernel's device
+// queue. WAL appends never pass through a block manager and memstore
+// flushes don't mark themselves as background, so on a host where the WAL
+// shares a device with the data directories the effective write priority
+// is WAL first, then flushes, then the marked background operations
+// (compactions and tablet copies).
+class ScopedBackgroundBlockWrites {
+ public:
+  ScopedBackgroundBlockWrites();
+  ~ScopedBackgroundBlockWrites();
+
+  // Returns true if the current thread is marked as issuing background
+  // block writes.
+  static bool on_current_thread() { return tls_marked_; }
+
+ private:
+  static __thread bool tls_marked_;
+
+  // Whether this instance did the marking; nested scopes are no-ops.
+  const bool marked_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedBackgroundBlockWrites);
+};
+
+// If the current thread is marked as issuing background block writes and
+// --block_manager_background_write_mb_per_sec is set, delays the calling
+// thread as necessary to keep the aggregate background write rate at or
+// below the configured one. 'num_bytes' is the size of the write about to
+// be issued.
+void MaybeThrottleBackgroundBlockWrite(size_t num_bytes);
+
 // Provides options and hints for block placement. This is used for identifying
 // the correct DataDirGroups to place blocks. In the future this may also be
 // used to specify directories based on block type (e.g. to prefer bloom block
 // placement into SSD-backed directories).
 struct CreateBlockOptions {
   const std::string tablet_id;
+
+  // The expected total size of the block's data in bytes, or 0 if not known.
+  // Serves as a hint to the block manager, which may use it to preallocate
+  // the block's on-disk space contiguously up front rather than growing it
+  // in fixed-size chunks as data is appended.
+  const int64_t expected_size;
 };
 
 // Block manager creation options.
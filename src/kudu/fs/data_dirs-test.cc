@@ -15,12 +15,14 @@
 // specific language governing permissions and limitations
 // under the License.
 
+#include <atomic>
 #include <cmath>
 #include <cstdint>
 #include <memory>
 #include <ostream>
 #include <set>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -32,11 +34,14 @@
 #include "kudu/fs/block_manager.h"
 #include "kudu/fs/data_dirs.h"
 #include "kudu/fs/fs.pb.h"
+#include "kudu/gutil/bind.h"
+#include "kudu/gutil/bind_helpers.h"
 #include "kudu/gutil/casts.h"
 #include "kudu/gutil/map-util.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/gutil/strings/join.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/countdown_latch.h"
 #include "kudu/util/env.h"
 #include "kudu/util/env_util.h"
 #include "kudu/util/metrics.h"
@@ -188,6 +193,80 @@ TEST_F(DataDirsTest, TestDeleteDataDirGroup) {
                                     "registered for tablet");
 }
 
+TEST_F(DataDirsTest, TestCoalescedSync) {
+  DataDir* dd = dd_manager_->data_dirs()[0].get();
+
+  // A lone request runs its sync function exactly once and propagates the
+  // resulting status.
+  int runs = 0;
+  ASSERT_OK(dd->CoalescedSync(&runs, [&]() { runs++; return Status::OK(); }));
+  ASSERT_EQ(1, runs);
+  Status s = dd->CoalescedSync(&runs, [&]() {
+    runs++;
+    return Status::IOError("injected");
+  });
+  ASSERT_TRUE(s.IsIOError()) << s.ToString();
+  ASSERT_EQ(2, runs);
+
+  // Many concurrent requests sharing one token all complete successfully,
+  // and the sync function never runs more than once per request.
+  const int kNumThreads = 8;
+  const int kItersPerThread = 100;
+  std::atomic<int> sync_calls(0);
+  int token;
+  vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([&]() {
+      for (int j = 0; j < kItersPerThread; j++) {
+        CHECK_OK(dd->CoalescedSync(&token, [&]() {
+          sync_calls++;
+          return Status::OK();
+        }));
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_GE(sync_calls.load(), 1);
+  ASSERT_LE(sync_calls.load(), kNumThreads * kItersPerThread);
+}
+
+TEST_F(DataDirsTest, TestLoadAwareSelection) {
+  ASSERT_OK(dd_manager_->CreateDataDirGroup(test_tablet_name_));
+
+  // Find the dirs in the tablet's directory group.
+  vector<DataDir*> group_dds;
+  for (const auto& e : dd_manager_->tablets_by_uuid_idx_map_) {
+    if (!e.second.empty()) {
+      group_dds.push_back(FindOrDie(dd_manager_->data_dir_by_uuid_idx_, e.first));
+    }
+  }
+  ASSERT_GT(group_dds.size(), 1);
+
+  // Pile blocked I/O tasks onto every member of the group but the first:
+  // one closure to occupy the pool's thread and one to sit in its queue.
+  DataDir* idle_dd = group_dds[0];
+  CountDownLatch latch(1);
+  for (size_t i = 1; i < group_dds.size(); i++) {
+    for (int j = 0; j < 2; j++) {
+      group_dds[i]->ExecClosure(Bind(&CountDownLatch::Wait, Unretained(&latch)));
+    }
+  }
+
+  // Selection should consistently prefer the only idle directory.
+  for (int i = 0; i < 10; i++) {
+    DataDir* dd = nullptr;
+    ASSERT_OK(dd_manager_->GetNextDataDir(test_block_opts_, &dd));
+    ASSERT_EQ(idle_dd, dd);
+  }
+
+  latch.CountDown();
+  for (DataDir* dd : group_dds) {
+    dd->WaitOnClosures();
+  }
+}
+
 TEST_F(DataDirsTest, TestFullDisk) {
   FLAGS_fs_data_dirs_full_disk_cache_seconds = 0;       // Don't cache device fullness.
   FLAGS_fs_data_dirs_reserved_bytes = 1;                // Reserved space.
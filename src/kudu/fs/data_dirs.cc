@@ -46,6 +46,7 @@
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/strings/join.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/countdown_latch.h"
 #include "kudu/util/env.h"
 #include "kudu/util/env_util.h"
 #include "kudu/util/flag_tags.h"
@@ -95,6 +96,22 @@ DEFINE_bool(fs_lock_data_dirs, true,
 TAG_FLAG(fs_lock_data_dirs, unsafe);
 TAG_FLAG(fs_lock_data_dirs, evolving);
 
+DEFINE_bool(fs_data_dirs_load_aware_selection, true,
+            "Whether to consider each data directory's outstanding I/O work "
+            "when placing new blocks. When enabled, block placement prefers "
+            "the directory in the tablet's directory group with the fewest "
+            "queued I/O tasks, so slow or busy disks shed new write load. "
+            "When disabled, a directory is chosen at random.");
+TAG_FLAG(fs_data_dirs_load_aware_selection, advanced);
+TAG_FLAG(fs_data_dirs_load_aware_selection, runtime);
+
+DEFINE_bool(fs_data_dirs_coalesce_fsyncs, true,
+            "Whether to coalesce concurrent file synchronization requests "
+            "against the same data directory into batched fsync() calls. "
+            "If disabled, every request issues its own syscall.");
+TAG_FLAG(fs_data_dirs_coalesce_fsyncs, advanced);
+TAG_FLAG(fs_data_dirs_coalesce_fsyncs, runtime);
+
 METRIC_DEFINE_gauge_uint64(server, data_dirs_failed,
                            "Data Directories Failed",
                            kudu::MetricUnit::kDataDirectories,
@@ -207,6 +224,7 @@ DataDir::DataDir(Env* env,
       metadata_file_(std::move(metadata_file)),
       pool_(std::move(pool)),
       is_shutdown_(false),
+      sync_leader_active_(false),
       is_full_(false) {
 }
 
@@ -237,6 +255,79 @@ void DataDir::WaitOnClosures() {
   pool_->Wait();
 }
 
+int DataDir::queued_io_tasks() const {
+  return pool_->num_queued_tasks();
+}
+
+struct DataDir::SyncRequest {
+  SyncRequest(const void* t, const std::function<Status()>* fn)
+      : token(t), sync_fn(fn), done(1) {}
+
+  const void* token;
+  const std::function<Status()>* sync_fn;
+  Status status;
+  CountDownLatch done;
+};
+
+Status DataDir::CoalescedSync(const void* token,
+                              const std::function<Status()>& sync_fn) {
+  if (!FLAGS_fs_data_dirs_coalesce_fsyncs) {
+    return sync_fn();
+  }
+
+  SyncRequest req(token, &sync_fn);
+  bool leader = false;
+  {
+    std::lock_guard<simple_spinlock> l(sync_lock_);
+    pending_syncs_.push_back(&req);
+    if (!sync_leader_active_) {
+      sync_leader_active_ = true;
+      leader = true;
+    }
+  }
+
+  if (!leader) {
+    // Some other caller is (or soon will be) servicing our request; wait for
+    // it to signal completion.
+    req.done.Wait();
+    return req.status;
+  }
+
+  // We're the batch leader: drain and service batches of requests until the
+  // queue is empty. Our own request is part of the first batch.
+  while (true) {
+    vector<SyncRequest*> batch;
+    {
+      std::lock_guard<simple_spinlock> l(sync_lock_);
+      if (pending_syncs_.empty()) {
+        sync_leader_active_ = false;
+        break;
+      }
+      batch.swap(pending_syncs_);
+    }
+
+    // Run one sync per distinct token; requests sharing a token share the
+    // result.
+    unordered_map<const void*, Status> results;
+    for (SyncRequest* r : batch) {
+      auto it = results.find(r->token);
+      if (it == results.end()) {
+        it = results.emplace(r->token, (*r->sync_fn)()).first;
+      }
+      r->status = it->second;
+    }
+
+    // Wake the waiters. A waiter may destroy its request as soon as its latch
+    // counts down, so this must be the last time the batch is touched.
+    for (SyncRequest* r : batch) {
+      if (r != &req) {
+        r->done.CountDown();
+      }
+    }
+  }
+  return req.status;
+}
+
 Status DataDir::RefreshIsFull(RefreshMode mode) {
   switch (mode) {
     case RefreshMode::EXPIRED_ONLY: {
@@ -869,16 +960,34 @@ Status DataDirManager::GetNextDataDir(const CreateBlockOptions& opts, DataDir**
   iota(random_indices.begin(), random_indices.end(), 0);
   shuffle(random_indices.begin(), random_indices.end(), default_random_engine(rng_.Next()));
 
-  // Randomly select a member of the group that is not full.
+  // Select a member of the group that is not full. If load-aware selection
+  // is enabled, prefer the member with the fewest queued I/O tasks so that
+  // slow or busy disks shed new write load; ties (e.g. when all the disks
+  // are idle) are broken by the shuffled order. Otherwise, pick the first
+  // candidate in the shuffled order.
+  DataDir* least_loaded = nullptr;
+  int least_queued_tasks = 0;
   for (int i : random_indices) {
     int uuid_idx = (*group_uuid_indices)[i];
     DataDir* candidate = FindOrDie(data_dir_by_uuid_idx_, uuid_idx);
     Status s = candidate->RefreshIsFull(DataDir::RefreshMode::EXPIRED_ONLY);
     WARN_NOT_OK(s, Substitute("failed to refresh fullness of $0", candidate->dir()));
-    if (s.ok() && !candidate->is_full()) {
+    if (!s.ok() || candidate->is_full()) {
+      continue;
+    }
+    if (!FLAGS_fs_data_dirs_load_aware_selection) {
       *dir = candidate;
       return Status::OK();
     }
+    int queued_tasks = candidate->queued_io_tasks();
+    if (least_loaded == nullptr || queued_tasks < least_queued_tasks) {
+      least_loaded = candidate;
+      least_queued_tasks = queued_tasks;
+    }
+  }
+  if (least_loaded != nullptr) {
+    *dir = least_loaded;
+    return Status::OK();
   }
   string tablet_id_str = "";
   if (PREDICT_TRUE(!opts.tablet_id.empty())) {
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <set>
@@ -151,6 +152,24 @@ class DataDir {
   // Waits for any outstanding closures submitted via ExecClosure() to finish.
   void WaitOnClosures();
 
+  // Run 'sync_fn' (which is expected to synchronize a single file in this
+  // directory to disk) on behalf of the caller, coalescing it with concurrent
+  // requests bearing the same 'token'.
+  //
+  // Concurrent callers are batched group-commit style: one caller becomes the
+  // batch leader, drains all outstanding requests, runs one sync per distinct
+  // token, and wakes the waiters with the resulting status. When many
+  // tablets flush against the same directory at once, this turns a storm of
+  // per-file fsync calls into a handful of syscalls per batch, at the cost of
+  // a small amount of added latency for the leader.
+  //
+  // 'token' is typically the address of the file being synchronized; requests
+  // which share a token must be satisfiable by any one of their sync
+  // functions. 'sync_fn' may run on the calling thread or on a concurrent
+  // caller's thread, but this call does not return until the sync for
+  // 'token' has completed (or failed).
+  Status CoalescedSync(const void* token, const std::function<Status()>& sync_fn);
+
   // Tests whether the data directory is full by comparing the free space of
   // its underlying filesystem with a predefined "reserved" space value.
   //
@@ -166,6 +185,10 @@ class DataDir {
   };
   Status RefreshIsFull(RefreshMode mode);
 
+  // Returns the number of tasks currently queued behind this dir's thread
+  // pool. This is a cheap proxy for how busy the underlying disk is.
+  int queued_io_tasks() const;
+
   DataDirFsType fs_type() const { return fs_type_; }
 
   const std::string& dir() const { return dir_; }
@@ -180,6 +203,8 @@ class DataDir {
   }
 
  private:
+  struct SyncRequest;
+
   Env* env_;
   DataDirMetrics* metrics_;
   const DataDirFsType fs_type_;
@@ -189,6 +214,11 @@ class DataDir {
 
   bool is_shutdown_;
 
+  // Protects 'pending_syncs_' and 'sync_leader_active_'.
+  mutable simple_spinlock sync_lock_;
+  std::vector<SyncRequest*> pending_syncs_;
+  bool sync_leader_active_;
+
   // Protects 'last_check_is_full_' and 'is_full_'.
   mutable simple_spinlock lock_;
   MonoTime last_check_is_full_;
@@ -387,6 +417,7 @@ class DataDirManager {
  private:
   FRIEND_TEST(DataDirsTest, TestCreateGroup);
   FRIEND_TEST(DataDirsTest, TestLoadFromPB);
+  FRIEND_TEST(DataDirsTest, TestLoadAwareSelection);
   FRIEND_TEST(DataDirsTest, TestLoadBalancingBias);
   FRIEND_TEST(DataDirsTest, TestLoadBalancingDistribution);
   FRIEND_TEST(DataDirsTest, TestFailedDirNotAddedToGroup);
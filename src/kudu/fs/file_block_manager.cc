@@ -65,8 +65,10 @@ using std::unique_ptr;
 using std::vector;
 using strings::Substitute;
 
+DECLARE_bool(block_manager_direct_io_reads);
 DECLARE_bool(block_manager_lock_dirs);
 DECLARE_bool(enable_data_block_fsync);
+DECLARE_bool(block_manager_evict_written_data);
 DECLARE_string(block_manager_preflush_control);
 
 namespace kudu {
@@ -340,16 +342,20 @@ Status FileWritableBlock::Append(const Slice& data) {
 
 Status FileWritableBlock::AppendV(ArrayView<const Slice> data) {
   DCHECK(state_ == CLEAN || state_ == DIRTY) << "Invalid state: " << state_;
-  RETURN_NOT_OK_HANDLE_ERROR(writer_->AppendV(data));
-  RETURN_NOT_OK_HANDLE_ERROR(location_.data_dir()->RefreshIsFull(
-      DataDir::RefreshMode::ALWAYS));
-  state_ = DIRTY;
 
-  // Calculate the amount of data written
+  // Calculate the amount of data to write
   size_t bytes_written = accumulate(data.begin(), data.end(), static_cast<size_t>(0),
                                     [&](int sum, const Slice& curr) {
                                       return sum + curr.size();
                                     });
+
+  MaybeThrottleBackgroundBlockWrite(bytes_written);
+
+  RETURN_NOT_OK_HANDLE_ERROR(writer_->AppendV(data));
+  RETURN_NOT_OK_HANDLE_ERROR(location_.data_dir()->RefreshIsFull(
+      DataDir::RefreshMode::ALWAYS));
+  state_ = DIRTY;
+
   bytes_appended_ += bytes_written;
   return Status::OK();
 }
@@ -403,6 +409,16 @@ Status FileWritableBlock::Close(SyncMode mode) {
     }
     WARN_NOT_OK(sync, Substitute("Failed to sync when closing block $0",
                                  id().ToString()));
+
+    // Now that the data is durable, it can be safely dropped from the
+    // page cache if so requested. Failure to evict is harmless.
+    if (sync.ok() &&
+        FLAGS_enable_data_block_fsync &&
+        FLAGS_block_manager_evict_written_data) {
+      WARN_NOT_OK(writer_->EvictCache(0, 0),
+                  Substitute("Failed to evict page cache for block $0",
+                             id().ToString()));
+    }
   }
   Status close = writer_->Close();
 
@@ -448,6 +464,12 @@ class FileReadableBlock : public ReadableBlock {
 
   virtual Status ReadV(uint64_t offset, ArrayView<Slice> results) const OVERRIDE;
 
+  virtual Status ReadBatch(ArrayView<ReadRange> ranges) const OVERRIDE;
+
+  virtual Status ReadAhead(uint64_t offset, size_t length) const OVERRIDE;
+
+  virtual Status HintAccessPattern(FileAccessPattern pattern) const OVERRIDE;
+
   virtual size_t memory_footprint() const OVERRIDE;
 
   void HandleError(const Status& s) const;
@@ -520,6 +542,16 @@ Status FileReadableBlock::Read(uint64_t offset, Slice result) const {
   return ReadV(offset, ArrayView<Slice>(&result, 1));
 }
 
+Status FileReadableBlock::ReadAhead(uint64_t offset, size_t length) const {
+  DCHECK(!closed_.Load());
+  return reader_->ReadAhead(offset, length);
+}
+
+Status FileReadableBlock::HintAccessPattern(FileAccessPattern pattern) const {
+  DCHECK(!closed_.Load());
+  return reader_->HintAccessPattern(pattern);
+}
+
 Status FileReadableBlock::ReadV(uint64_t offset, ArrayView<Slice> results) const {
   DCHECK(!closed_.Load());
 
@@ -537,6 +569,24 @@ Status FileReadableBlock::ReadV(uint64_t offset, ArrayView<Slice> results) const
   return Status::OK();
 }
 
+Status FileReadableBlock::ReadBatch(ArrayView<ReadRange> ranges) const {
+  DCHECK(!closed_.Load());
+
+  // Block offsets and file offsets coincide in the file block manager, so
+  // the ranges can be passed through as-is.
+  RETURN_NOT_OK_HANDLE_ERROR(reader_->ReadBatch(ranges));
+
+  if (block_manager_->metrics_) {
+    size_t bytes_read = accumulate(ranges.begin(), ranges.end(), static_cast<size_t>(0),
+                                   [&](size_t sum, const ReadRange& curr) {
+                                     return sum + curr.data.size();
+                                   });
+    block_manager_->metrics_->total_bytes_read->IncrementBy(bytes_read);
+  }
+
+  return Status::OK();
+}
+
 size_t FileReadableBlock::memory_footprint() const {
   DCHECK(reader_);
   return kudu_malloc_usable_size(this) + reader_->memory_footprint();
@@ -695,7 +745,7 @@ FileBlockManager::FileBlockManager(Env* env,
     error_manager_(DCHECK_NOTNULL(error_manager)),
     opts_(std::move(opts)),
     file_cache_("fbm", env_, GetFileCacheCapacityForBlockManager(env_),
-                opts_.metric_entity),
+                opts_.metric_entity, FLAGS_block_manager_direct_io_reads),
     rand_(GetRandomSeed32()),
     next_block_id_(rand_.Next64()),
     mem_tracker_(MemTracker::CreateTracker(-1,
@@ -774,13 +824,26 @@ Status FileBlockManager::CreateBlock(const CreateBlockOptions& opts,
 
     location = internal::FileBlockLocation::FromParts(dir, uuid_idx, id);
     path = location.GetFullPath();
-    s = location.CreateBlockDir(env_, &created_dirs);
 
-    // We could create a block in a different directory, but there's currently
-    // no point in doing so. On disk failure, the tablet specified by 'opts'
-    // will be shut down, so the returned block would not be used.
-    RETURN_NOT_OK_HANDLE_DISK_FAILURE(s,
-        error_manager_->RunErrorNotificationCb(ErrorHandlerType::DISK, dir));
+    // Only create the block's directory hierarchy if this is the first block
+    // we've placed in it; sequential block ID assignment means nearly all
+    // blocks land in a directory created for a previous block.
+    bool dir_cached;
+    {
+      std::lock_guard<simple_spinlock> l(lock_);
+      dir_cached = ContainsKey(created_dirs_, DirName(path));
+    }
+    if (!dir_cached) {
+      s = location.CreateBlockDir(env_, &created_dirs);
+
+      // We could create a block in a different directory, but there's
+      // currently no point in doing so. On disk failure, the tablet specified
+      // by 'opts' will be shut down, so the returned block would not be used.
+      RETURN_NOT_OK_HANDLE_DISK_FAILURE(s,
+          error_manager_->RunErrorNotificationCb(ErrorHandlerType::DISK, dir));
+      std::lock_guard<simple_spinlock> l(lock_);
+      created_dirs_.insert(DirName(path));
+    }
     WritableFileOptions wr_opts;
     wr_opts.mode = Env::CREATE_NON_EXISTING;
     s = env_util::OpenFileForWrite(wr_opts, env_, path, &writer);
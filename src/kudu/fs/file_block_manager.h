@@ -142,13 +142,20 @@ class FileBlockManager : public BlockManager {
   ThreadSafeRandom rand_;
   AtomicInt<uint64_t> next_block_id_;
 
-  // Protects 'dirty_dirs_'.
+  // Protects 'dirty_dirs_' and 'created_dirs_'.
   mutable simple_spinlock lock_;
 
   // Tracks the block directories which are dirty from block creation. This
   // lets us perform some simple coalescing when synchronizing metadata.
   std::unordered_set<std::string> dirty_dirs_;
 
+  // Tracks the block directories known to exist on disk. Because block IDs
+  // are assigned sequentially, consecutive blocks nearly always land in the
+  // same directory; caching it means only the first block in a directory
+  // pays for the directory creation checks. Entries are never removed, as
+  // block deletion leaves the directory hierarchy behind.
+  std::unordered_set<std::string> created_dirs_;
+
   // Metric container for the block manager.
   // May be null if instantiated without metrics.
   std::unique_ptr<internal::BlockManagerMetrics> metrics_;
@@ -25,6 +25,7 @@
 #include "kudu/fs/block_manager.h"
 #include "kudu/fs/fs_manager.h"
 #include "kudu/util/array_view.h"
+#include "kudu/util/env.h"
 #include "kudu/util/malloc.h"
 #include "kudu/util/slice.h"
 
@@ -81,6 +82,16 @@ class CountingReadableBlock : public ReadableBlock {
     return Status::OK();
   }
 
+  virtual Status ReadBatch(ArrayView<ReadRange> ranges) const OVERRIDE {
+    RETURN_NOT_OK(block_->ReadBatch(ranges));
+    size_t length = std::accumulate(ranges.begin(), ranges.end(), static_cast<size_t>(0),
+                               [&](size_t sum, const ReadRange& curr) {
+                                 return sum + curr.data.size();
+                               });
+    *bytes_read_ += length;
+    return Status::OK();
+  }
+
   virtual size_t memory_footprint() const OVERRIDE {
     return block_->memory_footprint();
   }
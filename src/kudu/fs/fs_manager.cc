@@ -583,10 +583,20 @@ string FsManager::GetTabletMetadataDir() const {
   return JoinPathSegments(canonicalized_metadata_fs_root_.path, kTabletMetadataDirName);
 }
 
+namespace {
+// Filename suffix for tablet incremental metadata logs, which live in the
+// tablet metadata directory alongside the superblocks.
+const char* const kTabletMetadataLogSuffix = ".log";
+} // anonymous namespace
+
 string FsManager::GetTabletMetadataPath(const string& tablet_id) const {
   return JoinPathSegments(GetTabletMetadataDir(), tablet_id);
 }
 
+string FsManager::GetTabletMetadataLogPath(const string& tablet_id) const {
+  return GetTabletMetadataPath(tablet_id) + kTabletMetadataLogSuffix;
+}
+
 namespace {
 // Return true if 'fname' is a valid tablet ID.
 bool IsValidTabletId(const string& fname) {
@@ -596,6 +606,12 @@ bool IsValidTabletId(const string& fname) {
     return false;
   }
 
+  if (HasSuffixString(fname, kTabletMetadataLogSuffix)) {
+    // Incremental metadata log for a tablet; not a superblock.
+    VLOG(1) << "Ignoring metadata log in tablet metadata dir: " << fname;
+    return false;
+  }
+
   if (HasPrefixString(fname, ".")) {
     // Hidden file or ./..
     VLOG(1) << "Ignoring hidden file in tablet metadata dir: " << fname;
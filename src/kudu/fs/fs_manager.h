@@ -204,6 +204,9 @@ class FsManager {
   // Return the path for a specific tablet's superblock.
   std::string GetTabletMetadataPath(const std::string& tablet_id) const;
 
+  // Return the path for a specific tablet's incremental metadata log.
+  std::string GetTabletMetadataLogPath(const std::string& tablet_id) const;
+
   // List the tablet IDs in the metadata directory.
   Status ListTabletIds(std::vector<std::string>* tablet_ids);
 
@@ -78,6 +78,7 @@ DECLARE_bool(crash_on_eio);
 DECLARE_double(env_inject_eio);
 DECLARE_double(log_container_excess_space_before_cleanup_fraction);
 DECLARE_double(log_container_live_metadata_before_compact_ratio);
+DECLARE_int64(log_container_dead_space_before_punch_bytes);
 DECLARE_int64(block_manager_max_open_files);
 DECLARE_int64(log_container_max_blocks);
 DECLARE_string(block_manager_preflush_control);
@@ -443,6 +444,57 @@ TEST_F(LogBlockManagerTest, MetricsTest) {
         {11, &METRIC_block_manager_total_blocks_deleted} }));
 }
 
+TEST_F(LogBlockManagerTest, DeferredHolePunchingTest) {
+  MetricRegistry registry;
+  scoped_refptr<MetricEntity> entity = METRIC_ENTITY_server.Instantiate(&registry, "test");
+  ASSERT_OK(ReopenBlockManager(entity));
+
+  // With a large deferral threshold, deleting blocks must not punch their
+  // holes immediately.
+  FLAGS_log_container_dead_space_before_punch_bytes = 1024 * 1024 * 1024;
+
+  // Create three contiguous blocks in the same container.
+  vector<BlockId> blocks;
+  for (int i = 0; i < 3; i++) {
+    unique_ptr<WritableBlock> b;
+    ASSERT_OK(bm_->CreateBlock(test_block_opts_, &b));
+    blocks.emplace_back(b->id());
+    ASSERT_OK(b->Append("test data"));
+    ASSERT_OK(b->Close());
+  }
+
+  {
+    shared_ptr<BlockDeletionTransaction> deletion_transaction =
+        bm_->NewDeletionTransaction();
+    deletion_transaction->AddDeletedBlock(blocks[0]);
+    deletion_transaction->AddDeletedBlock(blocks[1]);
+    vector<BlockId> deleted;
+    ASSERT_OK(deletion_transaction->CommitDeletedBlocks(&deleted));
+    ASSERT_EQ(2, deleted.size());
+  }
+  for (const auto& data_dir : dd_manager_->data_dirs()) {
+    data_dir->WaitOnClosures();
+  }
+  NO_FATALS(CheckCounterMetric(entity, 0, &METRIC_log_block_manager_holes_punched));
+
+  // Dropping the threshold and deleting one more block must punch out all
+  // of the accumulated dead space. The deferred ranges from both deletion
+  // transactions are contiguous, so they coalesce into a single punch.
+  FLAGS_log_container_dead_space_before_punch_bytes = 1;
+  {
+    shared_ptr<BlockDeletionTransaction> deletion_transaction =
+        bm_->NewDeletionTransaction();
+    deletion_transaction->AddDeletedBlock(blocks[2]);
+    vector<BlockId> deleted;
+    ASSERT_OK(deletion_transaction->CommitDeletedBlocks(&deleted));
+    ASSERT_EQ(1, deleted.size());
+  }
+  for (const auto& data_dir : dd_manager_->data_dirs()) {
+    data_dir->WaitOnClosures();
+  }
+  NO_FATALS(CheckCounterMetric(entity, 1, &METRIC_log_block_manager_holes_punched));
+}
+
 TEST_F(LogBlockManagerTest, ContainerPreallocationTest) {
   string kTestData = "test data";
 
@@ -485,6 +537,27 @@ TEST_F(LogBlockManagerTest, ContainerPreallocationTest) {
   ASSERT_EQ(FLAGS_log_container_preallocate_bytes, size);
 }
 
+// Test that a size hint provided at block creation time causes the entire
+// expected block size to be preallocated up front, even when it exceeds the
+// standard preallocation chunk.
+TEST_F(LogBlockManagerTest, ContainerPreallocationSizeHintTest) {
+  const int64_t kExpectedSize = FLAGS_log_container_preallocate_bytes * 2;
+
+  unique_ptr<WritableBlock> written_block;
+  ASSERT_OK(bm_->CreateBlock(CreateBlockOptions({ test_tablet_name_, kExpectedSize }),
+                             &written_block));
+  ASSERT_OK(written_block->Append("test data"));
+  ASSERT_OK(written_block->Close());
+
+  // The container should have been preallocated out to the full hinted size
+  // in one shot, rather than just a single preallocation chunk.
+  string container_data_filename;
+  NO_FATALS(GetOnlyContainerDataFile(&container_data_filename));
+  uint64_t size;
+  ASSERT_OK(env_->GetFileSizeOnDisk(container_data_filename, &size));
+  ASSERT_EQ(kExpectedSize, size);
+}
+
 // Test for KUDU-2202 to ensure that once the block manager has been notified
 // of a block ID, it will not reuse it.
 TEST_F(LogBlockManagerTest, TestBumpBlockIds) {
@@ -77,6 +77,7 @@
 
 DECLARE_bool(block_manager_lock_dirs);
 DECLARE_bool(enable_data_block_fsync);
+DECLARE_bool(block_manager_evict_written_data);
 DECLARE_string(block_manager_preflush_control);
 
 // TODO(unknown): How should this be configured? Should provide some guidance.
@@ -102,6 +103,18 @@ DEFINE_double(log_container_excess_space_before_cleanup_fraction, 0.10,
               "manager startup.");
 TAG_FLAG(log_container_excess_space_before_cleanup_fraction, advanced);
 
+DEFINE_int64(log_container_dead_space_before_punch_bytes, 0,
+             "Number of bytes of dead (deleted) block data that may "
+             "accumulate in a container before the corresponding holes are "
+             "punched out of its data file in one batched background pass. "
+             "Deferring and consolidating hole punches reduces the number "
+             "of fallocate() calls issued after large compactions. If 0, "
+             "holes are punched as soon as each deletion transaction "
+             "commits. Dead space that has not yet been punched when the "
+             "process exits is reclaimed during startup.");
+TAG_FLAG(log_container_dead_space_before_punch_bytes, advanced);
+TAG_FLAG(log_container_dead_space_before_punch_bytes, experimental);
+
 DEFINE_double(log_container_live_metadata_before_compact_ratio, 0.50,
               "Desired ratio of live block metadata in log containers. If a "
               "container's live to total block ratio dips below this value, "
@@ -161,6 +174,9 @@ using strings::Substitute;
 
 namespace internal {
 
+// Byte range within a container given as an <offset, offset + length> pair.
+typedef std::pair<int64_t, int64_t> BlockInterval;
+
 ////////////////////////////////////////////////////////////
 // LogBlockManagerMetrics
 ////////////////////////////////////////////////////////////
@@ -299,6 +315,10 @@ class LogWritableBlock : public WritableBlock {
 
   LogBlockContainer* container() const { return container_; }
 
+  int64_t block_offset() const { return block_offset_; }
+
+  int64_t block_length() const { return block_length_; }
+
  private:
   // The owning container. Must outlive the block.
   LogBlockContainer* container_;
@@ -374,11 +394,21 @@ class LogBlockContainer {
   // The on-disk effects of this call are made durable only after SyncData().
   Status PunchHole(int64_t offset, int64_t length);
 
-  // Executes a hole punching operation at 'offset' with the given 'length'.
-  void ContainerDeletionAsync(int64_t offset, int64_t length);
+  // Queues the given dead block byte ranges for hole punching. Punching is
+  // performed on this container's data directory thread pool, either
+  // immediately or, if --log_container_dead_space_before_punch_bytes is
+  // non-zero, once that much dead space has accumulated in the container.
+  //
+  // This function is thread safe.
+  void ScheduleHolePunches(const vector<BlockInterval>& intervals);
+
+  // Punches out a batch of dead block byte ranges, coalescing adjacent
+  // ranges into single punch operations.
+  void ContainerDeletionAsync(vector<BlockInterval> intervals);
 
   // Preallocate enough space to ensure that an append of 'next_append_length'
-  // can be satisfied by this container. The offset of the beginning of this
+  // can be satisfied by this container, even if the append is larger than the
+  // standard preallocation chunk. The offset of the beginning of this
   // block must be provided in 'block_start_offset' (since container
   // bookkeeping is only updated when a block is finished).
   //
@@ -398,6 +428,18 @@ class LogBlockContainer {
   // See RWFile::ReadV().
   Status ReadVData(int64_t offset, ArrayView<Slice> results) const;
 
+  // See RWFile::ReadBatch(). The offsets in 'ranges' are absolute offsets
+  // in the container's data file.
+  Status ReadBatchData(ArrayView<ReadRange> ranges) const;
+
+  // Hint that the given byte range of the container's data file will soon be
+  // read, allowing readahead of it to begin asynchronously. Purely advisory.
+  Status ReadAheadData(int64_t offset, size_t length) const;
+
+  // Hint the expected pattern of future reads of the container's data file.
+  // Purely advisory.
+  Status HintDataAccessPattern(FileAccessPattern pattern) const;
+
   // Appends 'pb' to this container's metadata file.
   //
   // The on-disk effects of this call are made durable only after SyncMetadata().
@@ -597,6 +639,16 @@ class LogBlockContainer {
   mutable simple_spinlock read_only_lock_;
   Status read_only_status_;
 
+  // Protects 'deferred_punches_' and 'deferred_punch_bytes_'.
+  mutable simple_spinlock deferred_punch_lock_;
+
+  // Dead block ranges whose hole punching has been deferred; see
+  // ScheduleHolePunches().
+  std::vector<BlockInterval> deferred_punches_;
+
+  // Total number of dead bytes covered by 'deferred_punches_'.
+  int64_t deferred_punch_bytes_ = 0;
+
   DISALLOW_COPY_AND_ASSIGN(LogBlockContainer);
 };
 
@@ -913,6 +965,18 @@ Status LogBlockContainer::DoCloseBlocks(const vector<LogWritableBlock*>& blocks,
     if (mode == SYNC) {
       VLOG(3) << "Syncing data file " << data_file_->filename();
       RETURN_NOT_OK(SyncData());
+
+      // Now that the block data is durable, it can be safely dropped from
+      // the page cache if so requested. Failure to evict is harmless.
+      if (FLAGS_enable_data_block_fsync &&
+          FLAGS_block_manager_evict_written_data) {
+        for (LogWritableBlock* block : blocks) {
+          WARN_NOT_OK(data_file_->EvictCache(block->block_offset(),
+                                             block->block_length()),
+                      Substitute("Failed to evict page cache for block $0",
+                                 block->id().ToString()));
+        }
+      }
     }
 
     // Append metadata only after data is synced so that there's
@@ -994,6 +1058,20 @@ Status LogBlockContainer::ReadVData(int64_t offset, ArrayView<Slice> results) co
   return Status::OK();
 }
 
+Status LogBlockContainer::ReadBatchData(ArrayView<ReadRange> ranges) const {
+  RETURN_NOT_OK_HANDLE_ERROR(data_file_->ReadBatch(ranges));
+  return Status::OK();
+}
+
+Status LogBlockContainer::ReadAheadData(int64_t offset, size_t length) const {
+  DCHECK_GE(offset, 0);
+  return data_file_->ReadAhead(offset, length);
+}
+
+Status LogBlockContainer::HintDataAccessPattern(FileAccessPattern pattern) const {
+  return data_file_->HintAccessPattern(pattern);
+}
+
 Status LogBlockContainer::AppendMetadata(const BlockRecordPB& pb) {
   RETURN_NOT_OK_HANDLE_ERROR(read_only_status());
   // Note: We don't check for sufficient disk space for metadata writes in
@@ -1020,7 +1098,11 @@ Status LogBlockContainer::SyncData() {
   RETURN_NOT_OK_HANDLE_ERROR(read_only_status());
   if (FLAGS_enable_data_block_fsync) {
     if (metrics_) metrics_->generic_metrics.total_disk_sync->Increment();
-    RETURN_NOT_OK_HANDLE_ERROR(data_file_->Sync());
+    // Coalesce with concurrent data file syncs against this data directory
+    // so that many actively-flushing containers don't each pay for their own
+    // syscall.
+    RETURN_NOT_OK_HANDLE_ERROR(data_dir_->CoalescedSync(
+        data_file_.get(), [this]() { return data_file_->Sync(); }));
   }
   return Status::OK();
 }
@@ -1029,7 +1111,8 @@ Status LogBlockContainer::SyncMetadata() {
   RETURN_NOT_OK_HANDLE_ERROR(read_only_status());
   if (FLAGS_enable_data_block_fsync) {
     if (metrics_) metrics_->generic_metrics.total_disk_sync->Increment();
-    RETURN_NOT_OK_HANDLE_ERROR(metadata_file_->Sync());
+    RETURN_NOT_OK_HANDLE_ERROR(data_dir_->CoalescedSync(
+        metadata_file_.get(), [this]() { return metadata_file_->Sync(); }));
   }
   return Status::OK();
 }
@@ -1061,7 +1144,12 @@ Status LogBlockContainer::EnsurePreallocated(int64_t block_start_offset,
   if (block_start_offset > preallocated_offset_ ||
       next_append_length > preallocated_offset_ - block_start_offset) {
     int64_t off = std::max(preallocated_offset_, block_start_offset);
-    int64_t len = FLAGS_log_container_preallocate_bytes;
+    // Preallocate at least a full chunk, but if the append is larger than
+    // that (e.g. because it reflects a block creation size hint), cover it
+    // in its entirety so the space is allocated in one contiguous extent.
+    int64_t len = std::max<int64_t>(
+        FLAGS_log_container_preallocate_bytes,
+        block_start_offset + next_append_length - off);
     RETURN_NOT_OK_HANDLE_ERROR(data_file_->PreAllocate(off, len, RWFile::CHANGE_FILE_SIZE));
     RETURN_NOT_OK_HANDLE_ERROR(data_dir_->RefreshIsFull(DataDir::RefreshMode::ALWAYS));
     VLOG(2) << Substitute("Preallocated $0 bytes at offset $1 in container $2",
@@ -1155,12 +1243,42 @@ void LogBlockContainer::SetReadOnly(const Status& error) {
   read_only_status_ = error;
 }
 
-void LogBlockContainer::ContainerDeletionAsync(int64_t offset, int64_t length) {
+void LogBlockContainer::ScheduleHolePunches(const vector<BlockInterval>& intervals) {
+  vector<BlockInterval> to_punch;
+  {
+    std::lock_guard<simple_spinlock> l(deferred_punch_lock_);
+    for (const auto& interval : intervals) {
+      deferred_punch_bytes_ += interval.second - interval.first;
+      deferred_punches_.emplace_back(interval);
+    }
+    if (deferred_punch_bytes_ < FLAGS_log_container_dead_space_before_punch_bytes) {
+      // Not enough dead space yet; keep accumulating. If the process exits
+      // before the threshold is reached, the dead space is reclaimed by the
+      // repunching pass at the next startup.
+      return;
+    }
+    to_punch.swap(deferred_punches_);
+    deferred_punch_bytes_ = 0;
+  }
+  ExecClosure(Bind(&LogBlockContainer::ContainerDeletionAsync,
+                   Unretained(this), std::move(to_punch)));
+}
+
+void LogBlockContainer::ContainerDeletionAsync(vector<BlockInterval> intervals) {
   VLOG(3) << "Freeing space belonging to container " << ToString();
-  Status s = PunchHole(offset, length);
-  if (s.ok() && metrics_) metrics_->holes_punched->Increment();
-  WARN_NOT_OK(s, Substitute("could not delete blocks in container $0",
-                            data_dir()->dir()));
+
+  // Deferred ranges from separate deletion transactions may well be
+  // adjacent (e.g. a compaction's inputs are deleted in several
+  // transactions); coalescing across the batch saves punch operations.
+  CHECK_OK_PREPEND(CoalesceIntervals<int64_t>(&intervals),
+                   Substitute("could not coalesce hole punching for container: $0",
+                              ToString()));
+  for (const auto& interval : intervals) {
+    Status s = PunchHole(interval.first, interval.second - interval.first);
+    if (s.ok() && metrics_) metrics_->holes_punched->Increment();
+    WARN_NOT_OK(s, Substitute("could not delete blocks in container $0",
+                              data_dir()->dir()));
+  }
 }
 
 ///////////////////////////////////////////////////////////
@@ -1240,9 +1358,6 @@ class LogBlockDeletionTransaction : public BlockDeletionTransaction,
   void AddBlock(const scoped_refptr<internal::LogBlock>& lb);
 
  private:
-  // Block <offset, offset + length> pair.
-  typedef std::pair<int64_t, int64_t> BlockInterval;
-
   // Map used to aggregate BlockInterval instances across containers.
   std::unordered_map<internal::LogBlockContainer*,
       std::vector<BlockInterval>> deleted_interval_map_;
@@ -1263,13 +1378,7 @@ LogBlockDeletionTransaction::~LogBlockDeletionTransaction() {
     CHECK_OK_PREPEND(CoalesceIntervals<int64_t>(&entry.second),
                      Substitute("could not coalesce hole punching for container: $0",
                                 container->ToString()));
-
-    for (const auto& interval : entry.second) {
-      container->ExecClosure(Bind(&LogBlockContainer::ContainerDeletionAsync,
-                                  Unretained(container),
-                                  interval.first,
-                                  interval.second - interval.first));
-    }
+    container->ScheduleHolePunches(entry.second);
   }
 }
 
@@ -1450,6 +1559,8 @@ Status LogWritableBlock::AppendV(ArrayView<const Slice> data) {
                                   return sum + curr.size();
                                 });
 
+  MaybeThrottleBackgroundBlockWrite(data_size);
+
   // The metadata change is deferred to Close(). We can't do
   // it now because the block's length is still in flux.
   int64_t cur_block_offset = block_offset_ + block_length_;
@@ -1564,6 +1675,12 @@ class LogReadableBlock : public ReadableBlock {
 
   virtual Status ReadV(uint64_t offset, ArrayView<Slice> results) const OVERRIDE;
 
+  virtual Status ReadBatch(ArrayView<ReadRange> ranges) const OVERRIDE;
+
+  virtual Status ReadAhead(uint64_t offset, size_t length) const OVERRIDE;
+
+  virtual Status HintAccessPattern(FileAccessPattern pattern) const OVERRIDE;
+
   virtual size_t memory_footprint() const OVERRIDE;
 
  private:
@@ -1656,6 +1773,66 @@ Status LogReadableBlock::ReadV(uint64_t offset, ArrayView<Slice> results) const
   return Status::OK();
 }
 
+Status LogReadableBlock::ReadBatch(ArrayView<ReadRange> ranges) const {
+  DCHECK(!closed_.Load());
+
+  // Translate the block-relative ranges into absolute ranges in the
+  // container's data file, bounds-checking each against the block's extent.
+  size_t read_length = 0;
+  vector<ReadRange> file_ranges;
+  file_ranges.reserve(ranges.size());
+  for (const ReadRange& range : ranges) {
+    if (log_block_->length() < range.offset + range.data.size()) {
+      return Status::IOError("Out-of-bounds read",
+                             Substitute("read of [$0-$1) in block [$2-$3)",
+                                        log_block_->offset() + range.offset,
+                                        log_block_->offset() + range.offset + range.data.size(),
+                                        log_block_->offset(),
+                                        log_block_->offset() + log_block_->length()));
+    }
+    file_ranges.push_back({ log_block_->offset() + range.offset, range.data });
+    read_length += range.data.size();
+  }
+
+  MicrosecondsInt64 start_time = GetMonoTimeMicros();
+  RETURN_NOT_OK(container_->ReadBatchData(file_ranges));
+  MicrosecondsInt64 end_time = GetMonoTimeMicros();
+
+  int64_t dur = end_time - start_time;
+  TRACE_COUNTER_INCREMENT("lbm_read_time_us", dur);
+
+  const char* counter = BUCKETED_COUNTER_NAME("lbm_reads", dur);
+  TRACE_COUNTER_INCREMENT(counter, 1);
+
+  if (container_->metrics()) {
+    container_->metrics()->generic_metrics.total_bytes_read->IncrementBy(read_length);
+  }
+  return Status::OK();
+}
+
+Status LogReadableBlock::ReadAhead(uint64_t offset, size_t length) const {
+  DCHECK(!closed_.Load());
+
+  if (offset >= log_block_->length()) {
+    return Status::OK();
+  }
+  length = static_cast<size_t>(
+      std::min<uint64_t>(length, log_block_->length() - offset));
+  return container_->ReadAheadData(log_block_->offset() + offset, length);
+}
+
+Status LogReadableBlock::HintAccessPattern(FileAccessPattern pattern) const {
+  DCHECK(!closed_.Load());
+
+  // A container file interleaves many blocks and may be shared with
+  // concurrent sequential readers, so a RANDOM hint -- which would disable
+  // kernel readahead for the whole file -- is not forwarded.
+  if (pattern != ACCESS_PATTERN_SEQUENTIAL) {
+    return Status::OK();
+  }
+  return container_->HintDataAccessPattern(pattern);
+}
+
 size_t LogReadableBlock::memory_footprint() const {
   return kudu_malloc_usable_size(this);
 }
@@ -1844,6 +2021,14 @@ Status LogBlockManager::CreateBlock(const CreateBlockOptions& opts,
   LogBlockContainer* container;
   RETURN_NOT_OK(GetOrCreateContainer(opts, &container));
 
+  // If the caller provided a size hint, preallocate the block's entire
+  // expected size up front. This yields a more contiguous extent layout for
+  // large blocks than growing the container chunk by chunk as data arrives.
+  if (opts.expected_size > 0) {
+    RETURN_NOT_OK(container->EnsurePreallocated(container->next_block_offset(),
+                                                opts.expected_size));
+  }
+
   // Generate a free block ID.
   // We have to loop here because earlier versions used non-sequential block IDs,
   // and thus we may have to "skip over" some block IDs that are claimed.
@@ -22,6 +22,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "kudu/gutil/endian.h"
 #include "kudu/gutil/integral_types.h"
 #include "kudu/gutil/port.h"
 
@@ -97,6 +98,39 @@ inline int fastmemcmp_inlined(const void *a_void, const void *b_void, size_t n)
   return 0;
 }
 
+// Three-way comparison of the n bytes at a and b, like memcmp().
+//
+// Compares 8 bytes at a time, resolving the first differing word with a
+// byte swap and a single register compare rather than falling back to a
+// byte-by-byte scan. This is considerably faster than memcmp() for inputs
+// which share a long common prefix and differ somewhere in the middle,
+// such as encoded composite keys.
+inline int fastmemcmp64_inlined(const void* a_void, const void* b_void, size_t n) {
+  const uint8_t* a = reinterpret_cast<const uint8_t*>(a_void);
+  const uint8_t* b = reinterpret_cast<const uint8_t*>(b_void);
+
+  while (n >= sizeof(uint64)) {
+    uint64 wa = UNALIGNED_LOAD64(a);
+    uint64 wb = UNALIGNED_LOAD64(b);
+    if (wa != wb) {
+      // In big-endian order, the integer order of the words matches the
+      // lexicographic order of the underlying bytes.
+      wa = BigEndian::FromHost64(wa);
+      wb = BigEndian::FromHost64(wb);
+      return (wa < wb) ? -1 : 1;
+    }
+    a += sizeof(uint64);
+    b += sizeof(uint64);
+    n -= sizeof(uint64);
+  }
+  while (n > 0) {
+    int d = static_cast<uint32>(*a++) - static_cast<uint32>(*b++);
+    if (d != 0) return d;
+    n--;
+  }
+  return 0;
+}
+
 // The standard memcpy operation is slow for variable small sizes.
 // This implementation inlines the optimal realization for sizes 1 to 16.
 // To avoid code bloat don't use it in case of not performance-critical spots,
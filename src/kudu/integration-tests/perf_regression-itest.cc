@@ -0,0 +1,187 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+//
+// Multi-node performance regression harness built on ExternalMiniCluster.
+//
+// Each scenario runs a standardized workload -- fixed thread count, batch
+// size and payload size -- against a three-server cluster and emits metric
+// lines of the form
+//
+//   PERF_METRIC <scenario>.<metric>=<value> <unit>
+//
+// which per-commit automation can grep out of the test log and trend across
+// builds. Because the parameters are pinned, the throughput, latency and
+// cycles-per-row numbers are comparable from run to run on the same host;
+// the test itself makes no assertions about the absolute values, only that
+// the workloads make progress and the scans see the inserted rows.
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include "kudu/client/client.h"
+#include "kudu/client/client-test-util.h"
+#include "kudu/client/shared_ptr.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/gutil/walltime.h"
+#include "kudu/integration-tests/external_mini_cluster-itest-base.h"
+#include "kudu/integration-tests/test_workload.h"
+#include "kudu/util/monotime.h"
+#include "kudu/util/test_macros.h"
+#include "kudu/util/test_util.h"
+
+DEFINE_int32(perf_regression_runtime_sec, -1,
+             "Number of seconds to run each ingest scenario. -1 picks a "
+             "default based on KUDU_ALLOW_SLOW_TESTS.");
+DEFINE_int32(perf_regression_num_write_threads, 4,
+             "Number of writer threads per ingest scenario. Part of the "
+             "standardized budget: changing this makes results incomparable "
+             "with previous runs.");
+DEFINE_int32(perf_regression_write_batch_size, 50,
+             "Number of rows per write batch. Part of the standardized "
+             "budget.");
+DEFINE_int32(perf_regression_payload_bytes, 128,
+             "Size of the binary payload column in each row. Part of the "
+             "standardized budget.");
+
+using std::string;
+using std::vector;
+using strings::Substitute;
+
+namespace kudu {
+
+using client::CountTableRows;
+using client::KuduTable;
+
+class PerfRegressionITest : public ExternalMiniClusterITestBase {
+ protected:
+  static int RuntimeSec() {
+    if (FLAGS_perf_regression_runtime_sec >= 0) {
+      return FLAGS_perf_regression_runtime_sec;
+    }
+    return AllowSlowTests() ? 20 : 2;
+  }
+
+  // Emit a metric line in the standardized machine-parseable format.
+  static void EmitMetric(const string& scenario, const string& metric,
+                         double value, const string& unit) {
+    LOG(INFO) << Substitute("PERF_METRIC $0.$1=$2 $3",
+                            scenario, metric, value, unit);
+  }
+
+  // Run 'workload' (already configured with a write pattern and table name)
+  // for RuntimeSec() seconds and emit its throughput, mean batch latency and
+  // cycles-per-row under 'scenario'.
+  void RunIngestScenario(const string& scenario, TestWorkload* workload) {
+    workload->set_num_write_threads(FLAGS_perf_regression_num_write_threads);
+    workload->set_write_batch_size(FLAGS_perf_regression_write_batch_size);
+    workload->set_payload_bytes(FLAGS_perf_regression_payload_bytes);
+    workload->Setup();
+
+    const int64_t start_cycles = CycleClock::Now();
+    const MonoTime start_time = MonoTime::Now();
+    workload->Start();
+    SleepFor(MonoDelta::FromSeconds(RuntimeSec()));
+    workload->StopAndJoin();
+    const double wall_secs = (MonoTime::Now() - start_time).ToSeconds();
+    const int64_t cycles = CycleClock::Now() - start_cycles;
+
+    const int64_t rows = workload->rows_inserted();
+    const int64_t batches = workload->batches_completed();
+    ASSERT_GT(rows, 0);
+    ASSERT_GT(batches, 0);
+    EmitMetric(scenario, "rows_inserted", rows, "rows");
+    EmitMetric(scenario, "ingest_throughput", rows / wall_secs, "rows/sec");
+    // Each writer thread issues batches synchronously, so the mean batch
+    // latency is the aggregate thread-time divided by the batch count.
+    EmitMetric(scenario, "mean_batch_latency",
+               wall_secs * FLAGS_perf_regression_num_write_threads /
+               batches * 1000, "ms");
+    EmitMetric(scenario, "cycles_per_row",
+               static_cast<double>(cycles) / rows, "cycles");
+  }
+
+  // Scan the whole of 'table_name' once and emit the scan throughput and
+  // cycles-per-row under 'scenario'. Returns the number of rows seen.
+  int64_t RunScanScenario(const string& scenario, const string& table_name) {
+    client::sp::shared_ptr<KuduTable> table;
+    CHECK_OK(client_->OpenTable(table_name, &table));
+
+    const int64_t start_cycles = CycleClock::Now();
+    const MonoTime start_time = MonoTime::Now();
+    const int64_t rows = CountTableRows(table.get());
+    const double wall_secs = (MonoTime::Now() - start_time).ToSeconds();
+    const int64_t cycles = CycleClock::Now() - start_cycles;
+
+    CHECK_GT(rows, 0);
+    EmitMetric(scenario, "rows_scanned", rows, "rows");
+    EmitMetric(scenario, "scan_throughput", rows / wall_secs, "rows/sec");
+    EmitMetric(scenario, "cycles_per_row",
+               static_cast<double>(cycles) / rows, "cycles");
+    return rows;
+  }
+};
+
+// Sequential ingest followed by a full-table scan. Sequential inserts cause
+// flushes but no compactions, so this isolates the MemRowSet insert path and
+// the flush path on the write side and a mostly-cold CFile read path on the
+// scan side.
+TEST_F(PerfRegressionITest, SequentialIngestAndScan) {
+  NO_FATALS(StartCluster());
+
+  TestWorkload workload(cluster_.get());
+  workload.set_table_name("perf-regression-seq");
+  workload.set_write_pattern(TestWorkload::INSERT_SEQUENTIAL_ROWS);
+  NO_FATALS(RunIngestScenario("seq_ingest", &workload));
+
+  // Sequential keys are unique, so the scan must see exactly the rows
+  // the workload reported inserting.
+  const int64_t scanned = RunScanScenario("seq_scan", workload.table_name());
+  ASSERT_EQ(workload.rows_inserted(), scanned);
+}
+
+// Random ingest against tablet servers configured to flush and compact
+// aggressively, followed by a full-table scan. Random inserts spread new
+// rows across the key space, so the small flush threshold produces many
+// overlapping rowsets and keeps the compaction maintenance ops busy for the
+// duration of the run; this exercises the write path under concurrent
+// background I/O and the scan path over a multi-rowset tablet.
+TEST_F(PerfRegressionITest, RandomIngestWithCompactionAndScan) {
+  vector<string> ts_flags = { "--flush_threshold_mb=1",
+                              "--maintenance_manager_num_threads=2" };
+  NO_FATALS(StartCluster(ts_flags));
+
+  TestWorkload workload(cluster_.get());
+  workload.set_table_name("perf-regression-rand");
+  workload.set_write_pattern(TestWorkload::INSERT_RANDOM_ROWS);
+  // With 32-bit random keys an occasional duplicate is possible; tolerate
+  // it rather than crashing the writer threads.
+  workload.set_already_present_allowed(true);
+  NO_FATALS(RunIngestScenario("rand_ingest", &workload));
+
+  // Duplicate random keys may have been rejected, so the scan can see
+  // slightly fewer rows than were reported inserted, but never more.
+  const int64_t scanned = RunScanScenario("rand_scan", workload.table_name());
+  ASSERT_LE(scanned, workload.rows_inserted());
+}
+
+} // namespace kudu
@@ -232,6 +232,16 @@ DEFINE_bool(catalog_manager_evict_excess_replicas, true,
 TAG_FLAG(catalog_manager_evict_excess_replicas, hidden);
 TAG_FLAG(catalog_manager_evict_excess_replicas, runtime);
 
+DEFINE_int32(catalog_manager_max_tablet_report_batch_size, 1000,
+             "Maximum number of tablets to process in a single batch when "
+             "processing a tablet report. Each batch locks only the tables "
+             "and tablets it touches and performs a single write to the "
+             "system catalog, so smaller batches bound the time during "
+             "which a large report blocks reports from other tablet "
+             "servers.");
+TAG_FLAG(catalog_manager_max_tablet_report_batch_size, advanced);
+TAG_FLAG(catalog_manager_max_tablet_report_batch_size, runtime);
+
 DECLARE_bool(raft_prepare_replacement_before_eviction);
 
 using base::subtle::NoBarrier_CompareAndSwap;
@@ -620,7 +630,8 @@ Status ProcessColumnPBDefaults(ColumnSchemaPB* col) {
 } // anonymous namespace
 
 CatalogManager::CatalogManager(Master *master)
-  : master_(master),
+  : needs_assignment_scan_(true),
+    master_(master),
     rng_(GetRandomSeed32()),
     state_(kConstructed),
     leader_ready_term_(-1),
@@ -999,6 +1010,11 @@ Status CatalogManager::VisitTablesAndTabletsUnlocked() {
   TabletLoader tablet_loader(this);
   RETURN_NOT_OK_PREPEND(sys_catalog_->VisitTablets(&tablet_loader),
                         "Failed while visiting tablets in sys catalog");
+
+  // Some of the loaded tablets may not be running yet (e.g. a table was
+  // mid-creation when leadership changed); make sure the background task
+  // gives them a look.
+  needs_assignment_scan_.Store(true);
   return Status::OK();
 }
 
@@ -1447,6 +1463,7 @@ Status CatalogManager::CreateTable(const CreateTableRequestPB* orig_req,
 
   resp->set_table_id(table->id());
   VLOG(1) << "Created table " << table->ToString();
+  needs_assignment_scan_.Store(true);
   background_tasks_->Wake();
   return Status::OK();
 }
@@ -1622,6 +1639,8 @@ Status CatalogManager::DeleteTable(const DeleteTableRequestPB* req,
   TRACE("Committing in-memory state");
   l.Commit();
 
+  locations_cache_.Invalidate(table->id());
+
   // 7. Abort any extant tasks belonging to the table.
   TRACE("Aborting table tasks");
   table->AbortTasks();
@@ -2142,12 +2161,17 @@ Status CatalogManager::AlterTable(const AlterTableRequestPB* req,
     l.Unlock();
   }
 
+  locations_cache_.Invalidate(table->id());
+
   SendAlterTableRequest(table);
   for (const auto& tablet : tablets_to_drop) {
     TabletMetadataLock l(tablet.get(), LockMode::READ);
     SendDeleteTabletRequest(tablet, l, deletion_msg);
   }
 
+  if (!tablets_to_add.empty()) {
+    needs_assignment_scan_.Store(true);
+  }
   background_tasks_->Wake();
   return Status::OK();
 }
@@ -3236,6 +3260,29 @@ Status CatalogManager::ProcessTabletReport(
   // reported, and somehow mark any that have been "lost" (eg somehow the
   // tablet metadata got corrupted or something).
 
+  // Process the report in bounded-size batches. Each batch locks only the
+  // tables and tablets it touches and performs a single write to the system
+  // catalog, so a large report from a server hosting many replicas doesn't
+  // hold the affected table locks for its entire duration. This allows
+  // reports from other tablet servers (which typically touch a different
+  // set of tables) to be processed concurrently.
+  full_report_update->mutable_tablets()->Reserve(num_tablets);
+  const int max_batch_size = FLAGS_catalog_manager_max_tablet_report_batch_size;
+  for (int batch_begin = 0; batch_begin < num_tablets;
+       batch_begin += max_batch_size) {
+    int batch_end = std::min(num_tablets, batch_begin + max_batch_size);
+    RETURN_NOT_OK(ProcessTabletReportBatch(ts_desc, full_report, batch_begin,
+                                           batch_end, full_report_update));
+  }
+  return Status::OK();
+}
+
+Status CatalogManager::ProcessTabletReportBatch(
+    TSDescriptor* ts_desc,
+    const TabletReportPB& full_report,
+    int batch_begin,
+    int batch_end,
+    TabletReportUpdatesPB* full_report_update) {
   // Maps a tablet ID to its corresponding tablet report (owned by 'full_report').
   unordered_map<string, const ReportedTabletPB*> reports;
 
@@ -3265,13 +3312,13 @@ Status CatalogManager::ProcessTabletReport(
   TabletMetadataGroupLock tablets_lock(LockMode::RELEASED);
 
   // 1. Set up local state.
-  full_report_update->mutable_tablets()->Reserve(num_tablets);
   {
     // We only need to acquire lock_ for the tablet_map_ access, but since it's
     // acquired exclusively so rarely, it's probably cheaper to acquire and
     // hold it for all tablets here than to acquire/release it for each tablet.
     shared_lock<LockType> l(lock_);
-    for (const ReportedTabletPB& report : full_report.updated_tablets()) {
+    for (int report_idx = batch_begin; report_idx < batch_end; report_idx++) {
+      const ReportedTabletPB& report = full_report.updated_tablets(report_idx);
       const string& tablet_id = report.tablet_id();
 
       // 1a. Prepare an update entry for this tablet. Every tablet in the
@@ -3558,6 +3605,13 @@ Status CatalogManager::ProcessTabletReport(
   // 10. Unlock the tables; we no longer need to access their state.
   tables_lock.Unlock();
 
+  // Note the tables whose locations may change below, so that their cached
+  // locations can be invalidated once the mutations are published.
+  unordered_set<string> mutated_table_ids;
+  for (const auto& tablet : mutated_tablets) {
+    mutated_table_ids.emplace(tablet->table()->id());
+  }
+
   // 11. Write all tablet mutations to the catalog table.
   //
   // SysCatalogTable::Write will short-circuit the case where the data has not
@@ -3578,6 +3632,10 @@ Status CatalogManager::ProcessTabletReport(
   // 12. Publish the in-memory tablet mutations and release the locks.
   tablets_lock.Commit();
 
+  for (const auto& table_id : mutated_table_ids) {
+    locations_cache_.Invalidate(table_id);
+  }
+
   // 13. Process all tablet schema version changes.
   //
   // This is separate from tablet state mutations because only tablet in-memory
@@ -3657,12 +3715,16 @@ void CatalogManager::SendDeleteTabletRequest(const scoped_refptr<TabletInfo>& ta
 void CatalogManager::ExtractTabletsToProcess(
     vector<scoped_refptr<TabletInfo>>* tablets_to_process) {
 
-  shared_lock<LockType> l(lock_);
+  // Fast path: if the previous scan found no tablets awaiting assignment and
+  // no new tablets have been created since, don't bother scanning. The flag
+  // is cleared here and re-armed below if the scan finds pending tablets, so
+  // a creation racing with the scan just triggers another scan on the next
+  // wakeup.
+  if (!needs_assignment_scan_.CompareAndSet(true, false)) {
+    return;
+  }
 
-  // TODO: At the moment we loop through all the tablets
-  //       we can keep a set of tablets waiting for "assignment"
-  //       or just a counter to avoid to take the lock and loop through the tablets
-  //       if everything is "stable".
+  shared_lock<LockType> l(lock_);
 
   // 'tablets_to_process' elements must be partially ordered in the same way as
   // table->GetAllTablets(); see the locking rules at the top of the file.
@@ -3684,6 +3746,13 @@ void CatalogManager::ExtractTabletsToProcess(
       tablets_to_process->emplace_back(tablet);
     }
   }
+
+  // Keep scanning on subsequent wakeups until every tablet is running: some
+  // of the extracted tablets may be waiting on tablet server heartbeats or
+  // CreateTablet retries to make progress.
+  if (!tablets_to_process->empty()) {
+    needs_assignment_scan_.Store(true);
+  }
 }
 
 // Check if it's time to roll TokenSigner's key. There's a bit of subtlety here:
@@ -4076,14 +4145,14 @@ Status CatalogManager::BuildLocationsForTablet(
     replica_pb->set_role(GetConsensusRole(peer.permanent_uuid(), cstate));
 
     TSInfoPB* tsinfo_pb = replica_pb->mutable_ts_info();
-    tsinfo_pb->set_permanent_uuid(peer.permanent_uuid());
 
     shared_ptr<TSDescriptor> ts_desc;
     if (master_->ts_manager()->LookupTSByUUID(peer.permanent_uuid(), &ts_desc)) {
-      ServerRegistrationPB reg;
-      ts_desc->GetRegistration(&reg);
-      tsinfo_pb->mutable_rpc_addresses()->Swap(reg.mutable_rpc_addresses());
+      // Copies the pre-built TSInfoPB rather than the whole registration
+      // (which also carries HTTP addresses, version info, etc).
+      ts_desc->GetTSInfoPB(tsinfo_pb);
     } else {
+      tsinfo_pb->set_permanent_uuid(peer.permanent_uuid());
       // If we've never received a heartbeat from the tserver, we'll fall back
       // to the last known RPC address in the RaftPeerPB.
       //
@@ -4146,6 +4215,30 @@ Status CatalogManager::GetTableLocations(const GetTableLocationsRequestPB* req,
   }
   RETURN_NOT_OK(CheckIfTableDeletedOrNotRunning(&l, resp));
 
+  // If the client's cached locations are still current, don't rebuild them.
+  uint64_t locations_version = locations_cache_.GetVersion(table->id());
+  if (req->has_cached_locations_version() &&
+      req->cached_locations_version() == locations_version) {
+    resp->set_locations_version(locations_version);
+    resp->set_locations_unchanged(true);
+    resp->set_ttl_millis(FLAGS_table_locations_ttl_ms);
+    return Status::OK();
+  }
+
+  // Serve a previously built response for identical request parameters, if
+  // one is cached at the current version.
+  // The partition keys are length-prefixed so that arbitrary key bytes can't
+  // produce colliding cache keys.
+  const string cache_key = Substitute(
+      "$0|$1:$2|$3:$4|$5|$6", table->id(),
+      req->partition_key_start().size(), req->partition_key_start(),
+      req->partition_key_end().size(), req->partition_key_end(),
+      req->max_returned_locations(), req->replica_type_filter());
+  if (locations_cache_.Lookup(cache_key, locations_version, resp)) {
+    resp->set_ttl_millis(FLAGS_table_locations_ttl_ms);
+    return Status::OK();
+  }
+
   vector<scoped_refptr<TabletInfo>> tablets_in_range;
   table->GetTabletsInRange(req, &tablets_in_range);
 
@@ -4176,6 +4269,10 @@ Status CatalogManager::GetTableLocations(const GetTableLocationsRequestPB* req,
     }
   }
   resp->set_ttl_millis(FLAGS_table_locations_ttl_ms);
+  if (!resp->has_error()) {
+    resp->set_locations_version(locations_version);
+    locations_cache_.Put(cache_key, table->id(), locations_version, *resp);
+  }
   return Status::OK();
 }
 
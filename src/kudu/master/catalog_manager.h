@@ -39,9 +39,11 @@
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/master/master.pb.h"
+#include "kudu/master/table_locations_cache.h"
 #include "kudu/master/ts_manager.h"
 #include "kudu/tserver/tablet_replica_lookup.h"
 #include "kudu/tserver/tserver.pb.h"
+#include "kudu/util/atomic.h"
 #include "kudu/util/cow_object.h"
 #include "kudu/util/locks.h"
 #include "kudu/util/monotime.h"
@@ -573,6 +575,11 @@ class CatalogManager : public tserver::TabletReplicaLookupIf {
 
   SysCatalogTable* sys_catalog() { return sys_catalog_.get(); }
 
+  // Drop all cached table locations responses and advance every table's
+  // locations version. Called when a tserver (re-)registers, since its
+  // addresses may be embedded in any table's cached responses.
+  void InvalidateTableLocationsCache() { locations_cache_.InvalidateAll(); }
+
   // Dump all of the current state about tables and tablets to the
   // given output stream. This is verbose, meant for debugging.
   void DumpState(std::ostream* out) const;
@@ -799,6 +806,17 @@ class CatalogManager : public tserver::TabletReplicaLookupIf {
   void HandleTabletSchemaVersionReport(const scoped_refptr<TabletInfo>& tablet,
                                        uint32_t version);
 
+  // Process the tablets in the range ['batch_begin', 'batch_end') of
+  // 'full_report' on behalf of ProcessTabletReport(). Locks the affected
+  // tables and tablets, performs a single write to the system catalog for
+  // the batch, and appends an update entry to 'full_report_update' for each
+  // processed tablet.
+  Status ProcessTabletReportBatch(TSDescriptor* ts_desc,
+                                  const TabletReportPB& full_report,
+                                  int batch_begin,
+                                  int batch_end,
+                                  TabletReportUpdatesPB* full_report_update);
+
   // Send the "create tablet request" to all peers of a particular tablet.
   //
   // The creation is async, and at the moment there is no error checking on the
@@ -853,6 +871,13 @@ class CatalogManager : public tserver::TabletReplicaLookupIf {
   // Tablet maps: tablet-id -> TabletInfo
   TabletInfoMap tablet_map_;
 
+  // Set when tablets may be awaiting assignment: at leader startup, when new
+  // tablets are created, and whenever a scan of 'tablet_map_' finds tablets
+  // that are not yet running. When clear, ExtractTabletsToProcess() can skip
+  // scanning the tablet maps altogether, so the background task doesn't walk
+  // every tablet once per wakeup on an otherwise stable cluster.
+  AtomicBool needs_assignment_scan_;
+
   // Names of tables that are currently reserved by CreateTable() or
   // AlterTable().
   //
@@ -875,6 +900,9 @@ class CatalogManager : public tserver::TabletReplicaLookupIf {
 
   gscoped_ptr<SysCatalogTable> sys_catalog_;
 
+  // Cache of GetTableLocations responses and per-table locations versions.
+  TableLocationsCache locations_cache_;
+
   // Background thread, used to execute the catalog manager tasks
   // like the assignment and cleaner
   friend class CatalogManagerBgTasks;
@@ -90,6 +90,7 @@ using strings::Substitute;
 
 DECLARE_bool(catalog_manager_check_ts_count_for_create_table);
 DECLARE_double(sys_catalog_fail_during_write);
+DECLARE_int32(catalog_manager_max_tablet_report_batch_size);
 
 namespace kudu {
 namespace master {
@@ -233,6 +234,30 @@ TEST_F(MasterTest, TestRegisterAndHeartbeat) {
     ASSERT_FALSE(resp.has_tablet_report());
   }
 
+  // A heartbeat which asks for an authentication token should be issued one.
+  {
+    TSHeartbeatRequestPB req;
+    TSHeartbeatResponsePB resp;
+    RpcController rpc;
+    req.mutable_common()->CopyFrom(common);
+    req.set_needs_authn_token(true);
+    ASSERT_OK(proxy_->TSHeartbeat(req, &resp, &rpc));
+
+    ASSERT_TRUE(resp.has_authn_token());
+    ASSERT_TRUE(resp.authn_token().has_token_data());
+  }
+
+  // A heartbeat which doesn't ask for a token shouldn't be issued one.
+  {
+    TSHeartbeatRequestPB req;
+    TSHeartbeatResponsePB resp;
+    RpcController rpc;
+    req.mutable_common()->CopyFrom(common);
+    ASSERT_OK(proxy_->TSHeartbeat(req, &resp, &rpc));
+
+    ASSERT_FALSE(resp.has_authn_token());
+  }
+
   // If we send the registration RPC while the master isn't the leader, it
   // shouldn't ask for a full tablet report.
   {
@@ -304,6 +329,27 @@ TEST_F(MasterTest, TestRegisterAndHeartbeat) {
     ASSERT_TRUE(resp.has_tablet_report());
   }
 
+  // A report larger than the batch size limit is processed in multiple
+  // batches; every reported tablet still gets an update entry in the
+  // response.
+  {
+    FLAGS_catalog_manager_max_tablet_report_batch_size = 1;
+    TSHeartbeatRequestPB req;
+    TSHeartbeatResponsePB resp;
+    RpcController rpc;
+    req.mutable_common()->CopyFrom(common);
+    TabletReportPB* tr = req.mutable_tablet_report();
+    tr->set_is_incremental(true);
+    tr->set_sequence_number(0);
+    for (int i = 0; i < 3; i++) {
+      tr->add_updated_tablets()->set_tablet_id(Substitute("tablet-$0", i));
+    }
+    ASSERT_OK(proxy_->TSHeartbeat(req, &resp, &rpc));
+
+    ASSERT_TRUE(resp.has_tablet_report());
+    ASSERT_EQ(3, resp.tablet_report().tablets_size());
+  }
+
   master_->ts_manager()->GetAllDescriptors(&descs);
   ASSERT_EQ(1, descs.size()) << "Should still only have one TS registered";
 
@@ -156,6 +156,9 @@ void MasterServiceImpl::TSHeartbeat(const TSHeartbeatRequestPB* req,
       rpc->RespondFailure(s);
       return;
     }
+    // A (re-)registration may change the addresses embedded in cached
+    // table locations responses.
+    server_->catalog_manager()->InvalidateTableLocationsCache();
   } else {
     Status s = server_->ts_manager()->LookupTS(req->common().ts_instance(), &ts_desc);
     if (s.IsNotFound()) {
@@ -220,6 +223,26 @@ void MasterServiceImpl::TSHeartbeat(const TSHeartbeatRequestPB* req,
     }
   }
 
+  // 8. Only leaders issue authentication tokens, which the tablet server
+  //    uses to authenticate its own intra-cluster RPC connections without
+  //    SASL negotiation round trips. As in ConnectToMaster(), don't issue
+  //    a token to a caller that authenticated with a token: otherwise a
+  //    tablet server could renew its token indefinitely, even after its
+  //    certificate or keytab had been revoked.
+  if (is_leader_master && req->needs_authn_token() &&
+      rpc->remote_user().authenticated_by() != rpc::RemoteUser::AUTHN_TOKEN) {
+    SignedTokenPB authn_token;
+    Status s = server_->token_signer()->GenerateAuthnToken(
+        rpc->remote_user().username(), &authn_token);
+    if (!s.ok()) {
+      KLOG_EVERY_N_SECS(WARNING, 1)
+          << "Unable to generate signed token for " << rpc->requestor_string()
+          << ": " << s.ToString();
+    } else {
+      resp->mutable_authn_token()->Swap(&authn_token);
+    }
+  }
+
   rpc->RespondSuccess();
 }
 
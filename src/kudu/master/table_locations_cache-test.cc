@@ -0,0 +1,118 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#include "kudu/master/table_locations_cache.h"
+
+#include <cstdint>
+#include <string>
+
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+
+#include "kudu/master/master.pb.h"
+#include "kudu/util/test_util.h"
+
+DECLARE_int32(table_locations_cache_max_entries);
+
+using std::string;
+
+namespace kudu {
+namespace master {
+
+class TableLocationsCacheTest : public KuduTest {
+ protected:
+  // Build a trivially distinguishable response.
+  static GetTableLocationsResponsePB MakeResponse(const string& tablet_id) {
+    GetTableLocationsResponsePB resp;
+    resp.add_tablet_locations()->set_tablet_id(tablet_id);
+    return resp;
+  }
+
+  TableLocationsCache cache_;
+};
+
+TEST_F(TableLocationsCacheTest, TestVersionStability) {
+  uint64_t v = cache_.GetVersion("table-a");
+  ASSERT_EQ(v, cache_.GetVersion("table-a"));
+
+  // Distinct tables get distinct versions.
+  ASSERT_NE(v, cache_.GetVersion("table-b"));
+
+  // Invalidation advances the version, but only for the affected table.
+  uint64_t v_b = cache_.GetVersion("table-b");
+  cache_.Invalidate("table-a");
+  ASSERT_NE(v, cache_.GetVersion("table-a"));
+  ASSERT_EQ(v_b, cache_.GetVersion("table-b"));
+}
+
+TEST_F(TableLocationsCacheTest, TestPutLookupInvalidate) {
+  const string kKey = "table-a|0:|0:|10|0";
+  uint64_t v = cache_.GetVersion("table-a");
+  GetTableLocationsResponsePB resp;
+  ASSERT_FALSE(cache_.Lookup(kKey, v, &resp));
+
+  cache_.Put(kKey, "table-a", v, MakeResponse("tablet-1"));
+  ASSERT_TRUE(cache_.Lookup(kKey, v, &resp));
+  ASSERT_EQ(1, resp.tablet_locations_size());
+  ASSERT_EQ("tablet-1", resp.tablet_locations(0).tablet_id());
+
+  // A lookup at any other version misses.
+  ASSERT_FALSE(cache_.Lookup(kKey, v + 1, &resp));
+
+  // Invalidation drops the entry and a stale Put is refused.
+  cache_.Invalidate("table-a");
+  uint64_t v2 = cache_.GetVersion("table-a");
+  ASSERT_FALSE(cache_.Lookup(kKey, v2, &resp));
+  cache_.Put(kKey, "table-a", v, MakeResponse("tablet-1"));
+  ASSERT_FALSE(cache_.Lookup(kKey, v, &resp));
+  ASSERT_FALSE(cache_.Lookup(kKey, v2, &resp));
+}
+
+TEST_F(TableLocationsCacheTest, TestInvalidateAll) {
+  uint64_t v_a = cache_.GetVersion("table-a");
+  uint64_t v_b = cache_.GetVersion("table-b");
+  cache_.Put("key-a", "table-a", v_a, MakeResponse("tablet-a"));
+  cache_.Put("key-b", "table-b", v_b, MakeResponse("tablet-b"));
+
+  cache_.InvalidateAll();
+  ASSERT_NE(v_a, cache_.GetVersion("table-a"));
+  ASSERT_NE(v_b, cache_.GetVersion("table-b"));
+  GetTableLocationsResponsePB resp;
+  ASSERT_FALSE(cache_.Lookup("key-a", v_a, &resp));
+  ASSERT_FALSE(cache_.Lookup("key-b", v_b, &resp));
+}
+
+TEST_F(TableLocationsCacheTest, TestCapacity) {
+  FLAGS_table_locations_cache_max_entries = 1;
+  uint64_t v = cache_.GetVersion("table-a");
+  cache_.Put("key-1", "table-a", v, MakeResponse("tablet-1"));
+  cache_.Put("key-2", "table-a", v, MakeResponse("tablet-2"));
+
+  // Only one of the two entries survives.
+  GetTableLocationsResponsePB resp;
+  int hits = 0;
+  hits += cache_.Lookup("key-1", v, &resp);
+  hits += cache_.Lookup("key-2", v, &resp);
+  ASSERT_EQ(1, hits);
+
+  // Setting the capacity to zero disables caching entirely.
+  FLAGS_table_locations_cache_max_entries = 0;
+  cache_.Put("key-3", "table-a", v, MakeResponse("tablet-3"));
+  ASSERT_FALSE(cache_.Lookup("key-3", v, &resp));
+}
+
+} // namespace master
+} // namespace kudu
@@ -0,0 +1,119 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#include "kudu/master/table_locations_cache.h"
+
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include <gflags/gflags.h>
+
+#include "kudu/gutil/map-util.h"
+#include "kudu/master/master.pb.h"
+#include "kudu/util/flag_tags.h"
+
+DEFINE_int32(table_locations_cache_max_entries, 1000,
+             "Maximum number of cached GetTableLocations responses the master "
+             "will retain. Each entry covers one distinct set of request "
+             "parameters (table, partition key range, count, replica filter). "
+             "Set to 0 to disable response caching; locations versions are "
+             "still maintained.");
+TAG_FLAG(table_locations_cache_max_entries, advanced);
+TAG_FLAG(table_locations_cache_max_entries, runtime);
+
+using std::shared_ptr;
+using std::string;
+
+namespace kudu {
+namespace master {
+
+TableLocationsCache::TableLocationsCache()
+    : next_version_(1) {
+}
+
+uint64_t TableLocationsCache::GetVersion(const string& table_id) {
+  std::lock_guard<simple_spinlock> l(lock_);
+  return LookupOrInsert(&table_versions_, table_id, next_version_++);
+}
+
+bool TableLocationsCache::Lookup(const string& key, uint64_t version,
+                                 GetTableLocationsResponsePB* resp) {
+  shared_ptr<const GetTableLocationsResponsePB> cached;
+  {
+    std::lock_guard<simple_spinlock> l(lock_);
+    const Entry* entry = FindOrNull(entries_, key);
+    if (!entry || entry->version != version) {
+      return false;
+    }
+    cached = entry->resp;
+  }
+  // Copy outside the lock; responses can be large.
+  resp->CopyFrom(*cached);
+  return true;
+}
+
+void TableLocationsCache::Put(const string& key,
+                              const string& table_id,
+                              uint64_t version,
+                              const GetTableLocationsResponsePB& resp) {
+  int32_t max_entries = FLAGS_table_locations_cache_max_entries;
+  if (max_entries <= 0) {
+    return;
+  }
+  Entry entry;
+  entry.table_id = table_id;
+  entry.version = version;
+  // Copy outside the lock; responses can be large.
+  entry.resp = std::make_shared<GetTableLocationsResponsePB>(resp);
+
+  std::lock_guard<simple_spinlock> l(lock_);
+  // If an invalidation raced with the response being built, its version no
+  // longer matches and the entry would never be served; don't store it.
+  uint64_t cur_version = LookupOrInsert(&table_versions_, table_id, next_version_++);
+  if (cur_version != version) {
+    return;
+  }
+  // Evict an arbitrary entry when at capacity. Entries are dropped wholesale
+  // on invalidation, so a smarter eviction policy isn't worth its overhead.
+  while (entries_.size() >= max_entries && !entries_.empty()) {
+    entries_.erase(entries_.begin());
+  }
+  entries_[key] = std::move(entry);
+}
+
+void TableLocationsCache::Invalidate(const string& table_id) {
+  std::lock_guard<simple_spinlock> l(lock_);
+  table_versions_[table_id] = next_version_++;
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->second.table_id == table_id) {
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void TableLocationsCache::InvalidateAll() {
+  std::lock_guard<simple_spinlock> l(lock_);
+  for (auto& e : table_versions_) {
+    e.second = next_version_++;
+  }
+  entries_.clear();
+}
+
+} // namespace master
+} // namespace kudu
@@ -0,0 +1,103 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#ifndef KUDU_MASTER_TABLE_LOCATIONS_CACHE_H
+#define KUDU_MASTER_TABLE_LOCATIONS_CACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "kudu/gutil/macros.h"
+#include "kudu/util/locks.h"
+
+namespace kudu {
+namespace master {
+
+class GetTableLocationsResponsePB;
+
+// A cache of fully-built GetTableLocations responses, plus a per-table
+// locations version counter.
+//
+// Building a GetTableLocationsResponsePB walks every tablet in the requested
+// range, taking per-tablet metadata locks and copying tserver registrations;
+// with large tables and a storm of clients starting up, this dominates master
+// CPU. Since tablet assignments change rarely relative to how often they're
+// read, the master can instead serve a cached response keyed by the request
+// parameters, invalidated whenever the underlying state changes.
+//
+// Each table has a monotonically increasing locations version. Any change
+// which could alter a locations response for the table — a tablet state or
+// consensus change from a tablet report, an alter/delete of the table, or a
+// tserver (re-)registration changing addresses embedded in responses —
+// advances the version and drops the table's cached entries. The version is
+// returned to clients, which may present it on later requests to short-
+// circuit the case where nothing has changed.
+//
+// This class is thread-safe.
+class TableLocationsCache {
+ public:
+  TableLocationsCache();
+
+  // Return the current locations version for 'table_id', assigning a fresh
+  // version if the table doesn't have one yet.
+  uint64_t GetVersion(const std::string& table_id);
+
+  // If a response cached under 'key' at exactly 'version' exists, copy it
+  // into 'resp' and return true.
+  bool Lookup(const std::string& key, uint64_t version,
+              GetTableLocationsResponsePB* resp);
+
+  // Cache 'resp' under 'key' at 'version' on behalf of 'table_id'.
+  void Put(const std::string& key,
+           const std::string& table_id,
+           uint64_t version,
+           const GetTableLocationsResponsePB& resp);
+
+  // Drop cached responses for 'table_id' and advance its version.
+  void Invalidate(const std::string& table_id);
+
+  // Drop all cached responses and advance every known table's version. Used
+  // when a tserver's registration changes, which can alter the addresses
+  // embedded in any table's responses.
+  void InvalidateAll();
+
+ private:
+  struct Entry {
+    std::string table_id;
+    uint64_t version;
+    std::shared_ptr<const GetTableLocationsResponsePB> resp;
+  };
+
+  mutable simple_spinlock lock_;
+
+  // Next version to assign; versions are unique across tables.
+  uint64_t next_version_;
+
+  // Current locations version per table.
+  std::unordered_map<std::string, uint64_t> table_versions_;
+
+  // Cached responses, keyed by the serialized request parameters.
+  std::unordered_map<std::string, Entry> entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(TableLocationsCache);
+};
+
+} // namespace master
+} // namespace kudu
+
+#endif
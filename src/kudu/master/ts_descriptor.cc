@@ -31,6 +31,7 @@
 #include "kudu/common/wire_protocol.pb.h"
 #include "kudu/consensus/consensus.proxy.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/master/master.pb.h"
 #include "kudu/tserver/tserver_admin.proxy.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/net/net_util.h"
@@ -135,6 +136,12 @@ Status TSDescriptor::Register(const NodeInstancePB& instance,
 
   latest_seqno_ = instance.instance_seqno();
   registration_.reset(new ServerRegistrationPB(registration));
+
+  gscoped_ptr<TSInfoPB> ts_info(new TSInfoPB);
+  ts_info->set_permanent_uuid(permanent_uuid_);
+  ts_info->mutable_rpc_addresses()->CopyFrom(registration.rpc_addresses());
+  ts_info_.swap(ts_info);
+
   ts_admin_proxy_.reset();
   consensus_proxy_.reset();
 
@@ -196,6 +203,12 @@ void TSDescriptor::GetRegistration(ServerRegistrationPB* reg) const {
   CHECK_NOTNULL(reg)->CopyFrom(*registration_);
 }
 
+void TSDescriptor::GetTSInfoPB(TSInfoPB* ts_info) const {
+  std::lock_guard<simple_spinlock> l(lock_);
+  CHECK(ts_info_) << "No registration";
+  CHECK_NOTNULL(ts_info)->CopyFrom(*ts_info_);
+}
+
 void TSDescriptor::GetNodeInstancePB(NodeInstancePB* instance_pb) const {
   std::lock_guard<simple_spinlock> l(lock_);
   instance_pb->set_permanent_uuid(permanent_uuid_);
@@ -52,6 +52,8 @@ class TabletServerAdminServiceProxy;
 
 namespace master {
 
+class TSInfoPB;
+
 // Master-side view of a single tablet server.
 //
 // Tracks the last heartbeat, status, instance identifier, etc.
@@ -86,6 +88,12 @@ class TSDescriptor {
   // may be mutated at any point if the tablet server re-registers.
   void GetRegistration(ServerRegistrationPB* reg) const;
 
+  // Copy the TSInfoPB (UUID and RPC addresses) describing this server into
+  // 'ts_info'. The PB is pre-built at registration time, so this copies
+  // just the fields that tablet location responses need rather than the
+  // whole registration.
+  void GetTSInfoPB(TSInfoPB* ts_info) const;
+
   void GetNodeInstancePB(NodeInstancePB* instance_pb) const;
 
   // Return an RPC proxy to the tablet server admin service.
@@ -153,6 +161,10 @@ class TSDescriptor {
 
   gscoped_ptr<ServerRegistrationPB> registration_;
 
+  // Pre-built PB describing this server in tablet location responses.
+  // Rebuilt whenever the server re-registers.
+  gscoped_ptr<TSInfoPB> ts_info_;
+
   std::shared_ptr<tserver::TabletServerAdminServiceProxy> ts_admin_proxy_;
   std::shared_ptr<consensus::ConsensusServiceProxy> consensus_proxy_;
 
@@ -59,6 +59,7 @@ using std::unique_ptr;
 
 using strings::Substitute;
 
+DECLARE_bool(rpc_compress_connections);
 DECLARE_bool(rpc_encrypt_loopback_connections);
 
 namespace kudu {
@@ -189,6 +190,21 @@ Status ClientNegotiation::Negotiate(unique_ptr<ErrorStatusPB>* rpc_error) {
       tls_handshake_.set_verification_mode(security::TlsVerificationMode::VERIFY_NONE);
     }
 
+    // Offer to resume a TLS session from a previous connection to this
+    // server, so that the server can skip the certificate exchange and key
+    // agreement with an abbreviated handshake. The cache key includes the
+    // authentication type, since the verification mode of the handshake which
+    // produced the cached session depends on it.
+    Sockaddr remote;
+    if (socket_->GetPeerAddress(&remote).ok()) {
+      tls_session_cache_key_ = Substitute(
+          "$0/$1", remote.ToString(), AuthenticationTypeToString(negotiated_authn_));
+      auto session = tls_context_->GetCachedSession(tls_session_cache_key_);
+      if (session) {
+        tls_handshake_.set_session(std::move(session));
+      }
+    }
+
     // To initiate the TLS handshake, we pretend as if the server sent us an
     // empty TLS_HANDSHAKE token.
     NegotiatePB initial;
@@ -316,6 +332,10 @@ Status ClientNegotiation::SendNegotiate() {
     }
   }
 
+  if (FLAGS_rpc_compress_connections) {
+    client_features_.insert(LZ4_COMPRESSION);
+  }
+
   for (RpcFeatureFlag feature : client_features_) {
     msg.add_supported_features(feature);
   }
@@ -492,7 +512,24 @@ Status ClientNegotiation::HandleTlsHandshake(const NegotiatePB& response) {
   // an Incomplete status.
   RETURN_NOT_OK(s);
 
+  // When resuming a TLS session with an abbreviated handshake, the client
+  // speaks last: our side of the handshake is complete, but the final token
+  // still needs to be sent to the server.
+  if (!token.empty()) {
+    RETURN_NOT_OK(SendTlsHandshake(std::move(token)));
+  }
+
   // TLS handshake is finished.
+  if (tls_handshake_.IsSessionReused()) {
+    TRACE("TLS session resumed");
+  }
+  if (!tls_session_cache_key_.empty()) {
+    // Cache the negotiated session (along with the session ticket the server
+    // issued with it) so that future connections to this server can attempt
+    // resumption.
+    tls_context_->CacheSession(tls_session_cache_key_, tls_handshake_.GetSession());
+  }
+
   if (ContainsKey(server_features_, TLS_AUTHENTICATION_ONLY) &&
       ContainsKey(client_features_, TLS_AUTHENTICATION_ONLY)) {
     TRACE("Negotiated auth-only $0 with cipher $1",
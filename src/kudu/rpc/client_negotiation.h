@@ -229,6 +229,11 @@ class ClientNegotiation {
   const RpcEncryption encryption_;
   bool tls_negotiated_;
 
+  // The key under which TLS sessions to this server are cached in the
+  // TlsContext for later resumption. Empty if the peer address could not be
+  // determined.
+  std::string tls_session_cache_key_;
+
   // TSK state.
   boost::optional<security::SignedTokenPB> authn_token_;
 
@@ -17,6 +17,8 @@
 
 #include "kudu/rpc/connection.h"
 
+#include <sys/uio.h>
+
 #include <algorithm>
 #include <cerrno>
 #include <cstddef>
@@ -30,6 +32,7 @@
 #include <boost/intrusive/detail/list_iterator.hpp>
 #include <boost/intrusive/list.hpp>
 #include <ev.h>
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 
 #include "kudu/gutil/map-util.h"
@@ -45,10 +48,34 @@
 #include "kudu/rpc/rpc_header.pb.h"
 #include "kudu/rpc/rpc_introspection.pb.h"
 #include "kudu/rpc/transfer.h"
+#include "kudu/util/compression/compression_codec.h"
+#include "kudu/util/flag_tags.h"
 #include "kudu/util/net/sockaddr.h"
 #include "kudu/util/net/socket.h"
 #include "kudu/util/status.h"
 
+DEFINE_int32(rpc_compression_min_message_size, 4 * 1024,
+             "The minimum size of an RPC message, in bytes, for it to be "
+             "compressed before being sent. Only takes effect on connections "
+             "where both sides enabled --rpc_compress_connections. Messages "
+             "smaller than this are sent uncompressed, since compressing them "
+             "is unlikely to save enough bandwidth to justify the CPU cost.");
+TAG_FLAG(rpc_compression_min_message_size, advanced);
+TAG_FLAG(rpc_compression_min_message_size, runtime);
+
+DEFINE_int32(rpc_small_transfer_max_size, 64 * 1024,
+             "The maximum size of an outbound RPC transfer, in bytes, for it "
+             "to be considered 'small'. Small transfers may be sent ahead of "
+             "larger transfers which are already queued on the same "
+             "connection but have not yet started sending, so that e.g. a "
+             "small write acknowledgement is not delayed behind a large scan "
+             "response sharing the connection. Set to 0 to disable "
+             "reordering and send all transfers in queue order.");
+TAG_FLAG(rpc_small_transfer_max_size, advanced);
+TAG_FLAG(rpc_small_transfer_max_size, runtime);
+
+DECLARE_bool(rpc_compress_connections);
+
 using std::function;
 using std::includes;
 using std::set;
@@ -61,6 +88,20 @@ namespace rpc {
 
 typedef OutboundCall::Phase Phase;
 
+namespace {
+
+// The maximum number of iovecs gathered from queued transfers into a single
+// writev() call by WriteHandler(). This must not exceed IOV_MAX (1024 on
+// Linux); past a certain batch size the syscall savings are negligible.
+const size_t kMaxWritevIovecs = 64;
+
+// The maximum number of times a large queued transfer may be overtaken by
+// small transfers queued after it, to bound the extra latency the
+// reordering in QueueOutbound() can add to a large transfer.
+const int kMaxTransferBypasses = 64;
+
+} // anonymous namespace
+
 ///
 /// Connection
 ///
@@ -76,6 +117,7 @@ Connection::Connection(ReactorThread *reactor_thread,
       last_activity_time_(MonoTime::Now()),
       is_epoll_registered_(false),
       next_call_id_(1),
+      compression_codec_(nullptr),
       credentials_policy_(policy),
       negotiation_complete_(false),
       scheduled_for_shutdown_(false) {
@@ -94,6 +136,8 @@ void Connection::EpollRegister(ev::loop_ref& loop) {
   if (direction_ == CLIENT && negotiation_complete_) {
     write_io_.start();
   }
+  cork_timer_.set(loop);
+  cork_timer_.set<Connection, &Connection::CorkTimerHandler>(this); // NOLINT(*)
   read_io_.set(loop);
   read_io_.set(socket_->GetFd(), ev::READ);
   read_io_.set<Connection, &Connection::ReadHandler>(this);
@@ -183,12 +227,24 @@ void Connection::Shutdown(const Status &status,
 
   read_io_.stop();
   write_io_.stop();
+  cork_timer_.stop();
   is_epoll_registered_ = false;
   if (socket_) {
     WARN_NOT_OK(socket_->Close(), "Error closing socket");
   }
 }
 
+void Connection::set_remote_features(set<RpcFeatureFlag> remote_features) {
+  remote_features_ = std::move(remote_features);
+  if (FLAGS_rpc_compress_connections &&
+      ContainsKey(remote_features_, LZ4_COMPRESSION)) {
+    // Once compression has been negotiated, both sides frame every message
+    // for it, so a missing codec here would be a protocol error. LZ4 is
+    // always compiled in, so this cannot fail.
+    CHECK_OK(GetCompressionCodec(LZ4, &compression_codec_));
+  }
+}
+
 void Connection::QueueOutbound(gscoped_ptr<OutboundTransfer> transfer) {
   DCHECK(reactor_thread_->IsCurrentThread());
 
@@ -199,14 +255,71 @@ void Connection::QueueOutbound(gscoped_ptr<OutboundTransfer> transfer) {
     return;
   }
 
+  // Only frame transfers for compression once negotiation has completed:
+  // until then 'compression_codec_' hasn't been set (it's assigned by the
+  // negotiation thread, and is only safe to read here after the completion
+  // task has run on this thread), and whether the connection compresses at
+  // all isn't yet known. Transfers queued in the meantime are framed in
+  // MarkNegotiationComplete().
+  if (negotiation_complete_ && compression_codec_ != nullptr) {
+    Status s = transfer->MaybeCompressPayload(compression_codec_,
+                                              FLAGS_rpc_compression_min_message_size);
+    if (PREDICT_FALSE(!s.ok())) {
+      transfer->Abort(s.CloneAndPrepend("failed to compress RPC transfer"));
+      return;
+    }
+  }
+
   DVLOG(3) << "Queueing transfer: " << transfer->HexDump();
 
-  outbound_transfers_.push_back(*transfer.release());
+  // Transfers on a connection are matched up by call ID rather than by their
+  // order on the wire, so whole transfers may be reordered freely as long as
+  // no transfer is preempted once it has started sending. Let a small
+  // transfer jump ahead of a queued large one (e.g. a scan response) so that
+  // it isn't stuck behind many milliseconds of bulk data, but give up once
+  // the large transfer has been bypassed too many times so it can't be
+  // starved indefinitely.
+  const int32_t small_max_size = FLAGS_rpc_small_transfer_max_size;
+  if (small_max_size > 0 && transfer->TotalLength() <= small_max_size) {
+    auto it = outbound_transfers_.begin();
+    while (it != outbound_transfers_.end() &&
+           (it->started() ||
+            it->TotalLength() <= small_max_size ||
+            it->bypass_count() >= kMaxTransferBypasses)) {
+      ++it;
+    }
+    if (it != outbound_transfers_.end()) {
+      it->IncrementBypassCount();
+      outbound_transfers_.insert(it, *transfer.release());
+    } else {
+      outbound_transfers_.push_back(*transfer.release());
+    }
+  } else {
+    outbound_transfers_.push_back(*transfer.release());
+  }
 
   if (negotiation_complete_ && !write_io_.is_active()) {
     // If we weren't currently in the middle of sending anything,
     // then our write_io_ interest is stopped. Need to re-start it.
     // Only do this after connection negotiation is done doing its work.
+    const MonoDelta& cork = reactor_thread_->transfer_cork_duration();
+    if (cork.ToNanoseconds() > 0) {
+      // With corking enabled, hold off on starting the write watcher for a
+      // short time so that subsequently-queued transfers can be flushed
+      // together with a single writev().
+      if (!cork_timer_.is_active()) {
+        cork_timer_.set(cork.ToSeconds(), 0);
+        cork_timer_.start();
+      }
+    } else {
+      write_io_.start();
+    }
+  }
+}
+
+void Connection::CorkTimerHandler(ev::timer& /*watcher*/, int /*revents*/) {
+  DCHECK(reactor_thread_->IsCurrentThread());
+  if (!outbound_transfers_.empty() && negotiation_complete_ && !write_io_.is_active()) {
     write_io_.start();
   }
 }
@@ -215,18 +328,26 @@ Connection::CallAwaitingResponse::~CallAwaitingResponse() {
   DCHECK(conn->reactor_thread_->IsCurrentThread());
 }
 
-void Connection::CallAwaitingResponse::HandleTimeout(ev::timer &watcher, int revents) {
+void Connection::CallAwaitingResponse::HandleTimeout(ev::timer& /*watcher*/, int /*revents*/) {
+  // Short-timeout calls don't use the two-stage timeout, so there is nothing
+  // to re-arm here.
+  DCHECK_EQ(0, remaining_timeout);
+  conn->HandleOutboundCallTimeout(this);
+}
+
+void Connection::CallAwaitingResponse::HandleTimerExpired() {
   if (remaining_timeout > 0) {
-    if (watcher.remaining() < -1.0) {
+    double late = (MonoTime::Now() - expiry()).ToSeconds();
+    if (late > 1.0) {
       LOG(WARNING) << "RPC call timeout handler was delayed by "
-                   << -watcher.remaining() << "s! This may be due to a process-wide "
+                   << late << "s! This may be due to a process-wide "
                    << "pause such as swapping, logging-related delays, or allocator lock "
                    << "contention. Will allow an additional "
                    << remaining_timeout << "s for a response.";
     }
 
-    watcher.set(remaining_timeout, 0);
-    watcher.start();
+    conn->reactor_thread_->ScheduleCoarseTimeout(
+        this, MonoTime::Now() + MonoDelta::FromSeconds(remaining_timeout));
     remaining_timeout = 0;
     return;
   }
@@ -346,13 +467,9 @@ void Connection::QueueOutboundCall(const shared_ptr<OutboundCall> &call) {
   car->conn = this;
   car->call = call;
 
-  // Set up the timeout timer.
+  // Set up the timeout tracking.
   const MonoDelta &timeout = call->controller()->timeout();
   if (timeout.Initialized()) {
-    reactor_thread_->RegisterTimeout(&car->timeout_timer);
-    car->timeout_timer.set<CallAwaitingResponse, // NOLINT(*)
-                           &CallAwaitingResponse::HandleTimeout>(car.get());
-
     // For calls with a timeout of at least 500ms, we actually run the timeout
     // handler in two stages. The first timeout fires with a timeout 10% less
     // than the user-specified one. It then schedules a second timeout for the
@@ -382,12 +499,23 @@ void Connection::QueueOutboundCall(const shared_ptr<OutboundCall> &call) {
     if (time >= 0.5) {
       car->remaining_timeout = time * 0.1;
       time -= car->remaining_timeout;
+
+      // Long-timeout calls (the common case) are tracked on the reactor's
+      // coarse timer wheel: O(1) to arm and O(1) to cancel when the response
+      // arrives, vs. O(lg n) heap maintenance for a libev timer. The wheel's
+      // tick granularity is noise relative to timeouts of this length.
+      reactor_thread_->ScheduleCoarseTimeout(
+          car.get(), MonoTime::Now() + MonoDelta::FromSeconds(time));
     } else {
+      // Short-timeout calls keep a precise per-call libev timer, since the
+      // wheel tick would be a significant fraction of the timeout.
       car->remaining_timeout = 0;
+      reactor_thread_->RegisterTimeout(&car->timeout_timer);
+      car->timeout_timer.set<CallAwaitingResponse, // NOLINT(*)
+                             &CallAwaitingResponse::HandleTimeout>(car.get());
+      car->timeout_timer.set(time, 0);
+      car->timeout_timer.start();
     }
-
-    car->timeout_timer.set(time, 0);
-    car->timeout_timer.start();
   }
 
   TransferCallbacks *cb = new CallTransferCallbacks(call, this);
@@ -519,6 +647,15 @@ void Connection::ReadHandler(ev::io &watcher, int revents) {
     }
     DVLOG(3) << ToString() << ": finished reading " << inbound_->data().size() << " bytes";
 
+    if (compression_codec_ != nullptr) {
+      Status s = inbound_->UncompressPayload(compression_codec_);
+      if (PREDICT_FALSE(!s.ok())) {
+        LOG(WARNING) << ToString() << " decompression error: " << s.ToString();
+        reactor_thread_->DestroyConnection(this, s);
+        return;
+      }
+    }
+
     if (direction_ == CLIENT) {
       HandleCallResponse(std::move(inbound_));
     } else if (direction_ == SERVER) {
@@ -575,7 +712,8 @@ void Connection::HandleCallResponse(gscoped_ptr<InboundTransfer> transfer) {
     return;
   }
 
-  // The car->timeout_timer ev::timer will be stopped automatically by its destructor.
+  // The car's timeout tracking (timer wheel entry or ev::timer, depending on
+  // the timeout length) is torn down automatically by its destructor.
   scoped_car car(car_pool_.make_scoped_ptr(car_ptr));
 
   if (PREDICT_FALSE(!car->call)) {
@@ -591,6 +729,47 @@ void Connection::HandleCallResponse(gscoped_ptr<InboundTransfer> transfer) {
   MaybeInjectCancellation(car->call);
 }
 
+bool Connection::StartTransfer(OutboundTransfer* transfer) {
+  DCHECK(reactor_thread_->IsCurrentThread());
+  DCHECK(!transfer->started());
+  transfer->set_started();
+
+  if (!transfer->is_for_outbound_call()) {
+    return true;
+  }
+
+  CallAwaitingResponse* car = FindOrDie(awaiting_response_, transfer->call_id());
+  if (!car->call) {
+    // If the call has already timed out or has already been cancelled, the 'call'
+    // field would be set to NULL. In that case, don't bother sending it.
+    transfer->Abort(Status::Aborted("already timed out or cancelled"));
+    return false;
+  }
+
+  // Before any of the transfer's bytes hit the socket, check if the server has
+  // the required RPC flags. We have to wait until just before the transfer in
+  // order to ensure that the negotiation has taken place, so that the flags
+  // are available.
+  const set<RpcFeatureFlag>& required_features = car->call->required_rpc_features();
+  if (!includes(remote_features_.begin(), remote_features_.end(),
+                required_features.begin(), required_features.end())) {
+    Status s = Status::NotSupported("server does not support the required RPC features");
+    transfer->Abort(s);
+    Phase phase = negotiation_complete_ ? Phase::REMOTE_CALL : Phase::CONNECTION_NEGOTIATION;
+    car->call->SetFailed(std::move(s), phase);
+    // Test cancellation when 'call_' is in 'FINISHED_ERROR' state.
+    MaybeInjectCancellation(car->call);
+    car->call.reset();
+    return false;
+  }
+
+  car->call->SetSending();
+
+  // Test cancellation when 'call_' is in 'SENDING' state.
+  MaybeInjectCancellation(car->call);
+  return true;
+}
+
 void Connection::WriteHandler(ev::io &watcher, int revents) {
   DCHECK(reactor_thread_->IsCurrentThread());
 
@@ -612,60 +791,61 @@ void Connection::WriteHandler(ev::io &watcher, int revents) {
   while (!outbound_transfers_.empty()) {
     transfer = &(outbound_transfers_.front());
 
-    if (!transfer->TransferStarted()) {
-
-      if (transfer->is_for_outbound_call()) {
-        CallAwaitingResponse* car = FindOrDie(awaiting_response_, transfer->call_id());
-        if (!car->call) {
-          // If the call has already timed out or has already been cancelled, the 'call'
-          // field would be set to NULL. In that case, don't bother sending it.
-          outbound_transfers_.pop_front();
-          transfer->Abort(Status::Aborted("already timed out or cancelled"));
-          delete transfer;
-          continue;
-        }
-
-        // If this is the start of the transfer, then check if the server has the
-        // required RPC flags. We have to wait until just before the transfer in
-        // order to ensure that the negotiation has taken place, so that the flags
-        // are available.
-        const set<RpcFeatureFlag>& required_features = car->call->required_rpc_features();
-        if (!includes(remote_features_.begin(), remote_features_.end(),
-                      required_features.begin(), required_features.end())) {
-          outbound_transfers_.pop_front();
-          Status s = Status::NotSupported("server does not support the required RPC features");
-          transfer->Abort(s);
-          Phase phase = negotiation_complete_ ? Phase::REMOTE_CALL : Phase::CONNECTION_NEGOTIATION;
-          car->call->SetFailed(std::move(s), phase);
-          // Test cancellation when 'call_' is in 'FINISHED_ERROR' state.
-          MaybeInjectCancellation(car->call);
-          car->call.reset();
-          delete transfer;
-          continue;
-        }
-
-        car->call->SetSending();
-
-        // Test cancellation when 'call_' is in 'SENDING' state.
-        MaybeInjectCancellation(car->call);
-      }
+    if (!transfer->started() && !StartTransfer(transfer)) {
+      outbound_transfers_.pop_front();
+      delete transfer;
+      continue;
     }
 
     last_activity_time_ = reactor_thread_->cur_time();
-    Status status = transfer->SendBuffer(*socket_);
+
+    // Gather as many queued transfers as will fit into a single writev(),
+    // so that a backlog of small messages (e.g. from a batcher-heavy client)
+    // is flushed with one syscall rather than one per transfer.
+    struct iovec iov[kMaxWritevIovecs];
+    size_t n_iov = transfer->FillIovecs(iov, kMaxWritevIovecs);
+    auto batch_end = outbound_transfers_.iterator_to(*transfer);
+    ++batch_end;
+    while (batch_end != outbound_transfers_.end() && n_iov < kMaxWritevIovecs) {
+      OutboundTransfer* next_transfer = &*batch_end;
+      if (!next_transfer->started() && !StartTransfer(next_transfer)) {
+        batch_end = outbound_transfers_.erase(batch_end);
+        delete next_transfer;
+        continue;
+      }
+      n_iov += next_transfer->FillIovecs(&iov[n_iov], kMaxWritevIovecs - n_iov);
+      ++batch_end;
+    }
+
+    int32_t written = 0;
+    Status status = socket_->Writev(iov, n_iov, &written);
     if (PREDICT_FALSE(!status.ok())) {
+      if (Socket::IsTemporarySocketError(status.posix_code())) {
+        // The socket's send buffer filled up; wait for the next
+        // ready-to-write callback.
+        return;
+      }
       LOG(WARNING) << ToString() << " send error: " << status.ToString();
       reactor_thread_->DestroyConnection(this, status);
       return;
     }
 
-    if (!transfer->TransferFinished()) {
-      DVLOG(3) << ToString() << ": writeHandler: xfer not finished.";
-      return;
+    // Distribute the written bytes over the batched transfers, retiring those
+    // which were fully sent. The batch is a prefix of the queue, so this
+    // cannot run past its end.
+    int64_t rem = written;
+    while (!outbound_transfers_.empty()) {
+      transfer = &(outbound_transfers_.front());
+      transfer->TransferSent(&rem);
+      if (!transfer->TransferFinished()) {
+        DCHECK_EQ(0, rem);
+        DVLOG(3) << ToString() << ": writeHandler: xfer not finished.";
+        return;
+      }
+      outbound_transfers_.pop_front();
+      delete transfer;
+      if (rem == 0) break;
     }
-
-    outbound_transfers_.pop_front();
-    delete transfer;
   }
 
   // If we were able to write all of our outbound transfers,
@@ -725,6 +905,25 @@ void Connection::CompleteNegotiation(Status negotiation_status,
 void Connection::MarkNegotiationComplete() {
   DCHECK(reactor_thread_->IsCurrentThread());
   negotiation_complete_ = true;
+  if (compression_codec_ == nullptr) {
+    return;
+  }
+  // Calls may have been queued while negotiation was still in flight, before
+  // the codec was known. None of them has started sending -- writes only
+  // begin once negotiation completes -- so frame them for compression now.
+  for (auto it = outbound_transfers_.begin(); it != outbound_transfers_.end();) {
+    OutboundTransfer* transfer = &*it;
+    DCHECK(!transfer->started());
+    Status s = transfer->MaybeCompressPayload(compression_codec_,
+                                              FLAGS_rpc_compression_min_message_size);
+    if (PREDICT_FALSE(!s.ok())) {
+      it = outbound_transfers_.erase(it);
+      transfer->Abort(s.CloneAndPrepend("failed to compress RPC transfer"));
+      delete transfer;
+      continue;
+    }
+    ++it;
+  }
 }
 
 Status Connection::DumpPB(const DumpRunningRpcsRequestPB& req,
@@ -38,6 +38,7 @@
 #include "kudu/rpc/rpc_controller.h"
 #include "kudu/rpc/rpc_header.pb.h"
 #include "kudu/rpc/remote_user.h"
+#include "kudu/rpc/timer_wheel.h"
 #include "kudu/rpc/transfer.h"
 #include "kudu/util/monotime.h"
 #include "kudu/util/net/sockaddr.h"
@@ -47,6 +48,8 @@
 
 namespace kudu {
 
+class CompressionCodec;
+
 namespace rpc {
 
 class DumpRunningRpcsRequestPB;
@@ -198,9 +201,9 @@ class Connection : public RefCountedThreadSafe<Connection> {
     socket_ = std::move(socket);
   }
 
-  void set_remote_features(std::set<RpcFeatureFlag> remote_features) {
-    remote_features_ = std::move(remote_features);
-  }
+  // Record the RPC features supported by the remote end of the connection,
+  // and enable payload compression if it was negotiated by both sides.
+  void set_remote_features(std::set<RpcFeatureFlag> remote_features);
 
   void set_remote_user(RemoteUser user) {
     DCHECK_EQ(direction_, SERVER);
@@ -233,12 +236,23 @@ class Connection : public RefCountedThreadSafe<Connection> {
 
   // A call which has been fully sent to the server, which we're waiting for
   // the server to process. This is used on the client side only.
-  struct CallAwaitingResponse {
+  //
+  // Timeouts are tracked on the reactor's coarse timer wheel (see
+  // ReactorThread::ScheduleCoarseTimeout()), except for very short timeouts,
+  // which keep a precise per-call libev timer since a wheel tick would be a
+  // significant fraction of the timeout itself. Destruction unschedules from
+  // the wheel automatically via ~TimerWheelEntry().
+  struct CallAwaitingResponse : public TimerWheelEntry {
     ~CallAwaitingResponse();
 
-    // Notification from libev that the call has timed out.
+    // Notification from libev that the call has timed out (short-timeout
+    // calls only).
     void HandleTimeout(ev::timer &watcher, int revents);
 
+    // Notification from the reactor's timer wheel that the call has timed
+    // out (all other calls).
+    void HandleTimerExpired() override;
+
     Connection *conn;
     std::shared_ptr<OutboundCall> call;
     ev::timer timeout_timer;
@@ -282,6 +296,19 @@ class Connection : public RefCountedThreadSafe<Connection> {
   // This must be called from the reactor thread.
   void QueueOutbound(gscoped_ptr<OutboundTransfer> transfer);
 
+  // Perform the checks required before any bytes of 'transfer' may be sent,
+  // e.g. that the associated call has not been cancelled and that the remote
+  // supports its required features. Returns true if the transfer may be sent.
+  // Otherwise, aborts the transfer (and fails the associated call, if any)
+  // and returns false; the caller is responsible for removing the transfer
+  // from the outbound queue and deleting it.
+  bool StartTransfer(OutboundTransfer* transfer);
+
+  // libev callback when the transfer cork duration has elapsed. Starts the
+  // write watcher to flush whatever transfers have accumulated in the
+  // meantime. See MessengerBuilder::set_transfer_cork_duration().
+  void CorkTimerHandler(ev::timer& watcher, int revents);
+
   // Internal test function for injecting cancellation request when 'call'
   // reaches state specified in 'FLAGS_rpc_inject_cancellation_state'.
   void MaybeInjectCancellation(const std::shared_ptr<OutboundCall> &call);
@@ -314,6 +341,11 @@ class Connection : public RefCountedThreadSafe<Connection> {
   // notifies us when our socket is writable.
   ev::io write_io_;
 
+  // Fires when a cork duration expires, at which point 'write_io_' is
+  // started. Only used when the messenger has a non-zero transfer cork
+  // duration configured.
+  ev::timer cork_timer_;
+
   // notifies us when our socket is readable.
   ev::io read_io_;
 
@@ -341,6 +373,10 @@ class Connection : public RefCountedThreadSafe<Connection> {
   // RPC features supported by the remote end of the connection.
   std::set<RpcFeatureFlag> remote_features_;
 
+  // Codec used to compress transfers on this connection, or NULL if
+  // compression was not negotiated.
+  const CompressionCodec* compression_codec_;
+
   // Pool from which CallAwaitingResponse objects are allocated.
   // Also a funny name.
   ObjectPool<CallAwaitingResponse> car_pool_;
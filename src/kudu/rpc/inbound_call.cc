@@ -21,6 +21,7 @@
 #include <memory>
 #include <ostream>
 
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 #include <google/protobuf/message.h>
 #include <google/protobuf/message_lite.h>
@@ -36,10 +37,23 @@
 #include "kudu/rpc/service_if.h"
 #include "kudu/rpc/transfer.h"
 #include "kudu/util/debug/trace_event.h"
+#include "kudu/util/flag_tags.h"
+#include "kudu/util/memory/arena.h"
 #include "kudu/util/metrics.h"
 #include "kudu/util/net/sockaddr.h"
 #include "kudu/util/trace.h"
 
+DEFINE_int32(rpc_trace_sample_period, 0,
+             "If set to a positive value N, attach a trace to roughly one in "
+             "every N inbound RPCs on each reactor thread, rather than to "
+             "every RPC. This makes per-request trace collection cheap enough "
+             "to leave enabled permanently, but calls without a trace are "
+             "invisible to /rpcz and to slow-response trace logging. If zero, "
+             "every RPC is traced.");
+TAG_FLAG(rpc_trace_sample_period, advanced);
+TAG_FLAG(rpc_trace_sample_period, experimental);
+TAG_FLAG(rpc_trace_sample_period, runtime);
+
 namespace google {
 namespace protobuf {
 class FieldDescriptor;
@@ -59,8 +73,13 @@ namespace rpc {
 
 InboundCall::InboundCall(Connection* conn)
   : conn_(conn),
-    trace_(new Trace),
     method_info_(nullptr) {
+  // When sampled tracing is enabled, most calls don't carry a trace at
+  // all; TRACE() and TRACE_TO() are no-ops for them.
+  int32_t sample_period = FLAGS_rpc_trace_sample_period;
+  if (PREDICT_TRUE(sample_period <= 0) || Trace::ShouldSample(sample_period)) {
+    trace_ = new Trace;
+  }
   RecordCallReceived();
 }
 
@@ -329,6 +348,13 @@ Status InboundCall::GetInboundSidecar(int idx, Slice* sidecar) const {
   return Status::OK();
 }
 
+Arena* InboundCall::GetArena() {
+  if (!arena_) {
+    arena_.reset(new Arena(1024));
+  }
+  return arena_.get();
+}
+
 void InboundCall::DiscardTransfer() {
   transfer_.reset();
 }
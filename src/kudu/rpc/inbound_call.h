@@ -47,6 +47,7 @@ class MessageLite;
 
 namespace kudu {
 
+class Arena;
 class Histogram;
 class Sockaddr;
 class Trace;
@@ -128,6 +129,10 @@ class InboundCall {
   // Serialize the response packet for the finished call into 'slices'.
   // The resulting slices refer to memory in this object.
   // Returns the number of slices in the serialized response.
+  //
+  // Any outbound sidecars are emitted as separate slices referring to the
+  // sidecars' own memory -- they are never copied into the response buffers.
+  // The transfer layer writes all of the slices scatter-gather via writev().
   size_t SerializeResponseTo(TransferPayload* slices) const;
 
   // See RpcContext::AddRpcSidecar()
@@ -143,6 +148,8 @@ class InboundCall {
 
   const scoped_refptr<Connection>& connection() const;
 
+  // Returns the trace associated with this call, or NULL if the call was
+  // not sampled for tracing (see --rpc_trace_sample_period).
   Trace* trace();
 
   const InboundCallTiming& timing() const {
@@ -198,6 +205,15 @@ class InboundCall {
   // returns an error.
   Status GetInboundSidecar(int idx, Slice* sidecar) const;
 
+  // Return an arena scoped to the lifetime of this call, creating it on first
+  // use. Memory allocated from it is freed in bulk when the call is destroyed
+  // after its response has been sent, so it is suitable for the many small
+  // temporary allocations made while servicing a call.
+  //
+  // Not thread-safe: should only be used by the thread currently handling
+  // the call.
+  Arena* GetArena();
+
   // Releases the buffer that contains the request + sidecar data. It is an error to
   // access sidecars or serialized_request() after this method is called.
   void DiscardTransfer();
@@ -216,6 +232,10 @@ class InboundCall {
   // Serialize a response message for either success or failure. If it is a success,
   // 'response' should be the user-defined response type for the call. If it is a
   // failure, 'response' should be an ErrorStatusPB instance.
+  //
+  // Only the response header and the response PB itself are serialized here.
+  // Sidecar data contributes to the length prefix but stays in the sidecars
+  // until SerializeResponseTo() hands it off for scatter-gather transmission.
   void SerializeResponseBuffer(const google::protobuf::MessageLite& response,
                                bool is_success);
 
@@ -267,6 +287,10 @@ class InboundCall {
   // per-method info such as tracing.
   scoped_refptr<RpcMethodInfo> method_info_;
 
+  // Call-scoped arena, lazily created by GetArena(). Destroyed (freeing all
+  // of its allocations at once) along with the call.
+  std::unique_ptr<Arena> arena_;
+
   DISALLOW_COPY_AND_ASSIGN(InboundCall);
 };
 
@@ -117,6 +117,15 @@ DEFINE_int32(rpc_default_keepalive_time_ms, 65000,
              "will disconnect the client.");
 TAG_FLAG(rpc_default_keepalive_time_ms, advanced);
 
+DEFINE_int32(rpc_transfer_cork_duration_us, 0,
+             "Amount of time, in microseconds, to hold off flushing newly-queued outbound "
+             "transfers so that other calls queued to the same connection in the meantime "
+             "can be sent in a single writev() call. This trades a small amount of latency "
+             "for fewer, larger writes when many small RPCs are sent to the same peer, e.g. "
+             "during a multi-tablet ingest workload. A value of 0 disables corking.");
+TAG_FLAG(rpc_transfer_cork_duration_us, advanced);
+TAG_FLAG(rpc_transfer_cork_duration_us, experimental);
+
 DECLARE_string(keytab_file);
 DECLARE_bool(allow_world_readable_credentials);
 
@@ -232,6 +241,8 @@ MessengerBuilder::MessengerBuilder(std::string name)
       min_negotiation_threads_(0),
       max_negotiation_threads_(4),
       coarse_timer_granularity_(MonoDelta::FromMilliseconds(100)),
+      transfer_cork_duration_(
+          MonoDelta::FromMicroseconds(FLAGS_rpc_transfer_cork_duration_us)),
       sasl_proto_name_("kudu"),
       enable_inbound_tls_(false) {
 }
@@ -261,6 +272,11 @@ MessengerBuilder& MessengerBuilder::set_coarse_timer_granularity(const MonoDelta
   return *this;
 }
 
+MessengerBuilder& MessengerBuilder::set_transfer_cork_duration(const MonoDelta &duration) {
+  transfer_cork_duration_ = duration;
+  return *this;
+}
+
 MessengerBuilder &MessengerBuilder::set_metric_entity(
     const scoped_refptr<MetricEntity>& metric_entity) {
   metric_entity_ = metric_entity;
@@ -25,6 +25,7 @@
 #include <utility>
 #include <vector>
 
+#include <gflags/gflags_declare.h>
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
@@ -53,6 +54,8 @@
 METRIC_DECLARE_counter(rpc_connections_accepted);
 METRIC_DECLARE_counter(rpcs_queue_overflow);
 
+DECLARE_int32(rpc_service_queue_shards);
+
 using std::string;
 using std::shared_ptr;
 using std::vector;
@@ -139,6 +142,38 @@ TEST_F(MultiThreadedRpcTest, TestShutdownDuringService) {
   }
 }
 
+// Same as above, but with the service queue split into multiple shards.
+// Verifies that calls are serviced and that shutdown cleanly drains all of
+// the shards.
+TEST_F(MultiThreadedRpcTest, TestShutdownDuringServiceShardedQueue) {
+  FLAGS_rpc_service_queue_shards = 2;
+  n_worker_threads_ = 4;
+
+  // Set up server.
+  Sockaddr server_addr;
+  StartTestServer(&server_addr);
+
+  const int kNumThreads = 4;
+  scoped_refptr<kudu::Thread> threads[kNumThreads];
+  Status statuses[kNumThreads];
+  for (int i = 0; i < kNumThreads; i++) {
+    ASSERT_OK(kudu::Thread::Create("test", strings::Substitute("t$0", i),
+      &MultiThreadedRpcTest::HammerServer, this, server_addr,
+      GenericCalculatorService::kAddMethodName, &statuses[i], &threads[i]));
+  }
+
+  SleepFor(MonoDelta::FromMilliseconds(50));
+
+  // Shut down server.
+  ASSERT_OK(server_messenger_->UnregisterService(service_name_));
+  service_pool_->Shutdown();
+  server_messenger_->Shutdown();
+
+  for (int i = 0; i < kNumThreads; i++) {
+    AssertShutdown(threads[i].get(), &statuses[i]);
+  }
+}
+
 // Test shutting down the client messenger exactly as a thread is about to start
 // a new connection. This is a regression test for KUDU-104.
 TEST_F(MultiThreadedRpcTest, TestShutdownClientWhileCallsPending) {
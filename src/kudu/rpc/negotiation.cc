@@ -76,6 +76,15 @@ DEFINE_bool(rpc_encrypt_loopback_connections, false,
             "an attacker.");
 TAG_FLAG(rpc_encrypt_loopback_connections, advanced);
 
+DEFINE_bool(rpc_compress_connections, false,
+            "Whether to advertise support for LZ4 compression of RPC messages. "
+            "If both sides of a connection enable this flag, messages larger "
+            "than --rpc_compression_min_message_size are compressed before "
+            "being sent. This trades CPU for bandwidth and is mainly useful "
+            "on low-bandwidth links such as those between datacenters.");
+TAG_FLAG(rpc_compress_connections, advanced);
+TAG_FLAG(rpc_compress_connections, experimental);
+
 using std::string;
 using std::unique_ptr;
 using strings::Substitute;
@@ -94,6 +94,11 @@ class OutboundCall {
   //
   // Because the request data is fully serialized by this call, 'req' may be subsequently
   // mutated with no ill effects.
+  //
+  // Sidecar data is _not_ copied into the serialized buffer; only the total
+  // sidecar length is folded into the message's length prefix. The sidecars'
+  // own slices are handed to the transfer layer by SerializeTo() and written
+  // scatter-gather via writev().
   void SetRequestPayload(const google::protobuf::Message& req,
       std::vector<std::unique_ptr<RpcSidecar>>&& sidecars);
 
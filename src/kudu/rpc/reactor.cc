@@ -42,6 +42,7 @@
 #include "kudu/rpc/outbound_call.h"
 #include "kudu/rpc/rpc_introspection.pb.h"
 #include "kudu/rpc/server_negotiation.h"
+#include "kudu/rpc/timer_wheel.h"
 #include "kudu/util/countdown_latch.h"
 #include "kudu/util/debug/sanitizer_scopes.h"
 #include "kudu/util/flag_tags.h"
@@ -128,15 +129,25 @@ void DoInitLibEv() {
   ev::set_syserr_cb(LibevSysErr);
 }
 
+// Parameters of the call-timeout wheel. A 10ms tick is a negligible error on
+// the multi-second timeouts which are tracked on the wheel, and 512 buckets
+// give it a 5.12s rotation, so only calls with timeouts beyond that are
+// re-examined when their bucket comes around again.
+const int kCallTimeoutWheelBuckets = 512;
+const int kCallTimeoutWheelTickMs = 10;
+
 } // anonymous namespace
 
 ReactorThread::ReactorThread(Reactor *reactor, const MessengerBuilder& bld)
   : loop_(kDefaultLibEvFlags),
+    call_timeout_wheel_(kCallTimeoutWheelBuckets,
+                        MonoDelta::FromMilliseconds(kCallTimeoutWheelTickMs)),
     cur_time_(MonoTime::Now()),
     last_unused_tcp_scan_(cur_time_),
     reactor_(reactor),
     connection_keepalive_time_(bld.connection_keepalive_time_),
     coarse_timer_granularity_(bld.coarse_timer_granularity_),
+    transfer_cork_duration_(bld.transfer_cork_duration_),
     total_client_conns_cnt_(0),
     total_server_conns_cnt_(0) {
 
@@ -164,6 +175,11 @@ Status ReactorThread::Init() {
   timer_.start(coarse_timer_granularity_.ToSeconds(),
                coarse_timer_granularity_.ToSeconds());
 
+  // Register the watcher driving the call-timeout wheel. It's only started
+  // once a timeout is actually scheduled on the wheel.
+  call_timeout_wheel_timer_.set(loop_);
+  call_timeout_wheel_timer_.set<ReactorThread, &ReactorThread::TimeoutWheelHandler>(this); // NOLINT(*)
+
   // Register our callbacks. ev++ doesn't provide handy wrappers for these.
   ev_set_userdata(loop_, this);
   ev_set_loop_release_cb(loop_, &ReactorThread::AboutToPollCb, &ReactorThread::PollCompleteCb);
@@ -403,6 +419,23 @@ void ReactorThread::RegisterTimeout(ev::timer *watcher) {
   watcher->set(loop_);
 }
 
+void ReactorThread::ScheduleCoarseTimeout(TimerWheelEntry* entry, MonoTime expiry) {
+  DCHECK(IsCurrentThread());
+  call_timeout_wheel_.Schedule(entry, expiry);
+  if (!call_timeout_wheel_timer_.is_active()) {
+    double tick = call_timeout_wheel_.tick().ToSeconds();
+    call_timeout_wheel_timer_.start(tick, tick);
+  }
+}
+
+void ReactorThread::TimeoutWheelHandler(ev::timer& /*watcher*/, int /*revents*/) {
+  DCHECK(IsCurrentThread());
+  call_timeout_wheel_.AdvanceTo(MonoTime::Now());
+  if (call_timeout_wheel_.empty()) {
+    call_timeout_wheel_timer_.stop();
+  }
+}
+
 void ReactorThread::ScanIdleConnections() {
   DCHECK(IsCurrentThread());
   // Enforce TCP connection timeouts: server-side connections.
@@ -35,6 +35,7 @@
 #include "kudu/rpc/connection_id.h"
 #include "kudu/rpc/messenger.h"
 #include "kudu/rpc/rpc_header.pb.h"
+#include "kudu/rpc/timer_wheel.h"
 #include "kudu/util/locks.h"
 #include "kudu/util/metrics.h"
 #include "kudu/util/monotime.h"
@@ -167,15 +168,33 @@ class ReactorThread {
   // libev callback for handling timer events in our epoll thread.
   void TimerHandler(ev::timer &watcher, int revents);
 
+  // libev callback driving the call-timeout wheel while it is non-empty.
+  void TimeoutWheelHandler(ev::timer &watcher, int revents);
+
   // Register an epoll timer watcher with our event loop.
   // Does not set a timeout or start it.
   void RegisterTimeout(ev::timer *watcher);
 
+  // Schedule 'entry' on the coarse call-timeout wheel, to fire at or shortly
+  // after 'expiry' (up to one wheel tick late). Scheduling is O(1), and the
+  // entry cancels itself in O(1) when destroyed, which makes this much
+  // cheaper than a per-call libev timer when many calls are outstanding.
+  // The caller keeps ownership of the entry.
+  // Must be called from the reactor thread.
+  void ScheduleCoarseTimeout(TimerWheelEntry* entry, MonoTime expiry);
+
   // This may be called from another thread.
   const std::string &name() const;
 
   MonoTime cur_time() const;
 
+  // How long a connection should wait for more transfers to accumulate
+  // before flushing its outbound queue. Zero means flush immediately.
+  // See MessengerBuilder::set_transfer_cork_duration().
+  const MonoDelta& transfer_cork_duration() const {
+    return transfer_cork_duration_;
+  }
+
   // This may be called from another thread.
   Reactor *reactor();
 
@@ -282,6 +301,12 @@ class ReactorThread {
   // Handles the periodic timer.
   ev::timer timer_;
 
+  // Hashed wheel tracking outbound call timeouts, and the libev timer which
+  // ticks it. The tick timer only runs while the wheel is non-empty, so an
+  // idle reactor doesn't wake up for it.
+  TimerWheel call_timeout_wheel_;
+  ev::timer call_timeout_wheel_timer_;
+
   // Scheduled (but not yet run) delayed tasks.
   //
   // Each task owns its own memory and must be freed by its TaskRun and
@@ -308,6 +333,10 @@ class ReactorThread {
   // Scan for idle connections on this granularity.
   const MonoDelta coarse_timer_granularity_;
 
+  // How long a connection waits for more transfers to accumulate before
+  // flushing its outbound queue. Zero means flush immediately.
+  const MonoDelta transfer_cork_duration_;
+
   // Metrics.
   scoped_refptr<Histogram> invoke_us_histogram_;
   scoped_refptr<Histogram> load_percent_histogram_;
@@ -24,6 +24,7 @@
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
+#include "kudu/gutil/hash/string_hash.h"
 #include "kudu/gutil/map-util.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/rpc/inbound_call.h"
@@ -105,9 +106,12 @@ struct ScopedMemTrackerUpdater {
 
 ResultTracker::ResultTracker(shared_ptr<MemTracker> mem_tracker)
     : mem_tracker_(std::move(mem_tracker)),
-      clients_(ClientStateMap::key_compare(),
-               ClientStateMapAllocator(mem_tracker_)),
-      gc_thread_stop_latch_(1) {}
+      gc_thread_stop_latch_(1) {
+  stripes_.reserve(kNumClientStateStripes);
+  for (int i = 0; i < kNumClientStateStripes; i++) {
+    stripes_.emplace_back(new ClientStateStripe(mem_tracker_));
+  }
+}
 
 ResultTracker::~ResultTracker() {
   if (gc_thread_) {
@@ -115,19 +119,26 @@ ResultTracker::~ResultTracker() {
     gc_thread_->Join();
   }
 
-  lock_guard<simple_spinlock> l(lock_);
   // Release all the memory for the stuff we'll delete on destruction.
-  for (auto& client_state : clients_) {
-    client_state.second->GCCompletionRecords(
-        mem_tracker_, [] (SequenceNumber, CompletionRecord*){ return true; });
-    mem_tracker_->Release(client_state.second->memory_footprint());
+  for (auto& stripe : stripes_) {
+    lock_guard<simple_spinlock> l(stripe->lock);
+    for (auto& client_state : stripe->clients) {
+      client_state.second->GCCompletionRecords(
+          mem_tracker_, [] (SequenceNumber, CompletionRecord*){ return true; });
+      mem_tracker_->Release(client_state.second->memory_footprint());
+    }
   }
 }
 
+ResultTracker::ClientStateStripe& ResultTracker::GetStripeByClientId(const string& client_id) {
+  size_t slot = HashStringThoroughly(client_id.data(), client_id.size()) % kNumClientStateStripes;
+  return *stripes_[slot];
+}
+
 ResultTracker::RpcState ResultTracker::TrackRpc(const RequestIdPB& request_id,
                                                 Message* response,
                                                 RpcContext* context) {
-  lock_guard<simple_spinlock> l(lock_);
+  lock_guard<simple_spinlock> l(GetStripeByClientId(request_id.client_id()).lock);
   return TrackRpcUnlocked(request_id, response, context);
 }
 
@@ -135,7 +146,7 @@ ResultTracker::RpcState ResultTracker::TrackRpcUnlocked(const RequestIdPB& reque
                                                         Message* response,
                                                         RpcContext* context) {
   ClientState* client_state = ComputeIfAbsent(
-      &clients_,
+      &GetStripeByClientId(request_id.client_id()).clients,
       request_id.client_id(),
       [&]{
         unique_ptr<ClientState> client_state(new ClientState(mem_tracker_));
@@ -198,7 +209,13 @@ ResultTracker::RpcState ResultTracker::TrackRpcUnlocked(const RequestIdPB& reque
       // non-null) copy the response and reply immediately. If there is no context/response
       // do nothing.
       if (context != nullptr) {
-        DCHECK_NOTNULL(response)->CopyFrom(*completion_record->response);
+        // A null cached response means the original response serialized to
+        // zero bytes and was not stored (see RecordCompletionAndRespond()).
+        if (completion_record->response) {
+          DCHECK_NOTNULL(response)->CopyFrom(*completion_record->response);
+        } else {
+          DCHECK_NOTNULL(response)->Clear();
+        }
         context->call_->RespondSuccess(*response);
         delete context;
       }
@@ -222,7 +239,7 @@ ResultTracker::RpcState ResultTracker::TrackRpcUnlocked(const RequestIdPB& reque
 }
 
 ResultTracker::RpcState ResultTracker::TrackRpcOrChangeDriver(const RequestIdPB& request_id) {
-  lock_guard<simple_spinlock> l(lock_);
+  lock_guard<simple_spinlock> l(GetStripeByClientId(request_id.client_id()).lock);
   RpcState state = TrackRpcUnlocked(request_id, nullptr, nullptr);
 
   if (state != RpcState::IN_PROGRESS) return state;
@@ -242,7 +259,7 @@ ResultTracker::RpcState ResultTracker::TrackRpcOrChangeDriver(const RequestIdPB&
 }
 
 bool ResultTracker::IsCurrentDriver(const RequestIdPB& request_id) {
-  lock_guard<simple_spinlock> l(lock_);
+  lock_guard<simple_spinlock> l(GetStripeByClientId(request_id.client_id()).lock);
   CompletionRecord* completion_record = FindCompletionRecordOrNullUnlocked(request_id);
 
   // If we couldn't find the CompletionRecord, someone might have called FailAndRespond() so
@@ -261,7 +278,7 @@ void ResultTracker::LogAndTraceAndRespondSuccess(RpcContext* context,
       "response for " << call->ToString() << ":" << std::endl << SecureDebugString(msg);
   TRACE_EVENT_ASYNC_END2("rpc_call", "RPC", this,
                          "response", pb_util::PbTracer::TracePb(msg),
-                         "trace", context->trace()->DumpToString());
+                         "trace", context->trace() ? context->trace()->DumpToString() : "");
   call->RespondSuccess(msg);
   delete context;
 }
@@ -273,7 +290,7 @@ void ResultTracker::LogAndTraceFailure(RpcContext* context,
       "response for " << call->ToString() << ": " << SecureDebugString(msg);
   TRACE_EVENT_ASYNC_END2("rpc_call", "RPC", this,
                          "response", pb_util::PbTracer::TracePb(msg),
-                         "trace", context->trace()->DumpToString());
+                         "trace", context->trace() ? context->trace()->DumpToString() : "");
 }
 
 void ResultTracker::LogAndTraceFailure(RpcContext* context,
@@ -284,18 +301,20 @@ void ResultTracker::LogAndTraceFailure(RpcContext* context,
       "response for " << call->ToString() << ": " << status.ToString();
   TRACE_EVENT_ASYNC_END2("rpc_call", "RPC", this,
                          "status", status.ToString(),
-                         "trace", context->trace()->DumpToString());
+                         "trace", context->trace() ? context->trace()->DumpToString() : "");
 }
 
 ResultTracker::CompletionRecord* ResultTracker::FindCompletionRecordOrDieUnlocked(
     const RequestIdPB& request_id) {
-  ClientState* client_state = DCHECK_NOTNULL(FindPointeeOrNull(clients_, request_id.client_id()));
+  ClientState* client_state = DCHECK_NOTNULL(FindPointeeOrNull(
+      GetStripeByClientId(request_id.client_id()).clients, request_id.client_id()));
   return DCHECK_NOTNULL(FindPointeeOrNull(client_state->completion_records, request_id.seq_no()));
 }
 
 pair<ResultTracker::ClientState*, ResultTracker::CompletionRecord*>
 ResultTracker::FindClientStateAndCompletionRecordOrNullUnlocked(const RequestIdPB& request_id) {
-  ClientState* client_state = FindPointeeOrNull(clients_, request_id.client_id());
+  ClientState* client_state = FindPointeeOrNull(
+      GetStripeByClientId(request_id.client_id()).clients, request_id.client_id());
   CompletionRecord* completion_record = nullptr;
   if (client_state != nullptr) {
     completion_record = FindPointeeOrNull(client_state->completion_records, request_id.seq_no());
@@ -312,7 +331,7 @@ void ResultTracker::RecordCompletionAndRespond(const RequestIdPB& request_id,
                                                const Message* response) {
   vector<OnGoingRpcInfo> to_respond;
   {
-    lock_guard<simple_spinlock> l(lock_);
+    lock_guard<simple_spinlock> l(GetStripeByClientId(request_id.client_id()).lock);
 
     CompletionRecord* completion_record = FindCompletionRecordOrDieUnlocked(request_id);
     ScopedMemTrackerUpdater<CompletionRecord> updater(mem_tracker_.get(), completion_record);
@@ -322,8 +341,14 @@ void ResultTracker::RecordCompletionAndRespond(const RequestIdPB& request_id,
         << "attempt number that was not marked as the driver for the RPC. RequestId: "
         << SecureShortDebugString(request_id) << "\nTracker state:\n " << ToStringUnlocked();
     DCHECK_EQ(completion_record->state, RpcState::IN_PROGRESS);
-    completion_record->response.reset(DCHECK_NOTNULL(response)->New());
-    completion_record->response->CopyFrom(*response);
+    // Don't bother storing a heap-allocated copy of a response that serialized
+    // to zero bytes: a null response on a COMPLETED record stands for the
+    // empty response. This is a common case for operations whose responses
+    // only carry error details.
+    if (DCHECK_NOTNULL(response)->ByteSize() > 0) {
+      completion_record->response.reset(response->New());
+      completion_record->response->CopyFrom(*response);
+    }
     completion_record->state = RpcState::COMPLETED;
     completion_record->last_updated = MonoTime::Now();
 
@@ -364,7 +389,7 @@ void ResultTracker::FailAndRespondInternal(const RequestIdPB& request_id,
                                            HandleOngoingRpcFunc func) {
   vector<OnGoingRpcInfo> to_handle;
   {
-    lock_guard<simple_spinlock> l(lock_);
+    lock_guard<simple_spinlock> l(GetStripeByClientId(request_id.client_id()).lock);
     auto state_and_record = FindClientStateAndCompletionRecordOrNullUnlocked(request_id);
     if (PREDICT_FALSE(state_and_record.first == nullptr)) {
       LOG(FATAL) << "Couldn't find ClientState for request: " << SecureShortDebugString(request_id)
@@ -471,7 +496,6 @@ void ResultTracker::RunGCThread() {
 }
 
 void ResultTracker::GCResults() {
-  lock_guard<simple_spinlock> l(lock_);
   MonoTime now = MonoTime::Now();
   // Calculate the instants before which we'll start GCing ClientStates and CompletionRecords.
   MonoTime time_to_gc_clients_from = now;
@@ -481,53 +505,71 @@ void ResultTracker::GCResults() {
   time_to_gc_responses_from.AddDelta(
       MonoDelta::FromMilliseconds(-FLAGS_remember_responses_ttl_ms));
 
-  // Now go through the ClientStates. If we haven't heard from a client in a while
-  // GC it and all its completion records (making sure there isn't actually one in progress first).
-  // If we've heard from a client recently, but some of its responses are old, GC those responses.
-  for (auto iter = clients_.begin(); iter != clients_.end();) {
-    auto& client_state = iter->second;
-    if (client_state->last_heard_from < time_to_gc_clients_from) {
-      // Client should be GCed.
-      bool ongoing_request = false;
-      client_state->GCCompletionRecords(
-          mem_tracker_,
-          [&] (SequenceNumber, CompletionRecord* completion_record) {
-            if (PREDICT_FALSE(completion_record->state == RpcState::IN_PROGRESS)) {
-              ongoing_request = true;
-              return false;
-            }
-            return true;
-          });
-      // Don't delete the client state if there is still a request in execution.
-      if (PREDICT_FALSE(ongoing_request)) {
+  // Now go through the ClientStates, one stripe at a time so that GC doesn't
+  // block handlers for longer than a single stripe's worth of work. If we
+  // haven't heard from a client in a while GC it and all its completion records
+  // (making sure there isn't actually one in progress first). If we've heard
+  // from a client recently, but some of its responses are old, GC those
+  // responses.
+  for (auto& stripe : stripes_) {
+    lock_guard<simple_spinlock> l(stripe->lock);
+    for (auto iter = stripe->clients.begin(); iter != stripe->clients.end();) {
+      auto& client_state = iter->second;
+      if (client_state->last_heard_from < time_to_gc_clients_from) {
+        // Client should be GCed.
+        bool ongoing_request = false;
+        client_state->GCCompletionRecords(
+            mem_tracker_,
+            [&] (SequenceNumber, CompletionRecord* completion_record) {
+              if (PREDICT_FALSE(completion_record->state == RpcState::IN_PROGRESS)) {
+                ongoing_request = true;
+                return false;
+              }
+              return true;
+            });
+        // Don't delete the client state if there is still a request in execution.
+        if (PREDICT_FALSE(ongoing_request)) {
+          ++iter;
+          continue;
+        }
+        mem_tracker_->Release(client_state->memory_footprint());
+        iter = stripe->clients.erase(iter);
+      } else {
+        // Client can't be GCed, but its calls might be GCable.
+        iter->second->GCCompletionRecords(
+            mem_tracker_,
+            [&] (SequenceNumber, CompletionRecord* completion_record) {
+              return completion_record->state != RpcState::IN_PROGRESS &&
+                  completion_record->last_updated < time_to_gc_responses_from;
+            });
         ++iter;
-        continue;
       }
-      mem_tracker_->Release(client_state->memory_footprint());
-      iter = clients_.erase(iter);
-    } else {
-      // Client can't be GCed, but its calls might be GCable.
-      iter->second->GCCompletionRecords(
-          mem_tracker_,
-          [&] (SequenceNumber, CompletionRecord* completion_record) {
-            return completion_record->state != RpcState::IN_PROGRESS &&
-                completion_record->last_updated < time_to_gc_responses_from;
-          });
-      ++iter;
     }
   }
 }
 
 string ResultTracker::ToString() {
-  lock_guard<simple_spinlock> l(lock_);
+  // Lock all the stripes, in order, so that we dump a consistent snapshot.
+  vector<std::unique_lock<simple_spinlock>> locks;
+  locks.reserve(stripes_.size());
+  for (auto& stripe : stripes_) {
+    locks.emplace_back(stripe->lock);
+  }
   return ToStringUnlocked();
 }
 
 string ResultTracker::ToStringUnlocked() const {
+  size_t num_client_states = 0;
+  for (auto& stripe : stripes_) {
+    num_client_states += stripe->clients.size();
+  }
   string result = Substitute("ResultTracker[this: $0, Num. Client States: $1, Client States:\n",
-                             this, clients_.size());
-  for (auto& cs : clients_) {
-    SubstituteAndAppend(&result, Substitute("\n\tClient: $0, $1", cs.first, cs.second->ToString()));
+                             this, num_client_states);
+  for (auto& stripe : stripes_) {
+    for (auto& cs : stripe->clients) {
+      SubstituteAndAppend(&result,
+                          Substitute("\n\tClient: $0, $1", cs.first, cs.second->ToString()));
+    }
   }
   result.append("]");
   return result;
@@ -272,6 +272,9 @@ class ResultTracker : public RefCountedThreadSafe<ResultTracker> {
     MonoTime last_updated;
 
     // The cached response, if this RPC is in COMPLETED state.
+    // As a memory optimization, responses that serialize to zero bytes are not
+    // stored: a null 'response' on a COMPLETED record stands for the empty
+    // response.
     std::unique_ptr<google::protobuf::Message> response;
 
     // The set of ongoing RPCs that correspond to this record.
@@ -333,6 +336,9 @@ class ResultTracker : public RefCountedThreadSafe<ResultTracker> {
     }
   };
 
+  // Implementation of TrackRpc().
+  // Requires that the caller holds the lock of the stripe owning the client
+  // in 'request_id'.
   RpcState TrackRpcUnlocked(const RequestIdPB& request_id,
                             google::protobuf::Message* response,
                             RpcContext* context);
@@ -369,6 +375,9 @@ class ResultTracker : public RefCountedThreadSafe<ResultTracker> {
   void LogAndTraceFailure(RpcContext* context, ErrorStatusPB_RpcErrorCodePB err,
                           const Status& status);
 
+  // Dumps the state of all stripes without taking any locks. Only safe if the
+  // caller has locked all the stripes (see ToString()) or is on a fatal error
+  // path.
   std::string ToStringUnlocked() const;
 
   void RunGCThread();
@@ -376,11 +385,6 @@ class ResultTracker : public RefCountedThreadSafe<ResultTracker> {
   // The memory tracker that tracks this ResultTracker's memory consumption.
   std::shared_ptr<kudu::MemTracker> mem_tracker_;
 
-  // Lock that protects access to 'clients_' and to the state contained in each
-  // ClientState.
-  // TODO consider a per-ClientState lock if we find this too coarse grained.
-  simple_spinlock lock_;
-
   typedef MemTrackerAllocator<std::pair<const std::string,
                                         std::unique_ptr<ClientState>>> ClientStateMapAllocator;
   typedef std::map<std::string,
@@ -388,7 +392,28 @@ class ResultTracker : public RefCountedThreadSafe<ResultTracker> {
                    std::less<std::string>,
                    ClientStateMapAllocator> ClientStateMap;
 
-  ClientStateMap clients_;
+  enum {
+    kNumClientStateStripes = 16
+  };
+
+  // A single stripe of the client state map. The lock protects 'clients' and
+  // the state contained in each of its ClientStates. Sharding the state by
+  // client id keeps handlers serving different clients from contending on a
+  // single tracker-wide lock when recording completions.
+  struct ClientStateStripe {
+    explicit ClientStateStripe(std::shared_ptr<MemTracker> mem_tracker)
+        : clients(ClientStateMap::key_compare(),
+                  ClientStateMapAllocator(std::move(mem_tracker))) {}
+
+    simple_spinlock lock;
+    ClientStateMap clients;
+  };
+
+  // Returns the stripe that owns 'client_id'. A client's state always lives
+  // in the stripe selected by hashing its client id.
+  ClientStateStripe& GetStripeByClientId(const std::string& client_id);
+
+  std::vector<std::unique_ptr<ClientStateStripe>> stripes_;
 
   // The thread which runs GC, and a latch to stop it.
   scoped_refptr<Thread> gc_thread_;
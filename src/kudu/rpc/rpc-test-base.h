@@ -19,6 +19,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cstring>
 #include <memory>
 #include <string>
 
@@ -41,6 +42,7 @@
 #include "kudu/util/env.h"
 #include "kudu/util/faststring.h"
 #include "kudu/util/mem_tracker.h"
+#include "kudu/util/memory/arena.h"
 #include "kudu/util/net/sockaddr.h"
 #include "kudu/util/path_util.h"
 #include "kudu/util/pb_util.h"
@@ -286,7 +288,12 @@ class CalculatorService : public CalculatorServiceIf {
   }
 
   void Echo(const EchoRequestPB *req, EchoResponsePB *resp, RpcContext *context) override {
-    resp->set_data(req->data());
+    // Bounce the data through the call-scoped arena to exercise it.
+    Arena* arena = context->GetArena();
+    void* copy = arena->AllocateBytes(req->data().size());
+    CHECK(copy != nullptr);
+    memcpy(copy, req->data().data(), req->data().size());
+    resp->set_data(copy, req->data().size());
     context->RespondSuccess();
   }
 
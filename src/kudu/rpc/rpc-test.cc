@@ -69,6 +69,7 @@
 METRIC_DECLARE_histogram(handler_latency_kudu_rpc_test_CalculatorService_Sleep);
 METRIC_DECLARE_histogram(rpc_incoming_queue_time);
 
+DECLARE_bool(rpc_compress_connections);
 DECLARE_bool(rpc_reopen_outbound_connections);
 DECLARE_int32(rpc_negotiation_inject_delay_ms);
 DECLARE_string(rpc_certificate_file);
@@ -184,6 +185,50 @@ TEST_P(TestRpc, TestCall) {
   }
 }
 
+// Test that calls complete normally when outbound transfer corking is
+// enabled, both for a lone call and for a burst of concurrent calls which
+// accumulate during the cork window and get flushed together.
+TEST_F(TestRpc, TestCallWithTransferCork) {
+  // Set up server.
+  Sockaddr server_addr;
+  StartTestServer(&server_addr);
+
+  // Set up a client messenger which corks each connection briefly before
+  // flushing its queued transfers with a single writev().
+  MessengerBuilder bld("Client");
+  bld.set_transfer_cork_duration(MonoDelta::FromMilliseconds(5));
+  bld.set_metric_entity(metric_entity_);
+  shared_ptr<Messenger> client_messenger;
+  ASSERT_OK(bld.Build(&client_messenger));
+  Proxy p(client_messenger, server_addr, server_addr.host(),
+          GenericCalculatorService::static_service_name());
+
+  ASSERT_OK(DoTestSyncCall(p, GenericCalculatorService::kAddMethodName));
+
+  const int n_calls = 10;
+  vector<unique_ptr<AddRequestPB>> reqs;
+  vector<unique_ptr<AddResponsePB>> resps;
+  vector<unique_ptr<RpcController>> controllers;
+  CountDownLatch latch(n_calls);
+  for (int i = 0; i < n_calls; i++) {
+    reqs.emplace_back(new AddRequestPB());
+    reqs.back()->set_x(i);
+    reqs.back()->set_y(i * 2);
+    resps.emplace_back(new AddResponsePB());
+    controllers.emplace_back(new RpcController());
+    p.AsyncRequest(GenericCalculatorService::kAddMethodName, *reqs.back(),
+                   resps.back().get(), controllers.back().get(),
+                   boost::bind(&CountDownLatch::CountDown, boost::ref(latch)));
+  }
+  latch.Wait();
+
+  for (int i = 0; i < n_calls; i++) {
+    ASSERT_OK(controllers[i]->status());
+    ASSERT_EQ(i + i * 2, resps[i]->result());
+  }
+  client_messenger->Shutdown();
+}
+
 TEST_P(TestRpc, TestCallWithChainCerts) {
   bool enable_ssl = GetParam();
   // We're only interested in running this test with TLS enabled.
@@ -561,6 +606,51 @@ TEST_P(TestRpc, TestRpcSidecar) {
   DoTestOutgoingSidecarExpectOK(p, 3000 * 1024, 2000 * 1024);
 }
 
+// Test that calls round-trip correctly on connections which negotiate
+// payload compression.
+TEST_P(TestRpc, TestCallWithCompression) {
+  FLAGS_rpc_compress_connections = true;
+
+  // Set up server.
+  Sockaddr server_addr;
+  bool enable_ssl = GetParam();
+  StartTestServer(&server_addr, enable_ssl);
+
+  // Set up client.
+  shared_ptr<Messenger> client_messenger(CreateMessenger("Client", 1, enable_ssl));
+  Proxy p(client_messenger, server_addr, server_addr.host(),
+          GenericCalculatorService::static_service_name());
+
+  // Small messages are sent uncompressed since they fall below the
+  // compression threshold.
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(DoTestSyncCall(p, GenericCalculatorService::kAddMethodName));
+  }
+
+  // Large, highly compressible payloads in both directions.
+  DoTestOutgoingSidecarExpectOK(p, 3000 * 1024, 2000 * 1024);
+
+  // Random sidecar data doesn't shrink when compressed, so these messages
+  // are sent raw despite exceeding the compression threshold.
+  DoTestSidecar(p, 3000 * 1024, 2000 * 1024);
+}
+
+// Test that a sidecar over externally owned data keeps its owner alive
+// exactly as long as the sidecar itself.
+TEST(RpcSidecarTest, TestSidecarWithOwner) {
+  auto owner = std::make_shared<string>("owned payload");
+  Slice data(*owner);
+  std::weak_ptr<string> weak_owner = owner;
+
+  unique_ptr<RpcSidecar> sidecar = RpcSidecar::FromSliceWithOwner(data, std::move(owner));
+  ASSERT_EQ(data, sidecar->AsSlice());
+
+  // The sidecar should now be the only thing keeping the owner alive.
+  ASSERT_FALSE(weak_owner.expired());
+  sidecar.reset();
+  ASSERT_TRUE(weak_owner.expired());
+}
+
 TEST_P(TestRpc, TestRpcSidecarLimits) {
   {
     // Test that the limits on the number of sidecars is respected.
@@ -72,7 +72,7 @@ void RpcContext::RespondSuccess() {
         << call_->ToString() << ":" << std::endl << SecureDebugString(*response_pb_);
     TRACE_EVENT_ASYNC_END2("rpc_call", "RPC", this,
                            "response", pb_util::PbTracer::TracePb(*response_pb_),
-                           "trace", trace()->DumpToString());
+                           "trace", trace() ? trace()->DumpToString() : "");
     call_->RespondSuccess(*response_pb_);
     delete this;
   }
@@ -87,7 +87,7 @@ void RpcContext::RespondNoCache() {
         << call_->ToString() << ": " << SecureDebugString(*response_pb_);
     TRACE_EVENT_ASYNC_END2("rpc_call", "RPC", this,
                            "response", pb_util::PbTracer::TracePb(*response_pb_),
-                           "trace", trace()->DumpToString());
+                           "trace", trace() ? trace()->DumpToString() : "");
     // This is a bit counter intuitive, but when we get the failure but set the error on the
     // call's response we call RespondSuccess() instead of RespondFailure().
     call_->RespondSuccess(*response_pb_);
@@ -104,7 +104,7 @@ void RpcContext::RespondFailure(const Status &status) {
         << call_->ToString() << ": " << status.ToString();
     TRACE_EVENT_ASYNC_END2("rpc_call", "RPC", this,
                            "status", status.ToString(),
-                           "trace", trace()->DumpToString());
+                           "trace", trace() ? trace()->DumpToString() : "");
     call_->RespondFailure(ErrorStatusPB::ERROR_APPLICATION, status);
     delete this;
   }
@@ -119,7 +119,7 @@ void RpcContext::RespondRpcFailure(ErrorStatusPB_RpcErrorCodePB err, const Statu
         << call_->ToString() << ": " << status.ToString();
     TRACE_EVENT_ASYNC_END2("rpc_call", "RPC", this,
                            "status", status.ToString(),
-                           "trace", trace()->DumpToString());
+                           "trace", trace() ? trace()->DumpToString() : "");
     call_->RespondFailure(err, status);
     delete this;
   }
@@ -140,7 +140,7 @@ void RpcContext::RespondApplicationError(int error_ext_id, const std::string& me
     }
     TRACE_EVENT_ASYNC_END2("rpc_call", "RPC", this,
                            "response", pb_util::PbTracer::TracePb(app_error_pb),
-                           "trace", trace()->DumpToString());
+                           "trace", trace() ? trace()->DumpToString() : "");
     call_->RespondApplicationError(error_ext_id, message, app_error_pb);
     delete this;
   }
@@ -158,6 +158,10 @@ Status RpcContext::GetInboundSidecar(int idx, Slice* slice) {
   return call_->GetInboundSidecar(idx, slice);
 }
 
+Arena* RpcContext::GetArena() {
+  return call_->GetArena();
+}
+
 const RemoteUser& RpcContext::remote_user() const {
   return call_->remote_user();
 }
@@ -36,6 +36,7 @@ class Message;
 
 namespace kudu {
 
+class Arena;
 class Slice;
 class Sockaddr;
 class Trace;
@@ -164,6 +165,15 @@ class RpcContext {
   // of bounds.
   Status GetInboundSidecar(int idx, Slice* slice);
 
+  // Return an arena scoped to the lifetime of the underlying call. The memory
+  // allocated from it is freed in bulk when the call completes, so services
+  // can use it for small temporary allocations made while handling the call
+  // instead of paying a malloc/free pair for each.
+  //
+  // Not thread-safe: should only be used by the thread currently handling
+  // the call.
+  Arena* GetArena();
+
   // Return the identity of remote user who made this call.
   const RemoteUser& remote_user() const;
 
@@ -45,6 +45,20 @@ class SliceSidecar : public RpcSidecar {
   const Slice slice_;
 };
 
+// Sidecar that references data kept alive by another object, such as a pinned
+// block cache entry. The owner is released when the sidecar is destroyed,
+// which happens once the call it is attached to has completed.
+class OwnedDataSidecar : public RpcSidecar {
+ public:
+  OwnedDataSidecar(Slice slice, std::shared_ptr<void> owner)
+      : slice_(slice), owner_(std::move(owner)) { }
+  Slice AsSlice() const override { return slice_; }
+
+ private:
+  const Slice slice_;
+  const std::shared_ptr<void> owner_;
+};
+
 class FaststringSidecar : public RpcSidecar {
  public:
   explicit FaststringSidecar(unique_ptr<faststring> data) : data_(std::move(data)) { }
@@ -62,6 +76,11 @@ unique_ptr<RpcSidecar> RpcSidecar::FromSlice(Slice slice) {
   return unique_ptr<RpcSidecar>(new SliceSidecar(slice));
 }
 
+unique_ptr<RpcSidecar> RpcSidecar::FromSliceWithOwner(Slice slice,
+                                                      std::shared_ptr<void> owner) {
+  return unique_ptr<RpcSidecar>(new OwnedDataSidecar(slice, std::move(owner)));
+}
+
 
 Status RpcSidecar::ParseSidecars(
     const ::google::protobuf::RepeatedField<::google::protobuf::uint32>& offsets,
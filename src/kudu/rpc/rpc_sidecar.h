@@ -53,6 +53,14 @@ class RpcSidecar {
   static std::unique_ptr<RpcSidecar> FromFaststring(std::unique_ptr<faststring> data);
   static std::unique_ptr<RpcSidecar> FromSlice(Slice slice);
 
+  // Construct a sidecar over data owned by some other object (e.g. a pinned
+  // block cache entry), keeping 'owner' alive until the sidecar is destroyed,
+  // i.e. until the call it is attached to completes. This allows responses to
+  // reference such data directly rather than copying it into a buffer owned
+  // by the sidecar. 'slice' must point into memory kept valid by 'owner'.
+  static std::unique_ptr<RpcSidecar> FromSliceWithOwner(Slice slice,
+                                                        std::shared_ptr<void> owner);
+
   // Utility method to parse a series of sidecar slices into 'sidecars' from 'buffer' and
   // a set of offsets. 'sidecars' must have length >= TransferLimits::kMaxSidecars, and
   // will be filled from index 0.
@@ -204,6 +204,10 @@ RpczStore::RpczStore() {}
 RpczStore::~RpczStore() {}
 
 void RpczStore::AddCall(InboundCall* call) {
+  // Calls that weren't sampled for tracing (see --rpc_trace_sample_period)
+  // have nothing to log or sample here.
+  if (PREDICT_FALSE(!call->trace())) return;
+
   LogTrace(call);
   auto* sampler = SamplerForCall(call);
   if (PREDICT_FALSE(!sampler)) return;
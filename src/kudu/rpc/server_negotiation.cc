@@ -72,6 +72,7 @@ DEFINE_double(rpc_inject_invalid_authn_token_ratio, 0,
 TAG_FLAG(rpc_inject_invalid_authn_token_ratio, runtime);
 TAG_FLAG(rpc_inject_invalid_authn_token_ratio, unsafe);
 
+DECLARE_bool(rpc_compress_connections);
 DECLARE_bool(rpc_encrypt_loopback_connections);
 
 DEFINE_string(trusted_subnets,
@@ -509,6 +510,10 @@ Status ServerNegotiation::HandleNegotiate(const NegotiatePB& request) {
     }
   }
 
+  if (FLAGS_rpc_compress_connections) {
+    server_features_.insert(LZ4_COMPRESSION);
+  }
+
   for (RpcFeatureFlag feature : server_features_) {
     response.add_supported_features(feature);
   }
@@ -567,8 +572,13 @@ Status ServerNegotiation::HandleTlsHandshake(const NegotiatePB& request) {
   }
 
   // Regardless of whether this is the final handshake roundtrip (in which case
-  // Continue would have returned OK), we still need to return a response.
-  RETURN_NOT_OK(SendTlsHandshake(std::move(token)));
+  // Continue would have returned OK), we still need to return a response. The
+  // exception is a completed handshake with no token to send: that happens
+  // when the client resumed a previous TLS session, in which case the client
+  // speaks last and is not expecting a further response.
+  if (!s.ok() || !token.empty()) {
+    RETURN_NOT_OK(SendTlsHandshake(std::move(token)));
+  }
   RETURN_NOT_OK(s);
 
   // TLS handshake is finished.
@@ -17,6 +17,7 @@
 
 #include "kudu/rpc/service_pool.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <ostream>
@@ -26,6 +27,7 @@
 #include <vector>
 
 #include <boost/optional/optional.hpp>
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 
 #include "kudu/gutil/basictypes.h"
@@ -39,6 +41,7 @@
 #include "kudu/rpc/rpc_header.pb.h"
 #include "kudu/rpc/service_if.h"
 #include "kudu/rpc/service_queue.h"
+#include "kudu/util/flag_tags.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/metrics.h"
 #include "kudu/util/net/sockaddr.h"
@@ -69,6 +72,16 @@ METRIC_DEFINE_counter(server, rpcs_queue_overflow,
                       "Number of RPCs dropped because the service queue "
                       "was full.");
 
+DEFINE_int32(rpc_service_queue_shards, 1,
+             "Number of shards to split each RPC service queue into. Incoming "
+             "calls are routed to a shard by hashing the client address, and "
+             "each worker thread serves a single shard. Sharding reduces "
+             "contention on the queue lock on servers handling a high rate of "
+             "small RPCs, at the cost of slightly less accurate "
+             "earliest-deadline-first dequeue ordering across shards.");
+TAG_FLAG(rpc_service_queue_shards, advanced);
+TAG_FLAG(rpc_service_queue_shards, experimental);
+
 namespace kudu {
 namespace rpc {
 
@@ -76,11 +89,18 @@ ServicePool::ServicePool(gscoped_ptr<ServiceIf> service,
                          const scoped_refptr<MetricEntity>& entity,
                          size_t service_queue_length)
   : service_(std::move(service)),
-    service_queue_(service_queue_length),
     incoming_queue_time_(METRIC_rpc_incoming_queue_time.Instantiate(entity)),
     rpcs_timed_out_in_queue_(METRIC_rpcs_timed_out_in_queue.Instantiate(entity)),
     rpcs_queue_overflow_(METRIC_rpcs_queue_overflow.Instantiate(entity)),
     closing_(false) {
+  int num_shards = std::max(1, FLAGS_rpc_service_queue_shards);
+  // Split the configured queue length across the shards so that the total
+  // capacity is unaffected by the shard count.
+  size_t shard_length = (service_queue_length + num_shards - 1) / num_shards;
+  service_queues_.reserve(num_shards);
+  for (int i = 0; i < num_shards; i++) {
+    service_queues_.emplace_back(new LifoServiceQueue(shard_length));
+  }
 }
 
 ServicePool::~ServicePool() {
@@ -88,17 +108,29 @@ ServicePool::~ServicePool() {
 }
 
 Status ServicePool::Init(int num_threads) {
+  // Each worker thread consumes from a single queue shard, so a shard with no
+  // worker assigned to it would never be drained. If the pool has fewer
+  // threads than shards, drop the extra (still-empty) shards.
+  if (static_cast<size_t>(num_threads) < service_queues_.size()) {
+    LOG(WARNING) << "Ignoring --rpc_service_queue_shards="
+                 << service_queues_.size() << " for service pool with only "
+                 << num_threads << " threads";
+    service_queues_.resize(std::max(num_threads, 1));
+  }
   for (int i = 0; i < num_threads; i++) {
     scoped_refptr<kudu::Thread> new_thread;
     CHECK_OK(kudu::Thread::Create("service pool", "rpc worker",
-        &ServicePool::RunThread, this, &new_thread));
+        &ServicePool::RunThread, this,
+        static_cast<int>(i % service_queues_.size()), &new_thread));
     threads_.push_back(new_thread);
   }
   return Status::OK();
 }
 
 void ServicePool::Shutdown() {
-  service_queue_.Shutdown();
+  for (auto& queue : service_queues_) {
+    queue->Shutdown();
+  }
 
   MutexLock lock(shutdown_lock_);
   if (closing_) return;
@@ -108,30 +140,32 @@ void ServicePool::Shutdown() {
     CHECK_OK(ThreadJoiner(thread.get()).Join());
   }
 
-  // Now we must drain the service queue.
+  // Now we must drain the service queues.
   Status status = Status::ServiceUnavailable("Service is shutting down");
-  std::unique_ptr<InboundCall> incoming;
-  while (service_queue_.BlockingGet(&incoming)) {
-    incoming.release()->RespondFailure(ErrorStatusPB::FATAL_SERVER_SHUTTING_DOWN, status);
+  for (auto& queue : service_queues_) {
+    std::unique_ptr<InboundCall> incoming;
+    while (queue->BlockingGet(&incoming)) {
+      incoming.release()->RespondFailure(ErrorStatusPB::FATAL_SERVER_SHUTTING_DOWN, status);
+    }
   }
 
   service_->Shutdown();
 }
 
-void ServicePool::RejectTooBusy(InboundCall* c) {
+void ServicePool::RejectTooBusy(InboundCall* c, LifoServiceQueue* queue) {
   string err_msg =
       Substitute("$0 request on $1 from $2 dropped due to backpressure. "
                  "The service queue is full; it has $3 items.",
                  c->remote_method().method_name(),
                  service_->service_name(),
                  c->remote_address().ToString(),
-                 service_queue_.max_size());
+                 queue->max_size());
   rpcs_queue_overflow_->Increment();
   KLOG_EVERY_N_SECS(WARNING, 1) << err_msg;
   c->RespondFailure(ErrorStatusPB::ERROR_SERVER_TOO_BUSY,
                     Status::ServiceUnavailable(err_msg));
   DLOG(INFO) << err_msg << " Contents of service queue:\n"
-             << service_queue_.ToString();
+             << queue->ToString();
 }
 
 RpcMethodInfo* ServicePool::LookupMethod(const RemoteMethod& method) {
@@ -158,16 +192,35 @@ Status ServicePool::QueueInboundCall(gscoped_ptr<InboundCall> call) {
 
   TRACE_TO(c->trace(), "Inserting onto call queue");
 
-  // Queue message on service queue
+  // Queue message on the shard of the service queue which this client's
+  // connection hashes to. All calls from a given connection hash to the same
+  // shard, which tends to keep a connection's calls on the same worker
+  // threads.
+  size_t num_queues = service_queues_.size();
+  size_t shard = 0;
+  if (PREDICT_FALSE(num_queues > 1)) {
+    shard = c->remote_address().HashCode() % num_queues;
+  }
+  LifoServiceQueue* queue = service_queues_[shard].get();
   boost::optional<InboundCall*> evicted;
-  auto queue_status = service_queue_.Put(c, &evicted);
+  auto queue_status = queue->Put(c, &evicted);
+
+  // If the home shard is full, spill to the other shards before rejecting:
+  // the shards are drained independently, so another one may have capacity
+  // or an idle worker.
+  if (PREDICT_FALSE(queue_status == QUEUE_FULL && num_queues > 1)) {
+    for (size_t i = 1; i < num_queues && queue_status == QUEUE_FULL; i++) {
+      queue_status = service_queues_[(shard + i) % num_queues]->Put(c, &evicted);
+    }
+  }
+
   if (queue_status == QUEUE_FULL) {
-    RejectTooBusy(c);
+    RejectTooBusy(c, queue);
     return Status::OK();
   }
 
   if (PREDICT_FALSE(evicted != boost::none)) {
-    RejectTooBusy(*evicted);
+    RejectTooBusy(*evicted, queue);
   }
 
   if (PREDICT_TRUE(queue_status == QUEUE_SUCCESS)) {
@@ -188,10 +241,11 @@ Status ServicePool::QueueInboundCall(gscoped_ptr<InboundCall> call) {
   return status;
 }
 
-void ServicePool::RunThread() {
+void ServicePool::RunThread(int queue_idx) {
+  LifoServiceQueue* queue = service_queues_[queue_idx].get();
   while (true) {
     std::unique_ptr<InboundCall> incoming;
-    if (!service_queue_.BlockingGet(&incoming)) {
+    if (!queue->BlockingGet(&incoming)) {
       VLOG(1) << "ServicePool: messenger shutting down.";
       return;
     }
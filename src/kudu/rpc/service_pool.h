@@ -19,6 +19,7 @@
 #define KUDU_SERVICE_POOL_H
 
 #include <cstddef>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -80,12 +81,21 @@ class ServicePool : public RpcService {
   const std::string service_name() const;
 
  private:
-  void RunThread();
-  void RejectTooBusy(InboundCall* c);
+  void RunThread(int queue_idx);
+  void RejectTooBusy(InboundCall* c, LifoServiceQueue* queue);
 
   gscoped_ptr<ServiceIf> service_;
   std::vector<scoped_refptr<kudu::Thread> > threads_;
-  LifoServiceQueue service_queue_;
+
+  // The service queue, sharded to reduce producer/consumer contention on its
+  // spinlock (see --rpc_service_queue_shards). Calls are routed to a shard by
+  // hashing the client's address, so all calls from one connection share a
+  // shard. Each worker thread consumes from a single shard: the queue's LIFO
+  // direct hand-off design binds a consumer thread to one queue instance for
+  // its lifetime, which rules out consumer-side work stealing. Instead, a
+  // producer which finds its home shard full spills to the other shards
+  // before rejecting the call.
+  std::vector<std::unique_ptr<LifoServiceQueue>> service_queues_;
   scoped_refptr<Histogram> incoming_queue_time_;
   scoped_refptr<Counter> rpcs_timed_out_in_queue_;
   scoped_refptr<Counter> rpcs_queue_overflow_;
@@ -0,0 +1,184 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#include "kudu/rpc/timer_wheel.h"
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "kudu/util/monotime.h"
+#include "kudu/util/test_util.h"
+
+namespace kudu {
+namespace rpc {
+
+namespace {
+
+// Test entry which counts how many times it fired, and optionally
+// re-schedules itself once from within the expiration callback.
+class CountingEntry : public TimerWheelEntry {
+ public:
+  CountingEntry()
+      : fire_count_(0),
+        reschedule_wheel_(nullptr) {
+  }
+
+  int fire_count() const { return fire_count_; }
+
+  void ReScheduleOnceAt(TimerWheel* wheel, MonoTime expiry) {
+    reschedule_wheel_ = wheel;
+    reschedule_expiry_ = expiry;
+  }
+
+ protected:
+  void HandleTimerExpired() override {
+    fire_count_++;
+    if (reschedule_wheel_ != nullptr) {
+      TimerWheel* wheel = reschedule_wheel_;
+      reschedule_wheel_ = nullptr;
+      wheel->Schedule(this, reschedule_expiry_);
+    }
+  }
+
+ private:
+  int fire_count_;
+  TimerWheel* reschedule_wheel_;
+  MonoTime reschedule_expiry_;
+};
+
+} // anonymous namespace
+
+class TimerWheelTest : public KuduTest {
+ protected:
+  static const int kNumBuckets = 16;
+  static const int kTickMs = 10;
+};
+
+TEST_F(TimerWheelTest, TestBasicExpiration) {
+  TimerWheel wheel(kNumBuckets, MonoDelta::FromMilliseconds(kTickMs));
+  MonoTime now = MonoTime::Now();
+
+  CountingEntry entry;
+  wheel.Schedule(&entry, now + MonoDelta::FromMilliseconds(50));
+  ASSERT_TRUE(entry.scheduled());
+  ASSERT_EQ(1, wheel.num_entries());
+
+  // Advancing to before the expiry must not fire.
+  wheel.AdvanceTo(now + MonoDelta::FromMilliseconds(30));
+  ASSERT_EQ(0, entry.fire_count());
+  ASSERT_TRUE(entry.scheduled());
+
+  // Advancing past the expiry fires exactly once and unschedules.
+  wheel.AdvanceTo(now + MonoDelta::FromMilliseconds(70));
+  ASSERT_EQ(1, entry.fire_count());
+  ASSERT_FALSE(entry.scheduled());
+  ASSERT_TRUE(wheel.empty());
+
+  // Further advancing doesn't re-fire.
+  wheel.AdvanceTo(now + MonoDelta::FromMilliseconds(500));
+  ASSERT_EQ(1, entry.fire_count());
+}
+
+TEST_F(TimerWheelTest, TestCancellationByDestruction) {
+  TimerWheel wheel(kNumBuckets, MonoDelta::FromMilliseconds(kTickMs));
+  MonoTime now = MonoTime::Now();
+
+  {
+    CountingEntry entry;
+    wheel.Schedule(&entry, now + MonoDelta::FromMilliseconds(50));
+    ASSERT_EQ(1, wheel.num_entries());
+    // The entry unschedules itself when it goes out of scope.
+  }
+  ASSERT_TRUE(wheel.empty());
+  wheel.AdvanceTo(now + MonoDelta::FromMilliseconds(500));
+}
+
+TEST_F(TimerWheelTest, TestExpiryBeyondOneRotation) {
+  TimerWheel wheel(kNumBuckets, MonoDelta::FromMilliseconds(kTickMs));
+  MonoTime now = MonoTime::Now();
+
+  // The wheel's rotation is kNumBuckets * kTickMs = 160ms; schedule well
+  // beyond it so the entry is re-examined when its bucket comes around.
+  CountingEntry entry;
+  wheel.Schedule(&entry, now + MonoDelta::FromMilliseconds(1000));
+
+  for (int ms = 10; ms <= 990; ms += 10) {
+    wheel.AdvanceTo(now + MonoDelta::FromMilliseconds(ms));
+    ASSERT_EQ(0, entry.fire_count()) << "fired early at +" << ms << "ms";
+  }
+  wheel.AdvanceTo(now + MonoDelta::FromMilliseconds(1010));
+  ASSERT_EQ(1, entry.fire_count());
+  ASSERT_TRUE(wheel.empty());
+}
+
+TEST_F(TimerWheelTest, TestRescheduleFromCallback) {
+  TimerWheel wheel(kNumBuckets, MonoDelta::FromMilliseconds(kTickMs));
+  MonoTime now = MonoTime::Now();
+
+  // Mimics the two-stage RPC timeout: the first expiration re-arms the
+  // entry for a later deadline.
+  CountingEntry entry;
+  entry.ReScheduleOnceAt(&wheel, now + MonoDelta::FromMilliseconds(200));
+  wheel.Schedule(&entry, now + MonoDelta::FromMilliseconds(50));
+
+  wheel.AdvanceTo(now + MonoDelta::FromMilliseconds(100));
+  ASSERT_EQ(1, entry.fire_count());
+  ASSERT_TRUE(entry.scheduled());
+
+  wheel.AdvanceTo(now + MonoDelta::FromMilliseconds(250));
+  ASSERT_EQ(2, entry.fire_count());
+  ASSERT_FALSE(entry.scheduled());
+  ASSERT_TRUE(wheel.empty());
+}
+
+TEST_F(TimerWheelTest, TestPastExpiryFiresOnNextAdvance) {
+  TimerWheel wheel(kNumBuckets, MonoDelta::FromMilliseconds(kTickMs));
+  MonoTime now = MonoTime::Now();
+  wheel.AdvanceTo(now + MonoDelta::FromMilliseconds(100));
+
+  // Scheduling with an already-elapsed expiry must still fire (on the next
+  // advance), not be lost in an already-drained slot.
+  CountingEntry entry;
+  wheel.Schedule(&entry, now + MonoDelta::FromMilliseconds(50));
+  wheel.AdvanceTo(now + MonoDelta::FromMilliseconds(120));
+  ASSERT_EQ(1, entry.fire_count());
+  ASSERT_TRUE(wheel.empty());
+}
+
+TEST_F(TimerWheelTest, TestManyEntries) {
+  TimerWheel wheel(kNumBuckets, MonoDelta::FromMilliseconds(kTickMs));
+  MonoTime now = MonoTime::Now();
+
+  const int kNumEntries = 1000;
+  std::vector<std::unique_ptr<CountingEntry>> entries;
+  for (int i = 0; i < kNumEntries; i++) {
+    entries.emplace_back(new CountingEntry());
+    wheel.Schedule(entries.back().get(),
+                   now + MonoDelta::FromMilliseconds(10 + i % 500));
+  }
+  ASSERT_EQ(kNumEntries, wheel.num_entries());
+
+  wheel.AdvanceTo(now + MonoDelta::FromMilliseconds(1000));
+  for (const auto& e : entries) {
+    ASSERT_EQ(1, e->fire_count());
+  }
+  ASSERT_TRUE(wheel.empty());
+}
+
+} // namespace rpc
+} // namespace kudu
@@ -0,0 +1,136 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#include "kudu/rpc/timer_wheel.h"
+
+#include <algorithm>
+
+#include <glog/logging.h>
+
+#include "kudu/gutil/bits.h"
+#include "kudu/gutil/port.h"
+
+namespace kudu {
+namespace rpc {
+
+namespace {
+
+size_t RoundUpToPowerOfTwo(int n) {
+  DCHECK_GT(n, 0);
+  if (n <= 1) return 1;
+  return 1ULL << (Bits::Log2Ceiling(n));
+}
+
+} // anonymous namespace
+
+TimerWheelEntry::~TimerWheelEntry() {
+  Unlink();
+}
+
+void TimerWheelEntry::Unlink() {
+  if (pprev_ == nullptr) return;
+  *pprev_ = next_;
+  if (next_ != nullptr) {
+    next_->pprev_ = pprev_;
+  }
+  next_ = nullptr;
+  pprev_ = nullptr;
+  wheel_->num_entries_--;
+  wheel_ = nullptr;
+}
+
+TimerWheel::TimerWheel(int num_buckets, MonoDelta tick)
+    : epoch_(MonoTime::Now()),
+      tick_(tick),
+      tick_nanos_(tick.ToNanoseconds()),
+      buckets_(RoundUpToPowerOfTwo(num_buckets), nullptr),
+      bucket_mask_(buckets_.size() - 1),
+      num_entries_(0),
+      last_tick_(0) {
+  CHECK_GT(tick_nanos_, 0);
+}
+
+TimerWheel::~TimerWheel() {
+  DCHECK_EQ(0, num_entries_) << "wheel destroyed with entries still scheduled";
+}
+
+int64_t TimerWheel::TickOf(MonoTime t) const {
+  int64_t nanos = (t - epoch_).ToNanoseconds();
+  if (PREDICT_FALSE(nanos < 0)) {
+    // An expiry in the past (or a deadline computed before the wheel was
+    // created) lands in the earliest possible slot.
+    return 0;
+  }
+  return nanos / tick_nanos_;
+}
+
+void TimerWheel::Schedule(TimerWheelEntry* entry, MonoTime expiry) {
+  DCHECK(!entry->scheduled());
+  entry->wheel_ = this;
+  entry->expiry_ = expiry;
+
+  // Never schedule into a slot the wheel has already advanced past:
+  // such a slot wouldn't be visited again for a full rotation. An
+  // already-elapsed expiry thus fires on the next tick.
+  int64_t slot_tick = std::max(TickOf(expiry), last_tick_ + 1);
+
+  TimerWheelEntry** head = &buckets_[slot_tick & bucket_mask_];
+  entry->next_ = *head;
+  if (entry->next_ != nullptr) {
+    entry->next_->pprev_ = &entry->next_;
+  }
+  *head = entry;
+  entry->pprev_ = head;
+  num_entries_++;
+}
+
+void TimerWheel::AdvanceTo(MonoTime now) {
+  int64_t now_tick = TickOf(now);
+
+  // If the wheel hasn't been advanced for more than a full rotation (e.g. it
+  // sat empty for a while), there is no point visiting slots more than once:
+  // scanning the last buckets_.size() slots covers every bucket.
+  int64_t start_tick = std::max<int64_t>(
+      last_tick_ + 1, now_tick - static_cast<int64_t>(buckets_.size()) + 1);
+
+  for (int64_t t = start_tick; t <= now_tick; t++) {
+    // Advance 'last_tick_' before processing the slot so that an expired
+    // callback which re-schedules (e.g. a two-stage timeout) can't insert
+    // into the slot currently being drained.
+    last_tick_ = t;
+
+    // Detach the whole chain, then fire the due entries and re-insert the
+    // ones which belong to a future rotation.
+    TimerWheelEntry* e = buckets_[t & bucket_mask_];
+    buckets_[t & bucket_mask_] = nullptr;
+    while (e != nullptr) {
+      TimerWheelEntry* next = e->next_;
+      e->next_ = nullptr;
+      e->pprev_ = nullptr;
+      e->wheel_ = nullptr;
+      num_entries_--;
+      if (e->expiry_ <= now) {
+        e->HandleTimerExpired();
+      } else {
+        Schedule(e, e->expiry_);
+      }
+      e = next;
+    }
+  }
+}
+
+} // namespace rpc
+} // namespace kudu
@@ -0,0 +1,146 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#ifndef KUDU_RPC_TIMER_WHEEL_H
+#define KUDU_RPC_TIMER_WHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "kudu/gutil/macros.h"
+#include "kudu/util/monotime.h"
+
+namespace kudu {
+namespace rpc {
+
+class TimerWheel;
+
+// An entry which may be scheduled on a TimerWheel.
+//
+// Entries are intrusive: scheduling allocates nothing, and an entry
+// automatically removes itself from its wheel when destroyed. An entry may
+// be scheduled on at most one wheel at a time.
+//
+// Not thread-safe: an entry must only be manipulated from the thread which
+// drives its wheel.
+class TimerWheelEntry {
+ public:
+  TimerWheelEntry()
+      : wheel_(nullptr),
+        next_(nullptr),
+        pprev_(nullptr) {
+  }
+
+  virtual ~TimerWheelEntry();
+
+  // Return true if this entry is currently scheduled on a wheel.
+  bool scheduled() const { return pprev_ != nullptr; }
+
+ protected:
+  // Invoked by the wheel once the entry's expiry has passed. Fires up to one
+  // wheel tick later than the requested expiry, depending on when the wheel
+  // is next advanced. The entry has already been removed from the wheel when
+  // this is called, so the implementation may re-schedule or destroy the
+  // entry.
+  virtual void HandleTimerExpired() = 0;
+
+  // The expiry the entry was scheduled with. Only valid while scheduled or
+  // from within HandleTimerExpired().
+  const MonoTime& expiry() const { return expiry_; }
+
+ private:
+  friend class TimerWheel;
+
+  // Remove this entry from its bucket chain, if linked.
+  void Unlink();
+
+  TimerWheel* wheel_;
+  MonoTime expiry_;
+
+  // Intrusive doubly-linked bucket chain. 'pprev_' points at the
+  // predecessor's 'next_' field (or the bucket head), which makes unlinking
+  // O(1) without a back-pointer to the wheel's buckets.
+  TimerWheelEntry* next_;
+  TimerWheelEntry** pprev_;
+
+  DISALLOW_COPY_AND_ASSIGN(TimerWheelEntry);
+};
+
+// A hashed timer wheel: a fixed array of buckets, each holding the entries
+// whose expiry falls into that tick slot (modulo the wheel size). Scheduling
+// and cancelling an entry are O(1); advancing the wheel visits only the
+// buckets whose tick has passed. Entries whose expiry lies more than one
+// full rotation ahead are re-examined once per rotation when their bucket
+// comes around.
+//
+// This trades precision for constant-time maintenance: an entry fires up to
+// one tick late. It is intended for coarse deadlines such as RPC call
+// timeouts, where a 10ms tick error is irrelevant but tens of thousands of
+// entries may be armed and (almost always) cancelled before expiry.
+//
+// The wheel does not own a clock or a thread; the owner must call
+// AdvanceTo() periodically, at least once per tick while the wheel is
+// non-empty.
+//
+// Not thread-safe.
+class TimerWheel {
+ public:
+  // Create a wheel with at least 'num_buckets' buckets (rounded up to a
+  // power of two) and the given tick duration.
+  TimerWheel(int num_buckets, MonoDelta tick);
+  ~TimerWheel();
+
+  // Schedule 'entry' to fire at 'expiry'. The entry must not already be
+  // scheduled. The wheel does not take ownership; the caller must keep the
+  // entry alive until it fires or is destroyed (which unschedules it).
+  void Schedule(TimerWheelEntry* entry, MonoTime expiry);
+
+  // Fire HandleTimerExpired() on every scheduled entry whose expiry is at
+  // or before 'now'. 'now' must not move backwards between calls.
+  void AdvanceTo(MonoTime now);
+
+  bool empty() const { return num_entries_ == 0; }
+  int num_entries() const { return num_entries_; }
+  const MonoDelta& tick() const { return tick_; }
+
+ private:
+  friend class TimerWheelEntry;
+
+  // Return the tick number (since 'epoch_') into which 't' falls.
+  int64_t TickOf(MonoTime t) const;
+
+  const MonoTime epoch_;
+  const MonoDelta tick_;
+  const int64_t tick_nanos_;
+
+  // Bucket heads. buckets_.size() is a power of two.
+  std::vector<TimerWheelEntry*> buckets_;
+  const size_t bucket_mask_;
+
+  int num_entries_;
+
+  // The last tick up to which the wheel has been advanced. Entries are never
+  // scheduled into slots at or before this tick.
+  int64_t last_tick_;
+
+  DISALLOW_COPY_AND_ASSIGN(TimerWheel);
+};
+
+} // namespace rpc
+} // namespace kudu
+
+#endif // KUDU_RPC_TIMER_WHEEL_H
@@ -19,9 +19,12 @@
 
 #include <sys/uio.h>
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <set>
+#include <vector>
 
 #include <gflags/gflags.h>
 #include <glog/logging.h>
@@ -30,6 +33,7 @@
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/rpc/constants.h"
+#include "kudu/util/compression/compression_codec.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/net/socket.h"
@@ -56,8 +60,19 @@ namespace rpc {
 using std::ostringstream;
 using std::set;
 using std::string;
+using std::vector;
 using strings::Substitute;
 
+namespace {
+
+// On connections which negotiated compression, every message carries an
+// extra length word following the standard length prefix. It holds the
+// uncompressed length of the payload, or zero if the payload was sent
+// uncompressed.
+const int32_t kCompressedFrameHeaderLength = sizeof(uint32_t);
+
+} // anonymous namespace
+
 #define RETURN_ON_ERROR_OR_SOCKET_NOT_READY(status) \
   if (PREDICT_FALSE(!status.ok())) {                            \
     if (Socket::IsTemporarySocketError(status.posix_code())) {  \
@@ -124,6 +139,45 @@ Status InboundTransfer::ReceiveBuffer(Socket &socket) {
   return Status::OK();
 }
 
+Status InboundTransfer::UncompressPayload(const CompressionCodec* codec) {
+  DCHECK(TransferFinished());
+  if (total_length_ < kMsgLengthPrefixLength + kCompressedFrameHeaderLength) {
+    return Status::Corruption(Substitute(
+        "compressed RPC frame was only $0 bytes long", total_length_));
+  }
+  uint32_t uncompressed_len = NetworkByteOrder::Load32(&buf_[kMsgLengthPrefixLength]);
+  int32_t payload_len = total_length_ - kMsgLengthPrefixLength - kCompressedFrameHeaderLength;
+  if (uncompressed_len == 0) {
+    // The sender transmitted the payload uncompressed; just strip the
+    // compression frame header and fix up the length prefix.
+    memmove(&buf_[kMsgLengthPrefixLength],
+            &buf_[kMsgLengthPrefixLength + kCompressedFrameHeaderLength],
+            payload_len);
+    buf_.resize(kMsgLengthPrefixLength + payload_len);
+    NetworkByteOrder::Store32(&buf_[0], payload_len);
+  } else {
+    if (uncompressed_len + kMsgLengthPrefixLength >
+        static_cast<uint32_t>(FLAGS_rpc_max_message_size)) {
+      return Status::NetworkError(Substitute(
+          "RPC frame had an uncompressed length of $0, but we only support messages "
+          "up to $1 bytes long.", uncompressed_len, FLAGS_rpc_max_message_size));
+    }
+    // Move the compressed payload aside and decompress it back into our
+    // buffer, so that the message ends up in standard framing.
+    faststring compressed;
+    compressed.append(&buf_[kMsgLengthPrefixLength + kCompressedFrameHeaderLength],
+                      payload_len);
+    buf_.resize(kMsgLengthPrefixLength + uncompressed_len);
+    RETURN_NOT_OK(codec->Uncompress(Slice(compressed),
+                                    &buf_[kMsgLengthPrefixLength],
+                                    uncompressed_len));
+    NetworkByteOrder::Store32(&buf_[0], uncompressed_len);
+  }
+  total_length_ = buf_.size();
+  cur_offset_ = total_length_;
+  return Status::OK();
+}
+
 bool InboundTransfer::TransferStarted() const {
   return cur_offset_ != 0;
 }
@@ -156,6 +210,8 @@ OutboundTransfer::OutboundTransfer(int32_t call_id,
   : cur_slice_idx_(0),
     cur_offset_in_slice_(0),
     callbacks_(callbacks),
+    started_(false),
+    bypass_count_(0),
     call_id_(call_id),
     aborted_(false) {
 
@@ -173,6 +229,56 @@ OutboundTransfer::~OutboundTransfer() {
   }
 }
 
+Status OutboundTransfer::MaybeCompressPayload(const CompressionCodec* codec,
+                                              int32_t min_length) {
+  DCHECK(!TransferStarted());
+  int32_t uncompressed_len = TotalLength() - kMsgLengthPrefixLength;
+  if (uncompressed_len >= min_length) {
+    size_t max_compressed_len = codec->MaxCompressedLength(uncompressed_len);
+    compression_buf_.resize(kMsgLengthPrefixLength + kCompressedFrameHeaderLength +
+                            max_compressed_len);
+    // Gather the payload (everything following the length prefix).
+    vector<Slice> slices;
+    slices.reserve(n_payload_slices_);
+    for (int i = 0; i < n_payload_slices_; i++) {
+      slices.push_back(payload_slices_[i]);
+    }
+    slices[0].remove_prefix(kMsgLengthPrefixLength);
+    size_t compressed_len;
+    RETURN_NOT_OK(codec->Compress(
+        slices,
+        &compression_buf_[kMsgLengthPrefixLength + kCompressedFrameHeaderLength],
+        &compressed_len));
+    if (compressed_len < static_cast<size_t>(uncompressed_len)) {
+      compression_buf_.resize(kMsgLengthPrefixLength + kCompressedFrameHeaderLength +
+                              compressed_len);
+      NetworkByteOrder::Store32(&compression_buf_[0],
+                                kCompressedFrameHeaderLength + compressed_len);
+      NetworkByteOrder::Store32(&compression_buf_[kMsgLengthPrefixLength],
+                                uncompressed_len);
+      payload_slices_[0] = Slice(compression_buf_);
+      n_payload_slices_ = 1;
+      return Status::OK();
+    }
+    // The payload didn't shrink; fall through and send it as-is.
+  }
+
+  // Send the payload unmodified. A zero in the compression frame header
+  // tells the peer not to decompress it.
+  compression_buf_.resize(kMsgLengthPrefixLength + kCompressedFrameHeaderLength);
+  NetworkByteOrder::Store32(&compression_buf_[0],
+                            kCompressedFrameHeaderLength + uncompressed_len);
+  NetworkByteOrder::Store32(&compression_buf_[kMsgLengthPrefixLength], 0);
+  DCHECK_LT(n_payload_slices_, payload_slices_.size());
+  for (int i = n_payload_slices_; i > 0; i--) {
+    payload_slices_[i] = payload_slices_[i - 1];
+  }
+  n_payload_slices_++;
+  payload_slices_[0] = Slice(compression_buf_);
+  payload_slices_[1].remove_prefix(kMsgLengthPrefixLength);
+  return Status::OK();
+}
+
 void OutboundTransfer::Abort(const Status &status) {
   CHECK(!aborted_) << "Already aborted";
   CHECK(!TransferFinished()) << "Cannot abort a finished transfer";
@@ -180,41 +286,37 @@ void OutboundTransfer::Abort(const Status &status) {
   aborted_ = true;
 }
 
-Status OutboundTransfer::SendBuffer(Socket &socket) {
-  CHECK_LT(cur_slice_idx_, n_payload_slices_);
+size_t OutboundTransfer::FillIovecs(struct ::iovec* iov, size_t max_iovecs) {
+  DCHECK_LT(cur_slice_idx_, n_payload_slices_);
 
-  int n_iovecs = n_payload_slices_ - cur_slice_idx_;
-  struct iovec iovec[n_iovecs];
-  {
-    int offset_in_slice = cur_offset_in_slice_;
-    for (int i = 0; i < n_iovecs; i++) {
-      Slice &slice = payload_slices_[cur_slice_idx_ + i];
-      iovec[i].iov_base = slice.mutable_data() + offset_in_slice;
-      iovec[i].iov_len = slice.size() - offset_in_slice;
+  size_t n_iovecs = std::min<size_t>(n_payload_slices_ - cur_slice_idx_, max_iovecs);
+  int offset_in_slice = cur_offset_in_slice_;
+  for (size_t i = 0; i < n_iovecs; i++) {
+    Slice &slice = payload_slices_[cur_slice_idx_ + i];
+    iov[i].iov_base = slice.mutable_data() + offset_in_slice;
+    iov[i].iov_len = slice.size() - offset_in_slice;
 
-      offset_in_slice = 0;
-    }
+    offset_in_slice = 0;
   }
+  return n_iovecs;
+}
 
-  int32_t written;
-  Status status = socket.Writev(iovec, n_iovecs, &written);
-  RETURN_ON_ERROR_OR_SOCKET_NOT_READY(status);
-
+void OutboundTransfer::TransferSent(int64_t* bytes) {
   // Adjust our accounting of current writer position.
-  for (int i = cur_slice_idx_; i < n_payload_slices_; i++) {
+  for (int i = cur_slice_idx_; i < n_payload_slices_ && *bytes > 0; i++) {
     Slice &slice = payload_slices_[i];
-    int rem_in_slice = slice.size() - cur_offset_in_slice_;
+    int64_t rem_in_slice = slice.size() - cur_offset_in_slice_;
     DCHECK_GE(rem_in_slice, 0);
 
-    if (written >= rem_in_slice) {
+    if (*bytes >= rem_in_slice) {
       // Used up this entire slice, advance to the next slice.
       cur_slice_idx_++;
       cur_offset_in_slice_ = 0;
-      written -= rem_in_slice;
+      *bytes -= rem_in_slice;
     } else {
       // Partially used up this slice, just advance the offset within it.
-      cur_offset_in_slice_ += written;
-      break;
+      cur_offset_in_slice_ += *bytes;
+      *bytes = 0;
     }
   }
 
@@ -225,8 +327,6 @@ Status OutboundTransfer::SendBuffer(Socket &socket) {
     DCHECK_LT(cur_slice_idx_, n_payload_slices_);
     DCHECK_LT(cur_offset_in_slice_, payload_slices_[cur_slice_idx_].size());
   }
-
-  return Status::OK();
 }
 
 bool OutboundTransfer::TransferStarted() const {
@@ -35,8 +35,11 @@
 
 DECLARE_int32(rpc_max_message_size);
 
+struct iovec;
+
 namespace kudu {
 
+class CompressionCodec;
 class Socket;
 
 namespace rpc {
@@ -47,7 +50,7 @@ class TransferLimits {
  public:
   enum {
     kMaxSidecars = 10,
-    kMaxPayloadSlices = kMaxSidecars + 2 // (header + msg)
+    kMaxPayloadSlices = kMaxSidecars + 3 // (header + msg + compression frame header)
   };
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(TransferLimits);
@@ -69,6 +72,13 @@ class InboundTransfer {
   // read from the socket into our buffer
   Status ReceiveBuffer(Socket &socket);
 
+  // Decode the compression frame header of a fully-received message and
+  // rewrite the buffer into standard (uncompressed) framing, decompressing
+  // the payload with 'codec' if the sender compressed it. Must only be
+  // called on connections which negotiated compression, after the transfer
+  // has finished.
+  Status UncompressPayload(const CompressionCodec* codec);
+
   // Return true if any bytes have yet been sent.
   bool TransferStarted() const;
 
@@ -136,8 +146,23 @@ class OutboundTransfer : public boost::intrusive::list_base_hook<> {
   // This triggers TransferCallbacks::NotifyTransferAborted.
   void Abort(const Status &status);
 
-  // send from our buffers into the sock
-  Status SendBuffer(Socket &socket);
+  // Reframe the transfer for a connection which negotiated compression,
+  // compressing the payload with 'codec' if it is at least 'min_length'
+  // bytes long and compression actually shrinks it. Smaller (or
+  // incompressible) payloads are sent unmodified with a marker telling the
+  // peer not to decompress them. Must be called before any bytes are sent.
+  Status MaybeCompressPayload(const CompressionCodec* codec, int32_t min_length);
+
+  // Fill 'iov' with up to 'max_iovecs' iovecs pointing at the portion of this
+  // transfer which has not yet been sent. Returns the number of iovecs filled
+  // in. This does not advance any accounting; it is used by the Connection to
+  // gather several queued transfers into a single writev() call.
+  size_t FillIovecs(struct ::iovec* iov, size_t max_iovecs);
+
+  // Advance this transfer's accounting by up to '*bytes' sent bytes,
+  // decrementing '*bytes' by the amount consumed. If the transfer is thereby
+  // completed, triggers TransferCallbacks::NotifyTransferFinished.
+  void TransferSent(int64_t* bytes);
 
   // Return true if any bytes have yet been sent.
   bool TransferStarted() const;
@@ -145,6 +170,13 @@ class OutboundTransfer : public boost::intrusive::list_base_hook<> {
   // Return true if the entire transfer has been sent.
   bool TransferFinished() const;
 
+  // Whether the connection has already performed its pre-send checks for this
+  // transfer (e.g. marking the associated call as being sent). The checks may
+  // run before any of the transfer's bytes hit the socket, so this is
+  // distinct from TransferStarted().
+  bool started() const { return started_; }
+  void set_started() { started_ = true; }
+
   // Return the total number of bytes to be sent (including those already sent)
   int32_t TotalLength() const;
 
@@ -161,6 +193,12 @@ class OutboundTransfer : public boost::intrusive::list_base_hook<> {
     return call_id_;
   }
 
+  // The number of times a later-queued transfer has been sent ahead of this
+  // one. Used by the Connection to bound how long a large transfer may be
+  // delayed by smaller ones. See Connection::QueueOutbound().
+  int bypass_count() const { return bypass_count_; }
+  void IncrementBypassCount() { bypass_count_++; }
+
  private:
   OutboundTransfer(int32_t call_id,
                    const TransferPayload& payload,
@@ -172,6 +210,10 @@ class OutboundTransfer : public boost::intrusive::list_base_hook<> {
   TransferPayload payload_slices_;
   size_t n_payload_slices_;
 
+  // Backing storage for the reframed payload built by MaybeCompressPayload().
+  // Unused on connections which did not negotiate compression.
+  faststring compression_buf_;
+
   // The current slice that is being sent.
   int32_t cur_slice_idx_;
   // The number of bytes in the above slice which has already been sent.
@@ -179,6 +221,12 @@ class OutboundTransfer : public boost::intrusive::list_base_hook<> {
 
   TransferCallbacks *callbacks_;
 
+  // Whether the connection has performed its pre-send checks. See started().
+  bool started_;
+
+  // See bypass_count().
+  int bypass_count_;
+
   // In the case of outbound calls, the associated call ID.
   // In the case of call responses, kInvalidCallId
   int32_t call_id_;
@@ -36,6 +36,7 @@ typedef struct X509_req_st X509_REQ;
 typedef struct bio_st BIO;
 typedef struct evp_pkey_st EVP_PKEY;
 typedef struct ssl_ctx_st SSL_CTX;
+typedef struct ssl_session_st SSL_SESSION;
 typedef struct ssl_st SSL;
 typedef struct x509_st X509;
 
@@ -155,6 +156,9 @@ template<> struct SslTypeTraits<EVP_PKEY> {
 template<> struct SslTypeTraits<SSL_CTX> {
   static constexpr auto kFreeFunc = &SSL_CTX_free;
 };
+template<> struct SslTypeTraits<SSL_SESSION> {
+  static constexpr auto kFreeFunc = &SSL_SESSION_free;
+};
 
 template<typename SSL_TYPE, typename Traits = SslTypeTraits<SSL_TYPE>>
 c_unique_ptr<SSL_TYPE> ssl_make_unique(SSL_TYPE* d) {
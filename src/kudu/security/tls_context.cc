@@ -82,6 +82,18 @@ DEFINE_string(rpc_tls_min_protocol, "TLSv1",
               "'TLSv1.2'.");
 TAG_FLAG(rpc_tls_min_protocol, advanced);
 
+DEFINE_bool(rpc_tls_resume_sessions, false,
+            "Whether clients should attempt TLS session resumption when "
+            "reconnecting to a previously contacted server. Resumption uses "
+            "the encrypted session ticket issued by the server during the "
+            "original handshake to skip the certificate exchange and key "
+            "agreement, completing the TLS portion of connection negotiation "
+            "in a single round trip. All servers must be running a version "
+            "which supports session resumption before this flag is enabled "
+            "on clients.");
+TAG_FLAG(rpc_tls_resume_sessions, advanced);
+TAG_FLAG(rpc_tls_resume_sessions, experimental);
+
 namespace kudu {
 namespace security {
 
@@ -481,5 +493,22 @@ Status TlsContext::InitiateHandshake(TlsHandshakeType handshake_type,
   return Status::OK();
 }
 
+c_unique_ptr<SSL_SESSION> TlsContext::GetCachedSession(const string& cache_key) const {
+  if (!FLAGS_rpc_tls_resume_sessions) return nullptr;
+  unique_lock<RWMutex> lock(lock_);
+  auto it = session_cache_.find(cache_key);
+  if (it == session_cache_.end()) return nullptr;
+  auto session = std::move(it->second);
+  session_cache_.erase(it);
+  return session;
+}
+
+void TlsContext::CacheSession(const string& cache_key,
+                              c_unique_ptr<SSL_SESSION> session) const {
+  if (!FLAGS_rpc_tls_resume_sessions || !session) return;
+  unique_lock<RWMutex> lock(lock_);
+  session_cache_[cache_key] = std::move(session);
+}
+
 } // namespace security
 } // namespace kudu
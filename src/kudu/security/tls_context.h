@@ -20,6 +20,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <boost/optional/optional.hpp>
@@ -161,6 +162,22 @@ class TlsContext {
   Status InitiateHandshake(TlsHandshakeType handshake_type,
                            TlsHandshake* handshake) const WARN_UNUSED_RESULT;
 
+  // Returns the TLS session cached under 'cache_key' by a previous call to
+  // CacheSession(), so that a new client-side handshake can attempt session
+  // resumption. Returns nullptr if session resumption is disabled (see
+  // --rpc_tls_resume_sessions) or no session has been cached under the key.
+  //
+  // The session is removed from the cache when it is handed out: session
+  // tickets are intended for one-time use, and the handshake which consumes
+  // the session re-caches the (possibly renewed) session when it completes.
+  c_unique_ptr<SSL_SESSION> GetCachedSession(const std::string& cache_key) const;
+
+  // Caches the TLS session negotiated by a completed client-side handshake
+  // under 'cache_key', replacing any previously cached session. This is a
+  // no-op if session resumption is disabled or 'session' is null.
+  void CacheSession(const std::string& cache_key,
+                    c_unique_ptr<SSL_SESSION> session) const;
+
   // Return the number of certs that have been marked as trusted.
   // Used by tests.
   int trusted_cert_count_for_tests() const {
@@ -185,6 +202,15 @@ class TlsContext {
   bool has_cert_;
   bool is_external_cert_;
   boost::optional<CertSignRequest> csr_;
+
+  // Client-side cache of negotiated TLS sessions for resumption, keyed by an
+  // identifier for the remote server (see GetCachedSession()). The cache is
+  // naturally bounded by the number of distinct servers this context connects
+  // to, since each key holds at most one session.
+  //
+  // This is mutable because caching a session does not modify any externally
+  // visible state of the context.
+  mutable std::unordered_map<std::string, c_unique_ptr<SSL_SESSION>> session_cache_;
 };
 
 } // namespace security
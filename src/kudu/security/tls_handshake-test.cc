@@ -43,6 +43,7 @@
 using std::string;
 using std::vector;
 
+DECLARE_bool(rpc_tls_resume_sessions);
 DECLARE_int32(ipki_server_key_size);
 
 namespace kudu {
@@ -98,12 +99,18 @@ class TestTlsHandshakeBase : public KuduTest {
     client.set_verification_mode(client_verify);
     server.set_verification_mode(server_verify);
 
+    return RunHandshakeLoop(&client, &server);
+  }
+
+  // Pump handshake messages between 'client' and 'server' until both sides
+  // complete their handshakes.
+  Status RunHandshakeLoop(TlsHandshake* client, TlsHandshake* server) {
     bool client_done = false, server_done = false;
     string to_client;
     string to_server;
     while (!client_done || !server_done) {
       if (!client_done) {
-        Status s = client.Continue(to_client, &to_server);
+        Status s = client->Continue(to_client, &to_server);
         VLOG(1) << "client->server: " << to_server.size() << " bytes";
         if (s.ok()) {
           client_done = true;
@@ -113,8 +120,7 @@ class TestTlsHandshakeBase : public KuduTest {
         }
       }
       if (!server_done) {
-        CHECK(!client_done);
-        Status s = server.Continue(to_server, &to_client);
+        Status s = server->Continue(to_server, &to_client);
         VLOG(1) << "server->client: " << to_client.size() << " bytes";
         if (s.ok()) {
           server_done = true;
@@ -215,6 +221,45 @@ TEST_F(TestTlsHandshake, TestHandshakeSequence) {
   ASSERT_EQ(buf2.size(), 0);
 }
 
+// Tests that a client can resume a cached TLS session with an abbreviated
+// handshake, using the session ticket issued by the server during the
+// original handshake.
+TEST_F(TestTlsHandshake, TestSessionResumption) {
+  FLAGS_rpc_tls_resume_sessions = true;
+  const string kCacheKey = "server";
+
+  ASSERT_OK(server_tls_.GenerateSelfSignedCertAndKey());
+
+  // The first handshake has no cached session to offer, so it negotiates a
+  // new session from scratch.
+  ASSERT_FALSE(client_tls_.GetCachedSession(kCacheKey));
+  for (int i = 0; i < 3; i++) {
+    TlsHandshake client, server;
+    ASSERT_OK(client_tls_.InitiateHandshake(TlsHandshakeType::CLIENT, &client));
+    ASSERT_OK(server_tls_.InitiateHandshake(TlsHandshakeType::SERVER, &server));
+    client.set_verification_mode(TlsVerificationMode::VERIFY_NONE);
+    server.set_verification_mode(TlsVerificationMode::VERIFY_NONE);
+
+    auto session = client_tls_.GetCachedSession(kCacheKey);
+    ASSERT_EQ(i > 0, session != nullptr);
+    if (session) {
+      client.set_session(std::move(session));
+    }
+
+    ASSERT_OK(RunHandshakeLoop(&client, &server));
+    ASSERT_EQ(i > 0, client.IsSessionReused());
+
+    // Cache the negotiated session for the next connection. The cached
+    // session is consumed when it is handed out, so each handshake must
+    // re-cache the session it negotiated.
+    client_tls_.CacheSession(kCacheKey, client.GetSession());
+  }
+
+  // With resumption disabled, nothing is handed out from the cache.
+  FLAGS_rpc_tls_resume_sessions = false;
+  ASSERT_FALSE(client_tls_.GetCachedSession(kCacheKey));
+}
+
 // Tests that the TlsContext can transition from self signed cert to signed
 // cert, and that it rejects invalid certs along the way. We are testing this
 // here instead of in a dedicated TlsContext test because it requires completing
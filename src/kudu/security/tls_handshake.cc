@@ -79,6 +79,34 @@ void TlsHandshake::SetSSLVerify() {
   SSL_set_verify(ssl_.get(), ssl_mode, /* callback = */nullptr);
 }
 
+void TlsHandshake::set_session(c_unique_ptr<SSL_SESSION> session) {
+  SCOPED_OPENSSL_NO_PENDING_ERRORS;
+  CHECK(ssl_);
+  CHECK(!has_started_);
+  DCHECK(session);
+  // SSL_set_session() takes its own reference on the session, so the caller's
+  // reference is dropped when 'session' goes out of scope. If the session
+  // can't be offered (e.g. it has already expired), just proceed with a full
+  // handshake.
+  if (SSL_set_session(ssl_.get(), session.get()) != 1) {
+    ERR_clear_error();
+  }
+}
+
+c_unique_ptr<SSL_SESSION> TlsHandshake::GetSession() const {
+  SCOPED_OPENSSL_NO_PENDING_ERRORS;
+  CHECK(ssl_);
+  DCHECK(SSL_is_init_finished(ssl_.get()));
+  return ssl_make_unique(SSL_get1_session(ssl_.get()));
+}
+
+bool TlsHandshake::IsSessionReused() const {
+  SCOPED_OPENSSL_NO_PENDING_ERRORS;
+  CHECK(ssl_);
+  DCHECK(SSL_is_init_finished(ssl_.get()));
+  return SSL_session_reused(ssl_.get()) != 0;
+}
+
 Status TlsHandshake::Continue(const string& recv, string* send) {
   SCOPED_OPENSSL_NO_PENDING_ERRORS;
   if (!has_started_) {
@@ -80,6 +80,26 @@ class TlsHandshake {
     verification_mode_ = mode;
   }
 
+  // Offer a TLS session from a previous handshake with the same server, so
+  // that the server may resume it with an abbreviated handshake instead of a
+  // full one. If the server declines (e.g. the session ticket has expired or
+  // the server has restarted), a full handshake transparently takes place
+  // instead.
+  //
+  // This must be called before the first call to Continue(), and only on a
+  // CLIENT-side handshake.
+  void set_session(c_unique_ptr<SSL_SESSION> session);
+
+  // Retrieve the negotiated TLS session, including any session ticket issued
+  // by the server, for later resumption of connections to the same server.
+  // Only valid to call after the handshake is complete and before 'Finish()'.
+  c_unique_ptr<SSL_SESSION> GetSession() const;
+
+  // Returns true if this handshake resumed a previous session rather than
+  // negotiating a new one. Only valid to call after the handshake is complete
+  // and before 'Finish()'.
+  bool IsSessionReused() const;
+
   // Continue or start a new handshake.
   //
   // 'recv' should contain the input buffer from the remote end, or an empty
@@ -19,10 +19,12 @@
 
 #include <sys/stat.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <fstream>
 #include <memory>
+#include <ostream>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -267,8 +269,8 @@ void AddDefaultPathHandlers(Webserver* webserver) {
 
 static void WriteMetricsAsJson(const MetricRegistry* const metrics,
                                const Webserver::WebRequest& req,
-                               Webserver::PrerenderedWebResponse* resp) {
-  std::ostringstream* output = resp->output;
+                               Webserver::StreamingWebResponse* resp) {
+  std::ostream* output = resp->output;
   const string* requested_metrics_param = FindOrNull(req.parsed_args, "metrics");
   vector<string> requested_metrics;
   MetricJsonOptions opts;
@@ -292,6 +294,14 @@ static void WriteMetricsAsJson(const MetricRegistry* const metrics,
 
   if (requested_metrics_param != nullptr) {
     SplitStringUsing(*requested_metrics_param, ",", &requested_metrics);
+    // If any of the requested metrics is the wildcard, collapse the list down
+    // to just the wildcard: every metric matches on the first comparison
+    // rather than substring-searching through the whole parameter list.
+    if (std::find(requested_metrics.begin(), requested_metrics.end(), "*") !=
+        requested_metrics.end()) {
+      requested_metrics.clear();
+      requested_metrics.emplace_back("*");
+    }
   } else {
     // Default to including all metrics.
     requested_metrics.emplace_back("*");
@@ -302,18 +312,19 @@ static void WriteMetricsAsJson(const MetricRegistry* const metrics,
 }
 
 void RegisterMetricsJsonHandler(Webserver* webserver, const MetricRegistry* const metrics) {
-  Webserver::PrerenderedPathHandlerCallback callback = boost::bind(WriteMetricsAsJson, metrics,
-                                                                   _1, _2);
-  bool not_styled = false;
+  Webserver::StreamingPathHandlerCallback callback = boost::bind(WriteMetricsAsJson, metrics,
+                                                                 _1, _2);
   bool not_on_nav_bar = false;
   bool is_on_nav_bar = true;
-  webserver->RegisterPrerenderedPathHandler("/metrics", "Metrics", callback,
-                                            not_styled, is_on_nav_bar);
+  // The metrics dump on a busy server can run to many megabytes; stream it to
+  // the client as it's serialized rather than rendering it into memory first.
+  webserver->RegisterStreamingPathHandler("/metrics", "Metrics", callback,
+                                          is_on_nav_bar);
 
   // The old name -- this is preserved for compatibility with older releases of
   // monitoring software which expects the old name.
-  webserver->RegisterPrerenderedPathHandler("/jsonmetricz", "Metrics", callback,
-                                            not_styled, not_on_nav_bar);
+  webserver->RegisterStreamingPathHandler("/jsonmetricz", "Metrics", callback,
+                                          not_on_nav_bar);
 }
 
 } // namespace kudu
@@ -149,6 +149,30 @@ TEST_F(WebserverTest, TestIndexPage) {
   ASSERT_STR_CONTAINS(buf_.ToString(), "memz");
 }
 
+TEST_F(WebserverTest, TestStreamingHandler) {
+  // Register a handler which streams a body much larger than the webserver's
+  // internal chunk buffer, and check that it round-trips intact.
+  const int kNumLines = 100000;
+  server_->RegisterStreamingPathHandler(
+      "/streaming", "Streaming",
+      [](const Webserver::WebRequest& /*req*/, Webserver::StreamingWebResponse* resp) {
+        for (int i = 0; i < kNumLines; i++) {
+          *resp->output << "line " << i << "\n";
+        }
+      },
+      /*is_on_nav_bar=*/ false);
+
+  curl_.set_return_headers(true);
+  ASSERT_OK(curl_.FetchURL(strings::Substitute("http://$0/streaming", addr_.ToString()),
+                           &buf_));
+  string resp = buf_.ToString();
+  // The response should be chunked, since its length isn't known up front.
+  ASSERT_STR_CONTAINS(resp, "Transfer-Encoding: chunked");
+  ASSERT_STR_NOT_CONTAINS(resp, "Content-Length:");
+  ASSERT_STR_CONTAINS(resp, "line 0\n");
+  ASSERT_STR_CONTAINS(resp, strings::Substitute("line $0\n", kNumLines - 1));
+}
+
 TEST_F(SslWebserverTest, TestSSL) {
   // We use a self-signed cert, so we need to disable cert verification in curl.
   curl_.set_verify_peer(false);
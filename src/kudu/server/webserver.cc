@@ -20,13 +20,16 @@
 #include <algorithm>
 #include <csignal>
 #include <cstdint>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <ostream>
 #include <sstream>
+#include <streambuf>
 #include <string>
 #include <unordered_set>
 #include <utility>
@@ -106,6 +109,88 @@ namespace {
     LOG(FATAL) << "Unexpected HTTP response code";
   }
 
+  // A std::streambuf which forwards data to a Squeasel connection using HTTP
+  // chunked transfer encoding (or raw writes for HTTP/1.0 clients, which
+  // don't understand chunking). Output accumulates in a fixed-size buffer
+  // and is emitted one chunk per flush, so a large response body is never
+  // materialized in memory.
+  class SqStreamingStreambuf : public std::streambuf {
+   public:
+    // 'headers_fn' is invoked to produce the response headers just before the
+    // first byte of the body is sent.
+    SqStreamingStreambuf(struct sq_connection* connection,
+                         std::function<string()> headers_fn,
+                         bool use_chunked)
+        : connection_(connection),
+          headers_fn_(std::move(headers_fn)),
+          use_chunked_(use_chunked),
+          headers_sent_(false) {
+      setp(buf_, buf_ + kBufSize);
+    }
+
+    // Emits any buffered data followed by the zero-length chunk which
+    // terminates a chunked response. The headers are sent even if the
+    // handler never wrote any data.
+    void Finish() {
+      SendHeaders();
+      EmitChunk();
+      if (use_chunked_) {
+        static const char kFinalChunk[] = "0\r\n\r\n";
+        sq_write(connection_, kFinalChunk, sizeof(kFinalChunk) - 1);
+      }
+    }
+
+   protected:
+    int overflow(int c) override {
+      SendHeaders();
+      EmitChunk();
+      if (c != traits_type::eof()) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+      }
+      return traits_type::not_eof(c);
+    }
+
+    int sync() override {
+      SendHeaders();
+      EmitChunk();
+      return 0;
+    }
+
+   private:
+    // Balances per-chunk framing and syscall overhead against memory usage.
+    static const size_t kBufSize = 64 * 1024;
+
+    void SendHeaders() {
+      if (headers_sent_) return;
+      headers_sent_ = true;
+      string headers = headers_fn_();
+      sq_write(connection_, headers.c_str(), headers.length());
+    }
+
+    void EmitChunk() {
+      size_t len = pptr() - pbase();
+      if (len == 0) return;
+      if (use_chunked_) {
+        char chunk_header[32];
+        int header_len = snprintf(chunk_header, sizeof(chunk_header),
+                                  "%zx\r\n", len);
+        sq_write(connection_, chunk_header, header_len);
+        sq_write(connection_, pbase(), len);
+        sq_write(connection_, "\r\n", 2);
+      } else {
+        sq_write(connection_, pbase(), len);
+      }
+      setp(buf_, buf_ + kBufSize);
+    }
+
+    struct sq_connection* const connection_;
+    const std::function<string()> headers_fn_;
+    const bool use_chunked_;
+    bool headers_sent_;
+    char buf_[kBufSize];
+  };
+
 }  // anonymous namespace
 
 namespace kudu {
@@ -457,6 +542,50 @@ int Webserver::RunPathHandler(const PathHandler& handler,
     use_style = false;
   }
 
+  if (handler.is_streaming()) {
+    // A streamed response can be much larger than we're willing to buffer,
+    // so there's no way to compute a Content-Length up front. Use chunked
+    // transfer encoding, except for HTTP/1.0 clients which don't understand
+    // it; those get a raw body and the connection is closed afterwards.
+    bool use_chunked = strcmp(request_info->http_version, "1.0") != 0;
+    StreamingWebResponse resp { HttpStatusCode::Ok, HttpResponseHeaders{}, nullptr };
+    auto headers_fn = [&]() {
+      ostringstream headers_stream;
+      headers_stream << Substitute("HTTP/1.1 $0\r\n",
+                                   HttpStatusCodeToString(resp.status_code));
+      headers_stream << "Content-Type: text/plain\r\n";
+      if (use_chunked) {
+        headers_stream << "Transfer-Encoding: chunked\r\n";
+      } else {
+        headers_stream << "Connection: close\r\n";
+      }
+      headers_stream << Substitute("X-Frame-Options: $0\r\n", FLAGS_webserver_x_frame_options);
+      std::unordered_set<string> invalid_headers{"Content-Type", "Content-Length",
+                                                 "Transfer-Encoding", "X-Frame-Options"};
+      for (const auto& entry : resp.response_headers) {
+        // It's forbidden to override the above headers.
+        if (ContainsKey(invalid_headers, entry.first)) {
+          LOG(FATAL) << "Reserved header " << entry.first << " was overridden "
+              "by handler for " << handler.alias();
+        }
+        headers_stream << Substitute("$0: $1\r\n", entry.first, entry.second);
+      }
+      headers_stream << "\r\n";
+      return headers_stream.str();
+    };
+    SqStreamingStreambuf streambuf(connection, headers_fn, use_chunked);
+    std::ostream out(&streambuf);
+    resp.output = &out;
+    if (kudu::g_should_redact == kudu::RedactContext::ALL) {
+      handler.stream_callback()(req, &resp);
+    } else {
+      ScopedDisableRedaction s;
+      handler.stream_callback()(req, &resp);
+    }
+    streambuf.Finish();
+    return 1;
+  }
+
   ostringstream content;
   PrerenderedWebResponse resp { HttpStatusCode::Ok, HttpResponseHeaders{}, &content };
   // Enable or disable redaction from the web UI based on the setting of --redact.
@@ -522,6 +651,12 @@ void Webserver::RegisterPrerenderedPathHandler(const string& path, const string&
   InsertOrDie(&path_handlers_, path, new PathHandler(is_styled, is_on_nav_bar, alias, callback));
 }
 
+void Webserver::RegisterStreamingPathHandler(const string& path, const string& alias,
+    const StreamingPathHandlerCallback& callback, bool is_on_nav_bar) {
+  std::lock_guard<RWMutex> l(lock_);
+  InsertOrDie(&path_handlers_, path, new PathHandler(is_on_nav_bar, alias, callback));
+}
+
 string Webserver::MustachePartialTag(const string& path) const {
   return Substitute("{{> $0.mustache}}", path);
 }
@@ -78,6 +78,14 @@ class Webserver : public WebCallbackRegistry {
                                       bool is_styled,
                                       bool is_on_nav_bar) override;
 
+  // Register a route 'path' whose response body is streamed to the client as
+  // the handler produces it, using chunked transfer encoding. This avoids
+  // buffering large response bodies (e.g. /metrics) in memory.
+  // See RegisterPathHandler for the other parameters.
+  void RegisterStreamingPathHandler(const std::string& path, const std::string& alias,
+                                    const StreamingPathHandlerCallback& callback,
+                                    bool is_on_nav_bar) override;
+
   // Change the footer HTML to be displayed at the bottom of all styled web pages.
   void set_footer_html(const std::string& html);
 
@@ -95,10 +103,19 @@ class Webserver : public WebCallbackRegistry {
           alias_(std::move(alias)),
           callback_(std::move(callback)) {}
 
+    PathHandler(bool is_on_nav_bar, std::string alias,
+                StreamingPathHandlerCallback stream_callback)
+        : is_styled_(false),
+          is_on_nav_bar_(is_on_nav_bar),
+          alias_(std::move(alias)),
+          stream_callback_(std::move(stream_callback)) {}
+
     bool is_styled() const { return is_styled_; }
     bool is_on_nav_bar() const { return is_on_nav_bar_; }
+    bool is_streaming() const { return !stream_callback_.empty(); }
     const std::string& alias() const { return alias_; }
     const PrerenderedPathHandlerCallback& callback() const { return callback_; }
+    const StreamingPathHandlerCallback& stream_callback() const { return stream_callback_; }
 
    private:
     // If true, the page appears is rendered styled.
@@ -110,8 +127,12 @@ class Webserver : public WebCallbackRegistry {
     // Alias used when displaying this link on the nav bar.
     std::string alias_;
 
-    // Callback to render output for this page.
+    // Callback to render output for this page. Exactly one of 'callback_'
+    // and 'stream_callback_' is set.
     PrerenderedPathHandlerCallback callback_;
+
+    // Callback which streams output for this page directly to the client.
+    StreamingPathHandlerCallback stream_callback_;
   };
 
   bool static_pages_available() const;
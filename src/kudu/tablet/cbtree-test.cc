@@ -305,6 +305,46 @@ TEST_F(TestCBTree, TestInsertAndVerify) {
   }
 }
 
+// Tests the fast path for in-order inserts: monotonically increasing keys
+// go through the rightmost-leaf hint, including across leaf splits, while
+// duplicates and out-of-order inserts must fall back to the full descent.
+TEST_F(TestCBTree, TestSequentialInsertFastPath) {
+  CBTree<SmallFanoutTraits> t;
+  char kbuf[64];
+  char vbuf[64];
+
+  const int kNumKeys = 10000;
+  for (int i = 0; i < kNumKeys; i++) {
+    snprintf(kbuf, sizeof(kbuf), "key_%08d", i);
+    snprintf(vbuf, sizeof(vbuf), "val_%d", i);
+    ASSERT_TRUE(t.Insert(Slice(kbuf), Slice(vbuf))) << "Failed insert at iteration " << i;
+
+    // Re-inserting the largest key must be detected as a duplicate even
+    // though the hint points at the leaf holding it.
+    ASSERT_FALSE(t.Insert(Slice(kbuf), Slice(vbuf)))
+        << "Allowed duplicate insert at iteration " << i;
+  }
+
+  // Keys sorting before the rightmost leaf miss the hint and descend from
+  // the root.
+  for (int i = 100; i > 0; i--) {
+    snprintf(kbuf, sizeof(kbuf), "before_%08d", i);
+    snprintf(vbuf, sizeof(vbuf), "bval_%d", i);
+    ASSERT_TRUE(t.Insert(Slice(kbuf), Slice(vbuf))) << "Failed insert at iteration " << i;
+  }
+
+  for (int i = 0; i < kNumKeys; i++) {
+    snprintf(kbuf, sizeof(kbuf), "key_%08d", i);
+    snprintf(vbuf, sizeof(vbuf), "val_%d", i);
+    VerifyGet(t, Slice(kbuf), Slice(vbuf));
+  }
+  for (int i = 100; i > 0; i--) {
+    snprintf(kbuf, sizeof(kbuf), "before_%08d", i);
+    snprintf(vbuf, sizeof(vbuf), "bval_%d", i);
+    VerifyGet(t, Slice(kbuf), Slice(vbuf));
+  }
+}
+
 template<class TREE, class COLLECTION>
 static void InsertRandomKeys(TREE *t, int n_keys,
                              COLLECTION *inserted) {
@@ -54,7 +54,10 @@
 #include "kudu/util/status.h"
 #include "kudu/util/test_macros.h"
 
+DECLARE_bool(enable_skip_scan);
 DECLARE_int32(cfile_default_block_size);
+DECLARE_int32(num_column_materialization_threads);
+DECLARE_string(rowset_value_index_columns);
 
 using std::shared_ptr;
 using std::string;
@@ -269,6 +272,32 @@ TEST_F(TestCFileSet, TestIteratePartialSchema) {
   }
 }
 
+// Scan with parallel column materialization enabled and ensure the results
+// match a serial scan.
+TEST_F(TestCFileSet, TestParallelColumnMaterialization) {
+  const int kNumRows = 10000;
+  FLAGS_num_column_materialization_threads = 4;
+  WriteTestRowSet(kNumRows);
+
+  shared_ptr<CFileSet> fileset;
+  ASSERT_OK(CFileSet::Open(rowset_meta_, MemTracker::GetRootTracker(), &fileset));
+
+  // A scan with no predicates materializes every projected column through
+  // the parallel path.
+  shared_ptr<CFileSet::Iterator> cfile_iter(fileset->NewIterator(&schema_));
+  gscoped_ptr<RowwiseIterator> iter(new MaterializingIterator(cfile_iter));
+  ASSERT_OK(iter->Init(nullptr));
+
+  vector<string> results;
+  ASSERT_OK(IterateToStringList(iter.get(), &results));
+  ASSERT_EQ(kNumRows, results.size());
+  for (int i = 0; i < kNumRows; i++) {
+    ASSERT_EQ(StringPrintf("(int32 c0=%d, int32 c1=%d, int32 c2=%d)",
+                           i * 2, i * 10, i * 100),
+              results[i]);
+  }
+}
+
 // Add a range predicate on the key column and ensure that only the relevant small number of rows
 // are read off disk.
 TEST_F(TestCFileSet, TestRangeScan) {
@@ -349,5 +378,181 @@ TEST_F(TestCFileSet, TestRangePredicates2) {
 }
 
 
+// Verify the per-column min/max statistics stored in the cfile footers.
+// Column 'c1' contains the values [0, 10, ..., (kNumRows - 1) * 10].
+TEST_F(TestCFileSet, TestColumnStatsPruning) {
+  const int kNumRows = 10000;
+  WriteTestRowSet(kNumRows);
+
+  shared_ptr<CFileSet> fileset;
+  ASSERT_OK(CFileSet::Open(rowset_meta_, MemTracker::GetRootTracker(), &fileset));
+
+  ColumnId col_id = schema_.column_id(1);
+  const ColumnSchema& col = schema_.column(1);
+
+  // Ranges overlapping the column's values can't be pruned.
+  int32_t lower = 5000;
+  int32_t upper = 6000;
+  ASSERT_TRUE(fileset->MayMatchColumnPredicate(
+      col_id, ColumnPredicate::Range(col, &lower, &upper)));
+
+  // A range entirely above the maximum value can.
+  lower = kNumRows * 10;
+  ASSERT_FALSE(fileset->MayMatchColumnPredicate(
+      col_id, ColumnPredicate::Range(col, &lower, nullptr)));
+
+  // As can a range entirely below the minimum value.
+  upper = 0;
+  ASSERT_FALSE(fileset->MayMatchColumnPredicate(
+      col_id, ColumnPredicate::Range(col, nullptr, &upper)));
+
+  // Equality predicates prune based on the same bounds.
+  int32_t val = 5000;
+  ASSERT_TRUE(fileset->MayMatchColumnPredicate(
+      col_id, ColumnPredicate::Equality(col, &val)));
+  val = -1;
+  ASSERT_FALSE(fileset->MayMatchColumnPredicate(
+      col_id, ColumnPredicate::Equality(col, &val)));
+
+  // An IS NULL predicate on a non-nullable column simplifies to None,
+  // which no row can match.
+  ASSERT_FALSE(fileset->MayMatchColumnPredicate(col_id, ColumnPredicate::IsNull(col)));
+}
+
+// Write a rowset with a value index on 'c1' and verify that equality
+// predicates on the column are answered through the index.
+TEST_F(TestCFileSet, TestValueIndex) {
+  FLAGS_rowset_value_index_columns = "c1";
+  const int kNumRows = 10000;
+  WriteTestRowSet(kNumRows);
+
+  shared_ptr<CFileSet> fileset;
+  ASSERT_OK(CFileSet::Open(rowset_meta_, MemTracker::GetRootTracker(), &fileset));
+
+  ColumnId col_id = schema_.column_id(1);
+  ASSERT_EQ(vector<ColumnId>({ col_id }), fileset->value_index_col_ids());
+
+  // Column 'c1' contains the values [0, 10, ..., (kNumRows - 1) * 10], so
+  // each present value matches exactly the row at value / 10.
+  vector<rowid_t> matching_rows;
+  int32_t val = 5000;
+  ASSERT_OK(fileset->EvaluateValueIndex(col_id, &val, &matching_rows));
+  ASSERT_EQ(vector<rowid_t>({ 500 }), matching_rows);
+
+  matching_rows.clear();
+  val = 0;
+  ASSERT_OK(fileset->EvaluateValueIndex(col_id, &val, &matching_rows));
+  ASSERT_EQ(vector<rowid_t>({ 0 }), matching_rows);
+
+  matching_rows.clear();
+  val = (kNumRows - 1) * 10;
+  ASSERT_OK(fileset->EvaluateValueIndex(col_id, &val, &matching_rows));
+  ASSERT_EQ(vector<rowid_t>({ kNumRows - 1 }), matching_rows);
+
+  // A value falling between two entries matches nothing.
+  matching_rows.clear();
+  val = 5005;
+  ASSERT_OK(fileset->EvaluateValueIndex(col_id, &val, &matching_rows));
+  ASSERT_TRUE(matching_rows.empty());
+
+  // A scan with an equality predicate on the indexed column should return
+  // exactly the matching row while reading almost nothing off disk.
+  shared_ptr<CFileSet::Iterator> cfile_iter(fileset->NewIterator(&schema_));
+  cfile_iter->AddValueIndexSafeColumn(col_id);
+  gscoped_ptr<RowwiseIterator> iter(new MaterializingIterator(cfile_iter));
+
+  ScanSpec spec;
+  int32_t match = 5000;
+  spec.AddPredicate(ColumnPredicate::Equality(schema_.column(1), &match));
+  ASSERT_OK(iter->Init(&spec));
+
+  vector<string> results;
+  ASSERT_OK(IterateToStringList(iter.get(), &results));
+  ASSERT_EQ(1, results.size());
+  EXPECT_EQ("(int32 c0=1000, int32 c1=5000, int32 c2=50000)", results[0]);
+
+  vector<IteratorStats> stats;
+  iter->GetIteratorStats(&stats);
+  for (int i = 0; i < 3; i++) {
+    EXPECT_LT(stats[i].cells_read_from_disk, kNumRows / 10);
+  }
+}
+
+// Test fixture with a composite (two-column) primary key, for exercising
+// the skip scan optimization.
+class TestCFileSetCompositeKey : public KuduRowSetTest {
+ public:
+  TestCFileSetCompositeKey() :
+    KuduRowSetTest(Schema({ ColumnSchema("c0", INT32),
+                            ColumnSchema("c1", INT32),
+                            ColumnSchema("c2", INT32) }, 2))
+  {}
+
+  // Write out a rowset with 'nprefixes' distinct values of 'c0', each
+  // containing 'rows_per_prefix' consecutive values of 'c1'. 'c2' is the
+  // overall row index.
+  void WriteTestRowSet(int nprefixes, int rows_per_prefix) {
+    DiskRowSetWriter rsw(rowset_meta_.get(), &schema_,
+                         BloomFilterSizing::BySizeAndFPRate(32*1024, 0.01f));
+    ASSERT_OK(rsw.Open());
+
+    RowBuilder rb(schema_);
+    int idx = 0;
+    for (int p = 0; p < nprefixes; p++) {
+      for (int i = 0; i < rows_per_prefix; i++) {
+        rb.Reset();
+        rb.AddInt32(p);
+        rb.AddInt32(i);
+        rb.AddInt32(idx++);
+        ASSERT_OK_FAST(WriteRow(rb.data(), &rsw));
+      }
+    }
+    ASSERT_OK(rsw.Finish());
+  }
+
+ protected:
+  google::FlagSaver saver;
+};
+
+// Scan with an equality predicate on the second key column and ensure that
+// skip scan returns exactly the matching rows while reading only a small
+// fraction of the rowset.
+TEST_F(TestCFileSetCompositeKey, TestSkipScan) {
+  FLAGS_enable_skip_scan = true;
+  const int kNumPrefixes = 100;
+  const int kRowsPerPrefix = 1000;
+  WriteTestRowSet(kNumPrefixes, kRowsPerPrefix);
+
+  shared_ptr<CFileSet> fileset;
+  ASSERT_OK(CFileSet::Open(rowset_meta_, MemTracker::GetRootTracker(), &fileset));
+
+  shared_ptr<CFileSet::Iterator> cfile_iter(fileset->NewIterator(&schema_));
+  gscoped_ptr<RowwiseIterator> iter(new MaterializingIterator(cfile_iter));
+
+  // Create a scan with an equality predicate on the second key column only.
+  ScanSpec spec;
+  int32_t match = 500;
+  spec.AddPredicate(ColumnPredicate::Equality(schema_.column(1), &match));
+  ASSERT_OK(iter->Init(&spec));
+
+  // Ensure that we got exactly the matching row from each prefix.
+  vector<string> results;
+  ASSERT_OK(IterateToStringList(iter.get(), &results));
+  ASSERT_EQ(kNumPrefixes, results.size());
+  for (int p = 0; p < kNumPrefixes; p++) {
+    EXPECT_EQ(StringPrintf("(int32 c0=%d, int32 c1=%d, int32 c2=%d)",
+                           p, match, p * kRowsPerPrefix + match),
+              results[p]);
+  }
+
+  // The scan should have skipped the bulk of every prefix, so it should have
+  // read far fewer cells than a full scan would have.
+  vector<IteratorStats> stats;
+  iter->GetIteratorStats(&stats);
+  for (int i = 0; i < 3; i++) {
+    EXPECT_LT(stats[i].cells_read_from_disk, kNumPrefixes * kRowsPerPrefix / 2);
+  }
+}
+
 } // namespace tablet
 } // namespace kudu
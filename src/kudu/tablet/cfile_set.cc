@@ -16,6 +16,7 @@
 // under the License.
 
 #include <algorithm>
+#include <cstring>
 #include <memory>
 #include <ostream>
 #include <string>
@@ -25,24 +26,32 @@
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
+#include "kudu/cfile/block_cache.h"
 #include "kudu/cfile/bloomfile.h"
 #include "kudu/cfile/cfile_reader.h"
 #include "kudu/cfile/cfile_util.h"
 #include "kudu/common/column_materialization_context.h"
+#include "kudu/common/column_predicate.h"
 #include "kudu/common/columnblock.h"
 #include "kudu/common/encoded_key.h"
 #include "kudu/common/iterator_stats.h"
+#include "kudu/common/key_encoder.h"
+#include "kudu/common/key_util.h"
+#include "kudu/common/row.h"
 #include "kudu/common/rowblock.h"
 #include "kudu/common/rowid.h"
 #include "kudu/common/scan_spec.h"
 #include "kudu/common/schema.h"
+#include "kudu/common/types.h"
 #include "kudu/fs/block_id.h"
 #include "kudu/fs/block_manager.h"
 #include "kudu/fs/fs_manager.h"
 #include "kudu/gutil/dynamic_annotations.h"
+#include "kudu/gutil/endian.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/stringprintf.h"
+#include "kudu/gutil/strings/numbers.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/tablet/cfile_set.h"
 #include "kudu/tablet/diskrowset.h"
@@ -50,12 +59,25 @@
 #include "kudu/tablet/rowset_metadata.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/logging.h"
+#include "kudu/util/memory/arena.h"
 #include "kudu/util/slice.h"
 #include "kudu/util/status.h"
 
 DEFINE_bool(consult_bloom_filters, true, "Whether to consult bloom filters on row presence checks");
 TAG_FLAG(consult_bloom_filters, hidden);
 
+DEFINE_bool(consult_value_indexes, true,
+            "Whether to consult per-rowset value indexes when evaluating equality "
+            "predicates on indexed non-key columns");
+TAG_FLAG(consult_value_indexes, hidden);
+
+DEFINE_bool(enable_skip_scan, false,
+            "Whether to enable the skip scan optimization, which uses the composite key "
+            "index to skip over runs of rows which cannot match an equality predicate "
+            "on a non-leading primary key column.");
+TAG_FLAG(enable_skip_scan, advanced);
+TAG_FLAG(enable_skip_scan, experimental);
+
 namespace kudu {
 
 class MemTracker;
@@ -82,12 +104,14 @@ using strings::Substitute;
 static Status OpenReader(FsManager* fs,
                          shared_ptr<MemTracker> parent_mem_tracker,
                          const BlockId& block_id,
+                         int cache_partition,
                          unique_ptr<CFileReader>* new_reader) {
   unique_ptr<ReadableBlock> block;
   RETURN_NOT_OK(fs->OpenBlock(block_id, &block));
 
   ReaderOptions opts;
   opts.parent_mem_tracker = std::move(parent_mem_tracker);
+  opts.block_cache_partition = cache_partition;
   return CFileReader::OpenNoInit(std::move(block),
                                  std::move(opts),
                                  new_reader);
@@ -118,6 +142,12 @@ Status CFileSet::Open(shared_ptr<RowSetMetadata> rowset_metadata,
 }
 
 Status CFileSet::DoOpen() {
+  // Blocks of all the cfiles in this rowset are charged to the cache
+  // partition of the table the rowset belongs to (if one is configured;
+  // see --block_cache_table_shares).
+  const int cache_partition = cfile::BlockCache::GetSingleton()->GetPartitionForTable(
+      rowset_metadata_->tablet_metadata()->table_id());
+
   RETURN_NOT_OK(OpenBloomReader());
 
   // Lazily open the column data cfiles. Each one will be fully opened
@@ -131,6 +161,7 @@ Status CFileSet::DoOpen() {
     RETURN_NOT_OK(OpenReader(rowset_metadata_->fs_manager(),
                              parent_mem_tracker_,
                              rowset_metadata_->column_data_block_for_col_id(col_id),
+                             cache_partition,
                              &reader));
     readers_by_col_id_[col_id] = std::move(reader);
     VLOG(1) << "Successfully opened cfile for column id " << col_id
@@ -138,10 +169,25 @@ Status CFileSet::DoOpen() {
   }
   readers_by_col_id_.shrink_to_fit();
 
+  // Ditto for any value index cfiles.
+  RowSetMetadata::ColumnIdToBlockIdMap value_index_map =
+      rowset_metadata_->GetValueIndexBlocksById();
+  for (const RowSetMetadata::ColumnIdToBlockIdMap::value_type& e : value_index_map) {
+    unique_ptr<CFileReader> reader;
+    RETURN_NOT_OK(OpenReader(rowset_metadata_->fs_manager(),
+                             parent_mem_tracker_,
+                             e.second,
+                             cache_partition,
+                             &reader));
+    value_index_readers_by_col_id_[e.first] = std::move(reader);
+  }
+  value_index_readers_by_col_id_.shrink_to_fit();
+
   if (rowset_metadata_->has_adhoc_index_block()) {
     RETURN_NOT_OK(OpenReader(rowset_metadata_->fs_manager(),
                              parent_mem_tracker_,
                              rowset_metadata_->adhoc_index_block(),
+                             cache_partition,
                              &ad_hoc_idx_reader_));
   }
 
@@ -162,6 +208,8 @@ Status CFileSet::OpenBloomReader() {
 
   ReaderOptions opts;
   opts.parent_mem_tracker = parent_mem_tracker_;
+  opts.block_cache_partition = cfile::BlockCache::GetSingleton()->GetPartitionForTable(
+      rowset_metadata_->tablet_metadata()->table_id());
   Status s = BloomFileReader::OpenNoInit(std::move(block),
                                          std::move(opts),
                                          &bloom_reader_);
@@ -208,6 +256,193 @@ Status CFileSet::NewColumnIterator(ColumnId col_id, CFileReader::CacheControl ca
   return FindOrDie(readers_by_col_id_, col_id)->NewIterator(iter, cache_blocks);
 }
 
+bool CFileSet::MayMatchColumnPredicate(ColumnId col_id,
+                                       const ColumnPredicate& pred) const {
+  const auto it = readers_by_col_id_.find(col_id);
+  if (it == readers_by_col_id_.end()) {
+    return true;
+  }
+  CFileReader* reader = it->second.get();
+
+  // Fully open the reader if it hasn't been opened yet. This does no extra
+  // IO in the common case: a predicate implies the column is about to be
+  // scanned anyway.
+  if (!reader->Init().ok()) {
+    // Let the scan itself surface the error.
+    return true;
+  }
+
+  string null_count_str;
+  if (!reader->GetMetadataEntry(DiskRowSet::kColumnNullCountMetaEntryName,
+                                &null_count_str)) {
+    // The cfile was written before column statistics were recorded.
+    return true;
+  }
+  uint64 null_count;
+  if (!safe_strtou64(null_count_str.c_str(), &null_count)) {
+    return true;
+  }
+
+  string min_str, max_str;
+  bool has_values =
+      reader->GetMetadataEntry(DiskRowSet::kColumnMinValueMetaEntryName, &min_str) &&
+      reader->GetMetadataEntry(DiskRowSet::kColumnMaxValueMetaEntryName, &max_str);
+
+  const TypeInfo* type_info = pred.column().type_info();
+  if (type_info->type() != reader->type_info()->type()) {
+    return true;
+  }
+
+  switch (pred.predicate_type()) {
+    case PredicateType::None:
+      return false;
+    case PredicateType::IsNull:
+      return null_count > 0;
+    case PredicateType::IsNotNull:
+      return has_values;
+    case PredicateType::Equality:
+    case PredicateType::Range:
+    case PredicateType::InList:
+      break;
+    default:
+      return true;
+  }
+
+  if (!has_values) {
+    // Every cell is NULL, which no equality/range/in-list predicate matches.
+    return false;
+  }
+
+  // Reconstruct cell pointers for the stored min and max values. Binary
+  // columns store the value bytes themselves; fixed-size columns store the
+  // raw cell representation.
+  Slice min_slice(min_str);
+  Slice max_slice(max_str);
+  const void* min_cell;
+  const void* max_cell;
+  if (type_info->physical_type() == BINARY) {
+    min_cell = &min_slice;
+    max_cell = &max_slice;
+  } else {
+    if (min_str.size() != type_info->size() || max_str.size() != type_info->size()) {
+      return true;
+    }
+    min_cell = min_str.data();
+    max_cell = max_str.data();
+  }
+
+  switch (pred.predicate_type()) {
+    case PredicateType::Equality:
+      return type_info->Compare(pred.raw_lower(), min_cell) >= 0 &&
+             type_info->Compare(pred.raw_lower(), max_cell) <= 0;
+    case PredicateType::Range:
+      // The lower bound is inclusive and the upper bound exclusive.
+      if (pred.raw_lower() != nullptr &&
+          type_info->Compare(max_cell, pred.raw_lower()) < 0) {
+        return false;
+      }
+      if (pred.raw_upper() != nullptr &&
+          type_info->Compare(min_cell, pred.raw_upper()) >= 0) {
+        return false;
+      }
+      return true;
+    case PredicateType::InList:
+      for (const void* value : pred.raw_values()) {
+        if (type_info->Compare(value, min_cell) >= 0 &&
+            type_info->Compare(value, max_cell) <= 0) {
+          return true;
+        }
+      }
+      return false;
+    default:
+      LOG(DFATAL) << "Unreachable predicate type";
+      return true;
+  }
+}
+
+vector<ColumnId> CFileSet::value_index_col_ids() const {
+  vector<ColumnId> ret;
+  ret.reserve(value_index_readers_by_col_id_.size());
+  for (const auto& e : value_index_readers_by_col_id_) {
+    ret.emplace_back(e.first);
+  }
+  return ret;
+}
+
+// Number of value index entries read per batch while collecting the rows
+// matching a predicate's value.
+static const size_t kValueIndexScanBatchSize = 64;
+
+Status CFileSet::EvaluateValueIndex(ColumnId col_id, const void* value,
+                                    vector<rowid_t>* matching_rows) const {
+  const auto it = value_index_readers_by_col_id_.find(col_id);
+  if (it == value_index_readers_by_col_id_.end()) {
+    return Status::NotFound(Substitute("no value index for column id $0", col_id));
+  }
+  CFileReader* reader = it->second.get();
+
+  // Fully open the reader if it hasn't been opened yet.
+  RETURN_NOT_OK(reader->Init());
+
+  const TypeInfo* type_info = tablet_schema().column_by_id(col_id).type_info();
+
+  // Build the smallest possible entry for 'value': its prefix-free encoding
+  // followed by ordinal zero. Every entry for the value seeks at or after it,
+  // and every entry for any other value differs within the encoding.
+  faststring enc;
+  GetKeyEncoder<faststring>(type_info).Encode(value, /*is_last=*/false, &enc);
+  const size_t prefix_len = enc.size();
+  const uint8_t kZeroOrdinal[sizeof(uint32_t)] = { 0, 0, 0, 0 };
+  enc.append(kZeroOrdinal, sizeof(kZeroOrdinal));
+
+  // The entries are the cfile's sole "key column", so the seek takes an
+  // EncodedKey whose raw key points at a Slice of the entry bytes.
+  Slice seek_entry(enc.data(), enc.size());
+  faststring enc_copy;
+  enc_copy.assign_copy(enc.data(), enc.size());
+  vector<const void*> raw_entries = { &seek_entry };
+  EncodedKey seek_key(&enc_copy, &raw_entries, 1);
+
+  CFileIterator* raw_iter;
+  RETURN_NOT_OK(reader->NewIterator(&raw_iter, CFileReader::CACHE_BLOCK));
+  unique_ptr<CFileIterator> iter(raw_iter);
+
+  bool exact;
+  Status s = iter->SeekAtOrAfter(seek_key, &exact);
+  if (s.IsNotFound() || s.IsNotSupported()) {
+    // Every entry precedes the value, or the index has no entries at all
+    // (an index built from all-NULL cells has no seekable structure).
+    return Status::OK();
+  }
+  RETURN_NOT_OK(s);
+
+  // Collect the run of entries carrying the value's encoding as a prefix.
+  Arena arena(1024);
+  bool done = false;
+  while (!done && iter->HasNext()) {
+    size_t n = kValueIndexScanBatchSize;
+    RETURN_NOT_OK(iter->PrepareBatch(&n));
+    vector<Slice> entries(n);
+    arena.Reset();
+    ColumnBlock block(GetTypeInfo(BINARY), nullptr, entries.data(), n, &arena);
+    SelectionVector sel(n);
+    sel.SetAllTrue();
+    ColumnMaterializationContext ctx(0, nullptr, &block, &sel);
+    RETURN_NOT_OK(iter->Scan(&ctx));
+    RETURN_NOT_OK(iter->FinishBatch());
+    for (size_t i = 0; i < n; i++) {
+      const Slice& entry = entries[i];
+      if (entry.size() != prefix_len + sizeof(uint32_t) ||
+          memcmp(entry.data(), enc.data(), prefix_len) != 0) {
+        done = true;
+        break;
+      }
+      matching_rows->push_back(BigEndian::Load32(entry.data() + prefix_len));
+    }
+  }
+  return Status::OK();
+}
+
 CFileSet::Iterator *CFileSet::NewIterator(const Schema *projection) const {
   return new CFileSet::Iterator(shared_from_this(), projection);
 }
@@ -288,6 +523,34 @@ Status CFileSet::FindRow(const RowSetKeyProbe &probe,
   return Status::OK();
 }
 
+Status CFileSet::CheckKeyMaybePresent(const BloomKeyProbe& probe, bool* maybe_present,
+                                      ProbeStats* stats) const {
+  *maybe_present = true;
+  if (!FLAGS_consult_bloom_filters) {
+    return Status::OK();
+  }
+
+  // Fully open the BloomFileReader if it was lazily opened earlier.
+  //
+  // If it's already initialized, this is a no-op.
+  RETURN_NOT_OK(bloom_reader_->Init());
+
+  stats->blooms_consulted++;
+  Status s = bloom_reader_->CheckKeyPresent(probe, maybe_present);
+  if (!s.ok()) {
+    KLOG_EVERY_N_SECS(WARNING, 1) << Substitute("Unable to query bloom in $0: $1",
+        rowset_metadata_->bloom_block().ToString(), s.ToString());
+    if (PREDICT_FALSE(s.IsDiskFailure())) {
+      // If the bloom lookup failed because of a disk failure, return early
+      // since I/O to the tablet should be stopped.
+      return s;
+    }
+    // Treat the key as maybe-present; the iterator seek will resolve it.
+    *maybe_present = true;
+  }
+  return Status::OK();
+}
+
 Status CFileSet::CheckRowPresent(const RowSetKeyProbe &probe, bool *present,
                                  rowid_t *rowid, ProbeStats* stats) const {
   boost::optional<rowid_t> opt_rowid;
@@ -363,11 +626,21 @@ Status CFileSet::Iterator::Init(ScanSpec *spec) {
   // ordinal range.
   RETURN_NOT_OK(PushdownRangeScanPredicate(spec));
 
+  if (spec != nullptr) {
+    RETURN_NOT_OK(TryEnableSkipScan(*spec));
+    RETURN_NOT_OK(TryPushdownValueIndexPredicate(*spec));
+  }
+
   initted_ = true;
 
   // Don't actually seek -- we'll seek when we first actually read the
   // data.
   cur_idx_ = lower_bound_idx_;
+  if (skip_scan_enabled_ && cur_idx_ < upper_bound_idx_) {
+    // Position the iterator at the first run of rows which may match the
+    // skip scan predicate.
+    RETURN_NOT_OK(SkipToNextRun());
+  }
   Unprepare(); // Reset state.
   return Status::OK();
 }
@@ -432,6 +705,268 @@ Status CFileSet::Iterator::PushdownRangeScanPredicate(ScanSpec *spec) {
   return Status::OK();
 }
 
+// A skip scan seek reads and decodes key index blocks, which costs roughly as
+// much as sequentially scanning this many rows. If the scan's seeks aren't
+// skipping at least this many rows each on average, skip scanning is a net
+// loss and is abandoned for the remainder of the scan.
+static const int kSkipScanSeekCostInRows = 128;
+
+// The number of seeks to perform before applying the above cost check, so that
+// a scan isn't penalized for a few dense key prefixes at its start.
+static const int kSkipScanMinSeeksBeforeCostCheck = 16;
+
+Status CFileSet::Iterator::TryEnableSkipScan(const ScanSpec& spec) {
+  if (!FLAGS_enable_skip_scan) return Status::OK();
+
+  const Schema& tablet_schema = base_data_->tablet_schema();
+  int num_key_cols = tablet_schema.num_key_columns();
+  if (num_key_cols < 2) return Status::OK();
+
+  // Find the first key column carrying a predicate. Skip scan applies when it
+  // is an equality predicate on a non-leading key column: the scan can then
+  // seek once per distinct combination of the preceding "prefix" columns
+  // instead of reading every row. Predicates on the leading column have
+  // already been converted into ordinal bounds by the key pushdown above.
+  int pred_col_idx = -1;
+  const ColumnPredicate* pred = nullptr;
+  for (int i = 0; i < num_key_cols; i++) {
+    pred = FindOrNull(spec.predicates(), tablet_schema.column(i).name());
+    if (pred != nullptr) {
+      pred_col_idx = i;
+      break;
+    }
+  }
+  if (pred_col_idx < 1 || pred->predicate_type() != PredicateType::Equality) {
+    return Status::OK();
+  }
+
+  skip_scan_key_schema_ = tablet_schema.CreateKeyProjection();
+  skip_scan_pred_col_idx_ = pred_col_idx;
+  skip_scan_arena_.reset(new Arena(1024));
+
+  // Deep-copy the predicate's value: the predicates in the scan spec may be
+  // removed by an enclosing iterator once it takes over their evaluation.
+  const ColumnSchema& pred_col = skip_scan_key_schema_.column(pred_col_idx);
+  size_t cell_size = pred_col.type_info()->size();
+  skip_scan_pred_value_.assign_copy(
+      reinterpret_cast<const uint8_t*>(pred->raw_lower()), cell_size);
+  if (pred_col.type_info()->physical_type() == BINARY) {
+    Slice data = *reinterpret_cast<const Slice*>(pred->raw_lower());
+    skip_scan_pred_value_.append(data.data(), data.size());
+    *reinterpret_cast<Slice*>(skip_scan_pred_value_.data()) =
+        Slice(skip_scan_pred_value_.data() + cell_size, data.size());
+  }
+
+  // Build the initial seek target from the scan's lower bound (or the
+  // rowset's minimum key): the same prefix, the predicate's value, and the
+  // minimum values for any remaining key columns. The target may precede the
+  // first row actually covered by the scan; SkipToNextRun() clamps runs to
+  // the iterator's ordinal bounds.
+  Slice start_key(base_data_->min_encoded_key_);
+  if (spec.lower_bound_key() != nullptr &&
+      spec.lower_bound_key()->encoded_key().compare(start_key) > 0) {
+    start_key = spec.lower_bound_key()->encoded_key();
+  }
+  uint8_t* row_buf = static_cast<uint8_t*>(
+      skip_scan_arena_->AllocateBytes(skip_scan_key_schema_.key_byte_size()));
+  ContiguousRow row(&skip_scan_key_schema_, row_buf);
+  RETURN_NOT_OK(skip_scan_key_schema_.DecodeRowKey(start_key, row_buf,
+                                                   skip_scan_arena_.get()));
+  memcpy(row.mutable_cell_ptr(pred_col_idx), skip_scan_pred_value_.data(), cell_size);
+  for (int i = pred_col_idx + 1; i < num_key_cols; i++) {
+    skip_scan_key_schema_.column(i).type_info()->CopyMinValue(row.mutable_cell_ptr(i));
+  }
+  skip_scan_next_target_ = EncodedKey::FromContiguousRow(ConstContiguousRow(row));
+
+  skip_scan_enabled_ = true;
+  VLOG(1) << "Enabled skip scan on " << base_data_->ToString()
+          << " for predicate " << pred->ToString();
+  return Status::OK();
+}
+
+Status CFileSet::Iterator::TryPushdownValueIndexPredicate(const ScanSpec& spec) {
+  if (!FLAGS_consult_value_indexes) return Status::OK();
+
+  const Schema& tablet_schema = base_data_->tablet_schema();
+  for (const ColumnId& col_id : value_index_safe_cols_) {
+    int col_idx = tablet_schema.find_column_by_id(col_id);
+    if (col_idx == Schema::kColumnNotFound) continue;
+    const ColumnSchema& col = tablet_schema.column(col_idx);
+    const ColumnPredicate* pred = FindOrNull(spec.predicates(), col.name());
+    if (pred == nullptr || pred->predicate_type() != PredicateType::Equality ||
+        pred->column().type_info()->type() != col.type_info()->type()) {
+      continue;
+    }
+
+    RETURN_NOT_OK(base_data_->EvaluateValueIndex(col_id, pred->raw_lower(),
+                                                 &value_index_rows_));
+    value_index_enabled_ = true;
+
+    // Narrow the ordinal bounds to the matching rows. The predicate is left
+    // in the scan spec: the enclosing iterator still evaluates it against
+    // the materialized rows, so the index only has to not lose matches.
+    if (value_index_rows_.empty()) {
+      lower_bound_idx_ = upper_bound_idx_;
+    } else {
+      lower_bound_idx_ = std::max(lower_bound_idx_, value_index_rows_.front());
+      upper_bound_idx_ = std::min(upper_bound_idx_, value_index_rows_.back() + 1);
+    }
+    VLOG(1) << "Pushed predicate " << pred->ToString() << " into value index on "
+            << base_data_->ToString() << ": " << value_index_rows_.size()
+            << " candidate row(s)";
+    break;
+  }
+  return Status::OK();
+}
+
+Status CFileSet::Iterator::ReadCurrentEncodedKey(Slice* enc_key) {
+  size_t n = 1;
+  RETURN_NOT_OK(key_iter_->PrepareBatch(&n));
+  if (PREDICT_FALSE(n != 1)) {
+    return Status::Corruption("unable to read key from the key index",
+                              base_data_->ToString());
+  }
+  Slice val;
+  ColumnBlock block(GetTypeInfo(BINARY), nullptr, &val, 1, skip_scan_arena_.get());
+  SelectionVector sel(1);
+  sel.SetAllTrue();
+  ColumnMaterializationContext ctx(0, nullptr, &block, &sel);
+  RETURN_NOT_OK(key_iter_->Scan(&ctx));
+  RETURN_NOT_OK(key_iter_->FinishBatch());
+  *enc_key = val;
+  return Status::OK();
+}
+
+Status CFileSet::Iterator::SkipToNextRun() {
+  DCHECK(skip_scan_enabled_);
+  const int pred_col_idx = skip_scan_pred_col_idx_;
+  const int num_key_cols = skip_scan_key_schema_.num_key_columns();
+  const TypeInfo* pred_type = skip_scan_key_schema_.column(pred_col_idx).type_info();
+
+  while (true) {
+    // If the seeks performed so far haven't skipped enough rows to pay for
+    // themselves (e.g. because the prefix columns turned out to have high
+    // cardinality), fall back to a sequential scan for the remainder.
+    if (skip_scan_num_seeks_ >= kSkipScanMinSeeksBeforeCostCheck &&
+        static_cast<int64_t>(cur_idx_ - lower_bound_idx_) <
+            skip_scan_num_seeks_ * kSkipScanSeekCostInRows) {
+      VLOG(1) << "Abandoning skip scan on " << base_data_->ToString()
+              << ": " << skip_scan_num_seeks_ << " seeks covered only "
+              << (cur_idx_ - lower_bound_idx_) << " rows";
+      skip_scan_enabled_ = false;
+      return Status::OK();
+    }
+
+    if (skip_scan_next_target_ == nullptr) {
+      // The key space is exhausted: no further row can match.
+      cur_idx_ = upper_bound_idx_;
+      return Status::OK();
+    }
+
+    skip_scan_arena_->Reset();
+
+    bool exact;
+    Status s = key_iter_->SeekAtOrAfter(*skip_scan_next_target_, &exact);
+    if (s.IsNotFound()) {
+      cur_idx_ = upper_bound_idx_;
+      return Status::OK();
+    }
+    RETURN_NOT_OK(s);
+    skip_scan_num_seeks_++;
+    rowid_t landing_idx = key_iter_->GetCurrentOrdinal();
+    if (landing_idx >= upper_bound_idx_) {
+      cur_idx_ = upper_bound_idx_;
+      return Status::OK();
+    }
+
+    // Decode the key of the row we landed on.
+    Slice enc_key;
+    RETURN_NOT_OK(ReadCurrentEncodedKey(&enc_key));
+    uint8_t* row_buf = static_cast<uint8_t*>(
+        skip_scan_arena_->AllocateBytes(skip_scan_key_schema_.key_byte_size()));
+    ContiguousRow row(&skip_scan_key_schema_, row_buf);
+    RETURN_NOT_OK(skip_scan_key_schema_.DecodeRowKey(enc_key, row_buf,
+                                                     skip_scan_arena_.get()));
+
+    int cmp = pred_type->Compare(row.cell_ptr(pred_col_idx),
+                                 skip_scan_pred_value_.data());
+    if (cmp != 0) {
+      // The row we landed on doesn't match the predicate; build a new target
+      // from its key. If its predicate column sorts before the value, the
+      // value may still occur within the row's own prefix; otherwise the
+      // prefix itself is exhausted and must be incremented.
+      if (cmp > 0 && !key_util::IncrementPrimaryKey(&row, pred_col_idx,
+                                                    skip_scan_arena_.get())) {
+        skip_scan_next_target_.reset();
+        continue;
+      }
+      memcpy(row.mutable_cell_ptr(pred_col_idx),
+             skip_scan_pred_value_.data(), pred_type->size());
+      for (int i = pred_col_idx + 1; i < num_key_cols; i++) {
+        skip_scan_key_schema_.column(i).type_info()->CopyMinValue(row.mutable_cell_ptr(i));
+      }
+      skip_scan_next_target_ = EncodedKey::FromContiguousRow(ConstContiguousRow(row));
+      continue;
+    }
+
+    // The landing row matches, so it starts a run of matching rows: all rows
+    // sharing its prefix and predicate value are adjacent in key order.
+    rowid_t run_start = std::max<rowid_t>(landing_idx, cur_idx_);
+
+    // The next run (if any) can only start at the next distinct prefix, with
+    // the predicate's value and minimum values for the remaining columns.
+    // Build that target from a copy of the landing row before mutating it.
+    uint8_t* next_buf = static_cast<uint8_t*>(
+        skip_scan_arena_->AllocateBytes(skip_scan_key_schema_.key_byte_size()));
+    memcpy(next_buf, row_buf, skip_scan_key_schema_.key_byte_size());
+    ContiguousRow next_row(&skip_scan_key_schema_, next_buf);
+    if (key_util::IncrementPrimaryKey(&next_row, pred_col_idx,
+                                      skip_scan_arena_.get())) {
+      memcpy(next_row.mutable_cell_ptr(pred_col_idx),
+             skip_scan_pred_value_.data(), pred_type->size());
+      for (int i = pred_col_idx + 1; i < num_key_cols; i++) {
+        skip_scan_key_schema_.column(i).type_info()->CopyMinValue(
+            next_row.mutable_cell_ptr(i));
+      }
+      skip_scan_next_target_ = EncodedKey::FromContiguousRow(ConstContiguousRow(next_row));
+    } else {
+      skip_scan_next_target_.reset();
+    }
+
+    // Find the exclusive end of the run: the first row whose key is greater
+    // than (prefix, value) for any suffix.
+    rowid_t run_end;
+    if (!key_util::IncrementPrimaryKey(&row, pred_col_idx + 1,
+                                       skip_scan_arena_.get())) {
+      // (prefix, value) is the maximum possible: the run extends to the end.
+      run_end = upper_bound_idx_;
+    } else {
+      for (int i = pred_col_idx + 1; i < num_key_cols; i++) {
+        skip_scan_key_schema_.column(i).type_info()->CopyMinValue(row.mutable_cell_ptr(i));
+      }
+      gscoped_ptr<EncodedKey> end_target(
+          EncodedKey::FromContiguousRow(ConstContiguousRow(row)));
+      s = key_iter_->SeekAtOrAfter(*end_target, &exact);
+      if (s.IsNotFound()) {
+        run_end = upper_bound_idx_;
+      } else {
+        RETURN_NOT_OK(s);
+        run_end = std::min<rowid_t>(key_iter_->GetCurrentOrdinal(), upper_bound_idx_);
+      }
+      skip_scan_num_seeks_++;
+    }
+
+    if (run_end <= run_start) {
+      // The run falls entirely outside the iterator's bounds.
+      continue;
+    }
+
+    cur_idx_ = run_start;
+    skip_scan_run_end_idx_ = run_end;
+    return Status::OK();
+  }
+}
+
 void CFileSet::Iterator::Unprepare() {
   prepared_count_ = 0;
   cols_prepared_.assign(col_iters_.size(), false);
@@ -444,6 +979,16 @@ Status CFileSet::Iterator::PrepareBatch(size_t *n) {
   if (*n > remaining) {
     *n = remaining;
   }
+  if (skip_scan_enabled_) {
+    // Don't prepare past the end of the current run of rows matching the
+    // skip scan predicate; the rows beyond it are skipped over in
+    // FinishBatch().
+    DCHECK_LT(cur_idx_, skip_scan_run_end_idx_);
+    size_t run_remaining = skip_scan_run_end_idx_ - cur_idx_;
+    if (*n > run_remaining) {
+      *n = run_remaining;
+    }
+  }
 
   prepared_count_ = *n;
 
@@ -489,7 +1034,23 @@ Status CFileSet::Iterator::PrepareColumn(ColumnMaterializationContext *ctx) {
 }
 
 Status CFileSet::Iterator::InitializeSelectionVector(SelectionVector *sel_vec) {
-  sel_vec->SetAllTrue();
+  if (!value_index_enabled_) {
+    sel_vec->SetAllTrue();
+    return Status::OK();
+  }
+
+  // Select only the rows of this batch which the value index matched.
+  sel_vec->SetAllFalse();
+  while (value_index_pos_ < value_index_rows_.size() &&
+         value_index_rows_[value_index_pos_] < cur_idx_) {
+    value_index_pos_++;
+  }
+  for (size_t p = value_index_pos_;
+       p < value_index_rows_.size() &&
+           value_index_rows_[p] < cur_idx_ + prepared_count_;
+       p++) {
+    sel_vec->SetRowSelected(value_index_rows_[p] - cur_idx_);
+  }
   return Status::OK();
 }
 
@@ -519,6 +1080,12 @@ Status CFileSet::Iterator::FinishBatch() {
   }
 
   cur_idx_ += prepared_count_;
+  if (skip_scan_enabled_ && cur_idx_ >= skip_scan_run_end_idx_ &&
+      cur_idx_ < upper_bound_idx_) {
+    // The current run of rows matching the skip scan predicate is finished;
+    // seek ahead to the next one.
+    RETURN_NOT_OK(SkipToNextRun());
+  }
   Unprepare();
 
   return Status::OK();
@@ -38,6 +38,7 @@
 #include "kudu/gutil/map-util.h"
 #include "kudu/gutil/port.h"
 #include "kudu/tablet/rowset_metadata.h"
+#include "kudu/util/faststring.h"
 #include "kudu/util/status.h"
 
 namespace boost {
@@ -47,7 +48,11 @@ class optional;
 
 namespace kudu {
 
+class Arena;
+class BloomKeyProbe;
 class ColumnMaterializationContext;
+class ColumnPredicate;
+class EncodedKey;
 class MemTracker;
 class ScanSpec;
 class SelectionVector;
@@ -111,11 +116,44 @@ class CFileSet : public std::enable_shared_from_this<CFileSet> {
   Status CheckRowPresent(const RowSetKeyProbe &probe, bool *present,
                          rowid_t *rowid, ProbeStats* stats) const;
 
+  // Check if the given key may be present, consulting only the bloom filter.
+  // A false result is definitive; a true result may be a bloom false
+  // positive (or mean that the bloom could not be consulted).
+  Status CheckKeyMaybePresent(const BloomKeyProbe& probe, bool* maybe_present,
+                              ProbeStats* stats) const;
+
   // Return true if there exists a CFile for the given column ID.
   bool has_data_for_column_id(ColumnId col_id) const {
     return ContainsKey(readers_by_col_id_, col_id);
   }
 
+  // Return the IDs of the columns which have a value index in this CFileSet.
+  std::vector<ColumnId> value_index_col_ids() const;
+
+  // Look up the rows whose base data in column 'col_id' equals 'value' (a
+  // raw cell pointer of the column's type) using the column's value index,
+  // appending their ordinals to 'matching_rows' in increasing order.
+  //
+  // The result reflects only the base data: callers must separately rule
+  // out deltas which could change the column's values (see
+  // DeltaTracker::MayHaveUpdatesForColumn()).
+  //
+  // Returns NotFound if the column has no value index.
+  Status EvaluateValueIndex(ColumnId col_id, const void* value,
+                            std::vector<rowid_t>* matching_rows) const;
+
+  // Consult the min/max statistics stored in the column's cfile footer to
+  // determine whether any row in the base data might match 'pred'. A false
+  // result is definitive; a true result is returned conservatively whenever
+  // the check can't be made (no cfile for the column, a cfile written before
+  // statistics were recorded, or a predicate type which can't be tested
+  // against a value range).
+  //
+  // Note that this only consults the base data: callers must separately
+  // rule out deltas which could change the column's values (see
+  // DeltaTracker::MayHaveUpdatesForColumn()).
+  bool MayMatchColumnPredicate(ColumnId col_id, const ColumnPredicate& pred) const;
+
   virtual ~CFileSet();
 
  private:
@@ -155,6 +193,10 @@ class CFileSet : public std::enable_shared_from_this<CFileSet> {
   typedef boost::container::flat_map<int, std::unique_ptr<cfile::CFileReader>> ReaderMap;
   ReaderMap readers_by_col_id_;
 
+  // Map of column ID to value index reader, for the columns which have one.
+  // Like the column readers, these are lazily initialized.
+  ReaderMap value_index_readers_by_col_id_;
+
   // A file reader for an ad-hoc index, i.e. an index that sits in its own file
   // and is not embedded with the column's data blocks. This is used when the
   // index pertains to more than one column, as in the case of composite keys.
@@ -180,6 +222,12 @@ class CFileSet::Iterator : public ColumnwiseIterator {
 
   Status MaterializeColumn(ColumnMaterializationContext *ctx) override;
 
+  // Each projected column is backed by its own cfile iterator, so distinct
+  // columns of a prepared batch may be materialized concurrently.
+  virtual bool SupportsConcurrentColumnMaterialization() const OVERRIDE {
+    return true;
+  }
+
   virtual Status FinishBatch() OVERRIDE;
 
   virtual bool HasNext() const OVERRIDE {
@@ -201,6 +249,14 @@ class CFileSet::Iterator : public ColumnwiseIterator {
     return cur_idx_;
   }
 
+  // Mark the given column as safe for value index use: the caller asserts
+  // that no delta could change the column's values for any row or snapshot
+  // this iterator may expose. Must be called before Init().
+  void AddValueIndexSafeColumn(ColumnId col_id) {
+    DCHECK(!initted_);
+    value_index_safe_cols_.push_back(col_id);
+  }
+
   // Collect the IO statistics for each of the underlying columns.
   virtual void GetIteratorStats(std::vector<IteratorStats> *stats) const OVERRIDE;
 
@@ -216,7 +272,13 @@ class CFileSet::Iterator : public ColumnwiseIterator {
         projection_(projection),
         initted_(false),
         cur_idx_(0),
-        prepared_count_(0) {
+        prepared_count_(0),
+        skip_scan_enabled_(false),
+        skip_scan_pred_col_idx_(-1),
+        skip_scan_run_end_idx_(0),
+        skip_scan_num_seeks_(0),
+        value_index_enabled_(false),
+        value_index_pos_(0) {
     CHECK_OK(base_data_->CountRows(&row_count_));
   }
 
@@ -228,6 +290,31 @@ class CFileSet::Iterator : public ColumnwiseIterator {
   // store it in member fields.
   Status PushdownRangeScanPredicate(ScanSpec *spec);
 
+  // Look for an equality predicate on a column marked safe for value index
+  // use, and evaluate it against the column's value index if one exists.
+  // On success the matching row ordinals bound the scan and drive the
+  // selection vector; the predicate is left in the scan spec.
+  Status TryPushdownValueIndexPredicate(const ScanSpec& spec);
+
+  // Check whether this scan can use the skip scan optimization to evaluate an
+  // equality predicate on a non-leading key column, and set up the skip scan
+  // state if so. The predicate is left in the scan spec; skip scan only narrows
+  // the ranges of rows which are scanned.
+  Status TryEnableSkipScan(const ScanSpec& spec);
+
+  // Read the encoded primary key of the row at the key iterator's current
+  // seek position into '*enc_key'. The returned data is backed by
+  // 'skip_scan_arena_'.
+  Status ReadCurrentEncodedKey(Slice* enc_key);
+
+  // Seek forward to the next contiguous run of rows which match the skip scan
+  // predicate, setting 'cur_idx_' to the start of the run and
+  // 'skip_scan_run_end_idx_' to its (exclusive) end. If no further rows can
+  // match, sets 'cur_idx_' to 'upper_bound_idx_'. May also abandon skip
+  // scanning entirely if it isn't skipping enough rows to pay for its index
+  // seeks.
+  Status SkipToNextRun();
+
   void Unprepare();
 
   // Prepare the given column if not already prepared.
@@ -258,8 +345,59 @@ class CFileSet::Iterator : public ColumnwiseIterator {
 
   // The underlying columns are prepared lazily, so that if a column is never
   // materialized, it doesn't need to be read off disk.
-  std::vector<bool> cols_prepared_;
-
+  //
+  // This is a vector of bytes rather than bools so that concurrent
+  // materialization of distinct columns doesn't race on the packed bits of
+  // a vector<bool>.
+  std::vector<uint8_t> cols_prepared_;
+
+  // True if this scan is using the skip scan optimization. May be reset to
+  // false mid-scan if skipping turns out not to be effective, in which case
+  // the rest of the scan proceeds sequentially.
+  bool skip_scan_enabled_;
+
+  // Key projection of the tablet schema, used to decode and build keys while
+  // skip scanning.
+  Schema skip_scan_key_schema_;
+
+  // Index of the key column carrying the equality predicate. The key columns
+  // preceding it form the prefix which the skip scan enumerates.
+  int skip_scan_pred_col_idx_;
+
+  // Copy of the predicate's value cell (and, for binary-typed columns, the
+  // data it points to). The predicate itself may be removed from the scan
+  // spec by an enclosing iterator, so we cannot hold a pointer into it.
+  faststring skip_scan_pred_value_;
+
+  // The seek target for the next run of matching rows, or null if no further
+  // run can exist. Always greater than every key at or below the current
+  // position, which guarantees forward progress.
+  gscoped_ptr<EncodedKey> skip_scan_next_target_;
+
+  // Exclusive upper bound (in ordinal indexes) of the current run of rows
+  // matching the skip scan predicate. Batches are clamped to this bound.
+  rowid_t skip_scan_run_end_idx_;
+
+  // Arena backing the temporary keys built while skip scanning.
+  gscoped_ptr<Arena> skip_scan_arena_;
+
+  // The number of key index seeks performed by the skip scan, used to detect
+  // the case where skipping isn't paying for itself.
+  int64_t skip_scan_num_seeks_;
+
+  // True if this scan is filtering its selection vectors through a list of
+  // rows obtained from a value index.
+  bool value_index_enabled_;
+
+  // Columns for which the creator of this iterator has ruled out deltas
+  // which could change the column's values. See AddValueIndexSafeColumn().
+  std::vector<ColumnId> value_index_safe_cols_;
+
+  // Ordinals of the rows matching the pushed-down equality predicate, in
+  // increasing order, and the position of the first ordinal which has not
+  // yet been passed by the scan.
+  std::vector<rowid_t> value_index_rows_;
+  size_t value_index_pos_;
 };
 
 } // namespace tablet
@@ -1037,6 +1037,45 @@ TEST_F(TestCompaction, TestMergeMRS) {
                 "Redo Mutations: [];", out[19]);
 }
 
+// Test MergeCompactionInput with inputs whose key ranges are entirely
+// disjoint. This exercises the block-wise fast path which kicks in when the
+// dominance checks leave only a single live input in the merge.
+TEST_F(TestCompaction, TestMergeMRSNonOverlapping) {
+  // 'mrs_a' has keys 100, 110, ... 190: strictly greater than everything
+  // in 'mrs_b' (keys 0, 10, ... 90). Insert the higher range first so the
+  // merge has to emit rows from the input added last.
+  shared_ptr<MemRowSet> mrs_a;
+  ASSERT_OK(MemRowSet::Create(0, schema_, log_anchor_registry_.get(),
+                              mem_trackers_.tablet_tracker, &mrs_a));
+  InsertRows(mrs_a.get(), 10, 100);
+
+  shared_ptr<MemRowSet> mrs_b;
+  ASSERT_OK(MemRowSet::Create(1, schema_, log_anchor_registry_.get(),
+                              mem_trackers_.tablet_tracker, &mrs_b));
+  InsertRows(mrs_b.get(), 10, 0);
+
+  MvccSnapshot snap(mvcc_);
+  vector<shared_ptr<CompactionInput> > merge_inputs;
+  merge_inputs.push_back(
+        shared_ptr<CompactionInput>(CompactionInput::Create(*mrs_a, &schema_, snap)));
+  merge_inputs.push_back(
+        shared_ptr<CompactionInput>(CompactionInput::Create(*mrs_b, &schema_, snap)));
+  gscoped_ptr<CompactionInput> input(CompactionInput::Merge(merge_inputs, &schema_));
+
+  vector<string> out;
+  IterateInput(input.get(), &out);
+  ASSERT_EQ(out.size(), 20);
+  EXPECT_EQ(R"(RowIdxInBlock: 0; Base: (string key="hello 00000000", int32 val=0, )"
+                "int32 nullable_val=0); Undo Mutations: [@11(DELETE)]; "
+                "Redo Mutations: [];", out[0]);
+  EXPECT_EQ(R"(RowIdxInBlock: 0; Base: (string key="hello 00000100", int32 val=0, )"
+                "int32 nullable_val=0); Undo Mutations: [@1(DELETE)]; "
+                "Redo Mutations: [];", out[10]);
+  EXPECT_EQ(R"(RowIdxInBlock: 9; Base: (string key="hello 00000190", int32 val=9, )"
+                "int32 nullable_val=NULL); Undo Mutations: [@10(DELETE)]; "
+                "Redo Mutations: [];", out[19]);
+}
+
 #ifdef NDEBUG
 // Benchmark for the compaction merge input for the case where the inputs
 // contain non-overlapping data. In this case the merge can be optimized
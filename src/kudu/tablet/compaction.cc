@@ -57,6 +57,7 @@
 #include "kudu/util/debug/trace_event.h"
 #include "kudu/util/faststring.h"
 #include "kudu/util/memory/arena.h"
+#include "kudu/util/slice.h"
 
 using kudu::clock::HybridClock;
 using std::deque;
@@ -454,6 +455,23 @@ class MergeCompactionInput : public CompactionInput {
 
     block->clear();
 
+    // Fast path: if only a single input is live in the merge -- because all
+    // of the other inputs are either dominated by it or exhausted -- then its
+    // entire pending block can be taken at once without any key comparisons.
+    // When the inputs' key ranges don't overlap (e.g. flushed rowsets from a
+    // time-series style workload), the dominance tracking in
+    // ProcessEmptyInputs() whittles the merge down to this case for nearly
+    // every block, so non-overlapping runs pass through block-at-a-time
+    // rather than row-by-row.
+    if (states_.size() == 1) {
+      MergeState* state = states_[0];
+      prepared_block_arena_ = state->input->PreparedBlockArena();
+      block->assign(state->pending.begin() + state->pending_idx,
+                    state->pending.end());
+      state->pending_idx = state->pending.size();
+      return Status::OK();
+    }
+
     while (true) {
       int smallest_idx = -1;
       CompactionInputRow* smallest;
@@ -1080,6 +1098,7 @@ Status FlushCompactionInput(CompactionInput* input,
                             RollingDiskRowSetWriter* out) {
   RETURN_NOT_OK(input->Init());
   vector<CompactionInputRow> rows;
+  faststring enc_key_buf;
 
   DCHECK(out->schema().has_column_ids());
 
@@ -1091,7 +1110,6 @@ Status FlushCompactionInput(CompactionInput* input,
     int n = 0;
     for (int i = 0; i < rows.size(); i++) {
       CompactionInputRow* input_row = &rows[i];
-      RETURN_NOT_OK(out->RollIfNecessary());
 
       const Schema* schema = input_row->row.schema();
       DCHECK_SCHEMA_EQ(*schema, out->schema());
@@ -1150,6 +1168,17 @@ Status FlushCompactionInput(CompactionInput* input,
       n++;
       if (n == block.nrows()) {
         RETURN_NOT_OK(out->AppendBlock(block));
+        // Rolling the writer is only possible right after a block of rows has
+        // been appended, before any of the following rows' deltas have been
+        // written, so checking here (rather than per input row) is both
+        // sufficient and a lot cheaper: the size check walks every column
+        // writer. The next input row's key is passed down so the writer can
+        // roll right at a key-prefix boundary if so configured.
+        Slice next_enc_key;
+        if (i + 1 < rows.size()) {
+          next_enc_key = schema->EncodeComparableKey(rows[i + 1].row, &enc_key_buf);
+        }
+        RETURN_NOT_OK(out->RollIfNecessary(next_enc_key));
         n = 0;
       }
     }
@@ -1157,6 +1186,7 @@ Status FlushCompactionInput(CompactionInput* input,
     if (n > 0) {
       block.Resize(n);
       RETURN_NOT_OK(out->AppendBlock(block));
+      RETURN_NOT_OK(out->RollIfNecessary());
       block.Resize(block.row_capacity());
     }
 
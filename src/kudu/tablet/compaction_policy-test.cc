@@ -142,6 +142,53 @@ TEST_F(TestCompactionPolicy, TestSignificantOverlap) {
   ASSERT_EQ(picked.size(), kBudgetMb);
 }
 
+// Test incremental evaluation: a policy instance seeds each run with the
+// solution from the previous run, so repeated runs over the same rowsets
+// should produce the same selection, and runs after the rowsets change
+// should still produce a valid selection.
+TEST_F(TestCompactionPolicy, TestIncrementalEvaluation) {
+  RowSetVector vec;
+  for (int i = 0; i < 100;  i++) {
+    vec.emplace_back(new MockDiskRowSet(
+        StringPrintf("%010d", i * 10000),
+        StringPrintf("%010d", (i + 2) * 10000)));
+  }
+  RowSetTree tree;
+  ASSERT_OK(tree.Reset(vec));
+  const int kBudgetMb = 64;
+  BudgetedCompactionPolicy policy(kBudgetMb);
+
+  unordered_set<RowSet*> picked;
+  double quality = 0;
+  ASSERT_OK(policy.PickRowSets(tree, &picked, &quality, nullptr));
+  ASSERT_EQ(kBudgetMb, picked.size());
+
+  // A second run on the same instance starts from the previous solution and
+  // should settle on an equally good compaction.
+  unordered_set<RowSet*> picked2;
+  double quality2 = 0;
+  ASSERT_OK(policy.PickRowSets(tree, &picked2, &quality2, nullptr));
+  ASSERT_DOUBLE_EQ(quality, quality2);
+  ASSERT_EQ(picked2.size(), kBudgetMb);
+
+  // Remove the picked rowsets, as if the compaction had run. The stale seed
+  // no longer applies, and the policy should pick among the remaining ones.
+  RowSetVector remaining;
+  for (const auto& rs : vec) {
+    if (picked2.count(rs.get()) == 0) {
+      remaining.push_back(rs);
+    }
+  }
+  RowSetTree remaining_tree;
+  ASSERT_OK(remaining_tree.Reset(remaining));
+  unordered_set<RowSet*> picked3;
+  double quality3 = 0;
+  ASSERT_OK(policy.PickRowSets(remaining_tree, &picked3, &quality3, nullptr));
+  for (RowSet* rs : picked3) {
+    ASSERT_EQ(0, picked2.count(rs));
+  }
+}
+
 // Return the directory of the currently-running executable.
 static string GetExecutableDir() {
   string exec;
@@ -55,6 +55,14 @@ DEFINE_double(compaction_minimum_improvement, 0.01f,
               "improve the average height of DiskRowSets by at least this amount, the "
               "compaction will be considered ineligible.");
 
+DEFINE_bool(compaction_policy_incremental_evaluation, true,
+            "Whether the budgeted compaction policy should seed each evaluation "
+            "with the solution found by the previous one. The seed serves as a "
+            "lower bound which allows the exact solver to skip key ranges whose "
+            "rowsets haven't changed since the previous evaluation.");
+TAG_FLAG(compaction_policy_incremental_evaluation, advanced);
+TAG_FLAG(compaction_policy_incremental_evaluation, runtime);
+
 namespace kudu {
 namespace tablet {
 
@@ -363,6 +371,44 @@ void BudgetedCompactionPolicy::RunExact(
   }
 }
 
+void BudgetedCompactionPolicy::SeedWithPreviousSolution(
+    const vector<RowSetInfo>& asc_min_key,
+    SolutionAndValue* best_solution) const {
+  if (prev_solution_.empty()) return;
+
+  std::unordered_set<RowSet*> found;
+  int total_size_mb = 0;
+  double total_width = 0;
+  double union_min = 0;
+  double union_max = 0;
+  for (const RowSetInfo& rsi : asc_min_key) {
+    if (!ContainsKey(prev_solution_, rsi.rowset())) continue;
+    if (found.empty()) {
+      union_min = rsi.cdf_min_key();
+      union_max = rsi.cdf_max_key();
+    } else {
+      union_min = std::min(union_min, rsi.cdf_min_key());
+      union_max = std::max(union_max, rsi.cdf_max_key());
+    }
+    total_size_mb += rsi.size_mb();
+    total_width += rsi.width();
+    found.insert(rsi.rowset());
+  }
+
+  // The previous solution is only a valid seed if every rowset it picked is
+  // still a candidate and the solution still fits in the budget: rowsets may
+  // have been compacted away, or may have grown since we last looked.
+  if (found.size() != prev_solution_.size() ||
+      total_size_mb > static_cast<int>(size_budget_mb_)) {
+    return;
+  }
+
+  double value = total_width - (union_max - union_min) * kSupportAdjust;
+  if (value <= best_solution->value) return;
+  best_solution->rowsets = std::move(found);
+  best_solution->value = value;
+}
+
 // See docs/design-docs/compaction-policy.md for an overview of the compaction
 // policy implemented in this function.
 Status BudgetedCompactionPolicy::PickRowSets(const RowSetTree &tree,
@@ -376,12 +422,21 @@ Status BudgetedCompactionPolicy::PickRowSets(const RowSetTree &tree,
       LOG_STRING(INFO, log) << "No rowsets to compact";
     }
     // nothing to compact.
+    prev_solution_.clear();
     return Status::OK();
   }
 
   // The best set of rowsets chosen so far, and the value attained by that choice.
   SolutionAndValue best_solution;
 
+  // Incremental evaluation: seed the search with the solution picked by the
+  // previous invocation. Key ranges which haven't changed since then can't
+  // do better than the seed, so the upper-bound pruning below avoids
+  // re-solving the knapsack for them.
+  if (FLAGS_compaction_policy_incremental_evaluation) {
+    SeedWithPreviousSolution(asc_min_key, &best_solution);
+  }
+
   // The algorithm proceeds in two passes. The first is based on an approximation
   // of the knapsack problem, and computes some upper and lower bounds. The second
   // pass looks again over the input for any cases where the upper bound tells us
@@ -436,6 +491,7 @@ Status BudgetedCompactionPolicy::PickRowSets(const RowSetTree &tree,
       *std::max_element(best_upper_bounds.begin(), best_upper_bounds.end()) <=
       FLAGS_compaction_minimum_improvement) {
     VLOG(1) << "Approximation algorithm short-circuited exact compaction calculation";
+    prev_solution_ = best_solution.rowsets;
     *quality = 0;
     return Status::OK();
   }
@@ -463,6 +519,9 @@ Status BudgetedCompactionPolicy::PickRowSets(const RowSetTree &tree,
 
   *quality = best_solution.value;
 
+  // Remember the solution to seed the next invocation.
+  prev_solution_ = best_solution.rowsets;
+
   if (best_solution.value <= FLAGS_compaction_minimum_improvement) {
     VLOG(1) << "Best compaction available (" << best_solution.value << " less than "
             << "minimum quality " << FLAGS_compaction_minimum_improvement
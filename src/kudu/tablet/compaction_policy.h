@@ -124,7 +124,22 @@ class BudgetedCompactionPolicy : public CompactionPolicy {
       const std::vector<double>& best_upper_bounds,
       SolutionAndValue* best_solution);
 
+  // Seed 'best_solution' with the solution picked by the previous invocation
+  // of PickRowSets(), re-evaluated against the current candidate rowsets in
+  // 'asc_min_key'. The seed acts as a lower bound which lets RunExact() skip
+  // re-solving key ranges that haven't changed since the previous invocation.
+  //
+  // No-op if any of the previously picked rowsets is no longer a candidate,
+  // or if the previous solution no longer fits in the budget.
+  void SeedWithPreviousSolution(const std::vector<RowSetInfo>& asc_min_key,
+                                SolutionAndValue* best_solution) const;
+
   size_t size_budget_mb_;
+
+  // The rowsets picked by the previous invocation of PickRowSets(), kept to
+  // seed the next invocation. Protected by the external synchronization that
+  // PickRowSets() requires of its callers.
+  std::unordered_set<RowSet*> prev_solution_;
 };
 
 } // namespace tablet
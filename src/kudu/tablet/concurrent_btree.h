@@ -956,7 +956,10 @@ class CBTree {
   }
 
   explicit CBTree(std::shared_ptr<typename Traits::ArenaType> arena)
-      : arena_(std::move(arena)), root_(NewLeaf(false)), frozen_(false) {}
+      : arena_(std::move(arena)),
+        root_(NewLeaf(false)),
+        frozen_(false),
+        rightmost_leaf_hint_(0) {}
 
   ~CBTree() {
     RecursiveDelete(root_);
@@ -1272,6 +1275,28 @@ class CBTree {
 
   void PrepareMutation(PreparedMutation<Traits> *mutation) {
     DCHECK_EQ(mutation->tree(), this);
+
+    // Fast path for workloads which insert in increasing key order (e.g.
+    // time-series ingest): try the leaf which most recently took a rightmost
+    // insert before descending from the root.
+    LeafNode<Traits> *hinted = reinterpret_cast<LeafNode<Traits> *>(
+        base::subtle::NoBarrier_Load(&rightmost_leaf_hint_));
+    if (hinted != NULL) {
+      hinted->Lock();
+      // While the lock is held no concurrent split can restructure the node,
+      // so the structural checks below are race-free. The key belongs in this
+      // leaf iff the leaf is still the rightmost one in the tree and the key
+      // sorts after every key it holds.
+      if (PREDICT_TRUE(hinted->next_ == NULL &&
+                       hinted->num_entries() > 0 &&
+                       mutation->key().compare(
+                           hinted->GetKey(hinted->num_entries() - 1)) > 0)) {
+        hinted->PrepareMutation(mutation);
+        return;
+      }
+      hinted->Unlock();
+    }
+
     while (true) {
       AtomicVersion stable_version;
       LeafNode<Traits> *lnode = TraverseToLeaf(mutation->key(), &stable_version);
@@ -1284,6 +1309,14 @@ class CBTree {
       }
 
       lnode->PrepareMutation(mutation);
+      // Remember this leaf if the mutation prepared an insert at the
+      // rightmost edge of the key space, so that the next in-order insert
+      // can skip the descent above.
+      if (lnode->next_ == NULL && !mutation->exists() &&
+          mutation->idx() == lnode->num_entries()) {
+        base::subtle::NoBarrier_Store(
+            &rightmost_leaf_hint_, reinterpret_cast<base::subtle::AtomicWord>(lnode));
+      }
       return;
     }
   }
@@ -1600,6 +1633,13 @@ class CBTree {
   // when they encounter a stale root pointer.
   mutable NodePtr<Traits> root_;
 
+  // Points at the leaf which most recently took an insert at the rightmost
+  // edge of the key space, or 0 if no such insert has happened yet. Used by
+  // PrepareMutation() to skip the root-to-leaf descent for workloads which
+  // insert in increasing key order. Leaves are never freed while the tree
+  // is alive, so the hint is at worst stale, never dangling.
+  base::subtle::AtomicWord rightmost_leaf_hint_;
+
   // If true, the tree is no longer mutable. Once a tree becomes
   // frozen, it may not be un-frozen. If an iterator is created on
   // a frozen tree, it will be more efficient.
@@ -22,12 +22,16 @@
 #include <utility>
 #include <vector>
 
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 
 #include "kudu/common/column_materialization_context.h"
+#include "kudu/gutil/walltime.h"
 #include "kudu/tablet/delta_store.h"
 #include "kudu/util/status.h"
 
+DECLARE_bool(scan_cycle_accounting);
+
 using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
@@ -46,14 +50,18 @@ DeltaApplier::DeltaApplier(shared_ptr<CFileSet::Iterator> base_iter,
                            unique_ptr<DeltaIterator> delta_iter)
     : base_iter_(std::move(base_iter)),
       delta_iter_(std::move(delta_iter)),
-      first_prepare_(true) {}
+      first_prepare_(true),
+      next_row_idx_(0),
+      delete_apply_cycles_(0) {}
 
 DeltaApplier::~DeltaApplier() {
 }
 
 Status DeltaApplier::Init(ScanSpec *spec) {
   RETURN_NOT_OK(base_iter_->Init(spec));
-  RETURN_NOT_OK(delta_iter_->Init(spec));
+  if (delta_iter_) {
+    RETURN_NOT_OK(delta_iter_->Init(spec));
+  }
   return Status::OK();
 }
 
@@ -63,7 +71,7 @@ string DeltaApplier::ToString() const {
   s.append("DeltaApplier(");
   s.append(base_iter_->ToString());
   s.append(" + ");
-  s.append(delta_iter_->ToString());
+  s.append(delta_iter_ ? delta_iter_->ToString() : "no deltas");
   s.append(")");
   return s;
 }
@@ -73,7 +81,15 @@ const Schema &DeltaApplier::schema() const {
 }
 
 void DeltaApplier::GetIteratorStats(std::vector<IteratorStats>* stats) const {
-  return base_iter_->GetIteratorStats(stats);
+  base_iter_->GetIteratorStats(stats);
+  for (size_t i = 0; i < update_apply_cycles_by_col_.size() && i < stats->size(); i++) {
+    (*stats)[i].delta_apply_cycles += update_apply_cycles_by_col_[i];
+  }
+  // Deletes are applied per batch rather than per column; attribute them to
+  // the first column's entry so they show up in the totals.
+  if (!stats->empty()) {
+    (*stats)[0].delta_apply_cycles += delete_apply_cycles_;
+  }
 }
 
 bool DeltaApplier::HasNext() const {
@@ -85,11 +101,27 @@ Status DeltaApplier::PrepareBatch(size_t *nrows) {
   // because it requires a loaded delta file, and we don't want to require
   // that at Init() time.
   if (first_prepare_) {
+    if (PREDICT_FALSE(FLAGS_scan_cycle_accounting)) {
+      // Sized up front so that concurrent column materialization only ever
+      // writes distinct entries.
+      update_apply_cycles_by_col_.resize(base_iter_->schema().num_columns(), 0);
+    }
+  }
+  if (delta_iter_ &&
+      (first_prepare_ || base_iter_->cur_ordinal_idx() != next_row_idx_)) {
+    // Seek the delta iterator to match the base iterator. Besides the
+    // initial seek, this is needed whenever the base iterator jumped over
+    // rows (e.g. a skip scan transitioning between runs): the delta
+    // iterator only prepares contiguous ranges, so without the re-seek the
+    // deltas would be applied at the wrong row offsets.
     RETURN_NOT_OK(delta_iter_->SeekToOrdinal(base_iter_->cur_ordinal_idx()));
-    first_prepare_ = false;
   }
+  first_prepare_ = false;
   RETURN_NOT_OK(base_iter_->PrepareBatch(nrows));
-  RETURN_NOT_OK(delta_iter_->PrepareBatch(*nrows, DeltaIterator::PREPARE_FOR_APPLY));
+  next_row_idx_ = base_iter_->cur_ordinal_idx() + *nrows;
+  if (delta_iter_) {
+    RETURN_NOT_OK(delta_iter_->PrepareBatch(*nrows, DeltaIterator::PREPARE_FOR_APPLY));
+  }
   return Status::OK();
 }
 
@@ -100,16 +132,32 @@ Status DeltaApplier::FinishBatch() {
 Status DeltaApplier::InitializeSelectionVector(SelectionVector *sel_vec) {
   DCHECK(!first_prepare_) << "PrepareBatch() must be called at least once";
   RETURN_NOT_OK(base_iter_->InitializeSelectionVector(sel_vec));
+  if (!delta_iter_) {
+    return Status::OK();
+  }
+  if (PREDICT_FALSE(FLAGS_scan_cycle_accounting)) {
+    const int64_t start_cycles = CycleClock::Now();
+    Status s = delta_iter_->ApplyDeletes(sel_vec);
+    delete_apply_cycles_ += CycleClock::Now() - start_cycles;
+    return s;
+  }
   return delta_iter_->ApplyDeletes(sel_vec);
 }
 
 Status DeltaApplier::MaterializeColumn(ColumnMaterializationContext *ctx) {
   DCHECK(!first_prepare_) << "PrepareBatch() must be called at least once";
   // Data with updates cannot be evaluated at the decoder-level.
-  if (delta_iter_->MayHaveDeltas()) {
+  if (delta_iter_ && delta_iter_->MayHaveDeltas()) {
     ctx->SetDecoderEvalNotSupported();
     RETURN_NOT_OK(base_iter_->MaterializeColumn(ctx));
-    RETURN_NOT_OK(delta_iter_->ApplyUpdates(ctx->col_idx(), ctx->block()));
+    if (PREDICT_FALSE(FLAGS_scan_cycle_accounting) &&
+        ctx->col_idx() < update_apply_cycles_by_col_.size()) {
+      const int64_t start_cycles = CycleClock::Now();
+      RETURN_NOT_OK(delta_iter_->ApplyUpdates(ctx->col_idx(), ctx->block(), *ctx->sel()));
+      update_apply_cycles_by_col_[ctx->col_idx()] += CycleClock::Now() - start_cycles;
+    } else {
+      RETURN_NOT_OK(delta_iter_->ApplyUpdates(ctx->col_idx(), ctx->block(), *ctx->sel()));
+    }
   } else {
     RETURN_NOT_OK(base_iter_->MaterializeColumn(ctx));
   }
@@ -49,6 +49,10 @@ class DeltaIterator;
 // A DeltaApplier takes in a base ColumnwiseIterator along with a a
 // DeltaIterator. It is responsible for applying the updates coming
 // from the delta iterator to the results of the base iterator.
+//
+// The delta iterator may be NULL, in which case the applier passes the
+// base iterator's data through untouched. This is used as a fast path
+// for rowsets which have no deltas relevant to the scan's snapshot.
 class DeltaApplier : public ColumnwiseIterator {
  public:
   virtual Status Init(ScanSpec *spec) OVERRIDE;
@@ -78,6 +82,7 @@ class DeltaApplier : public ColumnwiseIterator {
   DISALLOW_COPY_AND_ASSIGN(DeltaApplier);
 
   // Construct. The base_iter and delta_iter should not be Initted.
+  // 'delta_iter' may be NULL if there are no relevant deltas (see above).
   DeltaApplier(std::shared_ptr<CFileSet::Iterator> base_iter,
                std::unique_ptr<DeltaIterator> delta_iter);
   virtual ~DeltaApplier();
@@ -86,6 +91,19 @@ class DeltaApplier : public ColumnwiseIterator {
   std::unique_ptr<DeltaIterator> delta_iter_;
 
   bool first_prepare_;
+
+  // The ordinal index at which the previous batch ended. If the base
+  // iterator is positioned elsewhere at the next PrepareBatch() -- e.g.
+  // because a skip scan jumped over a range of rows -- the delta iterator
+  // must be re-seeked to match, since it only prepares contiguous ranges.
+  rowid_t next_row_idx_;
+
+  // Per-column CPU cycles spent applying updates, plus cycles spent applying
+  // deletes (which happen per batch rather than per column). Only populated
+  // when --scan_cycle_accounting is enabled. Sized in PrepareBatch() so that
+  // concurrent column materialization only ever writes distinct entries.
+  std::vector<int64_t> update_apply_cycles_by_col_;
+  int64_t delete_apply_cycles_;
 };
 
 } // namespace tablet
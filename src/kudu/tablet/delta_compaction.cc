@@ -23,6 +23,7 @@
 #include <utility>
 #include <vector>
 
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 
 #include "kudu/common/generic_iterators.h"
@@ -47,7 +48,17 @@
 #include "kudu/tablet/mutation.h"
 #include "kudu/tablet/mvcc.h"
 #include "kudu/tablet/rowset_metadata.h"
+#include "kudu/util/flag_tags.h"
 #include "kudu/util/memory/arena.h"
+#include "kudu/util/threadpool.h"
+
+DEFINE_int32(major_delta_compaction_num_threads, 4,
+             "Maximum number of threads used to rewrite the affected columns "
+             "during a major delta compaction. Each column's cfile is "
+             "rewritten independently, so compactions of wide rows scale "
+             "with this setting. A value of 1 rewrites the columns serially "
+             "in the compacting thread.");
+TAG_FLAG(major_delta_compaction_num_threads, advanced);
 
 using std::shared_ptr;
 
@@ -260,9 +271,22 @@ Status MajorDeltaCompaction::FlushRowSetAndDeltas() {
 Status MajorDeltaCompaction::OpenBaseDataWriter() {
   CHECK(!base_data_writer_);
 
+  // When several columns are being compacted, rewrite them in parallel: each
+  // column's base+REDO merge output is an independent cfile, so the appends
+  // only need to synchronize at the per-block barrier inside
+  // MultiColumnWriter.
+  if (FLAGS_major_delta_compaction_num_threads > 1 &&
+      partial_schema_.num_columns() > 1) {
+    RETURN_NOT_OK(ThreadPoolBuilder(Substitute("mdc-$0", tablet_id_))
+                  .set_min_threads(0)
+                  .set_max_threads(FLAGS_major_delta_compaction_num_threads)
+                  .Build(&column_writer_pool_));
+  }
+
   gscoped_ptr<MultiColumnWriter> w(new MultiColumnWriter(fs_manager_,
                                                          &partial_schema_,
-                                                         tablet_id_));
+                                                         tablet_id_,
+                                                         column_writer_pool_.get()));
   RETURN_NOT_OK(w->Open());
   base_data_writer_.swap(w);
   return Status::OK();
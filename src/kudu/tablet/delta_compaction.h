@@ -32,6 +32,7 @@
 namespace kudu {
 
 class FsManager;
+class ThreadPool;
 
 namespace tablet {
 
@@ -124,6 +125,11 @@ class MajorDeltaCompaction {
   // The ID of the tablet being compacted.
   const std::string tablet_id_;
 
+  // Pool used by 'base_data_writer_' to rewrite the affected columns in
+  // parallel. NULL when only one column is compacted or parallelism is
+  // disabled. Declared before the writer so that it outlives it.
+  gscoped_ptr<ThreadPool> column_writer_pool_;
+
   // Outputs:
   gscoped_ptr<MultiColumnWriter> base_data_writer_;
   // The following two may not be initialized if we don't need to write a delta file.
@@ -66,9 +66,10 @@ Status DeltaIteratorMerger::PrepareBatch(size_t nrows, PrepareFlag flag) {
   return Status::OK();
 }
 
-Status DeltaIteratorMerger::ApplyUpdates(size_t col_to_apply, ColumnBlock *dst) {
+Status DeltaIteratorMerger::ApplyUpdates(size_t col_to_apply, ColumnBlock *dst,
+                                         const SelectionVector& filter) {
   for (const unique_ptr<DeltaIterator> &iter : iters_) {
-    RETURN_NOT_OK(iter->ApplyUpdates(col_to_apply, dst));
+    RETURN_NOT_OK(iter->ApplyUpdates(col_to_apply, dst, filter));
   }
   return Status::OK();
 }
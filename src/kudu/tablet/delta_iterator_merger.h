@@ -62,7 +62,8 @@ class DeltaIteratorMerger : public DeltaIterator {
   virtual Status Init(ScanSpec *spec) OVERRIDE;
   virtual Status SeekToOrdinal(rowid_t idx) OVERRIDE;
   virtual Status PrepareBatch(size_t nrows, PrepareFlag flag) OVERRIDE;
-  virtual Status ApplyUpdates(size_t col_to_apply, ColumnBlock *dst) OVERRIDE;
+  virtual Status ApplyUpdates(size_t col_to_apply, ColumnBlock *dst,
+                              const SelectionVector& filter) OVERRIDE;
   virtual Status ApplyDeletes(SelectionVector *sel_vec) OVERRIDE;
   virtual Status CollectMutations(std::vector<Mutation *> *dst, Arena *arena) OVERRIDE;
   virtual Status FilterColumnIdsAndCollectDeltas(const std::vector<ColumnId>& col_ids,
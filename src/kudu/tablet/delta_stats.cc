@@ -28,6 +28,7 @@
 #include "kudu/gutil/strings/join.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/tablet/tablet.pb.h"
+#include "kudu/util/bitmap.h"
 
 using strings::Substitute;
 
@@ -122,6 +123,11 @@ void DeltaStats::ToPB(DeltaStatsPB* pb) const {
 
   pb->set_max_timestamp(max_timestamp_.ToUint64());
   pb->set_min_timestamp(min_timestamp_.ToUint64());
+
+  if (has_row_range_bitmap()) {
+    pb->set_row_range_size(row_range_size_);
+    pb->set_row_range_bitmap(row_range_bitmap_);
+  }
 }
 
 Status DeltaStats::InitFromPB(const DeltaStatsPB& pb) {
@@ -133,9 +139,31 @@ Status DeltaStats::InitFromPB(const DeltaStatsPB& pb) {
   }
   max_timestamp_.FromUint64(pb.max_timestamp());
   min_timestamp_.FromUint64(pb.min_timestamp());
+  if (pb.has_row_range_size() && pb.row_range_size() > 0) {
+    set_row_range_bitmap(pb.row_range_size(), pb.row_range_bitmap());
+  }
   return Status::OK();
 }
 
+bool DeltaStats::MayHaveDeltasInRowRange(rowid_t start_row, rowid_t last_row) const {
+  if (!has_row_range_bitmap()) {
+    return true;
+  }
+  DCHECK_LE(start_row, last_row);
+  size_t first_bit = start_row / row_range_size_;
+  size_t last_bit = last_row / row_range_size_;
+  const uint8_t* bitmap = reinterpret_cast<const uint8_t*>(row_range_bitmap_.data());
+  size_t num_bits = row_range_bitmap_.size() * 8;
+  for (size_t bit = first_bit; bit <= last_bit; bit++) {
+    // Ranges past the end of the bitmap have no deltas.
+    if (bit >= num_bits) break;
+    if (BitmapTest(bitmap, bit)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 void DeltaStats::AddColumnIdsWithUpdates(std::set<ColumnId>* col_ids) const {
   typedef std::pair<ColumnId, int64_t> entry;
   for (const entry& e : update_counts_by_col_id_) {
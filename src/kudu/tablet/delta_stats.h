@@ -22,6 +22,7 @@
 #include <string>
 #include <unordered_map>
 
+#include "kudu/common/rowid.h"
 #include "kudu/common/schema.h" // IWYU pragma: keep
 #include "kudu/common/timestamp.h"
 #include "kudu/gutil/map-util.h"
@@ -97,12 +98,34 @@ class DeltaStats {
   // set 'col_ids'.
   void AddColumnIdsWithUpdates(std::set<ColumnId>* col_ids) const;
 
+  // Install a sparse row-range skip bitmap. Bit N of 'bitmap' is set if any
+  // row in the range [N * range_size, (N + 1) * range_size) has a delta.
+  void set_row_range_bitmap(int64_t range_size, std::string bitmap) {
+    DCHECK_GT(range_size, 0);
+    row_range_size_ = range_size;
+    row_range_bitmap_ = std::move(bitmap);
+  }
+
+  bool has_row_range_bitmap() const {
+    return row_range_size_ > 0;
+  }
+
+  // Returns true if any row in the inclusive range [start_row, last_row]
+  // may have a delta. Conservatively returns true if no row-range bitmap
+  // was stored (e.g. for delta files written by older versions).
+  bool MayHaveDeltasInRowRange(rowid_t start_row, rowid_t last_row) const;
+
  private:
   std::unordered_map<ColumnId, int64_t> update_counts_by_col_id_;
   uint64_t delete_count_;
   uint64_t reinsert_count_;
   Timestamp max_timestamp_;
   Timestamp min_timestamp_;
+
+  // Sparse row-range skip bitmap; see set_row_range_bitmap(). A
+  // 'row_range_size_' of 0 indicates that no bitmap was stored.
+  std::string row_range_bitmap_;
+  int64_t row_range_size_ = 0;
 };
 
 
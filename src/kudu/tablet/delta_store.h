@@ -102,10 +102,10 @@ typedef std::vector<std::shared_ptr<DeltaStore> > SharedDeltaStoreVector;
 //     clear row block
 //     CHECK_OK(iter->PrepareBatch(rowblock.size()));
 //     ... read column 0 from base data into row block ...
-//     CHECK_OK(iter->ApplyUpdates(0, rowblock.column(0))
+//     CHECK_OK(iter->ApplyUpdates(0, rowblock.column(0), *rowblock.selection_vector())
 //     ... check predicates for column ...
 //     ... read another column from base data...
-//     CHECK_OK(iter->ApplyUpdates(1, rowblock.column(1)))
+//     CHECK_OK(iter->ApplyUpdates(1, rowblock.column(1), *rowblock.selection_vector()))
 //     ...
 //  }
 
@@ -149,9 +149,18 @@ class DeltaIterator {
   virtual Status PrepareBatch(size_t nrows, PrepareFlag flag) = 0;
 
   // Apply the snapshotted updates to one of the columns.
-  // 'dst' must be the same length as was previously passed to PrepareBatch()
+  //
+  // 'dst' must be the same length as was previously passed to PrepareBatch().
+  //
+  // 'filter' is the batch's selection vector, which must also be the same
+  // length as 'dst'. Updates to rows which have already been deselected
+  // (e.g. by a predicate on a previously materialized column, or by
+  // ApplyDeletes()) are skipped, so the cost of applying deltas is
+  // proportional to the number of surviving rows rather than the batch size.
+  //
   // Must have called PrepareBatch() with flag = PREPARE_FOR_APPLY.
-  virtual Status ApplyUpdates(size_t col_to_apply, ColumnBlock *dst) = 0;
+  virtual Status ApplyUpdates(size_t col_to_apply, ColumnBlock *dst,
+                              const SelectionVector& filter) = 0;
 
   // Apply any deletes to the given selection vector.
   // Rows which have been deleted in the associated MVCC snapshot are set to
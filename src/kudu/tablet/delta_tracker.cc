@@ -28,6 +28,7 @@
 #include <glog/logging.h>
 #include <glog/stl_logging.h>
 
+#include "kudu/cfile/block_cache.h"
 #include "kudu/cfile/cfile_util.h"
 #include "kudu/common/iterator.h"
 #include "kudu/common/schema.h"
@@ -116,6 +117,8 @@ Status DeltaTracker::OpenDeltaReaders(const vector<BlockId>& blocks,
     shared_ptr<DeltaFileReader> dfr;
     ReaderOptions options;
     options.parent_mem_tracker = mem_trackers_.tablet_tracker;
+    options.block_cache_partition = cfile::BlockCache::GetSingleton()->GetPartitionForTable(
+        rowset_metadata_->tablet_metadata()->table_id());
     s = DeltaFileReader::OpenNoInit(std::move(block),
                                     type,
                                     std::move(options),
@@ -591,11 +594,36 @@ Status DeltaTracker::NewDeltaFileIterator(
   return DeltaIteratorMerger::Create(*included_stores, schema, snap, out);
 }
 
+bool DeltaTracker::MayHaveDeltasForSnapshot(const MvccSnapshot& snap) const {
+  shared_lock<rw_spinlock> lock(component_lock_);
+  if (!dms_empty_.Load()) {
+    return true;
+  }
+  // All stores other than the DMS are always on disk, so the downcast is safe.
+  for (const shared_ptr<DeltaStore>& ds : redo_delta_stores_) {
+    if (down_cast<DeltaFileReader*>(ds.get())->IsRelevantForSnapshot(snap)) {
+      return true;
+    }
+  }
+  for (const shared_ptr<DeltaStore>& ds : undo_delta_stores_) {
+    if (down_cast<DeltaFileReader*>(ds.get())->IsRelevantForSnapshot(snap)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 Status DeltaTracker::WrapIterator(const shared_ptr<CFileSet::Iterator> &base,
                                   const MvccSnapshot &mvcc_snap,
                                   gscoped_ptr<ColumnwiseIterator>* out) const {
+  // Fully-compacted, read-mostly rowsets commonly have no deltas relevant
+  // to the scan at all. In that case, leave the delta iterator NULL so that
+  // the applier passes the base data through without paying the per-batch
+  // delta iteration overhead.
   unique_ptr<DeltaIterator> iter;
-  RETURN_NOT_OK(NewDeltaIterator(&base->schema(), mvcc_snap, &iter));
+  if (MayHaveDeltasForSnapshot(mvcc_snap)) {
+    RETURN_NOT_OK(NewDeltaIterator(&base->schema(), mvcc_snap, &iter));
+  }
 
   out->reset(new DeltaApplier(base, std::move(iter)));
   return Status::OK();
@@ -674,6 +702,8 @@ Status DeltaTracker::FlushDMS(DeltaMemStore* dms,
   RETURN_NOT_OK(fs->OpenBlock(block_id, &readable_block));
   ReaderOptions options;
   options.parent_mem_tracker = mem_trackers_.tablet_tracker;
+  options.block_cache_partition = cfile::BlockCache::GetSingleton()->GetPartitionForTable(
+      rowset_metadata_->tablet_metadata()->table_id());
   RETURN_NOT_OK(DeltaFileReader::OpenNoInit(std::move(readable_block),
                                             REDO,
                                             std::move(options),
@@ -808,6 +838,53 @@ void DeltaTracker::GetColumnIdsWithUpdates(std::vector<ColumnId>* col_ids) const
   col_ids->assign(column_ids_with_updates.begin(), column_ids_with_updates.end());
 }
 
+bool DeltaTracker::MayHaveUpdatesForColumn(ColumnId col_id) const {
+  if (!dms_empty_.Load()) {
+    return true;
+  }
+  shared_lock<rw_spinlock> lock(component_lock_);
+  for (const SharedDeltaStoreVector* stores :
+       { &undo_delta_stores_, &redo_delta_stores_ }) {
+    for (const shared_ptr<DeltaStore>& ds : *stores) {
+      // We won't force open files just to read their stats.
+      if (!ds->Initted()) {
+        return true;
+      }
+      const DeltaStats& stats = ds->delta_stats();
+      if (stats.update_count_for_col_id(col_id) > 0 ||
+          stats.reinsert_count() > 0) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool DeltaTracker::MayHaveMutationsAtOrAfter(Timestamp ts) const {
+  DCHECK_NE(Timestamp::kInvalidTimestamp, ts);
+  shared_lock<rw_spinlock> lock(component_lock_);
+
+  // Anything in the DMS is, by definition, unflushed and therefore recent.
+  if (!dms_empty_.Load()) {
+    return true;
+  }
+  // We won't force open files just to read their stats, so assume an
+  // uninitialized store may contain recent mutations. Note that UNDO
+  // stores must be considered too: their DELETE deltas carry the
+  // timestamps at which rows were originally inserted.
+  for (const shared_ptr<DeltaStore>& ds : redo_delta_stores_) {
+    if (!ds->Initted() || ds->delta_stats().max_timestamp() >= ts) {
+      return true;
+    }
+  }
+  for (const shared_ptr<DeltaStore>& ds : undo_delta_stores_) {
+    if (!ds->Initted() || ds->delta_stats().max_timestamp() >= ts) {
+      return true;
+    }
+  }
+  return false;
+}
+
 Status DeltaTracker::InitAllDeltaStoresForTests(WhichStores stores) {
   shared_lock<rw_spinlock> lock(component_lock_);
   if (stores == UNDOS_AND_REDOS || stores == UNDOS_ONLY) {
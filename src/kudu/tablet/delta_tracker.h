@@ -255,6 +255,20 @@ class DeltaTracker {
   // Retrieves the list of column indexes that currently have updates.
   void GetColumnIdsWithUpdates(std::vector<ColumnId>* col_ids) const;
 
+  // Return true if the tracked deltas may change the values of the column
+  // with the given ID at any snapshot. The check is conservative: a
+  // non-empty DMS, a store whose stats aren't loaded, or a store containing
+  // REINSERTs (which carry whole-row values without per-column counts) all
+  // cause it to return true. Used to decide whether the base data's
+  // per-column statistics can be trusted for rowset pruning.
+  bool MayHaveUpdatesForColumn(ColumnId col_id) const;
+
+  // Return true if any of the tracked delta stores may contain a mutation
+  // (including the UNDO DELETEs which record row insertion times) with a
+  // timestamp greater than or equal to 'ts'. The check is conservative:
+  // stores whose stats aren't loaded are assumed to contain such mutations.
+  bool MayHaveMutationsAtOrAfter(Timestamp ts) const;
+
   Mutex* compact_flush_lock() {
     return &compact_flush_lock_;
   }
@@ -289,6 +303,12 @@ class DeltaTracker {
   void CollectStores(std::vector<std::shared_ptr<DeltaStore>>* stores,
                      WhichStores which) const;
 
+  // Return true if any of the tracked delta stores may contain deltas
+  // relevant to a scan at 'snap'. The check is conservative: stores whose
+  // stats aren't loaded are assumed relevant. If this returns false, the
+  // scan can skip the delta-applying layer entirely.
+  bool MayHaveDeltasForSnapshot(const MvccSnapshot& snap) const;
+
   // Performs the actual compaction. Results of compaction are written to "block",
   // while delta stores that underwent compaction are appended to "compacted_stores", while
   // their corresponding block ids are appended to "compacted_blocks".
@@ -55,6 +55,7 @@
 #include "kudu/util/test_util.h"
 
 DECLARE_int32(deltafile_default_block_size);
+DECLARE_int32(deltafile_row_range_size);
 DEFINE_int32(first_row_to_update, 10000, "the first row to update");
 DEFINE_int32(last_row_to_update, 100000, "the last row to update");
 DEFINE_int32(n_verify, 1, "number of times to verify the updates"
@@ -183,8 +184,9 @@ class TestDeltaFile : public KuduTest {
       arena_.Reset();
 
       ASSERT_OK_FAST(it->PrepareBatch(block.nrows(), DeltaIterator::PREPARE_FOR_APPLY));
+      block.selection_vector()->SetAllTrue();
       ColumnBlock dst_col = block.column_block(0);
-      ASSERT_OK_FAST(it->ApplyUpdates(0, &dst_col));
+      ASSERT_OK_FAST(it->ApplyUpdates(0, &dst_col, *block.selection_vector()));
 
       for (int i = 0; i < block.nrows(); i++) {
         uint32_t row = start_row + i;
@@ -389,6 +391,84 @@ TEST_F(TestDeltaFile, TestLazyInit) {
   ASSERT_EQ(bytes_read_after_init, bytes_read);
 }
 
+// Check that a file whose deltas can't affect the projected columns (no
+// deletes, no reinserts, no updates to any projected column) doesn't read
+// any delta blocks when preparing for apply, while collection still sees
+// every mutation.
+TEST_F(TestDeltaFile, TestSkipIrrelevantForApply) {
+  WriteTestFile();
+
+  // Build a projection of a column which the file never updates, with a
+  // column ID distinct from the updated column's.
+  SchemaBuilder builder;
+  ASSERT_OK(builder.AddColumn("val", UINT32));
+  ASSERT_OK(builder.AddColumn("other", UINT32));
+  Schema other_proj;
+  ASSERT_OK(builder.Build().CreateProjectionByNames({ "other" }, &other_proj));
+
+  unique_ptr<ReadableBlock> block;
+  ASSERT_OK(fs_manager_->OpenBlock(test_block_, &block));
+  size_t bytes_read = 0;
+  unique_ptr<ReadableBlock> count_block(
+      new CountingReadableBlock(std::move(block), &bytes_read));
+  shared_ptr<DeltaFileReader> reader;
+  ASSERT_OK(DeltaFileReader::Open(
+      std::move(count_block), REDO, ReaderOptions(), &reader));
+
+  MvccSnapshot snap = MvccSnapshot::CreateSnapshotIncludingAllTransactions();
+  DeltaIterator* raw_iter;
+  ASSERT_OK(reader->NewDeltaIterator(&other_proj, snap, &raw_iter));
+  gscoped_ptr<DeltaIterator> it(raw_iter);
+  ASSERT_OK(it->Init(nullptr));
+  ASSERT_OK(it->SeekToOrdinal(FLAGS_first_row_to_update));
+
+  // Preparing for apply should not read any delta blocks.
+  size_t bytes_read_after_seek = bytes_read;
+  ASSERT_OK(it->PrepareBatch(100, DeltaIterator::PREPARE_FOR_APPLY));
+  ASSERT_EQ(bytes_read_after_seek, bytes_read);
+
+  // Preparing the same range for collection must still surface the
+  // mutations, since they are relevant to e.g. compaction regardless of
+  // the projection.
+  ASSERT_OK(it->SeekToOrdinal(FLAGS_first_row_to_update));
+  ASSERT_OK(it->PrepareBatch(100, DeltaIterator::PREPARE_FOR_COLLECT));
+  vector<Mutation*> mutations(100, nullptr);
+  ASSERT_OK(it->CollectMutations(&mutations, &arena_));
+  int rows_with_mutations = 0;
+  for (const Mutation* m : mutations) {
+    if (m != nullptr) {
+      rows_with_mutations++;
+    }
+  }
+  // Every other row in the range was updated.
+  ASSERT_EQ(50, rows_with_mutations);
+  ASSERT_GT(bytes_read, bytes_read_after_seek);
+}
+
+// Check that the row-range skip index is written with the delta stats and
+// correctly identifies ranges with no deltas, without affecting scan results.
+TEST_F(TestDeltaFile, TestRowRangeSkipIndex) {
+  WriteTestFile();
+
+  shared_ptr<DeltaFileReader> reader;
+  ASSERT_OK(OpenDeltaFileReader(test_block_, &reader));
+  const DeltaStats& stats = reader->delta_stats();
+  ASSERT_TRUE(stats.has_row_range_bitmap());
+
+  // Updated row ranges must be reported as possibly containing deltas.
+  ASSERT_TRUE(stats.MayHaveDeltasInRowRange(FLAGS_first_row_to_update,
+                                            FLAGS_first_row_to_update));
+  ASSERT_TRUE(stats.MayHaveDeltasInRowRange(0, FLAGS_last_row_to_update + 10000));
+
+  // A range well past the last update has no deltas.
+  rowid_t far_row = FLAGS_last_row_to_update + 10 * FLAGS_deltafile_row_range_size;
+  ASSERT_FALSE(stats.MayHaveDeltasInRowRange(far_row, far_row + 100));
+
+  // Applying deltas with the skip index in place should yield the same
+  // results as before.
+  VerifyTestFile();
+}
+
 // Check that, if a delta file is opened but no deltas are written,
 // Finish() will return Status::Aborted().
 TEST_F(TestDeltaFile, TestEmptyFileIsAborted) {
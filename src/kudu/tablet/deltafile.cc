@@ -17,6 +17,7 @@
 
 #include "kudu/tablet/deltafile.h"
 
+#include <cstring>
 #include <memory>
 #include <ostream>
 #include <string>
@@ -48,6 +49,7 @@
 #include "kudu/tablet/mutation.h"
 #include "kudu/tablet/mvcc.h"
 #include "kudu/tablet/tablet.pb.h"
+#include "kudu/util/bitmap.h"
 #include "kudu/util/compression/compression_codec.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/memory/arena.h"
@@ -64,6 +66,14 @@ DEFINE_string(deltafile_default_compression_codec, "lz4",
               "The compression codec used when writing deltafiles.");
 TAG_FLAG(deltafile_default_compression_codec, experimental);
 
+DEFINE_int32(deltafile_row_range_size, 4096,
+             "Number of rows covered by each bit of the per-deltafile "
+             "row-range skip index. Scans can skip reading delta blocks for "
+             "row ranges which have no deltas. A value of 0 disables writing "
+             "the skip index.");
+TAG_FLAG(deltafile_row_range_size, advanced);
+TAG_FLAG(deltafile_row_range_size, experimental);
+
 using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
@@ -93,8 +103,9 @@ namespace {
 } // namespace
 
 DeltaFileWriter::DeltaFileWriter(unique_ptr<WritableBlock> block)
+ : row_range_size_(FLAGS_deltafile_row_range_size)
 #ifndef NDEBUG
- : has_appended_(false)
+ , has_appended_(false)
 #endif
 { // NOLINT(*)
   cfile::WriterOptions opts;
@@ -129,6 +140,18 @@ Status DeltaFileWriter::FinishAndReleaseBlock(BlockCreationTransaction* transact
 
 Status DeltaFileWriter::DoAppendDelta(const DeltaKey &key,
                                       const RowChangeList &delta) {
+  // Record the delta's row range in the skip index.
+  if (row_range_size_ > 0) {
+    size_t bit = key.row_idx() / row_range_size_;
+    size_t bitmap_size = BitmapSize(bit + 1);
+    if (bitmap_size > row_range_bitmap_.size()) {
+      size_t old_size = row_range_bitmap_.size();
+      row_range_bitmap_.resize(bitmap_size);
+      memset(row_range_bitmap_.data() + old_size, 0, bitmap_size - old_size);
+    }
+    BitmapSet(row_range_bitmap_.data(), bit);
+  }
+
   Slice delta_slice(delta.slice());
   tmp_buf_.clear();
 
@@ -183,6 +206,13 @@ void DeltaFileWriter::WriteDeltaStats(const DeltaStats& stats) {
   DeltaStatsPB delta_stats_pb;
   stats.ToPB(&delta_stats_pb);
 
+  // Attach the row-range skip index accumulated while appending deltas.
+  if (row_range_size_ > 0 && row_range_bitmap_.size() > 0) {
+    delta_stats_pb.set_row_range_size(row_range_size_);
+    delta_stats_pb.set_row_range_bitmap(row_range_bitmap_.data(),
+                                        row_range_bitmap_.size());
+  }
+
   faststring buf;
   pb_util::SerializeToString(delta_stats_pb, &buf);
   writer_->AddMetadataPair(DeltaFileReader::kDeltaStatsEntryName, buf.ToString());
@@ -389,6 +419,8 @@ DeltaFileIterator::DeltaFileIterator(shared_ptr<DeltaFileReader> dfr,
       prepared_(false),
       exhausted_(false),
       initted_(false),
+      all_relevant_(false),
+      irrelevant_for_apply_(false),
       delta_type_(delta_type),
       cache_blocks_(CFileReader::CACHE_BLOCK) {}
 
@@ -414,12 +446,53 @@ Status DeltaFileIterator::SeekToOrdinal(rowid_t idx) {
   // that we are querying. We did this already before creating the
   // DeltaFileIterator, but due to lazy initialization, it's possible
   // that we weren't able to check at that time.
+  //
+  // Culling here also opportunistically helps the undo delta block GC:
+  // the initialization above loads the file's delta stats, so an UNDO
+  // file entirely older than the ancient history mark becomes visible to
+  // UndoDeltaBlockGCOp (which never initializes files itself in its
+  // deletion path) the next time it runs.
   if (!dfr_->IsRelevantForSnapshot(mvcc_snap_)) {
+    TRACE_COUNTER_INCREMENT("delta_iterators_culled_lazily", 1);
+    VLOG(2) << "Lazily culling " << (delta_type_ == REDO ? "REDO" : "UNDO")
+            << " delta " << dfr_->ToString() << " for " << mvcc_snap_.ToString();
     exhausted_ = true;
     delta_blocks_.clear();
     return Status::OK();
   }
 
+  // Determine whether *every* mutation in the file is relevant for the
+  // snapshot, using the file's timestamp bounds (available now that the
+  // reader is initialized). This is the common case for scans at a recent
+  // snapshot, where all the redo mutations are already committed; it lets
+  // the visitors skip the per-mutation MVCC checks.
+  if (delta_type_ == REDO) {
+    all_relevant_ = !mvcc_snap_.MayHaveUncommittedTransactionsAtOrBefore(
+        dfr_->delta_stats().max_timestamp());
+  } else {
+    all_relevant_ = !mvcc_snap_.MayHaveCommittedTransactionsAtOrAfter(
+        dfr_->delta_stats().min_timestamp());
+  }
+
+  // Determine whether the file contains anything that could affect rows
+  // applied through the projection: a file full of updates to unprojected
+  // columns (common for wide tables where only a few columns are ever
+  // updated) contributes nothing to the scan, and PrepareBatch() can skip
+  // reading its delta blocks altogether.
+  if (projection_->has_column_ids()) {
+    const DeltaStats& stats = dfr_->delta_stats();
+    irrelevant_for_apply_ =
+        stats.delete_count() == 0 && stats.reinsert_count() == 0;
+    if (irrelevant_for_apply_) {
+      for (size_t i = 0; i < projection_->num_columns(); i++) {
+        if (stats.update_count_for_col_id(projection_->column_id(i)) > 0) {
+          irrelevant_for_apply_ = false;
+          break;
+        }
+      }
+    }
+  }
+
   if (!index_iter_) {
     index_iter_.reset(IndexTreeIterator::Create(
         dfr_->cfile_reader().get(),
@@ -524,7 +597,18 @@ Status DeltaFileIterator::PrepareBatch(size_t nrows, PrepareFlag flag) {
     delta_blocks_.pop_front();
   }
 
-  while (!exhausted_) {
+  // Consult the file's row-range skip index: if no deltas exist in the range
+  // being prepared, don't read any delta blocks for it. We also don't advance
+  // the index iterator, so any block which additionally overlaps a later,
+  // non-skipped range will still be read when that range is prepared.
+  //
+  // Similarly, if the file as a whole is irrelevant to the projection, the
+  // apply calls would all be no-ops, so there's no reason to read the blocks.
+  bool range_may_have_deltas =
+      !(flag == PREPARE_FOR_APPLY && irrelevant_for_apply_) &&
+      dfr_->delta_stats().MayHaveDeltasInRowRange(start_row, stop_row);
+
+  while (!exhausted_ && range_may_have_deltas) {
     rowid_t next_block_rowidx;
     RETURN_NOT_OK(GetFirstRowIndexInCurrentBlock(&next_block_rowidx));
     VLOG(2) << "Current delta block starting at row " << next_block_rowidx;
@@ -632,10 +716,18 @@ Status DeltaFileIterator::VisitMutations(Visitor *visitor) {
 // Returns whether a REDO mutation with 'timestamp' is relevant under 'snap'.
 // If snap cannot include any mutations with a higher timestamp 'continue_visit' is
 // set to false, it's set to true otherwise.
-inline bool IsRedoRelevant(const MvccSnapshot& snap,
-                            const Timestamp& timestamp,
-                            bool* continue_visit) {
+//
+// 'all_relevant' short-circuits the per-mutation check; it is set when the
+// file's timestamp bounds prove that the snapshot commits every mutation in
+// the file (see DeltaFileIterator::SeekToOrdinal()).
+inline bool IsRedoRelevant(bool all_relevant,
+                           const MvccSnapshot& snap,
+                           const Timestamp& timestamp,
+                           bool* continue_visit) {
   *continue_visit = true;
+  if (PREDICT_TRUE(all_relevant)) {
+    return true;
+  }
   if (!snap.IsCommitted(timestamp)) {
     if (!snap.MayHaveCommittedTransactionsAtOrAfter(timestamp)) {
       *continue_visit = false;
@@ -648,10 +740,17 @@ inline bool IsRedoRelevant(const MvccSnapshot& snap,
 // Returns whether an UNDO mutation with 'timestamp' is relevant under 'snap'.
 // If snap cannot include any mutations with a lower timestamp 'continue_visit' is
 // set to false, it's set to true otherwise.
-inline bool IsUndoRelevant(const MvccSnapshot& snap,
+//
+// As above, 'all_relevant' short-circuits the per-mutation check when the
+// snapshot is known to commit none of the mutations in the file.
+inline bool IsUndoRelevant(bool all_relevant,
+                           const MvccSnapshot& snap,
                            const Timestamp& timestamp,
                            bool* continue_visit) {
   *continue_visit = true;
+  if (PREDICT_TRUE(all_relevant)) {
+    return true;
+  }
   if (snap.IsCommitted(timestamp)) {
     if (!snap.MayHaveUncommittedTransactionsAtOrBefore(timestamp)) {
       *continue_visit = false;
@@ -670,14 +769,20 @@ struct ApplyingVisitor {
     int64_t rel_idx = key.row_idx() - dfi->prepared_idx_;
     DCHECK_GE(rel_idx, 0);
 
+    // Rows which are already deselected (e.g. by a predicate on an earlier
+    // column) will never be returned, so there's no need to decode or apply
+    // their mutations.
+    if (!filter->IsRowSelected(rel_idx)) {
+      return Status::OK();
+    }
+
     // TODO: this code looks eerily similar to DMSIterator::ApplyUpdates!
     // I bet it can be combined.
 
-    const Schema* schema = dfi->projection_;
-    RowChangeListDecoder decoder((RowChangeList(deltas)));
+    decoder.Reset(RowChangeList(deltas));
     RETURN_NOT_OK(decoder.Init());
     if (decoder.is_update() || decoder.is_reinsert()) {
-      return decoder.ApplyToOneColumn(rel_idx, dst, *schema, col_to_apply, dst->arena());
+      return decoder.ApplyToOneColumn(rel_idx, dst, *col_schema, col_id, dst->arena());
     }
 
     DCHECK(decoder.is_delete());
@@ -686,15 +791,24 @@ struct ApplyingVisitor {
   }
 
   DeltaFileIterator *dfi;
-  size_t col_to_apply;
+  // The target column, resolved once so that per-mutation application
+  // doesn't need to look it up in the projection schema.
+  const ColumnSchema* col_schema;
+  ColumnId col_id;
   ColumnBlock *dst;
+  // Rows already deselected in this batch; their mutations are skipped.
+  const SelectionVector* filter;
+
+  // Reusable decode scratch, to avoid re-constructing decoder state for
+  // every visited mutation.
+  RowChangeListDecoder decoder;
 };
 
 template<>
 inline Status ApplyingVisitor<REDO>::Visit(const DeltaKey& key,
                                            const Slice& deltas,
                                            bool* continue_visit) {
-  if (IsRedoRelevant(dfi->mvcc_snap_, key.timestamp(), continue_visit)) {
+  if (IsRedoRelevant(dfi->all_relevant_, dfi->mvcc_snap_, key.timestamp(), continue_visit)) {
     DVLOG(3) << "Applied redo delta";
     return ApplyMutation(key, deltas);
   }
@@ -706,7 +820,7 @@ template<>
 inline Status ApplyingVisitor<UNDO>::Visit(const DeltaKey& key,
                                            const Slice& deltas,
                                            bool* continue_visit) {
-  if (IsUndoRelevant(dfi->mvcc_snap_, key.timestamp(), continue_visit)) {
+  if (IsUndoRelevant(dfi->all_relevant_, dfi->mvcc_snap_, key.timestamp(), continue_visit)) {
     DVLOG(3) << "Applied undo delta";
     return ApplyMutation(key, deltas);
   }
@@ -714,16 +828,35 @@ inline Status ApplyingVisitor<UNDO>::Visit(const DeltaKey& key,
   return Status::OK();
 }
 
-Status DeltaFileIterator::ApplyUpdates(size_t col_to_apply, ColumnBlock *dst) {
+Status DeltaFileIterator::ApplyUpdates(size_t col_to_apply, ColumnBlock *dst,
+                                       const SelectionVector& filter) {
   DCHECK_LE(prepared_count_, dst->nrows());
+  DCHECK_LE(prepared_count_, filter.nrows());
+
+  // If the file's stats show that this column was never updated (and there
+  // are no reinserts, which also carry column values), there's nothing to
+  // apply, regardless of what other deltas the prepared blocks contain.
+  if (projection_->has_column_ids()) {
+    const DeltaStats& stats = dfr_->delta_stats();
+    if (stats.update_count_for_col_id(projection_->column_id(col_to_apply)) == 0 &&
+        stats.reinsert_count() == 0) {
+      return Status::OK();
+    }
+  }
+
+  // Resolve the target column once, rather than per mutation.
+  const ColumnSchema& col_schema = projection_->column(col_to_apply);
+  ColumnId col_id = projection_->column_id(col_to_apply);
 
   if (delta_type_ == REDO) {
     DVLOG(3) << "Applying REDO mutations to " << col_to_apply;
-    ApplyingVisitor<REDO> visitor = {this, col_to_apply, dst};
+    ApplyingVisitor<REDO> visitor = {this, &col_schema, col_id, dst, &filter,
+                                     RowChangeListDecoder()};
     return VisitMutations(&visitor);
   }
   DVLOG(3) << "Applying UNDO mutations to " << col_to_apply;
-  ApplyingVisitor<UNDO> visitor = {this, col_to_apply, dst};
+  ApplyingVisitor<UNDO> visitor = {this, &col_schema, col_id, dst, &filter,
+                                   RowChangeListDecoder()};
   return VisitMutations(&visitor);
 }
 
@@ -768,7 +901,7 @@ template<>
 inline Status LivenessVisitor<REDO>::Visit(const DeltaKey& key,
                                            const Slice& deltas,
                                            bool* continue_visit) {
-  if (IsRedoRelevant(dfi->mvcc_snap_, key.timestamp(), continue_visit)) {
+  if (IsRedoRelevant(dfi->all_relevant_, dfi->mvcc_snap_, key.timestamp(), continue_visit)) {
     return ApplyDelete(key, deltas);
   }
   return Status::OK();
@@ -778,7 +911,7 @@ template<>
 inline Status LivenessVisitor<UNDO>::Visit(const DeltaKey& key,
                                            const Slice& deltas, bool*
                                            continue_visit) {
-  if (IsUndoRelevant(dfi->mvcc_snap_, key.timestamp(), continue_visit)) {
+  if (IsUndoRelevant(dfi->all_relevant_, dfi->mvcc_snap_, key.timestamp(), continue_visit)) {
     return ApplyDelete(key, deltas);
   }
   return Status::OK();
@@ -824,7 +957,7 @@ template<>
 inline Status CollectingVisitor<REDO>::Visit(const DeltaKey& key,
                                            const Slice& deltas,
                                            bool* continue_visit) {
-  if (IsRedoRelevant(dfi->mvcc_snap_, key.timestamp(), continue_visit)) {
+  if (IsRedoRelevant(dfi->all_relevant_, dfi->mvcc_snap_, key.timestamp(), continue_visit)) {
     return Collect(key, deltas);
   }
   return Status::OK();
@@ -834,7 +967,7 @@ template<>
 inline Status CollectingVisitor<UNDO>::Visit(const DeltaKey& key,
                                            const Slice& deltas, bool*
                                            continue_visit) {
-  if (IsUndoRelevant(dfi->mvcc_snap_, key.timestamp(), continue_visit)) {
+  if (IsUndoRelevant(dfi->all_relevant_, dfi->mvcc_snap_, key.timestamp(), continue_visit)) {
     return Collect(key, deltas);
   }
   return Status::OK();
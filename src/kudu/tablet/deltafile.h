@@ -117,6 +117,12 @@ class DeltaFileWriter {
   // of the deltas
   faststring tmp_buf_;
 
+  // Row-range skip index accumulated while appending deltas; written into
+  // the delta stats metadata by WriteDeltaStats(). A 'row_range_size_' of 0
+  // disables the index.
+  faststring row_range_bitmap_;
+  const int64_t row_range_size_;
+
   #ifndef NDEBUG
   // The index of the previously written row.
   // This is used in debug mode to make sure that rows are appended
@@ -225,7 +231,8 @@ class DeltaFileIterator : public DeltaIterator {
 
   Status SeekToOrdinal(rowid_t idx) OVERRIDE;
   Status PrepareBatch(size_t nrows, PrepareFlag flag) OVERRIDE;
-  Status ApplyUpdates(size_t col_to_apply, ColumnBlock *dst) OVERRIDE;
+  Status ApplyUpdates(size_t col_to_apply, ColumnBlock *dst,
+                      const SelectionVector& filter) OVERRIDE;
   Status ApplyDeletes(SelectionVector *sel_vec) OVERRIDE;
   Status CollectMutations(std::vector<Mutation *> *dst, Arena *arena) OVERRIDE;
   Status FilterColumnIdsAndCollectDeltas(const std::vector<ColumnId>& col_ids,
@@ -328,6 +335,19 @@ class DeltaFileIterator : public DeltaIterator {
   bool exhausted_;
   bool initted_;
 
+  // Set by SeekToOrdinal() when the file's delta stats prove that every
+  // mutation in the file is relevant to mvcc_snap_. In that case the
+  // visitors can skip the per-mutation MVCC checks.
+  bool all_relevant_;
+
+  // Set by SeekToOrdinal() when the file's delta stats prove that nothing in
+  // the file can affect rows applied through 'projection_': no deletes, no
+  // reinserts, and no updates to any projected column. In that case
+  // PrepareBatch(PREPARE_FOR_APPLY) skips reading delta blocks entirely.
+  // Collection (e.g. for compaction inputs) must still see every mutation,
+  // so PREPARE_FOR_COLLECT ignores this.
+  bool irrelevant_for_apply_;
+
   // After PrepareBatch(), the set of delta blocks in the delta file
   // which correspond to prepared_block_.
   std::deque<std::unique_ptr<PreparedDeltaBlock>> delta_blocks_;
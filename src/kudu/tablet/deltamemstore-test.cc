@@ -36,6 +36,7 @@
 #include "kudu/common/columnblock.h"
 #include "kudu/common/common.pb.h"
 #include "kudu/common/row_changelist.h"
+#include "kudu/common/rowblock.h"
 #include "kudu/common/schema.h"
 #include "kudu/common/timestamp.h"
 #include "kudu/common/types.h"
@@ -141,7 +142,9 @@ class TestDeltaMemStore : public KuduTest {
     ASSERT_OK(iter->Init(nullptr));
     ASSERT_OK(iter->SeekToOrdinal(row_idx));
     ASSERT_OK(iter->PrepareBatch(cb->nrows(), DeltaIterator::PREPARE_FOR_APPLY));
-    ASSERT_OK(iter->ApplyUpdates(0, cb));
+    SelectionVector filter(cb->nrows());
+    filter.SetAllTrue();
+    ASSERT_OK(iter->ApplyUpdates(0, cb, filter));
   }
 
 
@@ -457,10 +460,13 @@ TEST_F(TestDeltaMemStore, TestIteratorDoesUpdates) {
   gscoped_ptr<DMSIterator> iter(down_cast<DMSIterator *>(raw_iter));
   ASSERT_OK(iter->Init(nullptr));
 
+  SelectionVector filter(block.nrows());
+  filter.SetAllTrue();
+
   int block_start_row = 50;
   ASSERT_OK(iter->SeekToOrdinal(block_start_row));
   ASSERT_OK(iter->PrepareBatch(block.nrows(), DeltaIterator::PREPARE_FOR_APPLY));
-  ASSERT_OK(iter->ApplyUpdates(kIntColumn, &block));
+  ASSERT_OK(iter->ApplyUpdates(kIntColumn, &block, filter));
 
   for (int i = 0; i < 100; i++) {
     int actual_row = block_start_row + i;
@@ -470,11 +476,31 @@ TEST_F(TestDeltaMemStore, TestIteratorDoesUpdates) {
   // Apply the next block
   block_start_row += block.nrows();
   ASSERT_OK(iter->PrepareBatch(block.nrows(), DeltaIterator::PREPARE_FOR_APPLY));
-  ASSERT_OK(iter->ApplyUpdates(kIntColumn, &block));
+  ASSERT_OK(iter->ApplyUpdates(kIntColumn, &block, filter));
   for (int i = 0; i < 100; i++) {
     int actual_row = block_start_row + i;
     ASSERT_EQ(actual_row * 10, block[i]) << "at row " << actual_row;
   }
+
+  // Apply another block, this time with every other row deselected.
+  // Updates to the deselected rows should be skipped entirely.
+  block_start_row += block.nrows();
+  for (int i = 0; i < block.nrows(); i++) {
+    block[i] = 0;
+    if (i % 2 == 1) {
+      filter.SetRowUnselected(i);
+    }
+  }
+  ASSERT_OK(iter->PrepareBatch(block.nrows(), DeltaIterator::PREPARE_FOR_APPLY));
+  ASSERT_OK(iter->ApplyUpdates(kIntColumn, &block, filter));
+  for (int i = 0; i < 100; i++) {
+    int actual_row = block_start_row + i;
+    if (i % 2 == 0) {
+      ASSERT_EQ(actual_row * 10, block[i]) << "at row " << actual_row;
+    } else {
+      ASSERT_EQ(0, block[i]) << "deselected row " << actual_row << " should not be updated";
+    }
+  }
 }
 
 TEST_F(TestDeltaMemStore, TestCollectMutations) {
@@ -251,6 +251,14 @@ Status DMSIterator::PrepareBatch(size_t nrows, PrepareFlag flag) {
   deleted_.clear();
   prepared_deltas_.clear();
 
+  // Reuse a single decoder across all of the deltas in the batch rather
+  // than constructing one per mutation.
+  RowChangeListDecoder decoder;
+
+  // Deltas from the same transaction share a timestamp, so memoize the
+  // verdict of the last committed-check across the batch.
+  MvccCommittedChecker committed(&mvcc_snapshot_);
+
   while (iter_->IsValid()) {
     Slice key_slice, val;
     iter_->GetCurrentEntry(&key_slice, &val);
@@ -259,7 +267,7 @@ Status DMSIterator::PrepareBatch(size_t nrows, PrepareFlag flag) {
     DCHECK_GE(key.row_idx(), start_row);
     if (key.row_idx() > stop_row) break;
 
-    if (!mvcc_snapshot_.IsCommitted(key.timestamp())) {
+    if (!committed.IsCommitted(key.timestamp())) {
       // The transaction which applied this update is not yet committed
       // in this iterator's MVCC snapshot. Hence, skip it.
       iter_->Next();
@@ -267,7 +275,7 @@ Status DMSIterator::PrepareBatch(size_t nrows, PrepareFlag flag) {
     }
 
     if (flag == PREPARE_FOR_APPLY) {
-      RowChangeListDecoder decoder((RowChangeList(val)));
+      decoder.Reset(RowChangeList(val));
       decoder.InitNoSafetyChecks();
       DCHECK(!decoder.is_reinsert()) << "Reinserts are not supported in the DeltaMemStore.";
       if (decoder.is_delete()) {
@@ -295,13 +303,9 @@ Status DMSIterator::PrepareBatch(size_t nrows, PrepareFlag flag) {
 
           ColumnUpdate& cu = updates_by_col_[col_idx].back();
           cu.row_id = key.row_idx();
-          if (col_val == nullptr) {
-            cu.new_val_ptr = nullptr;
-          } else {
+          cu.new_val_is_null = (col_val == nullptr);
+          if (col_val != nullptr) {
             memcpy(cu.new_val_buf, col_val, col_size);
-            // NOTE: we're constructing a pointer here to an element inside the deque.
-            // This is safe because deques never invalidate pointers to their elements.
-            cu.new_val_ptr = cu.new_val_buf;
           }
         }
       }
@@ -321,15 +325,23 @@ Status DMSIterator::PrepareBatch(size_t nrows, PrepareFlag flag) {
   return Status::OK();
 }
 
-Status DMSIterator::ApplyUpdates(size_t col_to_apply, ColumnBlock *dst) {
+Status DMSIterator::ApplyUpdates(size_t col_to_apply, ColumnBlock *dst,
+                                 const SelectionVector& filter) {
   DCHECK_EQ(prepared_for_, PREPARED_FOR_APPLY);
   DCHECK_EQ(prepared_count_, dst->nrows());
+  DCHECK_LE(prepared_count_, filter.nrows());
 
   const ColumnSchema* col_schema = &projection_->column(col_to_apply);
   for (const ColumnUpdate& cu : updates_by_col_[col_to_apply]) {
     int32_t idx_in_block = cu.row_id - prepared_idx_;
     DCHECK_GE(idx_in_block, 0);
-    SimpleConstCell src(col_schema, cu.new_val_ptr);
+    // Rows deselected by an earlier column's predicate (or by ApplyDeletes())
+    // will never be returned, so don't bother copying their values.
+    if (!filter.IsRowSelected(idx_in_block)) {
+      continue;
+    }
+    const void* new_val = cu.new_val_is_null ? nullptr : cu.new_val_buf;
+    SimpleConstCell src(col_schema, new_val);
     ColumnBlock::Cell dst_cell = dst->cell(idx_in_block);
     RETURN_NOT_OK(CopyCell(src, &dst_cell, dst->arena()));
   }
@@ -19,7 +19,6 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <deque>
 #include <memory>
 #include <string>
 #include <vector>
@@ -204,7 +203,8 @@ class DMSIterator : public DeltaIterator {
 
   Status PrepareBatch(size_t nrows, PrepareFlag flag) OVERRIDE;
 
-  Status ApplyUpdates(size_t col_to_apply, ColumnBlock *dst) OVERRIDE;
+  Status ApplyUpdates(size_t col_to_apply, ColumnBlock *dst,
+                      const SelectionVector& filter) OVERRIDE;
 
   Status ApplyDeletes(SelectionVector *sel_vec) OVERRIDE;
 
@@ -266,12 +266,16 @@ class DMSIterator : public DeltaIterator {
   // ------------------------------------------------------------
   struct ColumnUpdate {
     rowid_t row_id;
-    void* new_val_ptr;
+    bool new_val_is_null;
     uint8_t new_val_buf[16];
   };
-  typedef std::deque<ColumnUpdate> UpdatesForColumn;
+  // Per-column flat arrays of updates, sorted by row id (PrepareBatch()
+  // traverses the tree in key order). Using contiguous storage here keeps
+  // the apply-side merge pass cache-friendly, and clear() retains the
+  // allocated capacity across batches.
+  typedef std::vector<ColumnUpdate> UpdatesForColumn;
   std::vector<UpdatesForColumn> updates_by_col_;
-  std::deque<rowid_t> deleted_;
+  std::vector<rowid_t> deleted_;
 
   // State when prepared_for_ == PREPARED_FOR_COLLECT
   // ------------------------------------------------------------
@@ -279,7 +283,7 @@ class DMSIterator : public DeltaIterator {
     DeltaKey key;
     Slice val;
   };
-  std::deque<PreparedDelta> prepared_deltas_;
+  std::vector<PreparedDelta> prepared_deltas_;
 
   // Temporary buffer used for RowChangeList projection.
   faststring delta_buf_;
@@ -114,13 +114,17 @@ class TestRowSet : public KuduRowSetTest {
       CHECK_OK(writer->Open());
 
       char buf[256];
+      faststring enc_key;
       RowBuilder rb(schema_);
       for (int i = 0; i < n_rows; i++) {
-        CHECK_OK(writer->RollIfNecessary());
         rb.Reset();
         FormatKey(i, buf, sizeof(buf));
         rb.AddString(Slice(buf));
         rb.AddUint32(zero_vals ? 0 : i);
+        // Pass the key of the row about to be written so that rolling
+        // writers can roll right at a key prefix boundary if so configured.
+        CHECK_OK(writer->RollIfNecessary(
+            schema_.EncodeComparableKey(rb.row(), &enc_key)));
         CHECK_OK(WriteRow(rb.data(), writer));
       }
       CHECK_OK(writer->Finish());
@@ -36,6 +36,7 @@
 #include "kudu/common/row_changelist.h"
 #include "kudu/common/schema.h"
 #include "kudu/common/timestamp.h"
+#include "kudu/consensus/log_anchor_registry.h"
 #include "kudu/fs/block_id.h"
 #include "kudu/gutil/gscoped_ptr.h"
 #include "kudu/gutil/move.h"
@@ -67,6 +68,7 @@ DECLARE_bool(cfile_lazy_open);
 DECLARE_bool(crash_on_eio);
 DECLARE_int32(cfile_default_block_size);
 DECLARE_double(env_inject_eio);
+DECLARE_int32(rowset_roll_key_prefix_length);
 DECLARE_double(tablet_delta_store_major_compact_min_ratio);
 DECLARE_int32(tablet_delta_store_minor_compact_max);
 
@@ -491,6 +493,47 @@ TEST_F(TestRowSet, TestRollingDiskRowSetWriter) {
   }
 }
 
+TEST_F(TestRowSet, TestRollAtKeyPrefixBoundary) {
+  google::FlagSaver saver;
+  FLAGS_cfile_default_block_size = 4096;
+  // Keys look like "hello 000000000001234". The first 18 bytes of the encoded
+  // key cover everything but the last three digits, so the key prefix changes
+  // every 1000 rows.
+  FLAGS_rowset_roll_key_prefix_length = 18;
+
+  RollingDiskRowSetWriter writer(tablet()->metadata(), schema_,
+                                 BloomFilterSizing::BySizeAndFPRate(32*1024, 0.01f),
+                                 64 * 1024); // roll every 64KB
+  DoWriteTestRowSet(10000, &writer);
+
+  vector<shared_ptr<RowSetMetadata> > metas;
+  writer.GetWrittenRowSetMetadata(&metas);
+  ASSERT_GE(metas.size(), 2);
+
+  // Every rowset but the first should start at a prefix boundary, i.e. on a
+  // row whose index is a multiple of 1000.
+  for (size_t i = 1; i < metas.size(); i++) {
+    shared_ptr<DiskRowSet> rs;
+    ASSERT_OK(DiskRowSet::Open(metas[i],
+                               new log::LogAnchorRegistry(),
+                               TabletMemTrackers(),
+                               &rs));
+    MvccSnapshot snap = MvccSnapshot::CreateSnapshotIncludingAllTransactions();
+    gscoped_ptr<RowwiseIterator> row_iter;
+    ASSERT_OK(rs->NewRowIterator(&schema_, snap, UNORDERED, &row_iter));
+    ASSERT_OK(row_iter->Init(nullptr));
+    vector<string> rows;
+    ASSERT_OK(IterateToStringList(row_iter.get(), &rows, 1));
+    ASSERT_EQ(1, rows.size());
+
+    size_t key_pos = rows[0].find("hello ");
+    ASSERT_NE(string::npos, key_pos);
+    string digits = rows[0].substr(key_pos + 6, 15);
+    EXPECT_EQ("000", digits.substr(12)) << "rowset " << i
+        << " does not start at a key prefix boundary: " << rows[0];
+  }
+}
+
 TEST_F(TestRowSet, TestMakeDeltaIteratorMergerUnlocked) {
   WriteTestRowSet();
 
@@ -30,9 +30,11 @@
 #include "kudu/cfile/bloomfile.h"
 #include "kudu/cfile/cfile_util.h"
 #include "kudu/cfile/cfile_writer.h"
+#include "kudu/common/column_predicate.h"
 #include "kudu/common/generic_iterators.h"
 #include "kudu/common/iterator.h"
 #include "kudu/common/rowblock.h"
+#include "kudu/common/scan_spec.h"
 #include "kudu/common/schema.h"
 #include "kudu/common/timestamp.h"
 #include "kudu/common/types.h"
@@ -73,6 +75,35 @@ DEFINE_int32(default_composite_key_index_block_size_bytes, 4096,
              "Block size used for composite key indexes.");
 TAG_FLAG(default_composite_key_index_block_size_bytes, experimental);
 
+DEFINE_bool(enable_rowset_column_stats_pruning, true,
+            "Whether to use the per-column min/max statistics stored in each "
+            "rowset's column cfiles to skip entire rowsets whose value ranges "
+            "cannot satisfy a scan's predicates.");
+TAG_FLAG(enable_rowset_column_stats_pruning, advanced);
+TAG_FLAG(enable_rowset_column_stats_pruning, runtime);
+
+DEFINE_int32(rowset_roll_key_prefix_length, 0,
+             "If set to a positive value, the rolling rowset writer used by "
+             "flushes and compactions prefers to roll to a new rowset where "
+             "the first N bytes of the encoded primary key change, rather "
+             "than exactly at the size threshold. Aligning rowset boundaries "
+             "with key-prefix boundaries (e.g. a tenant or shard id that "
+             "leads the primary key) means a scan restricted to one prefix "
+             "touches fewer rowsets. A value of 0 (the default) rolls purely "
+             "on size.");
+TAG_FLAG(rowset_roll_key_prefix_length, advanced);
+TAG_FLAG(rowset_roll_key_prefix_length, experimental);
+
+DEFINE_int32(rowset_roll_key_prefix_slack_pct, 50,
+             "Maximum percentage by which a rowset may exceed its target "
+             "size while waiting for a key-prefix boundary to roll at. Once "
+             "the overshoot exceeds this, the writer rolls regardless of the "
+             "key prefix, which bounds rowset sizes when a single prefix "
+             "holds more data than the target. Only used when "
+             "--rowset_roll_key_prefix_length is positive.");
+TAG_FLAG(rowset_roll_key_prefix_slack_pct, advanced);
+TAG_FLAG(rowset_roll_key_prefix_slack_pct, experimental);
+
 namespace kudu {
 
 class Mutex;
@@ -96,13 +127,18 @@ using std::vector;
 
 const char *DiskRowSet::kMinKeyMetaEntryName = "min_key";
 const char *DiskRowSet::kMaxKeyMetaEntryName = "max_key";
+const char *DiskRowSet::kColumnMinValueMetaEntryName = "min_val";
+const char *DiskRowSet::kColumnMaxValueMetaEntryName = "max_val";
+const char *DiskRowSet::kColumnNullCountMetaEntryName = "null_count";
 
 DiskRowSetWriter::DiskRowSetWriter(RowSetMetadata* rowset_metadata,
                                    const Schema* schema,
-                                   BloomFilterSizing bloom_sizing)
+                                   BloomFilterSizing bloom_sizing,
+                                   int64_t expected_size)
     : rowset_metadata_(rowset_metadata),
       schema_(schema),
       bloom_sizing_(bloom_sizing),
+      expected_size_(expected_size),
       finished_(false),
       written_count_(0) {
   CHECK(schema->has_column_ids());
@@ -113,7 +149,18 @@ Status DiskRowSetWriter::Open() {
 
   FsManager* fs = rowset_metadata_->fs_manager();
   const string& tablet_id = rowset_metadata_->tablet_metadata()->tablet_id();
-  col_writer_.reset(new MultiColumnWriter(fs, schema_, tablet_id));
+
+  // The expected size is for the rowset as a whole; apportion it evenly
+  // among the column writers. This is a crude estimate (columns vary in
+  // width and compressibility), but as a preallocation hint it only needs
+  // to be in the right ballpark.
+  int64_t column_expected_size = 0;
+  if (expected_size_ > 0) {
+    column_expected_size = expected_size_ / schema_->num_columns();
+  }
+  col_writer_.reset(new MultiColumnWriter(fs, schema_, tablet_id,
+                                          /* pool= */ nullptr,
+                                          column_expected_size));
   RETURN_NOT_OK(col_writer_->Open());
 
   // Open bloom filter.
@@ -265,6 +312,13 @@ Status DiskRowSetWriter::FinishAndReleaseBlocks(BlockCreationTransaction* transa
   col_writer_->GetFlushedBlocksByColumnId(&flushed_blocks);
   rowset_metadata_->SetColumnDataBlocks(flushed_blocks);
 
+  // Ditto for any value index blocks.
+  std::map<ColumnId, BlockId> value_index_blocks;
+  col_writer_->GetFlushedValueIndexBlocksByColumnId(&value_index_blocks);
+  if (!value_index_blocks.empty()) {
+    rowset_metadata_->SetValueIndexBlocks(value_index_blocks);
+  }
+
   if (ad_hoc_index_writer_ != nullptr) {
     Status s = ad_hoc_index_writer_->FinishAndReleaseBlock(transaction);
     if (!s.ok()) {
@@ -342,7 +396,8 @@ Status RollingDiskRowSetWriter::RollWriter() {
 
   RETURN_NOT_OK(tablet_metadata_->CreateRowSet(&cur_drs_metadata_));
 
-  cur_writer_.reset(new DiskRowSetWriter(cur_drs_metadata_.get(), &schema_, bloom_sizing_));
+  cur_writer_.reset(new DiskRowSetWriter(cur_drs_metadata_.get(), &schema_, bloom_sizing_,
+                                         target_rowset_size_));
   RETURN_NOT_OK(cur_writer_->Open());
 
   FsManager* fs = tablet_metadata_->fs_manager();
@@ -366,10 +421,39 @@ Status RollingDiskRowSetWriter::RollWriter() {
   return cur_redo_writer_->Start();
 }
 
-Status RollingDiskRowSetWriter::RollIfNecessary() {
+Status RollingDiskRowSetWriter::RollIfNecessary(const Slice& next_enc_key) {
   DCHECK_EQ(state_, kStarted);
-  if (can_roll_ && cur_writer_->written_size() > target_rowset_size_) {
-    RETURN_NOT_OK(RollWriter());
+  if (!can_roll_ || cur_writer_->written_size() <= target_rowset_size_) {
+    return Status::OK();
+  }
+  const int32_t prefix_len = FLAGS_rowset_roll_key_prefix_length;
+  if (prefix_len <= 0) {
+    return RollWriter();
+  }
+
+  // Prefer to roll where the first 'prefix_len' bytes of the encoded key
+  // change, so that rowset boundaries line up with key-prefix boundaries and
+  // a scan restricted to a single prefix opens fewer rowsets. Rolling only
+  // happens between appended blocks, so the alignment is best-effort: a
+  // prefix change in the middle of a block can't be split on.
+  //
+  // Bound the overshoot, so that a prefix with more data than the target
+  // size can't produce an arbitrarily large rowset.
+  const size_t max_size = target_rowset_size_ +
+      target_rowset_size_ * FLAGS_rowset_roll_key_prefix_slack_pct / 100;
+  if (cur_writer_->written_size() > max_size) {
+    return RollWriter();
+  }
+  if (next_enc_key.empty()) {
+    // The caller doesn't know the next key; wait for a call which does.
+    return Status::OK();
+  }
+  Slice last_prefix = cur_writer_->last_encoded_key();
+  Slice next_prefix = next_enc_key;
+  last_prefix.truncate(std::min(static_cast<size_t>(prefix_len), last_prefix.size()));
+  next_prefix.truncate(std::min(static_cast<size_t>(prefix_len), next_prefix.size()));
+  if (next_prefix != last_prefix) {
+    return RollWriter();
   }
   return Status::OK();
 }
@@ -647,6 +731,13 @@ Status DiskRowSet::NewRowIterator(const Schema *projection,
   shared_lock<rw_spinlock> l(component_lock_);
 
   shared_ptr<CFileSet::Iterator> base_iter(base_data_->NewIterator(projection));
+  for (const ColumnId& col_id : base_data_->value_index_col_ids()) {
+    // A value index reflects only the base data, so it may be consulted
+    // only when no delta could change the column's values.
+    if (!delta_tracker_->MayHaveUpdatesForColumn(col_id)) {
+      base_iter->AddValueIndexSafeColumn(col_id);
+    }
+  }
   gscoped_ptr<ColumnwiseIterator> col_iter;
   RETURN_NOT_OK(delta_tracker_->WrapIterator(base_iter, mvcc_snap, &col_iter));
 
@@ -709,6 +800,15 @@ Status DiskRowSet::CheckRowPresent(const RowSetKeyProbe &probe,
   return Status::OK();
 }
 
+Status DiskRowSet::CheckKeyMaybePresent(const BloomKeyProbe& probe,
+                                        bool* maybe_present,
+                                        ProbeStats* stats) const {
+  DCHECK(open_);
+  shared_lock<rw_spinlock> l(component_lock_);
+
+  return base_data_->CheckKeyMaybePresent(probe, maybe_present, stats);
+}
+
 Status DiskRowSet::CountRows(rowid_t *count) const {
   DCHECK(open_);
   shared_lock<rw_spinlock> l(component_lock_);
@@ -723,6 +823,34 @@ Status DiskRowSet::GetBounds(std::string* min_encoded_key,
   return base_data_->GetBounds(min_encoded_key, max_encoded_key);
 }
 
+bool DiskRowSet::MayMatchColumnPredicates(const ScanSpec& spec) const {
+  DCHECK(open_);
+  if (!FLAGS_enable_rowset_column_stats_pruning) {
+    return true;
+  }
+  shared_lock<rw_spinlock> l(component_lock_);
+
+  const Schema& schema = rowset_metadata_->tablet_schema();
+  for (const auto& entry : spec.predicates()) {
+    const ColumnPredicate& pred = entry.second;
+    int col_idx = schema.find_column(pred.column().name());
+    if (col_idx == Schema::kColumnNotFound) {
+      continue;
+    }
+    ColumnId col_id = schema.column_id(col_idx);
+
+    // The base data's statistics only describe the current values; any
+    // deltas which could change the column make them unusable for pruning.
+    if (delta_tracker_->MayHaveUpdatesForColumn(col_id)) {
+      continue;
+    }
+    if (!base_data_->MayMatchColumnPredicate(col_id, pred)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void DiskRowSet::GetDiskRowSetSpaceUsage(DiskRowSetSpace* drss) const {
   DCHECK(open_);
   shared_lock<rw_spinlock> l(component_lock_);
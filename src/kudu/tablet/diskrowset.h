@@ -50,6 +50,7 @@
 #include "kudu/util/bloom_filter.h"
 #include "kudu/util/faststring.h"
 #include "kudu/util/locks.h"
+#include "kudu/util/slice.h"
 #include "kudu/util/status.h"
 
 namespace kudu {
@@ -92,8 +93,14 @@ class OperationResultPB;
 class DiskRowSetWriter {
  public:
   // TODO: document ownership of rowset_metadata
+  //
+  // If 'expected_size' is non-zero, it is the expected total on-disk size of
+  // the rowset's data in bytes. It is divided among the column writers and
+  // passed to the block manager as a preallocation hint, so that large
+  // rowsets (e.g. compaction outputs) are laid out contiguously on disk.
   DiskRowSetWriter(RowSetMetadata* rowset_metadata, const Schema* schema,
-                   BloomFilterSizing bloom_sizing);
+                   BloomFilterSizing bloom_sizing,
+                   int64_t expected_size = 0);
 
   ~DiskRowSetWriter();
 
@@ -114,7 +121,9 @@ class DiskRowSetWriter {
 
   // The base DiskRowSetWriter never rolls. This method is necessary for tests
   // which are templatized on the writer type.
-  Status RollIfNecessary() { return Status::OK(); }
+  Status RollIfNecessary(const Slice& /*next_enc_key*/ = Slice()) {
+    return Status::OK();
+  }
 
   rowid_t written_count() const {
     CHECK(finished_);
@@ -126,6 +135,11 @@ class DiskRowSetWriter {
   // a reasonable estimate for the total data size.
   size_t written_size() const;
 
+  // Return the encoded key of the last row appended, or an empty Slice if no
+  // rows have been appended yet. The returned Slice is only valid until the
+  // next call to AppendBlock().
+  Slice last_encoded_key() const { return Slice(last_encoded_key_); }
+
   const Schema& schema() const { return *schema_; }
 
  private:
@@ -146,6 +160,10 @@ class DiskRowSetWriter {
 
   BloomFilterSizing bloom_sizing_;
 
+  // See the constructor comment. May be 0 if the rowset's size is not
+  // known up front.
+  const int64_t expected_size_;
+
   bool finished_;
   rowid_t written_count_;
   gscoped_ptr<MultiColumnWriter> col_writer_;
@@ -205,7 +223,14 @@ class RollingDiskRowSetWriter {
   // of AppendBlock() doesn't call it automatically, because it doesn't know if there
   // is any more data to be appended. It is safe to call this in other circumstances --
   // it will be ignored if it is not a good time to roll.
-  Status RollIfNecessary();
+  //
+  // If --rowset_roll_key_prefix_length is set, 'next_enc_key' may be passed
+  // as the encoded key of the next row that will be appended; it is used to
+  // roll right where the configured key prefix changes, so that rowset
+  // boundaries line up with key-prefix boundaries. If the next key is not
+  // known, an empty Slice may be passed, in which case the roll is deferred
+  // until a later call provides one (or the size slack runs out).
+  Status RollIfNecessary(const Slice& next_enc_key = Slice());
 
   Status Finish();
 
@@ -310,6 +335,14 @@ class DiskRowSet : public RowSet {
   static const char *kMinKeyMetaEntryName;
   static const char *kMaxKeyMetaEntryName;
 
+  // Per-column statistics entries stored in each column cfile's footer
+  // metadata. The null count is always present on files written by versions
+  // which record statistics; the min/max values are absent if every cell in
+  // the column is NULL.
+  static const char *kColumnMinValueMetaEntryName;
+  static const char *kColumnMaxValueMetaEntryName;
+  static const char *kColumnNullCountMetaEntryName;
+
   // Open a rowset from disk.
   // If successful, sets *rowset to the newly open rowset
   static Status Open(const std::shared_ptr<RowSetMetadata>& rowset_metadata,
@@ -351,6 +384,10 @@ class DiskRowSet : public RowSet {
                          bool *present,
                          ProbeStats* stats) const OVERRIDE;
 
+  Status CheckKeyMaybePresent(const BloomKeyProbe& probe,
+                              bool* maybe_present,
+                              ProbeStats* stats) const OVERRIDE;
+
   ////////////////////
   // Read functions.
   ////////////////////
@@ -399,6 +436,12 @@ class DiskRowSet : public RowSet {
   Status DeleteAncientUndoDeltas(Timestamp ancient_history_mark,
                                  int64_t* blocks_deleted, int64_t* bytes_deleted) OVERRIDE;
 
+  bool MayHaveRowsChangedAtOrAfter(Timestamp ts) const OVERRIDE {
+    return delta_tracker_->MayHaveMutationsAtOrAfter(ts);
+  }
+
+  bool MayMatchColumnPredicates(const ScanSpec& spec) const OVERRIDE;
+
   // Major compacts all the delta files for all the columns.
   Status MajorCompactDeltaStores(HistoryGcOpts history_gc_opts);
 
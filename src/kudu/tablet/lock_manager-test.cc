@@ -105,6 +105,28 @@ TEST_F(LockManagerTest, TestRelockSameRow) {
   VerifyAlreadyLocked(key_a);
 }
 
+TEST_F(LockManagerTest, TestLockBatch) {
+  Slice key_a("a"), key_b("b"), key_c("c");
+  vector<Slice> keys = { key_a, key_b, key_b, key_c };
+
+  {
+    vector<ScopedRowLock> locks;
+    lock_manager_.LockBatch(keys, kFakeTransaction, &locks);
+    ASSERT_EQ(keys.size(), locks.size());
+    for (ScopedRowLock& l : locks) {
+      ASSERT_TRUE(l.acquired());
+    }
+    VerifyAlreadyLocked(key_a);
+    VerifyAlreadyLocked(key_b);
+    VerifyAlreadyLocked(key_c);
+  }
+
+  // All the locks (including both references to 'b') should have been
+  // released when the batch went out of scope.
+  ScopedRowLock relock(&lock_manager_, kFakeTransaction, key_b, LockManager::LOCK_EXCLUSIVE);
+  ASSERT_EQ(LockManager::LOCK_ACQUIRED, relock.GetLockStatusForTests());
+}
+
 TEST_F(LockManagerTest, TestMoveLock) {
   // Acquire a lock.
   Slice key_a("a");
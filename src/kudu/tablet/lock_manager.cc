@@ -21,6 +21,7 @@
 #include <mutex>
 #include <ostream>
 #include <string>
+#include <vector>
 
 #include <glog/logging.h>
 
@@ -125,6 +126,14 @@ class LockTable {
   }
 
   LockEntry *GetLockEntry(const Slice &key);
+
+  // Batch equivalent of GetLockEntry(): return entries for all of 'keys'
+  // (in the same order), taking the table-wide lock only once for the
+  // whole batch. Duplicate keys yield the same entry, with one reference
+  // taken per occurrence.
+  void GetLockEntries(const std::vector<Slice>& keys,
+                      std::vector<LockEntry*>* entries);
+
   void ReleaseLockEntry(LockEntry *entry);
 
  private:
@@ -143,6 +152,39 @@ class LockTable {
     return node;
   }
 
+  // Find an existing entry equal to 'new_entry', taking a reference on
+  // it, or else link 'new_entry' into its bucket. Returns the entry now
+  // referenced by the caller; if it is not 'new_entry', ownership of
+  // 'new_entry' remains with the caller.
+  // The caller must hold the table lock in shared mode.
+  LockEntry *FindOrInsertEntry(LockEntry *new_entry) {
+    Bucket *bucket = FindBucket(new_entry->key_hash_);
+    std::lock_guard<simple_spinlock> bucket_lock(bucket->lock);
+    LockEntry **node = FindSlot(bucket, new_entry->key_, new_entry->key_hash_);
+    LockEntry *old_entry = *node;
+    if (old_entry != nullptr) {
+      old_entry->refs_++;
+      return old_entry;
+    }
+    new_entry->ht_next_ = nullptr;
+    new_entry->CopyKey();
+    *node = new_entry;
+    return new_entry;
+  }
+
+  // Grow the table if the number of entries has outpaced the number of
+  // buckets. Only one thread resizes at a time; others simply skip it.
+  void MaybeResize(int64_t items_added) {
+    if (base::subtle::NoBarrier_AtomicIncrement(&item_count_, items_added) > size_) {
+      std::unique_lock<percpu_rwlock> table_wrlock(lock_, std::try_to_lock);
+      // if we can't take the lock, means that someone else is resizing.
+      // (The percpu_rwlock try_lock waits for readers to complete)
+      if (table_wrlock.owns_lock()) {
+        Resize();
+      }
+    }
+  }
+
   // Return a pointer to slot that points to a lock entry that
   // matches the specified 'entry'.
   // If there is no such lock entry, NULL is returned.
@@ -172,40 +214,50 @@ class LockTable {
 
 LockEntry *LockTable::GetLockEntry(const Slice& key) {
   auto new_entry = new LockEntry(key);
-  LockEntry *old_entry;
+  LockEntry *entry;
 
   {
     shared_lock<rw_spinlock> l(lock_.get_lock());
-    Bucket *bucket = FindBucket(new_entry->key_hash_);
-    {
-      std::lock_guard<simple_spinlock> bucket_lock(bucket->lock);
-      LockEntry **node = FindSlot(bucket, new_entry->key_, new_entry->key_hash_);
-      old_entry = *node;
-      if (old_entry != nullptr) {
-        old_entry->refs_++;
-      } else {
-        new_entry->ht_next_ = nullptr;
-        new_entry->CopyKey();
-        *node = new_entry;
-      }
-    }
+    entry = FindOrInsertEntry(new_entry);
   }
 
-  if (old_entry != nullptr) {
+  if (entry != new_entry) {
     delete new_entry;
-    return old_entry;
+    return entry;
+  }
+
+  MaybeResize(1);
+  return new_entry;
+}
+
+void LockTable::GetLockEntries(const std::vector<Slice>& keys,
+                               std::vector<LockEntry*>* entries) {
+  // Allocate the candidate entries up-front, outside the table lock.
+  std::vector<LockEntry*> new_entries;
+  new_entries.reserve(keys.size());
+  for (const Slice& key : keys) {
+    new_entries.push_back(new LockEntry(key));
   }
 
-  if (base::subtle::NoBarrier_AtomicIncrement(&item_count_, 1) > size_) {
-    std::unique_lock<percpu_rwlock> table_wrlock(lock_, std::try_to_lock);
-    // if we can't take the lock, means that someone else is resizing.
-    // (The percpu_rwlock try_lock waits for readers to complete)
-    if (table_wrlock.owns_lock()) {
-      Resize();
+  entries->clear();
+  entries->reserve(keys.size());
+  int64_t num_inserted = 0;
+  {
+    shared_lock<rw_spinlock> l(lock_.get_lock());
+    for (LockEntry* new_entry : new_entries) {
+      LockEntry* entry = FindOrInsertEntry(new_entry);
+      if (entry != new_entry) {
+        delete new_entry;
+      } else {
+        num_inserted++;
+      }
+      entries->push_back(entry);
     }
   }
 
-  return new_entry;
+  if (num_inserted > 0) {
+    MaybeResize(num_inserted);
+  }
 }
 
 void LockTable::ReleaseLockEntry(LockEntry *entry) {
@@ -289,6 +341,16 @@ ScopedRowLock::ScopedRowLock(LockManager *manager,
   }
 }
 
+ScopedRowLock::ScopedRowLock(LockManager *manager,
+                             LockEntry *entry,
+                             LockManager::LockStatus ls)
+  : manager_(DCHECK_NOTNULL(manager)),
+    acquired_(ls == LockManager::LOCK_ACQUIRED),
+    entry_(entry),
+    ls_(ls) {
+  CHECK_NE(ls_, LockManager::LOCK_BUSY);
+}
+
 ScopedRowLock::ScopedRowLock(ScopedRowLock&& other) {
   TakeState(&other);
 }
@@ -332,16 +394,27 @@ LockManager::~LockManager() {
   delete locks_;
 }
 
+// Number of times to retry a contended lock's semaphore before parking
+// the thread on it. A row lock is typically held only for the couple of
+// microseconds it takes to prepare and apply the holding operation, so a
+// short spin often avoids the syscall and wake-up latency of blocking.
+static const int kNumSpinAttempts = 100;
+
 LockManager::LockStatus LockManager::Lock(const Slice& key,
                                           const TransactionState* tx,
                                           LockManager::LockMode mode,
                                           LockEntry** entry) {
   *entry = locks_->GetLockEntry(key);
+  return AcquireLockOnEntry(key, tx, *entry);
+}
 
+LockManager::LockStatus LockManager::AcquireLockOnEntry(const Slice& key,
+                                                        const TransactionState* tx,
+                                                        LockEntry* entry) {
   // We expect low contention, so just try to try_lock first. This is faster
   // than a timed_lock, since we don't have to do a syscall to get the current
   // time.
-  if (!(*entry)->sem.TryAcquire()) {
+  if (!entry->sem.TryAcquire()) {
     // If the current holder of this lock is the same transaction just return
     // a LOCK_ALREADY_ACQUIRED status without actually acquiring the mutex.
     //
@@ -351,37 +424,69 @@ LockManager::LockStatus LockManager::Lock(const Slice& key,
     // obtained and released at the same time). If at any time in the future
     // we opt to perform more fine grained locking, possibly letting transactions
     // release a portion of the locks they no longer need, this no longer is OK.
-    if (ANNOTATE_UNPROTECTED_READ((*entry)->holder_) == tx) {
-      (*entry)->recursion_++;
+    if (ANNOTATE_UNPROTECTED_READ(entry->holder_) == tx) {
+      entry->recursion_++;
       return LOCK_ACQUIRED;
     }
 
-    // If we couldn't immediately acquire the lock, do a timed lock so we can
-    // warn if it takes a long time.
-    // TODO: would be nice to hook in some histogram metric about lock acquisition
-    // time. For now we just associate with per-request metrics.
-    TRACE_COUNTER_INCREMENT("row_lock_wait_count", 1);
-    MicrosecondsInt64 start_wait_us = GetMonoTimeMicros();
-    int waited_seconds = 0;
-    while (!(*entry)->sem.TimedAcquire(MonoDelta::FromSeconds(1))) {
-      const TransactionState* cur_holder = ANNOTATE_UNPROTECTED_READ((*entry)->holder_);
-      LOG(WARNING) << "Waited " << (++waited_seconds) << " seconds to obtain row lock on key "
-                   << KUDU_REDACT(key.ToDebugString()) << " cur holder: " << cur_holder;
-      // TODO(unknown): would be nice to also include some info about the blocking transaction,
-      // but it's a bit tricky to do in a non-racy fashion (the other transaction may
-      // complete at any point)
+    // Spin briefly before parking on the semaphore: on a hot key the
+    // holder is likely to release within a few hundred nanoseconds.
+    bool acquired = false;
+    for (int i = 0; i < kNumSpinAttempts; i++) {
+      base::subtle::PauseCPU();
+      if (entry->sem.TryAcquire()) {
+        acquired = true;
+        break;
+      }
     }
-    MicrosecondsInt64 wait_us = GetMonoTimeMicros() - start_wait_us;
-    TRACE_COUNTER_INCREMENT("row_lock_wait_us", wait_us);
-    if (wait_us > 100 * 1000) {
-      TRACE("Waited $0us for lock on $1", wait_us, KUDU_REDACT(key.ToDebugString()));
+
+    if (!acquired) {
+      // If we couldn't acquire the lock by spinning, do a timed lock so we can
+      // warn if it takes a long time.
+      // TODO: would be nice to hook in some histogram metric about lock acquisition
+      // time. For now we just associate with per-request metrics.
+      TRACE_COUNTER_INCREMENT("row_lock_wait_count", 1);
+      MicrosecondsInt64 start_wait_us = GetMonoTimeMicros();
+      int waited_seconds = 0;
+      while (!entry->sem.TimedAcquire(MonoDelta::FromSeconds(1))) {
+        const TransactionState* cur_holder = ANNOTATE_UNPROTECTED_READ(entry->holder_);
+        LOG(WARNING) << "Waited " << (++waited_seconds) << " seconds to obtain row lock on key "
+                     << KUDU_REDACT(key.ToDebugString()) << " cur holder: " << cur_holder;
+        // TODO(unknown): would be nice to also include some info about the blocking transaction,
+        // but it's a bit tricky to do in a non-racy fashion (the other transaction may
+        // complete at any point)
+      }
+      MicrosecondsInt64 wait_us = GetMonoTimeMicros() - start_wait_us;
+      TRACE_COUNTER_INCREMENT("row_lock_wait_us", wait_us);
+      if (wait_us > 100 * 1000) {
+        TRACE("Waited $0us for lock on $1", wait_us, KUDU_REDACT(key.ToDebugString()));
+      }
     }
   }
 
-  (*entry)->holder_ = tx;
+  entry->holder_ = tx;
   return LOCK_ACQUIRED;
 }
 
+void LockManager::LockBatch(const std::vector<Slice>& keys,
+                            const TransactionState* tx,
+                            std::vector<ScopedRowLock>* locks) {
+#ifndef NDEBUG
+  for (size_t i = 1; i < keys.size(); i++) {
+    DCHECK_LE(keys[i - 1].compare(keys[i]), 0) << "keys must be sorted";
+  }
+#endif
+  std::vector<LockEntry*> entries;
+  locks_->GetLockEntries(keys, &entries);
+
+  locks->clear();
+  locks->reserve(entries.size());
+  for (size_t i = 0; i < entries.size(); i++) {
+    LockStatus ls = AcquireLockOnEntry(keys[i], tx, entries[i]);
+    locks->push_back(ScopedRowLock(this, entries[i], ls));
+  }
+}
+
 LockManager::LockStatus LockManager::TryLock(const Slice& key,
                                              const TransactionState* tx,
                                              LockManager::LockMode mode,
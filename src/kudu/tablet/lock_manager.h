@@ -18,6 +18,7 @@
 #define KUDU_TABLET_LOCK_MANAGER_H
 
 #include <cstddef>
+#include <vector>
 
 #include "kudu/gutil/macros.h"
 #include "kudu/util/slice.h"
@@ -26,6 +27,7 @@ namespace kudu { namespace tablet {
 
 class LockTable;
 class LockEntry;
+class ScopedRowLock;
 class TransactionState;
 
 // Super-simple lock manager implementation. This only supports exclusive
@@ -49,6 +51,19 @@ class LockManager {
     LOCK_EXCLUSIVE
   };
 
+  // Acquire exclusive locks on all of 'keys' on behalf of 'tx', filling
+  // 'locks' with one held ScopedRowLock per key, in the same order.
+  //
+  // 'keys' must be in sorted order: acquiring in a consistent order
+  // ensures that concurrent batch acquirers cannot deadlock against each
+  // other. Duplicate keys are allowed and behave as if the same
+  // transaction locked the key twice.
+  //
+  // Compared to taking one ScopedRowLock per key, this walks the lock
+  // table only once for the whole batch.
+  void LockBatch(const std::vector<Slice>& keys, const TransactionState* tx,
+                 std::vector<ScopedRowLock>* locks);
+
  private:
   friend class ScopedRowLock;
   friend class LockManagerTest;
@@ -59,6 +74,12 @@ class LockManager {
                      LockMode mode, LockEntry **entry);
   void Release(LockEntry *lock, LockStatus ls);
 
+  // Acquire the semaphore of 'entry', whose reference must already be
+  // held by the caller. Spins briefly before falling back to a blocking
+  // wait. 'key' is used only for log messages.
+  LockStatus AcquireLockOnEntry(const Slice& key, const TransactionState* tx,
+                                LockEntry* entry);
+
   LockTable *locks_;
 
   DISALLOW_COPY_AND_ASSIGN(LockManager);
@@ -116,6 +137,12 @@ class ScopedRowLock {
   ~ScopedRowLock();
 
  private:
+  friend class LockManager;
+
+  // Adopt an already-acquired lock entry. Used by LockManager::LockBatch().
+  ScopedRowLock(LockManager* manager, LockEntry* entry,
+                LockManager::LockStatus ls);
+
   void TakeState(ScopedRowLock* other);
 
   LockManager *manager_;
@@ -375,6 +375,40 @@ TEST_F(TestMemRowSet, TestInsertCopiesToArena) {
   }
 }
 
+// Test the in-memory key bloom filter: it must answer "maybe present" for
+// every inserted key (including deleted ones) and reject probes for keys
+// that were never inserted.
+TEST_F(TestMemRowSet, TestKeyBloomFilter) {
+  shared_ptr<MemRowSet> mrs;
+  ASSERT_OK(MemRowSet::Create(0, schema_, log_anchor_registry_.get(),
+                              MemTracker::GetRootTracker(), &mrs));
+
+  RowBuilder rb(key_schema_);
+  rb.AddString(Slice("hello world"));
+  RowSetKeyProbe probe(rb.row());
+  ProbeStats stats;
+  bool maybe_present;
+
+  // An empty memrowset can reject any probe outright.
+  ASSERT_OK(mrs->CheckKeyMaybePresent(probe.bloom_probe(), &maybe_present, &stats));
+  EXPECT_FALSE(maybe_present);
+
+  ASSERT_OK(InsertRow(mrs.get(), "hello world", 1));
+  ASSERT_OK(mrs->CheckKeyMaybePresent(probe.bloom_probe(), &maybe_present, &stats));
+  EXPECT_TRUE(maybe_present);
+  EXPECT_GT(stats.blooms_consulted, 0);
+
+  // A deleted row stays in the filter; only the tree knows it's a ghost.
+  OperationResultPB result;
+  ASSERT_OK(DeleteRow(mrs.get(), "hello world", &result));
+  ASSERT_OK(mrs->CheckKeyMaybePresent(probe.bloom_probe(), &maybe_present, &stats));
+  EXPECT_TRUE(maybe_present);
+
+  bool present;
+  ASSERT_OK(CheckRowPresent(*mrs, "hello world", &present));
+  EXPECT_FALSE(present);
+}
+
 TEST_F(TestMemRowSet, TestDelete) {
   const char kRowKey[] = "hello world";
   bool present;
@@ -51,6 +51,16 @@ DEFINE_bool(mrs_use_codegen, true, "whether the memrowset should use code "
             "generation for iteration");
 TAG_FLAG(mrs_use_codegen, hidden);
 
+DEFINE_int32(memrowset_bloom_expected_keys, 250000,
+             "Expected number of keys per memrowset, used to size the "
+             "in-memory bloom filter which rejects update and delete probes "
+             "for keys that were never inserted. If a memrowset accumulates "
+             "more keys than this the filter's false positive rate degrades "
+             "gracefully. If 0, the filter is disabled and every probe "
+             "descends into the in-memory tree.");
+TAG_FLAG(memrowset_bloom_expected_keys, advanced);
+TAG_FLAG(memrowset_bloom_expected_keys, experimental);
+
 using std::shared_ptr;
 using std::string;
 using std::vector;
@@ -63,6 +73,10 @@ using strings::Substitute;
 
 static const int kInitialArenaSize = 16;
 
+// False positive rate the memrowset key bloom filter is sized for at
+// --memrowset_bloom_expected_keys keys.
+static const double kKeyBloomFPRate = 0.01;
+
 bool MRSRow::IsGhost() const {
   bool is_ghost = false;
   for (const Mutation *mut = header_->redo_head;
@@ -156,14 +170,29 @@ Status MemRowSet::Insert(Timestamp timestamp,
     schema_.EncodeComparableKey(row, &enc_key_buf);
     Slice enc_key(enc_key_buf);
 
-    btree::PreparedMutation<MSBTreeTraits> mutation(enc_key);
-    mutation.Prepare(&tree_);
-
     // TODO: for now, the key ends up stored doubly --
     // once encoded in the btree key, and again in the value
     // (unencoded).
     // That's not very memory-efficient!
 
+    // Copy the non-encoded key onto the stack since we need
+    // to mutate it when we relocate its Slices into our arena.
+    //
+    // The full row (including relocating its indirect data into the arena)
+    // is built before preparing the mutation so that the leaf lock taken by
+    // Prepare() covers only the btree insert itself. The leaf lock is the
+    // main point of contention between concurrent inserters, so keeping row
+    // materialization out of the critical section matters more than the
+    // arena copy wasted on the rare duplicate-key/reinsert path (the arena
+    // reclaims that memory wholesale with the rest of the MRS anyway).
+    DEFINE_MRSROW_ON_STACK(this, mrsrow, mrsrow_slice);
+    mrsrow.header_->insertion_timestamp = timestamp;
+    mrsrow.header_->redo_head = nullptr;
+    RETURN_NOT_OK(mrsrow.CopyRow(row, arena_.get()));
+
+    btree::PreparedMutation<MSBTreeTraits> mutation(enc_key);
+    mutation.Prepare(&tree_);
+
     if (mutation.exists()) {
       // It's OK for it to exist if it's just a "ghost" row -- i.e the
       // row is deleted.
@@ -176,12 +205,11 @@ Status MemRowSet::Insert(Timestamp timestamp,
       return Reinsert(timestamp, row, &ms_row);
     }
 
-    // Copy the non-encoded key onto the stack since we need
-    // to mutate it when we relocate its Slices into our arena.
-    DEFINE_MRSROW_ON_STACK(this, mrsrow, mrsrow_slice);
-    mrsrow.header_->insertion_timestamp = timestamp;
-    mrsrow.header_->redo_head = nullptr;
-    RETURN_NOT_OK(mrsrow.CopyRow(row, arena_.get()));
+    // Publish the key to the bloom filter before the row becomes visible
+    // in the tree, so that a probe can never see the row while missing
+    // the filter entry. A reinserted key is already in the filter from
+    // its original insert.
+    AddKeyToBloom(enc_key);
 
     CHECK(mutation.Insert(mrsrow_slice))
     << "Expected to be able to insert, since the prepared mutation "
@@ -219,6 +247,12 @@ Status MemRowSet::MutateRow(Timestamp timestamp,
                             const consensus::OpId& op_id,
                             ProbeStats* stats,
                             OperationResultPB *result) {
+  // A bloom miss means the key was never inserted here; skip the tree
+  // descent (and its leaf lock) entirely.
+  if (PREDICT_FALSE(!KeyMayBePresent(probe.bloom_probe(), stats))) {
+    return Status::NotFound("not in memrowset (bloom)");
+  }
+
   {
     btree::PreparedMutation<MSBTreeTraits> mutation(probe.encoded_key_slice());
     mutation.Prepare(&tree_);
@@ -255,8 +289,47 @@ Status MemRowSet::MutateRow(Timestamp timestamp,
   return Status::OK();
 }
 
+void MemRowSet::AddKeyToBloom(const Slice& enc_key) {
+  if (FLAGS_memrowset_bloom_expected_keys <= 0) {
+    return;
+  }
+  std::lock_guard<simple_spinlock> l(key_bloom_lock_);
+  if (PREDICT_FALSE(!key_bloom_)) {
+    key_bloom_.reset(new BloomFilterBuilder(
+        BloomFilterSizing::ByCountAndFPRate(FLAGS_memrowset_bloom_expected_keys,
+                                            kKeyBloomFPRate)));
+  }
+  key_bloom_->AddKey(BloomKeyProbe(enc_key));
+}
+
+bool MemRowSet::KeyMayBePresent(const BloomKeyProbe& probe, ProbeStats* stats) const {
+  std::lock_guard<simple_spinlock> l(key_bloom_lock_);
+  if (PREDICT_FALSE(!key_bloom_)) {
+    // Either the filter is disabled, or no row has ever been inserted:
+    // the filter is allocated by the first insert, so its absence with the
+    // feature enabled means the tree is empty.
+    return FLAGS_memrowset_bloom_expected_keys <= 0;
+  }
+  if (stats) {
+    stats->blooms_consulted++;
+  }
+  return BloomFilter(key_bloom_->slice(), key_bloom_->n_hashes())
+      .MayContainKey(probe);
+}
+
+Status MemRowSet::CheckKeyMaybePresent(const BloomKeyProbe& probe, bool* maybe_present,
+                                       ProbeStats* stats) const {
+  *maybe_present = KeyMayBePresent(probe, stats);
+  return Status::OK();
+}
+
 Status MemRowSet::CheckRowPresent(const RowSetKeyProbe &probe, bool *present,
                                   ProbeStats* stats) const {
+  if (PREDICT_FALSE(!KeyMayBePresent(probe.bloom_probe(), stats))) {
+    *present = false;
+    return Status::OK();
+  }
+
   // Use a PreparedMutation here even though we don't plan to mutate. Even though
   // this takes a lock rather than an optimistic copy, it should be a very short
   // critical section, and this call is only made on updates, which are rare.
@@ -485,6 +558,9 @@ Status MemRowSet::Iterator::NextBlock(RowBlock *dst) {
 }
 
 Status MemRowSet::Iterator::FetchRows(RowBlock* dst, size_t* fetched) {
+  // Rows inserted by the same batch share an insertion timestamp, so memoize
+  // the verdict of the last committed-check across the loop.
+  MvccCommittedChecker committed(&mvcc_snap_);
   *fetched = 0;
   do {
     Slice k, v;
@@ -497,7 +573,7 @@ Status MemRowSet::Iterator::FetchRows(RowBlock* dst, size_t* fetched) {
     iter_->GetCurrentEntry(&k, &v);
     MRSRow row(memrowset_.get(), v);
 
-    if (mvcc_snap_.IsCommitted(row.insertion_timestamp())) {
+    if (committed.IsCommitted(row.insertion_timestamp())) {
       if (has_upper_bound() && out_of_bounds(k)) {
         state_ = kFinished;
         break;
@@ -540,10 +616,13 @@ Status MemRowSet::Iterator::ApplyMutationsToProjectedRow(
 
   bool is_deleted = false;
 
+  // A transaction which updated several columns of this row leaves several
+  // mutations with the same timestamp, so memoize the last committed-check.
+  MvccCommittedChecker committed(&mvcc_snap_);
   for (const Mutation *mut = mutation_head;
        mut != nullptr;
        mut = mut->acquire_next()) {
-    if (!mvcc_snap_.IsCommitted(mut->timestamp_)) {
+    if (!committed.IsCommitted(mut->timestamp_)) {
       // Transaction which wasn't committed yet in the reader's snapshot.
       continue;
     }
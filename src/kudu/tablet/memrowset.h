@@ -43,7 +43,9 @@
 #include "kudu/tablet/mvcc.h"
 #include "kudu/tablet/rowset.h"
 #include "kudu/tablet/rowset_metadata.h"
+#include "kudu/util/bloom_filter.h"
 #include "kudu/util/faststring.h"
+#include "kudu/util/locks.h"
 #include "kudu/util/memory/arena.h"
 #include "kudu/util/monotime.h"
 #include "kudu/util/slice.h"
@@ -286,12 +288,17 @@ class MemRowSet : public RowSet,
   Status CheckRowPresent(const RowSetKeyProbe &probe, bool *present,
                          ProbeStats* stats) const OVERRIDE;
 
+  Status CheckKeyMaybePresent(const BloomKeyProbe& probe, bool* maybe_present,
+                              ProbeStats* stats) const OVERRIDE;
+
   // Return the memory footprint of this memrowset.
   // Note that this may be larger than the sum of the data
   // inserted into the memrowset, due to arena and data structure
   // overhead.
   size_t memory_footprint() const {
-    return arena_->memory_footprint();
+    std::lock_guard<simple_spinlock> l(key_bloom_lock_);
+    return arena_->memory_footprint() +
+        (key_bloom_ ? key_bloom_->n_bytes() : 0);
   }
 
   // Return an iterator over the items in this memrowset.
@@ -410,6 +417,17 @@ class MemRowSet : public RowSet,
                   const ConstContiguousRow& row,
                   MRSRow *ms_row);
 
+  // Add 'enc_key' to the key bloom filter, allocating the filter if this
+  // is the first key. No-op if the filter is disabled.
+  void AddKeyToBloom(const Slice& enc_key);
+
+  // Return true if a row with the given bloom probe may have been inserted
+  // into this memrowset, consulting only the key bloom filter. Returns
+  // true conservatively if the filter is disabled. Bumps
+  // 'stats->blooms_consulted' if the filter was consulted; 'stats' may be
+  // null.
+  bool KeyMayBePresent(const BloomKeyProbe& probe, ProbeStats* stats) const;
+
   typedef btree::CBTree<MSBTreeTraits> MSBTree;
 
   int64_t id_;
@@ -422,6 +440,18 @@ class MemRowSet : public RowSet,
 
   MSBTree tree_;
 
+  // Bloom filter over the encoded keys inserted into this memrowset.
+  // Updates probe CheckRowPresent()/MutateRow() on every overlapping
+  // rowset, and the memrowset otherwise answers each such probe with a
+  // full tree descent; a bloom miss rejects the probe up front. The
+  // filter is allocated by the first insert (sized for
+  // --memrowset_bloom_expected_keys) and is null if the feature is
+  // disabled. Deleted rows stay in the filter, which is safe: a hit only
+  // means the tree must be consulted. If inserts exceed the expected
+  // count the false positive rate degrades but correctness is unaffected.
+  mutable simple_spinlock key_bloom_lock_;
+  gscoped_ptr<BloomFilterBuilder> key_bloom_;
+
   // Approximate counts of mutations. This variable is updated non-atomically,
   // so it cannot be relied upon to be in any way accurate. It's only used
   // as a sanity check during flush.
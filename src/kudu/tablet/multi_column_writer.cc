@@ -17,21 +17,45 @@
 
 #include "kudu/tablet/multi_column_writer.h"
 
+#include <algorithm>
 #include <memory>
 #include <ostream>
 #include <string>
 #include <utility>
+#include <vector>
+
+#include <gflags/gflags.h>
 
 #include "kudu/cfile/cfile_util.h"
 #include "kudu/cfile/cfile_writer.h"
 #include "kudu/common/columnblock.h"
+#include "kudu/common/key_encoder.h"
 #include "kudu/common/rowblock.h"
 #include "kudu/common/schema.h"
+#include "kudu/common/types.h"
 #include "kudu/fs/block_id.h"
 #include "kudu/fs/block_manager.h"
 #include "kudu/fs/fs_manager.h"
+#include "kudu/gutil/endian.h"
 #include "kudu/gutil/gscoped_ptr.h"
 #include "kudu/gutil/stl_util.h"
+#include "kudu/gutil/strings/numbers.h"
+#include "kudu/gutil/strings/split.h"
+#include "kudu/tablet/diskrowset.h"
+#include "kudu/util/countdown_latch.h"
+#include "kudu/util/flag_tags.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/threadpool.h"
+
+DEFINE_string(rowset_value_index_columns, "",
+              "Comma-separated list of non-key column names for which to write a "
+              "per-rowset value index when flushing or compacting rowsets. A value "
+              "index is a cfile of (value, row ordinal) entries sorted by value, "
+              "which lets scans find the rows matching an equality predicate on "
+              "the column without scanning it. The entries are buffered in memory "
+              "until the rowset is finished.");
+TAG_FLAG(rowset_value_index_columns, advanced);
+TAG_FLAG(rowset_value_index_columns, experimental);
 
 namespace kudu {
 namespace tablet {
@@ -41,14 +65,46 @@ using fs::BlockCreationTransaction;
 using fs::CreateBlockOptions;
 using fs::WritableBlock;
 using std::unique_ptr;
+using std::vector;
+
+namespace {
+
+// Copy the value of 'cell' into 'dst'. For binary-typed columns this copies
+// the referenced data rather than the Slice itself, so the copy remains
+// valid after the source block is destroyed.
+void CopyCellValue(const TypeInfo* type_info, const void* cell, faststring* dst) {
+  if (type_info->physical_type() == BINARY) {
+    const Slice* s = reinterpret_cast<const Slice*>(cell);
+    dst->assign_copy(s->data(), s->size());
+  } else {
+    dst->assign_copy(reinterpret_cast<const uint8_t*>(cell), type_info->size());
+  }
+}
+
+// Compare 'cell' against a value previously stored by CopyCellValue().
+int CompareCellToStored(const TypeInfo* type_info, const void* cell,
+                        const faststring& stored) {
+  if (type_info->physical_type() == BINARY) {
+    Slice stored_slice(stored.data(), stored.size());
+    return type_info->Compare(cell, &stored_slice);
+  }
+  return type_info->Compare(cell, stored.data());
+}
+
+} // anonymous namespace
 
 MultiColumnWriter::MultiColumnWriter(FsManager* fs,
                                      const Schema* schema,
-                                     std::string tablet_id)
+                                     std::string tablet_id,
+                                     ThreadPool* pool,
+                                     int64_t column_expected_size)
   : fs_(fs),
     schema_(schema),
     finished_(false),
-    tablet_id_(std::move(tablet_id)) {
+    tablet_id_(std::move(tablet_id)),
+    pool_(pool),
+    column_expected_size_(column_expected_size),
+    written_count_(0) {
 }
 
 MultiColumnWriter::~MultiColumnWriter() {
@@ -59,7 +115,7 @@ Status MultiColumnWriter::Open() {
   CHECK(cfile_writers_.empty());
 
   // Open columns.
-  const CreateBlockOptions block_opts({ tablet_id_ });
+  const CreateBlockOptions block_opts({ tablet_id_, column_expected_size_ });
   for (int i = 0; i < schema_->num_columns(); i++) {
     const ColumnSchema &col = schema_->column(i);
 
@@ -100,21 +156,158 @@ Status MultiColumnWriter::Open() {
     cfile_writers_.push_back(writer.release());
     block_ids_.push_back(block_id);
   }
+  col_stats_.resize(schema_->num_columns());
   LOG(INFO) << "Opened CFile writers for " << cfile_writers_.size() << " column(s)";
 
+  // Designate the columns for which to accumulate value index entries.
+  for (StringPiece name : strings::Split(FLAGS_rowset_value_index_columns, ",",
+                                         strings::SkipEmpty())) {
+    int col_idx = schema_->find_column(name);
+    if (col_idx == Schema::kColumnNotFound) {
+      // The schema may simply predate (or omit) the column; not an error.
+      continue;
+    }
+    if (col_idx < schema_->num_key_columns()) {
+      LOG(WARNING) << "Not writing a value index for key column " << name
+                   << ": key columns are already indexed";
+      continue;
+    }
+    value_index_entries_[col_idx];
+  }
+
   return Status::OK();
 }
 
 Status MultiColumnWriter::AppendBlock(const RowBlock& block) {
-  for (int i = 0; i < schema_->num_columns(); i++) {
-    ColumnBlock column = block.column_block(i);
-    if (column.is_nullable()) {
-      RETURN_NOT_OK(cfile_writers_[i]->AppendNullableEntries(column.null_bitmap(),
-          column.data(), column.nrows()));
-    } else {
-      RETURN_NOT_OK(cfile_writers_[i]->AppendEntries(column.data(), column.nrows()));
+  if (!value_index_entries_.empty()) {
+    AppendValueIndexEntries(block);
+  }
+  written_count_ += block.nrows();
+
+  int num_cols = schema_->num_columns();
+  if (pool_ == nullptr || num_cols == 1) {
+    for (int i = 0; i < num_cols; i++) {
+      RETURN_NOT_OK(AppendColumn(i, block));
+    }
+    return Status::OK();
+  }
+
+  // Each column writes to its own cfile, so the appends can proceed
+  // independently; the latch acts as the merge barrier.
+  vector<Status> results(num_cols);
+  CountDownLatch latch(num_cols);
+  for (int i = 0; i < num_cols; i++) {
+    Status submit = pool_->SubmitFunc([this, i, &block, &results, &latch]() {
+      results[i] = AppendColumn(i, block);
+      latch.CountDown();
+    });
+    if (!submit.ok()) {
+      // The pool is shutting down or its queue is full; fall back to
+      // appending this column in the calling thread.
+      results[i] = AppendColumn(i, block);
+      latch.CountDown();
+    }
+  }
+  latch.Wait();
+  for (const Status& s : results) {
+    RETURN_NOT_OK(s);
+  }
+  return Status::OK();
+}
+
+Status MultiColumnWriter::AppendColumn(int col_idx, const RowBlock& block) {
+  ColumnBlock column = block.column_block(col_idx);
+  UpdateColumnStats(col_idx, column);
+  if (column.is_nullable()) {
+    return cfile_writers_[col_idx]->AppendNullableEntries(column.null_bitmap(),
+        column.data(), column.nrows());
+  }
+  return cfile_writers_[col_idx]->AppendEntries(column.data(), column.nrows());
+}
+
+void MultiColumnWriter::UpdateColumnStats(int col_idx, const ColumnBlock& column) {
+  ColumnStats* stats = &col_stats_[col_idx];
+  const TypeInfo* type_info = schema_->column(col_idx).type_info();
+  for (size_t i = 0; i < column.nrows(); i++) {
+    if (column.is_nullable() && column.is_null(i)) {
+      stats->null_count++;
+      continue;
+    }
+    const void* cell = column.cell_ptr(i);
+    if (!stats->has_values) {
+      CopyCellValue(type_info, cell, &stats->min_value);
+      CopyCellValue(type_info, cell, &stats->max_value);
+      stats->has_values = true;
+    } else if (CompareCellToStored(type_info, cell, stats->min_value) < 0) {
+      CopyCellValue(type_info, cell, &stats->min_value);
+    } else if (CompareCellToStored(type_info, cell, stats->max_value) > 0) {
+      CopyCellValue(type_info, cell, &stats->max_value);
+    }
+  }
+}
+
+void MultiColumnWriter::AppendValueIndexEntries(const RowBlock& block) {
+  faststring enc;
+  for (auto& e : value_index_entries_) {
+    const int col_idx = e.first;
+    ColumnBlock column = block.column_block(col_idx);
+    const TypeInfo* type_info = schema_->column(col_idx).type_info();
+    const KeyEncoder<faststring>& encoder = GetKeyEncoder<faststring>(type_info);
+    for (size_t i = 0; i < column.nrows(); i++) {
+      if (column.is_nullable() && column.is_null(i)) {
+        // A NULL cell can never match an equality predicate.
+        continue;
+      }
+      // Encode the value with the composite-key encoding, which is
+      // order-preserving and prefix-free, followed by the row's ordinal in
+      // big-endian form: sorting the entries as raw bytes then yields
+      // (value, ordinal) order, and a value can be matched against an
+      // entry's prefix without any risk of ambiguity.
+      enc.clear();
+      encoder.Encode(column.cell_ptr(i), /*is_last=*/false, &enc);
+      uint8_t ordinal[sizeof(uint32_t)];
+      BigEndian::Store32(ordinal, written_count_ + i);
+      enc.append(ordinal, sizeof(ordinal));
+      e.second.emplace_back(reinterpret_cast<const char*>(enc.data()), enc.size());
     }
   }
+}
+
+Status MultiColumnWriter::WriteValueIndexes(BlockCreationTransaction* transaction) {
+  const CreateBlockOptions block_opts({ tablet_id_ });
+  for (auto& e : value_index_entries_) {
+    const int col_idx = e.first;
+    vector<std::string>* entries = &e.second;
+    std::sort(entries->begin(), entries->end());
+
+    cfile::WriterOptions opts;
+    // The index is consulted by value, so it needs its own value index and
+    // plain storage: the entries are already as compact as sorting allows,
+    // and must support binary search within a block.
+    opts.write_validx = true;
+    opts.storage_attributes.encoding = PLAIN_ENCODING;
+
+    unique_ptr<WritableBlock> block;
+    RETURN_NOT_OK_PREPEND(fs_->CreateNewBlock(block_opts, &block),
+                          "Unable to open value index block for column " +
+                          schema_->column(col_idx).ToString());
+    BlockId block_id(block->id());
+
+    CFileWriter writer(opts, GetTypeInfo(BINARY), false, std::move(block));
+    RETURN_NOT_OK(writer.Start());
+    vector<Slice> slices;
+    slices.reserve(entries->size());
+    for (const std::string& entry : *entries) {
+      slices.emplace_back(entry);
+    }
+    RETURN_NOT_OK(writer.AppendEntries(slices.data(), slices.size()));
+    RETURN_NOT_OK_PREPEND(writer.FinishAndReleaseBlock(transaction),
+                          "Unable to Finish value index writer for column " +
+                          schema_->column(col_idx).ToString());
+
+    value_index_blocks_[schema_->column_id(col_idx)] = block_id;
+    STLClearObject(entries);
+  }
   return Status::OK();
 }
 
@@ -123,6 +316,20 @@ Status MultiColumnWriter::FinishAndReleaseBlocks(
   CHECK(!finished_);
   for (int i = 0; i < schema_->num_columns(); i++) {
     CFileWriter *writer = cfile_writers_[i];
+
+    // Record the column statistics in the cfile footer; readers use them
+    // as zone maps to prune rowsets whose value ranges can't satisfy a
+    // scan's predicates.
+    const ColumnStats& stats = col_stats_[i];
+    writer->AddMetadataPair(DiskRowSet::kColumnNullCountMetaEntryName,
+                            SimpleItoa(stats.null_count));
+    if (stats.has_values) {
+      writer->AddMetadataPair(DiskRowSet::kColumnMinValueMetaEntryName,
+                              Slice(stats.min_value));
+      writer->AddMetadataPair(DiskRowSet::kColumnMaxValueMetaEntryName,
+                              Slice(stats.max_value));
+    }
+
     Status s = writer->FinishAndReleaseBlock(transaction);
     if (!s.ok()) {
       LOG(WARNING) << "Unable to Finish writer for column " <<
@@ -130,6 +337,7 @@ Status MultiColumnWriter::FinishAndReleaseBlocks(
       return s;
     }
   }
+  RETURN_NOT_OK(WriteValueIndexes(transaction));
   finished_ = true;
   return Status::OK();
 }
@@ -142,6 +350,12 @@ void MultiColumnWriter::GetFlushedBlocksByColumnId(std::map<ColumnId, BlockId>*
   }
 }
 
+void MultiColumnWriter::GetFlushedValueIndexBlocksByColumnId(
+    std::map<ColumnId, BlockId>* ret) const {
+  CHECK(finished_);
+  *ret = value_index_blocks_;
+}
+
 size_t MultiColumnWriter::written_size() const {
   size_t size = 0;
   for (const CFileWriter *writer : cfile_writers_) {
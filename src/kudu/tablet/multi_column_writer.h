@@ -18,21 +18,26 @@
 #define KUDU_TABLET_MULTI_COLUMN_WRITER_H
 
 #include <cstddef>
+#include <cstdint>
 #include <map>
 #include <string>
 #include <vector>
 
 #include <glog/logging.h>
 
+#include "kudu/common/rowid.h"
 #include "kudu/fs/block_id.h"
 #include "kudu/gutil/macros.h"
+#include "kudu/util/faststring.h"
 #include "kudu/util/status.h"
 
 namespace kudu {
 
+class ColumnBlock;
 class FsManager;
 class RowBlock;
 class Schema;
+class ThreadPool;
 struct ColumnId;
 
 namespace cfile {
@@ -49,9 +54,19 @@ namespace tablet {
 // Schema. Written blocks will fall in the tablet_id's data dir group.
 class MultiColumnWriter {
  public:
+  // If 'pool' is non-NULL, AppendBlock() encodes and appends the columns on
+  // it in parallel rather than serially in the calling thread; each column's
+  // cfile is written independently, so the appends don't contend. The pool
+  // must outlive this object.
+  //
+  // If 'column_expected_size' is non-zero, it is passed to the block manager
+  // as a size hint when each column's block is created, allowing the on-disk
+  // space to be preallocated contiguously.
   MultiColumnWriter(FsManager* fs,
                     const Schema* schema,
-                    std::string tablet_id);
+                    std::string tablet_id,
+                    ThreadPool* pool = nullptr,
+                    int64_t column_expected_size = 0);
 
   virtual ~MultiColumnWriter();
 
@@ -80,7 +95,41 @@ class MultiColumnWriter {
   // REQUIRES: Finish() already called.
   void GetFlushedBlocksByColumnId(std::map<ColumnId, BlockId>* ret) const;
 
+  // Return the block IDs of the written value indexes, keyed by column ID.
+  // Empty unless --rowset_value_index_columns designates columns present
+  // in the schema.
+  //
+  // REQUIRES: Finish() already called.
+  void GetFlushedValueIndexBlocksByColumnId(std::map<ColumnId, BlockId>* ret) const;
+
  private:
+  // Min/max/null-count statistics for one output column, accumulated as
+  // blocks are appended. The min and max hold copies of the smallest and
+  // largest non-null values seen so far: the raw cell bytes for fixed-size
+  // types, or the referenced data for binary-typed columns.
+  struct ColumnStats {
+    ColumnStats() : null_count(0), has_values(false) {}
+
+    faststring min_value;
+    faststring max_value;
+    uint64_t null_count;
+    bool has_values;
+  };
+
+  // Append the given block's column 'col_idx' to that column's cfile.
+  Status AppendColumn(int col_idx, const RowBlock& block);
+
+  // Accumulate (value, row ordinal) entries from the given block for each
+  // column designated for a value index.
+  void AppendValueIndexEntries(const RowBlock& block);
+
+  // Sort the accumulated entries for each designated column and write them
+  // out as one cfile per column, releasing the blocks to 'transaction'.
+  Status WriteValueIndexes(fs::BlockCreationTransaction* transaction);
+
+  // Fold the values in 'column' into 'col_stats_[col_idx]'.
+  void UpdateColumnStats(int col_idx, const ColumnBlock& column);
+
   FsManager* const fs_;
   const Schema* const schema_;
 
@@ -88,9 +137,35 @@ class MultiColumnWriter {
 
   const std::string tablet_id_;
 
+  // Pool on which to parallelize AppendBlock(), or NULL for serial appends.
+  ThreadPool* const pool_;
+
+  // Expected size of each column's block in bytes, or 0 if not known.
+  // Passed to the block manager as a preallocation hint.
+  const int64_t column_expected_size_;
+
   std::vector<cfile::CFileWriter *> cfile_writers_;
   std::vector<BlockId> block_ids_;
 
+  // Per-column statistics, parallel to 'cfile_writers_'. Written into each
+  // column's cfile footer when the writers are finished, where they serve
+  // as zone maps for rowset pruning (see CFileSet::MayMatchColumnPredicate).
+  std::vector<ColumnStats> col_stats_;
+
+  // The number of rows appended so far, i.e. the ordinal of the next row.
+  rowid_t written_count_;
+
+  // Value index entries accumulated for each column designated by
+  // --rowset_value_index_columns, keyed by column index. Each entry is the
+  // order-preserving encoding of a cell's value followed by the row's
+  // ordinal as a big-endian 32-bit integer, so a lexicographic sort yields
+  // (value, ordinal) order. NULL cells have no entry.
+  std::map<int, std::vector<std::string>> value_index_entries_;
+
+  // Block IDs of the written value indexes, keyed by column ID.
+  // Populated by WriteValueIndexes().
+  std::map<ColumnId, BlockId> value_index_blocks_;
+
   DISALLOW_COPY_AND_ASSIGN(MultiColumnWriter);
 };
 
@@ -303,6 +303,21 @@ TEST_F(MvccTest, TestPointInTimeSnapshot) {
   ASSERT_FALSE(snap.IsCommitted(Timestamp(11)));
 }
 
+TEST_F(MvccTest, TestCommittedChecker) {
+  MvccSnapshot snap(Timestamp(10));
+  MvccCommittedChecker checker(&snap);
+
+  // The checker must agree with the snapshot, including when the same
+  // timestamp is queried repeatedly (the memoized path).
+  ASSERT_TRUE(checker.IsCommitted(Timestamp(1)));
+  ASSERT_TRUE(checker.IsCommitted(Timestamp(1)));
+  ASSERT_TRUE(checker.IsCommitted(Timestamp(9)));
+  ASSERT_FALSE(checker.IsCommitted(Timestamp(10)));
+  ASSERT_FALSE(checker.IsCommitted(Timestamp(10)));
+  ASSERT_TRUE(checker.IsCommitted(Timestamp(9)));
+  ASSERT_FALSE(checker.IsCommitted(Timestamp(11)));
+}
+
 TEST_F(MvccTest, TestMayHaveCommittedTransactionsAtOrAfter) {
   MvccSnapshot snap;
   snap.all_committed_before_ = Timestamp(10);
@@ -156,6 +156,40 @@ class MvccSnapshot {
 
 };
 
+// Helper for call sites which test one timestamp per mutation in a tight
+// loop (e.g. rolling forward a row's redo list during a scan, or filtering
+// a DeltaMemStore batch). Equivalent to calling IsCommitted() on the
+// wrapped snapshot for every timestamp, but memoizes the last verdict:
+// consecutive mutations very often carry the same timestamp (a single
+// transaction applying several mutations, or a batch of inserts), in which
+// case only a single comparison is needed instead of re-consulting the
+// snapshot's watermarks and, for timestamps in the in-flight window, its
+// committed-timestamps list.
+//
+// Not thread-safe; intended to be instantiated per-loop or per-iterator.
+class MvccCommittedChecker {
+ public:
+  explicit MvccCommittedChecker(const MvccSnapshot* snap)
+    : snap_(snap),
+      last_ts_(Timestamp::kInvalidTimestamp.value()),
+      last_verdict_(false) {
+  }
+
+  inline bool IsCommitted(const Timestamp& timestamp) {
+    if (PREDICT_TRUE(timestamp.value() == last_ts_)) {
+      return last_verdict_;
+    }
+    last_ts_ = timestamp.value();
+    last_verdict_ = snap_->IsCommitted(timestamp);
+    return last_verdict_;
+  }
+
+ private:
+  const MvccSnapshot* const snap_;
+  Timestamp::val_type last_ts_;
+  bool last_verdict_;
+};
+
 // Coordinator of MVCC transactions. Threads wishing to make updates use
 // the MvccManager to obtain a unique timestamp, usually through the ScopedTransaction
 // class defined below.
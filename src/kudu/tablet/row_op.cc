@@ -42,6 +42,9 @@ RowOp::RowOp(DecodedRowOperation decoded_op)
 }
 
 RowOp::~RowOp() {
+  if (key_probe != nullptr) {
+    key_probe->~RowSetKeyProbe();
+  }
 }
 
 void RowOp::SetFailed(const Status& s) {
@@ -80,7 +80,10 @@ struct RowOp {
   // The key probe structure contains the row key in both key-encoded and
   // ContiguousRow formats, bloom probe structure, etc. This is set during
   // the "prepare" phase.
-  gscoped_ptr<RowSetKeyProbe> key_probe;
+  //
+  // Allocated from the transaction's arena (like the RowOp itself), so
+  // only its destructor is run when the RowOp is destroyed.
+  RowSetKeyProbe* key_probe = nullptr;
 
   // The row lock which has been acquired for this row. Set during the "prepare"
   // phase.
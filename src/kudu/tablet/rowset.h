@@ -45,6 +45,7 @@ namespace kudu {
 class MonoTime; // IWYU pragma: keep
 class RowChangeList;
 class RowwiseIterator;
+class ScanSpec;
 class Schema;
 class Slice;
 
@@ -78,6 +79,19 @@ class RowSet {
   virtual Status CheckRowPresent(const RowSetKeyProbe &probe, bool *present,
                                  ProbeStats* stats) const = 0;
 
+  // Check if a row with the given bloom probe may ever have been inserted
+  // into this rowset, consulting only bloom filters.
+  //
+  // Unlike CheckRowPresent(), a row which has since been deleted is still
+  // considered present, so a false result is safe for culling rowsets from
+  // scans at any snapshot. May conservatively set *maybe_present = true.
+  virtual Status CheckKeyMaybePresent(const BloomKeyProbe& /*probe*/,
+                                      bool* maybe_present,
+                                      ProbeStats* /*stats*/) const {
+    *maybe_present = true;
+    return Status::OK();
+  }
+
   // Update/delete a row in this rowset.
   // The 'update_schema' is the client schema used to encode the 'update' RowChangeList.
   //
@@ -231,6 +245,24 @@ class RowSet {
     return try_lock.owns_lock();
   }
 
+  // Return true if this RowSet may contain rows which were inserted,
+  // updated, or deleted at a timestamp greater than or equal to 'ts'.
+  // The check is conservative: implementations may return true even if
+  // no such row exists, but must never return false if one does. Used
+  // by diff scans to skip rowsets untouched since the start snapshot.
+  virtual bool MayHaveRowsChangedAtOrAfter(Timestamp ts) const {
+    return true;
+  }
+
+  // Return true if any row in this RowSet might match all of the column
+  // predicates in 'spec', consulting per-column min/max statistics where
+  // they are available. The check is conservative: implementations may
+  // return true even if no row matches, but a false result means the whole
+  // RowSet can be skipped by the scan, at any snapshot.
+  virtual bool MayMatchColumnPredicates(const ScanSpec& /*spec*/) const {
+    return true;
+  }
+
 };
 
 // Used often enough, may as well typedef it.
@@ -245,8 +277,20 @@ class RowSetKeyProbe {
   // NOTE: row_key is not copied and must be valid for the lifetime
   // of this object.
   explicit RowSetKeyProbe(ConstContiguousRow row_key)
-      : row_key_(row_key) {
-    encoded_key_ = EncodedKey::FromContiguousRow(row_key_);
+      : row_key_(row_key),
+        encoded_key_(EncodedKey::FromContiguousRow(row_key_).release()),
+        arena_backed_(false) {
+    bloom_probe_ = BloomKeyProbe(encoded_key_slice());
+  }
+
+  // As above, but allocates the encoded key and its storage from 'arena'
+  // rather than the heap. This is used on the write hot path, where probes
+  // are constructed per operation and the transaction's arena outlives them.
+  // The probe's destructor must still be run before the arena is reset.
+  RowSetKeyProbe(ConstContiguousRow row_key, Arena* arena)
+      : row_key_(row_key),
+        encoded_key_(EncodedKey::FromContiguousRow(row_key_, arena)),
+        arena_backed_(true) {
     bloom_probe_ = BloomKeyProbe(encoded_key_slice());
   }
 
@@ -256,11 +300,25 @@ class RowSetKeyProbe {
   // Still, the ConstContiguousRow row_key_ remains a reference to the data
   // underlying the original RowsetKeyProbe and is not copied.
   explicit RowSetKeyProbe(const RowSetKeyProbe& probe)
-  : row_key_(probe.row_key_) {
-    encoded_key_ = EncodedKey::FromContiguousRow(row_key_);
+      : row_key_(probe.row_key_),
+        encoded_key_(EncodedKey::FromContiguousRow(row_key_).release()),
+        arena_backed_(false) {
     bloom_probe_ = BloomKeyProbe(encoded_key_slice());
   }
 
+  RowSetKeyProbe& operator=(const RowSetKeyProbe&) = delete;
+
+  ~RowSetKeyProbe() {
+    if (arena_backed_) {
+      // The object's storage belongs to the arena; just run the destructor.
+      if (encoded_key_ != nullptr) {
+        encoded_key_->~EncodedKey();
+      }
+    } else {
+      delete encoded_key_;
+    }
+  }
+
   const ConstContiguousRow& row_key() const { return row_key_; }
 
   // Pointer to the key which has been encoded to be contiguous
@@ -279,7 +337,8 @@ class RowSetKeyProbe {
 
  private:
   const ConstContiguousRow row_key_;
-  gscoped_ptr<EncodedKey> encoded_key_;
+  EncodedKey* const encoded_key_;
+  const bool arena_backed_;
   BloomKeyProbe bloom_probe_;
 };
 
@@ -96,6 +96,13 @@ void RowSetMetadata::LoadFromPB(const RowSetDataPB& pb) {
     blocks_by_col_id_[col_id] = BlockId::FromPB(col_pb.block());
   }
 
+  // Load value index files.
+  value_index_blocks_by_col_id_.clear();
+  for (const ColumnDataPB& col_pb : pb.value_index_blocks()) {
+    ColumnId col_id = ColumnId(col_pb.column_id());
+    value_index_blocks_by_col_id_[col_id] = BlockId::FromPB(col_pb.block());
+  }
+
   // Load redo delta files.
   redo_delta_blocks_.clear();
   for (const DeltaDataPB& redo_delta_pb : pb.redo_deltas()) {
@@ -126,6 +133,13 @@ void RowSetMetadata::ToProtobuf(RowSetDataPB *pb) {
     col_data->set_column_id(col_id);
   }
 
+  // Write Value Index Files
+  for (const ColumnIdToBlockIdMap::value_type& e : value_index_blocks_by_col_id_) {
+    ColumnDataPB *idx_data = pb->add_value_index_blocks();
+    e.second.CopyToPB(idx_data->mutable_block());
+    idx_data->set_column_id(e.first);
+  }
+
   // Write Delta Files
   pb->set_last_durable_dms_id(last_durable_redo_dms_id_);
 
@@ -157,21 +171,44 @@ const std::string RowSetMetadata::ToString() const {
 void RowSetMetadata::SetColumnDataBlocks(const std::map<ColumnId, BlockId>& blocks_by_col_id) {
   ColumnIdToBlockIdMap new_map(blocks_by_col_id.begin(), blocks_by_col_id.end());
   new_map.shrink_to_fit();
-  std::lock_guard<LockType> l(lock_);
-  blocks_by_col_id_ = std::move(new_map);
+  {
+    std::lock_guard<LockType> l(lock_);
+    blocks_by_col_id_ = std::move(new_map);
+  }
+  // NOTE: marked dirty outside of 'lock_' since the tablet metadata may
+  // serialize this rowset (taking 'lock_') while holding its own lock.
+  tablet_metadata_->MarkRowSetMetadataDirty(id_);
+}
+
+void RowSetMetadata::SetValueIndexBlocks(const std::map<ColumnId, BlockId>& blocks_by_col_id) {
+  ColumnIdToBlockIdMap new_map(blocks_by_col_id.begin(), blocks_by_col_id.end());
+  new_map.shrink_to_fit();
+  {
+    std::lock_guard<LockType> l(lock_);
+    value_index_blocks_by_col_id_ = std::move(new_map);
+  }
+  // NOTE: marked dirty outside of 'lock_' since the tablet metadata may
+  // serialize this rowset (taking 'lock_') while holding its own lock.
+  tablet_metadata_->MarkRowSetMetadataDirty(id_);
 }
 
 Status RowSetMetadata::CommitRedoDeltaDataBlock(int64_t dms_id,
                                                 const BlockId& block_id) {
-  std::lock_guard<LockType> l(lock_);
-  last_durable_redo_dms_id_ = dms_id;
-  redo_delta_blocks_.push_back(block_id);
+  {
+    std::lock_guard<LockType> l(lock_);
+    last_durable_redo_dms_id_ = dms_id;
+    redo_delta_blocks_.push_back(block_id);
+  }
+  tablet_metadata_->MarkRowSetMetadataDirty(id_);
   return Status::OK();
 }
 
 Status RowSetMetadata::CommitUndoDeltaDataBlock(const BlockId& block_id) {
-  std::lock_guard<LockType> l(lock_);
-  undo_delta_blocks_.push_back(block_id);
+  {
+    std::lock_guard<LockType> l(lock_);
+    undo_delta_blocks_.push_back(block_id);
+  }
+  tablet_metadata_->MarkRowSetMetadataDirty(id_);
   return Status::OK();
 }
 
@@ -241,16 +278,29 @@ void RowSetMetadata::CommitUpdate(const RowSetMetadataUpdate& update,
       if (UpdateReturnCopy(&blocks_by_col_id_, e.first, e.second, &old_block_id)) {
         removed->push_back(old_block_id);
       }
+      // The column's value index (if any) describes the replaced base data
+      // and is now stale; drop it.
+      BlockId old_value_index;
+      if (FindCopy(value_index_blocks_by_col_id_, e.first, &old_value_index)) {
+        value_index_blocks_by_col_id_.erase(e.first);
+        removed->push_back(old_value_index);
+      }
     }
 
     for (const ColumnId& col_id : update.col_ids_to_remove_) {
       BlockId old = FindOrDie(blocks_by_col_id_, col_id);
       CHECK_EQ(1, blocks_by_col_id_.erase(col_id));
       removed->push_back(old);
+      BlockId old_value_index;
+      if (FindCopy(value_index_blocks_by_col_id_, col_id, &old_value_index)) {
+        value_index_blocks_by_col_id_.erase(col_id);
+        removed->push_back(old_value_index);
+      }
     }
   }
 
   blocks_by_col_id_.shrink_to_fit();
+  tablet_metadata_->MarkRowSetMetadataDirty(id_);
 }
 
 vector<BlockId> RowSetMetadata::GetAllBlocks() {
@@ -263,6 +313,7 @@ vector<BlockId> RowSetMetadata::GetAllBlocks() {
     blocks.push_back(bloom_block_);
   }
   AppendValuesFromMap(blocks_by_col_id_, &blocks);
+  AppendValuesFromMap(value_index_blocks_by_col_id_, &blocks);
 
   blocks.insert(blocks.end(),
                 undo_delta_blocks_.begin(), undo_delta_blocks_.end());
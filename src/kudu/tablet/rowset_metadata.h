@@ -115,6 +115,10 @@ class RowSetMetadata {
 
   void SetColumnDataBlocks(const std::map<ColumnId, BlockId>& blocks_by_col_id);
 
+  // Set the value index blocks written alongside the column data blocks.
+  // See RowSetDataPB.value_index_blocks.
+  void SetValueIndexBlocks(const std::map<ColumnId, BlockId>& blocks_by_col_id);
+
   Status CommitRedoDeltaDataBlock(int64_t dms_id, const BlockId& block_id);
 
   Status CommitUndoDeltaDataBlock(const BlockId& block_id);
@@ -144,6 +148,11 @@ class RowSetMetadata {
     return blocks_by_col_id_;
   }
 
+  ColumnIdToBlockIdMap GetValueIndexBlocksById() const {
+    std::lock_guard<LockType> l(lock_);
+    return value_index_blocks_by_col_id_;
+  }
+
   std::vector<BlockId> redo_delta_blocks() const {
     std::lock_guard<LockType> l(lock_);
     return redo_delta_blocks_;
@@ -224,6 +233,11 @@ class RowSetMetadata {
 
   // Map of column ID to block ID.
   ColumnIdToBlockIdMap blocks_by_col_id_;
+
+  // Map of column ID to value index block ID, for the columns which have
+  // one. A value index reflects the column's base data exactly, so it is
+  // dropped whenever the column's cfile is replaced or removed.
+  ColumnIdToBlockIdMap value_index_blocks_by_col_id_;
   std::vector<BlockId> redo_delta_blocks_;
   std::vector<BlockId> undo_delta_blocks_;
 
@@ -25,6 +25,7 @@
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
+#include "kudu/gutil/basictypes.h"
 #include "kudu/gutil/map-util.h"
 #include "kudu/gutil/stringprintf.h"
 #include "kudu/tablet/mock-rowsets.h"
@@ -112,6 +113,54 @@ TEST_F(TestRowSetTree, TestTree) {
   ASSERT_EQ(vec[2].get(), out[3]);
 }
 
+// Exercise keys around the 8-byte cached-prefix boundary: keys shorter than
+// a word, keys sharing a long common prefix, and keys which differ only
+// beyond the first word.
+TEST_F(TestRowSetTree, TestShortAndLongKeys) {
+  RowSetVector vec;
+  vec.push_back(shared_ptr<RowSet>(new MockDiskRowSet("a", "ab")));
+  vec.push_back(shared_ptr<RowSet>(new MockDiskRowSet("ab", "abcdefghij")));
+  vec.push_back(shared_ptr<RowSet>(new MockDiskRowSet("abcdefgh_0000",
+                                                      "abcdefgh_5000")));
+  vec.push_back(shared_ptr<RowSet>(new MockDiskRowSet("abcdefgh_5000",
+                                                      "abcdefgh_9999")));
+
+  RowSetTree tree;
+  ASSERT_OK(tree.Reset(vec));
+
+  // A key shorter than 8 bytes only hits the short-key rowsets.
+  vector<RowSet *> out;
+  tree.FindRowSetsWithKeyInRange("aa", &out);
+  ASSERT_EQ(1, out.size());
+  ASSERT_EQ(vec[0].get(), out[0]);
+
+  // The shared boundary key "ab" hits both of the first two rowsets.
+  out.clear();
+  tree.FindRowSetsWithKeyInRange("ab", &out);
+  ASSERT_EQ(2, out.size());
+  ASSERT_EQ(vec[0].get(), out[0]);
+  ASSERT_EQ(vec[1].get(), out[1]);
+
+  // Keys sharing the 8-byte prefix "abcdefgh" resolve on the bytes beyond
+  // the first word.
+  out.clear();
+  tree.FindRowSetsWithKeyInRange("abcdefgh_2500", &out);
+  ASSERT_EQ(1, out.size());
+  ASSERT_EQ(vec[2].get(), out[0]);
+
+  out.clear();
+  tree.FindRowSetsWithKeyInRange("abcdefgh_7500", &out);
+  ASSERT_EQ(1, out.size());
+  ASSERT_EQ(vec[3].get(), out[0]);
+
+  // An interval spanning the long-prefix boundary hits both rowsets there.
+  out.clear();
+  tree.FindRowSetsIntersectingInterval("abcdefgh_4000", "abcdefgh_6000", &out);
+  ASSERT_EQ(2, out.size());
+  ASSERT_EQ(vec[2].get(), out[0]);
+  ASSERT_EQ(vec[3].get(), out[1]);
+}
+
 class TestRowSetTreePerformance : public TestRowSetTree,
                                   public testing::WithParamInterface<std::tuple<int, int>> {
 };
@@ -192,6 +241,64 @@ TEST_P(TestRowSetTreePerformance, TestPerformance) {
                             batch_total ? (oat_total / batch_total) : 0);
 }
 
+// Verify that a tree derived incrementally from a base tree is
+// indistinguishable from one fully rebuilt from the resulting rowset list.
+TEST_F(TestRowSetTree, TestIncrementalReset) {
+  const int kNumRowSets = 100;
+  const int kNumSwapped = 10;
+  RowSetVector vec = GenerateRandomRowSets(kNumRowSets);
+  vec.push_back(shared_ptr<RowSet>(new MockMemRowSet()));
+
+  RowSetTree base;
+  ASSERT_OK(base.Reset(vec));
+
+  // Swap out a handful of rowsets (including the MemRowSet) for new ones,
+  // as a flush or compaction would.
+  RowSetVector to_remove(vec.begin(), vec.begin() + kNumSwapped);
+  to_remove.push_back(vec.back());
+  RowSetVector to_add = GenerateRandomRowSets(kNumSwapped);
+  to_add.push_back(shared_ptr<RowSet>(new MockMemRowSet()));
+
+  RowSetTree incremental;
+  ASSERT_OK(incremental.Reset(base, to_remove, to_add));
+
+  RowSetVector expected_vec(vec.begin() + kNumSwapped, vec.end() - 1);
+  expected_vec.insert(expected_vec.end(), to_add.begin(), to_add.end());
+  RowSetTree expected;
+  ASSERT_OK(expected.Reset(expected_vec));
+
+  // The rowset lists must match.
+  ASSERT_EQ(expected.all_rowsets(), incremental.all_rowsets());
+
+  // The sorted endpoint lists must match.
+  ASSERT_EQ(expected.key_endpoints().size(), incremental.key_endpoints().size());
+  for (int i = 0; i < expected.key_endpoints().size(); i++) {
+    const RowSetTree::RSEndpoint& a = expected.key_endpoints()[i];
+    const RowSetTree::RSEndpoint& b = incremental.key_endpoints()[i];
+    ASSERT_EQ(a.rowset_, b.rowset_);
+    ASSERT_EQ(a.endpoint_, b.endpoint_);
+    ASSERT_EQ(a.slice_, b.slice_);
+  }
+
+  // Point queries must return the same rowsets.
+  for (int key = 0; key < 10000; key += 97) {
+    string key_str = StringPrintf("%04d", key);
+    vector<RowSet*> out_expected;
+    expected.FindRowSetsWithKeyInRange(key_str, &out_expected);
+    vector<RowSet*> out_incremental;
+    incremental.FindRowSetsWithKeyInRange(key_str, &out_incremental);
+    std::sort(out_expected.begin(), out_expected.end());
+    std::sort(out_incremental.begin(), out_incremental.end());
+    ASSERT_EQ(out_expected, out_incremental);
+  }
+
+  // Removing a rowset which isn't in the base tree crashes.
+  RowSetTree bad;
+  EXPECT_DEATH({
+    ignore_result(bad.Reset(base, { to_add[0] }, RowSetVector()));
+  }, "Tried to remove a rowset not present in the base tree");
+}
+
 TEST_F(TestRowSetTree, TestEndpointsConsistency) {
   const int kNumRowSets = 1000;
   RowSetVector vec = GenerateRandomRowSets(kNumRowSets);
@@ -19,15 +19,19 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <functional>
 #include <memory>
 #include <string>
+#include <unordered_set>
 #include <vector>
 #include <ostream>
 
 #include <glog/logging.h>
 
-#include "kudu/gutil/stl_util.h"
+#include "kudu/gutil/endian.h"
+#include "kudu/gutil/port.h"
 #include "kudu/tablet/rowset.h"
 #include "kudu/tablet/rowset_metadata.h"
 #include "kudu/util/interval_tree-inl.h"
@@ -37,6 +41,7 @@
 using std::vector;
 using std::shared_ptr;
 using std::string;
+using std::unordered_set;
 
 namespace kudu {
 namespace tablet {
@@ -54,8 +59,24 @@ bool RSEndpointBySliceCompare(const RowSetTree::RSEndpoint& a,
   return false;
 }
 
+// Return the first 8 bytes of 'key', zero-extended if the key is shorter,
+// as a big-endian integer. Because the zero-extension appends the minimal
+// byte, comparing two prefixes as integers is consistent with comparing the
+// full keys lexicographically: if the prefixes differ, their order is the
+// order of the keys; if they are equal, a full comparison is required.
+uint64_t KeyPrefix(const Slice& key) {
+  if (PREDICT_TRUE(key.size() >= sizeof(uint64_t))) {
+    return BigEndian::Load64(key.data());
+  }
+  uint8_t buf[sizeof(uint64_t)] = { 0 };
+  memcpy(buf, key.data(), key.size());
+  return BigEndian::Load64(buf);
+}
+
 // Wrapper used when making batch queries into the interval tree.
 struct QueryStruct {
+  // The cached first 8 bytes of 'slice' (see KeyPrefix()).
+  uint64_t prefix;
   // The slice of the operation performing the query.
   Slice slice;
   // The original index of this slice in the incoming batch.
@@ -64,11 +85,31 @@ struct QueryStruct {
 
 } // anonymous namespace
 
+// Point in the interval tree's key space: an encoded key together with its
+// cached 8-byte prefix. Most comparisons between keys in a tablet differ
+// within the first few bytes, so they resolve with a single integer compare
+// without touching the key data itself.
+struct RowSetTreeKey {
+  uint64_t prefix;
+  Slice slice;
+
+  int compare(const RowSetTreeKey& other) const {
+    if (prefix != other.prefix) {
+      return prefix < other.prefix ? -1 : 1;
+    }
+    return slice.compare(other.slice);
+  }
+};
+
 // Entry for use in the interval tree.
 struct RowSetWithBounds {
   string min_key;
   string max_key;
 
+  // Cached prefixes of the two keys above (see KeyPrefix()).
+  uint64_t min_key_prefix;
+  uint64_t max_key_prefix;
+
   // NOTE: the ordering of struct fields here is purposeful: we access
   // min_key and max_key frequently, so putting them first in the struct
   // ensures they fill a single 64-byte cache line (each is 32 bytes).
@@ -78,40 +119,62 @@ struct RowSetWithBounds {
 
 // Traits struct for IntervalTree.
 struct RowSetIntervalTraits {
-  typedef Slice point_type;
+  typedef RowSetTreeKey point_type;
   typedef RowSetWithBounds *interval_type;
 
-  static Slice get_left(const RowSetWithBounds *rs) {
-    return Slice(rs->min_key);
+  static RowSetTreeKey get_left(const RowSetWithBounds *rs) {
+    return RowSetTreeKey{rs->min_key_prefix, Slice(rs->min_key)};
   }
 
-  static Slice get_right(const RowSetWithBounds *rs) {
-    return Slice(rs->max_key);
+  static RowSetTreeKey get_right(const RowSetWithBounds *rs) {
+    return RowSetTreeKey{rs->max_key_prefix, Slice(rs->max_key)};
   }
 
-  static int compare(const Slice &a, const Slice &b) {
+  static int compare(const RowSetTreeKey &a, const RowSetTreeKey &b) {
     return a.compare(b);
   }
 
-  static int compare(const Slice &a, const QueryStruct &b) {
-    return a.compare(b.slice);
+  static int compare(const RowSetTreeKey &a, const QueryStruct &b) {
+    return a.compare(RowSetTreeKey{b.prefix, b.slice});
   }
 
-  static int compare(const QueryStruct &a, const Slice &b) {
+  static int compare(const QueryStruct &a, const RowSetTreeKey &b) {
     return -compare(b, a);
   }
 
 };
 
+namespace {
+
+// Fetch the bounds of 'rs' into a freshly-allocated entry. Returns
+// NotSupported if the rowset has no static bounds (i.e it is a MemRowSet)
+// and thus cannot be placed in the interval tree.
+Status EntryForRowSet(const shared_ptr<RowSet>& rs,
+                      shared_ptr<RowSetWithBounds>* entry) {
+  shared_ptr<RowSetWithBounds> rsit(new RowSetWithBounds());
+  rsit->rowset = rs.get();
+  string min_key, max_key;
+  RETURN_NOT_OK(rs->GetBounds(&min_key, &max_key));
+  DCHECK_LE(min_key.compare(max_key), 0)
+    << "Rowset min must be <= max: " << rs->ToString();
+  rsit->min_key = std::move(min_key);
+  rsit->max_key = std::move(max_key);
+  rsit->min_key_prefix = KeyPrefix(rsit->min_key);
+  rsit->max_key_prefix = KeyPrefix(rsit->max_key);
+  *entry = std::move(rsit);
+  return Status::OK();
+}
+
+} // anonymous namespace
+
 RowSetTree::RowSetTree()
   : initted_(false) {
 }
 
 Status RowSetTree::Reset(const RowSetVector &rowsets) {
   CHECK(!initted_);
-  std::vector<RowSetWithBounds *> entries;
+  std::vector<std::shared_ptr<RowSetWithBounds>> entries;
   RowSetVector unbounded;
-  ElementDeleter deleter(&entries);
   entries.reserve(rowsets.size());
   std::vector<RSEndpoint> endpoints;
   endpoints.reserve(rowsets.size()*2);
@@ -119,10 +182,8 @@ Status RowSetTree::Reset(const RowSetVector &rowsets) {
   // Iterate over each of the provided RowSets, fetching their
   // bounds and adding them to the local vectors.
   for (const shared_ptr<RowSet> &rs : rowsets) {
-    gscoped_ptr<RowSetWithBounds> rsit(new RowSetWithBounds());
-    rsit->rowset = rs.get();
-    string min_key, max_key;
-    Status s = rs->GetBounds(&min_key, &max_key);
+    shared_ptr<RowSetWithBounds> rsit;
+    Status s = EntryForRowSet(rs, &rsit);
     if (s.IsNotSupported()) {
       // This rowset is a MemRowSet, for which the bounds change as more
       // data gets inserted. Therefore we can't put it in the static
@@ -136,28 +197,123 @@ Status RowSetTree::Reset(const RowSetVector &rowsets) {
                    << s.ToString();
       return s;
     }
-    DCHECK_LE(min_key.compare(max_key), 0)
-      << "Rowset min must be <= max: " << rs->ToString();
-
-    // Load bounds and save entry
-    rsit->min_key = std::move(min_key);
-    rsit->max_key = std::move(max_key);
 
     // Load into key endpoints.
     endpoints.emplace_back(rsit->rowset, START, rsit->min_key);
     endpoints.emplace_back(rsit->rowset, STOP, rsit->max_key);
 
-    entries.push_back(rsit.release());
+    entries.push_back(std::move(rsit));
   }
 
   // Sort endpoints
   std::sort(endpoints.begin(), endpoints.end(), RSEndpointBySliceCompare);
 
-  // Install the vectors into the object.
-  entries_.swap(entries);
-  unbounded_rowsets_.swap(unbounded);
-  tree_.reset(new IntervalTree<RowSetIntervalTraits>(entries_));
-  key_endpoints_.swap(endpoints);
+  Install(rowsets, std::move(entries), std::move(unbounded), std::move(endpoints));
+  return Status::OK();
+}
+
+Status RowSetTree::Reset(const RowSetTree& base,
+                         const RowSetVector& rowsets_to_remove,
+                         const RowSetVector& rowsets_to_add) {
+  CHECK(!initted_);
+  CHECK(base.initted_);
+
+  unordered_set<RowSet*> removed;
+  removed.reserve(rowsets_to_remove.size());
+  for (const shared_ptr<RowSet>& rs : rowsets_to_remove) {
+    removed.insert(rs.get());
+  }
+
+  // Diff the rowset list: the surviving rowsets in their original order,
+  // followed by the newly added ones.
+  RowSetVector all_rowsets;
+  all_rowsets.reserve(base.all_rowsets_.size() + rowsets_to_add.size());
+  size_t num_removed = 0;
+  for (const shared_ptr<RowSet>& rs : base.all_rowsets_) {
+    if (ContainsKey(removed, rs.get())) {
+      num_removed++;
+      continue;
+    }
+    all_rowsets.push_back(rs);
+  }
+  CHECK_EQ(num_removed, rowsets_to_remove.size())
+    << "Tried to remove a rowset not present in the base tree";
+  all_rowsets.insert(all_rowsets.end(), rowsets_to_add.begin(), rowsets_to_add.end());
+
+  // Share the bounds entries of the surviving rowsets with the base tree:
+  // a rowset's bounds are immutable, so there is no need to re-fetch them.
+  std::vector<std::shared_ptr<RowSetWithBounds>> entries;
+  entries.reserve(all_rowsets.size());
+  for (const auto& entry : base.entries_) {
+    if (!ContainsKey(removed, entry->rowset)) {
+      entries.push_back(entry);
+    }
+  }
+  RowSetVector unbounded;
+  for (const shared_ptr<RowSet>& rs : base.unbounded_rowsets_) {
+    if (!ContainsKey(removed, rs.get())) {
+      unbounded.push_back(rs);
+    }
+  }
+
+  // The surviving endpoints form a subsequence of the base tree's sorted
+  // endpoint list and thus stay sorted. Their slices point into the shared
+  // entries, so they remain valid in the new tree.
+  std::vector<RSEndpoint> endpoints;
+  endpoints.reserve(all_rowsets.size() * 2);
+  for (const RSEndpoint& endpoint : base.key_endpoints_) {
+    if (!ContainsKey(removed, endpoint.rowset_)) {
+      endpoints.push_back(endpoint);
+    }
+  }
+  const size_t num_surviving_endpoints = endpoints.size();
+
+  // Process the newly added rowsets the same way as a full Reset().
+  for (const shared_ptr<RowSet>& rs : rowsets_to_add) {
+    shared_ptr<RowSetWithBounds> rsit;
+    Status s = EntryForRowSet(rs, &rsit);
+    if (s.IsNotSupported()) {
+      unbounded.push_back(rs);
+      continue;
+    } else if (!s.ok()) {
+      LOG(WARNING) << "Unable to construct RowSetTree: "
+                   << rs->ToString() << " unable to determine its bounds: "
+                   << s.ToString();
+      return s;
+    }
+    endpoints.emplace_back(rsit->rowset, START, rsit->min_key);
+    endpoints.emplace_back(rsit->rowset, STOP, rsit->max_key);
+    entries.push_back(std::move(rsit));
+  }
+
+  // Only the endpoints of the added rowsets need sorting; merge them into
+  // the already-sorted surviving endpoints.
+  std::sort(endpoints.begin() + num_surviving_endpoints, endpoints.end(),
+            RSEndpointBySliceCompare);
+  std::inplace_merge(endpoints.begin(), endpoints.begin() + num_surviving_endpoints,
+                     endpoints.end(), RSEndpointBySliceCompare);
+
+  Install(all_rowsets, std::move(entries), std::move(unbounded), std::move(endpoints));
+  return Status::OK();
+}
+
+void RowSetTree::Install(const RowSetVector& rowsets,
+                         std::vector<std::shared_ptr<RowSetWithBounds>> entries,
+                         RowSetVector unbounded,
+                         std::vector<RSEndpoint> endpoints) {
+  entries_ = std::move(entries);
+  unbounded_rowsets_ = std::move(unbounded);
+
+  // The interval tree is always rebuilt: it stores raw pointers into the
+  // (possibly shared) entries, and its structure depends on the full set.
+  std::vector<RowSetWithBounds*> raw_entries;
+  raw_entries.reserve(entries_.size());
+  for (const auto& entry : entries_) {
+    raw_entries.push_back(entry.get());
+  }
+  tree_.reset(new IntervalTree<RowSetIntervalTraits>(raw_entries));
+
+  key_endpoints_ = std::move(endpoints);
   all_rowsets_.assign(rowsets.begin(), rowsets.end());
 
   // Build the mapping from DRS ID to DRS.
@@ -169,8 +325,6 @@ Status RowSetTree::Reset(const RowSetVector &rowsets) {
   }
 
   initted_ = true;
-
-  return Status::OK();
 }
 
 void RowSetTree::FindRowSetsIntersectingInterval(const Slice &lower_bound,
@@ -188,6 +342,8 @@ void RowSetTree::FindRowSetsIntersectingInterval(const Slice &lower_bound,
   RowSetWithBounds query;
   query.min_key = lower_bound.ToString();
   query.max_key = upper_bound.ToString();
+  query.min_key_prefix = KeyPrefix(query.min_key);
+  query.max_key_prefix = KeyPrefix(query.max_key);
 
   vector<RowSetWithBounds *> from_tree;
   from_tree.reserve(all_rowsets_.size());
@@ -211,7 +367,8 @@ void RowSetTree::FindRowSetsWithKeyInRange(const Slice &encoded_key,
   // whose ranges overlap the probe key.
   vector<RowSetWithBounds *> from_tree;
   from_tree.reserve(all_rowsets_.size());
-  tree_->FindContainingPoint(encoded_key, &from_tree);
+  tree_->FindContainingPoint(RowSetTreeKey{KeyPrefix(encoded_key), encoded_key},
+                             &from_tree);
   rowsets->reserve(rowsets->size() + from_tree.size());
   for (RowSetWithBounds *rs : from_tree) {
     rowsets->push_back(rs->rowset);
@@ -238,7 +395,7 @@ void RowSetTree::ForEachRowSetContainingKeys(
   vector<QueryStruct> queries;
   queries.resize(encoded_keys.size());
   for (int i = 0; i < encoded_keys.size(); i++) {
-    queries[i] = {encoded_keys[i], i};
+    queries[i] = {KeyPrefix(encoded_keys[i]), encoded_keys[i], i};
   }
 
   tree_->ForEachIntervalContainingPoints(
@@ -250,7 +407,6 @@ void RowSetTree::ForEachRowSetContainingKeys(
 
 
 RowSetTree::~RowSetTree() {
-  STLDeleteElements(&entries_);
 }
 
 } // namespace tablet
@@ -19,6 +19,7 @@
 
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
@@ -65,7 +66,23 @@ class RowSetTree {
   };
 
   RowSetTree();
+
   Status Reset(const RowSetVector &rowsets);
+
+  // Initialize this tree to hold the same rowsets as 'base', minus
+  // 'rowsets_to_remove' plus 'rowsets_to_add'.
+  //
+  // This is cheaper than a full Reset() when only a few rowsets change, as
+  // on a flush or compaction swap: the bounds entries and sorted endpoints
+  // of the unchanged rowsets are shared with 'base' rather than re-fetched
+  // and re-sorted.
+  //
+  // It is a CHECK failure if any rowset in 'rowsets_to_remove' is not
+  // present in 'base'.
+  Status Reset(const RowSetTree& base,
+               const RowSetVector& rowsets_to_remove,
+               const RowSetVector& rowsets_to_add);
+
   ~RowSetTree();
 
   // Return all RowSets whose range may contain the given encoded key.
@@ -101,6 +118,13 @@ class RowSetTree {
   const std::vector<RSEndpoint>& key_endpoints() const { return key_endpoints_; }
 
  private:
+  // Install the given state into this tree and build the interval tree
+  // over the entries. Shared tail of the two Reset() variants.
+  void Install(const RowSetVector& rowsets,
+               std::vector<std::shared_ptr<RowSetWithBounds>> entries,
+               RowSetVector unbounded,
+               std::vector<RSEndpoint> endpoints);
+
   // Interval tree of the rowsets. Used to efficiently find rowsets which might contain
   // a probe row.
   gscoped_ptr<IntervalTree<RowSetIntervalTraits> > tree_;
@@ -110,10 +134,11 @@ class RowSetTree {
   // TODO map to usage statistics as well. See KUDU-???
   std::vector<RSEndpoint> key_endpoints_;
 
-  // Container for all of the entries in tree_. IntervalTree does
-  // not itself manage memory, so this provides a simple way to enumerate
-  // all the entry structs and free them in the destructor.
-  std::vector<RowSetWithBounds *> entries_;
+  // Container for all of the entries in tree_. IntervalTree does not itself
+  // manage memory, so this keeps the entry structs alive. The entries are
+  // immutable once built and may be shared with other RowSetTrees derived
+  // incrementally from this one (or from which this one was derived).
+  std::vector<std::shared_ptr<RowSetWithBounds>> entries_;
 
   // All of the rowsets which were put in this RowSetTree.
   RowSetVector all_rowsets_;
@@ -37,6 +37,7 @@
 #include "kudu/common/timestamp.h"
 #include "kudu/fs/block_id.h"
 #include "kudu/fs/block_manager.h"
+#include "kudu/gutil/casts.h"
 #include "kudu/gutil/gscoped_ptr.h"
 #include "kudu/gutil/move.h"
 #include "kudu/gutil/port.h"
@@ -44,9 +45,12 @@
 #include "kudu/gutil/strings/join.h"
 #include "kudu/tablet/delta_key.h"
 #include "kudu/tablet/delta_stats.h"
+#include "kudu/tablet/delta_tracker.h"
 #include "kudu/tablet/deltafile.h"
+#include "kudu/tablet/diskrowset.h"
 #include "kudu/tablet/local_tablet_writer.h"
 #include "kudu/tablet/mvcc.h"
+#include "kudu/tablet/rowset.h"
 #include "kudu/tablet/rowset_metadata.h"
 #include "kudu/tablet/tablet-test-base.h"
 #include "kudu/tablet/tablet-test-util.h"
@@ -68,6 +72,9 @@ DEFINE_int32(testiterator_num_inserts, 1000,
 DEFINE_int32(testcompaction_num_rows, 1000,
              "Number of rows per rowset in TestCompaction");
 
+DECLARE_bool(tablet_apply_writes_in_key_order);
+DECLARE_int32(tablet_dms_flush_batch_size);
+
 using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
@@ -93,6 +100,77 @@ class TestTablet : public TabletTestBase<SETUP> {
 };
 TYPED_TEST_CASE(TestTablet, TabletTestHelperTypes);
 
+TYPED_TEST(TestTablet, TestSplitKeyRange) {
+  // Create a few disjoint rowsets.
+  const int kRowsPerRowSet = 100;
+  for (int i = 0; i < 3; i++) {
+    this->InsertTestRows(i * kRowsPerRowSet, kRowsPerRowSet, 0);
+    ASSERT_OK(this->tablet()->Flush());
+  }
+
+  // With no target chunk size, the whole key space comes back as a single
+  // unbounded range.
+  vector<KeyRangePB> ranges;
+  ASSERT_OK(this->tablet()->SplitKeyRange(Slice(), Slice(), 0, &ranges));
+  ASSERT_EQ(1, ranges.size());
+  ASSERT_FALSE(ranges[0].has_start_primary_key());
+  ASSERT_FALSE(ranges[0].has_stop_primary_key());
+
+  // With a tiny target chunk size, every rowset bound becomes a split
+  // point, yielding one range per rowset.
+  ranges.clear();
+  ASSERT_OK(this->tablet()->SplitKeyRange(Slice(), Slice(), 1, &ranges));
+  ASSERT_EQ(3, ranges.size());
+
+  // The ranges must cover the whole key space contiguously, in ascending
+  // key order, with a size estimate attached to each.
+  ASSERT_FALSE(ranges.front().has_start_primary_key());
+  ASSERT_FALSE(ranges.back().has_stop_primary_key());
+  for (size_t i = 1; i < ranges.size(); i++) {
+    ASSERT_EQ(ranges[i - 1].stop_primary_key(), ranges[i].start_primary_key());
+    ASSERT_GT(ranges[i - 1].size_bytes_estimate(), 0);
+  }
+}
+
+// Test that a diff scan only includes rowsets which may contain mutations
+// at or after the lower-bound timestamp, and skips the rest.
+TYPED_TEST(TestTablet, TestDiffScanSkipsUnchangedRowSets) {
+  const int kRowsPerRowSet = 100;
+  LocalTabletWriter writer(this->tablet().get(), &this->client_schema_);
+
+  // Create two disjoint rowsets.
+  for (int i = 0; i < 2; i++) {
+    this->InsertTestRows(i * kRowsPerRowSet, kRowsPerRowSet, 0);
+    ASSERT_OK(this->tablet()->Flush());
+  }
+
+  // Delta files are opened lazily, and their stats are unavailable (and
+  // thus assumed recent) until then. Force them open so that the skipping
+  // logic below has stats to look at.
+  vector<shared_ptr<RowSet>> rowsets;
+  this->tablet()->GetRowSetsForTests(&rowsets);
+  for (const shared_ptr<RowSet>& rs : rowsets) {
+    DiskRowSet* drs = down_cast<DiskRowSet*>(rs.get());
+    ASSERT_OK(drs->delta_tracker()->InitAllDeltaStoresForTests(
+        DeltaTracker::UNDOS_AND_REDOS));
+  }
+
+  // Update a row in the second rowset after taking the start timestamp.
+  Timestamp start_ts = this->tablet()->clock()->Now();
+  ASSERT_OK(this->UpdateTestRow(&writer, kRowsPerRowSet + 50, 1));
+
+  // A diff scan from 'start_ts' should return only the second rowset's
+  // rows: the first rowset has no mutations in the window.
+  gscoped_ptr<RowwiseIterator> iter;
+  ASSERT_OK(this->tablet()->NewDiffRowIterator(
+      this->client_schema_, MvccSnapshot(*this->tablet()->mvcc_manager()),
+      UNORDERED, start_ts, &iter));
+  ASSERT_OK(iter->Init(nullptr));
+  vector<string> rows;
+  ASSERT_OK(IterateToStringList(iter.get(), &rows));
+  ASSERT_EQ(kRowsPerRowSet, rows.size());
+}
+
 TYPED_TEST(TestTablet, TestFlush) {
   // Insert 1000 rows into memrowset
   uint64_t max_rows = this->ClampRowCount(FLAGS_testflush_num_inserts);
@@ -135,6 +213,27 @@ TYPED_TEST(TestTablet, TestFlush) {
   ASSERT_EQ(dfr->delta_stats().delete_count(), max_rows);
 }
 
+// Test that a DMS flush pass drains up to --tablet_dms_flush_batch_size
+// delta memstores rather than just the single best one.
+TYPED_TEST(TestTablet, TestFlushDMSBatch) {
+  FLAGS_tablet_dms_flush_batch_size = 2;
+
+  // Create two disk rowsets, then dirty a row in each so that both
+  // rowsets carry a non-empty DMS.
+  LocalTabletWriter writer(this->tablet().get(), &this->client_schema_);
+  this->InsertTestRows(0, 10, 0);
+  ASSERT_OK(this->tablet()->Flush());
+  this->InsertTestRows(10, 10, 0);
+  ASSERT_OK(this->tablet()->Flush());
+  ASSERT_OK(this->UpdateTestRow(&writer, 1, 111));
+  ASSERT_OK(this->UpdateTestRow(&writer, 11, 222));
+  ASSERT_FALSE(this->tablet()->DeltaMemRowSetEmpty());
+
+  // A single flush pass should drain both DMSes.
+  ASSERT_OK(this->tablet()->FlushDMSWithHighestRetention(Tablet::ReplaySizeMap()));
+  ASSERT_TRUE(this->tablet()->DeltaMemRowSetEmpty());
+}
+
 // Test that historical data for a row is maintained even after the row
 // is flushed from the memrowset.
 TYPED_TEST(TestTablet, TestInsertsAndMutationsAreUndoneWithMVCCAfterFlush) {
@@ -262,6 +361,48 @@ TYPED_TEST(TestTablet, TestInsertDuplicateKey) {
   ASSERT_EQ(1, this->TabletCount());
 }
 
+// Test that a batch whose ops arrive out of key order is applied correctly
+// with --tablet_apply_writes_in_key_order enabled, and that per-row errors
+// are still reported against the client's op order.
+TYPED_TEST(TestTablet, TestApplyWritesInKeyOrder) {
+  FLAGS_tablet_apply_writes_in_key_order = true;
+  LocalTabletWriter writer(this->tablet().get(), &this->client_schema_);
+
+  // Seed a row so that one op in the batch below fails.
+  ASSERT_OK(this->InsertTestRow(&writer, 5, 5));
+
+  // Send a batch in non-sorted key order whose last op is a duplicate
+  // insert of the seeded row. In sorted apply order the duplicate lands in
+  // the middle of the batch, so a correct result must still attach the
+  // failure to the last op.
+  KuduPartialRow row7(&this->client_schema_);
+  this->setup_.BuildRow(&row7, 7, 7);
+  KuduPartialRow row3(&this->client_schema_);
+  this->setup_.BuildRow(&row3, 3, 3);
+  KuduPartialRow row5(&this->client_schema_);
+  this->setup_.BuildRow(&row5, 5, 50);
+  vector<LocalTabletWriter::Op> ops;
+  ops.emplace_back(RowOperationsPB::INSERT, &row7);
+  ops.emplace_back(RowOperationsPB::INSERT, &row3);
+  ops.emplace_back(RowOperationsPB::INSERT, &row5);
+
+  Status s = writer.WriteBatch(ops);
+  ASSERT_STR_CONTAINS(s.ToString(), "key already present");
+  ASSERT_TRUE(writer.last_op_result().has_failed_status());
+
+  // The two new rows were inserted, and the duplicate insert did not
+  // clobber the seeded row's value.
+  ASSERT_EQ(3, this->TabletCount());
+  vector<string> expected = { this->setup_.FormatDebugRow(3, 3, false),
+                              this->setup_.FormatDebugRow(5, 5, false),
+                              this->setup_.FormatDebugRow(7, 7, false) };
+  std::sort(expected.begin(), expected.end());
+  vector<string> rows;
+  ASSERT_OK(this->IterateToStringList(&rows));
+  std::sort(rows.begin(), rows.end());
+  ASSERT_EQ(expected, rows);
+}
+
 // Tests that we are able to handle reinserts properly.
 //
 // Namely tests that:
@@ -45,6 +45,7 @@
 #include "kudu/common/rowid.h"
 #include "kudu/common/scan_spec.h"
 #include "kudu/common/schema.h"
+#include "kudu/common/schema_intern.h"
 #include "kudu/common/timestamp.h"
 #include "kudu/common/types.h"
 #include "kudu/common/wire_protocol.pb.h"
@@ -54,7 +55,9 @@
 #include "kudu/gutil/bind.h"
 #include "kudu/gutil/bind_helpers.h"
 #include "kudu/gutil/casts.h"
+#include "kudu/gutil/map-util.h"
 #include "kudu/gutil/move.h"
+#include "kudu/gutil/once.h"
 #include "kudu/gutil/stl_util.h"
 #include "kudu/gutil/strings/human_readable.h"
 #include "kudu/gutil/strings/substitute.h"
@@ -84,6 +87,7 @@
 #include "kudu/util/locks.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/maintenance_manager.h"
+#include "kudu/util/memory/arena.h"
 #include "kudu/util/metrics.h"
 #include "kudu/util/monotime.h"
 #include "kudu/util/slice.h"
@@ -107,6 +111,24 @@ DEFINE_double(tablet_bloom_target_fp_rate, 0.0001f,
               "required for bloom filters.");
 TAG_FLAG(tablet_bloom_target_fp_rate, advanced);
 
+DEFINE_bool(tablet_apply_writes_in_key_order, false,
+            "Whether to apply the operations of a write batch in primary key "
+            "order instead of the order in which the client sent them. For "
+            "workloads which send large, mostly-unsorted batches this gives "
+            "the in-memory row store and bloom filter probes sequential "
+            "access locality. Per-row results and errors are reported "
+            "against the client's original operation order either way.");
+TAG_FLAG(tablet_apply_writes_in_key_order, advanced);
+TAG_FLAG(tablet_apply_writes_in_key_order, experimental);
+
+DEFINE_int32(tablet_dms_flush_batch_size, 1,
+             "Maximum number of DeltaMemStores to flush in a single maintenance "
+             "operation. Each DMS flush swaps a fresh store in before doing any "
+             "I/O, so updates are blocked only for the duration of the swap; "
+             "flushing several stores per operation amortizes the maintenance "
+             "scheduling overhead on update-heavy tablets with many rowsets.");
+TAG_FLAG(tablet_dms_flush_batch_size, advanced);
+TAG_FLAG(tablet_dms_flush_batch_size, experimental);
 
 DEFINE_double(fault_crash_before_flush_tablet_meta_after_compaction, 0.0,
               "Fraction of the time, during compaction, to crash before flushing metadata");
@@ -132,6 +154,26 @@ DEFINE_double(tablet_throttler_burst_factor, 1.0f,
              "base rate.");
 TAG_FLAG(tablet_throttler_burst_factor, experimental);
 
+DEFINE_int64(tserver_throttler_rpc_per_sec, 0,
+             "Maximum aggregate write RPC rate (op/s) allowed across all tablets "
+             "hosted by this server. Write RPCs exceeding this limit will be "
+             "throttled even if the target tablet is under its own limit. "
+             "0 means no limit.");
+TAG_FLAG(tserver_throttler_rpc_per_sec, experimental);
+
+DEFINE_int64(tserver_throttler_bytes_per_sec, 0,
+             "Maximum aggregate write RPC IO rate (byte/s) allowed across all "
+             "tablets hosted by this server. Write RPCs exceeding this limit will "
+             "be throttled even if the target tablet is under its own limit. "
+             "0 means no limit.");
+TAG_FLAG(tserver_throttler_bytes_per_sec, experimental);
+
+DEFINE_double(tserver_throttler_burst_factor, 1.0f,
+             "Burst factor for server-wide write RPC throttling. The maximum rate "
+             "the server-wide throttler allows within a token refill period (100ms) "
+             "equals burst factor multiply base rate.");
+TAG_FLAG(tserver_throttler_burst_factor, experimental);
+
 DEFINE_int32(tablet_history_max_age_sec, 15 * 60,
              "Number of seconds to retain tablet history. Reads initiated at a "
              "snapshot that is older than this age will be rejected. "
@@ -352,10 +394,11 @@ void Tablet::Shutdown() {
   metadata_->SetPreFlushCallback(Bind(DoNothingStatusClosure));
 }
 
-Status Tablet::GetMappedReadProjection(const Schema& projection,
-                                       Schema *mapped_projection) const {
-  const Schema* cur_schema = schema();
-  return cur_schema->GetMappedReadProjection(projection, mapped_projection);
+Status Tablet::GetMappedReadProjection(const shared_ptr<const Schema>& projection,
+                                       shared_ptr<const Schema>* mapped_projection) const {
+  SchemaInternTable* intern = SchemaInternTable::GetInstance();
+  shared_ptr<const Schema> cur_schema = intern->Intern(*schema());
+  return intern->GetMappedReadProjection(cur_schema, projection, mapped_projection);
 }
 
 BloomFilterSizing Tablet::DefaultBloomSizing() {
@@ -380,10 +423,68 @@ Status Tablet::NewRowIterator(const Schema &projection,
     metrics_->scans_started->Increment();
   }
   VLOG_WITH_PREFIX(2) << "Created new Iterator under snap: " << snap.ToString();
-  iter->reset(new Iterator(this, projection, snap, order));
+  iter->reset(new Iterator(this, projection, snap, order, false,
+                           Timestamp::kInvalidTimestamp));
+  return Status::OK();
+}
+
+Status Tablet::NewDiffRowIterator(const Schema& projection,
+                                  const MvccSnapshot& snap,
+                                  const OrderMode order,
+                                  Timestamp diff_scan_lower_bound,
+                                  gscoped_ptr<RowwiseIterator>* iter) const {
+  DCHECK_NE(Timestamp::kInvalidTimestamp, diff_scan_lower_bound);
+  RETURN_IF_STOPPED_OR_CHECK_STATE(kOpen);
+  if (metrics_) {
+    metrics_->scans_started->Increment();
+  }
+  VLOG_WITH_PREFIX(2) << "Created new diff Iterator under snap: " << snap.ToString()
+                      << " changed since: " << diff_scan_lower_bound.ToString();
+  iter->reset(new Iterator(this, projection, snap, order, false,
+                           diff_scan_lower_bound));
+  return Status::OK();
+}
+
+Status Tablet::NewPointLookupIterator(const Schema& projection,
+                                      gscoped_ptr<RowwiseIterator>* iter) const {
+  RETURN_IF_STOPPED_OR_CHECK_STATE(kOpen);
+  if (metrics_) {
+    metrics_->scans_started->Increment();
+  }
+  // Yield current rows.
+  MvccSnapshot snap(mvcc_);
+  VLOG_WITH_PREFIX(2) << "Created new point lookup Iterator under snap: " << snap.ToString();
+  iter->reset(new Iterator(this, projection, snap, UNORDERED, true,
+                           Timestamp::kInvalidTimestamp));
   return Status::OK();
 }
 
+namespace {
+// Maximum number of validated write schemas retained per tablet. Writers in
+// steady state use only a handful of distinct schemas, so keep the cache
+// small and simply clear it if it somehow fills up.
+const size_t kMaxCachedWriteSchemas = 8;
+} // anonymous namespace
+
+std::shared_ptr<const Tablet::WriteSchemaState> Tablet::LookupWriteSchemaState(
+    const SchemaPB& client_schema_pb) const {
+  string key;
+  if (!client_schema_pb.SerializeToString(&key)) {
+    return nullptr;
+  }
+  std::lock_guard<simple_spinlock> l(write_schema_cache_lock_);
+  auto it = write_schema_cache_.find(key);
+  if (it == write_schema_cache_.end()) {
+    return nullptr;
+  }
+  if (it->second->schema_version != metadata_->schema_version()) {
+    // The tablet schema has changed since this entry was cached.
+    write_schema_cache_.erase(it);
+    return nullptr;
+  }
+  return it->second;
+}
+
 Status Tablet::DecodeWriteOperations(const Schema* client_schema,
                                      WriteTransactionState* tx_state) {
   TRACE_EVENT0("tablet", "Tablet::DecodeWriteOperations");
@@ -394,6 +495,48 @@ Status Tablet::DecodeWriteOperations(const Schema* client_schema,
   // change while this transaction is in-flight.
   tx_state->AcquireSchemaLock(&schema_lock_);
 
+  return DecodeWriteOperationsUnlocked(client_schema, tx_state);
+}
+
+Status Tablet::DecodeWriteOperations(const std::shared_ptr<const WriteSchemaState>& ws,
+                                     WriteTransactionState* tx_state) {
+  TRACE_EVENT0("tablet", "Tablet::DecodeWriteOperations");
+
+  DCHECK_EQ(tx_state->row_ops().size(), 0);
+
+  // Acquire the schema lock in shared mode, so that the schema doesn't
+  // change while this transaction is in-flight.
+  tx_state->AcquireSchemaLock(&schema_lock_);
+
+  // Now that the schema can no longer change, re-check that the cached state
+  // is still current. If the tablet schema changed between the cache lookup
+  // and the lock acquisition, fall back to full validation.
+  if (PREDICT_FALSE(ws->schema_version != metadata_->schema_version())) {
+    return DecodeWriteOperationsUnlocked(&ws->client_schema, tx_state);
+  }
+
+  // The Schema needs to be held constant while any transactions are between
+  // PREPARE and APPLY stages
+  TRACE("PREPARE: Decoding operations");
+  vector<DecodedRowOperation> ops;
+
+  RowOperationsPBDecoder dec(&tx_state->request()->row_operations(),
+                             &ws->client_schema,
+                             schema(),
+                             tx_state->arena());
+  RETURN_NOT_OK(dec.DecodeOperationsWithMapping(ws->client_to_tablet_mapping, &ops));
+  TRACE_COUNTER_INCREMENT("num_ops", ops.size());
+
+  // Important to set the schema before the ops -- we need the
+  // schema in order to stringify the ops.
+  tx_state->set_schema_at_decode_time(schema());
+  tx_state->SetRowOps(std::move(ops));
+
+  return Status::OK();
+}
+
+Status Tablet::DecodeWriteOperationsUnlocked(const Schema* client_schema,
+                                             WriteTransactionState* tx_state) {
   // The Schema needs to be held constant while any transactions are between
   // PREPARE and APPLY stages
   TRACE("PREPARE: Decoding operations");
@@ -404,9 +547,29 @@ Status Tablet::DecodeWriteOperations(const Schema* client_schema,
                              client_schema,
                              schema(),
                              tx_state->arena());
-  RETURN_NOT_OK(dec.DecodeOperations(&ops));
+  vector<int> client_to_tablet_mapping;
+  RETURN_NOT_OK(dec.DecodeOperations(&ops, &client_to_tablet_mapping));
   TRACE_COUNTER_INCREMENT("num_ops", ops.size());
 
+  // Cache the validated schema state so that subsequent requests with the
+  // same client schema can skip validation. The schema lock is held in
+  // shared mode, so the schema version cannot change underneath us.
+  if (tx_state->request()->has_schema()) {
+    string key;
+    if (tx_state->request()->schema().SerializeToString(&key)) {
+      auto ws = std::make_shared<WriteSchemaState>();
+      ws->client_schema = *client_schema;
+      ws->client_to_tablet_mapping = std::move(client_to_tablet_mapping);
+      ws->schema_version = metadata_->schema_version();
+      std::lock_guard<simple_spinlock> l(write_schema_cache_lock_);
+      if (write_schema_cache_.size() >= kMaxCachedWriteSchemas &&
+          !ContainsKey(write_schema_cache_, key)) {
+        write_schema_cache_.clear();
+      }
+      write_schema_cache_[key] = std::move(ws);
+    }
+  }
+
   // Important to set the schema before the ops -- we need the
   // schema in order to stringify the ops.
   tx_state->set_schema_at_decode_time(schema());
@@ -419,8 +582,39 @@ Status Tablet::AcquireRowLocks(WriteTransactionState* tx_state) {
   TRACE_EVENT1("tablet", "Tablet::AcquireRowLocks",
                "num_locks", tx_state->row_ops().size());
   TRACE("PREPARE: Acquiring locks for $0 operations", tx_state->row_ops().size());
-  for (RowOp* op : tx_state->row_ops()) {
-    RETURN_NOT_OK(AcquireLockForOp(tx_state, op));
+  const vector<RowOp*>& ops = tx_state->row_ops();
+
+  if (PREDICT_TRUE(ops.size() == 1)) {
+    RETURN_NOT_OK(AcquireLockForOp(tx_state, ops[0]));
+  } else {
+    // For a multi-row batch, set up the key probes for all of the ops first,
+    // then acquire the locks in sorted key order with a single pass over the
+    // lock table. Acquiring in sorted order ensures that concurrent writers
+    // locking overlapping row sets cannot deadlock against each other.
+    Arena* arena = tx_state->arena();
+    for (RowOp* op : ops) {
+      ConstContiguousRow row_key(&key_schema_, op->decoded_op.row_data);
+      op->key_probe = arena->NewObject<RowSetKeyProbe>(row_key, arena);
+      RETURN_NOT_OK(CheckRowInTablet(row_key));
+    }
+
+    vector<RowOp*> sorted_ops(ops.begin(), ops.end());
+    std::sort(sorted_ops.begin(), sorted_ops.end(), [](const RowOp* a, const RowOp* b) {
+        return a->key_probe->encoded_key_slice().compare(
+            b->key_probe->encoded_key_slice()) < 0;
+      });
+
+    vector<Slice> keys;
+    keys.reserve(sorted_ops.size());
+    for (const RowOp* op : sorted_ops) {
+      keys.push_back(op->key_probe->encoded_key_slice());
+    }
+
+    vector<ScopedRowLock> locks;
+    lock_manager_.LockBatch(keys, tx_state, &locks);
+    for (size_t i = 0; i < sorted_ops.size(); i++) {
+      sorted_ops[i]->row_lock = std::move(locks[i]);
+    }
   }
   TRACE("PREPARE: locks acquired");
   return Status::OK();
@@ -444,7 +638,8 @@ Status Tablet::CheckRowInTablet(const ConstContiguousRow& row) const {
 
 Status Tablet::AcquireLockForOp(WriteTransactionState* tx_state, RowOp* op) {
   ConstContiguousRow row_key(&key_schema_, op->decoded_op.row_data);
-  op->key_probe.reset(new tablet::RowSetKeyProbe(row_key));
+  Arena* arena = tx_state->arena();
+  op->key_probe = arena->NewObject<RowSetKeyProbe>(row_key, arena);
   RETURN_NOT_OK(CheckRowInTablet(row_key));
 
   op->row_lock = ScopedRowLock(&lock_manager_,
@@ -894,8 +1089,30 @@ Status Tablet::ApplyRowOperations(WriteTransactionState* tx_state) {
 
   RETURN_NOT_OK(BulkCheckPresence(tx_state));
 
+  // Determine the order in which to apply the ops. When enabled, a
+  // multi-row batch is applied in sorted key order, which gives the
+  // descent into the memrowset's btree and the per-rowset bloom probes
+  // sequential access locality for unsorted client batches. The op list
+  // itself is left in client order, so per-row results and errors keep
+  // their original indexes. Ops for the same key keep their relative
+  // order, since reordering them would change the outcome of the batch.
+  vector<int> apply_order;
+  if (PREDICT_FALSE(FLAGS_tablet_apply_writes_in_key_order) && num_ops > 1) {
+    const vector<RowOp*>& ops = tx_state->row_ops();
+    apply_order.reserve(num_ops);
+    for (int i = 0; i < num_ops; i++) {
+      apply_order.push_back(i);
+    }
+    std::sort(apply_order.begin(), apply_order.end(), [&ops](int a, int b) {
+        int c = ops[a]->key_probe->encoded_key_slice().compare(
+            ops[b]->key_probe->encoded_key_slice());
+        return c < 0 || (c == 0 && a < b);
+      });
+  }
+
   // Actually apply the ops.
-  for (int op_idx = 0; op_idx < num_ops; op_idx++) {
+  for (int i = 0; i < num_ops; i++) {
+    int op_idx = apply_order.empty() ? i : apply_order[i];
     RowOp* row_op = tx_state->row_ops()[op_idx];
     if (row_op->has_result()) continue;
 
@@ -971,35 +1188,12 @@ void Tablet::ModifyRowSetTree(const RowSetTree& old_tree,
                               const RowSetVector& rowsets_to_remove,
                               const RowSetVector& rowsets_to_add,
                               RowSetTree* new_tree) {
-  RowSetVector post_swap;
-
-  // O(n^2) diff algorithm to collect the set of rowsets excluding
-  // the rowsets that were included in the compaction
-  int num_removed = 0;
-
-  for (const shared_ptr<RowSet> &rs : old_tree.all_rowsets()) {
-    // Determine if it should be removed
-    bool should_remove = false;
-    for (const shared_ptr<RowSet> &to_remove : rowsets_to_remove) {
-      if (to_remove == rs) {
-        should_remove = true;
-        num_removed++;
-        break;
-      }
-    }
-    if (!should_remove) {
-      post_swap.push_back(rs);
-    }
-  }
-
-  CHECK_EQ(num_removed, rowsets_to_remove.size());
-
-  // Then push the new rowsets on the end of the new list
-  std::copy(rowsets_to_add.begin(),
-            rowsets_to_add.end(),
-            std::back_inserter(post_swap));
-
-  CHECK_OK(new_tree->Reset(post_swap));
+  // Derive the new tree incrementally from the old one. This runs under the
+  // tablet's component lock, so the cost must stay proportional to the number
+  // of changed rowsets rather than the total: the bounds and sorted endpoints
+  // of the unchanged rowsets are shared with the old tree instead of being
+  // re-fetched and re-sorted.
+  CHECK_OK(new_tree->Reset(old_tree, rowsets_to_remove, rowsets_to_add));
 }
 
 void Tablet::AtomicSwapRowSets(const RowSetVector &old_rowsets,
@@ -1265,11 +1459,53 @@ int32_t Tablet::CurrentMrsIdForTests() const {
   return components_->memrowset->mrs_id();
 }
 
+namespace {
+
+// Process-wide parent throttler shared by all tablets, created on first use
+// from the --tserver_throttler_* flags, or nullptr if server-wide write
+// throttling is disabled.
+Throttler* g_tserver_throttler = nullptr;
+GoogleOnceType g_tserver_throttler_once = GOOGLE_ONCE_INIT;
+
+void InitTserverThrottler() {
+  if (FLAGS_tserver_throttler_rpc_per_sec > 0 ||
+      FLAGS_tserver_throttler_bytes_per_sec > 0) {
+    g_tserver_throttler = new Throttler(MonoTime::Now(),
+                                        FLAGS_tserver_throttler_rpc_per_sec,
+                                        FLAGS_tserver_throttler_bytes_per_sec,
+                                        FLAGS_tserver_throttler_burst_factor);
+  }
+}
+
+} // anonymous namespace
+
 bool Tablet::ShouldThrottleAllow(int64_t bytes) {
-  if (!throttler_) {
+  GoogleOnceInit(&g_tserver_throttler_once, &InitTserverThrottler);
+  if (!throttler_ && !g_tserver_throttler) {
     return true;
   }
-  return throttler_->Take(MonoTime::Now(), 1, bytes);
+  MonoTime now = MonoTime::Now();
+  // Check the per-tablet bucket first: a tablet which is over its own budget
+  // should be rejected without consuming any of the server-wide budget, so
+  // that one hot tablet can't starve the others.
+  if (throttler_ && !throttler_->Take(now, 1, bytes)) {
+    if (metrics_) {
+      metrics_->throttler_rejections->Increment();
+    }
+    return false;
+  }
+  if (g_tserver_throttler && !g_tserver_throttler->Take(now, 1, bytes)) {
+    // Give the per-tablet tokens back so that this tablet isn't penalized
+    // for server-wide pressure.
+    if (throttler_) {
+      throttler_->Refund(1, bytes);
+    }
+    if (metrics_) {
+      metrics_->throttler_rejections_server_wide->Increment();
+    }
+    return false;
+  }
+  return true;
 }
 
 Status Tablet::PickRowSetsToCompact(RowSetsInCompaction *picked,
@@ -1718,6 +1954,8 @@ Status Tablet::CaptureConsistentIterators(
   const MvccSnapshot &snap,
   const ScanSpec *spec,
   OrderMode order,
+  bool point_lookup,
+  Timestamp diff_scan_lower_bound,
   vector<shared_ptr<RowwiseIterator> > *iters) const {
   shared_lock<rw_spinlock> l(component_lock_);
 
@@ -1741,7 +1979,41 @@ Status Tablet::CaptureConsistentIterators(
         spec->lower_bound_key()->encoded_key(),
         spec->exclusive_upper_bound_key()->encoded_key(),
         &interval_sets);
+
+    // For point lookups, additionally consult the rowsets' bloom filters: a
+    // rowset whose bloom proves that the key was never inserted into it can't
+    // contribute anything to the result, at any snapshot.
+    BloomKeyProbe probe;
+    ProbeStats stats;
+    if (point_lookup) {
+      probe = BloomKeyProbe(spec->lower_bound_key()->encoded_key());
+    }
+
     for (const RowSet *rs : interval_sets) {
+      if (point_lookup) {
+        bool maybe_present;
+        RETURN_NOT_OK_PREPEND(rs->CheckKeyMaybePresent(probe, &maybe_present, &stats),
+                              Substitute("Could not check bloom filter for rowset $0",
+                                         rs->ToString()));
+        if (!maybe_present) continue;
+      }
+      if (diff_scan_lower_bound != Timestamp::kInvalidTimestamp &&
+          !rs->MayHaveRowsChangedAtOrAfter(diff_scan_lower_bound)) {
+        continue;
+      }
+      // Consult per-column min/max statistics: a rowset whose value ranges
+      // can't satisfy the scan's predicates contributes no rows.
+      if (!rs->MayMatchColumnPredicates(*spec)) {
+        continue;
+      }
+      // The interval tree query above is inclusive on both ends, but the
+      // scan's upper bound is exclusive: drop a rowset which only touches
+      // the scanned interval at exactly the upper bound key.
+      string min_key, max_key;
+      if (rs->GetBounds(&min_key, &max_key).ok() &&
+          spec->exclusive_upper_bound_key()->encoded_key().compare(Slice(min_key)) <= 0) {
+        continue;
+      }
       gscoped_ptr<RowwiseIterator> row_it;
       RETURN_NOT_OK_PREPEND(rs->NewRowIterator(projection, snap, order, &row_it),
                             Substitute("Could not create iterator for rowset $0",
@@ -1754,7 +2026,33 @@ Status Tablet::CaptureConsistentIterators(
 
   // If there are no encoded predicates or they represent an open-ended range, then
   // fall back to grabbing all rowset iterators
+  //
+  // An open-ended range can't be culled by the rowset interval tree above,
+  // but we can still compare the bound we do have against each rowset's
+  // actual resident key range and skip rowsets which provably contain no
+  // part of the scanned interval.
+  const EncodedKey* lower_bound = spec != nullptr ? spec->lower_bound_key() : nullptr;
+  const EncodedKey* upper_bound = spec != nullptr ? spec->exclusive_upper_bound_key() : nullptr;
   for (const shared_ptr<RowSet> &rs : components_->rowsets->all_rowsets()) {
+    if (diff_scan_lower_bound != Timestamp::kInvalidTimestamp &&
+        !rs->MayHaveRowsChangedAtOrAfter(diff_scan_lower_bound)) {
+      continue;
+    }
+    if (spec != nullptr && !rs->MayMatchColumnPredicates(*spec)) {
+      continue;
+    }
+    if (lower_bound != nullptr || upper_bound != nullptr) {
+      // If the bounds aren't available (e.g. the rowset is in the process of
+      // being written), conservatively include the rowset.
+      string min_key, max_key;
+      if (rs->GetBounds(&min_key, &max_key).ok() &&
+          ((upper_bound != nullptr &&
+            upper_bound->encoded_key().compare(Slice(min_key)) <= 0) ||
+           (lower_bound != nullptr &&
+            lower_bound->encoded_key().compare(Slice(max_key)) > 0))) {
+        continue;
+      }
+    }
     gscoped_ptr<RowwiseIterator> row_it;
     RETURN_NOT_OK_PREPEND(rs->NewRowIterator(projection, snap, order, &row_it),
                           Substitute("Could not create iterator for rowset $0",
@@ -1834,6 +2132,77 @@ size_t Tablet::OnDiskDataSize() const {
   return ret;
 }
 
+Status Tablet::SplitKeyRange(const Slice& start_key,
+                             const Slice& stop_key,
+                             uint64_t target_chunk_size_bytes,
+                             vector<KeyRangePB>* ranges) const {
+  scoped_refptr<TabletComponents> comps;
+  GetComponents(&comps);
+
+  // Collect the upper bound and base data size of every rowset that has
+  // known bounds and overlaps the requested range. The rowset upper bounds
+  // are the candidate split points; in-memory data has no bounds and is
+  // ignored, so the size estimates only cover base data.
+  vector<pair<string, uint64_t>> candidates;
+  if (comps) {
+    for (const shared_ptr<RowSet>& rowset : comps->rowsets->all_rowsets()) {
+      string min_key, max_key;
+      if (!rowset->GetBounds(&min_key, &max_key).ok()) {
+        continue;
+      }
+      if (!stop_key.empty() && Slice(min_key).compare(stop_key) >= 0) {
+        continue;
+      }
+      if (!start_key.empty() && Slice(max_key).compare(start_key) < 0) {
+        continue;
+      }
+      candidates.emplace_back(std::move(max_key), rowset->OnDiskBaseDataSize());
+    }
+  }
+  std::sort(candidates.begin(), candidates.end());
+
+  // Walk the candidate split points in key order, accumulating size
+  // estimates and cutting a new range each time the accumulated size
+  // reaches the target chunk size.
+  string cur_start = start_key.ToString();
+  uint64_t cur_size = 0;
+  for (const auto& candidate : candidates) {
+    cur_size += candidate.second;
+    if (target_chunk_size_bytes == 0 || cur_size < target_chunk_size_bytes) {
+      continue;
+    }
+    // Never split past the requested stop key, and skip degenerate empty
+    // ranges (e.g. when multiple rowsets share an upper bound).
+    if (!stop_key.empty() && Slice(candidate.first).compare(stop_key) >= 0) {
+      break;
+    }
+    if (Slice(candidate.first).compare(Slice(cur_start)) <= 0) {
+      continue;
+    }
+    KeyRangePB range;
+    if (!cur_start.empty()) {
+      range.set_start_primary_key(cur_start);
+    }
+    range.set_stop_primary_key(candidate.first);
+    range.set_size_bytes_estimate(cur_size);
+    ranges->emplace_back(std::move(range));
+    cur_start = candidate.first;
+    cur_size = 0;
+  }
+
+  // The final range extends to the requested stop key.
+  KeyRangePB range;
+  if (!cur_start.empty()) {
+    range.set_start_primary_key(cur_start);
+  }
+  if (!stop_key.empty()) {
+    range.set_stop_primary_key(stop_key.ToString());
+  }
+  range.set_size_bytes_estimate(cur_size);
+  ranges->emplace_back(std::move(range));
+  return Status::OK();
+}
+
 size_t Tablet::DeltaMemStoresSize() const {
   scoped_refptr<TabletComponents> comps;
   GetComponents(&comps);
@@ -1875,34 +2244,57 @@ void Tablet::GetInfoForBestDMSToFlush(const ReplaySizeMap& replay_size_map,
 
 Status Tablet::FlushDMSWithHighestRetention(const ReplaySizeMap& replay_size_map) const {
   RETURN_IF_STOPPED_OR_CHECK_STATE(kOpen);
-  shared_ptr<RowSet> rowset = FindBestDMSToFlush(replay_size_map);
-  if (rowset) {
-    return rowset->FlushDeltas();
+  // Each rowset's delta flush swaps a fresh DMS in place of the frozen one
+  // before streaming it to disk, and takes only that rowset's flush lock, so
+  // flushing several rowsets here doesn't block concurrent updates any longer
+  // than flushing one would.
+  for (const shared_ptr<RowSet>& rowset : FindBestDMSsToFlush(replay_size_map)) {
+    RETURN_NOT_OK(rowset->FlushDeltas());
   }
   return Status::OK();
 }
 
 shared_ptr<RowSet> Tablet::FindBestDMSToFlush(const ReplaySizeMap& replay_size_map) const {
+  vector<shared_ptr<RowSet>> best = FindBestDMSsToFlush(replay_size_map);
+  return best.empty() ? nullptr : best[0];
+}
+
+vector<shared_ptr<RowSet>> Tablet::FindBestDMSsToFlush(
+    const ReplaySizeMap& replay_size_map) const {
   scoped_refptr<TabletComponents> comps;
   GetComponents(&comps);
-  int64_t mem_size = 0;
-  int64_t retention_size = 0;
-  shared_ptr<RowSet> best_dms;
+
+  struct Candidate {
+    int64_t retention_size;
+    int64_t mem_size;
+    shared_ptr<RowSet> rowset;
+  };
+  vector<Candidate> candidates;
   for (const shared_ptr<RowSet> &rowset : comps->rowsets->all_rowsets()) {
     if (rowset->DeltaMemStoreEmpty()) {
       continue;
     }
     int64_t size = GetReplaySizeForIndex(rowset->MinUnflushedLogIndex(),
                                          replay_size_map);
-    if ((size > retention_size) ||
-        (size == retention_size &&
-         (rowset->DeltaMemStoreSize() > mem_size))) {
-      mem_size = rowset->DeltaMemStoreSize();
-      retention_size = size;
-      best_dms = rowset;
+    candidates.push_back({ size, rowset->DeltaMemStoreSize(), rowset });
+  }
+  // Prefer the stores anchoring the most WAL, breaking ties by in-memory size.
+  std::sort(candidates.begin(), candidates.end(),
+            [](const Candidate& a, const Candidate& b) {
+              if (a.retention_size != b.retention_size) {
+                return a.retention_size > b.retention_size;
+              }
+              return a.mem_size > b.mem_size;
+            });
+  int max_flushes = std::max(1, FLAGS_tablet_dms_flush_batch_size);
+  vector<shared_ptr<RowSet>> ret;
+  for (const auto& c : candidates) {
+    if (static_cast<int>(ret.size()) >= max_flushes) {
+      break;
     }
+    ret.push_back(c.rowset);
   }
-  return best_dms;
+  return ret;
 }
 
 int64_t Tablet::GetReplaySizeForIndex(int64_t min_log_index,
@@ -2244,11 +2636,15 @@ string Tablet::LogPrefix() const {
 ////////////////////////////////////////////////////////////
 
 Tablet::Iterator::Iterator(const Tablet* tablet, const Schema& projection,
-                           MvccSnapshot snap, const OrderMode order)
+                           MvccSnapshot snap, const OrderMode order,
+                           bool point_lookup,
+                           Timestamp diff_scan_lower_bound)
     : tablet_(tablet),
-      projection_(projection),
+      projection_(SchemaInternTable::GetInstance()->Intern(projection)),
       snap_(std::move(snap)),
-      order_(order) {}
+      order_(order),
+      point_lookup_(point_lookup),
+      diff_scan_lower_bound_(diff_scan_lower_bound) {}
 
 Tablet::Iterator::~Iterator() {}
 
@@ -2260,11 +2656,13 @@ Status Tablet::Iterator::Init(ScanSpec *spec) {
 
   vector<shared_ptr<RowwiseIterator>> iters;
 
-  RETURN_NOT_OK(tablet_->CaptureConsistentIterators(&projection_, snap_, spec, order_, &iters));
+  RETURN_NOT_OK(tablet_->CaptureConsistentIterators(projection_.get(), snap_, spec, order_,
+                                                    point_lookup_, diff_scan_lower_bound_,
+                                                    &iters));
 
   switch (order_) {
     case ORDERED:
-      iter_.reset(new MergeIterator(projection_, std::move(iters)));
+      iter_.reset(new MergeIterator(*projection_, std::move(iters)));
       break;
     case UNORDERED:
     default:
@@ -25,6 +25,7 @@
 #include <mutex>
 #include <ostream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <glog/logging.h>
@@ -34,6 +35,7 @@
 #include "kudu/common/common.pb.h"
 #include "kudu/common/iterator.h"
 #include "kudu/common/schema.h"
+#include "kudu/common/timestamp.h"
 #include "kudu/gutil/gscoped_ptr.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/port.h"
@@ -132,11 +134,41 @@ class Tablet {
   // 'kStopped' or 'kShutdown' state.
   bool HasBeenStopped() const;
 
+  // The outcome of validating a client write schema against the tablet
+  // schema, cached per-tablet so that steady-state writers which reuse the
+  // same schema don't repay the validation and projection-mapping cost on
+  // every request. Entries are invalidated when the tablet schema changes
+  // (see 'schema_version').
+  struct WriteSchemaState {
+    // The decoded client schema.
+    Schema client_schema;
+
+    // The validated column index mapping: element i is the tablet schema
+    // index of client column i.
+    std::vector<int> client_to_tablet_mapping;
+
+    // The tablet schema version against which the mapping was validated.
+    uint32_t schema_version;
+  };
+
+  // Look up the cached write schema state for the given client schema PB.
+  // Returns NULL if there is no cached state, or if the cached state was
+  // computed against an older tablet schema.
+  std::shared_ptr<const WriteSchemaState> LookupWriteSchemaState(
+      const SchemaPB& client_schema_pb) const;
+
   // Decode the Write (insert/mutate) operations from within a user's
   // request.
   Status DecodeWriteOperations(const Schema* client_schema,
                                WriteTransactionState* tx_state);
 
+  // Like the above, but uses previously-validated schema state returned by
+  // LookupWriteSchemaState(), skipping schema validation and projection
+  // mapping construction. If the tablet schema has changed since 'ws' was
+  // cached, falls back to full validation.
+  Status DecodeWriteOperations(const std::shared_ptr<const WriteSchemaState>& ws,
+                               WriteTransactionState* tx_state);
+
   // Acquire locks for each of the operations in the given txn.
   //
   // Note that, if this fails, it's still possible that the transaction
@@ -197,6 +229,32 @@ class Tablet {
                         const OrderMode order,
                         gscoped_ptr<RowwiseIterator> *iter) const;
 
+  // Like NewRowIterator() above, but for an incremental (diff) scan:
+  // rowsets which provably contain no rows inserted, updated, or deleted
+  // at or after 'diff_scan_lower_bound' are skipped entirely, based on
+  // their delta stats. The skipping is conservative at rowset granularity:
+  // no changed row is ever missed, but unchanged rows which share a rowset
+  // with changed ones (or live in the MemRowSet) are still returned.
+  // 'diff_scan_lower_bound' must not be Timestamp::kInvalidTimestamp.
+  Status NewDiffRowIterator(const Schema& projection,
+                            const MvccSnapshot& snap,
+                            const OrderMode order,
+                            Timestamp diff_scan_lower_bound,
+                            gscoped_ptr<RowwiseIterator>* iter) const;
+
+  // Create a new row iterator optimized for a point lookup of a single row,
+  // yielding rows as of the current MVCC state of this tablet.
+  //
+  // The ScanSpec later passed to Init() must carry lower and exclusive upper
+  // bound keys which span exactly one primary key. In addition to the usual
+  // culling of rowsets whose key ranges don't intersect the bounds, rowsets
+  // whose bloom filters prove the key was never present are skipped entirely
+  // rather than contributing an iterator to the union.
+  //
+  // The returned iterator is not initialized.
+  Status NewPointLookupIterator(const Schema& projection,
+                                gscoped_ptr<RowwiseIterator>* iter) const;
+
   // Flush the current MemRowSet for this tablet to disk. This swaps
   // in a new (initially empty) MemRowSet in its place.
   //
@@ -262,6 +320,19 @@ class Tablet {
   // Includes the tablet superblock.
   size_t OnDiskSize() const;
 
+  // Split the requested key range ['start_key', 'stop_key') into contiguous
+  // sub-ranges covering roughly 'target_chunk_size_bytes' of base data each,
+  // based on the bounds and sizes of the tablet's rowsets. An empty
+  // 'start_key' or 'stop_key' means the range is unbounded on that side.
+  //
+  // The split points are approximate: they fall on rowset boundaries, and
+  // the size estimates ignore deltas and in-memory data. The resulting
+  // ranges (at least one) are appended to 'ranges' in ascending key order.
+  Status SplitKeyRange(const Slice& start_key,
+                       const Slice& stop_key,
+                       uint64_t target_chunk_size_bytes,
+                       std::vector<KeyRangePB>* ranges) const;
+
   // Returns the on-disk size of this tablet's data, in bytes.
   // Excludes all metadata (both tablet metadata and the metadata of this tablet's rowsets).
   size_t OnDiskDataSize() const;
@@ -277,7 +348,8 @@ class Tablet {
   void GetInfoForBestDMSToFlush(const ReplaySizeMap& replay_size_map,
                                 int64_t* mem_size, int64_t* replay_size) const;
 
-  // Flushes the DMS with the highest retention.
+  // Flushes up to --tablet_dms_flush_batch_size DMSes, starting with the one
+  // with the highest retention.
   Status FlushDMSWithHighestRetention(const ReplaySizeMap& replay_size_map) const;
 
   // Flush only the biggest DMS
@@ -545,10 +617,16 @@ class Tablet {
   //
   // The returned iterators are not Init()ed.
   // 'projection' must remain valid and unchanged for the lifetime of the returned iterators.
+  // If 'point_lookup' is true, 'spec' is expected to bound a single primary
+  // key, and rowsets whose bloom filters prove the key absent are culled.
+  // If 'diff_scan_lower_bound' is a valid timestamp, rowsets with no
+  // mutations at or after it are culled (see NewDiffRowIterator()).
   Status CaptureConsistentIterators(const Schema *projection,
                                     const MvccSnapshot &snap,
                                     const ScanSpec *spec,
                                     OrderMode order,
+                                    bool point_lookup,
+                                    Timestamp diff_scan_lower_bound,
                                     std::vector<std::shared_ptr<RowwiseIterator> > *iters) const;
 
   Status PickRowSetsToCompact(RowSetsInCompaction *picked,
@@ -600,21 +678,37 @@ class Tablet {
   Status FlushInternal(const RowSetsInCompaction& input,
                        const std::shared_ptr<MemRowSet>& old_ms);
 
-  // Convert the specified read client schema (without IDs) to a server schema (with IDs)
+  // Convert the specified read client schema (without IDs) to a server schema (with IDs).
+  // Both the input and output are interned handles; the mapping is computed at
+  // most once per (tablet schema, projection) pair and cached in the
+  // process-wide SchemaInternTable.
   // This method is used by NewRowIterator().
-  Status GetMappedReadProjection(const Schema& projection,
-                                 Schema *mapped_projection) const;
+  Status GetMappedReadProjection(const std::shared_ptr<const Schema>& projection,
+                                 std::shared_ptr<const Schema>* mapped_projection) const;
 
   Status CheckRowInTablet(const ConstContiguousRow& row) const;
 
   // Helper method to find the rowset that has the DMS with the highest retention.
   std::shared_ptr<RowSet> FindBestDMSToFlush(const ReplaySizeMap& replay_size_map) const;
 
+  // Helper method to find up to --tablet_dms_flush_batch_size rowsets with
+  // non-empty DMSes, ordered by descending retention and then by descending
+  // in-memory size.
+  std::vector<std::shared_ptr<RowSet>> FindBestDMSsToFlush(
+      const ReplaySizeMap& replay_size_map) const;
+
   // Helper method to find how many bytes need to be replayed to restore in-memory
   // state from this index.
   static int64_t GetReplaySizeForIndex(int64_t min_log_index,
                                        const ReplaySizeMap& size_map);
 
+  // Decode the write operations in 'tx_state' using 'client_schema',
+  // performing full schema validation and caching the validated state for
+  // later requests. The caller must have already acquired 'schema_lock_' in
+  // shared mode via 'tx_state'.
+  Status DecodeWriteOperationsUnlocked(const Schema* client_schema,
+                                       WriteTransactionState* tx_state);
+
   // Test-only lock that synchronizes access to AssignTimestampAndStartTransactionForTests().
   // Tests that use LocalTabletWriter take this lock to synchronize timestamp assignment,
   // transaction start and safe time adjustment.
@@ -634,6 +728,15 @@ class Tablet {
   // released after the schema change has been applied.
   mutable rw_semaphore schema_lock_;
 
+  // Protects 'write_schema_cache_'.
+  mutable simple_spinlock write_schema_cache_lock_;
+
+  // Cache of validated client write schemas, keyed by the serialized client
+  // SchemaPB. Entries whose schema version no longer matches the tablet's
+  // are lazily evicted on lookup. See LookupWriteSchemaState().
+  mutable std::unordered_map<std::string, std::shared_ptr<const WriteSchemaState>>
+      write_schema_cache_;
+
   const Schema key_schema_;
 
   scoped_refptr<TabletMetadata> metadata_;
@@ -751,7 +854,7 @@ class Tablet::Iterator : public RowwiseIterator {
   std::string ToString() const OVERRIDE;
 
   const Schema &schema() const OVERRIDE {
-    return projection_;
+    return *projection_;
   }
 
   virtual void GetIteratorStats(std::vector<IteratorStats>* stats) const OVERRIDE;
@@ -762,12 +865,18 @@ class Tablet::Iterator : public RowwiseIterator {
   DISALLOW_COPY_AND_ASSIGN(Iterator);
 
   Iterator(const Tablet* tablet, const Schema& projection, MvccSnapshot snap,
-           const OrderMode order);
+           const OrderMode order, bool point_lookup,
+           Timestamp diff_scan_lower_bound);
 
   const Tablet *tablet_;
-  Schema projection_;
+  // Interned handle; replaced by the mapped read projection during Init().
+  std::shared_ptr<const Schema> projection_;
   const MvccSnapshot snap_;
   const OrderMode order_;
+  const bool point_lookup_;
+  // If not kInvalidTimestamp, rowsets with no mutations at or after this
+  // timestamp are skipped entirely (see NewDiffRowIterator()).
+  const Timestamp diff_scan_lower_bound_;
   gscoped_ptr<RowwiseIterator> iter_;
 };
 
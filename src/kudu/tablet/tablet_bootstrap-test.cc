@@ -28,6 +28,7 @@
 #include <vector>
 
 #include <boost/optional/optional.hpp>
+#include <gflags/gflags_declare.h>
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
@@ -78,6 +79,8 @@
 #include "kudu/util/status.h"
 #include "kudu/util/test_macros.h"
 
+DECLARE_bool(bootstrap_parallel_replay);
+
 using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
@@ -243,6 +246,34 @@ TEST_F(BootstrapTest, TestBootstrap) {
   ASSERT_EQ(1, results.size());
 }
 
+// Tests that replay with --bootstrap_parallel_replay enabled produces the
+// same result as the default single-threaded replay, across several log
+// segments.
+TEST_F(BootstrapTest, TestParallelReplay) {
+  FLAGS_bootstrap_parallel_replay = true;
+
+  ASSERT_OK(BuildLog());
+
+  const int kNumOps = 10;
+  for (int i = 0; i < kNumOps; i++) {
+    AppendReplicateBatch(MakeOpId(1, current_index_));
+    AppendCommit(MakeOpId(1, current_index_));
+    current_index_++;
+    // Roll frequently so that replay has several segments to pipeline.
+    if (i % 3 == 0) {
+      ASSERT_OK(RollLog());
+    }
+  }
+
+  shared_ptr<Tablet> tablet;
+  ConsensusBootstrapInfo boot_info;
+  ASSERT_OK(BootstrapTestTablet(-1, -1, &tablet, &boot_info));
+
+  vector<string> results;
+  IterateTabletRows(tablet.get(), &results);
+  ASSERT_EQ(kNumOps, results.size());
+}
+
 // Test that we don't overflow opids. Regression test for KUDU-1933.
 TEST_F(BootstrapTest, TestBootstrapHighOpIdIndex) {
   // Start appending with a log index 3 under the int32 max value.
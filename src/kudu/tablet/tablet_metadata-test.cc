@@ -25,7 +25,10 @@
 
 #include "kudu/common/partial_row.h"
 #include "kudu/common/wire_protocol-test-util.h"
+#include "kudu/fs/data_dirs.h"
+#include "kudu/fs/fs_manager.h"
 #include "kudu/gutil/gscoped_ptr.h"
+#include "kudu/gutil/ref_counted.h"
 #include "kudu/gutil/port.h"
 #include "kudu/tablet/local_tablet_writer.h"
 #include "kudu/tablet/metadata.pb.h"
@@ -106,6 +109,44 @@ TEST_F(TestTabletMetadata, TestLoadFromSuperBlock) {
             << pb_util::SecureDebugString(superblock_pb_1);
 }
 
+// Test that metadata changes persisted via incremental metadata log records
+// are recovered when the metadata is reloaded from disk.
+TEST_F(TestTabletMetadata, TestIncrementalFlushAndReload) {
+  // Flush a couple of rowsets. The superblock was written when the tablet
+  // was created, so these flushes append records to the metadata log
+  // instead of rewriting it.
+  gscoped_ptr<KuduPartialRow> row;
+  BuildPartialRow(0, 0, "foo", &row);
+  writer_->Insert(*row);
+  ASSERT_OK(harness_->tablet()->Flush());
+  BuildPartialRow(1, 1, "bar", &row);
+  writer_->Insert(*row);
+  ASSERT_OK(harness_->tablet()->Flush());
+
+  TabletMetadata* meta = harness_->tablet()->metadata();
+  ASSERT_EQ(2, meta->rowsets().size());
+
+  harness_->tablet()->Shutdown();
+
+  // Reload the metadata from disk and verify that the rowsets flushed above
+  // were recovered by replaying the metadata log. The data dir group must be
+  // deregistered first so the reloaded metadata can re-register it.
+  harness_->fs_manager()->dd_manager()->DeleteDataDirGroup(meta->tablet_id());
+  scoped_refptr<TabletMetadata> reloaded;
+  ASSERT_OK(TabletMetadata::Load(harness_->fs_manager(), meta->tablet_id(), &reloaded));
+  ASSERT_EQ(2, reloaded->rowsets().size());
+  ASSERT_EQ(meta->last_durable_mrs_id(), reloaded->last_durable_mrs_id());
+
+  TabletSuperBlockPB superblock_pb_1;
+  ASSERT_OK(meta->ToSuperBlock(&superblock_pb_1));
+  TabletSuperBlockPB superblock_pb_2;
+  ASSERT_OK(reloaded->ToSuperBlock(&superblock_pb_2));
+  ASSERT_EQ(superblock_pb_1.SerializeAsString(),
+            superblock_pb_2.SerializeAsString())
+    << pb_util::SecureDebugString(superblock_pb_1)
+    << pb_util::SecureDebugString(superblock_pb_2);
+}
+
 TEST_F(TestTabletMetadata, TestOnDiskSize) {
   TabletMetadata* meta = harness_->tablet()->metadata();
 
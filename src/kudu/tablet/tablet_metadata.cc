@@ -47,11 +47,21 @@
 #include "kudu/util/env.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/logging.h"
+#include "kudu/util/path_util.h"
 #include "kudu/util/pb_util.h"
 #include "kudu/util/scoped_cleanup.h"
 #include "kudu/util/status.h"
 #include "kudu/util/trace.h"
 
+DEFINE_int32(tablet_metadata_log_max_entries, 100,
+             "Maximum number of incremental records appended to a tablet's "
+             "metadata log before the full superblock is rewritten. Rowset "
+             "changes within this window are persisted as small appended "
+             "records instead of rewriting the whole superblock, so metadata "
+             "I/O does not scale with the number of rowsets in the tablet. "
+             "0 disables incremental metadata flushes entirely.");
+TAG_FLAG(tablet_metadata_log_max_entries, experimental);
+
 DEFINE_bool(enable_tablet_orphaned_block_deletion, true,
             "Whether to enable deletion of orphaned blocks from disk. "
             "Note: This is only exposed for debugging purposes!");
@@ -64,8 +74,10 @@ using kudu::consensus::MinimumOpId;
 using kudu::consensus::OpId;
 using kudu::fs::BlockManager;
 using kudu::fs::BlockDeletionTransaction;
+using kudu::pb_util::ReadablePBContainerFile;
 using kudu::pb_util::SecureDebugString;
 using kudu::pb_util::SecureShortDebugString;
+using kudu::pb_util::WritablePBContainerFile;
 using std::memory_order_relaxed;
 using std::shared_ptr;
 using std::string;
@@ -213,6 +225,7 @@ Status TabletMetadata::DeleteTabletData(TabletDataState delete_type,
     if (last_logged_opid) {
       tombstone_last_logged_opid_ = last_logged_opid;
     }
+    needs_full_flush_ = true;
   }
 
   // Keep a copy of the old data dir group in case of flush failure.
@@ -247,6 +260,7 @@ bool TabletMetadata::IsTombstonedWithNoBlocks() const {
 }
 
 Status TabletMetadata::DeleteSuperBlock() {
+  MutexLock l_flush(flush_lock_);
   std::lock_guard<LockType> l(data_lock_);
   if (!orphaned_blocks_.empty()) {
     return Status::InvalidArgument("The metadata for tablet " + tablet_id_ +
@@ -263,6 +277,15 @@ Status TabletMetadata::DeleteSuperBlock() {
                    tablet_data_state_));
   }
 
+  // Close and remove the metadata log, if any, before the superblock: a
+  // leftover log without a superblock would be orphaned forever.
+  metadata_log_.reset();
+  string log_path = fs_manager_->GetTabletMetadataLogPath(tablet_id_);
+  if (fs_manager_->env()->FileExists(log_path)) {
+    RETURN_NOT_OK_PREPEND(fs_manager_->env()->DeleteFile(log_path),
+                          "Unable to delete metadata log for tablet " + tablet_id_);
+  }
+
   string path = fs_manager_->GetTabletMetadataPath(tablet_id_);
   RETURN_NOT_OK_PREPEND(fs_manager_->env()->DeleteFile(path),
                         "Unable to delete superblock for tablet " + tablet_id_);
@@ -290,6 +313,9 @@ TabletMetadata::TabletMetadata(FsManager* fs_manager, string tablet_id,
       tombstone_last_logged_opid_(std::move(tombstone_last_logged_opid)),
       num_flush_pins_(0),
       needs_flush_(false),
+      needs_full_flush_(true),
+      metadata_log_epoch_(0),
+      metadata_log_entries_(0),
       pre_flush_callback_(Bind(DoNothingStatusClosure)) {
   CHECK(schema_->has_column_ids());
   CHECK_GT(schema_->num_key_columns(), 0);
@@ -308,6 +334,9 @@ TabletMetadata::TabletMetadata(FsManager* fs_manager, string tablet_id)
       schema_(nullptr),
       num_flush_pins_(0),
       needs_flush_(false),
+      needs_full_flush_(true),
+      metadata_log_epoch_(0),
+      metadata_log_entries_(0),
       pre_flush_callback_(Bind(DoNothingStatusClosure)) {}
 
 Status TabletMetadata::LoadFromDisk() {
@@ -320,6 +349,9 @@ Status TabletMetadata::LoadFromDisk() {
   RETURN_NOT_OK(ReadSuperBlockFromDisk(&superblock));
   RETURN_NOT_OK_PREPEND(LoadFromSuperBlock(superblock),
                         "Failed to load data from superblock protobuf");
+  metadata_log_epoch_ = superblock.metadata_log_epoch();
+  RETURN_NOT_OK_PREPEND(ReplayMetadataLog(superblock),
+                        "Failed to replay tablet metadata log");
   RETURN_NOT_OK(UpdateOnDiskSize());
   state_ = kInitialized;
   return Status::OK();
@@ -329,10 +361,118 @@ Status TabletMetadata::UpdateOnDiskSize() {
   string path = fs_manager_->GetTabletMetadataPath(tablet_id_);
   uint64_t on_disk_size;
   RETURN_NOT_OK(fs_manager()->env()->GetFileSize(path, &on_disk_size));
+
+  // Include the incremental metadata log, if any.
+  string log_path = fs_manager_->GetTabletMetadataLogPath(tablet_id_);
+  uint64_t log_size;
+  if (fs_manager()->env()->FileExists(log_path) &&
+      fs_manager()->env()->GetFileSize(log_path, &log_size).ok()) {
+    on_disk_size += log_size;
+  }
   on_disk_size_.store(on_disk_size, memory_order_relaxed);
   return Status::OK();
 }
 
+Status TabletMetadata::ReplayMetadataLog(const TabletSuperBlockPB& superblock) {
+  string path = fs_manager_->GetTabletMetadataLogPath(tablet_id_);
+  Env* env = fs_manager_->env();
+  if (!env->FileExists(path)) {
+    return Status::OK();
+  }
+
+  unique_ptr<RandomAccessFile> reader;
+  RETURN_NOT_OK_PREPEND(env->NewRandomAccessFile(path, &reader),
+                        Substitute("Couldn't open metadata log $0", path));
+  ReadablePBContainerFile pb_reader(std::move(reader));
+  RETURN_NOT_OK_PREPEND(pb_reader.Open(),
+                        Substitute("Couldn't read metadata log header from $0", path));
+
+  const int64_t epoch = superblock.metadata_log_epoch();
+  int num_replayed = 0;
+  vector<BlockId> orphaned;
+  BlockId max_block_id;
+  while (true) {
+    TabletMetadataDeltaPB delta;
+    Status s = pb_reader.ReadNextPB(&delta);
+    if (s.IsEndOfFile()) {
+      break;
+    }
+    if (s.IsIncomplete()) {
+      // A crash during an append may leave a partial record at the tail of
+      // the log. Everything before it was synced, so it's safe to ignore.
+      LOG_WITH_PREFIX(INFO) << "Ignoring partial record at tail of metadata log " << path;
+      break;
+    }
+    RETURN_NOT_OK_PREPEND(s, Substitute("Corrupt metadata log $0", path));
+    if (delta.epoch() != epoch) {
+      // A record written against an earlier superblock; the superblock
+      // already reflects it.
+      continue;
+    }
+
+    std::lock_guard<LockType> l(data_lock_);
+    for (uint64_t removed_pb_id : delta.rowsets_removed()) {
+      const int64_t removed_id = static_cast<int64_t>(removed_pb_id);
+      auto it = rowsets_.begin();
+      while (it != rowsets_.end()) {
+        if ((*it)->id() == removed_id) {
+          it = rowsets_.erase(it);
+        } else {
+          it++;
+        }
+      }
+    }
+    for (const RowSetDataPB& rowset_pb : delta.rowsets_upserted()) {
+      unique_ptr<RowSetMetadata> rowset_meta;
+      RETURN_NOT_OK(RowSetMetadata::Load(this, rowset_pb, &rowset_meta));
+      next_rowset_idx_ = std::max(next_rowset_idx_, rowset_meta->id() + 1);
+      for (const BlockId& block_id : rowset_meta->GetAllBlocks()) {
+        max_block_id = std::max(max_block_id, block_id);
+      }
+      shared_ptr<RowSetMetadata> new_rowset(rowset_meta.release());
+      bool replaced = false;
+      for (auto& rowset : rowsets_) {
+        if (rowset->id() == new_rowset->id()) {
+          rowset = new_rowset;
+          replaced = true;
+          break;
+        }
+      }
+      if (!replaced) {
+        rowsets_.push_back(std::move(new_rowset));
+      }
+    }
+    if (delta.has_last_durable_mrs_id()) {
+      last_durable_mrs_id_ = delta.last_durable_mrs_id();
+    }
+    vector<BlockId> delta_orphans;
+    for (const BlockIdPB& block_pb : delta.orphaned_blocks()) {
+      BlockId orphaned_block_id = BlockId::FromPB(block_pb);
+      max_block_id = std::max(max_block_id, orphaned_block_id);
+      delta_orphans.push_back(orphaned_block_id);
+    }
+    AddOrphanedBlocksUnlocked(delta_orphans);
+    orphaned.insert(orphaned.end(), delta_orphans.begin(), delta_orphans.end());
+    num_replayed++;
+  }
+
+  if (num_replayed > 0) {
+    LOG_WITH_PREFIX(INFO) << Substitute("Replayed $0 record(s) from metadata log $1",
+                                        num_replayed, path);
+    // Notify the block manager of any blocks it may not have seen in the
+    // superblock.
+    fs_manager()->block_manager()->NotifyBlockId(max_block_id);
+  }
+
+  // As when loading the superblock, clean up any orphaned blocks recorded in
+  // the log; a crash may have prevented their deletion.
+  if (!fs_manager()->read_only()) {
+    DeleteOrphanedBlocks(orphaned);
+  }
+
+  return Status::OK();
+}
+
 Status TabletMetadata::LoadFromSuperBlock(const TabletSuperBlockPB& superblock) {
   vector<BlockId> orphaned_blocks;
 
@@ -342,6 +482,13 @@ Status TabletMetadata::LoadFromSuperBlock(const TabletSuperBlockPB& superblock)
   {
     std::lock_guard<LockType> l(data_lock_);
 
+    // The in-memory state now comes wholesale from 'superblock'; any pending
+    // incremental changes are obsolete and the next flush must rewrite the
+    // full superblock.
+    pending_delta_.Clear();
+    dirty_rowsets_.clear();
+    needs_full_flush_ = true;
+
     // Verify that the tablet id matches with the one in the protobuf
     if (superblock.tablet_id() != tablet_id_) {
       return Status::Corruption("Expected id=" + tablet_id_ +
@@ -473,6 +620,14 @@ void TabletMetadata::AddOrphanedBlocks(const vector<BlockId>& blocks) {
 void TabletMetadata::AddOrphanedBlocksUnlocked(const vector<BlockId>& blocks) {
   DCHECK(data_lock_.is_locked());
   orphaned_blocks_.insert(blocks.begin(), blocks.end());
+  for (const BlockId& block_id : blocks) {
+    block_id.CopyToPB(pending_delta_.add_orphaned_blocks());
+  }
+}
+
+void TabletMetadata::MarkRowSetMetadataDirty(int64_t rowset_id) {
+  std::lock_guard<LockType> l(data_lock_);
+  dirty_rowsets_.insert(rowset_id);
 }
 
 void TabletMetadata::DeleteOrphanedBlocks(const vector<BlockId>& blocks) {
@@ -519,6 +674,16 @@ Status TabletMetadata::UnPinFlush() {
   return Status::OK();
 }
 
+namespace {
+// Returns true if 'delta' records no changes at all.
+bool IsDeltaEmpty(const TabletMetadataDeltaPB& delta) {
+  return delta.rowsets_upserted_size() == 0 &&
+      delta.rowsets_removed_size() == 0 &&
+      !delta.has_last_durable_mrs_id() &&
+      delta.orphaned_blocks_size() == 0;
+}
+} // anonymous namespace
+
 Status TabletMetadata::Flush() {
   TRACE_EVENT1("tablet", "TabletMetadata::Flush",
                "tablet_id", tablet_id_);
@@ -526,6 +691,8 @@ Status TabletMetadata::Flush() {
   MutexLock l_flush(flush_lock_);
   vector<BlockId> orphaned;
   TabletSuperBlockPB pb;
+  TabletMetadataDeltaPB delta;
+  bool incremental;
   {
     std::lock_guard<LockType> l(data_lock_);
     CHECK_GE(num_flush_pins_, 0);
@@ -536,7 +703,27 @@ Status TabletMetadata::Flush() {
     }
     needs_flush_ = false;
 
-    RETURN_NOT_OK(ToSuperBlockUnlocked(&pb, rowsets_));
+    // If all changes since the last flush are expressible as an incremental
+    // metadata log record and the log hasn't hit its checkpoint limit,
+    // append a record instead of rewriting the whole superblock.
+    incremental = metadata_log_ != nullptr &&
+        !needs_full_flush_ &&
+        metadata_log_entries_ < FLAGS_tablet_metadata_log_max_entries;
+    if (incremental) {
+      delta.Swap(&pending_delta_);
+      delta.set_epoch(metadata_log_epoch_);
+      for (const shared_ptr<RowSetMetadata>& rowset : rowsets_) {
+        if (ContainsKey(dirty_rowsets_, rowset->id())) {
+          rowset->ToProtobuf(delta.add_rowsets_upserted());
+        }
+      }
+      dirty_rowsets_.clear();
+    } else {
+      RETURN_NOT_OK(ToSuperBlockUnlocked(&pb, rowsets_));
+      pending_delta_.Clear();
+      dirty_rowsets_.clear();
+      needs_full_flush_ = false;
+    }
 
     // Make a copy of the orphaned blocks list which corresponds to the superblock
     // that we're writing. It's important to take this local copy to avoid a race
@@ -547,7 +734,32 @@ Status TabletMetadata::Flush() {
     orphaned.assign(orphaned_blocks_.begin(), orphaned_blocks_.end());
   }
   pre_flush_callback_.Run();
-  RETURN_NOT_OK(ReplaceSuperBlockUnlocked(pb));
+  if (incremental) {
+    Status s = IsDeltaEmpty(delta) ? Status::OK() : AppendMetadataDeltaUnlocked(delta);
+    if (PREDICT_FALSE(!s.ok())) {
+      // Fall back to a full superblock rewrite; the in-memory state is
+      // authoritative, so nothing recorded in 'delta' is lost.
+      LOG_WITH_PREFIX(WARNING) << "Couldn't append to tablet metadata log, "
+                               << "rewriting full superblock: " << s.ToString();
+      std::lock_guard<LockType> l(data_lock_);
+      RETURN_NOT_OK(ToSuperBlockUnlocked(&pb, rowsets_));
+      pending_delta_.Clear();
+      dirty_rowsets_.clear();
+      needs_full_flush_ = false;
+      orphaned.assign(orphaned_blocks_.begin(), orphaned_blocks_.end());
+      incremental = false;
+    }
+  }
+  if (!incremental) {
+    Status s = ReplaceSuperBlockUnlocked(pb);
+    if (PREDICT_FALSE(!s.ok())) {
+      // The superblock on disk may be stale; make sure the next flush
+      // attempt rewrites it rather than appending to the log.
+      std::lock_guard<LockType> l(data_lock_);
+      needs_full_flush_ = true;
+      return s;
+    }
+  }
   TRACE("Metadata flushed");
   l_flush.Unlock();
 
@@ -569,6 +781,7 @@ Status TabletMetadata::UpdateUnlocked(
   if (last_durable_mrs_id != kNoMrsFlushed) {
     DCHECK_GE(last_durable_mrs_id, last_durable_mrs_id_);
     last_durable_mrs_id_ = last_durable_mrs_id;
+    pending_delta_.set_last_durable_mrs_id(last_durable_mrs_id_);
   }
 
   RowSetMetadataVector new_rowsets = rowsets_;
@@ -576,6 +789,11 @@ Status TabletMetadata::UpdateUnlocked(
   while (it != new_rowsets.end()) {
     if (ContainsKey(to_remove, (*it)->id())) {
       AddOrphanedBlocksUnlocked((*it)->GetAllBlocks());
+      // If the rowset was added since the last flush it was never written
+      // to disk, so no removal record is needed (removals of unknown IDs
+      // are ignored at replay time anyway).
+      dirty_rowsets_.erase((*it)->id());
+      pending_delta_.add_rowsets_removed((*it)->id());
       it = new_rowsets.erase(it);
     } else {
       it++;
@@ -583,6 +801,7 @@ Status TabletMetadata::UpdateUnlocked(
   }
 
   for (const shared_ptr<RowSetMetadata>& meta : to_add) {
+    dirty_rowsets_.insert(meta->id());
     new_rowsets.push_back(meta);
   }
   rowsets_ = new_rowsets;
@@ -607,16 +826,79 @@ Status TabletMetadata::ReplaceSuperBlock(const TabletSuperBlockPB &pb) {
 Status TabletMetadata::ReplaceSuperBlockUnlocked(const TabletSuperBlockPB &pb) {
   flush_lock_.AssertAcquired();
 
+  // Write the superblock with a bumped metadata log epoch so that any
+  // previously-written metadata log records are invalidated, even if a crash
+  // prevents us from recreating the log below.
+  TabletSuperBlockPB final_pb = pb;
+  final_pb.set_metadata_log_epoch(metadata_log_epoch_ + 1);
+
   string path = fs_manager_->GetTabletMetadataPath(tablet_id_);
   RETURN_NOT_OK_PREPEND(pb_util::WritePBContainerToPath(
-                            fs_manager_->env(), path, pb,
+                            fs_manager_->env(), path, final_pb,
                             pb_util::OVERWRITE, pb_util::SYNC),
                         Substitute("Failed to write tablet metadata $0", tablet_id_));
+  metadata_log_epoch_++;
+  metadata_log_entries_ = 0;
+
+  // Recreate the metadata log so that subsequent flushes may append
+  // incremental records. Failure here is not fatal: 'metadata_log_' is left
+  // NULL and subsequent flushes rewrite the full superblock.
+  Status s = OpenMetadataLogUnlocked();
+  if (PREDICT_FALSE(!s.ok())) {
+    LOG_WITH_PREFIX(WARNING) << "Couldn't open tablet metadata log: " << s.ToString();
+    metadata_log_.reset();
+  }
+
   RETURN_NOT_OK(UpdateOnDiskSize());
 
   return Status::OK();
 }
 
+Status TabletMetadata::OpenMetadataLogUnlocked() {
+  flush_lock_.AssertAcquired();
+
+  metadata_log_.reset();
+  string path = fs_manager_->GetTabletMetadataLogPath(tablet_id_);
+  Env* env = fs_manager_->env();
+  if (env->FileExists(path)) {
+    RETURN_NOT_OK_PREPEND(env->DeleteFile(path),
+                          Substitute("Couldn't delete old metadata log $0", path));
+  }
+  if (FLAGS_tablet_metadata_log_max_entries <= 0) {
+    // Incremental metadata flushes are disabled.
+    return Status::OK();
+  }
+
+  unique_ptr<RWFile> writer;
+  RWFileOptions opts;
+  opts.mode = Env::CREATE_NON_EXISTING;
+  RETURN_NOT_OK_PREPEND(env->NewRWFile(opts, path, &writer),
+                        Substitute("Couldn't create metadata log $0", path));
+  unique_ptr<WritablePBContainerFile> log(
+      new WritablePBContainerFile(shared_ptr<RWFile>(writer.release())));
+  RETURN_NOT_OK_PREPEND(log->CreateNew(TabletMetadataDeltaPB()),
+                        Substitute("Couldn't write header of metadata log $0", path));
+  RETURN_NOT_OK(log->Sync());
+
+  // Sync the parent directory so the new log file is durable.
+  RETURN_NOT_OK_PREPEND(env->SyncDir(DirName(path)),
+                        Substitute("Couldn't sync parent directory of metadata log $0", path));
+  metadata_log_ = std::move(log);
+  return Status::OK();
+}
+
+Status TabletMetadata::AppendMetadataDeltaUnlocked(const TabletMetadataDeltaPB& delta) {
+  flush_lock_.AssertAcquired();
+  DCHECK(metadata_log_);
+
+  RETURN_NOT_OK(metadata_log_->Append(delta));
+  RETURN_NOT_OK(metadata_log_->Sync());
+  metadata_log_entries_++;
+  RETURN_NOT_OK(UpdateOnDiskSize());
+  TRACE("Appended record to tablet metadata log");
+  return Status::OK();
+}
+
 void TabletMetadata::SetPreFlushCallback(StatusClosure callback) {
   MutexLock l_flush(flush_lock_);
   pre_flush_callback_ = std::move(callback);
@@ -728,11 +1010,13 @@ void TabletMetadata::SetSchemaUnlocked(gscoped_ptr<Schema> new_schema, uint32_t
     old_schemas_.push_back(old_schema);
   }
   schema_version_ = version;
+  needs_full_flush_ = true;
 }
 
 void TabletMetadata::SetTableName(const string& table_name) {
   std::lock_guard<LockType> l(data_lock_);
   table_name_ = table_name;
+  needs_full_flush_ = true;
 }
 
 string TabletMetadata::table_name() const {
@@ -753,6 +1037,7 @@ void TabletMetadata::set_tablet_data_state(TabletDataState state) {
     tombstone_last_logged_opid_ = boost::none;
   }
   tablet_data_state_ = state;
+  needs_full_flush_ = true;
 }
 
 string TabletMetadata::LogPrefix() const {
@@ -49,6 +49,10 @@ namespace consensus {
 class OpId;
 }
 
+namespace pb_util {
+class WritablePBContainerFile;
+}
+
 namespace tablet {
 
 class RowSetMetadata;
@@ -184,6 +188,11 @@ class TabletMetadata : public RefCountedThreadSafe<TabletMetadata> {
   // in a call to DeleteOrphanedBlocks().
   void AddOrphanedBlocks(const std::vector<BlockId>& block_ids);
 
+  // Mark the rowset with 'rowset_id' as having been mutated in place (e.g.
+  // by a DMS flush or delta compaction), so that its current state is
+  // included in the next incremental metadata flush.
+  void MarkRowSetMetadataDirty(int64_t rowset_id);
+
   // Mark the superblock to be in state 'delete_type', sync it to disk, and
   // then delete all of the rowsets in this tablet.
   // The metadata (superblock) is not deleted. For that, call DeleteSuperBlock().
@@ -290,6 +299,23 @@ class TabletMetadata : public RefCountedThreadSafe<TabletMetadata> {
   // Requires 'flush_lock_'.
   Status ReplaceSuperBlockUnlocked(const TabletSuperBlockPB &pb);
 
+  // Append 'delta' to the incremental metadata log and sync it to disk.
+  // The log writer must already be open.
+  // Requires 'flush_lock_'.
+  Status AppendMetadataDeltaUnlocked(const TabletMetadataDeltaPB& delta);
+
+  // Open (creating if necessary) the incremental metadata log for writing.
+  // Called after a full superblock write; any records from an earlier epoch
+  // are discarded.
+  // Requires 'flush_lock_'.
+  Status OpenMetadataLogUnlocked();
+
+  // Replay any incremental metadata log records on top of the state loaded
+  // from 'superblock'. Records whose epoch doesn't match the superblock's
+  // are ignored, as is a partial record at the tail of the log (the result
+  // of a crash mid-append).
+  Status ReplayMetadataLog(const TabletSuperBlockPB& superblock);
+
   // Requires 'data_lock_'.
   Status UpdateUnlocked(const RowSetMetadataIds& to_remove,
                         const RowSetMetadataVector& to_add,
@@ -371,6 +397,34 @@ class TabletMetadata : public RefCountedThreadSafe<TabletMetadata> {
   // metadata is persisted.
   bool needs_flush_;
 
+  // Rowset removals, orphaned blocks, and last-durable-MRS-id changes
+  // accumulated since the last flush, in incremental metadata log record
+  // form. Protected by 'data_lock_'.
+  TabletMetadataDeltaPB pending_delta_;
+
+  // IDs of rowsets which have been added or mutated in place since the last
+  // flush and must therefore be written (as upserts) by the next
+  // incremental flush. Protected by 'data_lock_'.
+  std::unordered_set<int64_t> dirty_rowsets_;
+
+  // True if state has changed which cannot be expressed in a delta record
+  // (e.g. a schema or data-state change), forcing the next Flush() to
+  // rewrite the full superblock. Protected by 'data_lock_'.
+  bool needs_full_flush_;
+
+  // Epoch of the superblock currently on disk. Incremented each time the
+  // full superblock is rewritten. Protected by 'flush_lock_'.
+  int64_t metadata_log_epoch_;
+
+  // Number of records appended to the metadata log since the superblock was
+  // last rewritten. Protected by 'flush_lock_'.
+  int64_t metadata_log_entries_;
+
+  // Writer for the incremental metadata log, or NULL if the log is not open
+  // (e.g. before the first full superblock write, or if incremental
+  // flushing is disabled). Protected by 'flush_lock_'.
+  std::unique_ptr<pb_util::WritablePBContainerFile> metadata_log_;
+
   // A callback that, if set, is called before this metadata is flushed
   // to disk. Protected by the 'flush_lock_'.
   StatusClosure pre_flush_callback_;
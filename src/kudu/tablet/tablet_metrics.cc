@@ -255,6 +255,17 @@ METRIC_DEFINE_counter(tablet, leader_memory_pressure_rejections,
   kudu::MetricUnit::kRequests,
   "Number of RPC requests rejected due to memory pressure while LEADER.");
 
+METRIC_DEFINE_counter(tablet, throttler_rejections,
+  "Throttler Rejections",
+  kudu::MetricUnit::kRequests,
+  "Number of write RPC requests rejected by the per-tablet write throttler.");
+
+METRIC_DEFINE_counter(tablet, throttler_rejections_server_wide,
+  "Server-wide Throttler Rejections",
+  kudu::MetricUnit::kRequests,
+  "Number of write RPC requests to this tablet rejected by the server-wide "
+  "write throttler.");
+
 using strings::Substitute;
 using std::unordered_map;
 
@@ -307,7 +318,9 @@ TabletMetrics::TabletMetrics(const scoped_refptr<MetricEntity>& entity)
     MINIT(undo_delta_block_gc_init_duration),
     MINIT(undo_delta_block_gc_delete_duration),
     MINIT(undo_delta_block_gc_perform_duration),
-    MINIT(leader_memory_pressure_rejections) {
+    MINIT(leader_memory_pressure_rejections),
+    MINIT(throttler_rejections),
+    MINIT(throttler_rejections_server_wide) {
 }
 #undef MINIT
 #undef GINIT
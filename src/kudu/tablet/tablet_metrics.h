@@ -98,6 +98,8 @@ struct TabletMetrics {
   scoped_refptr<Histogram> undo_delta_block_gc_perform_duration;
 
   scoped_refptr<Counter> leader_memory_pressure_rejections;
+  scoped_refptr<Counter> throttler_rejections;
+  scoped_refptr<Counter> throttler_rejections_server_wide;
 };
 
 } // namespace tablet
@@ -23,6 +23,7 @@
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
+#include "kudu/fs/block_manager.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/tablet/rowset.h"
 #include "kudu/tablet/tablet.h"
@@ -47,8 +48,9 @@ using strings::Substitute;
 namespace kudu {
 namespace tablet {
 
-TabletOpBase::TabletOpBase(string name, IOUsage io_usage, Tablet* tablet)
-    : MaintenanceOp(std::move(name), io_usage),
+TabletOpBase::TabletOpBase(string name, IOUsage io_usage, Tablet* tablet,
+                           Lane lane)
+    : MaintenanceOp(std::move(name), io_usage, lane),
       tablet_(tablet) {
 }
 
@@ -62,7 +64,8 @@ string TabletOpBase::LogPrefix() const {
 
 CompactRowSetsOp::CompactRowSetsOp(Tablet* tablet)
   : TabletOpBase(Substitute("CompactRowSetsOp($0)", tablet->tablet_id()),
-                 MaintenanceOp::HIGH_IO_USAGE, tablet),
+                 MaintenanceOp::HIGH_IO_USAGE, tablet,
+                 MaintenanceOp::LANE_ROWSET_COMPACTION),
     last_num_mrs_flushed_(0),
     last_num_rs_compacted_(0) {
 }
@@ -105,6 +108,9 @@ bool CompactRowSetsOp::Prepare() {
 }
 
 void CompactRowSetsOp::Perform() {
+  // Compaction output is large, latency-insensitive background I/O; mark it
+  // so the block managers can throttle it behind WAL and flush writes.
+  fs::ScopedBackgroundBlockWrites bg;
   WARN_NOT_OK(tablet_->Compact(Tablet::COMPACT_NO_FLAGS),
               Substitute("$0Compaction failed on $1",
                          LogPrefix(), tablet_->tablet_id()));
@@ -124,7 +130,8 @@ scoped_refptr<AtomicGauge<uint32_t> > CompactRowSetsOp::RunningGauge() const {
 
 MinorDeltaCompactionOp::MinorDeltaCompactionOp(Tablet* tablet)
   : TabletOpBase(Substitute("MinorDeltaCompactionOp($0)", tablet->tablet_id()),
-                 MaintenanceOp::HIGH_IO_USAGE, tablet),
+                 MaintenanceOp::HIGH_IO_USAGE, tablet,
+                 MaintenanceOp::LANE_DELTA_COMPACTION),
     last_num_mrs_flushed_(0),
     last_num_dms_flushed_(0),
     last_num_rs_compacted_(0),
@@ -176,6 +183,7 @@ bool MinorDeltaCompactionOp::Prepare() {
 }
 
 void MinorDeltaCompactionOp::Perform() {
+  fs::ScopedBackgroundBlockWrites bg;
   WARN_NOT_OK(tablet_->CompactWorstDeltas(RowSet::MINOR_DELTA_COMPACTION),
               Substitute("$0Minor delta compaction failed on $1",
                          LogPrefix(), tablet_->tablet_id()));
@@ -195,7 +203,8 @@ scoped_refptr<AtomicGauge<uint32_t> > MinorDeltaCompactionOp::RunningGauge() con
 
 MajorDeltaCompactionOp::MajorDeltaCompactionOp(Tablet* tablet)
   : TabletOpBase(Substitute("MajorDeltaCompactionOp($0)", tablet->tablet_id()),
-                 MaintenanceOp::HIGH_IO_USAGE, tablet),
+                 MaintenanceOp::HIGH_IO_USAGE, tablet,
+                 MaintenanceOp::LANE_DELTA_COMPACTION),
     last_num_mrs_flushed_(0),
     last_num_dms_flushed_(0),
     last_num_rs_compacted_(0),
@@ -252,6 +261,7 @@ bool MajorDeltaCompactionOp::Prepare() {
 }
 
 void MajorDeltaCompactionOp::Perform() {
+  fs::ScopedBackgroundBlockWrites bg;
   WARN_NOT_OK(tablet_->CompactWorstDeltas(RowSet::MAJOR_DELTA_COMPACTION),
               Substitute("$0Major delta compaction failed on $1",
                          LogPrefix(), tablet_->tablet_id()));
@@ -39,7 +39,8 @@ class Tablet;
 
 class TabletOpBase : public MaintenanceOp {
  public:
-  TabletOpBase(std::string name, IOUsage io_usage, Tablet* tablet);
+  TabletOpBase(std::string name, IOUsage io_usage, Tablet* tablet,
+               Lane lane = LANE_DEFAULT);
   std::string LogPrefix() const;
 
  protected:
@@ -76,6 +76,8 @@
 
 METRIC_DECLARE_entity(tablet);
 
+DECLARE_int32(flush_log_retention_threshold_mb);
+DECLARE_int32(flush_target_output_size_mb);
 DECLARE_int32(flush_threshold_mb);
 
 namespace kudu {
@@ -598,6 +600,25 @@ TEST_F(TabletReplicaTest, TestFlushOpsPerfImprovements) {
   ASSERT_LT(0.7, stats.perf_improvement());
   ASSERT_GT(1.0, stats.perf_improvement());
   stats.Clear();
+
+  // A small memstore anchoring a lot of WAL scores like an over-threshold
+  // flush: one point per MB of WAL retained beyond the retention threshold.
+  FLAGS_flush_log_retention_threshold_mb = 128;
+  stats.set_ram_anchored(1 * 1024 * 1024);
+  stats.set_logs_retained_bytes(192 * 1024 * 1024);
+  FlushOpPerfImprovementPolicy::SetPerfImprovementForFlush(&stats, 1);
+  ASSERT_NEAR(stats.perf_improvement(), 64, 0.01);
+  stats.Clear();
+
+  // A tiny, old memstore with little WAL anchored gets its time-based score
+  // scaled down by its size relative to the target output size, so that it
+  // coalesces with later writes rather than flushing as a tiny rowset.
+  FLAGS_flush_target_output_size_mb = 32;
+  stats.set_ram_anchored(1 * 1024 * 1024);
+  FlushOpPerfImprovementPolicy::SetPerfImprovementForFlush(&stats, 60 * 50 * 1000);
+  ASSERT_GT(stats.perf_improvement(), 0.0);
+  ASSERT_LT(stats.perf_improvement(), 0.1);
+  stats.Clear();
 }
 
 } // namespace tablet
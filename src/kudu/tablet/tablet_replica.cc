@@ -628,10 +628,26 @@ Status TabletReplica::StartReplicaTransaction(const scoped_refptr<ConsensusRound
                 driver.get(),
                 std::placeholders::_1));
 
-  RETURN_NOT_OK(driver->ExecuteAsync());
+  // Rather than submitting the prepare phase right away, buffer the driver
+  // so that all of the transactions started on behalf of a single consensus
+  // request are submitted to the prepare pool as one task in
+  // FinishReplicaTransactionBatch().
+  {
+    std::lock_guard<simple_spinlock> lock(lock_);
+    replica_prepare_batch_.emplace_back(std::move(driver));
+  }
   return Status::OK();
 }
 
+void TabletReplica::FinishReplicaTransactionBatch() {
+  vector<scoped_refptr<TransactionDriver>> batch;
+  {
+    std::lock_guard<simple_spinlock> lock(lock_);
+    batch.swap(replica_prepare_batch_);
+  }
+  TransactionDriver::ExecuteAsyncBatch(std::move(batch));
+}
+
 Status TabletReplica::NewLeaderTransactionDriver(gscoped_ptr<Transaction> transaction,
                                                  scoped_refptr<TransactionDriver>* driver) {
   scoped_refptr<TransactionDriver> tx_driver = new TransactionDriver(
@@ -153,9 +153,16 @@ class TabletReplica : public RefCountedThreadSafe<TabletReplica>,
   void GetTabletStatusPB(TabletStatusPB* status_pb_out) const;
 
   // Used by consensus to create and start a new ReplicaTransaction.
+  // The transaction's prepare phase is not kicked off until the next call
+  // to FinishReplicaTransactionBatch().
   virtual Status StartReplicaTransaction(
       const scoped_refptr<consensus::ConsensusRound>& round) OVERRIDE;
 
+  // Submits the prepare phase of all transactions buffered by
+  // StartReplicaTransaction() since the last call, as a single prepare
+  // pool task.
+  virtual void FinishReplicaTransactionBatch() OVERRIDE;
+
   consensus::RaftConsensus* consensus() {
     std::lock_guard<simple_spinlock> lock(lock_);
     return consensus_.get();
@@ -358,6 +365,10 @@ class TabletReplica : public RefCountedThreadSafe<TabletReplica>,
   // Token for serial task submission to the server-wide transaction prepare pool.
   std::unique_ptr<ThreadPoolToken> prepare_pool_token_;
 
+  // Replica transaction drivers started since the last call to
+  // FinishReplicaTransactionBatch(). Protected by lock_.
+  std::vector<scoped_refptr<TransactionDriver>> replica_prepare_batch_;
+
   scoped_refptr<clock::Clock> clock_;
 
   // List of maintenance operations for the tablet that need information that only the peer
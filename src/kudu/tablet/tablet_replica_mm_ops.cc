@@ -45,6 +45,22 @@ DEFINE_int32(flush_threshold_secs, 2 * 60,
              "even if it is not large.");
 TAG_FLAG(flush_threshold_secs, experimental);
 
+DEFINE_int32(flush_log_retention_threshold_mb, 128,
+             "Size of WAL segments anchored by a memstore at which a flush is triggered "
+             "even if the memstore itself is small. This bounds the WAL disk usage and "
+             "restart replay time caused by a trickle of writes to an otherwise cold "
+             "tablet. 0 disables WAL-retention-based flushing.");
+TAG_FLAG(flush_log_retention_threshold_mb, experimental);
+
+DEFINE_int32(flush_target_output_size_mb, 32,
+             "Desired minimum size of a flushed memstore. The priority of time-based "
+             "flushes of memstores smaller than this is scaled down proportionally, so "
+             "that small batches of writes coalesce in memory into fewer, larger "
+             "on-disk rowsets instead of many tiny ones which must later be compacted. "
+             "Flushes triggered by memory or WAL retention pressure are not affected. "
+             "0 disables coalescing.");
+TAG_FLAG(flush_target_output_size_mb, experimental);
+
 
 METRIC_DEFINE_gauge_uint32(tablet, log_gc_running,
                            "Log GCs Running",
@@ -71,6 +87,7 @@ const double kFlushUpperBoundMs = 60 * 60 * 1000;
 void FlushOpPerfImprovementPolicy::SetPerfImprovementForFlush(MaintenanceOpStats* stats,
                                                               double elapsed_ms) {
   double anchored_mb = static_cast<double>(stats->ram_anchored()) / (1024 * 1024);
+  double logs_retained_mb = static_cast<double>(stats->logs_retained_bytes()) / (1024 * 1024);
   if (anchored_mb > FLAGS_flush_threshold_mb) {
     // If we're over the user-specified flush threshold, then consider the perf
     // improvement to be 1 for every extra MB.  This produces perf_improvement results
@@ -81,6 +98,17 @@ void FlushOpPerfImprovementPolicy::SetPerfImprovementForFlush(MaintenanceOpStats
     double extra_mb = anchored_mb - static_cast<double>(FLAGS_flush_threshold_mb);
     DCHECK_GE(extra_mb, 0);
     stats->set_perf_improvement(extra_mb);
+  } else if (FLAGS_flush_log_retention_threshold_mb > 0 &&
+             logs_retained_mb > FLAGS_flush_log_retention_threshold_mb) {
+    // A memstore may be small and yet anchor a large amount of WAL: a trickle
+    // of writes to an otherwise cold tablet keeps the log segments containing
+    // them from being GCed. Score such flushes the same way as over-threshold
+    // ones -- one point per MB of WAL retained beyond the threshold -- so the
+    // WAL disk usage and restart replay time stay bounded.
+    double extra_mb =
+        logs_retained_mb - static_cast<double>(FLAGS_flush_log_retention_threshold_mb);
+    DCHECK_GE(extra_mb, 0);
+    stats->set_perf_improvement(extra_mb);
   } else if (elapsed_ms > FLAGS_flush_threshold_secs * 1000) {
     // Even if we aren't over the threshold, consider flushing if we haven't flushed
     // in a long time. But, don't give it a large perf_improvement score. We should
@@ -91,6 +119,16 @@ void FlushOpPerfImprovementPolicy::SetPerfImprovementForFlush(MaintenanceOpStats
     if (perf > 1.0) {
       perf = 1.0;
     }
+    // Scale the score down further for memstores which would flush to an
+    // output much smaller than the target size, since every tiny rowset we
+    // write now must be rewritten by a compaction later. This lets small
+    // batches of writes coalesce in memory until the output would be
+    // reasonably sized, or until memory or WAL retention pressure (handled
+    // above) forces the issue.
+    if (FLAGS_flush_target_output_size_mb > 0 &&
+        anchored_mb < FLAGS_flush_target_output_size_mb) {
+      perf *= anchored_mb / FLAGS_flush_target_output_size_mb;
+    }
     stats->set_perf_improvement(perf);
   }
 }
@@ -52,7 +52,8 @@ class FlushMRSOp : public MaintenanceOp {
  public:
   explicit FlushMRSOp(TabletReplica* tablet_replica)
     : MaintenanceOp(StringPrintf("FlushMRSOp(%s)", tablet_replica->tablet()->tablet_id().c_str()),
-                    MaintenanceOp::HIGH_IO_USAGE),
+                    MaintenanceOp::HIGH_IO_USAGE,
+                    MaintenanceOp::LANE_FLUSH),
       tablet_replica_(tablet_replica) {
     time_since_flush_.start();
   }
@@ -82,7 +83,8 @@ class FlushDeltaMemStoresOp : public MaintenanceOp {
   explicit FlushDeltaMemStoresOp(TabletReplica* tablet_replica)
     : MaintenanceOp(StringPrintf("FlushDeltaMemStoresOp(%s)",
                                  tablet_replica->tablet()->tablet_id().c_str()),
-                    MaintenanceOp::HIGH_IO_USAGE),
+                    MaintenanceOp::HIGH_IO_USAGE,
+                    MaintenanceOp::LANE_FLUSH),
       tablet_replica_(tablet_replica) {
     time_since_flush_.start();
   }
@@ -24,6 +24,7 @@
 #include <type_traits>
 #include <utility>
 
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 #include <google/protobuf/descriptor.h>
 #include <google/protobuf/message.h>
@@ -48,12 +49,22 @@
 #include "kudu/tablet/transaction_order_verifier.h"
 #include "kudu/tablet/transactions/transaction_tracker.h"
 #include "kudu/util/debug/trace_event.h"
+#include "kudu/util/flag_tags.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/pb_util.h"
 #include "kudu/util/status_callback.h"
 #include "kudu/util/threadpool.h"
 #include "kudu/util/trace.h"
 
+DEFINE_bool(tablet_inline_apply_when_idle, true,
+            "Whether to run a transaction's apply phase inline on the "
+            "prepare pool thread when replication finished before prepare "
+            "and the apply thread pool has no queued work. This saves a "
+            "scheduler round trip per such write; when the pool is busy, "
+            "applies are queued as usual.");
+TAG_FLAG(tablet_inline_apply_when_idle, advanced);
+TAG_FLAG(tablet_inline_apply_when_idle, experimental);
+
 namespace kudu {
 namespace tablet {
 
@@ -66,6 +77,7 @@ using pb_util::SecureShortDebugString;
 using rpc::RequestIdPB;
 using rpc::ResultTracker;
 using std::string;
+using std::vector;
 using strings::Substitute;
 
 static const char* kTimestampFieldName = "timestamp";
@@ -239,6 +251,30 @@ Status TransactionDriver::ExecuteAsync() {
   return Status::OK();
 }
 
+void TransactionDriver::ExecuteAsyncBatch(vector<scoped_refptr<TransactionDriver>> drivers) {
+  if (drivers.empty()) {
+    return;
+  }
+  if (drivers.size() == 1) {
+    // Not worth the batching machinery for a single transaction.
+    CHECK_OK(drivers[0]->ExecuteAsync());
+    return;
+  }
+  ThreadPoolToken* token = drivers[0]->prepare_pool_token_;
+  for (const scoped_refptr<TransactionDriver>& driver : drivers) {
+    DCHECK_EQ(token, driver->prepare_pool_token_);
+    TRACE_EVENT_FLOW_BEGIN0("txn", "ExecuteAsync", driver.get());
+  }
+  Status s = token->SubmitClosure(
+      Bind(&TransactionDriver::PrepareBatchTask, drivers));
+  if (PREDICT_FALSE(!s.ok())) {
+    for (const scoped_refptr<TransactionDriver>& driver : drivers) {
+      ADOPT_TRACE(driver->trace());
+      driver->HandleFailure(s);
+    }
+  }
+}
+
 void TransactionDriver::PrepareTask() {
   TRACE_EVENT_FLOW_END0("txn", "PrepareTask", this);
   Status prepare_status = Prepare();
@@ -247,6 +283,15 @@ void TransactionDriver::PrepareTask() {
   }
 }
 
+void TransactionDriver::PrepareBatchTask(const vector<scoped_refptr<TransactionDriver>>& drivers) {
+  // Adopt each transaction's trace so that its prepare phase is attributed
+  // the same way it would be had it been submitted as its own task.
+  for (const scoped_refptr<TransactionDriver>& driver : drivers) {
+    ADOPT_TRACE(driver->trace());
+    driver->PrepareTask();
+  }
+}
+
 void TransactionDriver::RegisterFollowerTransactionOnResultTracker() {
   // If this is a transaction being executed by a follower and its result is being
   // tracked, make sure that we're the driver of the transaction.
@@ -352,8 +397,9 @@ Status TransactionDriver::Prepare() {
     {
       // We can move on to apply.
       // Note that ApplyAsync() will handle the error status in the
-      // REPLICATION_FAILED case.
-      return ApplyAsync();
+      // REPLICATION_FAILED case. We're on a prepare pool thread here, so
+      // the apply may run inline.
+      return ApplyAsync(/*may_inline=*/true);
     }
   }
 
@@ -444,8 +490,11 @@ void TransactionDriver::ReplicationFinished(const Status& status) {
   // be applied to the tablet.
   if (prepare_state_copy == PREPARED) {
     // We likely need to do cleanup if this fails so for now just
-    // CHECK_OK
-    CHECK_OK(ApplyAsync());
+    // CHECK_OK.
+    //
+    // Consensus invokes this callback with RaftConsensus::lock_ held, so
+    // the apply must not run inline here.
+    CHECK_OK(ApplyAsync(/*may_inline=*/false));
   }
 }
 
@@ -469,7 +518,7 @@ void TransactionDriver::Abort(const Status& status) {
   }
 }
 
-Status TransactionDriver::ApplyAsync() {
+Status TransactionDriver::ApplyAsync(bool may_inline) {
   {
     std::unique_lock<simple_spinlock> lock(lock_);
     DCHECK_EQ(prepare_state_, PREPARED);
@@ -491,6 +540,25 @@ Status TransactionDriver::ApplyAsync() {
   }
 
   TRACE_EVENT_FLOW_BEGIN0("txn", "ApplyTask", this);
+
+  // If the apply pool has no queued work, run the apply inline rather than
+  // paying a scheduler round trip through the pool. Ordering is unaffected:
+  // CheckApply() above has already established this transaction's place in
+  // the apply order, and applies may run concurrently anyway. COMMIT_WAIT
+  // transactions are excluded because their apply phase sleeps, which would
+  // stall the calling thread. Inlining is restricted to the
+  // prepare-completion path ('may_inline' is false when called from
+  // ReplicationFinished()): the consensus callback invokes
+  // ReplicationFinished() while holding RaftConsensus::lock_, so applying
+  // there would stall elections and heartbeats and could deadlock when the
+  // apply phase calls back into consensus.
+  if (PREDICT_TRUE(FLAGS_tablet_inline_apply_when_idle) &&
+      may_inline &&
+      transaction_->state()->external_consistency_mode() != COMMIT_WAIT &&
+      apply_pool_->num_queued_tasks() == 0) {
+    ApplyTask();
+    return Status::OK();
+  }
   return apply_pool_->SubmitClosure(Bind(&TransactionDriver::ApplyTask, Unretained(this)));
 }
 
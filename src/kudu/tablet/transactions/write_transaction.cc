@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <ctime>
+#include <memory>
 #include <new>
 #include <ostream>
 #include <type_traits>
@@ -99,21 +100,32 @@ void WriteTransaction::NewReplicateMsg(gscoped_ptr<ReplicateMsg>* replicate_msg)
 Status WriteTransaction::Prepare() {
   TRACE_EVENT0("txn", "WriteTransaction::Prepare");
   TRACE("PREPARE: Starting");
-  // Decode everything first so that we give up if something major is wrong.
-  Schema client_schema;
-  RETURN_NOT_OK_PREPEND(SchemaFromPB(state_->request()->schema(), &client_schema),
-                        "Cannot decode client schema");
-  if (client_schema.has_column_ids()) {
-    // TODO: we have this kind of code a lot - add a new SchemaFromPB variant which
-    // does this check inline.
-    Status s = Status::InvalidArgument("User requests should not have Column IDs");
-    state_->completion_callback()->set_error(s, TabletServerErrorPB::INVALID_SCHEMA);
-    return s;
-  }
 
   Tablet* tablet = state()->tablet_replica()->tablet();
 
-  Status s = tablet->DecodeWriteOperations(&client_schema, state());
+  // In steady state the client sends the same schema on every request, so
+  // first check whether the tablet has already validated it. On a cache hit
+  // we can skip decoding and re-validating the schema entirely.
+  Status s;
+  std::shared_ptr<const Tablet::WriteSchemaState> ws =
+      tablet->LookupWriteSchemaState(state_->request()->schema());
+  if (PREDICT_TRUE(ws != nullptr)) {
+    s = tablet->DecodeWriteOperations(ws, state());
+  } else {
+    // Decode everything first so that we give up if something major is wrong.
+    Schema client_schema;
+    RETURN_NOT_OK_PREPEND(SchemaFromPB(state_->request()->schema(), &client_schema),
+                          "Cannot decode client schema");
+    if (client_schema.has_column_ids()) {
+      // TODO: we have this kind of code a lot - add a new SchemaFromPB variant which
+      // does this check inline.
+      Status s = Status::InvalidArgument("User requests should not have Column IDs");
+      state_->completion_callback()->set_error(s, TabletServerErrorPB::INVALID_SCHEMA);
+      return s;
+    }
+
+    s = tablet->DecodeWriteOperations(&client_schema, state());
+  }
   if (!s.ok()) {
     // TODO: is MISMATCHED_SCHEMA always right here? probably not.
     state()->completion_callback()->set_error(s, TabletServerErrorPB::MISMATCHED_SCHEMA);
@@ -427,6 +427,7 @@ TEST_F(ToolTest, TestModeHelp) {
         "cmeta.*Operate on a local tablet replica's consensus",
         "data_size.*Summarize the data size",
         "dump.*Dump a Kudu filesystem",
+        "backup_from_remote.*Back up a tablet replica",
         "copy_from_remote.*Copy a tablet replica",
         "delete.*Delete a tablet replica from the local filesystem",
         "list.*Show list of tablet replicas"
@@ -462,6 +463,13 @@ TEST_F(ToolTest, TestModeHelp) {
     NO_FATALS(RunTestHelp("local-replica copy-from-remote --help",
                           kLocalReplicaCopyFromRemoteRegexes));
   }
+  {
+    const vector<string> kLocalReplicaBackupFromRemoteRegexes = {
+        "Back up a tablet replica from a remote server"
+    };
+    NO_FATALS(RunTestHelp("local_replica backup_from_remote --help",
+                          kLocalReplicaBackupFromRemoteRegexes));
+  }
   {
     const vector<string> kClusterModeRegexes = {
         "ksck.*Check the health of a Kudu cluster",
@@ -1462,6 +1470,46 @@ TEST_F(ToolTest, TestRemoteReplicaCopy) {
                                    tablet::RUNNING, kTimeout));
 }
 
+// Test 'kudu local_replica backup_from_remote': the destination filesystem
+// layout is created on the fly and ends up holding a physical copy of the
+// replica.
+TEST_F(ToolTest, TestLocalReplicaBackupFromRemote) {
+  MonoDelta kTimeout = MonoDelta::FromSeconds(30);
+  ExternalMiniClusterOptions opts;
+  opts.num_tablet_servers = 1;
+  NO_FATALS(StartExternalMiniCluster(std::move(opts)));
+
+  // TestWorkLoad.Setup() internally generates a table.
+  TestWorkload workload(cluster_.get());
+  workload.set_num_replicas(1);
+  workload.Setup();
+  workload.Start();
+  while (workload.rows_inserted() < 100) {
+    SleepFor(MonoDelta::FromMilliseconds(10));
+  }
+  workload.StopAndJoin();
+
+  TServerDetails* ts = ts_map_[cluster_->tablet_server(0)->uuid()];
+  vector<ListTabletsResponsePB::StatusAndSchemaPB> tablets;
+  ASSERT_OK(WaitForNumTabletsOnTS(ts, 1, kTimeout, &tablets));
+  const string& tablet_id = tablets[0].tablet_status().tablet_id();
+  const string& ts_addr = cluster_->tablet_server(0)->bound_rpc_addr().ToString();
+
+  // The backup directory does not exist yet: the tool should create the
+  // filesystem layout before copying into it.
+  const string backup_dir = GetTestPath("backup");
+  NO_FATALS(RunActionStdoutNone(Substitute(
+      "local_replica backup_from_remote $0 $1 --fs_wal_dir=$2 --fs_data_dirs=$2",
+      tablet_id, ts_addr, backup_dir)));
+
+  // The backed-up replica should show up in the backup layout.
+  string stdout;
+  NO_FATALS(RunActionStdoutString(Substitute(
+      "local_replica list --fs_wal_dir=$0 --fs_data_dirs=$0",
+      backup_dir), &stdout));
+  ASSERT_STR_CONTAINS(stdout, tablet_id);
+}
+
 // Test 'kudu local_replica delete' tool with --clean_unsafe flag for
 // deleting the tablet from the tablet server.
 TEST_F(ToolTest, TestLocalReplicaDelete) {
@@ -350,6 +350,22 @@ Status SetRaftTerm(const RunnerContext& context) {
   return cmeta->Flush();
 }
 
+// Stream the tablet's superblock, data blocks, and WAL segments from the
+// given remote server into 'fs_manager' over the tablet copy protocol.
+Status DoCopyFromRemote(FsManager* fs_manager,
+                        const string& tablet_id,
+                        const HostPort& source) {
+  scoped_refptr<ConsensusMetadataManager> cmeta_manager(new ConsensusMetadataManager(fs_manager));
+  MessengerBuilder builder("tablet_copy_client");
+  shared_ptr<Messenger> messenger;
+  builder.Build(&messenger);
+  TabletCopyClient client(tablet_id, fs_manager, cmeta_manager,
+                          messenger, nullptr /* no metrics */);
+  RETURN_NOT_OK(client.Start(source, nullptr));
+  RETURN_NOT_OK(client.FetchAll(nullptr));
+  return client.Finish();
+}
+
 Status CopyFromRemote(const RunnerContext& context) {
   // Parse the tablet ID and source arguments.
   const string& tablet_id = FindOrDie(context.required_args, kTabletIdArg);
@@ -361,15 +377,29 @@ Status CopyFromRemote(const RunnerContext& context) {
   // Copy the tablet over.
   FsManager fs_manager(Env::Default(), FsManagerOpts());
   RETURN_NOT_OK(fs_manager.Open());
-  scoped_refptr<ConsensusMetadataManager> cmeta_manager(new ConsensusMetadataManager(&fs_manager));
-  MessengerBuilder builder("tablet_copy_client");
-  shared_ptr<Messenger> messenger;
-  builder.Build(&messenger);
-  TabletCopyClient client(tablet_id, &fs_manager, cmeta_manager,
-                          messenger, nullptr /* no metrics */);
-  RETURN_NOT_OK(client.Start(hp, nullptr));
-  RETURN_NOT_OK(client.FetchAll(nullptr));
-  return client.Finish();
+  return DoCopyFromRemote(&fs_manager, tablet_id, hp);
+}
+
+Status BackupFromRemote(const RunnerContext& context) {
+  // Parse the tablet ID and source arguments.
+  const string& tablet_id = FindOrDie(context.required_args, kTabletIdArg);
+  const string& rpc_address = FindOrDie(context.required_args, "source");
+
+  HostPort hp;
+  RETURN_NOT_OK(ParseHostPortString(rpc_address, &hp));
+
+  // Open the backup destination, creating the filesystem layout if this is
+  // the first backup into it.
+  FsManager fs_manager(Env::Default(), FsManagerOpts());
+  Status s = fs_manager.Open();
+  if (s.IsNotFound()) {
+    RETURN_NOT_OK_PREPEND(fs_manager.CreateInitialFileSystemLayout(),
+                          "unable to create the backup filesystem layout");
+    RETURN_NOT_OK(fs_manager.Open());
+  } else {
+    RETURN_NOT_OK(s);
+  }
+  return DoCopyFromRemote(&fs_manager, tablet_id, hp);
 }
 
 Status DeleteLocalReplica(const RunnerContext& context) {
@@ -970,6 +1000,28 @@ unique_ptr<Mode> BuildLocalReplicaMode() {
       .AddAction(std::move(set_term))
       .Build();
 
+  unique_ptr<Action> backup_from_remote =
+      ActionBuilder("backup_from_remote", &BackupFromRemote)
+      .Description("Back up a tablet replica from a remote server into a "
+        "local filesystem layout")
+      .ExtraDescription("Streams the replica's raw data blocks (already "
+        "compressed and encoded), metadata, and WAL segments over the tablet "
+        "copy protocol into the filesystem layout given by --fs_wal_dir and "
+        "--fs_data_dirs, creating the layout if it does not exist yet. This "
+        "is much cheaper than a row-level backup through the client, since "
+        "no rows are materialized on either side. The copy is physically "
+        "consistent: the source pins the set of blocks and log segments "
+        "referenced by the replica's superblock for the duration of the "
+        "session. The destination is itself a valid Kudu filesystem root, "
+        "so a backed-up replica can be restored with 'copy_from_remote' "
+        "pointed at a tablet server started on the backup layout.")
+      .AddRequiredParameter({ kTabletIdArg, kTabletIdArgDesc })
+      .AddRequiredParameter({ "source", "Source RPC address of "
+        "form hostname:port" })
+      .AddOptionalParameter("fs_wal_dir")
+      .AddOptionalParameter("fs_data_dirs")
+      .Build();
+
   unique_ptr<Action> copy_from_remote =
       ActionBuilder("copy_from_remote", &CopyFromRemote)
       .Description("Copy a tablet replica from a remote server")
@@ -1010,6 +1062,7 @@ unique_ptr<Mode> BuildLocalReplicaMode() {
   return ModeBuilder("local_replica")
       .Description("Operate on local tablet replicas via the local filesystem")
       .AddMode(std::move(cmeta))
+      .AddAction(std::move(backup_from_remote))
       .AddAction(std::move(copy_from_remote))
       .AddAction(std::move(data_size))
       .AddAction(std::move(delete_local_replica))
@@ -40,6 +40,7 @@
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/master/master.pb.h"
 #include "kudu/master/master.proxy.h"
+#include "kudu/rpc/messenger.h"
 #include "kudu/rpc/rpc_controller.h"
 #include "kudu/security/cert.h"
 #include "kudu/security/openssl_util.h"
@@ -84,6 +85,15 @@ DEFINE_int32(heartbeat_inject_latency_before_heartbeat_ms, 0,
 TAG_FLAG(heartbeat_inject_latency_before_heartbeat_ms, runtime);
 TAG_FLAG(heartbeat_inject_latency_before_heartbeat_ms, unsafe);
 
+DEFINE_int32(heartbeat_authn_token_refresh_secs, 60 * 60 * 24,
+             "Interval at which the tablet server asks the master for a fresh "
+             "authentication token via heartbeat. The token is used to "
+             "authenticate the tablet server's own intra-cluster RPC "
+             "connections without SASL negotiation round trips. Must be "
+             "shorter than the master's --authn_token_validity_seconds.");
+TAG_FLAG(heartbeat_authn_token_refresh_secs, advanced);
+TAG_FLAG(heartbeat_authn_token_refresh_secs, experimental);
+
 using kudu::master::MasterServiceProxy;
 using kudu::master::TabletReportPB;
 using kudu::pb_util::SecureDebugString;
@@ -169,6 +179,10 @@ class Heartbeater::Thread {
   // The most recent response from a heartbeat.
   master::TSHeartbeatResponsePB last_hb_response_;
 
+  // The last time the master issued us an authentication token, used to
+  // periodically ask for a fresh one before the current one expires.
+  MonoTime last_authn_token_refresh_;
+
   // The number of heartbeats which have failed in a row.
   // This is tracked so as to back-off heartbeating.
   int consecutive_failed_heartbeats_;
@@ -302,6 +316,7 @@ void Heartbeater::MarkTabletReportsAcknowledgedForTests(
 Heartbeater::Thread::Thread(HostPort master_address, TabletServer* server)
   : master_address_(std::move(master_address)),
     server_(server),
+    last_authn_token_refresh_(MonoTime::Min()),
     consecutive_failed_heartbeats_(0),
     next_report_seq_(0),
     cond_(&mutex_),
@@ -416,6 +431,16 @@ Status Heartbeater::Thread::DoHeartbeat() {
   // send us knew ones if they exist.
   req.set_latest_tsk_seq_num(server_->token_verifier().GetMaxKnownKeySequenceNumber());
 
+  // Ask the master for an authentication token if we don't have one yet, or
+  // if the one we have is due for a refresh. The token lets our outbound
+  // intra-cluster connections (e.g. consensus traffic) authenticate via a
+  // token exchange instead of SASL round trips.
+  if (!server_->messenger()->authn_token() ||
+      MonoTime::Now() - last_authn_token_refresh_ >
+          MonoDelta::FromSeconds(FLAGS_heartbeat_authn_token_refresh_secs)) {
+    req.set_needs_authn_token(true);
+  }
+
   if (send_full_tablet_report_) {
     LOG(INFO) << Substitute(
         "Master $0 was elected leader, sending a full tablet report...",
@@ -490,6 +515,13 @@ Status Heartbeater::Thread::DoHeartbeat() {
         "failed to import token signing public keys from master heartbeat");
   }
 
+  // Adopt a new authentication token, if we were issued one.
+  if (last_hb_response_.has_authn_token()) {
+    server_->messenger()->set_authn_token(last_hb_response_.authn_token());
+    last_authn_token_refresh_ = MonoTime::Now();
+    VLOG(1) << "Adopted new authentication token from the master";
+  }
+
   MarkTabletReportAcknowledged(req.tablet_report());
   return Status::OK();
 }
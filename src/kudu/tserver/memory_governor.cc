@@ -0,0 +1,181 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/tserver/memory_governor.h"
+
+#include <algorithm>
+#include <ostream>
+#include <utility>
+
+#include <gflags/gflags.h>
+#include <gflags/gflags_declare.h>
+#include <glog/logging.h>
+
+#include "kudu/cfile/block_cache.h"
+#include "kudu/util/flag_tags.h"
+#include "kudu/util/monotime.h"
+#include "kudu/util/process_memory.h"
+#include "kudu/util/thread.h"
+
+DEFINE_bool(memory_governor_enabled, false,
+            "Whether to dynamically rebalance memory between the block cache "
+            "and the memstores. When enabled, the block cache is shrunk while "
+            "the process is under memory pressure (handing memory to the "
+            "memstores and reducing flush pressure) and grown back toward "
+            "--block_cache_capacity_mb once pressure subsides and the cache "
+            "hit rate justifies it.");
+TAG_FLAG(memory_governor_enabled, advanced);
+TAG_FLAG(memory_governor_enabled, experimental);
+
+DEFINE_int32(memory_governor_interval_ms, 10000,
+             "Interval at which the memory governor re-evaluates the memory "
+             "split between the block cache and the memstores, in "
+             "milliseconds.");
+TAG_FLAG(memory_governor_interval_ms, advanced);
+TAG_FLAG(memory_governor_interval_ms, experimental);
+
+DEFINE_int64(memory_governor_min_block_cache_mb, 64,
+             "Lower bound on the block cache capacity maintained by the "
+             "memory governor, in MB. The governor never shrinks the cache "
+             "below this, no matter how much write pressure there is.");
+TAG_FLAG(memory_governor_min_block_cache_mb, advanced);
+TAG_FLAG(memory_governor_min_block_cache_mb, experimental);
+
+DEFINE_int64(memory_governor_step_mb, 64,
+             "Amount by which the memory governor adjusts the block cache "
+             "capacity in a single pass, in MB. Small steps avoid eviction "
+             "storms when pressure appears and give flushes time to catch "
+             "up between adjustments.");
+TAG_FLAG(memory_governor_step_mb, advanced);
+TAG_FLAG(memory_governor_step_mb, experimental);
+
+DEFINE_int32(memory_governor_calm_intervals_before_grow, 6,
+             "Number of consecutive pressure-free governor intervals "
+             "required before block cache capacity is grown back. This "
+             "hysteresis prevents the cache and the memstores from trading "
+             "the same memory back and forth on a workload that hovers "
+             "around the pressure threshold.");
+TAG_FLAG(memory_governor_calm_intervals_before_grow, advanced);
+TAG_FLAG(memory_governor_calm_intervals_before_grow, experimental);
+
+DEFINE_double(memory_governor_grow_hit_rate, 0.0,
+              "Minimum block cache hit rate over the most recent governor "
+              "interval required to grow the cache back after a shrink. "
+              "With the default of 0.0, growth is driven purely by the "
+              "absence of memory pressure.");
+TAG_FLAG(memory_governor_grow_hit_rate, advanced);
+TAG_FLAG(memory_governor_grow_hit_rate, experimental);
+
+DECLARE_int64(block_cache_capacity_mb);
+
+METRIC_DECLARE_counter(block_cache_hits_caching);
+METRIC_DECLARE_counter(block_cache_misses_caching);
+
+namespace kudu {
+namespace tserver {
+
+MemoryGovernor::MemoryGovernor(scoped_refptr<MetricEntity> metric_entity)
+  : metric_entity_(std::move(metric_entity)),
+    block_cache_target_bytes_(FLAGS_block_cache_capacity_mb * 1024 * 1024),
+    consecutive_calm_passes_(0),
+    last_hits_caching_(0),
+    last_misses_caching_(0),
+    shutdown_latch_(1) {
+}
+
+MemoryGovernor::~MemoryGovernor() {
+  Shutdown();
+}
+
+Status MemoryGovernor::Start() {
+  if (!FLAGS_memory_governor_enabled) {
+    return Status::OK();
+  }
+  // These instantiate as the same counters the block cache records into,
+  // since both use the server's metric entity.
+  hits_caching_ = METRIC_block_cache_hits_caching.Instantiate(metric_entity_);
+  misses_caching_ = METRIC_block_cache_misses_caching.Instantiate(metric_entity_);
+  return Thread::Create("tserver", "memory-governor",
+                        &MemoryGovernor::RunThread, this,
+                        &thread_);
+}
+
+void MemoryGovernor::Shutdown() {
+  if (thread_) {
+    shutdown_latch_.CountDown();
+    CHECK_OK(ThreadJoiner(thread_.get()).Join());
+    thread_ = nullptr;
+  }
+}
+
+void MemoryGovernor::RunThread() {
+  while (!shutdown_latch_.WaitFor(
+      MonoDelta::FromMilliseconds(FLAGS_memory_governor_interval_ms))) {
+    Rebalance();
+  }
+}
+
+void MemoryGovernor::Rebalance() {
+  const int64_t base_bytes = FLAGS_block_cache_capacity_mb * 1024 * 1024;
+  const int64_t min_bytes = std::min(
+      FLAGS_memory_governor_min_block_cache_mb * 1024 * 1024, base_bytes);
+  const int64_t step_bytes = FLAGS_memory_governor_step_mb * 1024 * 1024;
+
+  // Sample the hit rate of the interval which just ended.
+  double hit_rate = 0.0;
+  if (hits_caching_ && misses_caching_) {
+    int64_t hits = hits_caching_->value();
+    int64_t misses = misses_caching_->value();
+    int64_t interval_lookups = (hits - last_hits_caching_) +
+        (misses - last_misses_caching_);
+    if (interval_lookups > 0) {
+      hit_rate = static_cast<double>(hits - last_hits_caching_) / interval_lookups;
+    }
+    last_hits_caching_ = hits;
+    last_misses_caching_ = misses;
+  }
+
+  int64_t target = block_cache_target_bytes_;
+  // UnderMemoryPressure() only assigns this when it returns true, so
+  // compute it up front: it's also logged on the grow path below.
+  double capacity_pct = process_memory::HardLimit() > 0 ?
+      100.0 * process_memory::CurrentConsumption() / process_memory::HardLimit() :
+      0.0;
+  if (process_memory::UnderMemoryPressure(&capacity_pct)) {
+    // The memstores (and everything else) are crowding the process limit:
+    // hand them memory by shrinking the cache, a step at a time.
+    consecutive_calm_passes_ = 0;
+    target = std::max(block_cache_target_bytes_ - step_bytes, min_bytes);
+  } else if (++consecutive_calm_passes_ >=
+                 FLAGS_memory_governor_calm_intervals_before_grow &&
+             block_cache_target_bytes_ < base_bytes &&
+             hit_rate >= FLAGS_memory_governor_grow_hit_rate) {
+    target = std::min(block_cache_target_bytes_ + step_bytes, base_bytes);
+  }
+
+  if (target != block_cache_target_bytes_) {
+    LOG(INFO) << "Memory governor adjusting block cache capacity from "
+              << block_cache_target_bytes_ << " to " << target
+              << " bytes (memory used: " << capacity_pct << "%, block cache "
+              << "hit rate: " << hit_rate << ")";
+    block_cache_target_bytes_ = target;
+    cfile::BlockCache::GetSingleton()->UpdateCapacity(target);
+  }
+}
+
+} // namespace tserver
+} // namespace kudu
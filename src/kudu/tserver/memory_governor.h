@@ -0,0 +1,94 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#ifndef KUDU_TSERVER_MEMORY_GOVERNOR_H
+#define KUDU_TSERVER_MEMORY_GOVERNOR_H
+
+#include <cstdint>
+
+#include "kudu/gutil/macros.h"
+#include "kudu/gutil/ref_counted.h"
+#include "kudu/util/countdown_latch.h"
+#include "kudu/util/metrics.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+
+class Thread;
+
+namespace tserver {
+
+// Background task which rebalances process memory between the block cache
+// and the memstores based on the workload's current shape.
+//
+// Memstores have no capacity of their own: they grow until the process
+// approaches its memory limit, at which point the maintenance manager starts
+// prioritizing flushes. The block cache, on the other hand, holds on to its
+// configured capacity regardless of write pressure. On a mixed workload this
+// means an ingest-heavy phase is squeezed into whatever memory the cache
+// leaves over, while a scan-heavy phase can't use memory that idle memstores
+// would never claim.
+//
+// When enabled (--memory_governor_enabled), the governor periodically checks
+// the same memory-pressure signal the maintenance manager uses to prioritize
+// flushes. Under pressure it shrinks the block cache in steps, handing memory
+// to the memstores; once pressure has stayed away for a configurable number
+// of intervals (hysteresis) and the cache's recent hit rate shows it's
+// earning its memory, capacity is grown back in steps toward the configured
+// --block_cache_capacity_mb.
+class MemoryGovernor {
+ public:
+  explicit MemoryGovernor(scoped_refptr<MetricEntity> metric_entity);
+  ~MemoryGovernor();
+
+  // Start the governor thread. A no-op if --memory_governor_enabled is off.
+  Status Start();
+
+  // Stop the governor thread. Safe to call more than once.
+  void Shutdown();
+
+ private:
+  void RunThread();
+
+  // Run one rebalancing pass.
+  void Rebalance();
+
+  const scoped_refptr<MetricEntity> metric_entity_;
+
+  // The capacity the governor last applied to the block cache, in bytes.
+  int64_t block_cache_target_bytes_;
+
+  // Number of consecutive pressure-free Rebalance() passes; growth requires
+  // --memory_governor_calm_intervals_before_grow of them.
+  int consecutive_calm_passes_;
+
+  // Block cache counter values sampled at the previous Rebalance() pass,
+  // used to compute the hit rate of the most recent interval.
+  int64_t last_hits_caching_;
+  int64_t last_misses_caching_;
+
+  scoped_refptr<Counter> hits_caching_;
+  scoped_refptr<Counter> misses_caching_;
+
+  CountDownLatch shutdown_latch_;
+  scoped_refptr<Thread> thread_;
+
+  DISALLOW_COPY_AND_ASSIGN(MemoryGovernor);
+};
+
+} // namespace tserver
+} // namespace kudu
+#endif
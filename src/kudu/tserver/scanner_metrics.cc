@@ -24,6 +24,12 @@ METRIC_DEFINE_counter(server, scanners_expired,
                       kudu::MetricUnit::kScanners,
                       "Number of scanners that have expired due to inactivity since service start");
 
+METRIC_DEFINE_counter(server, scanners_evicted,
+                      "Scanners Evicted",
+                      kudu::MetricUnit::kScanners,
+                      "Number of scanners evicted because their user exceeded the "
+                      "per-user scanner quota (--scanner_quota_per_user)");
+
 METRIC_DEFINE_histogram(server, scanner_duration,
                         "Scanner Duration",
                         kudu::MetricUnit::kMicroseconds,
@@ -37,6 +43,8 @@ namespace tserver {
 ScannerMetrics::ScannerMetrics(const scoped_refptr<MetricEntity>& metric_entity)
     : scanners_expired(
           METRIC_scanners_expired.Instantiate(metric_entity)),
+      scanners_evicted(
+          METRIC_scanners_evicted.Instantiate(metric_entity)),
       scanner_duration(METRIC_scanner_duration.Instantiate(metric_entity)) {
 }
 
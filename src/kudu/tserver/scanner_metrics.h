@@ -39,6 +39,10 @@ struct ScannerMetrics {
   // expired since the start of service.
   scoped_refptr<Counter> scanners_expired;
 
+  // Keeps track of the total number of scanners that have been evicted
+  // because their user exceeded the per-user scanner quota.
+  scoped_refptr<Counter> scanners_evicted;
+
   // Keeps track of the duration of scanners.
   scoped_refptr<Histogram> scanner_duration;
 };
@@ -22,6 +22,8 @@
 #include <gflags/gflags_declare.h>
 #include <gtest/gtest.h>
 
+#include "kudu/common/rowblock.h"
+#include "kudu/common/schema.h"
 #include "kudu/gutil/gscoped_ptr.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/tablet/tablet_replica.h"
@@ -30,6 +32,7 @@
 #include "kudu/util/metrics.h"
 #include "kudu/util/monotime.h"
 
+DECLARE_int32(scanner_quota_per_user);
 DECLARE_int32(scanner_ttl_ms);
 
 namespace kudu {
@@ -69,6 +72,30 @@ TEST(ScannersTest, TestManager) {
   ASSERT_FALSE(mgr.UnregisterScanner("xxx"));
 }
 
+TEST(ScannersTest, TestRowBlockReuse) {
+  scoped_refptr<TabletReplica> null_replica(nullptr);
+  ScannerManager mgr(nullptr);
+  SharedScanner s;
+  mgr.NewScanner(null_replica, "", RowFormatFlags::NO_FLAGS, &s);
+
+  Schema schema({ ColumnSchema("key", INT32) }, 1);
+
+  // Repeated batches of the same capacity reuse the same block and arena.
+  RowBlock* b1 = s->PrepareRowBlockForBatch(schema, 128);
+  Arena* arena = b1->arena();
+  ASSERT_EQ(128, b1->row_capacity());
+  RowBlock* b2 = s->PrepareRowBlockForBatch(schema, 128);
+  ASSERT_EQ(b1, b2);
+  ASSERT_EQ(arena, b2->arena());
+
+  // A changed capacity reallocates the block but keeps the arena.
+  RowBlock* b3 = s->PrepareRowBlockForBatch(schema, 256);
+  ASSERT_EQ(256, b3->row_capacity());
+  ASSERT_EQ(arena, b3->arena());
+
+  ASSERT_TRUE(mgr.UnregisterScanner(s->id()));
+}
+
 TEST(ScannerTest, TestExpire) {
   scoped_refptr<TabletReplica> null_replica(nullptr);
   FLAGS_scanner_ttl_ms = 100;
@@ -87,5 +114,33 @@ TEST(ScannerTest, TestExpire) {
   ASSERT_EQ(s2->id(), active_scanners[0]->id());
 }
 
+TEST(ScannerTest, TestPerUserQuota) {
+  scoped_refptr<TabletReplica> null_replica(nullptr);
+  FLAGS_scanner_quota_per_user = 2;
+  MetricRegistry registry;
+  ScannerManager mgr(METRIC_ENTITY_server.Instantiate(&registry, "test"));
+
+  SharedScanner s1, s2, s3, other;
+  mgr.NewScanner(null_replica, "alice", RowFormatFlags::NO_FLAGS, &s1);
+  mgr.NewScanner(null_replica, "bob", RowFormatFlags::NO_FLAGS, &other);
+  mgr.NewScanner(null_replica, "alice", RowFormatFlags::NO_FLAGS, &s2);
+
+  // Let the first scanner go idle for a while, then touch the second one so
+  // that the first is clearly the costliest.
+  SleepFor(MonoDelta::FromMilliseconds(50));
+  s2->UpdateAccessTime();
+
+  // Opening a third scanner for the same user should evict the idle one,
+  // without touching the other user's scanner.
+  mgr.NewScanner(null_replica, "alice", RowFormatFlags::NO_FLAGS, &s3);
+  SharedScanner result;
+  ASSERT_FALSE(mgr.LookupScanner(s1->id(), &result));
+  ASSERT_TRUE(mgr.LookupScanner(s2->id(), &result));
+  ASSERT_TRUE(mgr.LookupScanner(s3->id(), &result));
+  ASSERT_TRUE(mgr.LookupScanner(other->id(), &result));
+  ASSERT_EQ(1, mgr.metrics_->scanners_evicted->value());
+  ASSERT_EQ(3, mgr.CountActiveScanners());
+}
+
 } // namespace tserver
 } // namespace kudu
@@ -17,24 +17,31 @@
 #include "kudu/tserver/scanners.h"
 
 #include <cstdint>
+#include <memory>
 #include <mutex>
 #include <ostream>
 
 #include <gflags/gflags.h>
 
+#include "kudu/common/common.pb.h"
 #include "kudu/common/iterator.h"
+#include "kudu/common/rowblock.h"
 #include "kudu/common/scan_spec.h"
 #include "kudu/common/schema.h"
 #include "kudu/gutil/bind.h"
 #include "kudu/gutil/bind_helpers.h"
 #include "kudu/gutil/hash/string_hash.h"
 #include "kudu/gutil/map-util.h"
+#include "kudu/gutil/port.h"
 #include "kudu/gutil/stl_util.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/tablet/tablet.h"
 #include "kudu/tablet/tablet_metrics.h"
 #include "kudu/tserver/scanner_metrics.h"
+#include "kudu/tserver/tserver.pb.h"
 #include "kudu/util/flag_tags.h"
+#include "kudu/util/mem_tracker.h"
+#include "kudu/util/memory/memory.h"
 #include "kudu/util/metrics.h"
 #include "kudu/util/status.h"
 #include "kudu/util/thread.h"
@@ -47,14 +54,61 @@ DEFINE_int32(scanner_gc_check_interval_us, 5 * 1000L *1000L, // 5 seconds
              "Number of microseconds in the interval at which we remove expired scanners");
 TAG_FLAG(scanner_gc_check_interval_us, hidden);
 
+DEFINE_int32(scanner_quota_per_user, 0,
+             "Maximum number of scanners a single user may keep open on this "
+             "server. When a user at the quota opens another scanner, the "
+             "user's costliest existing scanner (weighted by idle time and "
+             "pinned memory) is evicted to make room, so one runaway batch "
+             "job cannot starve other users of scanner resources. If set to "
+             "0, no quota is enforced.");
+TAG_FLAG(scanner_quota_per_user, advanced);
+TAG_FLAG(scanner_quota_per_user, runtime);
+
+DEFINE_int64(scan_result_cache_capacity_bytes, 0,
+             "Maximum amount of memory used to cache the results of completed "
+             "snapshot scans, so that identical re-issued scans (e.g. from "
+             "periodically refreshed dashboards) can be answered without "
+             "re-reading the tablet. If set to 0, scan results are not cached.");
+TAG_FLAG(scan_result_cache_capacity_bytes, advanced);
+TAG_FLAG(scan_result_cache_capacity_bytes, experimental);
+TAG_FLAG(scan_result_cache_capacity_bytes, runtime);
+DEFINE_int32(scan_projection_cache_capacity, 0,
+             "Maximum number of compiled scan projections to cache, so that "
+             "repeated scans which differ only in their predicate values "
+             "(e.g. dashboard query templates) skip the per-scan projection "
+             "validation and schema construction. If set to 0, compiled "
+             "projections are not cached.");
+TAG_FLAG(scan_projection_cache_capacity, advanced);
+TAG_FLAG(scan_projection_cache_capacity, experimental);
+TAG_FLAG(scan_projection_cache_capacity, runtime);
+
+DEFINE_int32(scan_result_cache_ttl_ms, 60000,
+             "Number of milliseconds a cached scan result may be served "
+             "before it is expired from the scan result cache");
+TAG_FLAG(scan_result_cache_ttl_ms, advanced);
+TAG_FLAG(scan_result_cache_ttl_ms, experimental);
+TAG_FLAG(scan_result_cache_ttl_ms, runtime);
+
 METRIC_DEFINE_gauge_size(server, active_scanners,
                          "Active Scanners",
                          kudu::MetricUnit::kScanners,
                          "Number of scanners that are currently active");
 
+METRIC_DEFINE_counter(server, scan_result_cache_hits,
+                      "Scan Result Cache Hits",
+                      kudu::MetricUnit::kScanners,
+                      "Number of scans which were served from the scan result cache");
+
+METRIC_DEFINE_counter(server, scan_result_cache_misses,
+                      "Scan Result Cache Misses",
+                      kudu::MetricUnit::kScanners,
+                      "Number of cacheable scans which were not found in the scan result cache");
+
+using std::shared_ptr;
 using std::string;
 using std::vector;
 using strings::Substitute;
+using strings::SubstituteAndAppend;
 
 namespace kudu {
 
@@ -62,8 +116,158 @@ using tablet::TabletReplica;
 
 namespace tserver {
 
-ScannerManager::ScannerManager(const scoped_refptr<MetricEntity>& metric_entity)
-    : shutdown_(false),
+ScanResultCache::ScanResultCache(const scoped_refptr<MetricEntity>& metric_entity) {
+  if (metric_entity) {
+    hits_ = METRIC_scan_result_cache_hits.Instantiate(metric_entity);
+    misses_ = METRIC_scan_result_cache_misses.Instantiate(metric_entity);
+  }
+}
+
+bool ScanResultCache::IsCacheableRequest(const ScanRequestPB& req) {
+  if (PREDICT_TRUE(FLAGS_scan_result_cache_capacity_bytes == 0)) {
+    return false;
+  }
+  if (!req.has_new_scan_request()) {
+    return false;
+  }
+  // Only snapshot reads at a client-provided timestamp are guaranteed to
+  // produce identical results when re-executed. Columnar results are returned
+  // through a different response path and are not cached.
+  const NewScanRequestPB& scan_pb = req.new_scan_request();
+  return scan_pb.read_mode() == READ_AT_SNAPSHOT &&
+         scan_pb.has_snap_timestamp() &&
+         !(scan_pb.row_format_flags() & RowFormatFlags::COLUMNAR_LAYOUT);
+}
+
+string ScanResultCache::DescriptorKey(const ScanRequestPB& req) {
+  DCHECK(req.has_new_scan_request());
+  // The serialized descriptor itself is used as the key, which rules out
+  // collisions between distinct scans. A logically identical descriptor
+  // which happens to serialize differently merely misses the cache.
+  string key;
+  CHECK(req.new_scan_request().AppendToString(&key));
+  // The batch size cap lives outside the descriptor, but bounds the (single)
+  // cached response frame.
+  key.push_back('\0');
+  key += std::to_string(req.has_batch_size_bytes() ? req.batch_size_bytes() : -1);
+  return key;
+}
+
+bool ScanResultCache::Lookup(const string& key, std::shared_ptr<Entry>* entry) {
+  std::lock_guard<simple_spinlock> l(lock_);
+  auto it = cache_.find(key);
+  if (it != cache_.end() && MonoTime::Now() > it->second.expiration_time) {
+    EraseUnlocked(it);
+    it = cache_.end();
+  }
+  if (it == cache_.end()) {
+    if (misses_) {
+      misses_->Increment();
+    }
+    return false;
+  }
+  lru_.splice(lru_.begin(), lru_, it->second.lru_it);
+  *entry = it->second.entry;
+  if (hits_) {
+    hits_->Increment();
+  }
+  return true;
+}
+
+void ScanResultCache::Insert(const string& key, std::shared_ptr<Entry> entry) {
+  size_t capacity = FLAGS_scan_result_cache_capacity_bytes;
+  size_t charge = key.size() + entry->rows_data.size() + entry->indirect_data.size() +
+      entry->last_primary_key.size() + sizeof(Entry);
+  if (charge > capacity) {
+    return;
+  }
+  MonoTime expiration_time = MonoTime::Now() +
+      MonoDelta::FromMilliseconds(FLAGS_scan_result_cache_ttl_ms);
+
+  std::lock_guard<simple_spinlock> l(lock_);
+  // Replace any existing result for the same descriptor.
+  auto it = cache_.find(key);
+  if (it != cache_.end()) {
+    EraseUnlocked(it);
+  }
+  while (usage_ + charge > capacity && !lru_.empty()) {
+    EraseUnlocked(cache_.find(lru_.back()));
+  }
+  lru_.push_front(key);
+  CachedResult result;
+  result.entry = std::move(entry);
+  result.expiration_time = expiration_time;
+  result.lru_it = lru_.begin();
+  result.charge = charge;
+  cache_.emplace(key, std::move(result));
+  usage_ += charge;
+}
+
+void ScanResultCache::EraseUnlocked(
+    std::unordered_map<string, CachedResult>::iterator it) {
+  DCHECK(lock_.is_locked());
+  DCHECK(it != cache_.end());
+  usage_ -= it->second.charge;
+  lru_.erase(it->second.lru_it);
+  cache_.erase(it);
+}
+
+bool CompiledProjectionCache::IsCacheableRequest(const NewScanRequestPB& /*scan_pb*/) {
+  return PREDICT_FALSE(FLAGS_scan_projection_cache_capacity > 0);
+}
+
+string CompiledProjectionCache::DescriptorKey(const NewScanRequestPB& scan_pb,
+                                              uint32_t schema_version) {
+  // The key covers every input to the compiled projections; predicate
+  // values are deliberately excluded, since scans which differ only in
+  // their values compile to the same schemas. Variable-length components
+  // are length-prefixed so that distinct descriptors cannot concatenate
+  // to the same key.
+  string key = Substitute("$0/$1/$2", scan_pb.tablet_id(), schema_version,
+                          static_cast<int>(scan_pb.order_mode()));
+  string serialized;
+  for (const ColumnSchemaPB& col : scan_pb.projected_columns()) {
+    serialized.clear();
+    CHECK(col.AppendToString(&serialized));
+    SubstituteAndAppend(&key, "/p$0:$1", serialized.size(), serialized);
+  }
+  // Column predicates refer to the tablet schema by name; the column name
+  // and the schema version pin down the materialized column.
+  for (const ColumnPredicatePB& pred : scan_pb.column_predicates()) {
+    SubstituteAndAppend(&key, "/c$0:$1", pred.column().size(), pred.column());
+  }
+  // The deprecated range predicates instead carry their column schema in
+  // the request, so the serialized column is part of the descriptor.
+  for (const ColumnRangePredicatePB& pred : scan_pb.deprecated_range_predicates()) {
+    serialized.clear();
+    CHECK(pred.column().AppendToString(&serialized));
+    SubstituteAndAppend(&key, "/d$0:$1", serialized.size(), serialized);
+  }
+  return key;
+}
+
+bool CompiledProjectionCache::Lookup(const string& key, std::shared_ptr<Entry>* entry) {
+  std::lock_guard<simple_spinlock> l(lock_);
+  return FindCopy(cache_, key, entry);
+}
+
+void CompiledProjectionCache::Insert(const string& key, std::shared_ptr<Entry> entry) {
+  size_t capacity = FLAGS_scan_projection_cache_capacity;
+  std::lock_guard<simple_spinlock> l(lock_);
+  if (cache_.size() >= capacity && !ContainsKey(cache_, key)) {
+    // The key space is bounded by the set of live query templates, so
+    // reaching capacity means one-off scans or retired schema versions have
+    // accumulated. Entries are cheap to rebuild; discard them wholesale
+    // rather than tracking recency.
+    cache_.clear();
+  }
+  cache_[key] = std::move(entry);
+}
+
+ScannerManager::ScannerManager(const scoped_refptr<MetricEntity>& metric_entity,
+                               const shared_ptr<MemTracker>& parent_mem_tracker)
+    : mem_tracker_(MemTracker::CreateTracker(-1, "Scanners", parent_mem_tracker)),
+      shutdown_(false),
       shutdown_cv_(&shutdown_lock_) {
   if (metric_entity) {
     metrics_.reset(new ScannerMetrics(metric_entity));
@@ -72,6 +276,8 @@ ScannerManager::ScannerManager(const scoped_refptr<MetricEntity>& metric_entity)
                                Unretained(this)))
       ->AutoDetach(&metric_detacher_);
   }
+  result_cache_.reset(new ScanResultCache(metric_entity));
+  projection_cache_.reset(new CompiledProjectionCache());
   for (size_t i = 0; i < kNumScannerMapStripes; i++) {
     scanner_maps_.push_back(new ScannerMapStripe());
   }
@@ -119,6 +325,10 @@ void ScannerManager::NewScanner(const scoped_refptr<TabletReplica>& tablet_repli
                                 const std::string& requestor_string,
                                 uint64_t row_format_flags,
                                 SharedScanner* scanner) {
+  if (PREDICT_FALSE(FLAGS_scanner_quota_per_user > 0)) {
+    EnforceQuotaForRequestor(requestor_string);
+  }
+
   // Keep trying to generate a unique ID until we get one.
   bool success = false;
   while (!success) {
@@ -131,7 +341,8 @@ void ScannerManager::NewScanner(const scoped_refptr<TabletReplica>& tablet_repli
                                tablet_replica,
                                requestor_string,
                                metrics_.get(),
-                               row_format_flags));
+                               row_format_flags,
+                               mem_tracker_));
 
     ScannerMapStripe& stripe = GetStripeByScannerId(id);
     std::lock_guard<RWMutex> l(stripe.lock_);
@@ -169,6 +380,53 @@ void ScannerManager::ListScanners(std::vector<SharedScanner>* scanners) {
   }
 }
 
+void ScannerManager::EnforceQuotaForRequestor(const string& requestor_string) {
+  const size_t quota = FLAGS_scanner_quota_per_user;
+  const MonoTime now = MonoTime::Now();
+  while (true) {
+    // Count the user's scanners, tracking the costliest one as the eviction
+    // victim.
+    size_t count = 0;
+    string victim_id;
+    double victim_cost = -1.0;
+    for (const ScannerMapStripe* stripe : scanner_maps_) {
+      shared_lock<RWMutex> l(stripe->lock_);
+      for (const ScannerMapEntry& se : stripe->scanners_by_id_) {
+        const SharedScanner& scanner = se.second;
+        if (scanner->requestor_string() != requestor_string) {
+          continue;
+        }
+        count++;
+        double cost = scanner->TimeSinceLastAccess(now).ToSeconds() *
+            (1 + scanner->memory_footprint());
+        if (cost > victim_cost) {
+          victim_cost = cost;
+          victim_id = se.first;
+        }
+      }
+    }
+    if (count < quota || victim_id.empty()) {
+      return;
+    }
+
+    ScannerMapStripe& stripe = GetStripeByScannerId(victim_id);
+    {
+      std::lock_guard<RWMutex> l(stripe.lock_);
+      // The victim may have been unregistered since we dropped the stripe
+      // lock; if so, rescan for another one.
+      if (stripe.scanners_by_id_.erase(victim_id) == 0) {
+        continue;
+      }
+    }
+    LOG(INFO) << Substitute(
+        "Evicting scanner id: $0 for $1, which is at the scanner quota "
+        "($2 scanners).", victim_id, requestor_string, quota);
+    if (metrics_) {
+      metrics_->scanners_evicted->Increment();
+    }
+  }
+}
+
 void ScannerManager::RemoveExpiredScanners() {
   MonoDelta scanner_ttl = MonoDelta::FromMilliseconds(FLAGS_scanner_ttl_ms);
   const MonoTime now = MonoTime::Now();
@@ -203,7 +461,8 @@ const std::string Scanner::kNullTabletId = "null tablet";
 
 Scanner::Scanner(string id, const scoped_refptr<TabletReplica>& tablet_replica,
                  string requestor_string, ScannerMetrics* metrics,
-                 uint64_t row_format_flags)
+                 uint64_t row_format_flags,
+                 shared_ptr<MemTracker> mem_tracker)
     : id_(std::move(id)),
       tablet_replica_(tablet_replica),
       requestor_string_(std::move(requestor_string)),
@@ -211,6 +470,8 @@ Scanner::Scanner(string id, const scoped_refptr<TabletReplica>& tablet_replica,
       start_time_(MonoTime::Now()),
       metrics_(metrics),
       arena_(256),
+      mem_tracker_(std::move(mem_tracker)),
+      mem_footprint_(0),
       row_format_flags_(row_format_flags) {
   if (tablet_replica_) {
     auto tablet = tablet_replica->shared_tablet();
@@ -238,6 +499,30 @@ void Scanner::UpdateAccessTime() {
   last_access_time_ = MonoTime::Now();
 }
 
+RowBlock* Scanner::PrepareRowBlockForBatch(const Schema& schema, size_t nrows) {
+  if (!block_arena_) {
+    if (mem_tracker_) {
+      block_allocator_.reset(new MemoryTrackingBufferAllocator(
+          HeapBufferAllocator::Get(), mem_tracker_));
+      block_arena_.reset(new Arena(block_allocator_.get(), 32 * 1024));
+    } else {
+      block_arena_.reset(new Arena(32 * 1024));
+    }
+  } else {
+    // Data from the previous batch has been serialized into the response by
+    // now, so its indirect data can be recycled.
+    block_arena_->Reset();
+  }
+  // The capacity may change if the batch size flag is changed at runtime;
+  // the schema never changes for a given scanner.
+  if (!block_ || block_->row_capacity() != nrows) {
+    DCHECK(!block_ || block_->schema().Equals(schema));
+    block_.reset(new RowBlock(schema, nrows, block_arena_.get()));
+  }
+  mem_footprint_.Store(arena_.memory_footprint() + block_arena_->memory_footprint());
+  return block_.get();
+}
+
 void Scanner::Init(gscoped_ptr<RowwiseIterator> iter,
                    gscoped_ptr<ScanSpec> spec) {
   std::lock_guard<simple_spinlock> l(lock_);
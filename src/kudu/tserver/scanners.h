@@ -19,6 +19,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -30,12 +31,16 @@
 #include <gtest/gtest_prod.h>
 
 #include "kudu/common/iterator_stats.h"
+#include "kudu/common/schema.h"
+#include "kudu/common/timestamp.h"
 #include "kudu/gutil/gscoped_ptr.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/tablet/tablet_replica.h"
+#include "kudu/util/atomic.h"
 #include "kudu/util/auto_release_pool.h"
 #include "kudu/util/condition_variable.h"
+#include "kudu/util/faststring.h"
 #include "kudu/util/locks.h"
 #include "kudu/util/memory/arena.h"
 #include "kudu/util/metrics.h"
@@ -46,18 +51,146 @@
 
 namespace kudu {
 
+class MemTracker;
+class MemoryTrackingBufferAllocator;
+class RowBlock;
 class RowwiseIterator;
 class ScanSpec;
-class Schema;
 class Status;
 class Thread;
 
 namespace tserver {
 
+class NewScanRequestPB;
+class ScanRequestPB;
 class Scanner;
 struct ScannerMetrics;
 typedef std::shared_ptr<Scanner> SharedScanner;
 
+// A bounded LRU cache of the complete results of recently completed snapshot
+// scans, keyed by the serialized scan descriptor (tablet, projection,
+// predicates, bounds and snapshot timestamp).
+//
+// Only READ_AT_SNAPSHOT scans with a client-provided snapshot timestamp are
+// cached: MVCC guarantees that re-executing such a scan produces the same
+// rows regardless of intervening flushes and compactions, so entries never
+// need to be invalidated for correctness, only bounded in size and age.
+//
+// This class is thread-safe.
+class ScanResultCache {
+ public:
+  // The complete result of a scan, in the same form it is returned to the
+  // client: the serialized row data and indirect data sidecars, plus the
+  // response fields which depend on the scanned data.
+  struct Entry {
+    int32_t num_rows;
+    std::string rows_data;
+    std::string indirect_data;
+    std::string last_primary_key;
+    uint64_t snap_timestamp;
+  };
+
+  // The passed 'metric_entity' may be NULL in tests.
+  explicit ScanResultCache(const scoped_refptr<MetricEntity>& metric_entity);
+
+  // Returns true if results for the given scan request are eligible to be
+  // served from or inserted into the cache.
+  static bool IsCacheableRequest(const ScanRequestPB& req);
+
+  // Returns the cache key for the request's scan descriptor. The request
+  // must be cacheable.
+  static std::string DescriptorKey(const ScanRequestPB& req);
+
+  // Look up the cached result for the given descriptor key. Returns true and
+  // sets 'entry' on a hit.
+  bool Lookup(const std::string& key, std::shared_ptr<Entry>* entry);
+
+  // Insert the result of a completed scan, evicting least-recently-used
+  // entries as needed to respect the configured capacity.
+  void Insert(const std::string& key, std::shared_ptr<Entry> entry);
+
+ private:
+  struct CachedResult {
+    std::shared_ptr<Entry> entry;
+    MonoTime expiration_time;
+    std::list<std::string>::iterator lru_it;
+    size_t charge;
+  };
+
+  // Remove the given entry from the cache. Must be called with 'lock_' held.
+  void EraseUnlocked(std::unordered_map<std::string, CachedResult>::iterator it);
+
+  scoped_refptr<Counter> hits_;
+  scoped_refptr<Counter> misses_;
+
+  // Lock protecting 'cache_', 'lru_' and 'usage_'.
+  mutable simple_spinlock lock_;
+
+  // Cached results, keyed by descriptor key.
+  std::unordered_map<std::string, CachedResult> cache_;
+
+  // Keys in most-recently-used-first order.
+  std::list<std::string> lru_;
+
+  // Total charge of the cached entries, in bytes.
+  size_t usage_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(ScanResultCache);
+};
+
+// A bounded cache of projection schemas compiled from scan requests, keyed
+// by the parts of the scan descriptor which determine them: the projected
+// columns, the predicate columns, the order mode, and the version of the
+// tablet schema the projections were compiled against.
+//
+// Repeated query templates (e.g. dashboard refreshes) differ only in their
+// predicate values, so their scans compile to identical schemas; serving
+// them from the cache skips the per-scan projection validation and
+// SchemaBuilder work. A tablet schema change bumps the schema version and
+// thus produces new keys, so stale entries are never hit, only aged out
+// when the cache reaches capacity.
+//
+// This class is thread-safe.
+class CompiledProjectionCache {
+ public:
+  // The schemas compiled from a scan descriptor: the projection the client
+  // requested, and the projection the scan iterator uses, which
+  // additionally materializes predicate columns (and, for ordered scans,
+  // key columns).
+  struct Entry {
+    Schema client_projection;
+    Schema scan_projection;
+  };
+
+  CompiledProjectionCache() {}
+
+  // Returns true if the compiled projections for the given scan request are
+  // eligible to be served from or inserted into the cache.
+  static bool IsCacheableRequest(const NewScanRequestPB& scan_pb);
+
+  // Return the cache key covering the parts of 'scan_pb' which determine
+  // the compiled projections. 'schema_version' is the version of the
+  // tablet schema the projections are resolved against.
+  static std::string DescriptorKey(const NewScanRequestPB& scan_pb,
+                                   uint32_t schema_version);
+
+  // Look up the cached projections for the given descriptor key. Returns
+  // true and sets 'entry' on a hit.
+  bool Lookup(const std::string& key, std::shared_ptr<Entry>* entry);
+
+  // Insert the projections compiled for a scan which passed validation.
+  void Insert(const std::string& key, std::shared_ptr<Entry> entry);
+
+ private:
+  // Lock protecting 'cache_'.
+  mutable simple_spinlock lock_;
+
+  // Cached projections, keyed by descriptor key.
+  std::unordered_map<std::string, std::shared_ptr<Entry>> cache_;
+
+  DISALLOW_COPY_AND_ASSIGN(CompiledProjectionCache);
+};
+
 // Manages the live scanners within a Tablet Server.
 //
 // When a scanner is created by a client, it is assigned a unique scanner ID.
@@ -68,7 +201,11 @@ typedef std::shared_ptr<Scanner> SharedScanner;
 // removes any scanners which have not been accessed since a configurable TTL.
 class ScannerManager {
  public:
-  explicit ScannerManager(const scoped_refptr<MetricEntity>& metric_entity);
+  // 'parent_mem_tracker' is the tracker under which scanners' batch storage
+  // is tracked; if NULL, a tracker parented to the root is used.
+  explicit ScannerManager(
+      const scoped_refptr<MetricEntity>& metric_entity,
+      const std::shared_ptr<MemTracker>& parent_mem_tracker = std::shared_ptr<MemTracker>());
   ~ScannerManager();
 
   // Starts the expired scanner removal thread.
@@ -101,8 +238,18 @@ class ScannerManager {
   // Iterate through scanners and remove any which are past their TTL.
   void RemoveExpiredScanners();
 
+  // Return the cache of completed snapshot scan results.
+  ScanResultCache* result_cache() { return result_cache_.get(); }
+
+  // Return the cache of compiled scan projections.
+  CompiledProjectionCache* projection_cache() { return projection_cache_.get(); }
+
+  // Return the memory tracker which scanners charge their batch storage to.
+  const std::shared_ptr<MemTracker>& mem_tracker() const { return mem_tracker_; }
+
  private:
   FRIEND_TEST(ScannerTest, TestExpire);
+  FRIEND_TEST(ScannerTest, TestPerUserQuota);
 
   enum {
     kNumScannerMapStripes = 32
@@ -122,11 +269,27 @@ class ScannerManager {
   // Periodically call RemoveExpiredScanners().
   void RunRemovalThread();
 
+  // If the given user is at its scanner quota (--scanner_quota_per_user),
+  // evict its costliest scanners until a new one may be registered. The
+  // cost of a scanner scales with its idle time and the memory pinned by
+  // its batch storage, so recently accessed scanners (e.g. interactive
+  // point scans) are never chosen ahead of an idle batch scan.
+  void EnforceQuotaForRequestor(const std::string& requestor_string);
+
   ScannerMapStripe& GetStripeByScannerId(const std::string& scanner_id);
 
   // (Optional) scanner metrics for this instance.
   gscoped_ptr<ScannerMetrics> metrics_;
 
+  // Cache of completed snapshot scan results.
+  gscoped_ptr<ScanResultCache> result_cache_;
+
+  // Cache of compiled scan projections.
+  gscoped_ptr<CompiledProjectionCache> projection_cache_;
+
+  // Tracks the memory consumed by scanners' batch storage.
+  std::shared_ptr<MemTracker> mem_tracker_;
+
   // If true, removal thread should shut itself down. Protected
   // by 'shutdown_lock_' and 'shutdown_cv_'.
   bool shutdown_;
@@ -175,7 +338,8 @@ class Scanner {
   Scanner(std::string id,
           const scoped_refptr<tablet::TabletReplica>& tablet_replica,
           std::string requestor_string, ScannerMetrics* metrics,
-          uint64_t row_format_flags);
+          uint64_t row_format_flags,
+          std::shared_ptr<MemTracker> mem_tracker = std::shared_ptr<MemTracker>());
   ~Scanner();
 
   // Attach an actual iterator and a ScanSpec to this Scanner.
@@ -282,6 +446,72 @@ class Scanner {
     return row_format_flags_;
   }
 
+  // The snapshot timestamp of an ordered READ_AT_SNAPSHOT scan, recorded so
+  // that scan continuation tokens can be built for each batch. Left as
+  // kInvalidTimestamp for scans which can't be resumed by primary key.
+  const Timestamp& checkpoint_snap_timestamp() const {
+    return checkpoint_snap_timestamp_;
+  }
+  void set_checkpoint_snap_timestamp(const Timestamp& ts) {
+    checkpoint_snap_timestamp_ = ts;
+  }
+
+  // Return a RowBlock over 'schema' with capacity 'nrows', backed by this
+  // scanner's batch arena.
+  //
+  // The block and its arena are reused across the scanner's batches; the
+  // arena is reset on each call, so any data referenced from the previous
+  // batch must already have been serialized into a response. Reusing the
+  // batch storage makes steady-state scans allocation-free per batch, which
+  // avoids tcmalloc central free-list contention when many scanners run
+  // concurrently.
+  //
+  // 'schema' must not change over the lifetime of the scanner.
+  RowBlock* PrepareRowBlockForBatch(const Schema& schema, size_t nrows);
+
+  // Return the approximate number of bytes pinned by this scanner's arenas,
+  // as of the start of its most recent batch. May be read from any thread.
+  size_t memory_footprint() const {
+    return mem_footprint_.Load();
+  }
+
+  // The serialized data of the scanner's most recent response, retained so
+  // that a client retry of the same call sequence ID (e.g. after the
+  // response was lost by the network) can be answered by re-sending the
+  // serialized batch rather than re-executing it against the tablet.
+  struct LastResponseData {
+    // The call sequence ID of the request this response answered.
+    uint32_t call_seq_id;
+
+    // Whether the scan had more results after this batch.
+    bool has_more_results;
+
+    // The number of client-visible rows in the batch.
+    uint32_t num_rows;
+
+    // The encoded primary key of the last row in the batch, if any.
+    std::string last_primary_key;
+
+    std::unique_ptr<faststring> rows_data;
+    std::unique_ptr<faststring> indirect_data;
+  };
+
+  // Replace the retained last response.
+  void set_last_response(std::shared_ptr<LastResponseData> last_response) {
+    std::lock_guard<simple_spinlock> l(lock_);
+    last_response_ = std::move(last_response);
+  }
+
+  // Return the retained response for the given call sequence ID, or nullptr
+  // if no matching response is retained.
+  std::shared_ptr<LastResponseData> last_response_for_seq_id(uint32_t call_seq_id) const {
+    std::lock_guard<simple_spinlock> l(lock_);
+    if (last_response_ && last_response_->call_seq_id == call_seq_id) {
+      return last_response_;
+    }
+    return nullptr;
+  }
+
  private:
   friend class ScannerManager;
 
@@ -320,6 +550,9 @@ class Scanner {
   // The spec used by 'iter_'
   gscoped_ptr<ScanSpec> spec_;
 
+  // See checkpoint_snap_timestamp().
+  Timestamp checkpoint_snap_timestamp_;
+
   // Stores the request's projection schema, if it differs from the
   // schema used by the iterator.
   gscoped_ptr<Schema> client_projection_schema_;
@@ -333,9 +566,30 @@ class Scanner {
   // response.
   Arena arena_;
 
+  // Tracker which the batch storage below is charged to. May be NULL in
+  // tests.
+  std::shared_ptr<MemTracker> mem_tracker_;
+
+  // Batch storage reused across this scanner's batches. Lazily created by
+  // PrepareRowBlockForBatch(). 'block_allocator_' must outlive
+  // 'block_arena_', which must outlive 'block_'.
+  gscoped_ptr<MemoryTrackingBufferAllocator> block_allocator_;
+  gscoped_ptr<Arena> block_arena_;
+  gscoped_ptr<RowBlock> block_;
+
+  // Approximate footprint of 'arena_' and 'block_arena_', updated by
+  // PrepareRowBlockForBatch(). Atomic so that the scanner manager can read
+  // it while computing eviction costs.
+  AtomicInt<int64_t> mem_footprint_;
+
   // The row format flags the client passed, if any.
   const uint64_t row_format_flags_;
 
+  // The retained last response, if any. Shared with the RPC sidecars of the
+  // in-flight response so retention adds no extra copy. Protected by
+  // 'lock_'.
+  std::shared_ptr<LastResponseData> last_response_;
+
   DISALLOW_COPY_AND_ASSIGN(Scanner);
 };
 
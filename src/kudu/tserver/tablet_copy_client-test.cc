@@ -70,6 +70,8 @@ using std::string;
 using std::thread;
 using std::vector;
 
+DECLARE_int32(tablet_copy_download_window);
+DECLARE_int32(tablet_copy_transfer_chunk_size_bytes);
 DECLARE_string(block_manager);
 
 METRIC_DECLARE_counter(block_manager_total_disk_sync);
@@ -219,6 +221,28 @@ TEST_F(TabletCopyClientTest, TestDownloadWalSegment) {
   ASSERT_OK(CompareFileContents(path, server_path));
 }
 
+// Like TestDownloadWalSegment, but with a small chunk size and several
+// pipelined chunk fetches in flight, to exercise the windowed download path.
+TEST_F(TabletCopyClientTest, TestDownloadWalSegmentPipelined) {
+  FLAGS_tablet_copy_transfer_chunk_size_bytes = 1024;
+  FLAGS_tablet_copy_download_window = 4;
+
+  ASSERT_OK(env_util::CreateDirIfMissing(
+      env_, fs_manager_->GetTabletWalDir(GetTabletId())));
+
+  uint64_t seqno = client_->wal_seqnos_[0];
+  string path = fs_manager_->GetWalSegmentFileName(GetTabletId(), seqno);
+
+  ASSERT_OK(client_->DownloadWAL(seqno));
+
+  log::SegmentSequence local_segments;
+  ASSERT_OK(tablet_replica_->log()->reader()->GetSegmentsSnapshot(&local_segments));
+  const scoped_refptr<log::ReadableLogSegment>& segment = local_segments[0];
+
+  // Compare the downloaded file with the source file.
+  ASSERT_OK(CompareFileContents(path, segment->path()));
+}
+
 // Ensure that we detect data corruption at the per-transfer level.
 TEST_F(TabletCopyClientTest, TestVerifyData) {
   string good = "This is a known good string";
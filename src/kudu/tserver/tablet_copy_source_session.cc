@@ -45,6 +45,7 @@
 #include "kudu/rpc/transfer.h"
 #include "kudu/tablet/tablet_metadata.h"
 #include "kudu/tablet/tablet_replica.h"
+#include "kudu/util/env.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/monotime.h"
 #include "kudu/util/pb_util.h"
@@ -389,6 +390,10 @@ Status TabletCopySourceSession::OpenBlock(const BlockId& block_id) {
     return s.CloneAndPrepend("Unable to get size of block");
   }
 
+  // The block will be streamed to the copying peer from start to end, so
+  // hint the kernel to ramp up readahead. Purely advisory.
+  ignore_result(block->HintAccessPattern(ACCESS_PATTERN_SEQUENTIAL));
+
   s = AddImmutableFileToMap(&blocks_, block_id, block.get(), size);
   if (!s.ok()) {
     s = s.CloneAndPrepend(Substitute("Error accessing data for block $0", block_id.ToString()));
@@ -57,6 +57,11 @@ class TabletReplicaLookupIf {
 
   virtual const NodeInstancePB& NodeInstance() const = 0;
 
+  // Hint that a caller is waiting on the given tablet. Implementations which
+  // open tablets asynchronously at startup may use this to reorder their
+  // remaining work; the default does nothing.
+  virtual void PrioritizeTabletForOpen(const std::string& /*tablet_id*/) {}
+
   virtual void StartTabletCopy(
       const consensus::StartTabletCopyRequestPB* req,
       std::function<void(const Status&, TabletServerErrorPB::Code)> cb) = 0;
@@ -42,6 +42,7 @@
 #include "kudu/common/encoded_key.h"
 #include "kudu/common/partial_row.h"
 #include "kudu/common/partition.h"
+#include "kudu/common/row.h"
 #include "kudu/common/row_operations.h"
 #include "kudu/common/schema.h"
 #include "kudu/common/timestamp.h"
@@ -143,9 +144,14 @@ DECLARE_int32(flush_threshold_mb);
 DECLARE_int32(flush_threshold_secs);
 DECLARE_int32(maintenance_manager_num_threads);
 DECLARE_int32(metrics_retirement_age_ms);
+DECLARE_int32(num_scan_executor_threads);
+DECLARE_int32(scan_projection_cache_capacity);
+DECLARE_int64(scan_result_cache_capacity_bytes);
+DECLARE_int32(scanner_batch_bytes_target);
 DECLARE_int32(scanner_batch_size_rows);
 DECLARE_int32(scanner_gc_check_interval_us);
 DECLARE_int32(scanner_ttl_ms);
+DECLARE_bool(tablet_open_warm_block_cache);
 DECLARE_string(block_manager);
 DECLARE_string(env_inject_eio_globs);
 
@@ -153,6 +159,7 @@ DECLARE_string(env_inject_eio_globs);
 METRIC_DECLARE_counter(rows_inserted);
 METRIC_DECLARE_counter(rows_updated);
 METRIC_DECLARE_counter(rows_deleted);
+METRIC_DECLARE_counter(scan_result_cache_hits);
 METRIC_DECLARE_counter(scanners_expired);
 METRIC_DECLARE_gauge_uint64(log_block_manager_blocks_under_management);
 METRIC_DECLARE_gauge_uint64(log_block_manager_containers);
@@ -1112,6 +1119,30 @@ TEST_F(TabletServerTest, TestRecoveryWithMutationsWhileFlushingAndCompacting) {
 
 #define ANFF ASSERT_NO_FATAL_FAILURE
 
+// Exercise the block cache warming pass which runs when a tablet is opened
+// with --tablet_open_warm_block_cache. The warming scan has to cope with
+// multiple rowsets and with on-disk deltas, so build a tablet with both
+// before restarting.
+TEST_F(TabletServerTest, TestWarmBlockCacheOnOpen) {
+  FLAGS_tablet_open_warm_block_cache = true;
+
+  ASSERT_NO_FATAL_FAILURE(InsertTestRowsRemote(1, 5));
+  ASSERT_OK(tablet_replica_->tablet()->Flush());
+  ANFF(UpdateTestRowRemote(1, 10));
+  ASSERT_OK(tablet_replica_->tablet()->FlushBiggestDMS());
+  ASSERT_NO_FATAL_FAILURE(InsertTestRowsRemote(6, 2));
+  ASSERT_OK(tablet_replica_->tablet()->Flush());
+
+  ASSERT_OK(ShutdownAndRebuildTablet());
+  ANFF(VerifyRows(schema_, { KeyValue(1, 10),
+                             KeyValue(2, 2),
+                             KeyValue(3, 3),
+                             KeyValue(4, 4),
+                             KeyValue(5, 5),
+                             KeyValue(6, 6),
+                             KeyValue(7, 7) }));
+}
+
 // Regression test for KUDU-176. Ensures that after a major delta compaction,
 // restarting properly recovers the tablet.
 TEST_F(TabletServerTest, TestKUDU_176_RecoveryAfterMajorDeltaCompaction) {
@@ -1360,6 +1391,33 @@ TEST_F(TabletServerTest, TestScan) {
   ASSERT_EQ(0, tablet_active_scanners->value());
 }
 
+// Scans routed through the dedicated scan executor pool should behave
+// identically to scans executed on the RPC worker threads.
+TEST_F(TabletServerTest, TestScanOnDedicatedExecutor) {
+  FLAGS_num_scan_executor_threads = 2;
+
+  int num_rows = 1000;
+  InsertTestRowsDirect(0, num_rows);
+
+  ScanResponsePB resp;
+  ASSERT_NO_FATAL_FAILURE(OpenScannerWithAllColumns(&resp));
+  ASSERT_TRUE(!resp.scanner_id().empty());
+
+  vector<string> results;
+  ASSERT_NO_FATAL_FAILURE(DrainScannerToStrings(resp.scanner_id(), schema_, &results));
+  ASSERT_EQ(num_rows, results.size());
+
+  KuduPartialRow row(&schema_);
+  for (int i = 0; i < num_rows; i++) {
+    BuildTestRow(i, &row);
+    ASSERT_EQ("(" + row.ToString() + ")", results[i]);
+  }
+
+  // Route subsequent scans back through the RPC worker threads. (The pool,
+  // once created, sticks around for the life of the process.)
+  FLAGS_num_scan_executor_threads = 0;
+}
+
 TEST_F(TabletServerTest, TestExpiredScanner) {
   // Make scanners expire quickly.
   FLAGS_scanner_ttl_ms = 1;
@@ -1577,6 +1635,225 @@ TEST_F(TabletServerTest, TestSnapshotScan_WithoutSnapshotTimestamp) {
   ASSERT_GT(resp.propagated_timestamp(), resp.snap_timestamp());
 }
 
+// Tests that an identical re-issued snapshot scan is served from the scan
+// result cache and returns the same rows.
+TEST_F(TabletServerTest, TestScanResultCache) {
+  FLAGS_scan_result_cache_capacity_bytes = 32 * 1024 * 1024;
+  const int num_rows = 100;
+  vector<uint64_t> write_timestamps_collector;
+  InsertTestRowsRemote(0, num_rows, 1, nullptr, kTabletId, &write_timestamps_collector);
+
+  scoped_refptr<Counter> cache_hits = METRIC_scan_result_cache_hits.Instantiate(
+      mini_server_->server()->metric_entity());
+
+  // Set up a snapshot scan with no predicates, all columns, reading at a
+  // timestamp which includes the written rows.
+  ScanRequestPB req;
+  NewScanRequestPB* scan = req.mutable_new_scan_request();
+  scan->set_tablet_id(kTabletId);
+  scan->set_read_mode(READ_AT_SNAPSHOT);
+  scan->set_snap_timestamp(Timestamp(write_timestamps_collector[0] + 1).ToUint64());
+  ASSERT_OK(SchemaToColumnPBs(schema_, scan->mutable_projected_columns()));
+  req.set_call_seq_id(0);
+  // Use a batch size large enough for the scan to complete in one response;
+  // only completed scans are cached.
+  req.set_batch_size_bytes(1024 * 1024);
+
+  vector<string> first_results;
+  {
+    ScanResponsePB resp;
+    RpcController rpc;
+    SCOPED_TRACE(SecureDebugString(req));
+    ASSERT_OK(proxy_->Scan(req, &resp, &rpc));
+    SCOPED_TRACE(SecureDebugString(resp));
+    ASSERT_FALSE(resp.has_error());
+    ASSERT_FALSE(resp.has_more_results());
+    ASSERT_NO_FATAL_FAILURE(StringifyRowsFromResponse(schema_, rpc, &resp, &first_results));
+    ASSERT_EQ(num_rows, first_results.size());
+  }
+  ASSERT_EQ(0, cache_hits->value());
+
+  // Re-issuing the identical request must return the same rows without
+  // opening a new scanner.
+  {
+    ScanResponsePB resp;
+    RpcController rpc;
+    SCOPED_TRACE(SecureDebugString(req));
+    ASSERT_OK(proxy_->Scan(req, &resp, &rpc));
+    SCOPED_TRACE(SecureDebugString(resp));
+    ASSERT_FALSE(resp.has_error());
+    ASSERT_FALSE(resp.has_more_results());
+    ASSERT_FALSE(resp.has_scanner_id());
+    vector<string> results;
+    ASSERT_NO_FATAL_FAILURE(StringifyRowsFromResponse(schema_, rpc, &resp, &results));
+    ASSERT_EQ(first_results, results);
+  }
+  ASSERT_EQ(1, cache_hits->value());
+}
+
+// Tests that repeated scans which differ only in their predicate values
+// reuse the projections compiled by the first scan and still return the
+// correct rows.
+TEST_F(TabletServerTest, TestCompiledProjectionCache) {
+  FLAGS_scan_projection_cache_capacity = 32;
+  InsertTestRowsDirect(0, 100);
+
+  // Issue two scans with the same shape but different predicate bounds;
+  // the second reuses the projections compiled by the first.
+  for (int iter = 0; iter < 2; iter++) {
+    ScanRequestPB req;
+    ScanResponsePB resp;
+    RpcController rpc;
+
+    NewScanRequestPB* scan = req.mutable_new_scan_request();
+    scan->set_tablet_id(kTabletId);
+    req.set_batch_size_bytes(0); // so it won't return data right away
+    ASSERT_OK(SchemaToColumnPBs(schema_, scan->mutable_projected_columns()));
+
+    // Set up a range predicate: lower_bound <= key
+    ColumnRangePredicatePB* pred = scan->add_deprecated_range_predicates();
+    pred->mutable_column()->CopyFrom(scan->projected_columns(0));
+    int32_t lower_bound_int = iter == 0 ? 51 : 91;
+    pred->mutable_lower_bound()->append(reinterpret_cast<char*>(&lower_bound_int),
+                                        sizeof(lower_bound_int));
+
+    {
+      SCOPED_TRACE(SecureDebugString(req));
+      ASSERT_OK(proxy_->Scan(req, &resp, &rpc));
+      SCOPED_TRACE(SecureDebugString(resp));
+      ASSERT_FALSE(resp.has_error());
+    }
+
+    vector<string> results;
+    ASSERT_NO_FATAL_FAILURE(
+      DrainScannerToStrings(resp.scanner_id(), schema_, &results));
+    ASSERT_EQ(iter == 0 ? 49 : 9, results.size());
+  }
+
+  // Scans which differ only in their predicate values share a descriptor
+  // key, while a different projection produces a different one.
+  NewScanRequestPB scan_a;
+  scan_a.set_tablet_id(kTabletId);
+  ASSERT_OK(SchemaToColumnPBs(schema_, scan_a.mutable_projected_columns()));
+  ColumnRangePredicatePB* pred_a = scan_a.add_deprecated_range_predicates();
+  pred_a->mutable_column()->CopyFrom(scan_a.projected_columns(0));
+  int32_t bound = 51;
+  pred_a->mutable_lower_bound()->append(reinterpret_cast<char*>(&bound), sizeof(bound));
+
+  NewScanRequestPB scan_b = scan_a;
+  bound = 91;
+  scan_b.mutable_deprecated_range_predicates(0)->mutable_lower_bound()->assign(
+      reinterpret_cast<char*>(&bound), sizeof(bound));
+  ASSERT_EQ(CompiledProjectionCache::DescriptorKey(scan_a, 0),
+            CompiledProjectionCache::DescriptorKey(scan_b, 0));
+
+  NewScanRequestPB scan_c = scan_a;
+  scan_c.mutable_projected_columns()->RemoveLast();
+  ASSERT_NE(CompiledProjectionCache::DescriptorKey(scan_a, 0),
+            CompiledProjectionCache::DescriptorKey(scan_c, 0));
+}
+
+// Tests that a scan still returns all rows when the internal batch size is
+// derived from the projection's row width rather than a fixed row count.
+TEST_F(TabletServerTest, TestScanWithBatchBytesTarget) {
+  FLAGS_scanner_batch_bytes_target = 4096;
+  const int num_rows = 1000;
+  InsertTestRowsDirect(0, num_rows);
+
+  ScanRequestPB req;
+  ScanResponsePB resp;
+  RpcController rpc;
+
+  NewScanRequestPB* scan = req.mutable_new_scan_request();
+  scan->set_tablet_id(kTabletId);
+  req.set_batch_size_bytes(0); // so it won't return data right away
+  ASSERT_OK(SchemaToColumnPBs(schema_, scan->mutable_projected_columns()));
+
+  {
+    SCOPED_TRACE(SecureDebugString(req));
+    ASSERT_OK(proxy_->Scan(req, &resp, &rpc));
+    SCOPED_TRACE(SecureDebugString(resp));
+    ASSERT_FALSE(resp.has_error());
+  }
+
+  vector<string> results;
+  ASSERT_NO_FATAL_FAILURE(
+    DrainScannerToStrings(resp.scanner_id(), schema_, &results));
+  ASSERT_EQ(num_rows, results.size());
+}
+
+// Tests that an ordered snapshot scan returns continuation tokens and that a
+// brand new scan carrying such a token resumes from where the original scan
+// left off.
+TEST_F(TabletServerTest, TestScanContinuationToken) {
+  const int num_rows = 100;
+  InsertTestRowsDirect(0, num_rows);
+
+  ScanRequestPB req;
+  ScanResponsePB resp;
+  RpcController rpc;
+
+  // Open an ordered snapshot scan; these are the scans which produce
+  // continuation tokens.
+  NewScanRequestPB* scan = req.mutable_new_scan_request();
+  scan->set_tablet_id(kTabletId);
+  scan->set_read_mode(READ_AT_SNAPSHOT);
+  scan->set_order_mode(ORDERED);
+  req.set_call_seq_id(0);
+  req.set_batch_size_bytes(0); // so it won't return data right away
+  ASSERT_OK(SchemaToColumnPBs(schema_, scan->mutable_projected_columns()));
+  {
+    SCOPED_TRACE(SecureDebugString(req));
+    ASSERT_OK(proxy_->Scan(req, &resp, &rpc));
+    SCOPED_TRACE(SecureDebugString(resp));
+    ASSERT_FALSE(resp.has_error());
+    ASSERT_TRUE(resp.has_more_results());
+  }
+
+  // Pull a small first batch and grab its continuation token.
+  vector<string> results;
+  {
+    ScanRequestPB continue_req;
+    continue_req.set_scanner_id(resp.scanner_id());
+    continue_req.set_call_seq_id(1);
+    continue_req.set_batch_size_bytes(100);
+    rpc.Reset();
+    SCOPED_TRACE(SecureDebugString(continue_req));
+    ASSERT_OK(proxy_->Scan(continue_req, &resp, &rpc));
+    SCOPED_TRACE(SecureDebugString(resp));
+    ASSERT_FALSE(resp.has_error());
+    ASSERT_TRUE(resp.has_continuation_token());
+    ASSERT_NO_FATAL_FAILURE(StringifyRowsFromResponse(schema_, rpc, &resp, &results));
+  }
+  ASSERT_GT(results.size(), 0);
+  ASSERT_LT(results.size(), num_rows);
+  const string token = resp.continuation_token();
+
+  // Abandon the original scanner and resume from the token with a completely
+  // new scan: the snapshot timestamp and start key come from the token.
+  ScanRequestPB resume_req;
+  ScanResponsePB resume_resp;
+  rpc.Reset();
+  NewScanRequestPB* resume_scan = resume_req.mutable_new_scan_request();
+  resume_scan->set_tablet_id(kTabletId);
+  resume_scan->set_continuation_token(token);
+  resume_req.set_call_seq_id(0);
+  resume_req.set_batch_size_bytes(0); // so it won't return data right away
+  ASSERT_OK(SchemaToColumnPBs(schema_, resume_scan->mutable_projected_columns()));
+  {
+    SCOPED_TRACE(SecureDebugString(resume_req));
+    ASSERT_OK(proxy_->Scan(resume_req, &resume_resp, &rpc));
+    SCOPED_TRACE(SecureDebugString(resume_resp));
+    ASSERT_FALSE(resume_resp.has_error());
+  }
+  ASSERT_NO_FATAL_FAILURE(
+    DrainScannerToStrings(resume_resp.scanner_id(), schema_, &results));
+
+  // Between the first batch and the resumed scan we should see every row
+  // exactly once.
+  ASSERT_EQ(num_rows, results.size());
+}
+
 // Tests that a snapshot in the future (beyond the current time plus maximum
 // synchronization error) fails as an invalid snapshot.
 TEST_F(TabletServerTest, TestSnapshotScan_SnapshotInTheFutureFails) {
@@ -1964,6 +2241,69 @@ TEST_F(TabletServerTest, TestScanWithEncodedPredicates) {
 }
 
 
+TEST_F(TabletServerTest, TestMultiGet) {
+  // Put some rows in a flushed rowset (with bloom filters) and some in the
+  // MemRowSet, so the point lookups exercise both paths.
+  InsertTestRowsDirect(0, 100);
+  ASSERT_OK(tablet_replica_->tablet()->Flush());
+  InsertTestRowsDirect(100, 50);
+
+  MultiGetRequestPB req;
+  MultiGetResponsePB resp;
+  RpcController rpc;
+
+  req.set_tablet_id(kTabletId);
+  ASSERT_OK(SchemaToColumnPBs(schema_, req.mutable_projected_columns()));
+
+  auto add_key = [&] (int32_t key) {
+    EncodedKeyBuilder ekb(&schema_);
+    ekb.AddColumnKey(&key);
+    gscoped_ptr<EncodedKey> encoded(ekb.BuildEncodedKey());
+    req.add_encoded_keys()->assign(
+        reinterpret_cast<const char*>(encoded->encoded_key().data()),
+        encoded->encoded_key().size());
+  };
+  add_key(5);     // in the flushed rowset
+  add_key(120);   // in the MemRowSet
+  add_key(1000);  // not present
+  add_key(42);    // in the flushed rowset
+
+  {
+    SCOPED_TRACE(SecureDebugString(req));
+    ASSERT_OK(proxy_->MultiGet(req, &resp, &rpc));
+    SCOPED_TRACE(SecureDebugString(resp));
+    ASSERT_FALSE(resp.has_error());
+  }
+
+  // Missing keys don't produce rows; found rows come back in key order.
+  Slice direct, indirect;
+  ASSERT_OK(rpc.GetInboundSidecar(resp.data().rows_sidecar(), &direct));
+  if (resp.data().has_indirect_data_sidecar()) {
+    ASSERT_OK(rpc.GetInboundSidecar(resp.data().indirect_data_sidecar(), &indirect));
+  }
+  vector<const uint8_t*> rows;
+  ASSERT_OK(ExtractRowsFromRowBlockPB(schema_, resp.data(), indirect, &direct, &rows));
+  ASSERT_EQ(3, rows.size());
+  vector<string> results;
+  for (const uint8_t* row_ptr : rows) {
+    ConstContiguousRow row(&schema_, row_ptr);
+    results.push_back(schema_.DebugRow(row));
+  }
+  EXPECT_EQ(R"((int32 key=5, int32 int_val=10, string string_val="hello 5"))", results[0]);
+  EXPECT_EQ(R"((int32 key=120, int32 int_val=240, string string_val="hello 120"))", results[1]);
+  EXPECT_EQ(R"((int32 key=42, int32 int_val=84, string string_val="hello 42"))", results[2]);
+
+  // A key which can't be decoded against the tablet schema yields an error.
+  rpc.Reset();
+  MultiGetRequestPB bad_req;
+  MultiGetResponsePB bad_resp;
+  bad_req.set_tablet_id(kTabletId);
+  ASSERT_OK(SchemaToColumnPBs(schema_, bad_req.mutable_projected_columns()));
+  bad_req.add_encoded_keys()->assign("x", 1);
+  ASSERT_OK(proxy_->MultiGet(bad_req, &bad_resp, &rpc));
+  ASSERT_TRUE(bad_resp.has_error());
+}
+
 // Test requesting more rows from a scanner which doesn't exist
 TEST_F(TabletServerTest, TestBadScannerID) {
   ScanRequestPB req;
@@ -2126,6 +2466,74 @@ TEST_F(TabletServerTest, TestScan_InvalidScanSeqId) {
   }
 }
 
+// A retried scan call with the same sequence ID as the previous call should
+// be answered from the scanner's retained last response rather than failing
+// with INVALID_SCAN_CALL_SEQ_ID.
+TEST_F(TabletServerTest, TestScan_RetriedCallGetsRetainedResponse) {
+  InsertTestRowsDirect(0, 1000);
+
+  ScanRequestPB req;
+  ScanResponsePB resp;
+  RpcController rpc;
+
+  {
+    // Set up a new scan request with no predicates, all columns.
+    const Schema& projection = schema_;
+    NewScanRequestPB* scan = req.mutable_new_scan_request();
+    scan->set_tablet_id(kTabletId);
+    ASSERT_OK(SchemaToColumnPBs(projection, scan->mutable_projected_columns()));
+    req.set_call_seq_id(0);
+    req.set_batch_size_bytes(0); // so it won't return data right away
+
+    SCOPED_TRACE(SecureDebugString(req));
+    ASSERT_OK(proxy_->Scan(req, &resp, &rpc));
+    ASSERT_FALSE(resp.has_error());
+    ASSERT_TRUE(resp.has_more_results());
+  }
+
+  string scanner_id = resp.scanner_id();
+
+  // Fetch the first batch, keeping it small enough that the scan does not
+  // complete.
+  vector<string> results;
+  {
+    req.Clear();
+    resp.Clear();
+    rpc.Reset();
+    req.set_scanner_id(scanner_id);
+    req.set_call_seq_id(1);
+    req.set_batch_size_bytes(100);
+
+    SCOPED_TRACE(SecureDebugString(req));
+    ASSERT_OK(proxy_->Scan(req, &resp, &rpc));
+    ASSERT_FALSE(resp.has_error());
+    ASSERT_TRUE(resp.has_more_results());
+    NO_FATALS(StringifyRowsFromResponse(schema_, rpc, &resp, &results));
+    ASSERT_GT(results.size(), 0);
+  }
+
+  // Re-send the same call, as a client would after losing the response. The
+  // server should re-send the retained batch rather than erroring out.
+  vector<string> retry_results;
+  {
+    resp.Clear();
+    rpc.Reset();
+
+    SCOPED_TRACE(SecureDebugString(req));
+    ASSERT_OK(proxy_->Scan(req, &resp, &rpc));
+    ASSERT_FALSE(resp.has_error());
+    ASSERT_TRUE(resp.has_more_results());
+    NO_FATALS(StringifyRowsFromResponse(schema_, rpc, &resp, &retry_results));
+    ASSERT_EQ(results, retry_results);
+  }
+
+  // The scan should then proceed normally from where it left off.
+  vector<string> remaining_results;
+  NO_FATALS(DrainScannerToStrings(scanner_id, schema_, &remaining_results,
+                                  proxy_.get(), 2));
+  ASSERT_EQ(1000, results.size() + remaining_results.size());
+}
+
 // Regression test for KUDU-1789: when ScannerKeepAlive is called on a non-existent
 // scanner, it should properly respond with an error.
 TEST_F(TabletServerTest, TestScan_KeepAliveExpiredScanner) {
@@ -33,6 +33,7 @@
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/rpc/service_if.h"
 #include "kudu/tserver/heartbeater.h"
+#include "kudu/tserver/memory_governor.h"
 #include "kudu/tserver/scanners.h"
 #include "kudu/tserver/tablet_copy_service.h"
 #include "kudu/tserver/tablet_service.h"
@@ -55,7 +56,7 @@ TabletServer::TabletServer(const TabletServerOptions& opts)
     fail_heartbeats_for_tests_(false),
     opts_(opts),
     tablet_manager_(new TSTabletManager(this)),
-    scanner_manager_(new ScannerManager(metric_entity())),
+    scanner_manager_(new ScannerManager(metric_entity(), mem_tracker())),
     path_handlers_(new TabletServerPathHandlers(this)),
     maintenance_manager_(new MaintenanceManager(MaintenanceManager::kDefaultOptions)) {
 }
@@ -96,6 +97,7 @@ Status TabletServer::Init() {
   }
 
   heartbeater_.reset(new Heartbeater(opts_, this));
+  memory_governor_.reset(new MemoryGovernor(metric_entity()));
 
   RETURN_NOT_OK_PREPEND(tablet_manager_->Init(),
                         "Could not init Tablet Manager");
@@ -130,6 +132,7 @@ Status TabletServer::Start() {
   RETURN_NOT_OK(KuduServer::Start());
 
   RETURN_NOT_OK(heartbeater_->Start());
+  RETURN_NOT_OK(memory_governor_->Start());
   RETURN_NOT_OK(maintenance_manager_->Init(fs_manager_->uuid()));
 
   google::FlushLogFiles(google::INFO); // Flush the startup messages.
@@ -147,6 +150,7 @@ void TabletServer::Shutdown() {
 
     // 2. Shut down the tserver's subsystems.
     maintenance_manager_->Shutdown();
+    memory_governor_->Shutdown();
     WARN_NOT_OK(heartbeater_->Stop(), "Failed to stop TS Heartbeat thread");
     fs_manager_->UnsetErrorNotificationCb(ErrorHandlerType::DISK);
     tablet_manager_->Shutdown();
@@ -35,6 +35,7 @@ class MaintenanceManager;
 namespace tserver {
 
 class Heartbeater;
+class MemoryGovernor;
 class ScannerManager;
 class TabletServerPathHandlers;
 class TSTabletManager;
@@ -106,6 +107,10 @@ class TabletServer : public kserver::KuduServer {
   // Thread responsible for heartbeating to the master.
   gscoped_ptr<Heartbeater> heartbeater_;
 
+  // Background task which rebalances memory between the block cache and
+  // the memstores. See memory_governor.h.
+  gscoped_ptr<MemoryGovernor> memory_governor_;
+
   // Webserver path handlers
   gscoped_ptr<TabletServerPathHandlers> path_handlers_;
 
@@ -57,9 +57,11 @@
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/map-util.h"
 #include "kudu/gutil/move.h"
+#include "kudu/gutil/once.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/gutil/stringprintf.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/gutil/walltime.h"
 #include "kudu/rpc/rpc_context.h"
 #include "kudu/rpc/rpc_header.pb.h"
 #include "kudu/rpc/rpc_sidecar.h"
@@ -95,6 +97,7 @@
 #include "kudu/util/slice.h"
 #include "kudu/util/status.h"
 #include "kudu/util/status_callback.h"
+#include "kudu/util/threadpool.h"
 #include "kudu/util/trace.h"
 #include "kudu/util/trace_metrics.h"
 #include "kudu/util/website_util.h"
@@ -110,11 +113,41 @@ DEFINE_int32(scanner_max_batch_size_bytes, 8 * 1024 * 1024,
 TAG_FLAG(scanner_max_batch_size_bytes, advanced);
 TAG_FLAG(scanner_max_batch_size_bytes, runtime);
 
+DEFINE_int32(scanner_batch_bytes_target, 0,
+             "If set, the number of rows per scan batch is derived from the "
+             "projection's row width so that a batch's materialized rows "
+             "total roughly this many bytes, instead of using the fixed "
+             "--scanner_batch_size_rows. Sizing batches to fit in the CPU "
+             "cache keeps the working set of the decode, delta-apply and "
+             "predicate stages cache-resident regardless of how wide the "
+             "projection is. Set to 0 to disable.");
+TAG_FLAG(scanner_batch_bytes_target, advanced);
+TAG_FLAG(scanner_batch_bytes_target, experimental);
+TAG_FLAG(scanner_batch_bytes_target, runtime);
+
 DEFINE_int32(scanner_batch_size_rows, 100,
              "The number of rows to batch for servicing scan requests.");
 TAG_FLAG(scanner_batch_size_rows, advanced);
 TAG_FLAG(scanner_batch_size_rows, runtime);
 
+DEFINE_int32(num_scan_executor_threads, 0,
+             "Number of threads in the dedicated pool used to execute scan "
+             "requests. When non-zero, scan batches are produced on this pool "
+             "instead of on the RPC worker threads, so a burst of heavy scans "
+             "cannot starve write requests sharing the RPC service pool. Set "
+             "to 0 to execute scans on the RPC worker threads.");
+TAG_FLAG(num_scan_executor_threads, advanced);
+TAG_FLAG(num_scan_executor_threads, experimental);
+
+DEFINE_int32(scanner_time_slice_ms, 100,
+             "The maximum amount of time (in milliseconds) a scan request may "
+             "spend producing rows before responding with the rows gathered so "
+             "far. The client continues the scan with a new request, so a "
+             "smaller slice makes concurrent scanners take turns more "
+             "frequently at the cost of more RPC round trips.");
+TAG_FLAG(scanner_time_slice_ms, advanced);
+TAG_FLAG(scanner_time_slice_ms, runtime);
+
 DEFINE_bool(scanner_allow_snapshot_scans_with_logical_timestamps, false,
             "If set, the server will support snapshot scans with logical timestamps.");
 TAG_FLAG(scanner_allow_snapshot_scans_with_logical_timestamps, unsafe);
@@ -125,6 +158,27 @@ DEFINE_int32(scanner_max_wait_ms, 1000,
              "longer.");
 TAG_FLAG(scanner_max_wait_ms, advanced);
 
+DEFINE_bool(scanner_leader_lease_check, false,
+            "Whether a leader replica serving a snapshot scan must hold a valid "
+            "leader lease. The leader advances safe time with its own clock, "
+            "without waiting on replication; a replica that still believes itself "
+            "leader after having been deposed could therefore serve a "
+            "non-repeatable read. With this flag enabled such scans fail with "
+            "ServiceUnavailable so that the client retries elsewhere.");
+TAG_FLAG(scanner_leader_lease_check, advanced);
+TAG_FLAG(scanner_leader_lease_check, experimental);
+TAG_FLAG(scanner_leader_lease_check, runtime);
+
+DEFINE_bool(scanner_retain_last_response, true,
+            "Whether each open scanner retains the serialized data of its "
+            "most recent response, so that a retried scan call with the same "
+            "call sequence ID (e.g. because the response was lost by the "
+            "network) can be answered by re-sending the retained data rather "
+            "than failing the scan. Costs up to one batch of memory per open "
+            "scanner.");
+TAG_FLAG(scanner_retain_last_response, advanced);
+TAG_FLAG(scanner_retain_last_response, runtime);
+
 // Fault injection flags.
 DEFINE_int32(scanner_inject_latency_on_each_batch_ms, 0,
              "If set, the scanner will pause the specified number of milliesconds "
@@ -132,6 +186,7 @@ DEFINE_int32(scanner_inject_latency_on_each_batch_ms, 0,
              "Used for tests.");
 TAG_FLAG(scanner_inject_latency_on_each_batch_ms, unsafe);
 
+DECLARE_bool(scan_cycle_accounting);
 DECLARE_int32(memory_limit_warn_threshold_percentage);
 DECLARE_int32(tablet_history_max_age_sec);
 
@@ -189,6 +244,29 @@ namespace tserver {
 
 namespace {
 
+// The pool shared by all Scan() RPCs when --num_scan_executor_threads is
+// non-zero. Created on first use and intentionally never destroyed.
+ThreadPool* g_scan_executor_pool = nullptr;
+GoogleOnceType g_scan_executor_pool_once = GOOGLE_ONCE_INIT;
+
+void CreateScanExecutorPool() {
+  gscoped_ptr<ThreadPool> pool;
+  CHECK_OK(ThreadPoolBuilder("scan-exec")
+           .set_max_threads(FLAGS_num_scan_executor_threads)
+           .Build(&pool));
+  g_scan_executor_pool = pool.release();
+}
+
+// Return the shared scan executor pool, or nullptr if scans should execute
+// on the RPC worker threads.
+ThreadPool* ScanExecutorPool() {
+  if (FLAGS_num_scan_executor_threads <= 0) {
+    return nullptr;
+  }
+  GoogleOnceInit(&g_scan_executor_pool_once, &CreateScanExecutorPool);
+  return g_scan_executor_pool;
+}
+
 // Lookup the given tablet, only ensuring that it exists.
 // If it does not, responds to the RPC associated with 'context' after setting
 // resp->mutable_error() to indicate the failure reason.
@@ -258,6 +336,12 @@ bool LookupRunningTabletReplicaOrRespond(TabletReplicaLookupIf* tablet_manager,
   if (!LookupTabletReplicaOrRespond(tablet_manager, tablet_id, resp, context, replica)) {
     return false;
   }
+  // An RPC arriving for a tablet which hasn't begun bootstrapping yet is a
+  // strong hint that someone is waiting on it; move it to the front of the
+  // startup open queue so it becomes available sooner.
+  if (PREDICT_FALSE((*replica)->state() == tablet::NOT_STARTED)) {
+    tablet_manager->PrioritizeTabletForOpen(tablet_id);
+  }
   if (!CheckTabletReplicaRunningOrRespond(*replica, resp, context)) {
     return false;
   }
@@ -482,13 +566,31 @@ class ScanResultCopier : public ScanResultCollector {
   void HandleRowBlock(const Schema* client_projection_schema,
                               const RowBlock& row_block) override {
     num_rows_returned_ += row_block.selection_vector()->CountSelected();
-    SerializeRowBlock(row_block, rowblock_pb_, client_projection_schema,
-                      rows_data_, indirect_data_, pad_unixtime_micros_to_16_bytes_);
+    int64_t start_cycles = 0;
+    if (PREDICT_FALSE(FLAGS_scan_cycle_accounting)) {
+      start_cycles = CycleClock::Now();
+    }
+    if (columnar_) {
+      SerializeRowBlockColumnar(row_block, client_projection_schema, columnar_batch_.get());
+    } else {
+      SerializeRowBlock(row_block, rowblock_pb_, client_projection_schema,
+                        rows_data_, indirect_data_, pad_unixtime_micros_to_16_bytes_);
+    }
+    if (PREDICT_FALSE(FLAGS_scan_cycle_accounting)) {
+      TRACE_COUNTER_INCREMENT("scan_serialize_cycles", CycleClock::Now() - start_cycles);
+    }
     SetLastRow(row_block, &last_primary_key_);
   }
 
   // Returns number of bytes buffered to return.
   int64_t ResponseSize() const override {
+    if (columnar_) {
+      int64_t size = 0;
+      for (const auto& col : columnar_batch_->columns) {
+        size += col.data.size() + col.varlen_data.size() + col.non_null_bitmap.size();
+      }
+      return size;
+    }
     return rows_data_->size() + indirect_data_->size();
   }
 
@@ -504,8 +606,21 @@ class ScanResultCopier : public ScanResultCollector {
     if (row_format_flags & RowFormatFlags::PAD_UNIX_TIME_MICROS_TO_16_BYTES) {
       pad_unixtime_micros_to_16_bytes_ = true;
     }
+    if (row_format_flags & RowFormatFlags::COLUMNAR_LAYOUT) {
+      columnar_ = true;
+      columnar_batch_ = std::make_shared<ColumnarSerializedBatch>();
+    }
   }
 
+  // Whether the client requested the columnar result layout.
+  bool columnar() const { return columnar_; }
+
+  // The serialized columnar results. Only valid if columnar() is true.
+  //
+  // This is shared so that the response sidecars can keep the buffers
+  // alive after the collector goes out of scope.
+  std::shared_ptr<ColumnarSerializedBatch> columnar_batch() { return columnar_batch_; }
+
  private:
   RowwiseRowBlockPB* const rowblock_pb_;
   faststring* const rows_data_;
@@ -513,6 +628,8 @@ class ScanResultCopier : public ScanResultCollector {
   int64_t num_rows_returned_;
   faststring last_primary_key_;
   bool pad_unixtime_micros_to_16_bytes_;
+  bool columnar_ = false;
+  std::shared_ptr<ColumnarSerializedBatch> columnar_batch_;
 
   DISALLOW_COPY_AND_ASSIGN(ScanResultCopier);
 };
@@ -1257,6 +1374,9 @@ void TabletServiceImpl::ScannerKeepAlive(const ScannerKeepAliveRequestPB *req,
 
 namespace {
 void SetResourceMetrics(ResourceMetricsPB* metrics, rpc::RpcContext* context) {
+  // The call may not carry a trace if it wasn't sampled for tracing
+  // (see --rpc_trace_sample_period).
+  if (!context->trace()) return;
   metrics->set_cfile_cache_miss_bytes(
     context->trace()->metrics()->GetMetric(cfile::CFILE_CACHE_MISS_BYTES_METRIC_NAME));
   metrics->set_cfile_cache_hit_bytes(
@@ -1267,6 +1387,26 @@ void SetResourceMetrics(ResourceMetricsPB* metrics, rpc::RpcContext* context) {
 void TabletServiceImpl::Scan(const ScanRequestPB* req,
                              ScanResponsePB* resp,
                              rpc::RpcContext* context) {
+  // Hand the scan off to the dedicated executor pool if one is configured,
+  // so that long-running scans don't occupy the RPC worker threads which
+  // also serve writes. The RPC is responded to from the pool thread.
+  ThreadPool* pool = ScanExecutorPool();
+  if (pool != nullptr) {
+    Status s = pool->SubmitFunc([this, req, resp, context]() {
+      this->DoScan(req, resp, context);
+    });
+    if (PREDICT_TRUE(s.ok())) {
+      return;
+    }
+    // The pool is shutting down or its queue is full; fall back to
+    // executing the scan in the RPC worker thread.
+  }
+  DoScan(req, resp, context);
+}
+
+void TabletServiceImpl::DoScan(const ScanRequestPB* req,
+                               ScanResponsePB* resp,
+                               rpc::RpcContext* context) {
   TRACE_EVENT0("tserver", "TabletServiceImpl::Scan");
   // Validate the request: user must pass a new_scan_request or
   // a scanner ID, but not both.
@@ -1285,6 +1425,9 @@ void TabletServiceImpl::Scan(const ScanRequestPB* req,
 
   bool has_more_results = false;
   TabletServerErrorPB::Code error_code = TabletServerErrorPB::UNKNOWN_ERROR;
+  // Set for continue requests; used below to retain the serialized response
+  // on the scanner for call-seq-id keyed retries.
+  SharedScanner retry_scanner;
   if (req->has_new_scan_request()) {
     const NewScanRequestPB& scan_pb = req->new_scan_request();
     scoped_refptr<TabletReplica> replica;
@@ -1292,6 +1435,38 @@ void TabletServiceImpl::Scan(const ScanRequestPB* req,
                                              context, &replica)) {
       return;
     }
+    // Consult the scan result cache: a repeat of a recently completed
+    // snapshot scan can be answered without touching the tablet.
+    string result_cache_key;
+    ScanResultCache* result_cache = server_->scanner_manager()->result_cache();
+    if (ScanResultCache::IsCacheableRequest(*req)) {
+      result_cache_key = ScanResultCache::DescriptorKey(*req);
+      std::shared_ptr<ScanResultCache::Entry> cached;
+      if (result_cache->Lookup(result_cache_key, &cached)) {
+        resp->set_has_more_results(false);
+        resp->set_snap_timestamp(cached->snap_timestamp);
+        resp->mutable_data()->set_num_rows(cached->num_rows);
+        int rows_idx;
+        CHECK_OK(context->AddOutboundSidecar(
+            RpcSidecar::FromSliceWithOwner(Slice(cached->rows_data), cached), &rows_idx));
+        resp->mutable_data()->set_rows_sidecar(rows_idx);
+        if (!cached->indirect_data.empty()) {
+          int indirect_idx;
+          CHECK_OK(context->AddOutboundSidecar(
+              RpcSidecar::FromSliceWithOwner(Slice(cached->indirect_data), cached),
+              &indirect_idx));
+          resp->mutable_data()->set_indirect_data_sidecar(indirect_idx);
+        }
+        if (!cached->last_primary_key.empty()) {
+          resp->set_last_primary_key(cached->last_primary_key);
+        }
+        resp->set_propagated_timestamp(server_->clock()->Now().ToUint64());
+        SetResourceMetrics(resp->mutable_resource_metrics(), context);
+        context->RespondSuccess();
+        return;
+      }
+    }
+
     string scanner_id;
     Timestamp scan_timestamp;
     Status s = HandleNewScanRequest(replica.get(), req, context,
@@ -1309,7 +1484,52 @@ void TabletServiceImpl::Scan(const ScanRequestPB* req,
     if (scan_timestamp != Timestamp::kInvalidTimestamp) {
       resp->set_snap_timestamp(scan_timestamp.ToUint64());
     }
+
+    // Cache the result if the scan completed in this response, so that a
+    // repeat of the same descriptor becomes a pure cache hit.
+    if (!result_cache_key.empty() && !has_more_results && !collector.columnar() &&
+        scan_timestamp != Timestamp::kInvalidTimestamp) {
+      auto cached = std::make_shared<ScanResultCache::Entry>();
+      cached->num_rows = data.num_rows();
+      cached->rows_data = rows_data->ToString();
+      cached->indirect_data = indirect_data->ToString();
+      cached->last_primary_key = collector.last_primary_key().ToString();
+      cached->snap_timestamp = scan_timestamp.ToUint64();
+      result_cache->Insert(result_cache_key, std::move(cached));
+    }
   } else if (req->has_scanner_id()) {
+    // A retry of the scanner's previous call (e.g. because its response was
+    // lost by the network) is answered from the retained last response;
+    // re-executing the batch isn't possible since its rows have already
+    // been consumed from the iterator.
+    if (server_->scanner_manager()->LookupScanner(req->scanner_id(), &retry_scanner)) {
+      std::shared_ptr<Scanner::LastResponseData> last =
+          retry_scanner->last_response_for_seq_id(req->call_seq_id());
+      if (PREDICT_FALSE(last != nullptr)) {
+        retry_scanner->UpdateAccessTime();
+        resp->set_has_more_results(last->has_more_results);
+        resp->mutable_data()->set_num_rows(last->num_rows);
+        int rows_idx;
+        CHECK_OK(context->AddOutboundSidecar(
+            RpcSidecar::FromSliceWithOwner(Slice(*last->rows_data), last), &rows_idx));
+        resp->mutable_data()->set_rows_sidecar(rows_idx);
+        if (last->indirect_data->size() > 0) {
+          int indirect_idx;
+          CHECK_OK(context->AddOutboundSidecar(
+              RpcSidecar::FromSliceWithOwner(Slice(*last->indirect_data), last),
+              &indirect_idx));
+          resp->mutable_data()->set_indirect_data_sidecar(indirect_idx);
+        }
+        if (!last->last_primary_key.empty()) {
+          resp->set_last_primary_key(last->last_primary_key);
+        }
+        resp->set_propagated_timestamp(server_->clock()->Now().ToUint64());
+        SetResourceMetrics(resp->mutable_resource_metrics(), context);
+        context->RespondSuccess();
+        return;
+      }
+    }
+
     Status s = HandleContinueScanRequest(req, &collector, &has_more_results, &error_code);
     if (PREDICT_FALSE(!s.ok())) {
       SetupErrorAndRespond(resp->mutable_error(), s, error_code, context);
@@ -1322,20 +1542,69 @@ void TabletServiceImpl::Scan(const ScanRequestPB* req,
   }
   resp->set_has_more_results(has_more_results);
 
-  resp->mutable_data()->CopyFrom(data);
-
-  // Add sidecar data to context and record the returned indices.
-  int rows_idx;
-  CHECK_OK(context->AddOutboundSidecar(
-      RpcSidecar::FromFaststring((std::move(rows_data))), &rows_idx));
-  resp->mutable_data()->set_rows_sidecar(rows_idx);
+  if (collector.columnar()) {
+    // The batch is shared with each sidecar so the buffers stay alive until
+    // the response has been fully sent.
+    std::shared_ptr<ColumnarSerializedBatch> batch = collector.columnar_batch();
+    ColumnarRowBlockPB* columnar_data = resp->mutable_columnar_data();
+    columnar_data->set_num_rows(batch->num_rows);
+    for (const ColumnarSerializedBatch::Column& col : batch->columns) {
+      ColumnarRowBlockPB::Column* col_pb = columnar_data->add_columns();
+      int sidecar_idx;
+      CHECK_OK(context->AddOutboundSidecar(
+          RpcSidecar::FromSliceWithOwner(Slice(col.data), batch), &sidecar_idx));
+      col_pb->set_data_sidecar(sidecar_idx);
+      if (col.is_varlen) {
+        CHECK_OK(context->AddOutboundSidecar(
+            RpcSidecar::FromSliceWithOwner(Slice(col.varlen_data), batch), &sidecar_idx));
+        col_pb->set_varlen_data_sidecar(sidecar_idx);
+      }
+      if (col.is_nullable) {
+        CHECK_OK(context->AddOutboundSidecar(
+            RpcSidecar::FromSliceWithOwner(Slice(col.non_null_bitmap), batch), &sidecar_idx));
+        col_pb->set_non_null_bitmap_sidecar(sidecar_idx);
+      }
+    }
+  } else if (retry_scanner && has_more_results && FLAGS_scanner_retain_last_response) {
+    // Retain the serialized batch on the scanner so a retry of this call can
+    // be answered without re-executing it. The retained data is shared with
+    // the response sidecars, so this adds no extra copy.
+    resp->mutable_data()->CopyFrom(data);
+    auto last = std::make_shared<Scanner::LastResponseData>();
+    last->call_seq_id = req->call_seq_id();
+    last->has_more_results = has_more_results;
+    last->num_rows = data.num_rows();
+    last->last_primary_key = collector.last_primary_key().ToString();
+    last->rows_data = std::move(rows_data);
+    last->indirect_data = std::move(indirect_data);
+
+    int rows_idx;
+    CHECK_OK(context->AddOutboundSidecar(
+        RpcSidecar::FromSliceWithOwner(Slice(*last->rows_data), last), &rows_idx));
+    resp->mutable_data()->set_rows_sidecar(rows_idx);
+    if (last->indirect_data->size() > 0) {
+      int indirect_idx;
+      CHECK_OK(context->AddOutboundSidecar(
+          RpcSidecar::FromSliceWithOwner(Slice(*last->indirect_data), last), &indirect_idx));
+      resp->mutable_data()->set_indirect_data_sidecar(indirect_idx);
+    }
+    retry_scanner->set_last_response(std::move(last));
+  } else {
+    resp->mutable_data()->CopyFrom(data);
 
-  // Add indirect data as a sidecar, if applicable.
-  if (indirect_data->size() > 0) {
-    int indirect_idx;
+    // Add sidecar data to context and record the returned indices.
+    int rows_idx;
     CHECK_OK(context->AddOutboundSidecar(
-        RpcSidecar::FromFaststring(std::move(indirect_data)), &indirect_idx));
-    resp->mutable_data()->set_indirect_data_sidecar(indirect_idx);
+        RpcSidecar::FromFaststring((std::move(rows_data))), &rows_idx));
+    resp->mutable_data()->set_rows_sidecar(rows_idx);
+
+    // Add indirect data as a sidecar, if applicable.
+    if (indirect_data->size() > 0) {
+      int indirect_idx;
+      CHECK_OK(context->AddOutboundSidecar(
+          RpcSidecar::FromFaststring(std::move(indirect_data)), &indirect_idx));
+      resp->mutable_data()->set_indirect_data_sidecar(indirect_idx);
+    }
   }
 
   // Set the last row found by the collector.
@@ -1345,12 +1614,141 @@ void TabletServiceImpl::Scan(const ScanRequestPB* req,
   const faststring& last = collector.last_primary_key();
   if (last.length() > 0) {
     resp->set_last_primary_key(last.ToString());
+
+    // For ordered snapshot scans, additionally return an opaque continuation
+    // token: it encodes everything needed to resume the scan from after this
+    // batch on any replica, even once this scanner has expired.
+    const string& checkpoint_scanner_id =
+        resp->has_scanner_id() ? resp->scanner_id() : req->scanner_id();
+    SharedScanner checkpoint_scanner;
+    if (!checkpoint_scanner_id.empty() &&
+        server_->scanner_manager()->LookupScanner(checkpoint_scanner_id,
+                                                  &checkpoint_scanner) &&
+        checkpoint_scanner->checkpoint_snap_timestamp() != Timestamp::kInvalidTimestamp) {
+      ScanCheckpointPB ckpt;
+      ckpt.set_tablet_id(checkpoint_scanner->tablet_id());
+      ckpt.set_snap_timestamp(checkpoint_scanner->checkpoint_snap_timestamp().ToUint64());
+      ckpt.set_last_primary_key(last.ToString());
+      CHECK(ckpt.SerializeToString(resp->mutable_continuation_token()));
+    }
   }
   resp->set_propagated_timestamp(server_->clock()->Now().ToUint64());
   SetResourceMetrics(resp->mutable_resource_metrics(), context);
   context->RespondSuccess();
 }
 
+void TabletServiceImpl::MultiGet(const MultiGetRequestPB* req,
+                                 MultiGetResponsePB* resp,
+                                 rpc::RpcContext* context) {
+  TRACE_EVENT0("tserver", "TabletServiceImpl::MultiGet");
+  scoped_refptr<TabletReplica> replica;
+  if (!LookupRunningTabletReplicaOrRespond(server_->tablet_manager(), req->tablet_id(),
+                                           resp, context, &replica)) {
+    return;
+  }
+  shared_ptr<Tablet> tablet;
+  TabletServerErrorPB::Code error_code = TabletServerErrorPB::UNKNOWN_ERROR;
+  Status s = GetTabletRef(replica, &tablet, &error_code);
+  if (PREDICT_FALSE(!s.ok())) {
+    SetupErrorAndRespond(resp->mutable_error(), s, error_code, context);
+    return;
+  }
+
+  // Create the user's requested projection.
+  Schema projection;
+  s = ColumnPBsToSchema(req->projected_columns(), &projection);
+  if (PREDICT_FALSE(!s.ok())) {
+    SetupErrorAndRespond(resp->mutable_error(), s, TabletServerErrorPB::INVALID_SCHEMA, context);
+    return;
+  }
+  if (projection.has_column_ids()) {
+    SetupErrorAndRespond(resp->mutable_error(),
+                         Status::InvalidArgument("User requests should not have Column IDs"),
+                         TabletServerErrorPB::INVALID_SCHEMA, context);
+    return;
+  }
+
+  // Take a copy of the schema, since it could change due to an ALTER while
+  // the keys are being decoded.
+  const Schema tablet_schema = replica->tablet_metadata()->schema();
+
+  unique_ptr<faststring> rows_data(new faststring());
+  unique_ptr<faststring> indirect_data(new faststring());
+  RowwiseRowBlockPB* data = resp->mutable_data();
+
+  Arena arena(256);
+  for (const string& encoded_key : req->encoded_keys()) {
+    // Decode the key twice: once for the inclusive lower bound, and once to
+    // increment into the exclusive upper bound, so that the bounds span
+    // exactly one primary key.
+    gscoped_ptr<EncodedKey> start;
+    gscoped_ptr<EncodedKey> stop;
+    s = EncodedKey::DecodeEncodedString(tablet_schema, &arena, encoded_key, &start);
+    if (PREDICT_FALSE(!s.ok())) {
+      SetupErrorAndRespond(resp->mutable_error(),
+                           s.CloneAndPrepend("Invalid encoded key"),
+                           TabletServerErrorPB::UNKNOWN_ERROR, context);
+      return;
+    }
+    s = EncodedKey::DecodeEncodedString(tablet_schema, &arena, encoded_key, &stop);
+    if (s.ok()) {
+      s = EncodedKey::IncrementEncodedKey(tablet_schema, &stop, &arena);
+    }
+    ScanSpec spec;
+    spec.SetLowerBoundKey(start.get());
+    if (s.ok()) {
+      spec.SetExclusiveUpperBoundKey(stop.get());
+    } else {
+      // The key could not be incremented, so it's the maximum possible key
+      // and the scan below can be left unbounded above.
+      stop.reset();
+    }
+
+    gscoped_ptr<RowwiseIterator> iter;
+    s = tablet->NewPointLookupIterator(projection, &iter);
+    if (s.ok()) {
+      s = iter->Init(&spec);
+    }
+    if (PREDICT_FALSE(!s.ok())) {
+      SetupErrorAndRespond(resp->mutable_error(),
+                           s.CloneAndPrepend("Error setting up point lookup"),
+                           TabletServerErrorPB::UNKNOWN_ERROR, context);
+      return;
+    }
+
+    Arena block_arena(1024);
+    RowBlock block(iter->schema(), 4, &block_arena);
+    while (iter->HasNext()) {
+      s = iter->NextBlock(&block);
+      if (PREDICT_FALSE(!s.ok())) {
+        SetupErrorAndRespond(resp->mutable_error(),
+                             s.CloneAndPrepend("Error reading row"),
+                             TabletServerErrorPB::UNKNOWN_ERROR, context);
+        return;
+      }
+      if (block.nrows() > 0) {
+        SerializeRowBlock(block, data, &projection, rows_data.get(), indirect_data.get(),
+                          false /* pad_unixtime_micros_to_16_bytes */);
+      }
+    }
+  }
+
+  // Add the rows as sidecar data, mirroring the non-columnar scan response.
+  int rows_idx;
+  CHECK_OK(context->AddOutboundSidecar(
+      RpcSidecar::FromFaststring((std::move(rows_data))), &rows_idx));
+  data->set_rows_sidecar(rows_idx);
+  if (indirect_data->size() > 0) {
+    int indirect_idx;
+    CHECK_OK(context->AddOutboundSidecar(
+        RpcSidecar::FromFaststring(std::move(indirect_data)), &indirect_idx));
+    data->set_indirect_data_sidecar(indirect_idx);
+  }
+
+  resp->set_propagated_timestamp(server_->clock()->Now().ToUint64());
+  context->RespondSuccess();
+}
+
 void TabletServiceImpl::ListTablets(const ListTabletsRequestPB* req,
                                     ListTabletsResponsePB* resp,
                                     rpc::RpcContext* context) {
@@ -1370,6 +1768,39 @@ void TabletServiceImpl::ListTablets(const ListTabletsRequestPB* req,
   context->RespondSuccess();
 }
 
+void TabletServiceImpl::SplitKeyRange(const SplitKeyRangeRequestPB* req,
+                                      SplitKeyRangeResponsePB* resp,
+                                      rpc::RpcContext* context) {
+  TRACE_EVENT0("tserver", "TabletServiceImpl::SplitKeyRange");
+  scoped_refptr<TabletReplica> replica;
+  if (!LookupRunningTabletReplicaOrRespond(server_->tablet_manager(), req->tablet_id(),
+                                           resp, context, &replica)) {
+    return;
+  }
+  shared_ptr<Tablet> tablet;
+  TabletServerErrorPB::Code error_code = TabletServerErrorPB::UNKNOWN_ERROR;
+  Status s = GetTabletRef(replica, &tablet, &error_code);
+  if (PREDICT_FALSE(!s.ok())) {
+    SetupErrorAndRespond(resp->mutable_error(), s, error_code, context);
+    return;
+  }
+
+  vector<KeyRangePB> ranges;
+  s = tablet->SplitKeyRange(Slice(req->start_primary_key()),
+                            Slice(req->stop_primary_key()),
+                            req->target_chunk_size_bytes(),
+                            &ranges);
+  if (PREDICT_FALSE(!s.ok())) {
+    SetupErrorAndRespond(resp->mutable_error(), s,
+                         TabletServerErrorPB::UNKNOWN_ERROR, context);
+    return;
+  }
+  for (KeyRangePB& range : ranges) {
+    resp->add_ranges()->Swap(&range);
+  }
+  context->RespondSuccess();
+}
+
 void TabletServiceImpl::Checksum(const ChecksumRequestPB* req,
                                  ChecksumResponsePB* resp,
                                  rpc::RpcContext* context) {
@@ -1632,6 +2063,42 @@ Status VerifyNotAncientHistory(Tablet* tablet, ReadMode read_mode, Timestamp tim
   }
   return Status::OK();
 }
+
+// Returns the number of rows to materialize per batch for a scan over
+// 'projection'. With --scanner_batch_bytes_target set, wide projections get
+// fewer rows per batch and narrow ones more, so that the batch's
+// materialized size stays roughly constant; otherwise the fixed
+// --scanner_batch_size_rows is used.
+int BatchSizeRowsForProjection(const Schema& projection) {
+  if (FLAGS_scanner_batch_bytes_target <= 0) {
+    return FLAGS_scanner_batch_size_rows;
+  }
+  int rows = FLAGS_scanner_batch_bytes_target /
+      std::max<size_t>(1, projection.byte_size());
+  // Clamp to keep per-row overheads amortized on the low end and the row
+  // block allocation bounded on the high end.
+  return std::min(65536, std::max(16, rows));
+}
+
+// Decode the continuation token in 'scan_pb' and overlay the checkpoint it
+// carries: the scan becomes an ORDERED READ_AT_SNAPSHOT scan resuming from
+// just after the checkpointed primary key.
+Status ApplyScanContinuationToken(NewScanRequestPB* scan_pb) {
+  ScanCheckpointPB ckpt;
+  if (!ckpt.ParseFromString(scan_pb->continuation_token())) {
+    return Status::InvalidArgument("Invalid scan continuation token");
+  }
+  if (ckpt.tablet_id() != scan_pb->tablet_id()) {
+    return Status::InvalidArgument(
+        Substitute("Scan continuation token is for tablet $0, not tablet $1",
+                   ckpt.tablet_id(), scan_pb->tablet_id()));
+  }
+  scan_pb->set_read_mode(READ_AT_SNAPSHOT);
+  scan_pb->set_snap_timestamp(ckpt.snap_timestamp());
+  scan_pb->set_order_mode(ORDERED);
+  scan_pb->set_last_primary_key(ckpt.last_primary_key());
+  return Status::OK();
+}
 } // anonymous namespace
 
 // Start a new scan.
@@ -1646,12 +2113,33 @@ Status TabletServiceImpl::HandleNewScanRequest(TabletReplica* replica,
   DCHECK(result_collector != nullptr);
   DCHECK(error_code != nullptr);
   DCHECK(req->has_new_scan_request());
-  const NewScanRequestPB& scan_pb = req->new_scan_request();
+
+  // A continuation token turns this into a resumption of a previously
+  // checkpointed scan; overlay the checkpoint on a copy of the request.
+  NewScanRequestPB resumed_scan_pb;
+  const NewScanRequestPB* scan_pb_ptr = &req->new_scan_request();
+  if (PREDICT_FALSE(scan_pb_ptr->has_continuation_token())) {
+    resumed_scan_pb = *scan_pb_ptr;
+    Status s = ApplyScanContinuationToken(&resumed_scan_pb);
+    if (!s.ok()) {
+      *error_code = TabletServerErrorPB::INVALID_SCAN_SPEC;
+      return s;
+    }
+    scan_pb_ptr = &resumed_scan_pb;
+  }
+  const NewScanRequestPB& scan_pb = *scan_pb_ptr;
   TRACE_EVENT1("tserver", "TabletServiceImpl::HandleNewScanRequest",
                "tablet_id", scan_pb.tablet_id());
 
   const Schema& tablet_schema = replica->tablet_metadata()->schema();
 
+  if ((scan_pb.row_format_flags() & RowFormatFlags::COLUMNAR_LAYOUT) &&
+      (scan_pb.row_format_flags() & RowFormatFlags::PAD_UNIX_TIME_MICROS_TO_16_BYTES)) {
+    *error_code = TabletServerErrorPB::INVALID_SCAN_SPEC;
+    return Status::InvalidArgument(
+        "COLUMNAR_LAYOUT and PAD_UNIX_TIME_MICROS_TO_16_BYTES cannot be combined");
+  }
+
   SharedScanner scanner;
   server_->scanner_manager()->NewScanner(replica,
                                          rpc_context->requestor_string(),
@@ -1662,18 +2150,34 @@ Status TabletServiceImpl::HandleNewScanRequest(TabletReplica* replica,
   // the scanner.
   ScopedUnregisterScanner unreg_scanner(server_->scanner_manager(), scanner->id());
 
+  // Consult the compiled projection cache: repeated scans which differ only
+  // in their predicate values compile to the same projection schemas.
+  string projection_key;
+  std::shared_ptr<CompiledProjectionCache::Entry> compiled;
+  if (CompiledProjectionCache::IsCacheableRequest(scan_pb)) {
+    projection_key = CompiledProjectionCache::DescriptorKey(
+        scan_pb, replica->tablet_metadata()->schema_version());
+    server_->scanner_manager()->projection_cache()->Lookup(projection_key, &compiled);
+  }
+
   // Create the user's requested projection.
   // TODO: add test cases for bad projections including 0 columns
   Schema projection;
-  Status s = ColumnPBsToSchema(scan_pb.projected_columns(), &projection);
-  if (PREDICT_FALSE(!s.ok())) {
-    *error_code = TabletServerErrorPB::INVALID_SCHEMA;
-    return s;
-  }
+  Status s;
+  if (compiled) {
+    // Cached entries already passed validation when they were compiled.
+    projection = compiled->client_projection;
+  } else {
+    s = ColumnPBsToSchema(scan_pb.projected_columns(), &projection);
+    if (PREDICT_FALSE(!s.ok())) {
+      *error_code = TabletServerErrorPB::INVALID_SCHEMA;
+      return s;
+    }
 
-  if (projection.has_column_ids()) {
-    *error_code = TabletServerErrorPB::INVALID_SCHEMA;
-    return Status::InvalidArgument("User requests should not have Column IDs");
+    if (projection.has_column_ids()) {
+      *error_code = TabletServerErrorPB::INVALID_SCHEMA;
+      return Status::InvalidArgument("User requests should not have Column IDs");
+    }
   }
 
   if (scan_pb.order_mode() == ORDERED) {
@@ -1685,6 +2189,11 @@ Status TabletServiceImpl::HandleNewScanRequest(TabletReplica* replica,
     }
   }
 
+  if (scan_pb.has_snap_start_timestamp() && scan_pb.read_mode() != READ_AT_SNAPSHOT) {
+    *error_code = TabletServerErrorPB::INVALID_SNAPSHOT;
+    return Status::InvalidArgument("Cannot do a diff scan that is not a snapshot read");
+  }
+
   gscoped_ptr<ScanSpec> spec(new ScanSpec);
 
   // Missing columns will contain the columns that are not mentioned in the client
@@ -1711,17 +2220,32 @@ Status TabletServiceImpl::HandleNewScanRequest(TabletReplica* replica,
   gscoped_ptr<Schema> orig_projection(new Schema(projection));
   scanner->set_client_projection_schema(std::move(orig_projection));
 
-  // Build a new projection with the projection columns and the missing columns. Make
-  // sure to set whether the column is a key column appropriately.
-  SchemaBuilder projection_builder;
-  vector<ColumnSchema> projection_columns = projection.columns();
-  for (const ColumnSchema& col : missing_cols) {
-    projection_columns.push_back(col);
-  }
-  for (const ColumnSchema& col : projection_columns) {
-    CHECK_OK(projection_builder.AddColumn(col, tablet_schema.is_key_column(col.name())));
+  if (compiled) {
+    // Reuse the enhanced projection compiled by a previous scan with the
+    // same descriptor. 'missing_cols' necessarily matches, since it is
+    // derived from the same descriptor and tablet schema version.
+    projection = compiled->scan_projection;
+  } else {
+    // Build a new projection with the projection columns and the missing columns. Make
+    // sure to set whether the column is a key column appropriately.
+    SchemaBuilder projection_builder;
+    vector<ColumnSchema> projection_columns = projection.columns();
+    for (const ColumnSchema& col : missing_cols) {
+      projection_columns.push_back(col);
+    }
+    for (const ColumnSchema& col : projection_columns) {
+      CHECK_OK(projection_builder.AddColumn(col, tablet_schema.is_key_column(col.name())));
+    }
+    if (!projection_key.empty()) {
+      auto entry = std::make_shared<CompiledProjectionCache::Entry>();
+      entry->client_projection = projection;
+      entry->scan_projection = projection_builder.BuildWithoutIds();
+      projection = entry->scan_projection;
+      server_->scanner_manager()->projection_cache()->Insert(projection_key, std::move(entry));
+    } else {
+      projection = projection_builder.BuildWithoutIds();
+    }
   }
-  projection = projection_builder.BuildWithoutIds();
 
   gscoped_ptr<RowwiseIterator> iter;
   // Preset the error code for when creating the iterator on the tablet fails
@@ -1830,6 +2354,9 @@ Status TabletServiceImpl::HandleNewScanRequest(TabletReplica* replica,
   }
 
   scanner->Init(std::move(iter), std::move(orig_spec));
+  if (scan_pb.order_mode() == ORDERED && scan_pb.read_mode() == READ_AT_SNAPSHOT) {
+    scanner->set_checkpoint_snap_timestamp(*snap_timestamp);
+  }
   unreg_scanner.Cancel();
   *scanner_id = scanner->id();
 
@@ -1904,14 +2431,18 @@ Status TabletServiceImpl::HandleContinueScanRequest(const ScanRequestPB* req,
   // TODO(todd): could size the RowBlock based on the user's requested batch size?
   // If people had really large indirect objects, we would currently overshoot
   // their requested batch size by a lot.
-  Arena arena(32 * 1024);
-  RowBlock block(scanner->iter()->schema(),
-                 FLAGS_scanner_batch_size_rows, &arena);
-
-  // TODO(todd): in the future, use the client timeout to set a budget. For now,
-  // just use a half second, which should be plenty to amortize call overhead.
-  int budget_ms = 500;
-  MonoTime deadline = MonoTime::Now() + MonoDelta::FromMilliseconds(budget_ms);
+  //
+  // The block and its arena live on the scanner so that their storage is
+  // reused across the scan's batches rather than reallocated per RPC.
+  RowBlock* block = scanner->PrepareRowBlockForBatch(
+      scanner->iter()->schema(), BatchSizeRowsForProjection(scanner->iter()->schema()));
+
+  // Cap the time spent producing this batch. A scan which fills its batch
+  // size quickly never hits the cap; a CPU-heavy scan (e.g. one whose
+  // predicates reject most rows) yields its executor thread at the end of
+  // the slice and takes its next turn when the client continues the scan.
+  MonoTime deadline = MonoTime::Now() +
+      MonoDelta::FromMilliseconds(FLAGS_scanner_time_slice_ms);
 
   int64_t rows_scanned = 0;
   while (iter->HasNext()) {
@@ -1919,7 +2450,7 @@ Status TabletServiceImpl::HandleContinueScanRequest(const ScanRequestPB* req,
       SleepFor(MonoDelta::FromMilliseconds(FLAGS_scanner_inject_latency_on_each_batch_ms));
     }
 
-    Status s = iter->NextBlock(&block);
+    Status s = iter->NextBlock(block);
     if (PREDICT_FALSE(!s.ok())) {
       LOG(WARNING) << "Copying rows from internal iterator for request "
                    << SecureShortDebugString(*req);
@@ -1927,19 +2458,19 @@ Status TabletServiceImpl::HandleContinueScanRequest(const ScanRequestPB* req,
       return s;
     }
 
-    if (PREDICT_TRUE(block.nrows() > 0)) {
+    if (PREDICT_TRUE(block->nrows() > 0)) {
       // Count the number of rows scanned, regardless of predicates or deletions.
       // The collector will separately count the number of rows actually returned to
       // the client.
-      rows_scanned += block.nrows();
-      result_collector->HandleRowBlock(scanner->client_projection_schema(), block);
+      rows_scanned += block->nrows();
+      result_collector->HandleRowBlock(scanner->client_projection_schema(), *block);
     }
 
     int64_t response_size = result_collector->ResponseSize();
 
     if (VLOG_IS_ON(2)) {
       // This may be fairly expensive if row block size is small
-      TRACE("Copied block (nrows=$0), new size=$1", block.nrows(), response_size);
+      TRACE("Copied block (nrows=$0), new size=$1", block->nrows(), response_size);
     }
 
     // TODO: should check if RPC got cancelled, once we implement RPC cancellation.
@@ -1991,6 +2522,12 @@ Status TabletServiceImpl::HandleContinueScanRequest(const ScanRequestPB* req,
   delta_stats.SubtractStats(scanner->already_reported_stats());
   scanner->set_already_reported_stats(total_stats);
 
+  if (PREDICT_FALSE(FLAGS_scan_cycle_accounting)) {
+    TRACE_COUNTER_INCREMENT("scan_decode_cycles", delta_stats.decode_cycles);
+    TRACE_COUNTER_INCREMENT("scan_delta_apply_cycles", delta_stats.delta_apply_cycles);
+    TRACE_COUNTER_INCREMENT("scan_predicate_cycles", delta_stats.predicate_cycles);
+  }
+
   if (tablet) {
     tablet->metrics()->scanner_rows_scanned->IncrementBy(
         rows_scanned);
@@ -2077,6 +2614,24 @@ Status TabletServiceImpl::HandleScanAtSnapshot(const NewScanRequestPB& scan_pb,
                                         ReadMode::READ_AT_SNAPSHOT,
                                         tmp_snap_timestamp));
 
+  // For a diff scan, validate the start of the snapshot window. If it has
+  // fallen behind the AHM then history needed to tell changed rows from
+  // unchanged ones may already have been GC'ed, so fail the scan rather
+  // than silently return an incomplete diff.
+  Timestamp snap_start_timestamp = Timestamp::kInvalidTimestamp;
+  if (scan_pb.has_snap_start_timestamp()) {
+    snap_start_timestamp.FromUint64(scan_pb.snap_start_timestamp());
+    if (snap_start_timestamp >= tmp_snap_timestamp) {
+      return Status::InvalidArgument(
+          Substitute("Snapshot start time $0 must be before snapshot time $1",
+                     server_->clock()->Stringify(snap_start_timestamp),
+                     server_->clock()->Stringify(tmp_snap_timestamp)));
+    }
+    RETURN_NOT_OK(VerifyNotAncientHistory(replica->tablet(),
+                                          ReadMode::READ_AT_SNAPSHOT,
+                                          snap_start_timestamp));
+  }
+
   tablet::MvccSnapshot snap;
   Tablet* tablet = replica->tablet();
   scoped_refptr<consensus::TimeManager> time_manager = replica->time_manager();
@@ -2094,36 +2649,68 @@ Status TabletServiceImpl::HandleScanAtSnapshot(const NewScanRequestPB& scan_pb,
   bool was_clamped = false;
   MonoTime final_deadline = ClampScanDeadlineForWait(client_deadline, &was_clamped);
 
-  // Wait for the tablet to know that 'snap_timestamp' is safe. I.e. that all operations
-  // that came before it are, at least, started. This, together with waiting for the mvcc
-  // snapshot to be clean below, allows us to always return the same data when scanning at
-  // the same timestamp (repeatable reads).
-  TRACE("Waiting safe time to advance");
-  MonoTime before = MonoTime::Now();
-  Status s = time_manager->WaitUntilSafe(tmp_snap_timestamp, final_deadline);
-
-  if (s.ok()) {
-    // Wait for the in-flights in the snapshot to be finished.
-    TRACE("Waiting for operations to commit");
-    s = mvcc_manager->WaitForSnapshotWithAllCommitted(tmp_snap_timestamp, &snap, client_deadline);
+  // A leader advances safe time with its own clock, without any
+  // communication with the other replicas. That is only sound while a
+  // majority of voters is withholding its vote from other candidates on
+  // this leader's behalf; a deposed leader that hasn't noticed its
+  // deposition yet could otherwise serve a non-repeatable read (see the
+  // note on the TimeManager class). If enabled, require a valid leader
+  // lease before trusting the local safe time.
+  if (PREDICT_FALSE(FLAGS_scanner_leader_lease_check)) {
+    shared_ptr<RaftConsensus> raft_consensus = replica->shared_consensus();
+    if (raft_consensus && raft_consensus->role() == consensus::RaftPeerPB::LEADER &&
+        MonoTime::Now() >= raft_consensus->LeaderLeaseDeadline()) {
+      return Status::ServiceUnavailable("leader replica does not hold a valid leader lease");
+    }
   }
 
-  // If we got an TimeOut but we had clamped the deadline, return a ServiceUnavailable instead
-  // so that the client retries.
-  if (s.IsTimedOut() && was_clamped) {
-    return Status::ServiceUnavailable(s.CloneAndPrepend(
-        "could not wait for desired snapshot timestamp to be consistent").ToString());
-  }
-  RETURN_NOT_OK(s);
+  if (tmp_snap_timestamp < mvcc_manager->GetCleanTimestamp()) {
+    // Fast path: the snapshot timestamp is already below the MVCC clean time
+    // watermark, so every transaction before it has committed and no new
+    // transaction can ever start below it. The snapshot is immutable and the
+    // scan can proceed without waiting on safe time at all. This is the
+    // common case for read-your-writes clients that propagate timestamps:
+    // the timestamp they observed usually comes from an operation this
+    // replica has already applied.
+    snap = tablet::MvccSnapshot(tmp_snap_timestamp);
+    TRACE("Snapshot timestamp already clean; no need to wait");
+  } else {
+    // Wait for the tablet to know that 'snap_timestamp' is safe. I.e. that all operations
+    // that came before it are, at least, started. This, together with waiting for the mvcc
+    // snapshot to be clean below, allows us to always return the same data when scanning at
+    // the same timestamp (repeatable reads).
+    TRACE("Waiting safe time to advance");
+    MonoTime before = MonoTime::Now();
+    Status s = time_manager->WaitUntilSafe(tmp_snap_timestamp, final_deadline);
 
-  uint64_t duration_usec = (MonoTime::Now() - before).ToMicroseconds();
-  tablet->metrics()->snapshot_read_inflight_wait_duration->Increment(duration_usec);
-  TRACE("All operations in snapshot committed. Waited for $0 microseconds", duration_usec);
+    if (s.ok()) {
+      // Wait for the in-flights in the snapshot to be finished.
+      TRACE("Waiting for operations to commit");
+      s = mvcc_manager->WaitForSnapshotWithAllCommitted(tmp_snap_timestamp, &snap, client_deadline);
+    }
+
+    // If we got an TimeOut but we had clamped the deadline, return a ServiceUnavailable instead
+    // so that the client retries.
+    if (s.IsTimedOut() && was_clamped) {
+      return Status::ServiceUnavailable(s.CloneAndPrepend(
+          "could not wait for desired snapshot timestamp to be consistent").ToString());
+    }
+    RETURN_NOT_OK(s);
+
+    uint64_t duration_usec = (MonoTime::Now() - before).ToMicroseconds();
+    tablet->metrics()->snapshot_read_inflight_wait_duration->Increment(duration_usec);
+    TRACE("All operations in snapshot committed. Waited for $0 microseconds", duration_usec);
+  }
 
   if (scan_pb.order_mode() == UNKNOWN_ORDER_MODE) {
     return Status::InvalidArgument("Unknown order mode specified");
   }
-  RETURN_NOT_OK(tablet->NewRowIterator(projection, snap, scan_pb.order_mode(), iter));
+  if (snap_start_timestamp != Timestamp::kInvalidTimestamp) {
+    RETURN_NOT_OK(tablet->NewDiffRowIterator(projection, snap, scan_pb.order_mode(),
+                                             snap_start_timestamp, iter));
+  } else {
+    RETURN_NOT_OK(tablet->NewRowIterator(projection, snap, scan_pb.order_mode(), iter));
+  }
   *snap_timestamp = tmp_snap_timestamp;
   return Status::OK();
 }
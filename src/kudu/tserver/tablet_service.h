@@ -113,6 +113,10 @@ class TabletServiceImpl : public TabletServerServiceIf {
                     ScanResponsePB* resp,
                     rpc::RpcContext* context) OVERRIDE;
 
+  virtual void MultiGet(const MultiGetRequestPB* req,
+                        MultiGetResponsePB* resp,
+                        rpc::RpcContext* context) OVERRIDE;
+
   virtual void ScannerKeepAlive(const ScannerKeepAliveRequestPB *req,
                                 ScannerKeepAliveResponsePB *resp,
                                 rpc::RpcContext *context) OVERRIDE;
@@ -121,6 +125,10 @@ class TabletServiceImpl : public TabletServerServiceIf {
                            ListTabletsResponsePB* resp,
                            rpc::RpcContext* context) OVERRIDE;
 
+  virtual void SplitKeyRange(const SplitKeyRangeRequestPB* req,
+                             SplitKeyRangeResponsePB* resp,
+                             rpc::RpcContext* context) OVERRIDE;
+
   virtual void Checksum(const ChecksumRequestPB* req,
                         ChecksumResponsePB* resp,
                         rpc::RpcContext* context) OVERRIDE;
@@ -130,6 +138,13 @@ class TabletServiceImpl : public TabletServerServiceIf {
   virtual void Shutdown() OVERRIDE;
 
  private:
+  // Body of the Scan() RPC. Runs either on the RPC worker thread or, when
+  // --num_scan_executor_threads is non-zero, on the dedicated scan executor
+  // pool.
+  void DoScan(const ScanRequestPB* req,
+              ScanResponsePB* resp,
+              rpc::RpcContext* context);
+
   Status HandleNewScanRequest(tablet::TabletReplica* tablet_replica,
                               const ScanRequestPB* req,
                               const rpc::RpcContext* rpc_context,
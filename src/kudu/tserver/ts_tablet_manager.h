@@ -18,11 +18,13 @@
 #pragma once
 
 #include <cstdint>
+#include <deque>
 #include <functional>
 #include <map>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include <gtest/gtest_prod.h>
@@ -103,6 +105,14 @@ class TSTabletManager : public tserver::TabletReplicaLookupIf {
   // the first tablet whose bootstrap failed.
   Status WaitForAllBootstrapsToFinish();
 
+  // If the given tablet is still waiting in line to be opened, move it to
+  // the front of the open queue. Called when an incoming RPC (a client
+  // operation or a consensus request from a peer) touches a tablet which
+  // hasn't started bootstrapping yet, so that the tablets which are in
+  // demand become available long before the background pool has drained
+  // the rest. No-op for tablets already opened, opening, or unknown.
+  void PrioritizeTabletForOpen(const std::string& tablet_id) override;
+
   // Shut down all of the tablets, gracefully flushing before shutdown.
   void Shutdown();
 
@@ -267,6 +277,12 @@ class TSTabletManager : public tserver::TabletReplicaLookupIf {
   void OpenTablet(const scoped_refptr<tablet::TabletReplica>& replica,
                   const scoped_refptr<TransitionInProgressDeleter>& deleter);
 
+  // Open the tablet at the front of 'pending_open_replicas_'. Init() submits
+  // one such task to 'open_tablet_pool_' per queued tablet; not binding the
+  // tasks to specific tablets is what allows PrioritizeTabletForOpen() to
+  // reorder the queue while tasks are in flight.
+  void OpenNextTablet();
+
   // Open a tablet whose metadata has already been loaded.
   void BootstrapAndInitTablet(const scoped_refptr<tablet::TabletMetadata>& meta,
                               scoped_refptr<tablet::TabletReplica>* replica);
@@ -361,6 +377,15 @@ class TSTabletManager : public tserver::TabletReplicaLookupIf {
   // Thread pool used to open the tablets async, whether bootstrap is required or not.
   gscoped_ptr<ThreadPool> open_tablet_pool_;
 
+  // Protects 'pending_open_replicas_'.
+  simple_spinlock pending_opens_lock_;
+
+  // Replicas registered at startup which are waiting for their turn on
+  // 'open_tablet_pool_', in the order they will be opened. Pool tasks pop
+  // from the front; PrioritizeTabletForOpen() moves entries to the front.
+  std::deque<std::pair<scoped_refptr<tablet::TabletReplica>,
+                       scoped_refptr<TransitionInProgressDeleter>>> pending_open_replicas_;
+
   FunctionGaugeDetacher metric_detacher_;
 
   DISALLOW_COPY_AND_ASSIGN(TSTabletManager);
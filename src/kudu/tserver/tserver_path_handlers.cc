@@ -585,16 +585,19 @@ string TabletServerPathHandlers::IteratorStatsToHtml(const Schema& projection,
        << "<th>Blocks read from disk</th>"
        << "<th>Bytes read from disk</th>"
        << "<th>Cells read from disk</th>"
+       << "<th>Decode cycles</th>"
+       << "<th>Delta apply cycles</th>"
+       << "<th>Predicate cycles</th>"
        << "</tr>\n";
   for (size_t idx = 0; idx < stats.size(); idx++) {
     // We use 'title' attributes so that if the user hovers over the value, they get a
-    // human-readable tooltip.
+    // human-readable tooltip. The cycle counts are only non-zero when
+    // --scan_cycle_accounting is enabled.
     html << Substitute("<tr>"
                        "<td>$0</td>"
                        "<td title=\"$1\">$2</td>"
                        "<td title=\"$3\">$4</td>"
-                       "<td title=\"$5\">$6</td>"
-                       "</tr>\n",
+                       "<td title=\"$5\">$6</td>",
                        EscapeForHtmlToString(projection.column(idx).name()), // $0
                        HumanReadableInt::ToString(stats[idx].data_blocks_read_from_disk), // $1
                        stats[idx].data_blocks_read_from_disk, // $2
@@ -602,6 +605,16 @@ string TabletServerPathHandlers::IteratorStatsToHtml(const Schema& projection,
                        stats[idx].bytes_read_from_disk, // $4
                        HumanReadableInt::ToString(stats[idx].cells_read_from_disk), // $5
                        stats[idx].cells_read_from_disk); // $6
+    html << Substitute("<td title=\"$0\">$1</td>"
+                       "<td title=\"$2\">$3</td>"
+                       "<td title=\"$4\">$5</td>"
+                       "</tr>\n",
+                       HumanReadableInt::ToString(stats[idx].decode_cycles), // $0
+                       stats[idx].decode_cycles, // $1
+                       HumanReadableInt::ToString(stats[idx].delta_apply_cycles), // $2
+                       stats[idx].delta_apply_cycles, // $3
+                       HumanReadableInt::ToString(stats[idx].predicate_cycles), // $4
+                       stats[idx].predicate_cycles); // $5
   }
   html << "</table>\n";
   return html.str();
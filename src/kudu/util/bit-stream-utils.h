@@ -52,6 +52,11 @@ class BitWriter {
   // bits are ignored.
   void PutValue(uint64_t v, int num_bits);
 
+  // Bit-packs 'count' values in one call. Equivalent to calling PutValue() on
+  // each element of 'values', but uses a BMI2 bulk-packing kernel for groups
+  // of eight values at power-of-2 bit widths <= 8 when the CPU supports it.
+  void PutValues(const uint64_t* values, int count, int num_bits);
+
   // Writes v to the next aligned byte using num_bits. If T is larger than num_bits, the
   // extra high-order bits will be ignored.
   template<typename T>
@@ -100,6 +105,14 @@ class BitReader {
   template<typename T>
   bool GetValue(int num_bits, T* v);
 
+  // Reads 'count' consecutive bit-packed values into 'v'. Equivalent to
+  // calling GetValue() 'count' times, but uses a BMI2 bulk-unpacking kernel
+  // for groups of eight values at power-of-2 bit widths <= 8 when the CPU
+  // supports it. Returns false (reading nothing) if fewer than
+  // 'num_bits * count' bits are left in the stream.
+  template<typename T>
+  bool GetValues(int num_bits, T* v, int count);
+
   // Reads a 'num_bytes'-sized value from the buffer and stores it in 'v'. T needs to be a
   // little-endian native type and big enough to store 'num_bytes'. The value is assumed
   // to be byte-aligned so the stream will be advanced to the start of the next byte
@@ -19,12 +19,57 @@
 
 #include <algorithm>
 
+#if defined(__x86_64__) && !defined(__APPLE__)
+#include <x86intrin.h>
+#endif
+
 #include "glog/logging.h"
 #include "kudu/util/bit-stream-utils.h"
 #include "kudu/util/alignment.h"
 
 namespace kudu {
 
+namespace bit_stream_internal {
+
+#if defined(__x86_64__) && !defined(__APPLE__)
+
+// Whether the runtime CPU supports the BMI2 pdep/pext instructions. Latched
+// in a static so the CPU check runs once per process.
+inline bool CpuHasBmi2() {
+  static const bool has_bmi2 = __builtin_cpu_supports("bmi2");
+  return has_bmi2;
+}
+
+// For a power-of-2 bit width <= 8, the pdep/pext mask which selects the low
+// 'num_bits' bits of each of eight byte lanes.
+inline uint64_t ByteLaneMask(int num_bits) {
+  return 0x0101010101010101ULL * ((1ULL << num_bits) - 1);
+}
+
+// Compress eight byte-lane values (the low 'num_bits' of each byte of
+// 'lanes') into '8 * num_bits' contiguous low-order bits.
+__attribute__((target("bmi2")))
+inline uint64_t PackByteLanes(uint64_t lanes, int num_bits) {
+  return _pext_u64(lanes, ByteLaneMask(num_bits));
+}
+
+// Inverse of PackByteLanes(): spread '8 * num_bits' packed low-order bits of
+// 'packed' so each value occupies its own byte lane.
+__attribute__((target("bmi2")))
+inline uint64_t UnpackByteLanes(uint64_t packed, int num_bits) {
+  return _pdep_u64(packed, ByteLaneMask(num_bits));
+}
+
+#endif // defined(__x86_64__) && !defined(__APPLE__)
+
+// The BMI2 kernels handle groups of eight values whose packed group fits in
+// one 64-bit word with one value per byte lane.
+inline bool BulkPackableBitWidth(int num_bits) {
+  return num_bits == 1 || num_bits == 2 || num_bits == 4 || num_bits == 8;
+}
+
+} // namespace bit_stream_internal
+
 inline void BitWriter::PutValue(uint64_t v, int num_bits) {
   DCHECK_LE(num_bits, 64);
   // Truncate the higher-order bits. This is necessary to
@@ -49,6 +94,26 @@ inline void BitWriter::PutValue(uint64_t v, int num_bits) {
   DCHECK_LT(bit_offset_, 64);
 }
 
+inline void BitWriter::PutValues(const uint64_t* values, int count, int num_bits) {
+  int i = 0;
+#if defined(__x86_64__) && !defined(__APPLE__)
+  if (bit_stream_internal::BulkPackableBitWidth(num_bits) &&
+      count >= 8 &&
+      bit_stream_internal::CpuHasBmi2()) {
+    for (; i + 8 <= count; i += 8) {
+      uint64_t lanes = 0;
+      for (int j = 0; j < 8; ++j) {
+        lanes |= (values[i + j] & 0xff) << (8 * j);
+      }
+      PutValue(bit_stream_internal::PackByteLanes(lanes, num_bits), 8 * num_bits);
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    PutValue(values[i], num_bits);
+  }
+}
+
 inline void BitWriter::Flush(bool align) {
   int num_bytes = BitUtil::Ceil(bit_offset_, 8);
   buffer_->reserve(KUDU_ALIGN_UP(byte_offset_ + num_bytes, 8));
@@ -131,6 +196,41 @@ inline bool BitReader::GetValue(int num_bits, T* v) {
   return true;
 }
 
+template<typename T>
+inline bool BitReader::GetValues(int num_bits, T* v, int count) {
+  DCHECK_LE(num_bits, 64);
+  DCHECK_LE(num_bits, sizeof(T) * 8);
+  DCHECK_GE(count, 0);
+
+  // Check the bounds once up front so the per-group reads below can't fail.
+  if (PREDICT_FALSE(position() + static_cast<int64_t>(num_bits) * count >
+                    static_cast<int64_t>(max_bytes_) * 8)) {
+    return false;
+  }
+
+  int i = 0;
+#if defined(__x86_64__) && !defined(__APPLE__)
+  if (bit_stream_internal::BulkPackableBitWidth(num_bits) &&
+      count >= 8 &&
+      bit_stream_internal::CpuHasBmi2()) {
+    for (; i + 8 <= count; i += 8) {
+      uint64_t packed = 0;
+      bool result = GetValue(8 * num_bits, &packed);
+      DCHECK(result);
+      uint64_t lanes = bit_stream_internal::UnpackByteLanes(packed, num_bits);
+      for (int j = 0; j < 8; ++j) {
+        v[i + j] = static_cast<T>((lanes >> (8 * j)) & 0xff);
+      }
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    bool result = GetValue(num_bits, &v[i]);
+    DCHECK(result);
+  }
+  return true;
+}
+
 inline void BitReader::Rewind(int num_bits) {
   bit_offset_ -= num_bits;
   if (bit_offset_ >= 0) {
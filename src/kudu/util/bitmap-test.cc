@@ -15,6 +15,7 @@
 // specific language governing permissions and limitations
 // under the License.
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 #include <vector>
@@ -155,6 +156,38 @@ TEST(TestBitMap, TestBulkSetAndTestBits) {
   }
 }
 
+TEST(TestBitMap, TestCopyRange) {
+  uint8_t src[16];
+  size_t total_size = sizeof(src) * 8;
+
+  // Fill the source with a pattern that doesn't repeat at byte granularity.
+  for (size_t i = 0; i < total_size; ++i) {
+    BitmapChange(src, i, i & 3);
+  }
+
+  uint8_t dst[16];
+  for (size_t src_offset = 0; src_offset < 24; ++src_offset) {
+    for (size_t dst_offset = 0; dst_offset < 24; ++dst_offset) {
+      size_t max_bits = total_size - std::max(src_offset, dst_offset);
+      for (size_t num_bits = 1; num_bits <= max_bits; ++num_bits) {
+        // 0xaa sets the odd bits, so untouched destination bits are
+        // easy to recognize.
+        memset(dst, 0xaa, sizeof(dst));
+        BitmapCopyRange(dst, dst_offset, src, src_offset, num_bits);
+
+        for (size_t i = 0; i < total_size; ++i) {
+          if (i >= dst_offset && i < dst_offset + num_bits) {
+            ASSERT_EQ(BitmapTest(src, src_offset + (i - dst_offset)),
+                      BitmapTest(dst, i));
+          } else {
+            ASSERT_EQ(!!(i & 1), BitmapTest(dst, i));
+          }
+        }
+      }
+    }
+  }
+}
+
 TEST(TestBitMap, TestFindBit) {
   uint8_t bm[16];
 
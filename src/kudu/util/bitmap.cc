@@ -22,6 +22,8 @@
 
 #include <glog/logging.h>
 
+#include "kudu/gutil/bits.h"
+#include "kudu/gutil/port.h"
 #include "kudu/gutil/stringprintf.h"
 
 namespace kudu {
@@ -64,6 +66,66 @@ void BitmapChangeBits(uint8_t *bitmap, size_t offset, size_t num_bits, bool valu
   }
 }
 
+void BitmapCopyRange(uint8_t *dst, size_t dst_offset,
+                     const uint8_t *src, size_t src_offset,
+                     size_t num_bits) {
+  DCHECK_GT(num_bits, 0);
+  DCHECK(src + BitmapSize(src_offset + num_bits) <= dst + (dst_offset >> 3) ||
+         dst + BitmapSize(dst_offset + num_bits) <= src + (src_offset >> 3))
+      << "source and destination ranges must not overlap";
+
+  // Copy bit by bit until the destination is byte-aligned. From there the
+  // copy can proceed a word at a time.
+  while ((dst_offset & 7) != 0 && num_bits > 0) {
+    BitmapChange(dst, dst_offset++, BitmapTest(src, src_offset++));
+    num_bits--;
+  }
+  if (num_bits == 0) {
+    return;
+  }
+
+  uint8_t *d = dst + (dst_offset >> 3);
+  const uint8_t *s = src + (src_offset >> 3);
+  const int shift = src_offset & 7;
+
+  // With the destination byte-aligned, each full word of output is built
+  // from a word of input plus (if the source is misaligned) the low bits
+  // of one extra byte. The extra byte holds the last bits of the output
+  // word and is therefore always within the source bitmap. (As in
+  // BitmapFindFirst, the LSB-first bitmap layout matches the bit order of
+  // a little-endian load, so shifting words shifts bit indexes.)
+  while (num_bits >= 64) {
+    uint64_t word = UNALIGNED_LOAD64(s);
+    if (shift != 0) {
+      word = (word >> shift) | (static_cast<uint64_t>(s[8]) << (64 - shift));
+    }
+    UNALIGNED_STORE64(d, word);
+    s += 8;
+    d += 8;
+    num_bits -= 64;
+  }
+
+  // Same thing, a byte at a time.
+  while (num_bits >= 8) {
+    uint8_t b = *s >> shift;
+    if (shift != 0) {
+      b |= s[1] << (8 - shift);
+    }
+    *d = b;
+    s++;
+    d++;
+    num_bits -= 8;
+  }
+
+  // Copy the remaining partial byte bit by bit.
+  dst_offset = (d - dst) << 3;
+  src_offset = ((s - src) << 3) + shift;
+  while (num_bits > 0) {
+    BitmapChange(dst, dst_offset++, BitmapTest(src, src_offset++));
+    num_bits--;
+  }
+}
+
 bool BitmapFindFirst(const uint8_t *bitmap, size_t offset, size_t bitmap_size,
                      bool value, size_t *idx) {
   const uint64_t pattern64[2] = { 0xffffffffffffffff, 0x0000000000000000 };
@@ -90,27 +152,41 @@ bool BitmapFindFirst(const uint8_t *bitmap, size_t offset, size_t bitmap_size,
     p++;
   }
 
-  // check 64bit at the time for a 'value' bit
+  // Check 64 bits at a time for a 'value' bit. XORing with the complement
+  // pattern leaves exactly the 'value' bits set, so a bit-scan instruction
+  // locates the match directly instead of a bit-at-a-time walk. (The bitmap
+  // is laid out LSB-first within each byte, which matches the bit order of
+  // a little-endian 64-bit load.)
   const uint64_t *u64 = (const uint64_t *)p;
-  while (num_bits >= 64 && *u64 == pattern64[value]) {
+  while (num_bits >= 64) {
+    uint64_t candidates = *u64 ^ pattern64[value];
+    if (candidates != 0) {
+      *idx = (((const uint8_t *)u64 - bitmap) << 3) + Bits::FindLSBSetNonZero64(candidates);
+      return true;
+    }
     num_bits -= 64;
     u64++;
   }
 
-  // check 8bit at the time for a 'value' bit
+  // Check the trailing bytes the same way. A candidate bit at or past the
+  // end of the bitmap means no in-range match can follow, since the scan
+  // always yields the lowest-order candidate.
   p = (const uint8_t *)u64;
-  while (num_bits >= 8 && *p == pattern8[value]) {
-    num_bits -= 8;
-    p++;
-  }
-
-  // Find a 'value' bit at the beginning of the last byte
-  for (bit = 0; num_bits > 0; ++bit) {
-    if (BitmapTest(p, bit) == value) {
+  while (num_bits > 0) {
+    uint8_t candidates = *p ^ pattern8[value];
+    if (candidates != 0) {
+      bit = Bits::FindLSBSetNonZero(candidates);
+      if (bit >= num_bits) {
+        return false;
+      }
       *idx = ((p - bitmap) << 3) + bit;
       return true;
     }
-    num_bits--;
+    if (num_bits < 8) {
+      break;
+    }
+    num_bits -= 8;
+    p++;
   }
 
   return false;
@@ -68,6 +68,15 @@ inline void BitmapMergeOr(uint8_t *dst, const uint8_t *src, size_t n_bits) {
 // Set bits from offset to (offset + num_bits) to the specified value
 void BitmapChangeBits(uint8_t *bitmap, size_t offset, size_t num_bits, bool value);
 
+// Copy 'num_bits' bits from 'src' (starting at 'src_offset') into 'dst'
+// (starting at 'dst_offset'). The ranges must not overlap.
+//
+// The copy proceeds a word at a time wherever possible; only partial bytes
+// at the edges of the destination range are handled bit by bit.
+void BitmapCopyRange(uint8_t *dst, size_t dst_offset,
+                     const uint8_t *src, size_t src_offset,
+                     size_t num_bits);
+
 // Find the first bit of the specified value, starting from the specified offset.
 bool BitmapFindFirst(const uint8_t *bitmap, size_t offset, size_t bitmap_size,
                      bool value, size_t *idx);
@@ -178,6 +178,14 @@ class BloomFilter {
   // Return true if the filter may contain the given key.
   bool MayContainKey(const BloomKeyProbe &probe) const;
 
+  // Return the number of hashes that are calculated for each probed key.
+  size_t n_hashes() const { return n_hashes_; }
+
+  // Return a slice view into the underlying byte array.
+  Slice slice() const {
+    return Slice(bitmap_, n_bits_ / 8);
+  }
+
  private:
   friend class BloomFilterBuilder;
   static uint32_t PickBit(uint32_t hash, size_t n_bits);
@@ -25,6 +25,13 @@
 #include "kudu/util/slice.h"
 #include "kudu/util/test_macros.h"
 #include "kudu/util/test_util.h"
+#include "kudu/util/twotier_cache.h"
+
+DECLARE_bool(cache_force_single_shard);
+
+METRIC_DECLARE_counter(block_cache_slow_tier_hits);
+METRIC_DECLARE_counter(block_cache_promotions);
+METRIC_DECLARE_counter(block_cache_demotions);
 
 #if defined(__linux__)
 DECLARE_string(nvm_cache_path);
@@ -102,6 +109,17 @@ class CacheTest : public KuduTest,
     cache_->Release(cache_->Insert(handle, this));
   }
 
+  // Like Insert(), but charges the entry to the given eviction partition.
+  void InsertIntoPartition(int partition_id, int key, int value, int charge = 1) {
+    std::string key_str = EncodeInt(key);
+    std::string val_str = EncodeInt(value);
+    Cache::PendingHandle* handle = CHECK_NOTNULL(cache_->Allocate(key_str, val_str.size(), charge));
+    memcpy(cache_->MutableValue(handle), val_str.data(), val_str.size());
+    cache_->SetPartition(handle, partition_id);
+
+    cache_->Release(cache_->Insert(handle, this));
+  }
+
   void Erase(int key) {
     cache_->Erase(EncodeInt(key));
   }
@@ -123,6 +141,127 @@ TEST_P(CacheTest, TrackMemory) {
   }
 }
 
+TEST_P(CacheTest, FrequencyBasedAdmission) {
+  if (GetParam() != DRAM_CACHE) {
+    LOG(INFO) << "Skipping test, admission control is only supported by "
+              << "the DRAM cache";
+    return;
+  }
+
+  // Use a single shard so that capacity accounting is deterministic.
+  FLAGS_cache_force_single_shard = true;
+  cache_.reset(NewLRUCache(DRAM_CACHE, kCacheSize, "cache_test_admission"));
+  cache_->SetFrequencyBasedAdmission(true);
+
+  // Build a working set which fills the cache, and access it several times
+  // so that its entries accumulate frequency in the sketch.
+  const int kWorkingSetSize = 10;
+  const int kCharge = kCacheSize / kWorkingSetSize;
+  for (int i = 0; i < kWorkingSetSize; i++) {
+    Insert(i, i, kCharge);
+  }
+  for (int pass = 0; pass < 4; pass++) {
+    for (int i = 0; i < kWorkingSetSize; i++) {
+      ASSERT_EQ(i, Lookup(i));
+    }
+  }
+
+  // Simulate a large scan: each entry is inserted once and never accessed
+  // again.
+  for (int i = 1000; i < 1200; i++) {
+    Insert(i, i, kCharge);
+  }
+
+  // The scan must not have flushed the hot working set.
+  for (int i = 0; i < kWorkingSetSize; i++) {
+    ASSERT_EQ(i, Lookup(i));
+  }
+}
+
+TEST_P(CacheTest, UpdateCapacity) {
+  if (GetParam() != DRAM_CACHE) {
+    LOG(INFO) << "Skipping test, capacity adjustment is only supported by "
+              << "the DRAM cache";
+    return;
+  }
+
+  // Use a single shard so that capacity accounting is deterministic.
+  FLAGS_cache_force_single_shard = true;
+  cache_.reset(NewLRUCache(DRAM_CACHE, kCacheSize, "cache_test_capacity"));
+
+  // Fill the cache to capacity.
+  const int kNumElems = 10;
+  const int kCharge = kCacheSize / kNumElems;
+  for (int i = 0; i < kNumElems; i++) {
+    Insert(i, i, kCharge);
+  }
+  for (int i = 0; i < kNumElems; i++) {
+    ASSERT_EQ(i, Lookup(i));
+  }
+
+  // Shrinking the capacity must synchronously evict entries until usage
+  // fits again.
+  cache_->UpdateCapacity(kCacheSize / 2);
+  int remaining = 0;
+  for (int i = 0; i < kNumElems; i++) {
+    if (Lookup(i) == i) remaining++;
+  }
+  ASSERT_LE(remaining, kNumElems / 2);
+  ASSERT_GE(evicted_keys_.size(), kNumElems / 2);
+
+  // After growing the capacity back, the cache must be able to hold a full
+  // working set again: between the surviving old entries and the new ones,
+  // a full capacity's worth of entries should be resident.
+  cache_->UpdateCapacity(kCacheSize);
+  for (int i = 100; i < 100 + kNumElems; i++) {
+    Insert(i, i, kCharge);
+  }
+  int resident = 0;
+  for (int i = 0; i < kNumElems; i++) {
+    if (Lookup(i) == i) resident++;
+  }
+  for (int i = 100; i < 100 + kNumElems; i++) {
+    if (Lookup(i) == i) resident++;
+  }
+  ASSERT_GE(resident, kNumElems - 1);
+}
+
+TEST_P(CacheTest, PartitionedEviction) {
+  if (GetParam() != DRAM_CACHE) {
+    LOG(INFO) << "Skipping test, partitioning is only supported by "
+              << "the DRAM cache";
+    return;
+  }
+
+  // Use a single shard so that capacity accounting is deterministic.
+  FLAGS_cache_force_single_shard = true;
+  cache_.reset(NewLRUCache(DRAM_CACHE, kCacheSize, "cache_test_partitions"));
+
+  // Register a partition with the same weight as the default partition, so
+  // that each is entitled to half of the capacity.
+  const int partition = cache_->RegisterPartition(1);
+  ASSERT_NE(0, partition);
+
+  // Insert one default-partition entry and then fill the rest of the cache
+  // with entries from the new partition, leaving the default partition far
+  // below its target and the new partition over it.
+  const int kNumElems = 10;
+  const int kCharge = kCacheSize / kNumElems;
+  Insert(0, 0, kCharge);
+  for (int i = 1; i < kNumElems; i++) {
+    InsertIntoPartition(partition, i, i, kCharge);
+  }
+
+  // Inserting one more entry forces an eviction. Although the default
+  // partition's entry is the coldest, eviction must instead pick the oldest
+  // entry of the over-target partition.
+  InsertIntoPartition(partition, kNumElems, kNumElems, kCharge);
+  ASSERT_EQ(0, Lookup(0));
+  ASSERT_EQ(-1, Lookup(1));
+  ASSERT_EQ(1, evicted_keys_.size());
+  ASSERT_EQ(1, evicted_keys_[0]);
+}
+
 TEST_P(CacheTest, HitAndMiss) {
   ASSERT_EQ(-1, Lookup(100));
 
@@ -237,4 +376,90 @@ TEST_P(CacheTest, HeavyEntries) {
   ASSERT_LE(cached_weight, kCacheSize + kCacheSize/10);
 }
 
+// Tests for the two-tier cache wrapper. The test composes two DRAM caches
+// so that demotion and promotion can be exercised deterministically without
+// persistent memory hardware.
+class TwoTierCacheTest : public KuduTest,
+                         public Cache::EvictionCallback {
+ public:
+  // Implementation of the EvictionCallback interface. Invoked when an entry
+  // falls out of the fast tier.
+  void EvictedEntry(Slice key, Slice val) override {
+    evicted_keys_.push_back(DecodeInt(key));
+  }
+  std::vector<int> evicted_keys_;
+  gscoped_ptr<Cache> cache_;
+  MetricRegistry metric_registry_;
+  scoped_refptr<MetricEntity> entity_;
+
+  static const int kFastCacheSize = 4 * 1024;
+  static const int kSlowCacheSize = 64 * 1024;
+
+  virtual void SetUp() OVERRIDE {
+    // Use a single shard so that fast-tier capacity accounting is
+    // deterministic.
+    FLAGS_cache_force_single_shard = true;
+    cache_.reset(NewTwoTierCache(
+        NewLRUCache(DRAM_CACHE, kFastCacheSize, "twotier_test_fast"),
+        NewLRUCache(DRAM_CACHE, kSlowCacheSize, "twotier_test_slow"),
+        "twotier_test"));
+    entity_ = METRIC_ENTITY_server.Instantiate(&metric_registry_, "twotier_test");
+    cache_->SetMetrics(entity_);
+  }
+
+  int Lookup(int key) {
+    Cache::Handle* handle = cache_->Lookup(EncodeInt(key), Cache::EXPECT_IN_CACHE);
+    const int r = (handle == nullptr) ? -1 : DecodeInt(cache_->Value(handle));
+    if (handle != nullptr) {
+      cache_->Release(handle);
+    }
+    return r;
+  }
+
+  void Insert(int key, int value, int charge = 1) {
+    std::string key_str = EncodeInt(key);
+    std::string val_str = EncodeInt(value);
+    Cache::PendingHandle* handle = CHECK_NOTNULL(cache_->Allocate(key_str, val_str.size(), charge));
+    memcpy(cache_->MutableValue(handle), val_str.data(), val_str.size());
+
+    cache_->Release(cache_->Insert(handle, this));
+  }
+};
+
+TEST_F(TwoTierCacheTest, TestDemotionAndPromotion) {
+  scoped_refptr<Counter> slow_tier_hits =
+      METRIC_block_cache_slow_tier_hits.Instantiate(entity_);
+  scoped_refptr<Counter> promotions = METRIC_block_cache_promotions.Instantiate(entity_);
+  scoped_refptr<Counter> demotions = METRIC_block_cache_demotions.Instantiate(entity_);
+
+  // Fill the fast tier and then keep inserting, so earlier entries are
+  // evicted from it.
+  const int kNumElems = 8;
+  const int kSizePerElem = kFastCacheSize / (kNumElems / 2);
+  for (int i = 0; i < kNumElems; i++) {
+    Insert(i, 1000 + i, kSizePerElem);
+  }
+  ASSERT_FALSE(evicted_keys_.empty());
+
+  // The evicted entries are demoted to the slow tier in the background; once
+  // there, looking one up promotes it back into the fast tier.
+  const int evicted_key = evicted_keys_[0];
+  ASSERT_EVENTUALLY([&]() {
+    ASSERT_EQ(1000 + evicted_key, Lookup(evicted_key));
+  });
+  ASSERT_GE(demotions->value(), 1);
+  ASSERT_GE(slow_tier_hits->value(), 1);
+  ASSERT_GE(promotions->value(), 1);
+
+  // The promoted entry is now served from the fast tier.
+  ASSERT_EQ(1000 + evicted_key, Lookup(evicted_key));
+}
+
+TEST_F(TwoTierCacheTest, TestErase) {
+  Insert(100, 101);
+  ASSERT_EQ(101, Lookup(100));
+  cache_->Erase(EncodeInt(100));
+  ASSERT_EQ(-1, Lookup(100));
+}
+
 }  // namespace kudu
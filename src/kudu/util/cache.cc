@@ -2,6 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 #include <memory>
@@ -55,7 +56,7 @@ Cache::~Cache() {
 
 namespace {
 
-typedef simple_spinlock MutexType;
+typedef rw_spinlock MutexType;
 
 // LRU cache implementation
 
@@ -70,7 +71,15 @@ struct LRUHandle {
   uint32_t key_length;
   uint32_t val_length;
   Atomic32 refs;
+  // Set on lookup instead of moving the entry to the head of the LRU list,
+  // so that lookups don't need the shard's exclusive lock. The eviction path
+  // gives flagged entries a second chance, moving them back to the hot end
+  // of the list and clearing the flag.
+  Atomic32 recently_used;
   uint32_t hash;      // Hash of key(); used for fast sharding and comparisons
+  // Id of the eviction partition this entry is charged to. See
+  // Cache::RegisterPartition().
+  int32_t partition;
 
   // The storage for the key/value pair itself. The data is stored as:
   //   [key bytes ...] [padding up to 8-byte boundary] [value bytes ...]
@@ -180,6 +189,97 @@ class HandleTable {
   }
 };
 
+// Approximate frequency sketch used for admission control, in the style of
+// TinyLFU. Each key maps to a set of small saturating counters which are
+// incremented on every lookup. Counters are periodically halved so that the
+// sketch tracks recent popularity rather than all-time popularity.
+//
+// Increment() and Estimate() may be called concurrently (they are called
+// with the shard lock held in shared mode); Age() requires exclusive access.
+class FrequencySketch {
+ public:
+  explicit FrequencySketch(size_t capacity) {
+    // Size the sketch based on a rough guess of the entry count, assuming
+    // small-blocks of a few KB each. Over-sizing only costs memory (4 bytes
+    // per counter); under-sizing increases the collision-induced
+    // overestimation of frequencies, which errs on the side of admitting.
+    size_t num_counters = kMinCounters;
+    while (num_counters < capacity / 4096 && num_counters < kMaxCounters) {
+      num_counters <<= 1;
+    }
+    counters_.resize(num_counters, 0);
+    index_shift_ = 32 - Bits::Log2Floor(num_counters);
+    accesses_ = 0;
+  }
+
+  // Record an access of the key with the given hash.
+  void Increment(uint32_t hash) {
+    for (int i = 0; i < kNumHashes; i++) {
+      Atomic32* counter = &counters_[CounterIndex(hash, i)];
+      // The saturation check is racy, so a counter may slightly exceed
+      // kMaxFrequency under concurrent increments. That's harmless: the
+      // counter is still bounded and the estimate remains approximate.
+      if (base::subtle::NoBarrier_Load(counter) < kMaxFrequency) {
+        base::subtle::NoBarrier_AtomicIncrement(counter, 1);
+      }
+    }
+    base::subtle::NoBarrier_AtomicIncrement(&accesses_, 1);
+  }
+
+  // Return the estimated access frequency of the key with the given hash.
+  uint32_t Estimate(uint32_t hash) const {
+    Atomic32 min = kMaxFrequency;
+    for (int i = 0; i < kNumHashes; i++) {
+      min = std::min(min, base::subtle::NoBarrier_Load(
+          &counters_[CounterIndex(hash, i)]));
+    }
+    return min;
+  }
+
+  // If enough accesses have accumulated since the last aging cycle, halve
+  // all counters so that previously-hot keys which are no longer accessed
+  // decay. Must be called with exclusive access to the sketch.
+  void MaybeAge() {
+    if (PREDICT_TRUE(accesses_ < counters_.size() * kAgingMultiplier)) {
+      return;
+    }
+    for (Atomic32& counter : counters_) {
+      counter >>= 1;
+    }
+    accesses_ = 0;
+  }
+
+ private:
+  enum {
+    kNumHashes = 4,
+    kMaxFrequency = 15,
+    kMinCounters = 1 << 10,
+    kMaxCounters = 1 << 26,
+    // Age the counters after this many accesses per counter.
+    kAgingMultiplier = 8
+  };
+
+  size_t CounterIndex(uint32_t hash, int i) const {
+    // Derive kNumHashes independent indexes from the single 32-bit key hash
+    // by remixing it with different odd constants.
+    static const uint32_t kSeeds[kNumHashes] =
+        { 0x85ebca6b, 0xc2b2ae35, 0x27d4eb2f, 0x165667b1 };
+    return (hash * kSeeds[i]) >> index_shift_;
+  }
+
+  std::vector<Atomic32> counters_;
+  int index_shift_;
+  Atomic32 accesses_;
+
+  DISALLOW_COPY_AND_ASSIGN(FrequencySketch);
+};
+
+// The maximum number of entries inspected from the cold end of the LRU list
+// when looking for an eviction victim belonging to a partition which is over
+// its share target. Bounding the probe depth keeps eviction O(1) and makes
+// partition targets a soft preference rather than a hard guarantee.
+const int kEvictionProbeDepth = 8;
+
 // A single shard of sharded cache.
 class LRUCache {
  public:
@@ -187,10 +287,32 @@ class LRUCache {
   ~LRUCache();
 
   // Separate from constructor so caller can easily make an array of LRUCache
-  void SetCapacity(size_t capacity) { capacity_ = capacity; }
+  void SetCapacity(size_t capacity) {
+    capacity_ = capacity;
+    RecomputePartitionTargets();
+  }
+
+  // Thread-safe capacity adjustment: takes the shard lock and, if the new
+  // capacity is smaller than the current usage, evicts entries to fit.
+  void UpdateCapacity(size_t capacity);
 
   void SetMetrics(CacheMetrics* metrics) { metrics_ = metrics; }
 
+  // Enable or disable frequency-based admission control. Must be called
+  // before the shard is accessed concurrently.
+  void SetFrequencyBasedAdmission(bool enabled) {
+    if (enabled) {
+      freq_sketch_.reset(new FrequencySketch(capacity_));
+    } else {
+      freq_sketch_.reset();
+    }
+  }
+
+  // Register a new eviction partition with the given weight and return its
+  // id. Must be called with the same sequence of weights on every shard so
+  // that partition ids agree across shards. See Cache::RegisterPartition().
+  int AddPartition(int weight);
+
   Cache::Handle* Insert(LRUHandle* handle, Cache::EvictionCallback* eviction_callback);
   // Like Cache::Lookup, but with an extra "hash" parameter.
   Cache::Handle* Lookup(const Slice& key, uint32_t hash, bool caching);
@@ -200,6 +322,11 @@ class LRUCache {
  private:
   void LRU_Remove(LRUHandle* e);
   void LRU_Append(LRUHandle* e);
+  // Recompute 'partition_target_' from the current capacity and weights.
+  void RecomputePartitionTargets();
+  // Choose the entry to evict, starting from 'coldest' (the cold end of
+  // the LRU list).
+  LRUHandle* PickEvictionVictim(LRUHandle* coldest);
   // Just reduce the reference count by 1.
   // Return true if last reference
   bool Unref(LRUHandle* e);
@@ -209,16 +336,34 @@ class LRUCache {
   // Initialized before use.
   size_t capacity_;
 
-  // mutex_ protects the following state.
+  // mutex_ protects the following state. Lookups take it in shared mode:
+  // instead of reordering the LRU list, they mark the entry as recently used,
+  // and the eviction path in Insert() approximates LRU by giving such entries
+  // a second chance. Only mutations of the table and list (insert, erase,
+  // eviction) take it exclusively, so lookups don't contend with each other.
   MutexType mutex_;
   size_t usage_;
 
+  // Per-partition accounting for weighted eviction. 'partition_usage_'
+  // tracks the bytes charged to each partition by entries resident in this
+  // shard, and 'partition_target_' is each partition's soft share of
+  // 'capacity_', proportional to 'partition_weights_'. All three vectors
+  // have one element per registered partition, including the default
+  // partition 0, and only grow via AddPartition().
+  std::vector<size_t> partition_usage_;
+  std::vector<size_t> partition_target_;
+  std::vector<int> partition_weights_;
+
   // Dummy head of LRU list.
   // lru.prev is newest entry, lru.next is oldest entry.
   LRUHandle lru_;
 
   HandleTable table_;
 
+  // If non-NULL, tracks approximate access frequencies and gates admission
+  // of new entries on them. See Cache::SetFrequencyBasedAdmission().
+  gscoped_ptr<FrequencySketch> freq_sketch_;
+
   MemTracker* mem_tracker_;
 
   CacheMetrics* metrics_;
@@ -226,6 +371,9 @@ class LRUCache {
 
 LRUCache::LRUCache(MemTracker* tracker)
  : usage_(0),
+   partition_usage_(1, 0),
+   partition_target_(1, 0),
+   partition_weights_(1, 1),
    mem_tracker_(tracker),
    metrics_(nullptr) {
   // Make empty circular linked list
@@ -266,6 +414,7 @@ void LRUCache::LRU_Remove(LRUHandle* e) {
   e->next->prev = e->prev;
   e->prev->next = e->next;
   usage_ -= e->charge;
+  partition_usage_[e->partition] -= e->charge;
 }
 
 void LRUCache::LRU_Append(LRUHandle* e) {
@@ -275,17 +424,71 @@ void LRUCache::LRU_Append(LRUHandle* e) {
   e->prev->next = e;
   e->next->prev = e;
   usage_ += e->charge;
+  DCHECK_LT(e->partition, static_cast<int32_t>(partition_usage_.size()));
+  partition_usage_[e->partition] += e->charge;
+}
+
+int LRUCache::AddPartition(int weight) {
+  DCHECK_GT(weight, 0);
+  std::lock_guard<MutexType> l(mutex_);
+  partition_weights_.push_back(weight);
+  partition_usage_.push_back(0);
+  partition_target_.push_back(0);
+  RecomputePartitionTargets();
+  return static_cast<int>(partition_weights_.size()) - 1;
+}
+
+void LRUCache::RecomputePartitionTargets() {
+  int64_t total_weight = 0;
+  for (int w : partition_weights_) {
+    total_weight += w;
+  }
+  for (size_t i = 0; i < partition_weights_.size(); i++) {
+    partition_target_[i] = capacity_ * partition_weights_[i] / total_weight;
+  }
+}
+
+LRUHandle* LRUCache::PickEvictionVictim(LRUHandle* coldest) {
+  // With no registered partitions, or when the coldest entry's partition is
+  // already over its share target, plain LRU applies.
+  if (PREDICT_TRUE(partition_target_.size() == 1) ||
+      partition_usage_[coldest->partition] > partition_target_[coldest->partition]) {
+    return coldest;
+  }
+  // Otherwise, probe a bounded number of entries towards the hot end for
+  // one belonging to an over-target partition, so that partitions which
+  // exceed their share bear eviction pressure first. If none is found
+  // nearby, fall back to evicting the coldest entry: the targets are a
+  // soft preference, not a hard split.
+  LRUHandle* e = coldest->next;
+  for (int probes = 0; e != &lru_ && probes < kEvictionProbeDepth; probes++) {
+    if (!base::subtle::NoBarrier_Load(&e->recently_used) &&
+        partition_usage_[e->partition] > partition_target_[e->partition]) {
+      return e;
+    }
+    e = e->next;
+  }
+  return coldest;
 }
 
 Cache::Handle* LRUCache::Lookup(const Slice& key, uint32_t hash, bool caching) {
   LRUHandle* e;
   {
-    std::lock_guard<MutexType> l(mutex_);
+    shared_lock<MutexType> l(mutex_);
+    // Record the access in the frequency sketch whether or not the key is
+    // present: a key which misses repeatedly accumulates enough frequency
+    // to be admitted when it is eventually inserted.
+    if (PREDICT_FALSE(freq_sketch_ != nullptr)) {
+      freq_sketch_->Increment(hash);
+    }
     e = table_.Lookup(key, hash);
     if (e != nullptr) {
       base::RefCountInc(&e->refs);
-      LRU_Remove(e);
-      LRU_Append(e);
+      // Flag the entry as recently used rather than splicing it to the head
+      // of the LRU list, which would require the exclusive lock. The
+      // eviction path in Insert() honors the flag by giving the entry a
+      // second chance.
+      base::subtle::NoBarrier_Store(&e->recently_used, 1);
     }
   }
 
@@ -325,6 +528,7 @@ Cache::Handle* LRUCache::Insert(LRUHandle* e, Cache::EvictionCallback *eviction_
   // Allocate().
   e->eviction_callback = eviction_callback;
   e->refs = 2;  // One from LRUCache, one for the returned handle
+  e->recently_used = 0;
   mem_tracker_->Consume(e->charge);
   if (PREDICT_TRUE(metrics_)) {
     metrics_->cache_usage->IncrementBy(e->charge);
@@ -335,6 +539,21 @@ Cache::Handle* LRUCache::Insert(LRUHandle* e, Cache::EvictionCallback *eviction_
   {
     std::lock_guard<MutexType> l(mutex_);
 
+    if (PREDICT_FALSE(freq_sketch_ != nullptr)) {
+      freq_sketch_->MaybeAge();
+      // Admission control: if accepting this entry would force an eviction,
+      // only admit it when it has been accessed at least as frequently as
+      // the coldest resident entry. Otherwise the caller still gets a
+      // usable handle, but the entry is dropped on release rather than
+      // evicting more valuable data.
+      if (usage_ + e->charge > capacity_ && lru_.next != &lru_ &&
+          freq_sketch_->Estimate(e->hash) <
+              freq_sketch_->Estimate(lru_.next->hash)) {
+        e->refs = 1;  // Only the handle returned to the caller.
+        return reinterpret_cast<Cache::Handle*>(e);
+      }
+    }
+
     LRU_Append(e);
 
     LRUHandle* old = table_.Insert(e);
@@ -348,6 +567,17 @@ Cache::Handle* LRUCache::Insert(LRUHandle* e, Cache::EvictionCallback *eviction_
 
     while (usage_ > capacity_ && lru_.next != &lru_) {
       LRUHandle* old = lru_.next;
+      if (base::subtle::NoBarrier_Load(&old->recently_used)) {
+        // The entry was hit since it last reached the cold end of the list:
+        // clear the flag and move it back to the hot end instead of evicting
+        // it. Each flagged entry is moved at most once per pass, so this
+        // terminates.
+        base::subtle::NoBarrier_Store(&old->recently_used, 0);
+        LRU_Remove(old);
+        LRU_Append(old);
+        continue;
+      }
+      old = PickEvictionVictim(old);
       LRU_Remove(old);
       table_.Remove(old->key(), old->hash);
       if (Unref(old)) {
@@ -386,6 +616,39 @@ void LRUCache::Erase(const Slice& key, uint32_t hash) {
   }
 }
 
+void LRUCache::UpdateCapacity(size_t capacity) {
+  LRUHandle* to_remove_head = nullptr;
+  {
+    std::lock_guard<MutexType> l(mutex_);
+    capacity_ = capacity;
+    RecomputePartitionTargets();
+    // Evict from the cold end until usage fits, giving recently-used entries
+    // a second chance as in Insert().
+    while (usage_ > capacity_ && lru_.next != &lru_) {
+      LRUHandle* old = lru_.next;
+      if (base::subtle::NoBarrier_Load(&old->recently_used)) {
+        base::subtle::NoBarrier_Store(&old->recently_used, 0);
+        LRU_Remove(old);
+        LRU_Append(old);
+        continue;
+      }
+      old = PickEvictionVictim(old);
+      LRU_Remove(old);
+      table_.Remove(old->key(), old->hash);
+      if (Unref(old)) {
+        old->next = to_remove_head;
+        to_remove_head = old;
+      }
+    }
+  }
+  // Free the evicted entries outside of the lock.
+  while (to_remove_head != nullptr) {
+    LRUHandle* next = to_remove_head->next;
+    FreeEntry(to_remove_head);
+    to_remove_head = next;
+  }
+}
+
 // Determine the number of bits of the hash that should be used to determine
 // the cache shard. This, in turn, determines the number of shards.
 int DetermineShardBits() {
@@ -458,6 +721,13 @@ class ShardedLRUCache : public Cache {
     const uint32_t hash = HashSlice(key);
     shards_[Shard(hash)]->Erase(key, hash);
   }
+  virtual void UpdateCapacity(size_t capacity) OVERRIDE {
+    int num_shards = 1 << shard_bits_;
+    const size_t per_shard = (capacity + (num_shards - 1)) / num_shards;
+    for (LRUCache* cache : shards_) {
+      cache->UpdateCapacity(per_shard);
+    }
+  }
   virtual Slice Value(Handle* handle) OVERRIDE {
     return reinterpret_cast<LRUHandle*>(handle)->value();
   }
@@ -477,6 +747,27 @@ class ShardedLRUCache : public Cache {
     }
   }
 
+  virtual void SetFrequencyBasedAdmission(bool enabled) OVERRIDE {
+    for (LRUCache* cache : shards_) {
+      cache->SetFrequencyBasedAdmission(enabled);
+    }
+  }
+
+  virtual int RegisterPartition(int weight) OVERRIDE {
+    // Registering the same weight on every shard yields the same id
+    // from each; the partition's target in each shard is its share of the
+    // per-shard capacity.
+    int id = 0;
+    for (LRUCache* cache : shards_) {
+      id = cache->AddPartition(weight);
+    }
+    return id;
+  }
+
+  virtual void SetPartition(PendingHandle* handle, int partition_id) OVERRIDE {
+    reinterpret_cast<LRUHandle*>(DCHECK_NOTNULL(handle))->partition = partition_id;
+  }
+
   virtual PendingHandle* Allocate(Slice key, int val_len, int charge) OVERRIDE {
     int key_len = key.size();
     DCHECK_GE(key_len, 0);
@@ -491,6 +782,7 @@ class ShardedLRUCache : public Cache {
     handle->val_length = val_len;
     handle->charge = charge;
     handle->hash = HashSlice(key);
+    handle->partition = 0;
     memcpy(handle->kv_data, key.data(), key_len);
 
     return reinterpret_cast<PendingHandle*>(handle);
@@ -132,6 +132,41 @@ class Cache {
   // Pass a metric entity in order to start recoding metrics.
   virtual void SetMetrics(const scoped_refptr<MetricEntity>& metric_entity) = 0;
 
+  // Adjust the cache's total capacity to 'capacity' bytes. Shrinking the
+  // capacity synchronously evicts entries until usage fits within the new
+  // capacity. May be called concurrently with other cache operations.
+  // Implementations which do not support capacity adjustment ignore this.
+  virtual void UpdateCapacity(size_t capacity) {}
+
+  // Enable or disable frequency-based admission control.
+  //
+  // When enabled, the cache tracks an approximate access frequency for
+  // recently seen keys. If inserting a new entry would require evicting an
+  // existing one, the new entry is only retained when it has been accessed
+  // at least as frequently as the eviction candidate; otherwise the insert
+  // still returns a usable handle, but the entry is dropped as soon as the
+  // handle is released. This makes the cache resistant to large one-off
+  // scans which would otherwise flush the frequently-accessed working set.
+  //
+  // Must be called before the cache is accessed concurrently.
+  // Implementations which do not support admission control ignore this.
+  virtual void SetFrequencyBasedAdmission(bool enabled) {}
+
+  // Register a logical eviction partition with the given relative 'weight'
+  // and return its id, for use with SetPartition() below.
+  //
+  // Each partition is assigned a soft eviction target proportional to its
+  // weight: when the cache must evict, it prefers entries belonging to
+  // partitions which are over their target. The targets are not hard
+  // splits -- a partition may grow past its share as long as the space
+  // isn't needed by another partition. Entries belong to the default
+  // partition (id 0, weight 1) unless reassigned.
+  //
+  // Must be called before the cache is accessed concurrently.
+  // Implementations which do not support partitioning return the default
+  // partition id.
+  virtual int RegisterPartition(int weight) { return 0; }
+
   // ------------------------------------------------------------
   // Insertion path
   // ------------------------------------------------------------
@@ -173,6 +208,12 @@ class Cache {
   // caller must either free it using Free(), or insert it using Insert().
   virtual PendingHandle* Allocate(Slice key, int val_len, int charge) = 0;
 
+  // Assign the given pending entry to the eviction partition identified by
+  // 'partition_id', which must have been returned by RegisterPartition().
+  // Must be called before the entry is inserted. Implementations which do
+  // not support partitioning ignore this.
+  virtual void SetPartition(PendingHandle* handle, int partition_id) {}
+
   virtual uint8_t* MutableValue(PendingHandle* handle) = 0;
 
   // Commit a prepared entry into the cache.
@@ -49,6 +49,20 @@ METRIC_DEFINE_gauge_uint64(server, block_cache_usage, "Block Cache Memory Usage"
                            kudu::MetricUnit::kBytes,
                            "Memory consumed by the block cache");
 
+METRIC_DEFINE_counter(server, block_cache_slow_tier_hits,
+                      "Block Cache Slow Tier Hits", kudu::MetricUnit::kBlocks,
+                      "Number of lookups served from the slow (e.g. NVM) tier "
+                      "of a two-tier block cache");
+METRIC_DEFINE_counter(server, block_cache_promotions,
+                      "Block Cache Promotions", kudu::MetricUnit::kBlocks,
+                      "Number of blocks promoted from the slow tier to the "
+                      "fast tier of a two-tier block cache");
+METRIC_DEFINE_counter(server, block_cache_demotions,
+                      "Block Cache Demotions", kudu::MetricUnit::kBlocks,
+                      "Number of blocks evicted from the fast tier of a "
+                      "two-tier block cache and queued for demotion to the "
+                      "slow tier");
+
 namespace kudu {
 
 #define MINIT(member, x) member(METRIC_##x.Instantiate(entity))
@@ -66,4 +80,12 @@ CacheMetrics::CacheMetrics(const scoped_refptr<MetricEntity>& entity)
 #undef MINIT
 #undef GINIT
 
+#define MINIT(member, x) member(METRIC_##x.Instantiate(entity))
+TwoTierCacheMetrics::TwoTierCacheMetrics(const scoped_refptr<MetricEntity>& entity)
+  : MINIT(slow_tier_hits, block_cache_slow_tier_hits),
+    MINIT(promotions, block_cache_promotions),
+    MINIT(demotions, block_cache_demotions) {
+}
+#undef MINIT
+
 } // namespace kudu
@@ -38,5 +38,16 @@ struct CacheMetrics {
   scoped_refptr<AtomicGauge<uint64_t> > cache_usage;
 };
 
+// Additional metrics recorded by a two-tier cache (see twotier_cache.h),
+// breaking out the traffic which crosses between the tiers. The per-tier
+// lookup and usage traffic is recorded into the shared CacheMetrics above.
+struct TwoTierCacheMetrics {
+  explicit TwoTierCacheMetrics(const scoped_refptr<MetricEntity>& metric_entity);
+
+  scoped_refptr<Counter> slow_tier_hits;
+  scoped_refptr<Counter> promotions;
+  scoped_refptr<Counter> demotions;
+};
+
 } // namespace kudu
 #endif /* KUDU_UTIL_CACHE_METRICS_H */
@@ -27,6 +27,7 @@
 #include "kudu/gutil/strings/numbers.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/util/crc.h"
+#include "kudu/util/random.h"
 #include "kudu/util/stopwatch.h"
 #include "kudu/util/test_util.h"
 
@@ -79,6 +80,34 @@ TEST_F(CrcTest, TestCRC32C) {
   ASSERT_EQ(kExpectedCrc, data_crc3);
 }
 
+// Check that the Crc32c() helpers, which take a fast inline path for small
+// buffers, produce values identical to the crcutil instance for all small
+// lengths and alignments.
+TEST_F(CrcTest, TestSmallBufferEquivalence) {
+  Random rng(SeedRandom());
+  uint8_t buf[512];
+  for (uint8_t& b : buf) {
+    b = rng.Uniform(256);
+  }
+
+  Crc* crc32c = GetCrc32cInstance();
+  for (size_t offset = 0; offset < 8; offset++) {
+    for (size_t length = 0; length + offset <= sizeof(buf); length++) {
+      uint64_t expected = 0;
+      crc32c->Compute(buf + offset, length, &expected);
+      ASSERT_EQ(static_cast<uint32_t>(expected), Crc32c(buf + offset, length))
+          << "offset=" << offset << " length=" << length;
+
+      // Also check extending a previous CRC.
+      uint64_t expected_ext = expected;
+      crc32c->Compute(buf, 16, &expected_ext);
+      ASSERT_EQ(static_cast<uint32_t>(expected_ext),
+                Crc32c(buf, 16, static_cast<uint32_t>(expected)))
+          << "offset=" << offset << " length=" << length;
+    }
+  }
+}
+
 // Simple benchmark of CRC32C throughput.
 // We should expect about 8 bytes per cycle in throughput on a single core.
 TEST_F(CrcTest, BenchmarkCRC32C) {
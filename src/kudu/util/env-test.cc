@@ -498,6 +498,36 @@ TEST_F(TestEnv, TestReadFully) {
   ASSERT_STR_CONTAINS(status.ToString(), "EOF");
 }
 
+TEST_F(TestEnv, TestDirectIORead) {
+  const string kTestPath = GetTestPath("test");
+  const int kFileSize = 64 * 1024;
+  Env* env = Env::Default();
+
+  WriteTestFile(env, kTestPath, kFileSize);
+  ASSERT_NO_FATAL_FAILURE();
+
+  // Reopen for direct I/O reads. If the underlying filesystem doesn't
+  // support direct I/O this falls back to buffered reads, so the test is
+  // still meaningful.
+  RandomAccessFileOptions opts;
+  opts.o_direct = true;
+  unique_ptr<RandomAccessFile> raf;
+  ASSERT_OK(env->NewRandomAccessFile(opts, kTestPath, &raf));
+
+  // Reads need not be sector-aligned; the implementation stages them through
+  // an internal aligned buffer.
+  const int kReadLength = 10000;
+  unique_ptr<uint8_t[]> scratch(new uint8_t[kReadLength]);
+  Slice s(scratch.get(), kReadLength);
+  ASSERT_OK(raf->Read(1, s));
+  NO_FATALS(VerifyTestData(s, 1));
+
+  // Verify that a read ending past EOF fails with an EndOfFile error.
+  Slice s2(scratch.get(), 200);
+  Status status = raf->Read(kFileSize - 100, s2);
+  ASSERT_TRUE(status.IsEndOfFile()) << status.ToString();
+}
+
 TEST_F(TestEnv, TestReadVFully) {
   // Create the file.
   unique_ptr<RWFile> file;
@@ -534,6 +564,42 @@ TEST_F(TestEnv, TestReadVFully) {
   ASSERT_STR_CONTAINS(status.ToString(), "EOF");
 }
 
+TEST_F(TestEnv, TestReadBatch) {
+  // Create the file.
+  unique_ptr<RWFile> file;
+  ASSERT_OK(env_->NewRWFile(GetTestPath("foo"), &file));
+
+  // Append to it.
+  string kTestData = "abcde12345fghij";
+  ASSERT_OK(file->Write(0, kTestData));
+
+  // Read two contiguous ranges and one disjoint range in a single batch.
+  size_t size1 = 5;
+  uint8_t scratch1[size1];
+  size_t size2 = 3;
+  uint8_t scratch2[size2];
+  size_t size3 = 5;
+  uint8_t scratch3[size3];
+  vector<ReadRange> ranges = {
+    { 0, Slice(scratch1, size1) },
+    { 5, Slice(scratch2, size2) },
+    { 10, Slice(scratch3, size3) },
+  };
+  ASSERT_OK(file->ReadBatch(ranges));
+  ASSERT_EQ(ranges[0].data, "abcde");
+  ASSERT_EQ(ranges[1].data, "123");
+  ASSERT_EQ(ranges[2].data, "fghij");
+
+  // A batch with a range past EOF should fail.
+  vector<ReadRange> bad_ranges = {
+    { 0, Slice(scratch1, size1) },
+    { 12, Slice(scratch3, size3) },
+  };
+  Status status = file->ReadBatch(bad_ranges);
+  ASSERT_FALSE(status.ok());
+  ASSERT_TRUE(status.IsEndOfFile());
+}
+
 TEST_F(TestEnv, TestIOVMax) {
   Env* env = Env::Default();
   const string kTestPath = GetTestPath("test");
@@ -382,6 +382,30 @@ class SequentialFile {
   virtual const std::string& filename() const = 0;
 };
 
+// Describes one read in a batch of reads submitted via
+// RandomAccessFile::ReadBatch() or RWFile::ReadBatch().
+struct ReadRange {
+  // The file offset to read from.
+  uint64_t offset;
+
+  // Preallocated buffer for the data; its size determines how many bytes
+  // are read.
+  Slice data;
+};
+
+// Expected pattern of reads against an open file. Purely advisory; used
+// to tune kernel readahead via RandomAccessFile::HintAccessPattern() and
+// RWFile::HintAccessPattern().
+enum FileAccessPattern : uint8_t {
+  // The file will be read from start to end (e.g. a compaction input or
+  // tablet copy stream); aggressive kernel readahead is beneficial.
+  ACCESS_PATTERN_SEQUENTIAL,
+
+  // Reads will be scattered point accesses (e.g. bloom filter probes);
+  // kernel readahead would only waste I/O and page cache.
+  ACCESS_PATTERN_RANDOM,
+};
+
 // A file abstraction for randomly reading the contents of a file.
 class RandomAccessFile {
  public:
@@ -413,6 +437,41 @@ class RandomAccessFile {
   // Safe for concurrent use by multiple threads.
   virtual Status ReadV(uint64_t offset, ArrayView<Slice> results) const = 0;
 
+  // Reads a batch of byte ranges, each into its own preallocated buffer.
+  //
+  // The ranges should be sorted by ascending offset and must not overlap.
+  // Implementations coalesce ranges which are contiguous in the file into
+  // single vectored read syscalls, so a batch of adjacent ranges costs one
+  // syscall rather than one per range.
+  //
+  // Like Read(), retries on EINTR and short reads; if any range cannot be
+  // fully read, an error is returned.
+  //
+  // Safe for concurrent use by multiple threads.
+  virtual Status ReadBatch(ArrayView<ReadRange> ranges) const = 0;
+
+  // Hint that the given byte range will soon be read, allowing the
+  // implementation to begin readahead into the OS page cache asynchronously.
+  //
+  // Purely advisory: implementations may ignore it, and the range need not
+  // lie entirely within the file.
+  //
+  // Safe for concurrent use by multiple threads.
+  virtual Status ReadAhead(uint64_t /*offset*/, size_t /*length*/) const {
+    return Status::OK();
+  }
+
+  // Hint the expected pattern of future reads of the file, allowing the
+  // implementation to tune kernel readahead accordingly: a larger window
+  // for sequential streams, none at all for random point reads.
+  //
+  // Purely advisory: implementations may ignore it.
+  //
+  // Safe for concurrent use by multiple threads.
+  virtual Status HintAccessPattern(FileAccessPattern /*pattern*/) const {
+    return Status::OK();
+  }
+
   // Returns the size of the file
   virtual Status Size(uint64_t *size) const = 0;
 
@@ -439,7 +498,18 @@ struct WritableFileOptions {
 
 // Options specified when a file is opened for random access.
 struct RandomAccessFileOptions {
-  RandomAccessFileOptions() {}
+  // Whether to bypass the kernel page cache when reading (O_DIRECT). This
+  // avoids double-buffering data that the application caches itself.
+  //
+  // Direct I/O requires reads to be aligned to the logical sector size;
+  // implementations stage reads through an internal aligned buffer so that
+  // callers need not align their requests. If the underlying filesystem
+  // doesn't support direct I/O, the file transparently falls back to
+  // buffered reads.
+  bool o_direct;
+
+  RandomAccessFileOptions()
+    : o_direct(false) {}
 };
 
 // A file abstraction for sequential writing.  The implementation
@@ -486,6 +556,18 @@ class WritableFile {
 
   virtual Status Sync() = 0;
 
+  // Hint that the byte range given by 'offset' and 'length' will not be
+  // read again soon, allowing the implementation to release any clean
+  // pages caching it from the OS page cache. If 'length' is 0, the hint
+  // covers all bytes from 'offset' to the end of the file.
+  //
+  // Purely advisory: implementations may ignore it. Dirty pages are
+  // unaffected, so this is only useful after the range has been flushed
+  // or synced.
+  virtual Status EvictCache(uint64_t /*offset*/, size_t /*length*/) const {
+    return Status::OK();
+  }
+
   virtual uint64_t Size() const = 0;
 
   // Returns the filename provided when the WritableFile was constructed.
@@ -554,6 +636,30 @@ class RWFile {
   // Safe for concurrent use by multiple threads.
   virtual Status ReadV(uint64_t offset, ArrayView<Slice> results) const = 0;
 
+  // Reads a batch of byte ranges, each into its own preallocated buffer,
+  // coalescing contiguous ranges into single vectored read syscalls.
+  // See RandomAccessFile::ReadBatch().
+  //
+  // Safe for concurrent use by multiple threads.
+  virtual Status ReadBatch(ArrayView<ReadRange> ranges) const = 0;
+
+  // Hint that the given byte range will soon be read, allowing the
+  // implementation to begin readahead into the OS page cache asynchronously.
+  // Purely advisory; see RandomAccessFile::ReadAhead().
+  //
+  // Safe for concurrent use by multiple threads.
+  virtual Status ReadAhead(uint64_t /*offset*/, size_t /*length*/) const {
+    return Status::OK();
+  }
+
+  // Hint the expected pattern of future reads of the file.
+  // Purely advisory; see RandomAccessFile::HintAccessPattern().
+  //
+  // Safe for concurrent use by multiple threads.
+  virtual Status HintAccessPattern(FileAccessPattern /*pattern*/) const {
+    return Status::OK();
+  }
+
   // Writes 'data' to the file position given by 'offset'.
   virtual Status Write(uint64_t offset, const Slice& data) = 0;
 
@@ -603,6 +709,16 @@ class RWFile {
   // return a meaningful status.
   virtual Status Flush(FlushMode mode, uint64_t offset, size_t length) = 0;
 
+  // Hint that the byte range given by 'offset' and 'length' will not be
+  // read again soon, allowing the implementation to release any clean
+  // pages caching it from the OS page cache.
+  // Purely advisory; see WritableFile::EvictCache().
+  //
+  // Safe for concurrent use by multiple threads.
+  virtual Status EvictCache(uint64_t /*offset*/, size_t /*length*/) const {
+    return Status::OK();
+  }
+
   // Synchronously flushes all dirty file data and metadata to disk. Upon
   // returning successfully, all previously issued file changes have been
   // made durable.
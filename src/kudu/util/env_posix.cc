@@ -46,6 +46,7 @@
 #include "kudu/gutil/stringprintf.h"
 #include "kudu/gutil/strings/split.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/alignment.h"
 #include "kudu/util/array_view.h"
 #include "kudu/util/debug/trace_event.h"
 #include "kudu/util/env.h"
@@ -431,6 +432,79 @@ Status DoReadV(int fd, const string& filename, uint64_t offset,
   return Status::OK();
 }
 
+Status DoReadBatch(int fd, const string& filename, ArrayView<ReadRange> ranges) {
+  // Coalesce runs of ranges which are contiguous in the file and issue one
+  // vectored read per run.
+  vector<Slice> run;
+  size_t i = 0;
+  while (i < ranges.size()) {
+    run.clear();
+    uint64_t run_offset = ranges[i].offset;
+    uint64_t run_end = run_offset + ranges[i].data.size();
+    run.push_back(ranges[i].data);
+    i++;
+    while (i < ranges.size() && ranges[i].offset == run_end) {
+      run_end += ranges[i].data.size();
+      run.push_back(ranges[i].data);
+      i++;
+    }
+    RETURN_NOT_OK(DoReadV(fd, filename, run_offset,
+                          ArrayView<Slice>(run.data(), run.size())));
+  }
+  return Status::OK();
+}
+
+// Alignment required for the buffer address, file offset, and length of
+// direct I/O reads. 4KB satisfies both 512-byte and 4Kn sector devices and
+// keeps buffers page-aligned.
+const size_t kDirectIOReadAlignment = 4096;
+
+// Reads 'result.size()' bytes at 'offset' from a file opened with O_DIRECT.
+//
+// Direct I/O requires the buffer address, file offset, and length to all be
+// sector-aligned, so the read is staged through an aligned scratch buffer
+// covering the enclosing aligned window and the requested range is copied
+// out. This costs one user-space copy but keeps the data out of the kernel
+// page cache entirely.
+Status DoReadDirect(int fd, const string& filename, uint64_t offset, Slice result) {
+  MAYBE_RETURN_EIO(filename, IOError(Env::kInjectedFailureStatusMsg, EIO));
+  ThreadRestrictions::AssertIOAllowed();
+
+  uint64_t aligned_offset = offset & ~(kDirectIOReadAlignment - 1);
+  size_t aligned_size = KUDU_ALIGN_UP(offset + result.size() - aligned_offset,
+                                      kDirectIOReadAlignment);
+  void* mem;
+  if (posix_memalign(&mem, kDirectIOReadAlignment, aligned_size) != 0) {
+    return Status::RuntimeError(Substitute(
+        "Unable to allocate $0 byte aligned buffer for direct I/O", aligned_size));
+  }
+  unique_ptr<uint8_t, FreeDeleter> scratch(static_cast<uint8_t*>(mem));
+
+  uint64_t cur_offset = aligned_offset;
+  uint64_t end_offset = offset + result.size();
+  uint8_t* dst = scratch.get();
+  while (cur_offset < end_offset) {
+    size_t to_read = aligned_size - (cur_offset - aligned_offset);
+    ssize_t r;
+    RETRY_ON_EINTR(r, pread(fd, dst, to_read, cur_offset));
+    if (PREDICT_FALSE(r < 0)) {
+      return IOError(filename, errno);
+    }
+    cur_offset += r;
+    dst += r;
+    // With O_DIRECT a short read only happens at EOF. If it didn't cover the
+    // requested range, the caller asked for bytes past the end of the file.
+    if (PREDICT_FALSE(r == 0 ||
+                      (cur_offset < end_offset &&
+                       (r & (kDirectIOReadAlignment - 1)) != 0))) {
+      return Status::EndOfFile(
+          Substitute("EOF trying to read $0 bytes at offset $1", result.size(), offset));
+    }
+  }
+  memcpy(result.mutable_data(), scratch.get() + (offset - aligned_offset), result.size());
+  return Status::OK();
+}
+
 Status DoWriteV(int fd, const string& filename, uint64_t offset, ArrayView<const Slice> data) {
   MAYBE_RETURN_EIO(filename, IOError(Env::kInjectedFailureStatusMsg, EIO));
   ThreadRestrictions::AssertIOAllowed();
@@ -559,19 +633,78 @@ class PosixRandomAccessFile: public RandomAccessFile {
   std::string filename_;
   int fd_;
 
+  // Whether 'fd_' was opened with O_DIRECT, in which case reads must go
+  // through the alignment-handling direct read path.
+  bool o_direct_;
+
  public:
-  PosixRandomAccessFile(std::string fname, int fd)
-      : filename_(std::move(fname)), fd_(fd) {}
+  PosixRandomAccessFile(std::string fname, int fd, bool o_direct)
+      : filename_(std::move(fname)), fd_(fd), o_direct_(o_direct) {}
   virtual ~PosixRandomAccessFile() { close(fd_); }
 
   virtual Status Read(uint64_t offset, Slice result) const OVERRIDE {
+    if (PREDICT_FALSE(o_direct_)) {
+      return DoReadDirect(fd_, filename_, offset, result);
+    }
     return DoReadV(fd_, filename_, offset, ArrayView<Slice>(&result, 1));
   }
 
   virtual Status ReadV(uint64_t offset, ArrayView<Slice> results) const OVERRIDE {
+    if (PREDICT_FALSE(o_direct_)) {
+      uint64_t cur_offset = offset;
+      for (Slice& result : results) {
+        RETURN_NOT_OK(DoReadDirect(fd_, filename_, cur_offset, result));
+        cur_offset += result.size();
+      }
+      return Status::OK();
+    }
     return DoReadV(fd_, filename_, offset, results);
   }
 
+  virtual Status ReadBatch(ArrayView<ReadRange> ranges) const OVERRIDE {
+    if (PREDICT_FALSE(o_direct_)) {
+      for (const ReadRange& range : ranges) {
+        RETURN_NOT_OK(DoReadDirect(fd_, filename_, range.offset, range.data));
+      }
+      return Status::OK();
+    }
+    return DoReadBatch(fd_, filename_, ranges);
+  }
+
+  virtual Status ReadAhead(uint64_t offset, size_t length) const OVERRIDE {
+#if defined(__linux__)
+    // Readahead populates the kernel page cache, which direct I/O bypasses.
+    if (o_direct_) {
+      return Status::OK();
+    }
+    TRACE_EVENT1("io", "PosixRandomAccessFile::ReadAhead", "path", filename_);
+    ThreadRestrictions::AssertIOAllowed();
+    int ret = posix_fadvise(fd_, offset, length, POSIX_FADV_WILLNEED);
+    if (ret != 0) {
+      return IOError(filename_, ret);
+    }
+#endif
+    return Status::OK();
+  }
+
+  virtual Status HintAccessPattern(FileAccessPattern pattern) const OVERRIDE {
+#if defined(__linux__)
+    // The hint only affects kernel readahead, which direct I/O bypasses.
+    if (o_direct_) {
+      return Status::OK();
+    }
+    TRACE_EVENT1("io", "PosixRandomAccessFile::HintAccessPattern", "path", filename_);
+    ThreadRestrictions::AssertIOAllowed();
+    int advice = pattern == ACCESS_PATTERN_SEQUENTIAL ?
+        POSIX_FADV_SEQUENTIAL : POSIX_FADV_RANDOM;
+    int ret = posix_fadvise(fd_, 0, 0, advice);
+    if (ret != 0) {
+      return IOError(filename_, ret);
+    }
+#endif
+    return Status::OK();
+  }
+
   virtual Status Size(uint64_t *size) const OVERRIDE {
     MAYBE_RETURN_EIO(filename_, IOError(Env::kInjectedFailureStatusMsg, EIO));
     TRACE_EVENT1("io", "PosixRandomAccessFile::Size", "path", filename_);
@@ -706,6 +839,18 @@ class PosixWritableFile : public WritableFile {
     return Status::OK();
   }
 
+  virtual Status EvictCache(uint64_t offset, size_t length) const OVERRIDE {
+#if defined(__linux__)
+    TRACE_EVENT1("io", "PosixWritableFile::EvictCache", "path", filename_);
+    ThreadRestrictions::AssertIOAllowed();
+    int ret = posix_fadvise(fd_, offset, length, POSIX_FADV_DONTNEED);
+    if (ret != 0) {
+      return IOError(filename_, ret);
+    }
+#endif
+    return Status::OK();
+  }
+
   virtual Status Sync() OVERRIDE {
     TRACE_EVENT1("io", "PosixWritableFile::Sync", "path", filename_);
     ThreadRestrictions::AssertIOAllowed();
@@ -755,6 +900,36 @@ class PosixRWFile : public RWFile {
     return DoReadV(fd_, filename_, offset, results);
   }
 
+  virtual Status ReadBatch(ArrayView<ReadRange> ranges) const OVERRIDE {
+    return DoReadBatch(fd_, filename_, ranges);
+  }
+
+  virtual Status ReadAhead(uint64_t offset, size_t length) const OVERRIDE {
+#if defined(__linux__)
+    TRACE_EVENT1("io", "PosixRWFile::ReadAhead", "path", filename_);
+    ThreadRestrictions::AssertIOAllowed();
+    int ret = posix_fadvise(fd_, offset, length, POSIX_FADV_WILLNEED);
+    if (ret != 0) {
+      return IOError(filename_, ret);
+    }
+#endif
+    return Status::OK();
+  }
+
+  virtual Status HintAccessPattern(FileAccessPattern pattern) const OVERRIDE {
+#if defined(__linux__)
+    TRACE_EVENT1("io", "PosixRWFile::HintAccessPattern", "path", filename_);
+    ThreadRestrictions::AssertIOAllowed();
+    int advice = pattern == ACCESS_PATTERN_SEQUENTIAL ?
+        POSIX_FADV_SEQUENTIAL : POSIX_FADV_RANDOM;
+    int ret = posix_fadvise(fd_, 0, 0, advice);
+    if (ret != 0) {
+      return IOError(filename_, ret);
+    }
+#endif
+    return Status::OK();
+  }
+
   virtual Status Write(uint64_t offset, const Slice& data) OVERRIDE {
     return WriteV(offset, ArrayView<const Slice>(&data, 1));
   }
@@ -856,6 +1031,18 @@ class PosixRWFile : public RWFile {
     return Status::OK();
   }
 
+  virtual Status EvictCache(uint64_t offset, size_t length) const OVERRIDE {
+#if defined(__linux__)
+    TRACE_EVENT1("io", "PosixRWFile::EvictCache", "path", filename_);
+    ThreadRestrictions::AssertIOAllowed();
+    int ret = posix_fadvise(fd_, offset, length, POSIX_FADV_DONTNEED);
+    if (ret != 0) {
+      return IOError(filename_, ret);
+    }
+#endif
+    return Status::OK();
+  }
+
   virtual Status Sync() OVERRIDE {
     TRACE_EVENT1("io", "PosixRWFile::Sync", "path", filename_);
     ThreadRestrictions::AssertIOAllowed();
@@ -1038,12 +1225,37 @@ class PosixEnv : public Env {
     TRACE_EVENT1("io", "PosixEnv::NewRandomAccessFile", "path", fname);
     MAYBE_RETURN_EIO(fname, IOError(Env::kInjectedFailureStatusMsg, EIO));
     ThreadRestrictions::AssertIOAllowed();
-    int fd = open(fname.c_str(), O_RDONLY);
+    bool o_direct = opts.o_direct;
+    int flags = O_RDONLY;
+#if !defined(__APPLE__)
+    if (o_direct) {
+      flags |= O_DIRECT;
+    }
+#endif
+    int fd = open(fname.c_str(), flags);
+#if !defined(__APPLE__)
+    if (fd < 0 && o_direct && errno == EINVAL) {
+      // The underlying filesystem doesn't support direct I/O (e.g. tmpfs).
+      // Fall back to buffered reads.
+      KLOG_EVERY_N_SECS(WARNING, 60)
+          << "Filesystem does not support direct I/O; falling back to "
+          << "buffered reads for " << fname;
+      o_direct = false;
+      fd = open(fname.c_str(), O_RDONLY);
+    }
+#endif
     if (fd < 0) {
       return IOError(fname, errno);
     }
-
-    result->reset(new PosixRandomAccessFile(fname, fd));
+#if defined(__APPLE__)
+    if (o_direct) {
+      // OS X has no O_DIRECT; F_NOCACHE similarly bypasses the buffer cache
+      // but imposes no alignment restrictions on reads.
+      fcntl(fd, F_NOCACHE, 1);
+      o_direct = false;
+    }
+#endif
+    result->reset(new PosixRandomAccessFile(fname, fd, o_direct));
     return Status::OK();
   }
 
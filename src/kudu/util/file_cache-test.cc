@@ -302,6 +302,39 @@ TYPED_TEST(FileCacheTest, TestHeavyReads) {
   }
 }
 
+TYPED_TEST(FileCacheTest, TestPrefetch) {
+  const int kNumFiles = 5;
+
+  ASSERT_OK(this->ReinitCache(kNumFiles));
+
+  vector<string> filenames;
+  for (int i = 0; i < kNumFiles; i++) {
+    string filename = this->GetTestPath(Substitute("$0", i));
+    ASSERT_OK(this->WriteTestFile(filename, "test data"));
+    filenames.push_back(filename);
+  }
+
+  // Prefetching a mix of existing and non-existent files should eventually
+  // leave all of the existing files open, and the failures should be
+  // swallowed.
+  vector<string> to_prefetch = filenames;
+  to_prefetch.emplace_back("/does/not/exist");
+  this->cache_->PrefetchFiles(to_prefetch);
+  ASSERT_EVENTUALLY([&]() {
+    ASSERT_EQ(this->initial_open_fds_ + kNumFiles, CountOpenFds(this->env_));
+  });
+
+  // The files were opened with the same descriptors that a regular open
+  // would use.
+  for (const auto& filename : filenames) {
+    shared_ptr<TypeParam> f;
+    ASSERT_OK(this->cache_->OpenExistingFile(filename, &f));
+    uint64_t size;
+    ASSERT_OK(f->Size(&size));
+  }
+  ASSERT_EQ(this->initial_open_fds_ + kNumFiles, CountOpenFds(this->env_));
+}
+
 TYPED_TEST(FileCacheTest, TestNoRecursiveDeadlock) {
   // This test triggered a deadlock in a previous implementation, when expired
   // weak_ptrs were removed from the descriptor map in the descriptor's
@@ -46,11 +46,17 @@
 #include "kudu/util/slice.h"
 #include "kudu/util/status.h"
 #include "kudu/util/thread.h"
+#include "kudu/util/threadpool.h"
 
 DEFINE_int32(file_cache_expiry_period_ms, 60 * 1000,
              "Period of time (in ms) between removing expired file cache descriptors");
 TAG_FLAG(file_cache_expiry_period_ms, advanced);
 
+DEFINE_int32(file_cache_num_prefetch_threads, 4,
+             "Maximum number of threads used to open files ahead of their "
+             "first access via FileCache::PrefetchFiles()");
+TAG_FLAG(file_cache_num_prefetch_threads, advanced);
+
 using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
@@ -165,6 +171,8 @@ class BaseDescriptor {
 
   Env* env() const { return file_cache_->env_; }
 
+  bool direct_io() const { return file_cache_->direct_io_; }
+
   const string& filename() const { return file_name_; }
 
   bool deleted() const { return flags_.load() & FILE_DELETED; }
@@ -245,6 +253,24 @@ class Descriptor<RWFile> : public RWFile {
     return opened.file()->ReadV(offset, results);
   }
 
+  Status ReadBatch(ArrayView<ReadRange> ranges) const override {
+    ScopedOpenedDescriptor<RWFile> opened(&base_);
+    RETURN_NOT_OK(ReopenFileIfNecessary(&opened));
+    return opened.file()->ReadBatch(ranges);
+  }
+
+  Status ReadAhead(uint64_t offset, size_t length) const override {
+    ScopedOpenedDescriptor<RWFile> opened(&base_);
+    RETURN_NOT_OK(ReopenFileIfNecessary(&opened));
+    return opened.file()->ReadAhead(offset, length);
+  }
+
+  Status HintAccessPattern(FileAccessPattern pattern) const override {
+    ScopedOpenedDescriptor<RWFile> opened(&base_);
+    RETURN_NOT_OK(ReopenFileIfNecessary(&opened));
+    return opened.file()->HintAccessPattern(pattern);
+  }
+
   Status Write(uint64_t offset, const Slice& data) override {
     ScopedOpenedDescriptor<RWFile> opened(&base_);
     RETURN_NOT_OK(ReopenFileIfNecessary(&opened));
@@ -281,6 +307,12 @@ class Descriptor<RWFile> : public RWFile {
     return opened.file()->Flush(mode, offset, length);
   }
 
+  Status EvictCache(uint64_t offset, size_t length) const override {
+    ScopedOpenedDescriptor<RWFile> opened(&base_);
+    RETURN_NOT_OK(ReopenFileIfNecessary(&opened));
+    return opened.file()->EvictCache(offset, length);
+  }
+
   Status Sync() override {
     ScopedOpenedDescriptor<RWFile> opened(&base_);
     RETURN_NOT_OK(ReopenFileIfNecessary(&opened));
@@ -334,6 +366,7 @@ class Descriptor<RWFile> : public RWFile {
     //
     // Because the file may be evicted at any time we must use 'sync_on_close'
     // (note: sync is a no-op if the file isn't dirty).
+    DCHECK(!base_.direct_io()) << "direct I/O is not supported for RWFiles";
     RWFileOptions opts;
     opts.sync_on_close = true;
     opts.mode = Env::OPEN_EXISTING;
@@ -376,6 +409,24 @@ class Descriptor<RandomAccessFile> : public RandomAccessFile {
     return opened.file()->ReadV(offset, results);
   }
 
+  Status ReadBatch(ArrayView<ReadRange> ranges) const override {
+    ScopedOpenedDescriptor<RandomAccessFile> opened(&base_);
+    RETURN_NOT_OK(ReopenFileIfNecessary(&opened));
+    return opened.file()->ReadBatch(ranges);
+  }
+
+  Status ReadAhead(uint64_t offset, size_t length) const override {
+    ScopedOpenedDescriptor<RandomAccessFile> opened(&base_);
+    RETURN_NOT_OK(ReopenFileIfNecessary(&opened));
+    return opened.file()->ReadAhead(offset, length);
+  }
+
+  Status HintAccessPattern(FileAccessPattern pattern) const override {
+    ScopedOpenedDescriptor<RandomAccessFile> opened(&base_);
+    RETURN_NOT_OK(ReopenFileIfNecessary(&opened));
+    return opened.file()->HintAccessPattern(pattern);
+  }
+
   Status Size(uint64_t *size) const override {
     ScopedOpenedDescriptor<RandomAccessFile> opened(&base_);
     RETURN_NOT_OK(ReopenFileIfNecessary(&opened));
@@ -434,8 +485,10 @@ class Descriptor<RandomAccessFile> : public RandomAccessFile {
     }
 
     // The file was evicted, reopen it.
+    RandomAccessFileOptions opts;
+    opts.o_direct = base_.direct_io();
     unique_ptr<RandomAccessFile> f;
-    RETURN_NOT_OK(base_.env()->NewRandomAccessFile(base_.filename(), &f));
+    RETURN_NOT_OK(base_.env()->NewRandomAccessFile(opts, base_.filename(), &f));
 
     // The cache will take ownership of the newly opened file.
     ScopedOpenedDescriptor<RandomAccessFile> opened(
@@ -458,9 +511,11 @@ template <class FileType>
 FileCache<FileType>::FileCache(const string& cache_name,
                                Env* env,
                                int max_open_files,
-                               const scoped_refptr<MetricEntity>& entity)
+                               const scoped_refptr<MetricEntity>& entity,
+                               bool direct_io)
     : env_(env),
       cache_name_(cache_name),
+      direct_io_(direct_io),
       eviction_cb_(new EvictionCallback<FileType>()),
       cache_(NewLRUCache(DRAM_CACHE, max_open_files, cache_name)),
       running_(1) {
@@ -473,6 +528,11 @@ FileCache<FileType>::FileCache(const string& cache_name,
 
 template <class FileType>
 FileCache<FileType>::~FileCache() {
+  // Stop the prefetch pool before tearing anything else down; its tasks
+  // reference both 'this' and the cache.
+  if (prefetch_pool_) {
+    prefetch_pool_->Shutdown();
+  }
   running_.CountDown();
   if (descriptor_expiry_thread_) {
     descriptor_expiry_thread_->Join();
@@ -481,6 +541,10 @@ FileCache<FileType>::~FileCache() {
 
 template <class FileType>
 Status FileCache<FileType>::Init() {
+  RETURN_NOT_OK(ThreadPoolBuilder(Substitute("$0-prefetch", cache_name_))
+                .set_min_threads(0)
+                .set_max_threads(FLAGS_file_cache_num_prefetch_threads)
+                .Build(&prefetch_pool_));
   return Thread::Create("cache", Substitute("$0-evict", cache_name_),
                         &FileCache::RunDescriptorExpiry, this,
                         &descriptor_expiry_thread_);
@@ -510,6 +574,27 @@ Status FileCache<FileType>::OpenExistingFile(const string& file_name,
   return Status::OK();
 }
 
+template <class FileType>
+void FileCache<FileType>::PrefetchFiles(const vector<string>& file_names) {
+  DCHECK(prefetch_pool_);
+  for (const auto& f : file_names) {
+    Status submit = prefetch_pool_->SubmitFunc([this, f]() {
+      // The descriptor is dropped at the end of the task, but the opened
+      // file remains in the cache until evicted.
+      shared_ptr<FileType> file;
+      Status s = OpenExistingFile(f, &file);
+      if (!s.ok()) {
+        VLOG(1) << Substitute("Failed to prefetch $0: $1", f, s.ToString());
+      }
+    });
+    if (!submit.ok()) {
+      // The pool is shutting down; the files will simply be opened on first
+      // access as usual.
+      return;
+    }
+  }
+}
+
 template <class FileType>
 Status FileCache<FileType>::DeleteFile(const string& file_name) {
   {
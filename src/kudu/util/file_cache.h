@@ -20,9 +20,11 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <gtest/gtest_prod.h>
 
+#include "kudu/gutil/gscoped_ptr.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/util/cache.h"
@@ -46,6 +48,7 @@ class Descriptor;
 
 class MetricEntity;
 class Thread;
+class ThreadPool;
 
 // Cache of open files.
 //
@@ -100,10 +103,15 @@ class FileCache {
   // The 'cache_name' is used to disambiguate amongst other file cache
   // instances. The cache will use 'max_open_files' as a soft upper bound on
   // the number of files open at any given time.
+  //
+  // If 'direct_io' is true, files are opened for direct I/O, bypassing the
+  // kernel page cache (see RandomAccessFileOptions::o_direct). Only
+  // supported for FileCache<RandomAccessFile>.
   FileCache(const std::string& cache_name,
             Env* env,
             int max_open_files,
-            const scoped_refptr<MetricEntity>& entity);
+            const scoped_refptr<MetricEntity>& entity,
+            bool direct_io = false);
 
   // Destroys the file cache.
   ~FileCache();
@@ -123,6 +131,22 @@ class FileCache {
   Status OpenExistingFile(const std::string& file_name,
                           std::shared_ptr<FileType>* file);
 
+  // Warms the cache for a batch of files, asynchronously and best-effort.
+  //
+  // The named files are opened on a background thread pool so that by the
+  // time they are actually accessed (via OpenExistingFile() or I/O through
+  // an existing descriptor), the open file is likely already in the cache.
+  // Callers that know the set of files they are about to read (e.g. a scan
+  // across many cold cfiles) can use this to overlap the opens with one
+  // another and with their own work rather than paying for each open()
+  // serially on first access.
+  //
+  // Any errors encountered are ignored; a file that cannot be opened here
+  // will surface its error on first real access. Prefetched files are
+  // subject to normal eviction, so prefetching a batch larger than the
+  // cache's capacity is wasted work.
+  void PrefetchFiles(const std::vector<std::string>& file_names);
+
   // Deletes a file by name through the cache.
   //
   // If there is an outstanding descriptor for the file, the deletion will be
@@ -183,6 +207,9 @@ class FileCache {
   // Name of the cache.
   const std::string cache_name_;
 
+  // Whether files are opened for direct I/O.
+  const bool direct_io_;
+
   // Invoked whenever a cached file reaches zero references (i.e. it was
   // removed from the cache and is no longer in use by any file operations).
   std::unique_ptr<Cache::EvictionCallback> eviction_cb_;
@@ -197,6 +224,9 @@ class FileCache {
   std::unordered_map<std::string,
                      std::weak_ptr<internal::Descriptor<FileType>>> descriptors_;
 
+  // Runs the opens submitted by PrefetchFiles().
+  gscoped_ptr<ThreadPool> prefetch_pool_;
+
   // Calls RunDescriptorExpiry() in a loop until 'running_' isn't set.
   scoped_refptr<Thread> descriptor_expiry_thread_;
 
@@ -16,6 +16,8 @@
 // under the License.
 
 #include <cstdint>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -113,4 +115,31 @@ TEST_F(HdrHistogramTest, PercentileAndCopyTest) {
   ASSERT_EQ(hist.TotalSum(), copy.TotalSum());
 }
 
+// Increment from many threads concurrently and verify that no samples are
+// lost when the per-thread shards are merged.
+TEST_F(HdrHistogramTest, ConcurrentWritersTest) {
+  const int kNumThreads = 8;
+  const int kItersPerThread = 10000;
+  const int64_t kValue = 42;
+
+  HdrHistogram hist(10000LU, kSigDigits);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([&]() {
+      for (int j = 0; j < kItersPerThread; j++) {
+        hist.Increment(kValue);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  ASSERT_EQ(kNumThreads * kItersPerThread, hist.TotalCount());
+  ASSERT_EQ(kNumThreads * kItersPerThread * kValue, hist.TotalSum());
+  ASSERT_EQ(kNumThreads * kItersPerThread, hist.CountInBucketForValue(kValue));
+  ASSERT_EQ(kValue, hist.MinValue());
+  ASSERT_EQ(kValue, hist.MaxValue());
+}
+
 } // namespace kudu
@@ -35,8 +35,12 @@
 #include "kudu/gutil/bits.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/util/status.h"
+#include "kudu/util/striped64.h"
 
+using base::subtle::Acquire_CompareAndSwap;
+using base::subtle::Acquire_Load;
 using base::subtle::Atomic64;
+using base::subtle::AtomicWord;
 using base::subtle::NoBarrier_AtomicIncrement;
 using base::subtle::NoBarrier_Store;
 using base::subtle::NoBarrier_Load;
@@ -45,6 +49,21 @@ using strings::Substitute;
 
 namespace kudu {
 
+// Per-shard recording state. Each shard's counters are only contended by the
+// (typically few) threads which hash onto it, making the write path's atomic
+// increments effectively uncontended. Readers merge all shards lazily.
+struct HdrHistogram::Shard {
+  explicit Shard(int counts_array_length)
+    : total_count(0),
+      total_sum(0),
+      counts(new Atomic64[counts_array_length]()) {  // value-initialized
+  }
+
+  Atomic64 total_count;
+  Atomic64 total_sum;
+  gscoped_array<Atomic64> counts;
+};
+
 HdrHistogram::HdrHistogram(uint64_t highest_trackable_value, int num_significant_digits)
   : highest_trackable_value_(highest_trackable_value),
     num_significant_digits_(num_significant_digits),
@@ -54,11 +73,8 @@ HdrHistogram::HdrHistogram(uint64_t highest_trackable_value, int num_significant
     sub_bucket_half_count_magnitude_(0),
     sub_bucket_half_count_(0),
     sub_bucket_mask_(0),
-    total_count_(0),
-    total_sum_(0),
     min_value_(std::numeric_limits<Atomic64>::max()),
-    max_value_(0),
-    counts_(nullptr) {
+    max_value_(0) {
   Init();
 }
 
@@ -71,29 +87,35 @@ HdrHistogram::HdrHistogram(const HdrHistogram& other)
     sub_bucket_half_count_magnitude_(0),
     sub_bucket_half_count_(0),
     sub_bucket_mask_(0),
-    total_count_(0),
-    total_sum_(0),
     min_value_(std::numeric_limits<Atomic64>::max()),
-    max_value_(0),
-    counts_(nullptr) {
+    max_value_(0) {
   Init();
 
   // Not a consistent snapshot but we try to roughly keep it close.
   // Copy the sum and min first.
-  NoBarrier_Store(&total_sum_, NoBarrier_Load(&other.total_sum_));
+  Shard* merged = new Shard(counts_array_length_);
+  base::subtle::Release_Store(&shards_[0], reinterpret_cast<AtomicWord>(merged));
+  NoBarrier_Store(&merged->total_sum, other.TotalSum());
   NoBarrier_Store(&min_value_, NoBarrier_Load(&other.min_value_));
 
   uint64_t total_copied_count = 0;
-  // Copy the counts in order of ascending magnitude.
+  // Merge the other histogram's shards into our single shard, copying the
+  // counts in order of ascending magnitude.
   for (int i = 0; i < counts_array_length_; i++) {
-    uint64_t count = NoBarrier_Load(&other.counts_[i]);
-    NoBarrier_Store(&counts_[i], count);
+    uint64_t count = other.SumCountsAtIndex(i);
+    NoBarrier_Store(&merged->counts[i], count);
     total_copied_count += count;
   }
   // Copy the max observed value last.
   NoBarrier_Store(&max_value_, NoBarrier_Load(&other.max_value_));
   // We must ensure the total is consistent with the copied counts.
-  NoBarrier_Store(&total_count_, total_copied_count);
+  NoBarrier_Store(&merged->total_count, total_copied_count);
+}
+
+HdrHistogram::~HdrHistogram() {
+  for (int i = 0; i < kNumShards; i++) {
+    delete reinterpret_cast<Shard*>(NoBarrier_Load(&shards_[i]));
+  }
 }
 
 bool HdrHistogram::IsValidHighestTrackableValue(uint64_t highest_trackable_value) {
@@ -147,7 +169,58 @@ void HdrHistogram::Init() {
   bucket_count_ = buckets_needed;
 
   counts_array_length_ = (bucket_count_ + 1) * sub_bucket_half_count_;
-  counts_.reset(new Atomic64[counts_array_length_]());  // value-initialized
+  shards_.reset(new AtomicWord[kNumShards]());  // value-initialized
+}
+
+HdrHistogram::Shard* HdrHistogram::GetOrCreateCurrentShard() {
+  int idx = Striped64::get_tls_hashcode() & (kNumShards - 1);
+  AtomicWord cur = Acquire_Load(&shards_[idx]);
+  if (PREDICT_TRUE(cur != 0)) {
+    return reinterpret_cast<Shard*>(cur);
+  }
+  // First sample mapped onto this shard: allocate it, letting a concurrent
+  // allocation win any race.
+  Shard* shard = new Shard(counts_array_length_);
+  AtomicWord existing = Acquire_CompareAndSwap(
+      &shards_[idx], 0, reinterpret_cast<AtomicWord>(shard));
+  if (PREDICT_FALSE(existing != 0)) {
+    delete shard;
+    return reinterpret_cast<Shard*>(existing);
+  }
+  return shard;
+}
+
+uint64_t HdrHistogram::SumCountsAtIndex(int counts_index) const {
+  uint64_t count = 0;
+  for (int i = 0; i < kNumShards; i++) {
+    const Shard* shard = reinterpret_cast<const Shard*>(Acquire_Load(&shards_[i]));
+    if (shard) {
+      count += NoBarrier_Load(&shard->counts[counts_index]);
+    }
+  }
+  return count;
+}
+
+uint64_t HdrHistogram::TotalCount() const {
+  uint64_t count = 0;
+  for (int i = 0; i < kNumShards; i++) {
+    const Shard* shard = reinterpret_cast<const Shard*>(Acquire_Load(&shards_[i]));
+    if (shard) {
+      count += NoBarrier_Load(&shard->total_count);
+    }
+  }
+  return count;
+}
+
+uint64_t HdrHistogram::TotalSum() const {
+  uint64_t sum = 0;
+  for (int i = 0; i < kNumShards; i++) {
+    const Shard* shard = reinterpret_cast<const Shard*>(Acquire_Load(&shards_[i]));
+    if (shard) {
+      sum += NoBarrier_Load(&shard->total_sum);
+    }
+  }
+  return sum;
 }
 
 void HdrHistogram::Increment(int64_t value) {
@@ -164,15 +237,20 @@ void HdrHistogram::IncrementBy(int64_t value, int64_t count) {
   int sub_bucket_index = SubBucketIndex(value, bucket_index);
   int counts_index = CountsArrayIndex(bucket_index, sub_bucket_index);
 
-  // Increment bucket, total, and sum.
-  NoBarrier_AtomicIncrement(&counts_[counts_index], count);
-  NoBarrier_AtomicIncrement(&total_count_, count);
-  NoBarrier_AtomicIncrement(&total_sum_, value * count);
-
-  // Update min, if needed.
+  // Increment bucket, total, and sum in this thread's shard. The increments
+  // are still atomic, but the shard's cache lines are shared with few (if
+  // any) concurrent writers.
+  Shard* shard = GetOrCreateCurrentShard();
+  NoBarrier_AtomicIncrement(&shard->counts[counts_index], count);
+  NoBarrier_AtomicIncrement(&shard->total_count, count);
+  NoBarrier_AtomicIncrement(&shard->total_sum, value * count);
+
+  // Update min, if needed. Note that we load the raw atomics rather than
+  // going through MinValue()/MaxValue(), whose empty-histogram checks would
+  // scan every shard on each sample.
   {
     Atomic64 min_val;
-    while (PREDICT_FALSE(value < (min_val = MinValue()))) {
+    while (PREDICT_FALSE(value < (min_val = NoBarrier_Load(&min_value_)))) {
       Atomic64 old_val = NoBarrier_CompareAndSwap(&min_value_, min_val, value);
       if (PREDICT_TRUE(old_val == min_val)) break; // CAS success.
     }
@@ -181,7 +259,7 @@ void HdrHistogram::IncrementBy(int64_t value, int64_t count) {
   // Update max, if needed.
   {
     Atomic64 max_val;
-    while (PREDICT_FALSE(value > (max_val = MaxValue()))) {
+    while (PREDICT_FALSE(value > (max_val = NoBarrier_Load(&max_value_)))) {
       Atomic64 old_val = NoBarrier_CompareAndSwap(&max_value_, max_val, value);
       if (PREDICT_TRUE(old_val == max_val)) break; // CAS success.
     }
@@ -236,7 +314,7 @@ int HdrHistogram::CountsArrayIndex(int bucket_index, int sub_bucket_index) const
 }
 
 uint64_t HdrHistogram::CountAt(int bucket_index, int sub_bucket_index) const {
-  return counts_[CountsArrayIndex(bucket_index, sub_bucket_index)];
+  return SumCountsAtIndex(CountsArrayIndex(bucket_index, sub_bucket_index));
 }
 
 uint64_t HdrHistogram::CountInBucketForValue(uint64_t value) const {
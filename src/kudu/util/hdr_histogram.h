@@ -80,6 +80,8 @@ class HdrHistogram {
   // Copy-construct a (non-consistent) snapshot of other.
   explicit HdrHistogram(const HdrHistogram& other);
 
+  ~HdrHistogram();
+
   // Validate your params before trying to construct the object.
   static bool IsValidHighestTrackableValue(uint64_t highest_trackable_value);
   static bool IsValidNumSignificantDigits(int num_significant_digits);
@@ -103,11 +105,12 @@ class HdrHistogram {
   int BucketIndex(uint64_t value) const;
   int SubBucketIndex(uint64_t value, int bucket_index) const;
 
-  // Count of all events recorded.
-  uint64_t TotalCount() const { return base::subtle::NoBarrier_Load(&total_count_); }
+  // Count of all events recorded. Merges all shards; not an atomic snapshot
+  // in the presence of concurrent updates.
+  uint64_t TotalCount() const;
 
-  // Sum of all events recorded.
-  uint64_t TotalSum() const { return base::subtle::NoBarrier_Load(&total_sum_); }
+  // Sum of all events recorded. Merges all shards; see TotalCount().
+  uint64_t TotalSum() const;
 
   // Return number of items at index.
   uint64_t CountAt(int bucket_index, int sub_bucket_index) const;
@@ -174,9 +177,27 @@ class HdrHistogram {
   static const int kMinValidNumSignificantDigits = 1;
   static const int kMaxValidNumSignificantDigits = 5;
 
+  // Number of recording shards. Must be a power of two. Threads map onto
+  // shards via the Striped64 thread-local hashcode, so concurrent writers
+  // typically update disjoint cache lines instead of contending on a single
+  // set of atomics; readers lazily merge all shards.
+  static const int kNumShards = 8;
+
+  // The counters updated by the write path, replicated per shard. Shards are
+  // allocated lazily on a shard's first sample, so a histogram only ever
+  // written from one thread pays for a single shard.
+  struct Shard;
+
   void Init();
   int CountsArrayIndex(int bucket_index, int sub_bucket_index) const;
 
+  // Return the shard the calling thread should record into, allocating it if
+  // this is the first sample mapped onto it.
+  Shard* GetOrCreateCurrentShard();
+
+  // Return the count at the given counts array index, summed across shards.
+  uint64_t SumCountsAtIndex(int counts_index) const;
+
   uint64_t highest_trackable_value_;
   int num_significant_digits_;
   int counts_array_length_;
@@ -188,12 +209,12 @@ class HdrHistogram {
   int sub_bucket_half_count_;
   uint32_t sub_bucket_mask_;
 
-  // Also hot.
-  base::subtle::Atomic64 total_count_;
-  base::subtle::Atomic64 total_sum_;
+  // Also hot, but rarely written after warm-up.
   base::subtle::Atomic64 min_value_;
   base::subtle::Atomic64 max_value_;
-  gscoped_array<base::subtle::Atomic64> counts_;
+
+  // Lazily-allocated Shard pointers, one slot per shard.
+  gscoped_array<base::subtle::AtomicWord> shards_;
 
   HdrHistogram& operator=(const HdrHistogram& other); // Disable assignment operator.
 };
@@ -44,14 +44,16 @@ using std::vector;
 
 namespace kudu {
 
-// Adapter to allow RapidJSON to write directly to a stringstream.
-// Since Squeasel exposes a stringstream as its interface, this is needed to avoid overcopying.
+// Adapter to allow RapidJSON to write directly to an ostream. This avoids
+// buffering the whole document before handing it to the stream, which matters
+// for large documents written to streaming sinks (e.g. the webserver's
+// chunked /metrics response).
 class UTF8StringStreamBuffer {
  public:
-  explicit UTF8StringStreamBuffer(std::ostringstream* out);
+  explicit UTF8StringStreamBuffer(std::ostream* out);
   void Put(rapidjson::UTF8<>::Ch c);
  private:
-  std::ostringstream* out_;
+  std::ostream* out_;
 };
 
 // rapidjson doesn't provide any common interface between the PrettyWriter and
@@ -84,7 +86,7 @@ class JsonWriterIf {
 template<class T>
 class JsonWriterImpl : public JsonWriterIf {
  public:
-  explicit JsonWriterImpl(ostringstream* out);
+  explicit JsonWriterImpl(std::ostream* out);
 
   virtual void Null() OVERRIDE;
   virtual void Bool(bool b) OVERRIDE;
@@ -115,7 +117,7 @@ class JsonWriterImpl : public JsonWriterIf {
 typedef rapidjson::PrettyWriter<UTF8StringStreamBuffer> PrettyWriterClass;
 typedef rapidjson::Writer<UTF8StringStreamBuffer> CompactWriterClass;
 
-JsonWriter::JsonWriter(ostringstream* out, Mode m) {
+JsonWriter::JsonWriter(std::ostream* out, Mode m) {
   switch (m) {
     case PRETTY:
       impl_.reset(new JsonWriterImpl<PrettyWriterClass>(DCHECK_NOTNULL(out)));
@@ -282,7 +284,7 @@ string JsonWriter::ToJson(const Message& pb, Mode mode) {
 // UTF8StringStreamBuffer
 //
 
-UTF8StringStreamBuffer::UTF8StringStreamBuffer(std::ostringstream* out)
+UTF8StringStreamBuffer::UTF8StringStreamBuffer(std::ostream* out)
   : out_(DCHECK_NOTNULL(out)) {
 }
 
@@ -295,7 +297,7 @@ void UTF8StringStreamBuffer::Put(rapidjson::UTF8<>::Ch c) {
 //
 
 template<class T>
-JsonWriterImpl<T>::JsonWriterImpl(ostringstream* out)
+JsonWriterImpl<T>::JsonWriterImpl(std::ostream* out)
   : stream_(DCHECK_NOTNULL(out)),
     writer_(stream_) {
 }
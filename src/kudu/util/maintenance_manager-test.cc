@@ -55,6 +55,7 @@ METRIC_DEFINE_histogram(test, maintenance_op_duration,
                         "Maintenance Operation Duration",
                         kudu::MetricUnit::kSeconds, "", 60000000LU, 2);
 
+DECLARE_int32(maintenance_manager_rowset_compaction_lane_threads);
 DECLARE_int64(log_target_replay_size_mb);
 
 namespace kudu {
@@ -94,8 +95,9 @@ TEST_F(MaintenanceManagerTest, TestCreateAndShutdown) {
 class TestMaintenanceOp : public MaintenanceOp {
  public:
   TestMaintenanceOp(const std::string& name,
-                    IOUsage io_usage)
-    : MaintenanceOp(name, io_usage),
+                    IOUsage io_usage,
+                    Lane lane = LANE_DEFAULT)
+    : MaintenanceOp(name, io_usage, lane),
       ram_anchored_(500),
       logs_retained_bytes_(0),
       perf_improvement_(0),
@@ -304,6 +306,46 @@ TEST_F(MaintenanceManagerTest, TestLogRetentionPrioritization) {
   manager_->UnregisterOp(&op2);
 }
 
+// Test that lane concurrency budgets cap a lane's concurrency when another
+// lane has runnable work, but that a capped lane can still use idle threads
+// when nothing else is runnable.
+TEST_F(MaintenanceManagerTest, TestLaneBudgets) {
+  manager_->Shutdown();
+
+  TestMaintenanceOp compact_op("compact", MaintenanceOp::HIGH_IO_USAGE,
+                               MaintenanceOp::LANE_ROWSET_COMPACTION);
+  compact_op.set_perf_improvement(10);
+  compact_op.set_remaining_runs(10);
+
+  TestMaintenanceOp flush_op("flush", MaintenanceOp::HIGH_IO_USAGE,
+                             MaintenanceOp::LANE_FLUSH);
+  flush_op.set_perf_improvement(5);
+  flush_op.set_remaining_runs(10);
+
+  manager_->RegisterOp(&compact_op);
+  manager_->RegisterOp(&flush_op);
+
+  // With no budgets configured, the compaction wins on perf improvement.
+  ASSERT_EQ(&compact_op, manager_->FindBestOp());
+
+  // Cap the compaction lane at one concurrent op. With a compaction already
+  // running, the flush should be picked despite its lower score.
+  FLAGS_maintenance_manager_rowset_compaction_lane_threads = 1;
+  manager_->running_by_lane_[MaintenanceOp::LANE_ROWSET_COMPACTION] = 1;
+  manager_->running_ops_ = 1;
+  ASSERT_EQ(&flush_op, manager_->FindBestOp());
+
+  // When the flush lane has nothing runnable, the compaction lane may steal
+  // the idle thread even though it is at its budget.
+  flush_op.set_remaining_runs(0);
+  ASSERT_EQ(&compact_op, manager_->FindBestOp());
+
+  manager_->running_by_lane_[MaintenanceOp::LANE_ROWSET_COMPACTION] = 0;
+  manager_->running_ops_ = 0;
+  manager_->UnregisterOp(&compact_op);
+  manager_->UnregisterOp(&flush_op);
+}
+
 // Test retrieving a list of an op's running instances
 TEST_F(MaintenanceManagerTest, TestRunningInstances) {
   TestMaintenanceOp op("op", MaintenanceOp::HIGH_IO_USAGE);
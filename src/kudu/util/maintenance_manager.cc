@@ -19,6 +19,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <mutex>
 #include <sstream>
@@ -56,6 +57,33 @@ DEFINE_int32(maintenance_manager_num_threads, 1,
              "not be above the number of devices.");
 TAG_FLAG(maintenance_manager_num_threads, stable);
 
+DEFINE_int32(maintenance_manager_flush_lane_threads, 0,
+             "Maximum number of maintenance manager threads that may "
+             "concurrently run ops in the flush lane (memstore and delta "
+             "memstore flushes). If no other lane has runnable work, idle "
+             "threads may still pick up flush ops beyond this budget. "
+             "0 means the lane has no dedicated budget.");
+TAG_FLAG(maintenance_manager_flush_lane_threads, advanced);
+TAG_FLAG(maintenance_manager_flush_lane_threads, runtime);
+
+DEFINE_int32(maintenance_manager_delta_compaction_lane_threads, 0,
+             "Maximum number of maintenance manager threads that may "
+             "concurrently run minor or major delta compactions. If no other "
+             "lane has runnable work, idle threads may still pick up delta "
+             "compactions beyond this budget. 0 means the lane has no "
+             "dedicated budget.");
+TAG_FLAG(maintenance_manager_delta_compaction_lane_threads, advanced);
+TAG_FLAG(maintenance_manager_delta_compaction_lane_threads, runtime);
+
+DEFINE_int32(maintenance_manager_rowset_compaction_lane_threads, 0,
+             "Maximum number of maintenance manager threads that may "
+             "concurrently run rowset compactions. If no other lane has "
+             "runnable work, idle threads may still pick up rowset "
+             "compactions beyond this budget. 0 means the lane has no "
+             "dedicated budget.");
+TAG_FLAG(maintenance_manager_rowset_compaction_lane_threads, advanced);
+TAG_FLAG(maintenance_manager_rowset_compaction_lane_threads, runtime);
+
 DEFINE_int32(maintenance_manager_polling_interval_ms, 250,
        "Polling interval for the maintenance manager scheduler, "
        "in milliseconds.");
@@ -104,11 +132,12 @@ void MaintenanceOpStats::Clear() {
   last_modified_ = MonoTime();
 }
 
-MaintenanceOp::MaintenanceOp(std::string name, IOUsage io_usage)
+MaintenanceOp::MaintenanceOp(std::string name, IOUsage io_usage, Lane lane)
     : name_(std::move(name)),
       running_(0),
       cancel_(false),
-      io_usage_(io_usage) {
+      io_usage_(io_usage),
+      lane_(lane) {
 }
 
 MaintenanceOp::~MaintenanceOp() {
@@ -151,6 +180,7 @@ MaintenanceManager::MaintenanceManager(const Options& options)
     completed_ops_count_(0),
     rand_(GetRandomSeed32()),
     memory_pressure_func_(&process_memory::UnderMemoryPressure) {
+  memset(running_by_lane_, 0, sizeof(running_by_lane_));
   CHECK_OK(ThreadPoolBuilder("MaintenanceMgr").set_min_threads(num_threads_)
                .set_max_threads(num_threads_).Build(&thread_pool_));
   uint32_t history_size = options.history_size == 0 ?
@@ -282,6 +312,7 @@ void MaintenanceManager::RunSchedulerThread() {
     // Prepare the maintenance operation.
     op->running_++;
     running_ops_++;
+    running_by_lane_[op->lane()]++;
     guard.unlock();
     bool ready = op->Prepare();
     guard.lock();
@@ -290,6 +321,7 @@ void MaintenanceManager::RunSchedulerThread() {
                             << ".  Re-running scheduler.";
       op->running_--;
       running_ops_--;
+      running_by_lane_[op->lane()]--;
       op->cond_->Signal();
       continue;
     }
@@ -301,6 +333,25 @@ void MaintenanceManager::RunSchedulerThread() {
   }
 }
 
+namespace {
+
+// Return the concurrency budget configured for the given scheduling lane,
+// or 0 if the lane has no dedicated budget.
+int32_t LaneBudget(MaintenanceOp::Lane lane) {
+  switch (lane) {
+    case MaintenanceOp::LANE_FLUSH:
+      return FLAGS_maintenance_manager_flush_lane_threads;
+    case MaintenanceOp::LANE_DELTA_COMPACTION:
+      return FLAGS_maintenance_manager_delta_compaction_lane_threads;
+    case MaintenanceOp::LANE_ROWSET_COMPACTION:
+      return FLAGS_maintenance_manager_rowset_compaction_lane_threads;
+    default:
+      return 0;
+  }
+}
+
+} // anonymous namespace
+
 // Finding the best operation goes through four filters:
 // - If there's an Op that we can run quickly that frees log retention, we run it.
 // - If we've hit the overall process memory limit (note: this includes memory that the Ops cannot
@@ -331,6 +382,29 @@ MaintenanceOp* MaintenanceManager::FindBestOp() {
     return nullptr;
   }
 
+  // Update the stats of all the registered ops.
+  for (OpMapTy::value_type& val : ops_) {
+    MaintenanceOpStats& stats(val.second);
+    stats.Clear();
+    val.first->UpdateStats(&stats);
+  }
+
+  bool have_lane_budgets =
+      FLAGS_maintenance_manager_flush_lane_threads > 0 ||
+      FLAGS_maintenance_manager_delta_compaction_lane_threads > 0 ||
+      FLAGS_maintenance_manager_rowset_compaction_lane_threads > 0;
+
+  MaintenanceOp* op = FindBestOpHelper(have_lane_budgets);
+  if (!op && have_lane_budgets) {
+    // Work-stealing: no lane with remaining budget has anything worth
+    // running, so let the idle threads pick up work from lanes that are
+    // at their budget.
+    op = FindBestOpHelper(false);
+  }
+  return op;
+}
+
+MaintenanceOp* MaintenanceManager::FindBestOpHelper(bool respect_lane_budgets) {
   int64_t low_io_most_logs_retained_bytes = 0;
   MaintenanceOp* low_io_most_logs_retained_bytes_op = nullptr;
 
@@ -350,12 +424,17 @@ MaintenanceOp* MaintenanceManager::FindBestOp() {
     MaintenanceOp* op(val.first);
     MaintenanceOpStats& stats(val.second);
     VLOG_WITH_PREFIX(3) << "Considering MM op " << op->name();
-    // Update op stats.
-    stats.Clear();
-    op->UpdateStats(&stats);
     if (op->cancelled() || !stats.valid() || !stats.runnable()) {
       continue;
     }
+    if (respect_lane_budgets) {
+      int32_t budget = LaneBudget(op->lane());
+      if (budget > 0 && running_by_lane_[op->lane()] >= static_cast<uint64_t>(budget)) {
+        VLOG_WITH_PREFIX(3) << "Skipping " << op->name()
+                            << ": its scheduling lane is at its concurrency budget";
+        continue;
+      }
+    }
     if (stats.logs_retained_bytes() > low_io_most_logs_retained_bytes &&
         op->io_usage() == MaintenanceOp::LOW_IO_USAGE) {
       low_io_most_logs_retained_bytes_op = op;
@@ -482,6 +561,7 @@ void MaintenanceManager::LaunchOp(MaintenanceOp* op) {
     op->DurationHistogram()->Increment(op_instance.duration.ToMilliseconds());
 
     running_ops_--;
+    running_by_lane_[op->lane()]--;
     op->running_--;
     op->cond_->Signal();
     cond_.Signal(); // wake up scheduler
@@ -180,7 +180,20 @@ class MaintenanceOp {
     HIGH_IO_USAGE // Everything else.
   };
 
-  explicit MaintenanceOp(std::string name, IOUsage io_usage);
+  // Scheduling lane for the op. A lane with a configured thread budget (see
+  // the --maintenance_manager_*_lane_threads flags) is capped at that many
+  // concurrently running ops so that, for example, flushes are not starved
+  // behind long-running compactions. When no other lane has runnable work,
+  // a lane at its budget may still use idle threads.
+  enum Lane {
+    LANE_DEFAULT, // No dedicated budget; never capped.
+    LANE_FLUSH,
+    LANE_DELTA_COMPACTION,
+    LANE_ROWSET_COMPACTION,
+    kNumLanes
+  };
+
+  MaintenanceOp(std::string name, IOUsage io_usage, Lane lane = LANE_DEFAULT);
   virtual ~MaintenanceOp();
 
   // Unregister this op, if it is currently registered.
@@ -215,6 +228,8 @@ class MaintenanceOp {
 
   IOUsage io_usage() const { return io_usage_; }
 
+  Lane lane() const { return lane_; }
+
   // Return true if the operation has been cancelled due to Unregister() pending.
   bool cancelled() const {
     return cancel_.Load();
@@ -253,6 +268,8 @@ class MaintenanceOp {
   std::shared_ptr<MaintenanceManager> manager_;
 
   IOUsage io_usage_;
+
+  Lane lane_;
 };
 
 struct MaintenanceOpComparator {
@@ -298,6 +315,7 @@ class MaintenanceManager : public std::enable_shared_from_this<MaintenanceManage
   static const Options kDefaultOptions;
 
  private:
+  FRIEND_TEST(MaintenanceManagerTest, TestLaneBudgets);
   FRIEND_TEST(MaintenanceManagerTest, TestLogRetentionPrioritization);
   typedef std::map<MaintenanceOp*, MaintenanceOpStats,
           MaintenanceOpComparator> OpMapTy;
@@ -311,6 +329,11 @@ class MaintenanceManager : public std::enable_shared_from_this<MaintenanceManage
   // find the best op, or null if there is nothing we want to run
   MaintenanceOp* FindBestOp();
 
+  // Helper for FindBestOp(). Assumes the stats in 'ops_' have already been
+  // updated. If 'respect_lane_budgets' is true, ops in lanes which have
+  // reached their concurrency budget are not considered.
+  MaintenanceOp* FindBestOpHelper(bool respect_lane_budgets);
+
   void LaunchOp(MaintenanceOp* op);
 
   std::string LogPrefix() const;
@@ -324,6 +347,9 @@ class MaintenanceManager : public std::enable_shared_from_this<MaintenanceManage
   bool shutdown_;
   int32_t polling_interval_ms_;
   uint64_t running_ops_;
+  // The number of currently running ops in each scheduling lane.
+  // Protected by lock_.
+  uint64_t running_by_lane_[MaintenanceOp::kNumLanes];
   // Vector used as a circular buffer for recently completed ops. Elements need to be added at
   // the completed_ops_count_ % the vector's size and then the count needs to be incremented.
   std::vector<OpInstance> completed_ops_;
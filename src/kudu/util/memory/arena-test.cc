@@ -189,6 +189,29 @@ TEST(TestArena, TestMemoryTrackingEnforced) {
   ASSERT_EQ(256, mem_tracker->consumption());
 }
 
+TEST(TestArena, TestRecyclingBufferAllocator) {
+  RecyclingBufferAllocator allocator(HeapBufferAllocator::Get(), 1024 * 1024);
+
+  // A freed power-of-two-sized buffer should be cached, and handed back out
+  // for the next allocation of the same size.
+  std::unique_ptr<Buffer> buf(allocator.Allocate(64 * 1024));
+  ASSERT_TRUE(buf);
+  void* data = buf->data();
+  buf.reset();
+  ASSERT_EQ(64 * 1024, allocator.cached_bytes());
+  buf.reset(allocator.Allocate(64 * 1024));
+  ASSERT_TRUE(buf);
+  ASSERT_EQ(data, buf->data());
+  ASSERT_EQ(0, allocator.cached_bytes());
+
+  // Buffers with sizes outside the cacheable size classes pass straight
+  // through to the delegate.
+  buf.reset(allocator.Allocate(1000));
+  ASSERT_TRUE(buf);
+  buf.reset();
+  ASSERT_EQ(0, allocator.cached_bytes());
+}
+
 TEST(TestArena, TestSTLAllocator) {
   Arena a(256);
   typedef vector<int, ArenaAllocator<int, false> > ArenaVector;
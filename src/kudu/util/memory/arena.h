@@ -71,6 +71,15 @@ template <> struct ArenaTraits<false> {
 // predecessor, until the maximum specified buffer size is reached.
 // The buffers are furnished by a designated allocator.
 //
+// NOTE on NUMA placement: the arena makes no attempt to bind its buffers to
+// a particular NUMA node -- doing so would require a libnuma dependency.
+// Under Linux's default first-touch policy, fresh pages of a buffer are bound
+// to the node of the thread which first writes them, which for memstore
+// arenas is the inserting thread. The caveat is that the underlying malloc
+// implementation may recycle memory whose pages were first touched on a
+// different node; workloads that are sensitive to this should run one tablet
+// server per node (e.g. under numactl) rather than one spanning both.
+//
 // This class is thread-safe with the fast path lock-free.
 template <bool THREADSAFE>
 class ArenaBase {
@@ -195,6 +195,92 @@ void ClearingBufferAllocator::FreeInternal(Buffer* buffer) {
   DelegateFree(delegate_, buffer);
 }
 
+namespace {
+
+// Bounds on the power-of-two buffer size classes maintained by
+// RecyclingBufferAllocator.
+const size_t kMinCachedBufferSize = 4 * 1024;
+const size_t kMaxCachedBufferSize = 1024 * 1024;
+const int kNumBufferSizeClasses = 9;  // log2(1MB) - log2(4KB) + 1
+
+} // anonymous namespace
+
+RecyclingBufferAllocator::RecyclingBufferAllocator(BufferAllocator* delegate,
+                                                   size_t max_cached_bytes)
+    : delegate_(delegate),
+      max_cached_bytes_(max_cached_bytes),
+      cached_bytes_(0),
+      free_lists_(kNumBufferSizeClasses) {
+}
+
+RecyclingBufferAllocator::~RecyclingBufferAllocator() {
+  size_t size = kMinCachedBufferSize;
+  for (const auto& free_list : free_lists_) {
+    for (void* data : free_list) {
+      // Re-wrap the raw block in a Buffer owned by the delegate so that it
+      // is returned through the allocator which originally provided it.
+      delete CreateBuffer(data, size, delegate_);
+    }
+    size *= 2;
+  }
+}
+
+size_t RecyclingBufferAllocator::cached_bytes() const {
+  MutexLock lock(mutex_);
+  return cached_bytes_;
+}
+
+int RecyclingBufferAllocator::SizeClass(size_t size) {
+  if (size < kMinCachedBufferSize || size > kMaxCachedBufferSize ||
+      (size & (size - 1)) != 0) {
+    return -1;
+  }
+  int size_class = 0;
+  while ((kMinCachedBufferSize << size_class) != size) {
+    size_class++;
+  }
+  return size_class;
+}
+
+Buffer* RecyclingBufferAllocator::AllocateInternal(size_t requested,
+                                                   size_t minimal,
+                                                   BufferAllocator* originator) {
+  int size_class = SizeClass(requested);
+  if (size_class != -1) {
+    MutexLock lock(mutex_);
+    if (!free_lists_[size_class].empty()) {
+      void* data = free_lists_[size_class].back();
+      free_lists_[size_class].pop_back();
+      cached_bytes_ -= requested;
+      return CreateBuffer(data, requested, originator);
+    }
+  }
+  return DelegateAllocate(delegate_, requested, minimal, originator);
+}
+
+bool RecyclingBufferAllocator::ReallocateInternal(size_t requested,
+                                                  size_t minimal,
+                                                  Buffer* buffer,
+                                                  BufferAllocator* originator) {
+  // Reallocation is delegated directly: the underlying block always comes
+  // from the delegate, regardless of whether it was most recently handed out
+  // from the cache.
+  return DelegateReallocate(delegate_, requested, minimal, buffer, originator);
+}
+
+void RecyclingBufferAllocator::FreeInternal(Buffer* buffer) {
+  int size_class = SizeClass(buffer->size());
+  if (size_class != -1) {
+    MutexLock lock(mutex_);
+    if (cached_bytes_ + buffer->size() <= max_cached_bytes_) {
+      free_lists_[size_class].push_back(buffer->data());
+      cached_bytes_ += buffer->size();
+      return;
+    }
+  }
+  DelegateFree(delegate_, buffer);
+}
+
 Buffer* MediatingBufferAllocator::AllocateInternal(
     const size_t requested,
     const size_t minimal,
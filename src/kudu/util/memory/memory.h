@@ -313,6 +313,62 @@ class ClearingBufferAllocator : public BufferAllocator {
   DISALLOW_COPY_AND_ASSIGN(ClearingBufferAllocator);
 };
 
+// Wrapper around the delegate allocator that keeps a bounded cache of freed
+// buffers and serves future same-sized allocations from the cache instead of
+// going back to the delegate. Only power-of-two-sized buffers between 4KB and
+// 1MB are cached; these cover the buffer sizes that dominate Arena chunk
+// churn (Arena chunks double in size, so repeated arena reset/rebuild cycles
+// allocate and free the same few size classes over and over).
+//
+// The total amount of cached memory is bounded by 'max_cached_bytes'; once
+// the cache is full, freed buffers are returned to the delegate as usual.
+//
+// Thread-safe if the delegate is thread-safe. Note that cached buffers are
+// not returned to the delegate until this allocator is destroyed, so when
+// composing with MemoryTrackingBufferAllocator, this allocator should be
+// layered on top (i.e. further from the heap) so that cached memory remains
+// accounted for by the MemTracker.
+class RecyclingBufferAllocator : public BufferAllocator {
+ public:
+  // Does not take ownership of the delegate.
+  RecyclingBufferAllocator(BufferAllocator* delegate, size_t max_cached_bytes);
+
+  // Returns any cached buffers to the delegate.
+  virtual ~RecyclingBufferAllocator();
+
+  virtual size_t Available() const OVERRIDE {
+    return delegate_->Available();
+  }
+
+  // The total size of currently cached buffers, in bytes.
+  size_t cached_bytes() const;
+
+ private:
+  // Returns the cache size class index for a buffer of exactly 'size' bytes,
+  // or -1 if buffers of that size are not cached.
+  static int SizeClass(size_t size);
+
+  virtual Buffer* AllocateInternal(size_t requested,
+                                   size_t minimal,
+                                   BufferAllocator* originator) OVERRIDE;
+
+  virtual bool ReallocateInternal(size_t requested,
+                                  size_t minimal,
+                                  Buffer* buffer,
+                                  BufferAllocator* originator) OVERRIDE;
+
+  virtual void FreeInternal(Buffer* buffer) OVERRIDE;
+
+  BufferAllocator* delegate_;
+  const size_t max_cached_bytes_;
+
+  mutable Mutex mutex_;
+  size_t cached_bytes_;
+  std::vector<std::vector<void*> > free_lists_;
+
+  DISALLOW_COPY_AND_ASSIGN(RecyclingBufferAllocator);
+};
+
 // Abstract policy for modifying allocation requests - e.g. enforcing quotas.
 class Mediator {
  public:
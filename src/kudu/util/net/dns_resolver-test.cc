@@ -21,6 +21,7 @@
 #include <string>
 #include <vector>
 
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
@@ -31,6 +32,10 @@
 #include "kudu/util/test_macros.h"
 #include "kudu/util/test_util.h"
 
+DECLARE_bool(fail_dns_resolution);
+DECLARE_int32(dns_resolver_cache_ttl_sec);
+DECLARE_int32(dns_resolver_negative_cache_ttl_sec);
+
 using std::vector;
 
 namespace kudu {
@@ -40,6 +45,44 @@ class DnsResolverTest : public KuduTest {
   DnsResolver resolver_;
 };
 
+TEST_F(DnsResolverTest, TestCaching) {
+  google::FlagSaver saver;
+  FLAGS_dns_resolver_cache_ttl_sec = 60;
+
+  vector<Sockaddr> addrs;
+  HostPort hp("localhost", 12345);
+  ASSERT_OK(resolver_.ResolveAddresses(hp, &addrs));
+  ASSERT_TRUE(!addrs.empty());
+
+  // A second resolution should be served from the cache, with the requested
+  // port patched into the cached addresses: resolution can't succeed any
+  // other way while failures are being injected.
+  FLAGS_fail_dns_resolution = true;
+  addrs.clear();
+  HostPort hp2("localhost", 54321);
+  ASSERT_OK(resolver_.ResolveAddresses(hp2, &addrs));
+  ASSERT_TRUE(!addrs.empty());
+  for (const Sockaddr& addr : addrs) {
+    EXPECT_TRUE(HasPrefixString(addr.ToString(), "127."));
+    EXPECT_TRUE(HasSuffixString(addr.ToString(), ":54321"));
+  }
+}
+
+TEST_F(DnsResolverTest, TestNegativeCaching) {
+  google::FlagSaver saver;
+  FLAGS_dns_resolver_negative_cache_ttl_sec = 60;
+
+  // Prime the cache with an injected failure.
+  FLAGS_fail_dns_resolution = true;
+  HostPort hp("localhost", 12345);
+  ASSERT_FALSE(resolver_.ResolveAddresses(hp, nullptr).ok());
+
+  // Even though resolution would now succeed, the cached failure should be
+  // served until it expires.
+  FLAGS_fail_dns_resolution = false;
+  ASSERT_FALSE(resolver_.ResolveAddresses(hp, nullptr).ok());
+}
+
 TEST_F(DnsResolverTest, TestResolution) {
   vector<Sockaddr> addrs;
   Synchronizer s;
@@ -17,6 +17,9 @@
 
 #include "kudu/util/net/dns_resolver.h"
 
+#include <mutex>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include <boost/bind.hpp> // IWYU pragma: keep
@@ -32,10 +35,31 @@
 DEFINE_int32(dns_num_resolver_threads, 1, "The number of threads to use for DNS resolution");
 TAG_FLAG(dns_num_resolver_threads, advanced);
 
+DEFINE_int32(dns_resolver_cache_ttl_sec, 15,
+             "The number of seconds for which successful DNS resolutions are cached. "
+             "Cached entries are refreshed in the background after half this time, so "
+             "steadily-used hostnames keep resolving from the cache. Set to 0 to "
+             "disable DNS caching entirely.");
+TAG_FLAG(dns_resolver_cache_ttl_sec, advanced);
+TAG_FLAG(dns_resolver_cache_ttl_sec, runtime);
+
+DEFINE_int32(dns_resolver_negative_cache_ttl_sec, 1,
+             "The number of seconds for which failed DNS resolutions are cached, "
+             "protecting against tight retry loops hammering an unresponsive DNS "
+             "server. Set to 0 to disable negative caching.");
+TAG_FLAG(dns_resolver_negative_cache_ttl_sec, advanced);
+TAG_FLAG(dns_resolver_negative_cache_ttl_sec, runtime);
+
+using std::string;
 using std::vector;
 
 namespace kudu {
 
+DnsResolver* DnsResolver::GetSingleton() {
+  static DnsResolver* resolver = new DnsResolver();
+  return resolver;
+}
+
 DnsResolver::DnsResolver() {
   CHECK_OK(ThreadPoolBuilder("dns-resolver")
            .set_max_threads(FLAGS_dns_num_resolver_threads)
@@ -46,20 +70,137 @@ DnsResolver::~DnsResolver() {
   pool_->Shutdown();
 }
 
-namespace {
-static void DoResolution(const HostPort &hostport, vector<Sockaddr>* addresses,
-                         StatusCallback cb) {
-  cb.Run(hostport.ResolveAddresses(addresses));
-}
-} // anonymous namespace
-
 void DnsResolver::ResolveAddresses(const HostPort& hostport,
                                    vector<Sockaddr>* addresses,
                                    const StatusCallback& cb) {
-  Status s = pool_->SubmitFunc(boost::bind(&DoResolution, hostport, addresses, cb));
+  Status cached_status;
+  if (TryServeFromCache(hostport, addresses, &cached_status)) {
+    cb.Run(cached_status);
+    return;
+  }
+  Status s = pool_->SubmitFunc(boost::bind(&DnsResolver::DoResolution,
+                                           this, hostport, addresses, cb));
   if (!s.ok()) {
     cb.Run(s);
   }
 }
 
+Status DnsResolver::ResolveAddresses(const HostPort& hostport,
+                                     vector<Sockaddr>* addresses) {
+  Status cached_status;
+  if (TryServeFromCache(hostport, addresses, &cached_status)) {
+    return cached_status;
+  }
+  return ResolveAndCache(hostport, addresses);
+}
+
+bool DnsResolver::TryServeFromCache(const HostPort& hostport,
+                                    vector<Sockaddr>* addresses,
+                                    Status* status) {
+  if (FLAGS_dns_resolver_cache_ttl_sec <= 0) {
+    return false;
+  }
+  const MonoTime now = MonoTime::Now();
+  bool needs_refresh = false;
+  {
+    std::lock_guard<simple_spinlock> l(cache_lock_);
+    auto it = cache_.find(hostport.host());
+    if (it == cache_.end()) {
+      return false;
+    }
+    CacheEntry* entry = &it->second;
+    if (now > entry->expiration) {
+      cache_.erase(it);
+      return false;
+    }
+    *status = entry->status;
+    if (entry->status.ok() && addresses != nullptr) {
+      *addresses = entry->addresses;
+    }
+    if (now > entry->refresh_after && !entry->refresh_in_progress) {
+      entry->refresh_in_progress = true;
+      needs_refresh = true;
+    }
+  }
+  if (addresses != nullptr && status->ok()) {
+    for (Sockaddr& addr : *addresses) {
+      addr.set_port(hostport.port());
+    }
+  }
+  if (needs_refresh) {
+    // Refresh the entry in the background: in the meantime the cached
+    // addresses continue to be served.
+    Status s = pool_->SubmitFunc(boost::bind(&DnsResolver::DoRefresh,
+                                             this, hostport.host()));
+    if (!s.ok()) {
+      std::lock_guard<simple_spinlock> l(cache_lock_);
+      auto it = cache_.find(hostport.host());
+      if (it != cache_.end()) {
+        it->second.refresh_in_progress = false;
+      }
+    }
+  }
+  return true;
+}
+
+Status DnsResolver::ResolveAndCache(const HostPort& hostport,
+                                    vector<Sockaddr>* addresses) {
+  vector<Sockaddr> addrs;
+  Status s = hostport.ResolveAddresses(&addrs);
+  UpdateCache(hostport.host(), s, addrs);
+  if (s.ok() && addresses != nullptr) {
+    *addresses = std::move(addrs);
+  }
+  return s;
+}
+
+void DnsResolver::DoResolution(const HostPort& hostport,
+                               vector<Sockaddr>* addresses,
+                               const StatusCallback& cb) {
+  cb.Run(ResolveAndCache(hostport, addresses));
+}
+
+void DnsResolver::DoRefresh(const string& host) {
+  HostPort hostport(host, 0);
+  vector<Sockaddr> addrs;
+  Status s = hostport.ResolveAddresses(&addrs);
+  UpdateCache(host, s, addrs);
+}
+
+void DnsResolver::UpdateCache(const string& host,
+                              const Status& status,
+                              const vector<Sockaddr>& addrs) {
+  int64_t ttl_sec = status.ok() ? FLAGS_dns_resolver_cache_ttl_sec
+                                : FLAGS_dns_resolver_negative_cache_ttl_sec;
+  const MonoTime now = MonoTime::Now();
+  std::lock_guard<simple_spinlock> l(cache_lock_);
+  if (ttl_sec <= 0) {
+    cache_.erase(host);
+    return;
+  }
+  auto it = cache_.find(host);
+  if (!status.ok() && it != cache_.end() && it->second.status.ok() &&
+      now < it->second.expiration) {
+    // A background refresh failed but the previously resolved addresses
+    // haven't expired yet. Keep serving them in case this is a transient
+    // DNS blip, and throttle further refresh attempts.
+    it->second.refresh_in_progress = false;
+    it->second.refresh_after = now + MonoDelta::FromSeconds(ttl_sec);
+    return;
+  }
+  CacheEntry entry;
+  entry.status = status;
+  if (status.ok()) {
+    entry.addresses = addrs;
+    for (Sockaddr& addr : entry.addresses) {
+      addr.set_port(0);
+    }
+  }
+  entry.expiration = now + MonoDelta::FromSeconds(ttl_sec);
+  // Negative entries are not refreshed: retries re-resolve on expiration.
+  entry.refresh_after = status.ok() ? now + MonoDelta::FromSeconds(ttl_sec / 2.0)
+                                    : entry.expiration;
+  cache_[host] = std::move(entry);
+}
+
 } // namespace kudu
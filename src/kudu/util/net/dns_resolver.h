@@ -17,21 +17,36 @@
 #ifndef KUDU_UTIL_NET_DNS_RESOLVER_H
 #define KUDU_UTIL_NET_DNS_RESOLVER_H
 
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "kudu/gutil/gscoped_ptr.h"
 #include "kudu/gutil/macros.h"
+#include "kudu/util/locks.h"
+#include "kudu/util/monotime.h"
+#include "kudu/util/net/sockaddr.h"
+#include "kudu/util/status.h"
 #include "kudu/util/status_callback.h"
 
 namespace kudu {
 
 class HostPort;
-class Sockaddr;
 class ThreadPool;
 
 // DNS Resolver which supports async address resolution.
+//
+// Resolutions are cached with a TTL (see --dns_resolver_cache_ttl_sec):
+// both successful and failed lookups are cached, and entries for
+// steadily-used hosts are refreshed in the background before they expire,
+// so repeated resolutions of stable hostnames are served from memory.
 class DnsResolver {
  public:
+  // Return a process-wide shared resolver instance, for callers which have
+  // no natural place to own one of their own (e.g. consensus proxy
+  // creation). Never destroyed.
+  static DnsResolver* GetSingleton();
+
   DnsResolver();
   ~DnsResolver();
 
@@ -46,15 +61,67 @@ class DnsResolver {
   //
   // NOTE: the callback should be fast since it is called by the DNS
   // resolution thread.
-  // NOTE: in some rare cases, the callback may also be called inline
-  // from this function call, on the caller's thread.
+  // NOTE: the callback may also be called inline from this function call,
+  // on the caller's thread, if the result is served from the cache.
   void ResolveAddresses(const HostPort& hostport,
                         std::vector<Sockaddr>* addresses,
                         const StatusCallback& cb);
 
+  // Synchronous version of the above: serves the result from the cache when
+  // possible, and otherwise resolves on the caller's thread.
+  Status ResolveAddresses(const HostPort& hostport,
+                          std::vector<Sockaddr>* addresses);
+
  private:
+  // A cached resolution (or failed resolution) for a single host. The cached
+  // addresses carry a zero port; the requested port is filled in whenever
+  // the entry is served.
+  struct CacheEntry {
+    // The outcome of the resolution. Failed resolutions are cached too
+    // ("negative caching"), with their own, typically much shorter, TTL.
+    Status status;
+    std::vector<Sockaddr> addresses;
+    // The time at which the entry stops being served.
+    MonoTime expiration;
+    // The time at which the entry becomes eligible for a background
+    // refresh. Refreshing before expiration means steadily-used hosts keep
+    // being served from the cache without ever blocking on resolution.
+    MonoTime refresh_after;
+    // Whether a background refresh of this host has been submitted.
+    bool refresh_in_progress = false;
+  };
+
+  // Serve a resolution from the cache, if a live entry for the host exists.
+  // Returns true if served, setting '*status' (and '*addresses' on success),
+  // and possibly kicking off a background refresh of the entry.
+  bool TryServeFromCache(const HostPort& hostport,
+                         std::vector<Sockaddr>* addresses,
+                         Status* status);
+
+  // Resolve on the caller's thread and insert the result into the cache.
+  Status ResolveAndCache(const HostPort& hostport,
+                         std::vector<Sockaddr>* addresses);
+
+  // Task run on 'pool_' for async resolutions which missed the cache.
+  void DoResolution(const HostPort& hostport,
+                    std::vector<Sockaddr>* addresses,
+                    const StatusCallback& cb);
+
+  // Task run on 'pool_' to refresh the cached entry for 'host'.
+  void DoRefresh(const std::string& host);
+
+  // Insert the outcome of a resolution of 'host' into the cache. If a
+  // refresh of a still-live positive entry failed, the old addresses are
+  // kept instead, in case the failure is just a transient DNS blip.
+  void UpdateCache(const std::string& host,
+                   const Status& status,
+                   const std::vector<Sockaddr>& addrs);
+
   gscoped_ptr<ThreadPool> pool_;
 
+  simple_spinlock cache_lock_;
+  std::unordered_map<std::string, CacheEntry> cache_;
+
   DISALLOW_COPY_AND_ASSIGN(DnsResolver);
 };
 
@@ -17,6 +17,8 @@
 #ifndef IMPALA_RLE_ENCODING_H
 #define IMPALA_RLE_ENCODING_H
 
+#include <algorithm>
+
 #include <glog/logging.h>
 
 #include "kudu/gutil/port.h"
@@ -102,6 +104,12 @@ class RleDecoder {
   // Gets the next value.  Returns false if there are no more.
   bool Get(T* val);
 
+  // Gets up to 'count' consecutive values, bulk-filling repeated runs and
+  // bulk-unpacking literal runs. Returns the number of values read, which is
+  // less than 'count' only when the stream is exhausted. Invalidates
+  // RewindOne().
+  size_t GetBatch(T* vals, size_t count);
+
   // Seek to the previous value.
   void RewindOne();
 
@@ -271,6 +279,29 @@ inline bool RleDecoder<T>::Get(T* val) {
   return true;
 }
 
+template<typename T>
+inline size_t RleDecoder<T>::GetBatch(T* vals, size_t count) {
+  DCHECK(bit_reader_.is_initialized());
+  size_t ret = 0;
+  while (ret < count && ReadHeader()) {
+    if (PREDICT_TRUE(repeat_count_ > 0)) {
+      size_t n = std::min<size_t>(repeat_count_, count - ret);
+      std::fill_n(&vals[ret], n, static_cast<T>(current_value_));
+      repeat_count_ -= n;
+      ret += n;
+    } else {
+      DCHECK_GT(literal_count_, 0);
+      size_t n = std::min<size_t>(literal_count_, count - ret);
+      bool result = bit_reader_.GetValues(bit_width_, &vals[ret], static_cast<int>(n));
+      DCHECK(result);
+      literal_count_ -= n;
+      ret += n;
+    }
+  }
+  rewind_state_ = CANT_REWIND;
+  return ret;
+}
+
 template<typename T>
 inline void RleDecoder<T>::RewindOne() {
   DCHECK(bit_reader_.is_initialized());
@@ -419,9 +450,7 @@ inline void RleEncoder<T>::FlushLiteralRun(bool update_indicator_byte) {
   }
 
   // Write all the buffered values as bit packed literals
-  for (int i = 0; i < num_buffered_values_; ++i) {
-    bit_writer_.PutValue(buffered_values_[i], bit_width_);
-  }
+  bit_writer_.PutValues(buffered_values_, num_buffered_values_, bit_width_);
   num_buffered_values_ = 0;
 
   if (update_indicator_byte) {
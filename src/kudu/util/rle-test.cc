@@ -543,4 +543,71 @@ TEST_F(TestRle, TestSkip) {
 
   encoder.Flush();
 }
+
+// Round-trip bit-packed values through the bulk PutValues()/GetValues()
+// APIs, which use the BMI2 pack/unpack kernels for power-of-2 bit widths
+// when the CPU supports them.
+TEST(BitArray, TestBulkValues) {
+  SeedRandom();
+  for (int width = 1; width <= kMaxWidth; ++width) {
+    const int num_vals = 777; // deliberately not a multiple of 8
+    const uint64_t mod = width == 64 ? 0 : 1ULL << width;
+    vector<uint64_t> values(num_vals);
+    for (int i = 0; i < num_vals; ++i) {
+      uint64_t v = (static_cast<uint64_t>(random()) << 32) | random();
+      values[i] = mod == 0 ? v : v % mod;
+    }
+
+    faststring buffer;
+    BitWriter writer(&buffer);
+    // Mix bulk and single-value writes so groups start at unaligned offsets.
+    writer.PutValue(values[0], width);
+    writer.PutValues(values.data() + 1, num_vals - 1, width);
+    writer.Flush();
+
+    BitReader reader(buffer.data(), writer.bytes_written());
+    vector<uint64_t> decoded(num_vals);
+    ASSERT_TRUE(reader.GetValue(width, &decoded[0]));
+    ASSERT_TRUE(reader.GetValues(width, decoded.data() + 1, num_vals - 1));
+    for (int i = 0; i < num_vals; ++i) {
+      ASSERT_EQ(values[i], decoded[i]) << "width=" << width << " i=" << i;
+    }
+  }
+}
+
+// Round-trip random sequences with a mix of literal and repeated runs
+// through the batched GetBatch() API, reading in odd-sized chunks so
+// batches straddle run boundaries.
+TEST_F(TestRle, TestGetBatch) {
+  SeedRandom();
+  for (int width = 1; width <= kMaxWidth; ++width) {
+    const uint64_t mod = width == 64 ? 0 : 1ULL << width;
+    vector<uint64_t> values;
+    while (values.size() < 1000) {
+      uint64_t v = (static_cast<uint64_t>(random()) << 32) | random();
+      if (mod != 0) v %= mod;
+      // Bias towards short runs, with occasional runs long enough to be
+      // encoded as repeated runs.
+      int run_length = (random() % 4 == 0) ? random() % 30 + 1 : 1;
+      values.insert(values.end(), run_length, v);
+    }
+
+    faststring buffer;
+    RleEncoder<uint64_t> encoder(&buffer, width);
+    for (uint64_t v : values) {
+      encoder.Put(v);
+    }
+    int encoded_len = encoder.Flush();
+
+    RleDecoder<uint64_t> decoder(buffer.data(), encoded_len, width);
+    vector<uint64_t> decoded(values.size());
+    size_t total = 0;
+    while (total < values.size()) {
+      size_t batch = std::min<size_t>(random() % 17 + 1, values.size() - total);
+      ASSERT_EQ(batch, decoder.GetBatch(&decoded[total], batch));
+      total += batch;
+    }
+    ASSERT_EQ(values, decoded) << "width=" << width;
+  }
+}
 } // namespace kudu
@@ -32,6 +32,33 @@ namespace kudu {
 
 typedef SliceMap<int>::type MySliceMap;
 
+// Verify the three-way comparison for strings of various lengths around the
+// 8-byte word size used by the underlying comparison routine, including
+// pairs which differ within a word, across a word boundary, and only in
+// length.
+TEST(SliceTest, TestCompare) {
+  auto sign = [](int x) { return x < 0 ? -1 : (x > 0 ? 1 : 0); };
+  const string kStrings[] = {
+    "",
+    "a",
+    "ab",
+    "abcdefg",
+    "abcdefgh",
+    string("abcdefgh\x00", 9),
+    "abcdefghi",
+    "abcdefghijklmnop",
+    "abcdefghijklmnoq",
+    "abcdefgi",
+    "b",
+  };
+  for (const string& a : kStrings) {
+    for (const string& b : kStrings) {
+      SCOPED_TRACE(a + " vs " + b);
+      ASSERT_EQ(sign(a.compare(b)), sign(Slice(a).compare(Slice(b))));
+    }
+  }
+}
+
 TEST(SliceTest, TestSliceMap) {
   MySliceMap my_map;
   Slice a("a");
@@ -47,6 +47,34 @@ TEST(StatusTest, TestMemoryUsage) {
       "file error", "some other thing", ENOTDIR).memory_footprint_excluding_this(), 0);
 }
 
+TEST(StatusTest, TestInternedState) {
+  // Statuses constructed without a message or POSIX code share static
+  // interned state and report no heap usage.
+  Status not_found = Status::NotFound("");
+  ASSERT_TRUE(not_found.IsNotFound());
+  ASSERT_EQ(-1, not_found.posix_code());
+  ASSERT_EQ("", not_found.message().ToString());
+  ASSERT_EQ("Not found: ", not_found.ToString());
+  ASSERT_EQ(0, not_found.memory_footprint_excluding_this());
+
+  // Copies share the same interned state and are safe to destroy
+  // independently.
+  {
+    Status copy = not_found;
+    ASSERT_TRUE(copy.IsNotFound());
+    ASSERT_EQ(0, copy.memory_footprint_excluding_this());
+    copy = Status::Incomplete("");
+    ASSERT_TRUE(copy.IsIncomplete());
+  }
+  ASSERT_TRUE(not_found.IsNotFound());
+
+  // Cloning with an added message allocates as usual.
+  Status with_msg = not_found.CloneAndPrepend("could not find foo");
+  ASSERT_TRUE(with_msg.IsNotFound());
+  ASSERT_EQ("Not found: could not find foo", with_msg.ToString());
+  ASSERT_GT(with_msg.memory_footprint_excluding_this(), 0);
+}
+
 TEST(StatusTest, TestMoveConstructor) {
   // OK->OK move should do nothing.
   {
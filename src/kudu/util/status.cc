@@ -14,6 +14,31 @@
 
 namespace kudu {
 
+// One interned state entry per non-OK code, in code order: a zero message
+// length, the code byte, and a POSIX code of -1.
+#define INTERNED_STATE(c) '\0', '\0', '\0', '\0', static_cast<char>(c), '\xff', '\xff'
+const char Status::kInternedStates[] = {
+  INTERNED_STATE(kNotFound),
+  INTERNED_STATE(kCorruption),
+  INTERNED_STATE(kNotSupported),
+  INTERNED_STATE(kInvalidArgument),
+  INTERNED_STATE(kIOError),
+  INTERNED_STATE(kAlreadyPresent),
+  INTERNED_STATE(kRuntimeError),
+  INTERNED_STATE(kNetworkError),
+  INTERNED_STATE(kIllegalState),
+  INTERNED_STATE(kNotAuthorized),
+  INTERNED_STATE(kAborted),
+  INTERNED_STATE(kRemoteError),
+  INTERNED_STATE(kServiceUnavailable),
+  INTERNED_STATE(kTimedOut),
+  INTERNED_STATE(kUninitialized),
+  INTERNED_STATE(kConfigurationError),
+  INTERNED_STATE(kIncomplete),
+  INTERNED_STATE(kEndOfFile),
+};
+#undef INTERNED_STATE
+
 const char* Status::CopyState(const char* state) {
   uint32_t size;
   strings::memcpy_inlined(&size, state, sizeof(size));
@@ -25,6 +50,11 @@ const char* Status::CopyState(const char* state) {
 Status::Status(Code code, const Slice& msg, const Slice& msg2,
                int16_t posix_code) {
   DCHECK(code != kOk);
+  if (msg.empty() && msg2.empty() && posix_code == -1) {
+    // Messageless statuses share interned state rather than allocating.
+    state_ = &kInternedStates[(code - 1) * kInternedStateSize];
+    return;
+  }
   const uint32_t len1 = msg.size();
   const uint32_t len2 = msg2.size();
   const uint32_t size = len1 + (len2 ? (2 + len2) : 0);
@@ -161,7 +191,7 @@ Status Status::CloneAndAppend(const Slice& msg) const {
 }
 
 size_t Status::memory_footprint_excluding_this() const {
-  return state_ ? kudu_malloc_usable_size(state_) : 0;
+  return (state_ && !IsInterned(state_)) ? kudu_malloc_usable_size(state_) : 0;
 }
 
 size_t Status::memory_footprint_including_this() const {
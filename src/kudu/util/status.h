@@ -147,7 +147,7 @@ class KUDU_EXPORT Status {
   /// Create an object representing success status.
   Status() : state_(NULL) { }
 
-  ~Status() { delete[] state_; }
+  ~Status() { FreeState(state_); }
 
   /// Copy the specified status.
   ///
@@ -415,12 +415,18 @@ class KUDU_EXPORT Status {
   size_t memory_footprint_including_this() const;
 
  private:
-  // OK status has a NULL state_.  Otherwise, state_ is a new[] array
-  // of the following form:
+  // OK status has a NULL state_.  Otherwise, state_ is an array of the
+  // following form:
   //    state_[0..3] == length of message
   //    state_[4]    == code
   //    state_[5..6] == posix_code
   //    state_[7..]  == message
+  //
+  // The array is heap-allocated with new[], except for statuses created with
+  // an empty message and no POSIX code: those share a static per-code entry
+  // in 'kInternedStates' and never touch the allocator. Such statuses are
+  // common on hot control-flow paths (e.g. NotFound returned by bloom filter
+  // misses, or Incomplete at block boundaries in the cfile readers).
   const char* state_;
 
   enum Code {
@@ -451,6 +457,31 @@ class KUDU_EXPORT Status {
   };
   COMPILE_ASSERT(sizeof(Code) == 4, code_enum_size_is_part_of_abi);
 
+  enum {
+    // Size in bytes of one interned state entry: the 7-byte state header
+    // above with a zero-length message.
+    kInternedStateSize = 7,
+    // One entry per non-OK code, indexed by 'code - 1'.
+    kNumInternedStates = kEndOfFile
+  };
+
+  // The static interned state entries, defined in status.cc.
+  static const char kInternedStates[kNumInternedStates * kInternedStateSize];
+
+  // Return true iff 'state' points into 'kInternedStates' and thus must be
+  // neither freed nor deep-copied.
+  static bool IsInterned(const char* state) {
+    return state >= kInternedStates &&
+           state < kInternedStates + sizeof(kInternedStates);
+  }
+
+  // Free 'state' unless it is NULL or interned.
+  static void FreeState(const char* state) {
+    if (state != NULL && !IsInterned(state)) {
+      delete[] state;
+    }
+  }
+
   Code code() const {
     return (state_ == NULL) ? kOk : static_cast<Code>(state_[4]);
   }
@@ -460,15 +491,18 @@ class KUDU_EXPORT Status {
 };
 
 inline Status::Status(const Status& s) {
-  state_ = (s.state_ == NULL) ? NULL : CopyState(s.state_);
+  state_ = (s.state_ == NULL || IsInterned(s.state_)) ?
+      s.state_ : CopyState(s.state_);
 }
 
 inline Status& Status::operator=(const Status& s) {
   // The following condition catches both aliasing (when this == &s),
-  // and the common case where both s and *this are OK.
+  // and the common case where both s and *this are OK. It also catches
+  // copies between statuses sharing the same interned state.
   if (state_ != s.state_) {
-    delete[] state_;
-    state_ = (s.state_ == NULL) ? NULL : CopyState(s.state_);
+    FreeState(state_);
+    state_ = (s.state_ == NULL || IsInterned(s.state_)) ?
+        s.state_ : CopyState(s.state_);
   }
   return *this;
 }
@@ -480,7 +514,7 @@ inline Status::Status(Status&& s) : state_(s.state_) {
 
 inline Status& Status::operator=(Status&& s) {
   if (state_ != s.state_) {
-    delete[] state_;
+    FreeState(state_);
     state_ = s.state_;
     s.state_ = nullptr;
   }
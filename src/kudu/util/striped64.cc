@@ -18,6 +18,7 @@
 #include "kudu/util/striped64.h"
 
 #include <mm_malloc.h>
+#include <sched.h>
 #include <unistd.h>
 
 #include <cstdlib>
@@ -146,19 +147,37 @@ void Striped64::InternalReset(int64_t initial_value) {
   }
 }
 
+namespace {
+
+// Returns the index of the cell the calling thread should update. On Linux
+// this is the CPU the thread is currently running on, which makes the cells
+// behave as per-CPU slots: an atomic add to the slot can't fail, and two
+// threads only share a slot while they're running on (or recently migrated
+// off) the same CPU. Platforms without sched_getcpu() fall back to the
+// per-thread striping hashcode. Callers mask the result to the table size.
+uint64_t CurrentCellIndex() {
+#if defined(__APPLE__) || defined(THREAD_SANITIZER)
+  return Striped64::get_tls_hashcode();
+#else
+  int cpu = sched_getcpu();
+  if (PREDICT_FALSE(cpu < 0)) {
+    return Striped64::get_tls_hashcode();
+  }
+  return cpu;
+#endif
+}
+
+} // anonymous namespace
+
 void LongAdder::IncrementBy(int64_t x) {
-  // Use hash table if present. If that fails, call RetryUpdate to rehash and retry.
-  // If no hash table, try to CAS the base counter. If that fails, RetryUpdate to init the table.
+  // Use the cell table if present. If no cell table, try to CAS the base
+  // counter; if that fails, RetryUpdate initializes the table.
   const int32_t n = base::subtle::Acquire_Load(&num_cells_);
   if (n > 0) {
-    Cell *cell = &(cells_[(n - 1) & get_tls_hashcode()]);
+    Cell *cell = &(cells_[(n - 1) & CurrentCellIndex()]);
     DCHECK_EQ(0, reinterpret_cast<const uintptr_t>(cell) & (sizeof(Cell) - 1))
         << " unaligned Cell not allowed for Striped64" << std::endl;
-    const int64_t old = cell->value_.Load();
-    if (!cell->CompareAndSet(old, old + x)) {
-      // When we hit a hash table contention, signal RetryUpdate to rehash.
-      RetryUpdate(x, kRehash);
-    }
+    cell->value_.IncrementBy(x);
   } else {
     int64_t b = base_.value_.Load();
     if (!base_.CompareAndSet(b, b + x)) {
@@ -78,6 +78,12 @@ class Cell {
 // Striped64's accessed by the thread. This is good, since contention on one Striped64 is
 // indicative of contention elsewhere too.
 //
+// LongAdder additionally takes advantage of the fact that its update is a plain addition:
+// once the cell table exists, it picks the cell for the CPU the thread is currently running
+// on (where the platform supports sched_getcpu()) and applies an atomic increment, which
+// cannot fail and thus needs no rehash-and-retry loop. This makes the cells behave as
+// per-CPU slots, with a full-table sum at read time.
+//
 // The hashtable is statically sized to the nearest power of 2 greater than or equal to the
 // number of CPUs. This is sufficient, since this guarantees the existence of a perfect hash
 // function. Due to the random rehashing, the threads should eventually converge to this function.
@@ -93,6 +99,11 @@ class Striped64 {
   Striped64();
   virtual ~Striped64();
 
+  // Returns this thread's striping hashcode, generating and storing one if
+  // the thread doesn't yet have one. Exposed so that other sharded data
+  // structures (e.g. HdrHistogram) can map threads onto shards the same way.
+  static uint64_t get_tls_hashcode();
+
  protected:
 
   enum Rehash {
@@ -130,9 +141,6 @@ class Striped64 {
   striped64::internal::Cell* cells_;
   int32_t num_cells_;
 
- protected:
-  static uint64_t get_tls_hashcode();
-
  private:
   // Static hash code per-thread. Shared across all instances to limit thread-local pollution.
   // Also, if a thread hits a collision on one Striped64, it's also likely to collide on
@@ -457,25 +457,46 @@ Status ThreadPool::Submit(shared_ptr<Runnable> r) {
 
 Status ThreadPool::DoSubmit(shared_ptr<Runnable> r, ThreadPoolToken* token) {
   DCHECK(token);
-  MonoTime submit_time = MonoTime::Now();
 
-  MutexLock guard(lock_);
-  if (PREDICT_FALSE(!pool_status_.ok())) {
-    return pool_status_;
+  // Construct the task before acquiring the lock: capturing the current
+  // trace and timestamp needs no pool state, and the submission path is hot
+  // enough on the apply and prepare pools that the critical section should
+  // only cover the queue and bookkeeping updates themselves.
+  Task task;
+  task.runnable = std::move(r);
+  task.trace = Trace::CurrentTrace();
+  // Need to AddRef, since the thread which submitted the task may go away,
+  // and we don't want the trace to be destructed while waiting in the queue.
+  if (task.trace) {
+    task.trace->AddRef();
   }
+  task.submit_time = MonoTime::Now();
 
-  if (PREDICT_FALSE(!token->MaySubmitNewTasks())) {
-    return Status::ServiceUnavailable("Thread pool token was shut down");
+  MutexLock guard(lock_);
+  Status submit_status = pool_status_;
+  if (PREDICT_TRUE(submit_status.ok())) {
+    if (PREDICT_FALSE(!token->MaySubmitNewTasks())) {
+      submit_status = Status::ServiceUnavailable("Thread pool token was shut down");
+    } else {
+      // Size limit check.
+      int64_t capacity_remaining = static_cast<int64_t>(max_threads_) - active_threads_ +
+                                   static_cast<int64_t>(max_queue_size_) - total_queued_tasks_;
+      if (capacity_remaining < 1) {
+        submit_status = Status::ServiceUnavailable(
+            Substitute("Thread pool is at capacity ($0/$1 tasks running, $2/$3 tasks queued)",
+                       num_threads_ + num_threads_pending_start_, max_threads_,
+                       total_queued_tasks_, max_queue_size_));
+      }
+    }
   }
-
-  // Size limit check.
-  int64_t capacity_remaining = static_cast<int64_t>(max_threads_) - active_threads_ +
-                               static_cast<int64_t>(max_queue_size_) - total_queued_tasks_;
-  if (capacity_remaining < 1) {
-    return Status::ServiceUnavailable(
-        Substitute("Thread pool is at capacity ($0/$1 tasks running, $2/$3 tasks queued)",
-                   num_threads_ + num_threads_pending_start_, max_threads_,
-                   total_queued_tasks_, max_queue_size_));
+  if (PREDICT_FALSE(!submit_status.ok())) {
+    // Drop the trace reference outside the lock; releasing it may destroy
+    // the trace.
+    guard.Unlock();
+    if (task.trace) {
+      task.trace->Release();
+    }
+    return submit_status;
   }
 
   // Should we create another thread?
@@ -504,24 +525,16 @@ Status ThreadPool::DoSubmit(shared_ptr<Runnable> r, ThreadPoolToken* token) {
     num_threads_pending_start_++;
   }
 
-  Task task;
-  task.runnable = std::move(r);
-  task.trace = Trace::CurrentTrace();
-  // Need to AddRef, since the thread which submitted the task may go away,
-  // and we don't want the trace to be destructed while waiting in the queue.
-  if (task.trace) {
-    task.trace->AddRef();
-  }
-  task.submit_time = submit_time;
-
   // Add the task to the token's queue.
   ThreadPoolToken::State state = token->state();
   DCHECK(state == ThreadPoolToken::State::IDLE ||
          state == ThreadPoolToken::State::RUNNING);
   token->entries_.emplace_back(std::move(task));
+  bool task_runnable = false;
   if (state == ThreadPoolToken::State::IDLE ||
       token->mode() == ExecutionMode::CONCURRENT) {
     queue_.emplace_back(token);
+    task_runnable = true;
     if (state == ThreadPoolToken::State::IDLE) {
       token->Transition(ThreadPoolToken::State::RUNNING);
     }
@@ -530,7 +543,12 @@ Status ThreadPool::DoSubmit(shared_ptr<Runnable> r, ThreadPoolToken* token) {
 
   guard.Unlock();
 
-  not_empty_.Signal();
+  // Only wake a worker if this submission made a new task runnable. A
+  // submission to an already-running SERIAL token doesn't go on the run
+  // queue, so signalling would just wake a thread to find nothing to do.
+  if (task_runnable) {
+    not_empty_.Signal();
+  }
 
   if (metrics_.queue_length_histogram) {
     metrics_.queue_length_histogram->Increment(length_at_submit);
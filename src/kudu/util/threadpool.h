@@ -234,6 +234,14 @@ class ThreadPool {
     return num_threads_ + num_threads_pending_start_;
   }
 
+  // Return the number of tasks currently waiting in the pool's queues.
+  // Naturally the result may be stale by the time the caller acts on it;
+  // this is only suitable as a load heuristic.
+  int num_queued_tasks() const {
+    MutexLock l(lock_);
+    return total_queued_tasks_;
+  }
+
  private:
   FRIEND_TEST(ThreadPoolTest, TestThreadPoolWithNoMinimum);
   FRIEND_TEST(ThreadPoolTest, TestVariableSizeThreadPool);
@@ -73,4 +73,27 @@ TEST_F(ThrottlerTest, TestBurst) {
   ASSERT_FALSE(t0.Take(now, 1, 1));
 }
 
+TEST_F(ThrottlerTest, TestRefund) {
+  // Check that refunded tokens can be taken again.
+  MonoTime now = MonoTime::Now();
+  Throttler t0(now, 1000, 1000*1000, 1);
+  // Fill up bucket
+  now += MonoDelta::FromMilliseconds(2000);
+  for (int i = 0; i < 100; i++) {
+    ASSERT_TRUE(t0.Take(now, 1, 1000));
+  }
+  ASSERT_FALSE(t0.Take(now, 1, 1000));
+  t0.Refund(1, 1000);
+  ASSERT_TRUE(t0.Take(now, 1, 1000));
+  ASSERT_FALSE(t0.Take(now, 1, 1000));
+  // A refund never exceeds the burst capacity of the bucket.
+  for (int i = 0; i < 300; i++) {
+    t0.Refund(1, 1000);
+  }
+  for (int i = 0; i < 100; i++) {
+    ASSERT_TRUE(t0.Take(now, 1, 1000));
+  }
+  ASSERT_FALSE(t0.Take(now, 1, 1000));
+}
+
 } // namespace kudu
@@ -44,6 +44,11 @@ class Throttler {
   // Return false if there are not enough tokens, and operation is throttled.
   bool Take(MonoTime now, uint64_t op, uint64_t byte);
 
+  // Return 'op' operation tokens and 'byte' byte tokens to the bucket, up to
+  // its burst capacity. Used to undo a successful Take() when a subsequent
+  // acquisition from another throttler in a hierarchy fails.
+  void Refund(uint64_t op, uint64_t byte);
+
  private:
   void Refill(MonoTime now);
 
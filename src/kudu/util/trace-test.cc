@@ -85,6 +85,26 @@ TEST_F(TraceTest, TestBasic) {
             result);
 }
 
+TEST_F(TraceTest, TestNullTraceTo) {
+  // TRACE_TO() must be a no-op, and must not evaluate its substitutions,
+  // when handed a NULL trace (e.g. for a call not sampled for tracing).
+  Trace* t = nullptr;
+  int evaluations = 0;
+  TRACE_TO(t, "this should not be evaluated: $0", ++evaluations);
+  ASSERT_EQ(0, evaluations);
+}
+
+TEST_F(TraceTest, TestShouldSample) {
+  // The first call on a thread is always sampled; after that, exactly one
+  // in every 'period' calls is.
+  ASSERT_TRUE(Trace::ShouldSample(10));
+  int sampled = 0;
+  for (int i = 0; i < 100; i++) {
+    sampled += Trace::ShouldSample(10) ? 1 : 0;
+  }
+  ASSERT_EQ(10, sampled);
+}
+
 TEST_F(TraceTest, TestAttach) {
   scoped_refptr<Trace> traceA(new Trace);
   scoped_refptr<Trace> traceB(new Trace);
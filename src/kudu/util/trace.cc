@@ -30,6 +30,7 @@
 
 #include <glog/logging.h>
 
+#include "kudu/gutil/port.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/gutil/walltime.h"
 #include "kudu/util/memory/arena.h"
@@ -255,6 +256,21 @@ void Trace::DumpCurrentTrace() {
   t->Dump(&std::cerr, true);
 }
 
+namespace {
+// Countdown until the next sampled call on this thread. Starts at zero so
+// that the first call on each thread is sampled.
+__thread int32_t tls_sample_countdown;
+} // anonymous namespace
+
+bool Trace::ShouldSample(int32_t period) {
+  DCHECK_GT(period, 0);
+  if (PREDICT_TRUE(--tls_sample_countdown > 0)) {
+    return false;
+  }
+  tls_sample_countdown = period;
+  return true;
+}
+
 void Trace::AddChildTrace(StringPiece label, Trace* child_trace) {
   CHECK(arena_->RelocateStringPiece(label, &label));
 
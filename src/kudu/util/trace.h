@@ -17,6 +17,7 @@
 #ifndef KUDU_UTIL_TRACE_H
 #define KUDU_UTIL_TRACE_H
 
+#include <cstdint>
 #include <iosfwd>
 #include <string>
 #include <utility>
@@ -56,8 +57,16 @@ class Trace;
   } while (0);
 
 // Like the above, but takes the trace pointer as an explicit argument.
+// If the pointer is NULL (e.g. because the call wasn't sampled for
+// tracing) this does nothing and does not evaluate the substitutions.
 #define TRACE_TO(trace, format, substitutions...) \
-  (trace)->SubstituteAndTrace(__FILE__, __LINE__, (format), ##substitutions)
+  do { \
+    kudu::Trace* _trace = (trace); \
+    if (_trace) { \
+      _trace->SubstituteAndTrace(__FILE__, __LINE__, (format),  \
+        ##substitutions); \
+    } \
+  } while (0)
 
 // Increment a counter associated with the current trace.
 //
@@ -198,6 +207,14 @@ class Trace : public RefCountedThreadSafe<Trace> {
   // 'call kudu::Trace::DumpCurrentTrace();'.
   static void DumpCurrentTrace();
 
+  // Returns true approximately once in every 'period' calls made on any
+  // given thread. This uses a thread-local countdown, so the common case
+  // is a single decrement and a predictable branch, making it cheap
+  // enough to decide per-request whether to capture a trace at all.
+  //
+  // 'period' must be positive.
+  static bool ShouldSample(int32_t period);
+
   TraceMetrics* metrics() {
     return &metrics_;
   }
@@ -0,0 +1,258 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/util/twotier_cache.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "kudu/gutil/gscoped_ptr.h"
+#include "kudu/gutil/macros.h"
+#include "kudu/gutil/port.h"
+#include "kudu/gutil/ref_counted.h"
+#include "kudu/util/cache.h"
+#include "kudu/util/cache_metrics.h"
+#include "kudu/util/faststring.h"
+#include "kudu/util/flag_tags.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+#include "kudu/util/threadpool.h"
+
+DEFINE_int32(cache_demotion_max_queue_size, 512,
+             "Maximum number of entries queued for demotion from the fast "
+             "tier to the slow tier of a two-tier cache. When the queue is "
+             "full, further evicted entries are dropped rather than demoted.");
+TAG_FLAG(cache_demotion_max_queue_size, advanced);
+TAG_FLAG(cache_demotion_max_queue_size, experimental);
+
+using std::shared_ptr;
+using std::string;
+
+namespace kudu {
+
+namespace {
+
+class TwoTierCache : public Cache {
+ public:
+  TwoTierCache(Cache* fast_cache, Cache* slow_cache, const string& id)
+      : fast_cache_(fast_cache),
+        slow_cache_(slow_cache),
+        demotion_callback_(this, nullptr, /* one_shot= */ false) {
+    CHECK_OK(ThreadPoolBuilder(id + "-demotion")
+             .set_min_threads(0)
+             .set_max_threads(1)
+             .set_max_queue_size(FLAGS_cache_demotion_max_queue_size)
+             .Build(&demotion_pool_));
+  }
+
+  virtual ~TwoTierCache() {
+    // Shut down the demotion thread before the fast tier is destroyed:
+    // entries freed during its destruction would otherwise all be queued
+    // for demotion.
+    demotion_pool_->Shutdown();
+  }
+
+  virtual Handle* Lookup(const Slice& key, CacheBehavior caching) OVERRIDE {
+    Handle* h = fast_cache_->Lookup(key, caching);
+    if (h != nullptr) {
+      return h;
+    }
+    Handle* slow_h = slow_cache_->Lookup(key, caching);
+    if (slow_h == nullptr) {
+      return nullptr;
+    }
+    // Promote the entry into the fast tier and serve it from there, so that
+    // repeated accesses read fast-tier memory. The copy is the same one
+    // needed to read the value out of the slow tier; the slow-tier copy is
+    // left to age out via LRU.
+    Slice value = slow_cache_->Value(slow_h);
+    PendingHandle* ph = fast_cache_->Allocate(key, value.size(), value.size());
+    if (PREDICT_FALSE(ph == nullptr)) {
+      // The fast tier could not free up space (e.g. too many pinned
+      // entries); treat the lookup as a miss rather than handing out a
+      // slow-tier handle.
+      slow_cache_->Release(slow_h);
+      return nullptr;
+    }
+    memcpy(fast_cache_->MutableValue(ph), value.data(), value.size());
+    slow_cache_->Release(slow_h);
+    if (metrics_) {
+      metrics_->slow_tier_hits->Increment();
+      metrics_->promotions->Increment();
+    }
+    return fast_cache_->Insert(ph, &demotion_callback_);
+  }
+
+  virtual void Release(Handle* handle) OVERRIDE {
+    fast_cache_->Release(handle);
+  }
+
+  virtual Slice Value(Handle* handle) OVERRIDE {
+    return fast_cache_->Value(handle);
+  }
+
+  virtual void Erase(const Slice& key) OVERRIDE {
+    fast_cache_->Erase(key);
+    slow_cache_->Erase(key);
+  }
+
+  virtual void SetMetrics(const scoped_refptr<MetricEntity>& metric_entity) OVERRIDE {
+    metrics_.reset(new TwoTierCacheMetrics(metric_entity));
+    // Both tiers record into the same top-level cache metrics; the
+    // two-tier metrics above break out the tier-crossing traffic.
+    fast_cache_->SetMetrics(metric_entity);
+    slow_cache_->SetMetrics(metric_entity);
+  }
+
+  virtual void SetFrequencyBasedAdmission(bool enabled) OVERRIDE {
+    fast_cache_->SetFrequencyBasedAdmission(enabled);
+    slow_cache_->SetFrequencyBasedAdmission(enabled);
+  }
+
+  virtual void UpdateCapacity(size_t capacity) OVERRIDE {
+    // Only the DRAM tier competes with other consumers for process memory;
+    // the NVM tier's capacity stays fixed.
+    fast_cache_->UpdateCapacity(capacity);
+  }
+
+  virtual int RegisterPartition(int weight) OVERRIDE {
+    // Register on both tiers so that the ids agree; the slow tier may
+    // ignore partitioning (e.g. NVM), in which case only the fast tier
+    // enforces the share targets.
+    int id = fast_cache_->RegisterPartition(weight);
+    slow_cache_->RegisterPartition(weight);
+    return id;
+  }
+
+  virtual PendingHandle* Allocate(Slice key, int val_len, int charge) OVERRIDE {
+    return fast_cache_->Allocate(key, val_len, charge);
+  }
+
+  virtual void SetPartition(PendingHandle* handle, int partition_id) OVERRIDE {
+    fast_cache_->SetPartition(handle, partition_id);
+  }
+
+  virtual uint8_t* MutableValue(PendingHandle* handle) OVERRIDE {
+    return fast_cache_->MutableValue(handle);
+  }
+
+  virtual Handle* Insert(PendingHandle* pending,
+                         EvictionCallback* eviction_callback) OVERRIDE {
+    if (eviction_callback == nullptr) {
+      return fast_cache_->Insert(pending, &demotion_callback_);
+    }
+    // Chain the client's callback behind the demotion handling. The chained
+    // callback is invoked exactly once, when the entry falls out of the fast
+    // tier, and frees itself afterwards.
+    return fast_cache_->Insert(
+        pending, new TieredEvictionCallback(this, eviction_callback, /* one_shot= */ true));
+  }
+
+  virtual void Free(PendingHandle* ptr) OVERRIDE {
+    fast_cache_->Free(ptr);
+  }
+
+ private:
+  // An entry evicted from the fast tier, copied out of the cache so the
+  // write into the slow tier can happen on the demotion thread.
+  struct DemotedEntry {
+    faststring key;
+    faststring value;
+  };
+
+  // Queues entries evicted from the fast tier for demotion and then invokes
+  // the client's own eviction callback, if any.
+  class TieredEvictionCallback : public Cache::EvictionCallback {
+   public:
+    TieredEvictionCallback(TwoTierCache* cache,
+                           Cache::EvictionCallback* client_callback,
+                           bool one_shot)
+        : cache_(cache),
+          client_callback_(client_callback),
+          one_shot_(one_shot) {
+    }
+
+    virtual void EvictedEntry(Slice key, Slice value) OVERRIDE {
+      cache_->DemoteEntry(key, value);
+      if (client_callback_ != nullptr) {
+        client_callback_->EvictedEntry(key, value);
+      }
+      if (one_shot_) {
+        delete this;
+      }
+    }
+
+   private:
+    TwoTierCache* const cache_;
+    Cache::EvictionCallback* const client_callback_;
+    const bool one_shot_;
+  };
+
+  void DemoteEntry(Slice key, Slice value) {
+    // The evicted entry is freed as soon as the eviction callback returns,
+    // so copy it out here; the (slow) write into the slow tier happens on
+    // the demotion thread.
+    shared_ptr<DemotedEntry> entry(new DemotedEntry());
+    entry->key.assign_copy(key.data(), key.size());
+    entry->value.assign_copy(value.data(), value.size());
+    Status s = demotion_pool_->SubmitFunc(
+        [this, entry]() { this->WriteToSlowTier(*entry); });
+    if (PREDICT_FALSE(!s.ok())) {
+      // The demotion queue is full or the cache is shutting down; the entry
+      // is simply not demoted.
+      return;
+    }
+    if (metrics_) {
+      metrics_->demotions->Increment();
+    }
+  }
+
+  void WriteToSlowTier(const DemotedEntry& entry) {
+    PendingHandle* ph = slow_cache_->Allocate(
+        Slice(entry.key), entry.value.size(), entry.value.size());
+    if (PREDICT_FALSE(ph == nullptr)) {
+      // The slow tier could not free up space for the entry.
+      return;
+    }
+    memcpy(slow_cache_->MutableValue(ph), entry.value.data(), entry.value.size());
+    slow_cache_->Release(slow_cache_->Insert(ph, nullptr));
+  }
+
+  gscoped_ptr<Cache> fast_cache_;
+  gscoped_ptr<Cache> slow_cache_;
+
+  gscoped_ptr<ThreadPool> demotion_pool_;
+
+  // Shared eviction callback for entries inserted without a client callback.
+  TieredEvictionCallback demotion_callback_;
+
+  gscoped_ptr<TwoTierCacheMetrics> metrics_;
+
+  DISALLOW_COPY_AND_ASSIGN(TwoTierCache);
+};
+
+}  // anonymous namespace
+
+Cache* NewTwoTierCache(Cache* fast_cache, Cache* slow_cache, const string& id) {
+  return new TwoTierCache(fast_cache, slow_cache, id);
+}
+
+}  // namespace kudu
@@ -0,0 +1,47 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#ifndef KUDU_UTIL_TWOTIER_CACHE_H_
+#define KUDU_UTIL_TWOTIER_CACHE_H_
+
+#include <string>
+
+namespace kudu {
+class Cache;
+
+// Create a two-tier cache which keeps hot entries in 'fast_cache' and spills
+// entries evicted from it into 'slow_cache' (e.g. a DRAM tier backed by a
+// much larger NVM tier).
+//
+// Lookups consult the fast tier first. A hit in the slow tier promotes the
+// entry back into the fast tier and serves it from there, so that repeated
+// accesses read fast-tier memory. Entries evicted from the fast tier are
+// demoted into the slow tier by a background thread, keeping the (slow)
+// writes to the cold tier off the insertion path; when the demotion queue
+// is full, evicted entries are simply dropped.
+//
+// Eviction callbacks passed to Insert() are invoked when the entry falls
+// out of the fast tier, before it is demoted; they are not re-attached to
+// the demoted copy, so an entry which is later promoted and evicted again
+// does not invoke the callback a second time. Values must therefore be
+// self-contained (as block cache values are).
+//
+// Takes ownership of both caches. 'id' is used to name the demotion thread.
+Cache* NewTwoTierCache(Cache* fast_cache, Cache* slow_cache, const std::string& id);
+
+}  // namespace kudu
+
+#endif
@@ -89,6 +89,23 @@ class WebCallbackRegistry {
     std::ostringstream* output;
   };
 
+  // A response to an HTTP request whose body is streamed to the client as it
+  // is produced.
+  struct StreamingWebResponse {
+    // Determines the status code of the HTTP response. Since the response is
+    // streamed, this (and 'response_headers') must be set before anything is
+    // written to 'output': the headers are sent to the client along with the
+    // first bytes of the body.
+    HttpStatusCode status_code;
+
+    // Additional headers added to the HTTP response.
+    HttpResponseHeaders response_headers;
+
+    // The response body. Data written here is sent to the client
+    // incrementally rather than being buffered until the handler returns.
+    std::ostream* output;
+  };
+
   // A function that handles an HTTP request where the response body will be rendered
   // with a mustache template from the JSON object held by 'resp'.
   typedef boost::function<void (const WebRequest& args, WebResponse* resp)>
@@ -99,6 +116,11 @@ class WebCallbackRegistry {
   typedef boost::function<void (const WebRequest& args, PrerenderedWebResponse* resp)>
       PrerenderedPathHandlerCallback;
 
+  // A function that handles an HTTP request, streaming the response body to
+  // the client as it writes to the 'output' member of 'resp'.
+  typedef boost::function<void (const WebRequest& args, StreamingWebResponse* resp)>
+      StreamingPathHandlerCallback;
+
   virtual ~WebCallbackRegistry() {}
 
   // Register a callback for a URL path. Path should not include the
@@ -122,6 +144,13 @@ class WebCallbackRegistry {
                                               const PrerenderedPathHandlerCallback& callback,
                                               bool is_styled,
                                               bool is_on_nav_bar) = 0;
+
+  // Same as RegisterPrerenderedPathHandler(), except that the response body is
+  // streamed to the client as the callback produces it, rather than being
+  // buffered in memory first. Streamed responses are never styled.
+  virtual void RegisterStreamingPathHandler(const std::string& path, const std::string& alias,
+                                            const StreamingPathHandlerCallback& callback,
+                                            bool is_on_nav_bar) = 0;
 };
 
 } // namespace kudu